@@ -0,0 +1,763 @@
+/**
+ * @file benchmark.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Contém o programa de benchmark da árvore 2-3 e do gerenciador de livros.
+ *
+ * Para cada tamanho de catálogo e cada distribuição de códigos, o programa gera um catálogo sintético, executa as
+ * operações abaixo sobre uma biblioteca nova e mede cada chamada individualmente:
+ *
+ * - insert: `insertBookRecord` de todos os livros (com os índices de autores e de títulos abertos);
+ * - lookup: `readBookRecord` de códigos existentes;
+ * - author_search: `authorIndexLookup` seguido da leitura dos registros candidatos;
+ * - title_search: `titleIndexSearch` exata;
+ * - remove: `deleteBookRecord` de códigos existentes;
+ * - bulk_load: `loadTextFileBulk` de um arquivo texto com o catálogo inteiro, em uma biblioteca vazia.
+ *
+ * As distribuições são:
+ *
+ * - sequential: códigos 1..n inseridos em ordem crescente;
+ * - random: os mesmos códigos, inseridos em ordem aleatória;
+ * - skewed: códigos com intervalos de cauda pesada (Pareto) entre eles, inseridos em ordem aleatória, com
+ *   autores e consultas concentrados em poucos valores (Zipf).
+ *
+ * O resultado é um documento JSON com a vazão, as latências p50 e p99 e, quando `/proc/self/io` está disponível,
+ * o número de chamadas de sistema de leitura e escrita e os bytes transferidos por operação. O documento é gravado
+ * em `bench_output.json`, a menos que outro arquivo seja indicado em `--output`.
+ *
+ * Uso: `benchmark [--sizes 1000,10000,...] [--order N] [--seed N] [--dir DIRETORIO] [--output ARQUIVO]`
+ *
+ * @see library.h
+ * @see book_manager.h
+ */
+
+#include "library.h"
+#include "book_manager.h"
+#include "file_manager.h"
+#include "storage.h"
+#include "key_search.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Número máximo de tamanhos de catálogo aceitos em `--sizes`.
+ */
+#define BENCHMARK_MAX_SIZES 16
+
+/**
+ * @brief Número máximo de operações medidas nas fases de consulta e de remoção.
+ */
+#define BENCHMARK_MAX_QUERIES 100000
+
+/**
+ * @brief Distribuições de códigos geradas pelo benchmark.
+ */
+typedef enum
+{
+    DISTRIBUTION_SEQUENTIAL,
+    DISTRIBUTION_RANDOM,
+    DISTRIBUTION_SKEWED
+} Distribution;
+
+static const char *distributionNames[] = {"sequential", "random", "skewed"};
+
+/**
+ * @brief Contadores de entrada e saída do processo (`/proc/self/io`).
+ */
+typedef struct
+{
+    int available;      // 1 se os contadores puderam ser lidos
+    long long syscr;    // Chamadas de sistema de leitura
+    long long syscw;    // Chamadas de sistema de escrita
+    long long rchar;    // Bytes lidos
+    long long wchar;    // Bytes escritos
+} IoCounters;
+
+/**
+ * @brief Medição de uma fase do benchmark.
+ */
+typedef struct
+{
+    double *latencies; // Latência de cada operação, em segundos
+    long ops;          // Operações medidas
+    double seconds;    // Soma das latências
+    IoCounters before; // Contadores no início da fase
+} Phase;
+
+/**
+ * @brief Opções da linha de comando.
+ */
+typedef struct
+{
+    long sizes[BENCHMARK_MAX_SIZES];
+    int sizeCount;
+    int order;
+    uint64_t seed;
+    const char *dir;
+    const char *output;
+} Options;
+
+static uint64_t rngState = 1;
+static int firstResult = 1;
+
+/**
+ * @brief Gera o próximo número pseudoaleatório (xorshift64*), reprodutível a partir de `--seed`.
+ */
+static uint64_t nextRandom(void)
+{
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+
+    return rngState * 2685821657736338717ULL;
+}
+
+/**
+ * @brief Retorna um número pseudoaleatório uniforme em [0, 1).
+ */
+static double randomUnit(void)
+{
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Retorna um índice em [0, n) com distribuição aproximadamente Zipf (s = 1): o índice k é sorteado com
+ *        probabilidade proporcional a 1 / (k + 1).
+ */
+static long zipfIndex(long n)
+{
+    long index = (long)floor(exp(randomUnit() * log((double)n + 1.0))) - 1;
+
+    return index < 0 ? 0 : (index >= n ? n - 1 : index);
+}
+
+/**
+ * @brief Embaralha um vetor de códigos (Fisher-Yates).
+ */
+static void shuffleCodes(int *codes, long n)
+{
+    for (long i = n - 1; i > 0; i--)
+    {
+        long j = (long)(nextRandom() % (uint64_t)(i + 1));
+        int aux = codes[i];
+
+        codes[i] = codes[j];
+        codes[j] = aux;
+    }
+}
+
+/**
+ * @brief Gera os códigos do catálogo, na ordem de inserção, para a distribuição informada.
+ *
+ * @return Vetor alocado com `n` códigos distintos e positivos, ou NULL em caso de erro de memória.
+ */
+static int *generateCodes(long n, Distribution distribution)
+{
+    int *codes = malloc(sizeof(int) * n);
+    long code = 0;
+
+    if (codes == NULL)
+    {
+        return NULL;
+    }
+
+    for (long i = 0; i < n; i++)
+    {
+        if (distribution == DISTRIBUTION_SKEWED)
+        {
+            // Intervalos de Pareto (alfa = 1,5): a maioria dos códigos fica agrupada, com saltos ocasionais
+            double gap = pow(1.0 - randomUnit(), -1.0 / 1.5);
+
+            code += gap > 1000.0 ? 1000 : (long)gap;
+        }
+        else
+        {
+            code++;
+        }
+
+        codes[i] = (int)code;
+    }
+
+    if (distribution != DISTRIBUTION_SEQUENTIAL)
+    {
+        shuffleCodes(codes, n);
+    }
+
+    return codes;
+}
+
+/**
+ * @brief Número de autores distintos de um catálogo com `n` livros.
+ */
+static long authorCount(long n)
+{
+    return n / 10 > 0 ? n / 10 : 1;
+}
+
+/**
+ * @brief Sorteia o autor de um livro (uniforme ou, na distribuição skewed, Zipf).
+ */
+static long pickAuthor(long n, Distribution distribution)
+{
+    return distribution == DISTRIBUTION_SKEWED ? zipfIndex(authorCount(n))
+                                               : (long)(nextRandom() % (uint64_t)authorCount(n));
+}
+
+/**
+ * @brief Preenche um livro sintético.
+ */
+static void makeBook(Book *book, int code, long author)
+{
+    memset(book, 0, sizeof(Book));
+    book->code = code;
+    snprintf(book->title, sizeof(book->title), "Titulo %d", code);
+    snprintf(book->author, sizeof(book->author), "Autor %ld", author);
+    snprintf(book->publisher, sizeof(book->publisher), "Editora %d", code % 50);
+    book->edition = 1 + code % 5;
+    book->year = 1950 + code % 75;
+    book->price = 10.0 + (code % 9000) / 100.0;
+    book->stock_quantity = code % 20;
+}
+
+/**
+ * @brief Sorteia o índice de um livro do catálogo para uma consulta (uniforme ou, na distribuição skewed, Zipf).
+ */
+static long pickBook(long n, Distribution distribution)
+{
+    return distribution == DISTRIBUTION_SKEWED ? zipfIndex(n) : (long)(nextRandom() % (uint64_t)n);
+}
+
+/**
+ * @brief Retorna o instante atual do relógio monotônico, em segundos.
+ */
+static double now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Lê os contadores de entrada e saída do processo.
+ */
+static IoCounters readIoCounters(void)
+{
+    IoCounters counters = {0, 0, 0, 0, 0};
+    FILE *file = fopen("/proc/self/io", "r");
+    char name[32];
+    long long value;
+    int fields = 0;
+
+    if (file == NULL)
+    {
+        return counters;
+    }
+
+    while (fscanf(file, "%31[^:]: %lld\n", name, &value) == 2)
+    {
+        if (strcmp(name, "syscr") == 0)
+        {
+            counters.syscr = value;
+            fields++;
+        }
+        else if (strcmp(name, "syscw") == 0)
+        {
+            counters.syscw = value;
+            fields++;
+        }
+        else if (strcmp(name, "rchar") == 0)
+        {
+            counters.rchar = value;
+            fields++;
+        }
+        else if (strcmp(name, "wchar") == 0)
+        {
+            counters.wchar = value;
+            fields++;
+        }
+    }
+
+    fclose(file);
+    counters.available = fields == 4;
+
+    return counters;
+}
+
+/**
+ * @brief Inicia a medição de uma fase com até `capacity` operações.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int phaseBegin(Phase *phase, long capacity)
+{
+    phase->latencies = malloc(sizeof(double) * (capacity > 0 ? capacity : 1));
+    phase->ops = 0;
+    phase->seconds = 0.0;
+
+    if (phase->latencies == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para as latências do benchmark.\n");
+        return -1;
+    }
+
+    phase->before = readIoCounters();
+    return 0;
+}
+
+/**
+ * @brief Registra a latência de uma operação da fase.
+ */
+static void phaseRecord(Phase *phase, double start)
+{
+    double elapsed = now() - start;
+
+    phase->latencies[phase->ops++] = elapsed;
+    phase->seconds += elapsed;
+}
+
+/**
+ * @brief Compara duas latências.
+ */
+static int compareLatencies(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Retorna o percentil `p` (entre 0 e 1) das latências já ordenadas, em microssegundos.
+ */
+static double percentile(const Phase *phase, double p)
+{
+    long index = (long)ceil(p * phase->ops) - 1;
+
+    return phase->latencies[index < 0 ? 0 : index] * 1e6;
+}
+
+/**
+ * @brief Imprime um contador por operação, ou `null` se os contadores não estiverem disponíveis.
+ */
+static void printPerOp(FILE *output, const char *name, int available, long long delta, long ops)
+{
+    if (available)
+    {
+        fprintf(output, ", \"%s\": %.3f", name, (double)delta / ops);
+    }
+    else
+    {
+        fprintf(output, ", \"%s\": null", name);
+    }
+}
+
+/**
+ * @brief Encerra a medição de uma fase e grava o seu resultado no documento JSON.
+ *
+ * @param perOpLatency 1 se cada operação foi medida individualmente; 0 se a fase é uma única chamada (carga em
+ *                     lote), caso em que as latências são omitidas.
+ */
+static void phaseEnd(Phase *phase, FILE *output, long size, Distribution distribution, const char *operation,
+                     int perOpLatency)
+{
+    IoCounters after = readIoCounters();
+    int available = phase->before.available && after.available;
+
+    if (phase->ops == 0)
+    {
+        free(phase->latencies);
+        return;
+    }
+
+    long ops = perOpLatency ? phase->ops : size;
+
+    fprintf(output, "%s\n    {\"size\": %ld, \"distribution\": \"%s\", \"operation\": \"%s\", \"ops\": %ld, "
+                    "\"seconds\": %.6f, \"ops_per_second\": %.1f",
+            firstResult ? "" : ",", size, distributionNames[distribution], operation, ops, phase->seconds,
+            phase->seconds > 0 ? ops / phase->seconds : 0.0);
+    firstResult = 0;
+
+    if (perOpLatency)
+    {
+        qsort(phase->latencies, phase->ops, sizeof(double), compareLatencies);
+        fprintf(output, ", \"p50_us\": %.3f, \"p99_us\": %.3f", percentile(phase, 0.50), percentile(phase, 0.99));
+    }
+    else
+    {
+        fprintf(output, ", \"p50_us\": null, \"p99_us\": null");
+    }
+
+    printPerOp(output, "read_syscalls_per_op", available, after.syscr - phase->before.syscr, ops);
+    printPerOp(output, "write_syscalls_per_op", available, after.syscw - phase->before.syscw, ops);
+    printPerOp(output, "read_bytes_per_op", available, after.rchar - phase->before.rchar, ops);
+    printPerOp(output, "write_bytes_per_op", available, after.wchar - phase->before.wchar, ops);
+    fprintf(output, "}");
+    fflush(output);
+
+    free(phase->latencies);
+}
+
+/**
+ * @brief Monta o caminho de um arquivo de trabalho no diretório do benchmark.
+ */
+static void workPath(char *path, size_t size, const Options *options, const char *name)
+{
+    snprintf(path, size, "%s/%s", options->dir, name);
+}
+
+/**
+ * @brief Remove os arquivos de trabalho do benchmark.
+ */
+static void removeWorkFiles(const Options *options)
+{
+    static const char *names[] = {"bench_data.bin", "bench_index.bin", "bench_authors.bin", "bench_titles.bin",
+                                  "bench_books.txt"};
+    char path[512];
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        workPath(path, sizeof(path), options, names[i]);
+        remove(path);
+    }
+}
+
+/**
+ * @brief Executa as fases de inserção, consulta, busca e remoção para um catálogo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int runLibraryPhases(FILE *output, const Options *options, long n, Distribution distribution,
+                            const int *codes, const long *authors)
+{
+    char dataPath[512], indexPath[512], authorPath[512], titlePath[512];
+    long queries = n < BENCHMARK_MAX_QUERIES ? n : BENCHMARK_MAX_QUERIES;
+    Library library;
+    Phase phase;
+    Book book;
+
+    workPath(dataPath, sizeof(dataPath), options, "bench_data.bin");
+    workPath(indexPath, sizeof(indexPath), options, "bench_index.bin");
+    workPath(authorPath, sizeof(authorPath), options, "bench_authors.bin");
+    workPath(titlePath, sizeof(titlePath), options, "bench_titles.bin");
+
+    if (libraryOpenWithOrder(&library, dataPath, indexPath, options->order) != 0 ||
+        libraryOpenAuthorIndex(&library, authorPath) != 0 || libraryOpenTitleIndex(&library, titlePath) != 0)
+    {
+        fprintf(stderr, "Erro ao abrir a biblioteca do benchmark.\n");
+        return -1;
+    }
+
+    // Inserção de todo o catálogo
+    if (phaseBegin(&phase, n) != 0)
+    {
+        libraryClose(&library);
+        return -1;
+    }
+
+    for (long i = 0; i < n; i++)
+    {
+        makeBook(&book, codes[i], authors[i]);
+
+        double start = now();
+        insertBookRecord(&library, &book);
+        phaseRecord(&phase, start);
+    }
+
+    phaseEnd(&phase, output, n, distribution, "insert", 1);
+    libraryCommit(&library);
+
+    // Consultas pontuais por código
+    if (phaseBegin(&phase, queries) == 0)
+    {
+        for (long i = 0; i < queries; i++)
+        {
+            int code = codes[pickBook(n, distribution)];
+
+            double start = now();
+            readBookRecord(&library, code, &book);
+            phaseRecord(&phase, start);
+        }
+
+        phaseEnd(&phase, output, n, distribution, "lookup", 1);
+    }
+
+    // Buscas por autor: candidatos do índice confirmados no arquivo de dados
+    if (phaseBegin(&phase, queries) == 0)
+    {
+        for (long i = 0; i < queries; i++)
+        {
+            char author[100];
+            int count = 0;
+
+            snprintf(author, sizeof(author), "Autor %ld", pickAuthor(n, distribution));
+
+            double start = now();
+            int *positions = authorIndexLookup(&library.authorIndex, author, &count);
+
+            for (int j = 0; j < count; j++)
+            {
+                storageRead(library.dataFile, sizeof(BookDataFileHeader) + (long)positions[j] * sizeof(Book),
+                            &book, sizeof(Book));
+            }
+
+            free(positions);
+            phaseRecord(&phase, start);
+        }
+
+        phaseEnd(&phase, output, n, distribution, "author_search", 1);
+    }
+
+    // Buscas exatas por título
+    if (phaseBegin(&phase, queries) == 0)
+    {
+        for (long i = 0; i < queries; i++)
+        {
+            char title[150];
+            int count = 0;
+
+            snprintf(title, sizeof(title), "Titulo %d", codes[pickBook(n, distribution)]);
+
+            double start = now();
+            free(titleIndexSearch(&library.titleIndex, title, 0, 0, &count));
+            phaseRecord(&phase, start);
+        }
+
+        phaseEnd(&phase, output, n, distribution, "title_search", 1);
+    }
+
+    // Remoções de códigos distintos, na ordem de inserção
+    if (phaseBegin(&phase, queries) == 0)
+    {
+        for (long i = 0; i < queries; i++)
+        {
+            double start = now();
+            deleteBookRecord(&library, codes[i]);
+            phaseRecord(&phase, start);
+        }
+
+        phaseEnd(&phase, output, n, distribution, "remove", 1);
+    }
+
+    libraryClose(&library);
+    return 0;
+}
+
+/**
+ * @brief Executa a fase de carga em lote de um arquivo texto com o catálogo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int runBulkLoadPhase(FILE *output, const Options *options, long n, Distribution distribution,
+                            const int *codes, const long *authors)
+{
+    char dataPath[512], indexPath[512], textPath[512];
+    Library library;
+    Phase phase;
+    Book book;
+
+    workPath(dataPath, sizeof(dataPath), options, "bench_data.bin");
+    workPath(indexPath, sizeof(indexPath), options, "bench_index.bin");
+    workPath(textPath, sizeof(textPath), options, "bench_books.txt");
+
+    FILE *text = fopen(textPath, "w");
+
+    if (text == NULL)
+    {
+        perror("Erro ao criar o arquivo texto do benchmark");
+        return -1;
+    }
+
+    for (long i = 0; i < n; i++)
+    {
+        makeBook(&book, codes[i], authors[i]);
+        fprintf(text, "%d;%s;%s;%s;%d;%d;%.2f;%d\n", book.code, book.title, book.author, book.publisher,
+                book.edition, book.year, book.price, book.stock_quantity);
+    }
+
+    if (fclose(text) != 0 || libraryOpenWithOrder(&library, dataPath, indexPath, options->order) != 0)
+    {
+        fprintf(stderr, "Erro ao preparar a carga em lote do benchmark.\n");
+        return -1;
+    }
+
+    if (phaseBegin(&phase, 1) == 0)
+    {
+        double start = now();
+        loadTextFileBulk(&library, textPath);
+        libraryCommit(&library);
+        phaseRecord(&phase, start);
+
+        phaseEnd(&phase, output, n, distribution, "bulk_load", 0);
+    }
+
+    libraryClose(&library);
+    return 0;
+}
+
+/**
+ * @brief Lê a lista de tamanhos de `--sizes` (separados por vírgula).
+ *
+ * @return 0 em caso de sucesso, -1 se a lista for inválida.
+ */
+static int parseSizes(Options *options, const char *list)
+{
+    char buffer[256];
+    char *token;
+
+    snprintf(buffer, sizeof(buffer), "%s", list);
+    options->sizeCount = 0;
+
+    for (token = strtok(buffer, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        long size = atol(token);
+
+        if (size <= 0 || options->sizeCount == BENCHMARK_MAX_SIZES)
+        {
+            return -1;
+        }
+
+        options->sizes[options->sizeCount++] = size;
+    }
+
+    return options->sizeCount > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Lê as opções da linha de comando.
+ *
+ * @return 0 em caso de sucesso, -1 se alguma opção for inválida.
+ */
+static int parseOptions(Options *options, int argc, char *argv[])
+{
+    options->sizeCount = 0;
+    options->order = TWO_THREE_TREE_ORDER;
+    options->seed = 1;
+    options->dir = ".";
+    options->output = "bench_output.json";
+
+    // Por padrão, de 10^3 a 10^5 livros; tamanhos maiores (até 10^7) devem ser pedidos com --sizes
+    for (long size = 1000; size <= 100000; size *= 10)
+    {
+        options->sizes[options->sizeCount++] = size;
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            return -1;
+        }
+
+        if (strcmp(argv[i], "--sizes") == 0)
+        {
+            if (parseSizes(options, argv[++i]) != 0)
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--order") == 0)
+        {
+            options->order = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            options->seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--dir") == 0)
+        {
+            options->dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--output") == 0)
+        {
+            options->output = argv[++i];
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    return options->seed != 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+
+    if (parseOptions(&options, argc, argv) != 0)
+    {
+        fprintf(stderr, "Uso: %s [--sizes 1000,10000,...] [--order N] [--seed N] [--dir DIRETORIO] "
+                        "[--output ARQUIVO]\n",
+                argv[0]);
+        return 1;
+    }
+
+    // O resultado não é gravado na saída padrão, onde a carga em lote imprime o seu resumo
+    FILE *output = fopen(options.output, "w");
+
+    if (output == NULL)
+    {
+        perror("Erro ao criar o arquivo de resultados");
+        return 1;
+    }
+
+    fprintf(output, "{\n  \"benchmark\": \"TwoThreeLibrary\",\n  \"format\": 1,\n  \"order\": %d,\n  \"seed\": %llu,\n"
+                    "  \"book_size\": %zu,\n  \"key_search\": \"%s\",\n  \"results\": [",
+            options.order, (unsigned long long)options.seed, sizeof(Book), keySearchImplementation());
+
+    int status = 0;
+
+    for (int s = 0; status == 0 && s < options.sizeCount; s++)
+    {
+        long n = options.sizes[s];
+
+        for (int d = DISTRIBUTION_SEQUENTIAL; status == 0 && d <= DISTRIBUTION_SKEWED; d++)
+        {
+            Distribution distribution = (Distribution)d;
+
+            // Cada catálogo é gerado a partir da mesma semente, de modo que as execuções sejam comparáveis
+            rngState = options.seed + (uint64_t)n * 3 + d;
+
+            int *codes = generateCodes(n, distribution);
+            long *authors = malloc(sizeof(long) * n);
+
+            if (codes == NULL || authors == NULL)
+            {
+                fprintf(stderr, "Erro: memória insuficiente para o catálogo de %ld livros.\n", n);
+                free(codes);
+                free(authors);
+                status = -1;
+                break;
+            }
+
+            for (long i = 0; i < n; i++)
+            {
+                authors[i] = pickAuthor(n, distribution);
+            }
+
+            removeWorkFiles(&options);
+            status = runLibraryPhases(output, &options, n, distribution, codes, authors);
+
+            removeWorkFiles(&options);
+            if (status == 0)
+            {
+                status = runBulkLoadPhase(output, &options, n, distribution, codes, authors);
+            }
+
+            removeWorkFiles(&options);
+            free(codes);
+            free(authors);
+        }
+    }
+
+    fprintf(output, "\n  ]\n}\n");
+    fclose(output);
+
+    return status == 0 ? 0 : 1;
+}
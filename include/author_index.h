@@ -0,0 +1,165 @@
+/**
+ * @file author_index.h
+ * @see author_index.c
+ *
+ * @brief Contém o índice secundário persistente de livros por autor.
+ *
+ * O índice é uma tabela hash gravada em arquivo. O arquivo começa pelo cabeçalho, seguido do vetor de baldes
+ * (cada balde guarda a primeira entrada da sua lista) e das entradas. Cada entrada associa o hash do nome
+ * normalizado do autor à posição do livro no arquivo de dados. Como apenas o hash é armazenado, quem consulta o
+ * índice deve confirmar o autor no registro do livro, descartando eventuais colisões.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef AUTHOR_INDEX_H
+#define AUTHOR_INDEX_H
+
+#include <stdio.h>
+
+/**
+ * @brief Número de baldes utilizado ao criar um novo índice de autores.
+ */
+#define AUTHOR_INDEX_DEFAULT_BUCKETS 4096
+
+/**
+ * @brief Estrutura de Dados para o cabeçalho do arquivo do índice de autores.
+ *
+ * - bucketCount: Número de baldes da tabela hash.
+ * - firstEmptyPosition: Posição (número da entrada) da primeira entrada nunca utilizada.
+ * - headEmptyPosition: Posição da primeira entrada da lista de entradas livres (-1 se vazia).
+ */
+typedef struct
+{
+    int bucketCount;        // Número de baldes da tabela hash
+    int firstEmptyPosition; // Primeira entrada nunca utilizada
+    int headEmptyPosition;  // Cabeça da lista de entradas livres
+} AuthorIndexHeader;
+
+/**
+ * @brief Estrutura de Dados para uma entrada do índice de autores.
+ *
+ * - hash: Hash do nome normalizado do autor.
+ * - bookPosition: Posição do livro no arquivo de dados.
+ * - next: Próxima entrada do mesmo balde (ou da lista de entradas livres), -1 se for a última.
+ */
+typedef struct
+{
+    unsigned int hash; // Hash do nome normalizado do autor
+    int bookPosition;  // Posição do livro no arquivo de dados
+    int next;          // Próxima entrada da lista
+} AuthorIndexEntry;
+
+/**
+ * @brief Índice de autores aberto.
+ *
+ * O cabeçalho e o vetor de baldes ficam em memória enquanto o índice está aberto e só são gravados no arquivo
+ * em `authorIndexFlush` ou `authorIndexClose`.
+ */
+typedef struct
+{
+    FILE *file;               // Arquivo do índice (NULL se o índice não estiver aberto)
+    AuthorIndexHeader header; // Cabeçalho (versão válida)
+    int *buckets;             // Primeira entrada de cada balde
+    int dirty;                // 1 se o cabeçalho ou os baldes precisam ser gravados
+} AuthorIndex;
+
+/**
+ * @brief Cria um novo índice de autores vazio.
+ *
+ * @pre `index` e `filename` não devem ser NULL.
+ *
+ * @post O arquivo é criado (ou truncado) e o índice fica aberto, com o cabeçalho e os baldes em memória.
+ *
+ * @param index Ponteiro para a estrutura do índice a ser inicializada.
+ * @param filename Nome do arquivo do índice.
+ * @param bucketCount Número de baldes da tabela hash.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int authorIndexCreate(AuthorIndex *index, const char *filename, int bucketCount);
+
+/**
+ * @brief Abre um índice de autores existente.
+ *
+ * @pre `index` e `filename` não devem ser NULL.
+ *
+ * @post O índice fica aberto, com o cabeçalho e os baldes lidos do arquivo para a memória.
+ *
+ * @param index Ponteiro para a estrutura do índice a ser inicializada.
+ * @param filename Nome do arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser lido ou estiver inconsistente.
+ */
+int authorIndexOpen(AuthorIndex *index, const char *filename);
+
+/**
+ * @brief Insere a associação entre um autor e a posição de um livro.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param author Nome do autor (não precisa estar normalizado).
+ * @param bookPosition Posição do livro no arquivo de dados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de gravação.
+ */
+int authorIndexInsert(AuthorIndex *index, const char *author, int bookPosition);
+
+/**
+ * @brief Remove a associação entre um autor e a posição de um livro.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param author Nome do autor usado na inserção.
+ * @param bookPosition Posição do livro no arquivo de dados.
+ *
+ * @return 0 se a entrada foi removida, -1 se não foi encontrada ou em caso de erro.
+ *
+ * @note A entrada removida é colocada na lista de entradas livres para ser reutilizada.
+ */
+int authorIndexRemove(AuthorIndex *index, const char *author, int bookPosition);
+
+/**
+ * @brief Retorna as posições dos livros cujo autor tem o mesmo hash do autor informado.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param author Nome do autor a ser buscado.
+ * @param count Ponteiro onde será armazenado o número de posições retornadas.
+ *
+ * @return Vetor alocado dinamicamente com as posições em ordem crescente (deve ser liberado com `free`),
+ *         ou NULL se nenhuma posição for encontrada.
+ *
+ * @warning As posições retornadas são candidatas: o autor deve ser confirmado no registro do livro.
+ */
+int *authorIndexLookup(AuthorIndex *index, const char *author, int *count);
+
+/**
+ * @brief Remove todas as entradas do índice, mantendo o arquivo aberto.
+ *
+ * Usada para reconstruir o índice quando as posições dos livros mudam (por exemplo, na compactação).
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ *
+ * @post O arquivo é truncado para o cabeçalho e os baldes vazios.
+ */
+int authorIndexClear(AuthorIndex *index);
+
+/**
+ * @brief Grava no arquivo o cabeçalho e os baldes do índice, caso tenham sido modificados.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int authorIndexFlush(AuthorIndex *index);
+
+/**
+ * @brief Grava as alterações pendentes e fecha o índice de autores.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int authorIndexClose(AuthorIndex *index);
+
+#endif /* AUTHOR_INDEX_H */
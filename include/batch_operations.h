@@ -0,0 +1,107 @@
+/**
+ * @file batch_operations.h
+ * @see batch_operations.c
+ *
+ * @brief Contém o executor de operações em lote (inserções, remoções e alterações de estoque e de preço).
+ *
+ * O arquivo de operações é um arquivo texto com uma operação por linha, identificada pela primeira letra:
+ *
+ * @code
+ * I;codigo;titulo;autor;editora;edicao;ano;preco;estoque   (insere um livro, no formato do arquivo texto)
+ * R;codigo                                                 (remove um livro)
+ * E;codigo;variacao                                        (soma a variação ao estoque do livro)
+ * P;codigo;preco                                           (substitui o preço do livro)
+ * @endcode
+ *
+ * Linhas em branco e linhas iniciadas por `#` são ignoradas.
+ *
+ * Todas as operações são lidas para a memória e ordenadas pelo código do livro (mantendo a ordem do arquivo entre
+ * operações do mesmo código), de modo que os nós da árvore sejam visitados em ordem e reaproveitados pelo cache de
+ * nós. As operações são aplicadas sobre os cabeçalhos mantidos em memória pelo handle da biblioteca, que só são
+ * gravados uma vez, ao final do lote.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef BATCH_OPERATIONS_H
+#define BATCH_OPERATIONS_H
+
+#include "book.h"
+#include "library.h"
+
+/**
+ * @brief Número máximo de erros listados individualmente no relatório do lote.
+ */
+#define BATCH_MAX_REPORTED_ERRORS 20
+
+/**
+ * @brief Tipo de uma operação do lote.
+ */
+typedef enum
+{
+    BATCH_INSERT, // Inserção de um livro
+    BATCH_REMOVE, // Remoção de um livro
+    BATCH_STOCK,  // Alteração do estoque de um livro
+    BATCH_PRICE   // Alteração do preço de um livro
+} BatchOperationType;
+
+/**
+ * @brief Estrutura de Dados para uma operação do lote.
+ *
+ * - type: Tipo da operação.
+ * - line: Linha do arquivo de operações (usada no relatório e como desempate na ordenação).
+ * - delta: Variação do estoque (apenas em `BATCH_STOCK`).
+ * - price: Novo preço (apenas em `BATCH_PRICE`).
+ * - book: Livro a ser inserido; nas demais operações apenas `book.code` é utilizado.
+ */
+typedef struct
+{
+    BatchOperationType type; // Tipo da operação
+    int line;                // Linha do arquivo de operações
+    int delta;               // Variação do estoque
+    double price;            // Novo preço
+    Book book;               // Livro (ou apenas o código)
+} BatchOperation;
+
+/**
+ * @brief Resumo da execução de um lote.
+ */
+typedef struct
+{
+    int inserted;     // Livros inseridos
+    int removed;      // Livros removidos
+    int updated;      // Estoques ou preços alterados
+    int duplicates;   // Inserções com código já existente
+    int missing;      // Remoções ou alterações de códigos inexistentes
+    int insufficient; // Alterações que deixariam o estoque negativo
+    int invalid;      // Linhas mal formatadas ou com valores inválidos
+    int failed;       // Operações interrompidas por erro de leitura ou gravação
+} BatchReport;
+
+/**
+ * @brief Executa as operações de um arquivo de operações em lote.
+ *
+ * As operações rejeitadas (código duplicado, código inexistente, estoque insuficiente ou linha inválida) não
+ * interrompem o lote: elas são contabilizadas no relatório e as primeiras `BATCH_MAX_REPORTED_ERRORS` são listadas.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @post As operações válidas são aplicadas e os cabeçalhos, os nós modificados, os índices secundários e as
+ *       estatísticas são gravados uma única vez, ao final do lote.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param filename Nome do arquivo de operações.
+ * @param report Ponteiro para o relatório a ser preenchido.
+ *
+ * @return O número de operações aplicadas, ou -1 se o arquivo não puder ser lido.
+ */
+int executeBatchFile(Library *library, const char *filename, BatchReport *report);
+
+/**
+ * @brief Exibe o relatório de execução de um lote.
+ *
+ * @param report Ponteiro para o relatório.
+ */
+void printBatchReport(const BatchReport *report);
+
+#endif /* BATCH_OPERATIONS_H */
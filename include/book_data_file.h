@@ -13,17 +13,40 @@
 #ifndef BOOK_DATA_FILE_H
 #define BOOK_DATA_FILE_H
 
+/**
+ * @brief Identificador do formato do arquivo de dados.
+ */
+#define BOOK_DATA_FILE_MAGIC 0x31464442u
+
+/**
+ * @brief Versão do formato do arquivo de dados.
+ */
+#define BOOK_DATA_FILE_VERSION 3
+
 /**
  * @brief Estrutura de cabeçalho para os metadados do arquivo de dados de livros.
  *
  * Esta estrutura armazena metadados sobre o arquivo de dados de livros, incluindo:
+ * - `magic`, `version`: Identificador e versão do formato (`BOOK_DATA_FILE_MAGIC` e `BOOK_DATA_FILE_VERSION`).
+ * - `recordSize`: O tamanho (em bytes) de cada registro, igual a `sizeof(Book)`.
+ * - `generation`: O número de fechamentos completos da biblioteca, conferido com o do snapshot ao reabri-la.
+ * - `pairStamp`: A marca comum ao arquivo de dados e ao arquivo de índices criados juntos, conferida ao reabri-los.
  * - `firstEmptyPosition`: O deslocamento da primeira posição disponível para escrita de novos dados.
  * - `headEmptyPosition`: O deslocamento da cabeça da lista encadeada de blocos de dados livres.
+ * - `bookCount`: O número de livros registrados (registros não removidos).
+ * - `stockTotal`: A soma dos exemplares em estoque de todos os livros registrados.
  */
 typedef struct
 {
+    unsigned int magic;     /**< Identificador do formato. */
+    int version;            /**< Versão do formato. */
+    int recordSize;         /**< Tamanho de cada registro. */
+    int generation;         /**< Número de fechamentos completos. */
+    unsigned int pairStamp; /**< Marca comum ao arquivo de índices do mesmo par. */
     int firstEmptyPosition; /**< Deslocamento da primeira posição livre no arquivo de dados. */
     int headEmptyPosition;  /**< Deslocamento da cabeça da lista de blocos livres. */
+    int bookCount;          /**< Número de livros registrados. */
+    long long stockTotal;   /**< Soma dos exemplares em estoque. */
 } BookDataFileHeader;
 
 /**
@@ -13,5 +13,407 @@
 #define BOOK_MANAGER_H
 
 #include "book.h"
+#include "library.h"
+
+/**
+ * @brief Resultados das operações de livros (os erros de leitura ou gravação retornam -1).
+ */
+#define BOOK_OK 0                 // Operação realizada
+#define BOOK_NOT_FOUND 1          // Código não encontrado no índice
+#define BOOK_DUPLICATE 2          // Código já existente no índice
+#define BOOK_INSUFFICIENT_STOCK 3 // A operação deixaria o estoque negativo
+#define BOOK_INVALID_STOCK 4      // O livro informado tem estoque negativo
+#define BOOK_INVALID_PRICE 5      // O novo preço não é um número finito e positivo
+
+/**
+ * @brief Campos alterados por uma atualização (`BookUpdate.fields`), combinados com `|`.
+ */
+#define BOOK_UPDATE_PRICE 0x1 // Substitui o preço
+#define BOOK_UPDATE_STOCK 0x2 // Soma `stockDelta` ao estoque
+
+/**
+ * @brief Número máximo de registros lidos de uma vez por `updateBookRecords`.
+ */
+#define BOOK_UPDATE_MAX_RUN 64
+
+/**
+ * @brief Estrutura de Dados para a atualização dos campos de um livro.
+ *
+ * - code: Código do livro.
+ * - fields: Campos alterados (`BOOK_UPDATE_PRICE`, `BOOK_UPDATE_STOCK` ou ambos).
+ * - price: Novo preço (apenas com `BOOK_UPDATE_PRICE`).
+ * - stockDelta: Variação da quantidade em estoque (apenas com `BOOK_UPDATE_STOCK`).
+ */
+typedef struct
+{
+    int code;       // Código do livro
+    int fields;     // Campos alterados
+    double price;   // Novo preço
+    int stockDelta; // Variação do estoque
+} BookUpdate;
+
+/**
+ * @brief Processa uma linha de texto e extrai os dados do livro.
+ *
+ * @param[in] linha Linha do arquivo de texto contendo os dados do livro, com os campos separados por ponto e vírgula (`;`).
+ * @param[out] livro Ponteiro para a estrutura `Book` onde os dados extraídos serão armazenados.
+ *
+ * @pre A linha de texto deve estar formatada corretamente e o ponteiro `livro` deve ser válido.
+ *
+ * @post A estrutura apontada por `livro` é preenchida com os dados extraídos da linha.
+ */
+void extractBookFromLine(const char *linha, Book *livro);
+
+/**
+ * @brief Insere um livro no arquivo de dados e sua chave nos índices, sem exibir mensagens.
+ *
+ * @details O livro é gravado no registro livre de menor posição, obtido do alocador de registros sem leitura do
+ *          arquivo (que é estendido em lotes quando não há registros livres). Em seguida, o código do livro é inserido na árvore 2-3 junto com a
+ *          posição do registro, e os índices secundários e as estatísticas abertos são atualizados. Os cabeçalhos
+ *          utilizados são os mantidos em memória pelo handle da biblioteca, de modo que nenhuma leitura ou gravação
+ *          de cabeçalho é feita por livro.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param book Ponteiro para o livro a ser inserido.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações da operação formam uma única transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante toda a operação.
+ * @note Com o filtro de códigos ligado (`libraryEnableCodeFilter`), a busca prévia por duplicados só é feita
+ *       para os códigos que podem estar no índice.
+ * @note Uma falha ao atualizar um arquivo secundário não desfaz a inserção: o arquivo é marcado com
+ *       `libraryMarkStale` e reconstruído na próxima abertura.
+ *
+ * @return `BOOK_OK` se o livro foi inserido, `BOOK_DUPLICATE` se o código já existir no índice,
+ *         `BOOK_INVALID_STOCK` se o estoque do livro for negativo, ou -1 em caso de erro de leitura ou gravação.
+ */
+int insertBookRecord(Library *library, const Book *book);
+
+/**
+ * @brief Adiciona um livro ao arquivo de dados e sua chave ao índice.
+ *
+ * @details Chama `insertBookRecord` e exibe o resultado da inserção.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param book Ponteiro para o livro a ser adicionado.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @post Se o código ainda não existir no índice, o livro é gravado e indexado.
+ */
+void addBookAux(Library *library, const Book *book);
+
+/**
+ * @brief Adiciona um livro à biblioteca.
+ *
+ * @details Chama `addBookAux` e registra a operação no handle da biblioteca, que grava os cabeçalhos no disco
+ *          quando o intervalo de gravação configurado é atingido.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param book Ponteiro para o livro a ser adicionado.
+ */
+void addBook(Library *library, const Book *book);
+
+/**
+ * @brief Remove um livro do arquivo de dados e dos índices, sem exibir mensagens.
+ *
+ * @details A chave do livro é removida da árvore 2-3 e dos índices de autores e de títulos (se estiverem abertos). O registro no
+ *          arquivo de dados é marcado como removido (código -1) e devolvido ao alocador de registros, para ser
+ *          reutilizado pelas próximas inserções.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param code Código do livro a ser removido.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações da operação formam uma única transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante toda a operação.
+ * @note Uma falha ao atualizar um índice secundário não desfaz a remoção: o índice é marcado com `libraryMarkStale`
+ *       e reconstruído na próxima abertura.
+ *
+ * @return `BOOK_OK` se o livro foi removido, `BOOK_NOT_FOUND` se o código não existir no índice, ou -1 em caso de erro.
+ */
+int deleteBookRecord(Library *library, int code);
+
+/**
+ * @brief Remove um livro da biblioteca.
+ *
+ * @details Chama `deleteBookRecord` e registra a operação no handle da biblioteca.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param code Código do livro a ser removido.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @return 0 se o livro foi removido, -1 se não foi encontrado ou em caso de erro.
+ */
+int removeBook(Library *library, int code);
+
+/**
+ * @brief Altera a quantidade em estoque de um livro, sem exibir mensagens.
+ *
+ * @details O registro do livro é lido e apenas o campo do estoque é regravado, na mesma posição (veja
+ *          `updateBookRecord`). O total em estoque do cabeçalho do arquivo de dados e as estatísticas abertas são
+ *          ajustados pela mesma variação.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param code Código do livro.
+ * @param delta Variação da quantidade em estoque (negativa para saídas).
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações da operação formam uma única transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante toda a operação.
+ *
+ * @return `BOOK_OK` se o estoque foi alterado, `BOOK_NOT_FOUND` se o código não existir no índice,
+ *         `BOOK_INSUFFICIENT_STOCK` se o estoque ficaria negativo, ou -1 em caso de erro.
+ */
+int adjustBookStockRecord(Library *library, int code, int delta);
+
+/**
+ * @brief Altera o preço e/ou o estoque de um livro no próprio registro, sem exibir mensagens.
+ *
+ * @details O código é procurado uma única vez no índice e o registro é lido para validar a alteração e ajustar as
+ *          estatísticas. Apenas os bytes dos campos alterados são regravados, em uma única gravação (o preço e o
+ *          estoque são campos vizinhos do registro); o índice, os demais campos e a lista de registros livres não
+ *          são alterados. O total em estoque do cabeçalho, as estatísticas e o arquivo de colunas abertos são
+ *          ajustados junto (as estatísticas e as colunas, depois de confirmada a transação).
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param update Ponteiro para a atualização.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações da operação formam uma única transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante toda a operação.
+ *
+ * @return `BOOK_OK` se o livro foi alterado, `BOOK_NOT_FOUND` se o código não existir no índice,
+ *         `BOOK_INVALID_PRICE` se o novo preço não for finito e positivo, `BOOK_INSUFFICIENT_STOCK` se o estoque
+ *         ficaria negativo (nos dois casos, nenhum campo é alterado), ou -1 em caso de erro.
+ */
+int updateBookRecord(Library *library, const BookUpdate *update);
+
+/**
+ * @brief Aplica um lote de atualizações de preço e/ou estoque, sem exibir mensagens.
+ *
+ * @details Os códigos são procurados de uma só vez com `twoThreeTreeSearchMany`, e as atualizações são aplicadas em
+ *          ordem crescente de posição no arquivo de dados: os registros consecutivos são lidos em uma única leitura
+ *          (de até `BOOK_UPDATE_MAX_RUN` registros) e cada atualização regrava apenas os campos alterados, como em
+ *          `updateBookRecord`. As atualizações de um mesmo código são aplicadas na ordem do lote.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param updates Atualizações, em qualquer ordem.
+ * @param n Número de atualizações.
+ * @param results Vetor que recebe, na ordem de `updates`, o resultado de cada atualização (`BOOK_OK`,
+ *                `BOOK_NOT_FOUND`, `BOOK_INVALID_PRICE`, `BOOK_INSUFFICIENT_STOCK` ou -1), ou NULL.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações de todo o lote formam uma única transação: em caso de
+ *       erro, a transação é descartada, nenhuma atualização é aplicada e as que seriam aplicadas recebem -1 em
+ *       `results`. Sem o log, as atualizações gravadas antes do erro permanecem nos arquivos, com `BOOK_OK`.
+ * @note As estatísticas e o arquivo de colunas só são ajustados depois de confirmada a transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante todo o lote.
+ *
+ * @return Número de atualizações aplicadas, ou -1 em caso de erro de memória, de leitura ou de gravação.
+ */
+int updateBookRecords(Library *library, const BookUpdate *updates, int n, int *results);
+
+/**
+ * @brief Lê um livro a partir do seu código, sem exibir mensagens.
+ *
+ * @details O código é procurado na árvore 2-3 e o registro correspondente é lido do arquivo de dados. Com o acesso
+ *          concorrente ligado (`libraryEnableConcurrency`), a trava de leitura do índice é mantida durante a busca e a
+ *          leitura do registro, de modo que várias threads podem ler livros ao mesmo tempo, enquanto as inserções,
+ *          remoções e alterações de estoque aguardam.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param code Código do livro.
+ * @param book Ponteiro para a estrutura que recebe o livro lido.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @return `BOOK_OK` se o livro foi lido, `BOOK_NOT_FOUND` se o código não existir no índice, ou -1 em caso de erro.
+ */
+int readBookRecord(Library *library, int code, Book *book);
+
+/**
+ * @brief Lê um lote de livros a partir dos seus códigos, sem exibir mensagens.
+ *
+ * @details Os códigos são procurados de uma só vez com `twoThreeTreeSearchMany`, e os registros encontrados são lidos
+ *          em ordem crescente de posição no arquivo de dados, com registros consecutivos lidos em uma única leitura.
+ *          Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de leitura do índice é mantida
+ *          durante a busca e a leitura de todo o lote.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param codes Códigos dos livros, em qualquer ordem.
+ * @param n Número de códigos.
+ * @param books Vetor que recebe, na ordem de `codes`, o livro de cada código. O campo `code` dos livros não
+ *              encontrados é -1.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @return Número de livros encontrados, ou -1 em caso de erro de memória ou de leitura.
+ */
+int readBookRecords(Library *library, const int *codes, int n, Book *books);
+
+/**
+ * @brief Coleta dados de um livro do usuário e os adiciona à biblioteca.
+ *
+ * @param library Ponteiro para o handle da biblioteca onde o livro será adicionado.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ */
+void registerBook(Library *library);
+
+/**
+ * @brief Busca e exibe livros de um autor específico.
+ *
+ * @details Quando o índice de autores da biblioteca está aberto, apenas os registros indicados pelo índice são lidos
+ *          e o autor de cada um é confirmado (descartando colisões do hash). Caso contrário, todos os registros do
+ *          arquivo de dados são percorridos em paralelo (`parallelScan`). Nos dois casos a comparação ignora
+ *          maiúsculas e espaços extras.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param autor Nome do autor pelo qual os livros devem ser buscados.
+ *
+ * @pre O ponteiro `autor` deve ser uma string válida que representa o nome do autor a ser buscado.
+ *
+ * @post Todos os livros do autor especificado são exibidos, ou uma mensagem é mostrada se nenhum livro for encontrado.
+ */
+void searchByAuthor(Library *library, const char *autor);
+
+/**
+ * @brief Busca e imprime informações dos livros com um título específico.
+ *
+ * @details Quando o índice de títulos da biblioteca está aberto, apenas os registros indicados pelo índice são
+ * lidos. Caso contrário, todos os registros do arquivo de dados são percorridos em paralelo (`parallelScan`). Nos dois
+ * casos a comparação ignora maiúsculas e espaços extras, e as informações de cada livro encontrado são exibidas.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param titulo O título do livro a ser pesquisado. Deve ser uma string não-nula.
+ */
+void searchByTitle(Library *library, const char *titulo);
+
+/**
+ * @brief Lista, em ordem de título, os livros cujo título começa pelo prefixo informado.
+ *
+ * @details Requer o índice de títulos aberto: a busca visita apenas os ramos da árvore que podem conter o prefixo,
+ *          o que permite usá-la para autocompletar sem percorrer o arquivo de dados.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param prefixo Início do título a ser buscado. A comparação ignora maiúsculas e espaços extras.
+ * @param limite Número máximo de livros exibidos (0 para não limitar).
+ *
+ * @return Número de livros exibidos, ou -1 se o índice de títulos não estiver aberto.
+ */
+int searchByTitlePrefix(Library *library, const char *prefixo, int limite);
+
+/**
+ * @brief Imprime os dados de um livro com base em seu código.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param codigo O código do livro a ser pesquisado.
+ */
+void printBookData(Library *library, int codigo);
+
+/**
+ * @brief Lista, em ordem de código, os livros com código no intervalo informado.
+ *
+ * @details O intervalo é percorrido com o cursor do índice (`treeRangeBegin`/`treeRangeNextBooks`), que lê os livros
+ *          em lotes. Nenhuma ordenação do arquivo de dados é necessária.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param codigoInicial Menor código do intervalo.
+ * @param codigoFinal Maior código do intervalo.
+ *
+ * @return Número de livros exibidos, ou -1 em caso de erro.
+ */
+int listBooksByCodeRange(Library *library, int codigoInicial, int codigoFinal);
+
+/**
+ * @brief Lista todos os livros da biblioteca, em ordem de código.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ */
+void listarTodosLivros(Library *library);
+
+/**
+ * @brief Retorna o total de livros registrados na biblioteca.
+ *
+ * O total é mantido no cabeçalho do arquivo de dados (`bookCount`) e atualizado a cada inserção e remoção, de modo
+ * que a consulta não precisa percorrer a árvore de índices.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ *
+ * @return O número de livros registrados.
+ */
+int calcularTotalLivrosRegistrados(Library *library);
+
+/**
+ * @brief Retorna a quantidade total de exemplares em estoque na biblioteca.
+ *
+ * O total é mantido no cabeçalho do arquivo de dados (`stockTotal`) e atualizado a cada inserção, remoção e
+ * alteração de estoque, de modo que a consulta não precisa percorrer o arquivo de dados.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ *
+ * @return A soma das quantidades em estoque dos livros registrados.
+ */
+long long calcularTotalLivrosEmEstoque(Library *library);
+
+/**
+ * @brief Calcula o total de livros e de exemplares em estoque com um determinado autor, editora ou ano.
+ *
+ * @details Quando as estatísticas da biblioteca estão abertas (`libraryOpenStats`), o resultado é obtido diretamente
+ *          dos contadores. Sem elas, o total é calculado sobre as colunas (`libraryOpenColumns`), se estiverem
+ *          abertas: o ano é comparado diretamente e o autor e a editora, pelo identificador no dicionário do campo;
+ *          nos demais casos, o arquivo de dados é percorrido em paralelo (`parallelScan`), ignorando os registros
+ *          removidos.
+ *          A comparação ignora maiúsculas e espaços extras.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param campo Campo agrupado (`BOOK_STATS_AUTHOR`, `BOOK_STATS_PUBLISHER` ou `BOOK_STATS_YEAR`).
+ * @param valor Valor procurado (nome do autor, da editora ou o ano em texto).
+ * @param estoque Ponteiro onde a soma do estoque será armazenada (pode ser NULL).
+ *
+ * @return O número de livros com o valor informado, ou -1 em caso de erro de leitura.
+ */
+int calcularTotalLivrosPorCampo(Library *library, BookStatsField campo, const char *valor, int *estoque);
+
+/**
+ * @brief Exibe o total de livros e de exemplares em estoque de cada autor ou de cada editora.
+ *
+ * @details Com as colunas abertas (`libraryOpenColumns`), os livros são agrupados pelo identificador do valor no
+ *          dicionário do campo, em uma única passagem pela coluna de identificadores. Caso contrário, são exibidos
+ *          os contadores das estatísticas (`libraryOpenStats`) ou, sem elas, os contadores obtidos percorrendo o
+ *          arquivo de dados em paralelo (`parallelScan`). Os valores são exibidos normalizados.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param campo Campo agrupado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ *
+ * @return O número de valores exibidos, ou -1 em caso de erro de leitura ou de memória.
+ */
+int listarTotaisPorCampo(Library *library, BookStatsField campo);
+
+/**
+ * @brief Calcula as estatísticas de preço dos livros registrados.
+ *
+ * @details Com as colunas abertas (`libraryOpenColumns`), apenas as colunas de preço e de estoque são percorridas.
+ *          Caso contrário, o arquivo de dados é percorrido em paralelo (`parallelScan`), ignorando os registros
+ *          removidos.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param stats Ponteiro para as estatísticas a serem preenchidas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+int calcularEstatisticasPreco(Library *library, ColumnStorePriceStats *stats);
 
 #endif /* BOOK_MANAGER_H */
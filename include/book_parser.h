@@ -0,0 +1,114 @@
+/**
+ * @file book_parser.h
+ * @see book_parser.c
+ *
+ * @brief Contém o leitor do formato texto de importação de livros.
+ *
+ * Cada linha do arquivo texto descreve um livro, com os campos separados por ponto e vírgula:
+ * `código;título;autor;editora;edição;ano;preço;estoque`. Campos adicionais no final da linha são ignorados.
+ *
+ * O leitor percorre o arquivo em blocos de `BOOK_PARSER_BLOCK_SIZE` bytes. As quebras de linha e os separadores são
+ * localizados com `memchr` diretamente no bloco, sem copiar a linha nem alterar o texto, e cada campo é convertido e
+ * gravado no `Book` em uma única passada. Os campos de texto recebem a mesma normalização de `trimWhitespace`
+ * (espaços das extremidades removidos e espaços internos consecutivos reduzidos a um) e são truncados ao tamanho
+ * do campo; o preço aceita vírgula ou ponto como separador decimal.
+ *
+ * Linhas mal formadas (campos faltando, números inválidos) são ignoradas e reportadas com o seu número de linha; as
+ * linhas em branco são ignoradas silenciosamente.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef BOOK_PARSER_H
+#define BOOK_PARSER_H
+
+#include "book.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Tamanho (em bytes) dos blocos lidos do arquivo texto. Linhas maiores fazem o buffer crescer.
+ */
+#define BOOK_PARSER_BLOCK_SIZE (1 << 20)
+
+/**
+ * @brief Número máximo de linhas mal formadas reportadas individualmente por arquivo.
+ */
+#define BOOK_PARSER_MAX_REPORTED 20
+
+/**
+ * @brief Estrutura de Dados para a leitura de um arquivo texto de livros.
+ *
+ * - file: Arquivo texto.
+ * - buffer, capacity: Buffer dos blocos lidos e o seu tamanho.
+ * - start, end: Trecho do buffer ainda não consumido.
+ * - eof: 1 quando o final do arquivo foi alcançado.
+ * - line: Número da última linha lida (a primeira linha é a 1).
+ * - malformed: Número de linhas mal formadas ignoradas.
+ */
+typedef struct
+{
+    FILE *file;      // Arquivo texto
+    char *buffer;    // Blocos lidos
+    size_t capacity; // Tamanho do buffer
+    size_t start;    // Início do trecho não consumido
+    size_t end;      // Final do trecho lido
+    int eof;         // 1 quando o arquivo terminou
+    long line;       // Número da última linha lida
+    long malformed;  // Linhas mal formadas ignoradas
+} BookParser;
+
+/**
+ * @brief Abre um arquivo texto de livros para leitura.
+ *
+ * @param parser Ponteiro para o leitor a ser inicializado.
+ * @param filename Nome do arquivo texto.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser aberto ou faltar memória.
+ */
+int bookParserOpen(BookParser *parser, const char *filename);
+
+/**
+ * @brief Lê o próximo livro do arquivo, ignorando as linhas em branco e as mal formadas.
+ *
+ * @param parser Ponteiro para o leitor aberto.
+ * @param book Ponteiro para o livro a ser preenchido (todos os bytes são definidos).
+ *
+ * @return 1 se um livro foi lido, 0 no final do arquivo, -1 em caso de erro de leitura ou de memória.
+ *
+ * @note O número da linha do livro lido fica em `parser->line`.
+ */
+int bookParserNext(BookParser *parser, Book *book);
+
+/**
+ * @brief Fecha o arquivo e libera o buffer do leitor.
+ *
+ * @param parser Ponteiro para o leitor.
+ */
+void bookParserClose(BookParser *parser);
+
+/**
+ * @brief Converte uma linha do formato texto em um livro.
+ *
+ * @param line Início da linha (não precisa terminar com caractere nulo).
+ * @param length Tamanho da linha, sem a quebra de linha.
+ * @param book Ponteiro para o livro a ser preenchido. Os campos são preenchidos em ordem até o primeiro erro.
+ * @param error Ponteiro onde é armazenada a descrição do erro (pode ser NULL).
+ *
+ * @return 0 se a linha for válida, -1 se estiver mal formada ou tiver estoque negativo.
+ */
+int bookParseLine(const char *line, size_t length, Book *book, const char **error);
+
+/**
+ * @brief Converte um campo inteiro (com sinal opcional e espaços nas extremidades).
+ *
+ * @param start Início do campo.
+ * @param end Fim do campo (exclusivo).
+ * @param value Ponteiro onde o valor convertido será armazenado.
+ *
+ * @return 0 em caso de sucesso, -1 se o campo estiver vazio, tiver caracteres inválidos ou não couber em um `int`.
+ */
+int bookParseInt(const char *start, const char *end, int *value);
+
+#endif /* BOOK_PARSER_H */
@@ -0,0 +1,223 @@
+/**
+ * @file book_stats.h
+ * @see book_stats.c
+ *
+ * @brief Contém os contadores agregados de livros por autor, por editora e por ano de publicação.
+ *
+ * Para cada autor, editora e ano, o arquivo de estatísticas guarda o número de livros registrados e a soma dos
+ * exemplares em estoque. Os contadores ficam em memória em tabelas hash (endereçamento aberto) e são atualizados a
+ * cada inserção, remoção ou alteração de estoque, de modo que as consultas do submenu de quantidades não precisem
+ * percorrer o arquivo de dados. O arquivo é regravado por inteiro em `bookStatsFlush`.
+ *
+ * Os nomes de autores e editoras são normalizados (`normalizeString`) antes de servirem de chave, como no índice
+ * de autores.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef BOOK_STATS_H
+#define BOOK_STATS_H
+
+#include "book.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Tamanho máximo da chave de um contador (o maior campo agrupado é o autor).
+ */
+#define BOOK_STATS_KEY_SIZE sizeof(((Book *)0)->author)
+
+/**
+ * @brief Capacidade inicial de cada tabela de contadores (potência de 2).
+ */
+#define BOOK_STATS_INITIAL_CAPACITY 256
+
+/**
+ * @brief Campo pelo qual os livros são agrupados.
+ */
+typedef enum
+{
+    BOOK_STATS_AUTHOR,    // Agrupa pelo autor
+    BOOK_STATS_PUBLISHER, // Agrupa pela editora
+    BOOK_STATS_YEAR,      // Agrupa pelo ano de publicação
+    BOOK_STATS_FIELDS     // Número de campos agrupados
+} BookStatsField;
+
+/**
+ * @brief Estrutura de Dados para o cabeçalho do arquivo de estatísticas.
+ *
+ * - counts: Número de contadores gravados para cada campo, na ordem de `BookStatsField`.
+ */
+typedef struct
+{
+    int counts[BOOK_STATS_FIELDS]; // Contadores gravados por campo
+} BookStatsHeader;
+
+/**
+ * @brief Estrutura de Dados para um contador.
+ *
+ * - key: Valor normalizado do campo (string vazia se a entrada da tabela estiver livre).
+ * - books: Número de livros registrados com esse valor.
+ * - stock: Soma dos exemplares em estoque desses livros.
+ */
+typedef struct
+{
+    char key[BOOK_STATS_KEY_SIZE]; // Valor normalizado do campo
+    int books;                     // Livros registrados
+    int stock;                     // Exemplares em estoque
+} BookStatsEntry;
+
+/**
+ * @brief Tabela hash de contadores de um campo.
+ */
+typedef struct
+{
+    BookStatsEntry *entries; // Entradas da tabela
+    int capacity;            // Número de entradas (potência de 2)
+    int count;               // Entradas ocupadas
+} BookStatsTable;
+
+/**
+ * @brief Estatísticas abertas.
+ */
+typedef struct
+{
+    FILE *file;                               // Arquivo de estatísticas (NULL se não estiver aberto)
+    BookStatsTable tables[BOOK_STATS_FIELDS]; // Uma tabela por campo
+    int dirty;                                // 1 se os contadores precisam ser gravados
+} BookStats;
+
+/**
+ * @brief Normaliza um valor de campo (nome do autor, da editora ou o ano em texto) para ser usado como chave.
+ *
+ * @param value Valor a ser normalizado.
+ * @param key Destino da chave, com pelo menos `BOOK_STATS_KEY_SIZE` bytes.
+ *
+ * @note Valores vazios recebem a chave "-", já que a string vazia marca entradas livres das tabelas.
+ */
+void bookStatsValueKey(const char *value, char *key);
+
+/**
+ * @brief Monta a chave de um livro para o campo informado.
+ *
+ * @param book Ponteiro para o livro.
+ * @param field Campo agrupado.
+ * @param key Destino da chave, com pelo menos `BOOK_STATS_KEY_SIZE` bytes.
+ */
+void bookStatsKey(const Book *book, BookStatsField field, char *key);
+
+/**
+ * @brief Inicializa uma tabela de contadores vazia, sem arquivo associado.
+ *
+ * @param table Ponteiro para a tabela.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int bookStatsTableInit(BookStatsTable *table);
+
+/**
+ * @brief Soma livros e exemplares ao contador de uma chave, criando-o se necessário.
+ *
+ * @param table Ponteiro para a tabela inicializada.
+ * @param key Chave já normalizada (com `bookStatsKey` ou `bookStatsValueKey`).
+ * @param books Número de livros a somar.
+ * @param stock Número de exemplares a somar.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int bookStatsTableAdd(BookStatsTable *table, const char *key, int books, int stock);
+
+/**
+ * @brief Libera as entradas de uma tabela de contadores.
+ *
+ * @param table Ponteiro para a tabela.
+ */
+void bookStatsTableFree(BookStatsTable *table);
+
+/**
+ * @brief Cria um novo arquivo de estatísticas vazio.
+ *
+ * @pre `stats` e `filename` não devem ser NULL.
+ *
+ * @post O arquivo é criado (ou truncado) e as tabelas de contadores estão vazias em memória.
+ *
+ * @param stats Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo de estatísticas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int bookStatsCreate(BookStats *stats, const char *filename);
+
+/**
+ * @brief Abre um arquivo de estatísticas existente, carregando os contadores para a memória.
+ *
+ * @pre `stats` e `filename` não devem ser NULL.
+ *
+ * @param stats Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo de estatísticas.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser lido ou estiver inconsistente.
+ */
+int bookStatsOpen(BookStats *stats, const char *filename);
+
+/**
+ * @brief Contabiliza um livro inserido.
+ *
+ * @param stats Ponteiro para as estatísticas abertas.
+ * @param book Ponteiro para o livro inserido.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int bookStatsAddBook(BookStats *stats, const Book *book);
+
+/**
+ * @brief Desconta um livro removido.
+ *
+ * @param stats Ponteiro para as estatísticas abertas.
+ * @param book Ponteiro para o livro removido (como estava gravado no arquivo de dados).
+ */
+void bookStatsRemoveBook(BookStats *stats, const Book *book);
+
+/**
+ * @brief Registra a alteração do estoque de um livro.
+ *
+ * @param stats Ponteiro para as estatísticas abertas.
+ * @param book Ponteiro para o livro.
+ * @param delta Variação da quantidade em estoque (negativa para saídas).
+ */
+void bookStatsAdjustStock(BookStats *stats, const Book *book, int delta);
+
+/**
+ * @brief Consulta o contador de um valor de campo.
+ *
+ * @param stats Ponteiro para as estatísticas abertas.
+ * @param field Campo agrupado.
+ * @param value Valor procurado (nome do autor, da editora ou o ano em texto). É normalizado antes da consulta.
+ * @param books Ponteiro onde o número de livros será armazenado.
+ * @param stock Ponteiro onde a soma do estoque será armazenada.
+ *
+ * @note Valores sem livros registrados produzem 0 em `books` e `stock`.
+ */
+void bookStatsLookup(const BookStats *stats, BookStatsField field, const char *value, int *books, int *stock);
+
+/**
+ * @brief Grava os contadores no arquivo, se tiverem sido alterados.
+ *
+ * @param stats Ponteiro para as estatísticas.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int bookStatsFlush(BookStats *stats);
+
+/**
+ * @brief Grava os contadores, fecha o arquivo e libera as tabelas.
+ *
+ * @param stats Ponteiro para as estatísticas.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ *
+ * @post `stats->file` é definido como NULL.
+ */
+int bookStatsClose(BookStats *stats);
+
+#endif /* BOOK_STATS_H */
@@ -0,0 +1,162 @@
+/**
+ * @file bplus_tree.h
+ * @see bplus_tree.c
+ *
+ * @brief Contém o modo B+ do arquivo de índices, com nós do tamanho de uma página.
+ *
+ * Quando o arquivo de índices é criado com ordem maior que `TWO_THREE_TREE_ORDER`, `insertKey`, `removeKey` e
+ * `twoThreeTreeSearch` passam a operar sobre uma árvore B+ cujos nós ocupam uma página de `BPLUS_PAGE_SIZE` bytes.
+ * Os nós internos guardam apenas chaves e filhos; as posições dos livros ficam somente nas folhas, que são
+ * encadeadas da esquerda para a direita para que varreduras por intervalo sejam sequenciais.
+ *
+ * Os endereços dos nós são deslocamentos (em bytes) no arquivo de índices, sempre múltiplos de `BPLUS_PAGE_SIZE`.
+ * A primeira página é reservada para o cabeçalho do arquivo.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef BPLUS_TREE_H
+#define BPLUS_TREE_H
+
+#include "two_three_tree.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Tamanho (em bytes) de uma página do arquivo de índices no modo B+.
+ */
+#define BPLUS_PAGE_SIZE 4096
+
+/**
+ * @brief Maior ordem (número máximo de filhos de um nó) que cabe em uma página.
+ */
+#define BPLUS_MAX_ORDER 510
+
+/**
+ * @brief Estrutura de Dados para um nó (página) da árvore B+.
+ *
+ * - isLeaf: 1 se o nó é uma folha.
+ * - nKeys: Número de chaves do nó (no máximo `ordem - 1` no arquivo).
+ * - next: Nas folhas, endereço da próxima folha (-1 na última). Não utilizado nos nós internos.
+ * - keys: Chaves em ordem crescente.
+ * - values: Nas folhas, `values[i]` é a posição do livro de `keys[i]`. Nos nós internos, `values[i]` é o filho com
+ *           as chaves menores que `keys[i]` e `values[nKeys]` o filho com as chaves maiores ou iguais a `keys[nKeys - 1]`.
+ *
+ * @note Os vetores têm uma posição a mais que o necessário para que um nó possa transbordar em memória antes de ser
+ *       dividido. O tamanho da estrutura é exatamente `BPLUS_PAGE_SIZE`.
+ */
+typedef struct
+{
+    int isLeaf;
+    int nKeys;
+    int next;
+    int keys[BPLUS_MAX_ORDER];
+    int values[BPLUS_MAX_ORDER + 1];
+} BPlusNode;
+
+/**
+ * @brief Carrega um nó da árvore B+ do arquivo de índices.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param address Endereço (deslocamento) do nó.
+ * @param node Ponteiro onde o nó lido será armazenado.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+int bplusTreeLoadNode(FILE *indexFile, int address, BPlusNode *node);
+
+/**
+ * @brief Busca uma chave na árvore B+.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ * @param key Chave a ser buscada.
+ *
+ * @return Posição do livro associado à chave, ou -1 se a chave não for encontrada.
+ */
+int bplusTreeSearch(FILE *indexFile, const IndexFileHeader *header, int key);
+
+/**
+ * @brief Busca um lote de chaves, em ordem crescente, na árvore B+.
+ *
+ * As chaves são distribuídas entre os filhos de cada nó interno visitado, de modo que cada nó é lido uma única vez
+ * para todas as chaves do lote que passam por ele, e cada folha é percorrida junto com as chaves que lhe cabem.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ * @param keys Chaves a serem buscadas, em ordem crescente (podem se repetir).
+ * @param n Número de chaves.
+ * @param positions Vetor que recebe, na ordem de `keys`, a posição do livro de cada chave (-1 se não encontrada).
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+int bplusTreeSearchMany(FILE *indexFile, const IndexFileHeader *header, const int *keys, int n, int *positions);
+
+/**
+ * @brief Localiza a folha onde uma chave está (ou estaria) armazenada.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ * @param key Chave de referência.
+ * @param leaf Ponteiro onde a folha encontrada será armazenada.
+ *
+ * @return Endereço da folha, ou -1 se a árvore estiver vazia ou ocorrer erro de leitura.
+ *
+ * @note A partir da folha retornada, as chaves maiores podem ser percorridas em ordem seguindo o campo `next`.
+ */
+int bplusTreeFindLeaf(FILE *indexFile, const IndexFileHeader *header, int key, BPlusNode *leaf);
+
+/**
+ * @brief Insere uma chave e a posição do livro associado na árvore B+.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param key Chave a ser inserida.
+ * @param bookPosition Posição do livro no arquivo de dados.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices (atualizado quando a raiz muda ou páginas são alocadas).
+ *
+ * @return 0 em caso de sucesso, -1 se a chave já existir ou ocorrer erro de gravação.
+ */
+int bplusTreeInsert(FILE *indexFile, int key, int bookPosition, IndexFileHeader *header);
+
+/**
+ * @brief Remove uma chave da árvore B+.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param key Chave a ser removida.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ *
+ * @return 0 se a chave foi removida, -1 se não foi encontrada ou em caso de erro.
+ *
+ * @note A remoção é preguiçosa: a chave é retirada da folha, mas folhas com poucas chaves não são redistribuídas nem
+ *       fundidas. As chaves dos nós internos continuam válidas como separadores.
+ */
+int bplusTreeRemove(FILE *indexFile, int key, IndexFileHeader *header);
+
+/**
+ * @brief Constrói a árvore B+ de baixo para cima a partir de chaves já ordenadas.
+ *
+ * As folhas são preenchidas por completo e gravadas sequencialmente, seguidas dos níveis internos.
+ *
+ * @pre A árvore deve estar vazia e `keys` deve estar em ordem estritamente crescente.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param keys Vetor de chaves ordenadas.
+ * @param bookPositions Vetor com a posição do livro associada a cada chave.
+ * @param n Número de chaves.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ *
+ * @return O endereço da nova raiz, ou -1 em caso de erro.
+ */
+int bplusTreeBulkBuild(FILE *indexFile, const int *keys, const int *bookPositions, int n, IndexFileHeader *header);
+
+/**
+ * @brief Conta as chaves armazenadas na árvore B+, percorrendo o encadeamento das folhas.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ *
+ * @return Número de chaves, ou -1 em caso de erro de leitura.
+ */
+int bplusTreeCountKeys(FILE *indexFile, const IndexFileHeader *header);
+
+#endif /* BPLUS_TREE_H */
@@ -0,0 +1,105 @@
+/**
+ * @file code_filter.h
+ * @see code_filter.c
+ *
+ * @brief Contém o filtro de pertinência (filtro de Bloom com contadores) dos códigos de livros.
+ *
+ * O filtro mantém em memória `CODE_FILTER_COUNTERS_PER_KEY` contadores de 4 bits por código previsto. Cada código
+ * incrementa `CODE_FILTER_HASHES` contadores; a remoção os decrementa. Se algum dos contadores de um código for
+ * zero, o código certamente não está no índice, e a inserção pode dispensar a busca prévia por duplicados. Caso
+ * contrário, o código pode estar no índice (com probabilidade de falso positivo em torno de 1% enquanto o número
+ * de códigos não exceder a capacidade) e a busca é feita normalmente.
+ *
+ * Um contador que atinge o valor máximo deixa de ser alterado, mesmo nas remoções: o filtro pode passar a dar
+ * falsos positivos para esse contador, mas nunca falsos negativos.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef CODE_FILTER_H
+#define CODE_FILTER_H
+
+/**
+ * @brief Número de contadores por código previsto (cerca de 1% de falsos positivos com `CODE_FILTER_HASHES`).
+ */
+#define CODE_FILTER_COUNTERS_PER_KEY 10
+
+/**
+ * @brief Número de contadores alterados por código.
+ */
+#define CODE_FILTER_HASHES 7
+
+/**
+ * @brief Capacidade mínima (em códigos) de um filtro.
+ */
+#define CODE_FILTER_MIN_CAPACITY 1024
+
+/**
+ * @brief Estrutura de Dados para o filtro de códigos.
+ *
+ * - counters: Contadores de 4 bits, dois por byte (NULL se o filtro não estiver criado).
+ * - mask: Número de contadores menos 1 (o número de contadores é uma potência de 2).
+ * - keys: Número de códigos presentes no filtro.
+ * - capacity: Número de códigos para o qual o filtro foi dimensionado.
+ */
+typedef struct
+{
+    unsigned char *counters; // Contadores de 4 bits
+    unsigned long mask;      // Número de contadores menos 1
+    long keys;               // Códigos presentes
+    long capacity;           // Códigos previstos
+} CodeFilter;
+
+/**
+ * @brief Cria um filtro vazio dimensionado para `capacity` códigos.
+ *
+ * @param filter Ponteiro para o filtro.
+ * @param capacity Número de códigos previstos (no mínimo `CODE_FILTER_MIN_CAPACITY`).
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int codeFilterCreate(CodeFilter *filter, long capacity);
+
+/**
+ * @brief Libera a memória do filtro.
+ *
+ * @param filter Ponteiro para o filtro (pode não ter sido criado).
+ */
+void codeFilterDestroy(CodeFilter *filter);
+
+/**
+ * @brief Acrescenta um código ao filtro.
+ *
+ * @param filter Ponteiro para o filtro criado.
+ * @param code Código do livro.
+ */
+void codeFilterAdd(CodeFilter *filter, int code);
+
+/**
+ * @brief Retira do filtro um código acrescentado com `codeFilterAdd`.
+ *
+ * @param filter Ponteiro para o filtro criado.
+ * @param code Código do livro.
+ */
+void codeFilterRemove(CodeFilter *filter, int code);
+
+/**
+ * @brief Informa se um código pode estar no filtro.
+ *
+ * @param filter Ponteiro para o filtro criado.
+ * @param code Código do livro.
+ *
+ * @return 0 se o código certamente não está no filtro, 1 se pode estar.
+ */
+int codeFilterMayContain(const CodeFilter *filter, int code);
+
+/**
+ * @brief Informa se o filtro tem mais códigos do que a sua capacidade e deve ser reconstruído maior.
+ *
+ * @param filter Ponteiro para o filtro criado.
+ *
+ * @return 1 se o número de códigos excede a capacidade, 0 caso contrário.
+ */
+int codeFilterIsFull(const CodeFilter *filter);
+
+#endif /* CODE_FILTER_H */
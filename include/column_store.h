@@ -0,0 +1,265 @@
+/**
+ * @file column_store.h
+ * @see column_store.c
+ *
+ * @brief Contém o arquivo de colunas com os campos numéricos e os campos codificados por dicionário dos livros.
+ *
+ * O arquivo de colunas guarda, para cada posição do arquivo de dados, o código, o ano, a edição, o estoque e o
+ * preço do livro em vetores separados (uma coluna por campo), além de um mapa de bits das posições removidas
+ * ou livres. As agregações sobre esses campos percorrem apenas as colunas necessárias, cerca de 24 bytes por
+ * livro em vez de um `Book` completo.
+ *
+ * O autor e a editora, que se repetem muito no catálogo, são codificados por dicionário: cada valor normalizado
+ * (como as chaves de `book_stats.h`) recebe um identificador em um `StringDictionary`, e as colunas `authorIds` e
+ * `publisherIds` guardam apenas esse identificador. Os totais por autor e por editora comparam inteiros em vez de
+ * strings. Os dicionários são gravados ao lado do arquivo de colunas, em `<nome>.autores` e `<nome>.editoras`.
+ *
+ * As posições removidas ficam com valores neutros nas colunas (estoque e preço 0, ano `COLUMN_STORE_NO_YEAR`,
+ * identificadores -1), de modo que as somas e contagens percorrem as colunas sem desvios e podem ser vetorizadas
+ * pelo compilador.
+ *
+ * As colunas ficam em memória enquanto o arquivo está aberto; em `columnStoreFlush`, apenas o intervalo de
+ * posições alterado desde a última gravação é regravado (ou o arquivo inteiro, se as colunas cresceram).
+ *
+ * Formato do arquivo: `ColumnStoreHeader` seguido das colunas `codes`, `years`, `editions`, `stocks`, `authorIds`,
+ * `publisherIds` (`int`), `prices` (`double`) e do mapa de bits `deleted`, cada uma com `capacity` posições.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef COLUMN_STORE_H
+#define COLUMN_STORE_H
+
+#include "book.h"
+#include "book_stats.h"
+#include "string_dictionary.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Capacidade inicial (em posições) de cada coluna. Deve ser múltiplo de 64.
+ */
+#define COLUMN_STORE_INITIAL_CAPACITY 1024
+
+/**
+ * @brief Ano gravado nas posições removidas, que nunca coincide com um ano consultado.
+ */
+#define COLUMN_STORE_NO_YEAR INT_MIN
+
+/**
+ * @brief Estrutura de Dados para o cabeçalho do arquivo de colunas.
+ *
+ * - rowCount: Número de posições do arquivo de dados representadas (igual a `firstEmptyPosition`).
+ * - capacity: Número de posições reservadas em cada coluna do arquivo (múltiplo de 64).
+ */
+typedef struct
+{
+    int rowCount; // Posições representadas
+    int capacity; // Posições reservadas por coluna
+} ColumnStoreHeader;
+
+/**
+ * @brief Arquivo de colunas aberto.
+ */
+typedef struct
+{
+    FILE *file;                  // Arquivo de colunas (NULL se não estiver aberto)
+    ColumnStoreHeader header;    // Cabeçalho (versão válida)
+    int *codes;                  // Código de cada posição (-1 se removida)
+    int *years;                  // Ano de publicação
+    int *editions;               // Edição
+    int *stocks;                 // Exemplares em estoque
+    int *authorIds;              // Identificador do autor em `authors` (-1 se removida)
+    int *publisherIds;           // Identificador da editora em `publishers` (-1 se removida)
+    double *prices;              // Preço
+    uint64_t *deleted;           // Mapa de bits das posições removidas ou livres
+    int dirtyFirst;              // Primeira posição alterada desde a última gravação (-1 se nenhuma)
+    int dirtyLast;               // Última posição alterada desde a última gravação
+    int layoutDirty;             // 1 se o arquivo inteiro precisa ser regravado
+    StringDictionary authors;    // Dicionário dos autores
+    StringDictionary publishers; // Dicionário das editoras
+} ColumnStore;
+
+/**
+ * @brief Estrutura de Dados para as estatísticas de preço dos livros.
+ *
+ * - books: Número de livros considerados.
+ * - minPrice, maxPrice, averagePrice: Menor, maior e média dos preços (0 se não houver livros).
+ * - stockValue: Soma de preço vezes estoque de todos os livros.
+ */
+typedef struct
+{
+    int books;           // Livros considerados
+    double minPrice;     // Menor preço
+    double maxPrice;     // Maior preço
+    double averagePrice; // Preço médio
+    double stockValue;   // Valor total do estoque
+} ColumnStorePriceStats;
+
+/**
+ * @brief Cria um novo arquivo de colunas vazio.
+ *
+ * @pre `store` e `filename` não devem ser NULL.
+ *
+ * @param store Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo de colunas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int columnStoreCreate(ColumnStore *store, const char *filename);
+
+/**
+ * @brief Abre um arquivo de colunas existente, carregando as colunas e os dicionários para a memória.
+ *
+ * @pre `store` e `filename` não devem ser NULL.
+ *
+ * @param store Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo de colunas.
+ *
+ * @return 0 em caso de sucesso, -1 se algum arquivo não puder ser lido ou estiver inconsistente.
+ */
+int columnStoreOpen(ColumnStore *store, const char *filename);
+
+/**
+ * @brief Grava os campos de um livro na posição informada.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param position Posição do livro no arquivo de dados.
+ * @param book Ponteiro para o livro.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int columnStoreSet(ColumnStore *store, int position, const Book *book);
+
+/**
+ * @brief Marca a posição informada como removida.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param position Posição do livro removido no arquivo de dados.
+ */
+void columnStoreDelete(ColumnStore *store, int position);
+
+/**
+ * @brief Altera o estoque da posição informada.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param position Posição do livro no arquivo de dados.
+ * @param stock Novo estoque do livro.
+ */
+void columnStoreSetStock(ColumnStore *store, int position, int stock);
+
+/**
+ * @brief Altera o preço da posição informada.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param position Posição do livro no arquivo de dados.
+ * @param price Novo preço do livro.
+ */
+void columnStoreSetPrice(ColumnStore *store, int position, double price);
+
+/**
+ * @brief Remove todas as posições, mantendo o arquivo aberto.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ *
+ * @note Os dicionários são mantidos: os identificadores já atribuídos continuam válidos para as novas posições.
+ */
+void columnStoreClear(ColumnStore *store);
+
+/**
+ * @brief Soma os exemplares em estoque de todos os livros.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ *
+ * @return O total de exemplares em estoque.
+ */
+long columnStoreStockTotal(const ColumnStore *store);
+
+/**
+ * @brief Conta os livros de um ano de publicação e soma os seus exemplares em estoque.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param year Ano de publicação.
+ * @param stock Ponteiro onde a soma do estoque será armazenada (pode ser NULL).
+ *
+ * @return O número de livros do ano informado.
+ */
+int columnStoreCountByYear(const ColumnStore *store, int year, int *stock);
+
+/**
+ * @brief Conta os livros com um autor ou uma editora e soma os seus exemplares em estoque.
+ *
+ * O valor é normalizado e procurado uma única vez no dicionário; a contagem compara apenas identificadores.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param field Campo consultado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ * @param value Valor procurado (a comparação ignora maiúsculas e espaços extras).
+ * @param stock Ponteiro onde a soma do estoque será armazenada (pode ser NULL).
+ *
+ * @return O número de livros com o valor informado.
+ */
+int columnStoreCountByValue(const ColumnStore *store, BookStatsField field, const char *value, int *stock);
+
+/**
+ * @brief Retorna o número de valores distintos do dicionário de um campo.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param field Campo consultado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ *
+ * @return O número de identificadores atribuídos (inclusive os de valores sem livros no momento).
+ */
+int columnStoreDistinctValues(const ColumnStore *store, BookStatsField field);
+
+/**
+ * @brief Retorna o valor normalizado de um identificador do dicionário de um campo.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param field Campo consultado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ * @param id Identificador (entre 0 e `columnStoreDistinctValues - 1`).
+ *
+ * @return O valor normalizado.
+ */
+const char *columnStoreValue(const ColumnStore *store, BookStatsField field, int id);
+
+/**
+ * @brief Agrupa os livros por autor ou por editora.
+ *
+ * Os vetores são indexados pelo identificador do valor no dicionário, de modo que o agrupamento percorre as
+ * colunas uma única vez, sem tabela hash nem comparações de strings.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param field Campo agrupado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ * @param books Vetor com `columnStoreDistinctValues` posições que receberá o número de livros de cada valor.
+ * @param stocks Vetor com `columnStoreDistinctValues` posições que receberá o estoque de cada valor.
+ */
+void columnStoreGroupCounts(const ColumnStore *store, BookStatsField field, int *books, int *stocks);
+
+/**
+ * @brief Calcula as estatísticas de preço dos livros.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param stats Ponteiro para as estatísticas a serem preenchidas.
+ */
+void columnStorePriceStats(const ColumnStore *store, ColumnStorePriceStats *stats);
+
+/**
+ * @brief Grava no arquivo as posições alteradas desde a última gravação e os valores novos dos dicionários.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int columnStoreFlush(ColumnStore *store);
+
+/**
+ * @brief Grava as alterações pendentes e fecha o arquivo de colunas.
+ *
+ * @param store Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int columnStoreClose(ColumnStore *store);
+
+#endif /* COLUMN_STORE_H */
@@ -0,0 +1,174 @@
+/**
+ * @file compact_book_file.h
+ * @see compact_book_file.c
+ *
+ * @brief Contém o formato compacto do arquivo de livros e a conversão entre ele e o arquivo de dados.
+ *
+ * No arquivo de dados, cada livro ocupa um `Book` completo (mais de 430 bytes), quase todo formado pelo espaço
+ * reservado para o título, o autor e a editora. No formato compacto, cada livro ocupa um registro de tamanho fixo
+ * apenas com os campos numéricos (`CompactBookRecord`), e os textos são gravados sem terminador nem preenchimento
+ * em uma área de textos separada, no final do arquivo:
+ *
+ * @code
+ * CompactBookFileHeader | CompactBookRecord[bookCount] | textos (heapSize bytes)
+ * @endcode
+ *
+ * Os registros e os textos seguem a mesma ordem, de modo que os textos de registros consecutivos também são
+ * consecutivos. Varreduras que só precisam dos campos numéricos (como o total em estoque) leem apenas os registros.
+ *
+ * O arquivo compacto é um formato de exportação: ele não tem lista de registros livres e os livros são
+ * renumerados a partir de 0. Por isso, `convertCompactToDataFile` monta um novo índice junto com o arquivo de
+ * dados obtido de volta.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef COMPACT_BOOK_FILE_H
+#define COMPACT_BOOK_FILE_H
+
+#include "book.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Identificador do formato compacto.
+ */
+#define COMPACT_BOOK_FILE_MAGIC 0x32464243u
+
+/**
+ * @brief Número de livros lidos e convertidos de cada vez.
+ */
+#define COMPACT_BOOK_FILE_BATCH 256
+
+/**
+ * @brief Estrutura de Dados para o cabeçalho do arquivo compacto.
+ *
+ * - magic: Deve ser `COMPACT_BOOK_FILE_MAGIC`.
+ * - bookCount: Número de registros do arquivo.
+ * - heapSize: Tamanho (em bytes) da área de textos.
+ * - stockTotal: Soma dos exemplares em estoque de todos os livros.
+ */
+typedef struct
+{
+    unsigned int magic;   // Identificador do formato
+    int bookCount;        // Número de registros
+    int heapSize;         // Tamanho da área de textos
+    long long stockTotal; // Soma dos exemplares em estoque
+} CompactBookFileHeader;
+
+/**
+ * @brief Estrutura de Dados para o registro de tamanho fixo de um livro no formato compacto.
+ *
+ * - code, edition, year, price, stock_quantity: Campos numéricos do livro.
+ * - textOffset: Posição (em bytes, a partir do início da área de textos) do título do livro. O autor e a editora
+ *   vêm logo em seguida.
+ * - titleLength, authorLength, publisherLength: Tamanho de cada texto, sem terminador.
+ */
+typedef struct
+{
+    int code;                      // Código do livro
+    int edition;                   // Edição
+    int year;                      // Ano de publicação
+    int stock_quantity;            // Exemplares em estoque
+    double price;                  // Preço
+    int textOffset;                // Início dos textos na área de textos
+    unsigned char titleLength;     // Tamanho do título
+    unsigned char authorLength;    // Tamanho do autor
+    unsigned char publisherLength; // Tamanho da editora
+} CompactBookRecord;
+
+/**
+ * @brief Arquivo compacto aberto para leitura.
+ */
+typedef struct
+{
+    FILE *file;                   // Arquivo (NULL se não estiver aberto)
+    CompactBookFileHeader header; // Cabeçalho do arquivo
+} CompactBookFile;
+
+/**
+ * @brief Abre um arquivo compacto para leitura.
+ *
+ * @param compact Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo compacto.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser aberto ou não estiver no formato compacto.
+ */
+int compactBookFileOpen(CompactBookFile *compact, const char *filename);
+
+/**
+ * @brief Lê registros consecutivos do arquivo compacto, sem os textos.
+ *
+ * @param compact Ponteiro para o arquivo aberto.
+ * @param first Número do primeiro registro.
+ * @param records Vetor onde os registros serão armazenados.
+ * @param maxRecords Capacidade do vetor `records`.
+ *
+ * @return Número de registros lidos (0 depois do último), ou -1 em caso de erro.
+ */
+int compactBookFileReadRecords(CompactBookFile *compact, int first, CompactBookRecord *records, int maxRecords);
+
+/**
+ * @brief Lê livros consecutivos e completos do arquivo compacto.
+ *
+ * Os textos dos livros lidos são carregados com uma única leitura da área de textos.
+ *
+ * @param compact Ponteiro para o arquivo aberto.
+ * @param first Número do primeiro livro.
+ * @param books Vetor onde os livros serão armazenados.
+ * @param maxBooks Capacidade do vetor `books` (no máximo `COMPACT_BOOK_FILE_BATCH`).
+ *
+ * @return Número de livros lidos (0 depois do último), ou -1 em caso de erro.
+ */
+int compactBookFileReadBooks(CompactBookFile *compact, int first, Book *books, int maxBooks);
+
+/**
+ * @brief Soma os exemplares em estoque lendo apenas os registros de tamanho fixo.
+ *
+ * @param compact Ponteiro para o arquivo aberto.
+ *
+ * @return O total de exemplares em estoque, ou -1 em caso de erro.
+ */
+long compactBookFileStockTotal(CompactBookFile *compact);
+
+/**
+ * @brief Fecha o arquivo compacto.
+ *
+ * @param compact Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int compactBookFileClose(CompactBookFile *compact);
+
+/**
+ * @brief Converte um arquivo de dados para o formato compacto.
+ *
+ * Os registros livres do arquivo de dados são descartados; os livros mantêm a ordem do arquivo de dados.
+ *
+ * @pre O arquivo de dados não deve estar aberto por uma biblioteca (o cabeçalho gravado deve estar atualizado).
+ *
+ * @param dataFilename Nome do arquivo de dados.
+ * @param compactFilename Nome do arquivo compacto a ser criado.
+ *
+ * @return O número de livros convertidos, ou -1 em caso de erro.
+ */
+int convertDataFileToCompact(const char *dataFilename, const char *compactFilename);
+
+/**
+ * @brief Converte um arquivo compacto de volta para o formato do arquivo de dados e monta o seu índice.
+ *
+ * O livro `i` do arquivo compacto é gravado na posição `i` do arquivo de dados, que fica sem registros livres. O
+ * índice é montado de baixo para cima com `twoThreeTreeBulkBuild` (na ordem `TWO_THREE_TREE_ORDER`), e os dois
+ * arquivos recebem a mesma marca de par.
+ *
+ * @param compactFilename Nome do arquivo compacto.
+ * @param dataFilename Nome do arquivo de dados a ser criado.
+ * @param indexFilename Nome do arquivo de índices a ser criado.
+ *
+ * @return O número de livros convertidos, ou -1 em caso de erro (ou de código repetido no arquivo compacto).
+ *
+ * @post Em caso de erro, os arquivos de dados e de índices são removidos.
+ */
+int convertCompactToDataFile(const char *compactFilename, const char *dataFilename, const char *indexFilename);
+
+#endif /* COMPACT_BOOK_FILE_H */
@@ -0,0 +1,69 @@
+/**
+ * @file compaction.h
+ * @see compaction.c
+ *
+ * @brief Contém a compactação dos arquivos de dados e de índices da biblioteca.
+ *
+ * Depois de muitas remoções, o arquivo de dados fica com registros livres espalhados e o índice com nós livres, que
+ * continuam sendo lidos pelas varreduras sequenciais. A compactação regrava o arquivo de dados sem espaços vazios,
+ * com os livros agrupados em ordem de código (a ordem do índice), e monta um novo índice de baixo para cima com as
+ * novas posições. Os dois arquivos são montados em arquivos temporários (`<nome>.tmp`, veja `LIBRARY_SWAP_SUFFIX`)
+ * com uma nova marca de par, sincronizados com o dispositivo e só então trocados pelos originais com
+ * `librarySwapFiles`. Os índices secundários e as colunas, que dependem das posições dos livros, são reconstruídos em
+ * seguida; as estatísticas não mudam.
+ *
+ * Em caso de erro antes da troca, os arquivos originais permanecem intactos e os temporários são apagados. Uma
+ * interrupção entre as duas renomeações da troca é concluída por `libraryOpenExisting` na próxima abertura.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef COMPACTION_H
+#define COMPACTION_H
+
+#include "library.h"
+
+/**
+ * @brief Número de livros lidos e gravados de cada vez durante a compactação.
+ */
+#define COMPACTION_BATCH_SIZE 256
+
+/**
+ * @brief Estrutura de Dados para o relatório de uma compactação.
+ *
+ * - bookCount: Número de livros gravados no novo arquivo de dados.
+ * - dataBytesBefore, dataBytesAfter: Tamanho (em bytes) do arquivo de dados antes e depois da compactação.
+ * - indexBytesBefore, indexBytesAfter: Tamanho (em bytes) do arquivo de índices antes e depois da compactação.
+ */
+typedef struct
+{
+    int bookCount;          // Livros gravados
+    long dataBytesBefore;   // Tamanho do arquivo de dados antes
+    long dataBytesAfter;    // Tamanho do arquivo de dados depois
+    long indexBytesBefore;  // Tamanho do arquivo de índices antes
+    long indexBytesAfter;   // Tamanho do arquivo de índices depois
+} CompactionReport;
+
+/**
+ * @brief Compacta os arquivos de dados e de índices da biblioteca.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen` e nenhuma transação pode estar aberta.
+ *
+ * @post O arquivo de dados contém apenas os livros do índice, em ordem de código e sem registros livres; o índice,
+ *       os índices secundários e as colunas abertos e as listas de unidades livres refletem as novas posições.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param report Ponteiro para o relatório a ser preenchido.
+ *
+ * @return O número de livros gravados, ou -1 em caso de erro.
+ */
+int compactLibrary(Library *library, CompactionReport *report);
+
+/**
+ * @brief Exibe o relatório de uma compactação.
+ *
+ * @param report Ponteiro para o relatório.
+ */
+void printCompactionReport(const CompactionReport *report);
+
+#endif /* COMPACTION_H */
@@ -14,6 +14,9 @@
 #ifndef FILE_MANAGER_H
 #define FILE_MANAGER_H
 
+#include "library.h"
+#include "page_allocator.h"
+
 #include <stdio.h>
 
 /**
@@ -51,6 +54,8 @@ FILE *openFile(const char *filename, const char *mode);
  * @return 0 se o arquivo foi fechado com sucesso, -1 caso contrário.
  *
  * @note Se ocorrer um erro ao fechar o arquivo, uma mensagem de erro será exibida com detalhes do erro.
+ *       O cabeçalho anexado ao arquivo e os nós mantidos no cache de nós são gravados antes do fechamento,
+ *       e o mapeamento em memória do arquivo, se houver, é desfeito.
  */
 int closeFile(FILE **file);
 
@@ -65,15 +70,30 @@ int closeFile(FILE **file);
  *
  * @return Nenhum.
  *
- * @note O cabeçalho do arquivo de índices é composto por três informações:
+ * @note Além do identificador, da versão, do tamanho dos nós, da geração e da marca do par, o cabeçalho do
+ *       arquivo de índices contém:
  *       - A raiz da árvore (`rootAddress`), inicialmente definida como -1 (indicando que a árvore está vazia).
- *       - A primeira posição livre (`firstEmptyPosition`), inicialmente definida como 0.
+ *       - A primeira posição livre (`firstEmptyPosition`), o endereço do primeiro nó, logo após o cabeçalho.
  *       - A cabeça de registros livres (`headEmptyPosition`), inicialmente definida como -1 (sem registros livres).
+ *       - A ordem da árvore (`order`), definida como `TWO_THREE_TREE_ORDER`.
  *
  * @warning A função assume que o arquivo foi aberto corretamente e está pronto para gravação. Não realiza verificação de erros na abertura do arquivo.
  */
 void createIndexFileHeader(FILE *file);
 
+/**
+ * @brief Cria o cabeçalho do arquivo de índices para uma árvore da ordem informada.
+ *
+ * Com ordem igual a `TWO_THREE_TREE_ORDER` o cabeçalho é o mesmo criado por `createIndexFileHeader`. Com ordem maior,
+ * o arquivo passa a usar o modo B+: a primeira página fica reservada para o cabeçalho e `firstEmptyPosition` aponta
+ * para a página seguinte.
+ *
+ * @param file Ponteiro para o arquivo de índices a ser modificado. O arquivo deve estar aberto em modo de escrita.
+ * @param order Número máximo de filhos por nó, entre `TWO_THREE_TREE_ORDER` e `BPLUS_MAX_ORDER`
+ *              (valores fora do intervalo são ajustados ao limite mais próximo).
+ */
+void createIndexFileHeaderWithOrder(FILE *file, int order);
+
 /**
  * @brief Cria o cabeçalho do arquivo de dados.
  *
@@ -85,14 +105,61 @@ void createIndexFileHeader(FILE *file);
  *
  * @return Nenhum.
  *
- * @note O cabeçalho do arquivo de dados é composto por duas informações:
+ * @note Além do identificador, da versão, do tamanho dos registros, da geração e da marca do par, o cabeçalho
+ *       do arquivo de dados contém:
  *       - A primeira posição livre (`firstEmptyPosition`), inicialmente definida como 0.
  *       - A cabeça de registros livres (`headEmptyPosition`), inicialmente definida como -1 (sem registros livres).
+ *       - O número de livros registrados (`bookCount`) e o total em estoque (`stockTotal`), inicialmente 0.
  *
  * @warning A função assume que o arquivo foi aberto corretamente e está pronto para gravação. Não realiza verificação de erros na abertura do arquivo.
  */
 void createBookDataFileHeader(FILE *file);
 
+/**
+ * @brief Inicializa o cabeçalho de um arquivo de dados vazio, sem gravá-lo.
+ *
+ * @param header Ponteiro para o cabeçalho a ser preenchido.
+ */
+void initBookDataFileHeader(BookDataFileHeader *header);
+
+/**
+ * @brief Gera a marca de um novo par de arquivos de dados e de índices (`pairStamp`).
+ *
+ * @param previous Marca do par substituído (ou 0), que nunca é repetida.
+ *
+ * @return A nova marca.
+ */
+unsigned int createFilePairStamp(unsigned int previous);
+
+/**
+ * @brief Verifica se o cabeçalho lido de um arquivo de dados existente é válido para este programa.
+ *
+ * São conferidos o identificador e a versão do formato, o tamanho dos registros e a coerência dos campos com o
+ * tamanho do arquivo.
+ *
+ * @param file Ponteiro para o arquivo de dados aberto.
+ * @param header Ponteiro para o cabeçalho lido do arquivo.
+ *
+ * @return 0 se o cabeçalho for válido, -1 caso contrário (o motivo é exibido no stderr).
+ *
+ * @note O total em estoque não é conferido: ele é derivado dos livros, e `libraryOpenExisting` o recalcula se for
+ *       negativo.
+ */
+int checkBookDataFileHeader(FILE *file, const BookDataFileHeader *header);
+
+/**
+ * @brief Verifica se o cabeçalho lido de um arquivo de índices existente é válido para este programa.
+ *
+ * São conferidos o identificador e a versão do formato, a ordem, o tamanho dos nós e a coerência dos endereços
+ * com o tamanho do arquivo.
+ *
+ * @param file Ponteiro para o arquivo de índices aberto.
+ * @param header Ponteiro para o cabeçalho lido do arquivo.
+ *
+ * @return 0 se o cabeçalho for válido, -1 caso contrário (o motivo é exibido no stderr).
+ */
+int checkIndexFileHeader(FILE *file, const IndexFileHeader *header);
+
 /**
  * @brief Lê o cabeçalho de um arquivo binário e armazena na estrutura fornecida.
  *
@@ -106,7 +173,8 @@ void createBookDataFileHeader(FILE *file);
  * @return 1 se o cabeçalho foi lido com sucesso, -1 em caso de erro.
  *
  * @note A função assume que o arquivo foi aberto corretamente em modo de leitura binária antes de ser chamada.
- *       A leitura será feita a partir do início do arquivo.
+ *       A leitura será feita a partir do início do arquivo. Se o cabeçalho estiver anexado ao arquivo
+ *       (`attachFileHeader`), a cópia em memória é retornada sem acesso ao arquivo.
  *
  * @warning Se ocorrer um erro ao ler o cabeçalho, uma mensagem de erro será exibida.
  */
@@ -126,11 +194,147 @@ int readFileHeader(FILE *file, void *header, size_t headerSize);
  * @return Nenhum.
  *
  * @note A função assume que o arquivo foi aberto corretamente em modo de escrita binária antes de ser chamada.
- *       O cabeçalho será escrito a partir do início do arquivo.
+ *       O cabeçalho será escrito a partir do início do arquivo. Se o cabeçalho estiver anexado ao arquivo
+ *       (`attachFileHeader`), apenas a cópia em memória é atualizada e a gravação ocorre em `flushFileHeader`.
  * 
  * @warning Não há verificação de erros durante a escrita do cabeçalho. É importante garantir que o arquivo esteja
  *          corretamente aberto e pronto para gravação antes de chamar a função.
  */
 void saveHeader(FILE *file, void *header, size_t headerSize);
 
+/**
+ * @brief Anexa um cabeçalho em memória a um arquivo binário.
+ *
+ * O cabeçalho é lido do arquivo para a estrutura fornecida, que passa a ser a versão válida do cabeçalho: as
+ * chamadas seguintes a `readFileHeader` e `saveHeader` para este arquivo operam apenas na memória, e o
+ * cabeçalho só é gravado no arquivo por `flushFileHeader` ou `detachFileHeader`.
+ *
+ * @pre O arquivo deve estar aberto em modo de leitura e escrita binária e já conter o cabeçalho.
+ * @pre `header` deve permanecer válido enquanto estiver anexado ao arquivo.
+ *
+ * @post O cabeçalho é carregado em `header` e anexado ao arquivo.
+ *
+ * @param file Ponteiro para o arquivo binário.
+ * @param header Ponteiro para a estrutura que manterá o cabeçalho em memória.
+ * @param headerSize Tamanho, em bytes, da estrutura do cabeçalho.
+ *
+ * @return 1 se o cabeçalho foi anexado com sucesso, -1 em caso de erro na leitura ou se não houver posição livre.
+ */
+int attachFileHeader(FILE *file, void *header, size_t headerSize);
+
+/**
+ * @brief Grava no arquivo o cabeçalho em memória, caso tenha sido modificado.
+ *
+ * @param file Ponteiro para o arquivo binário.
+ *
+ * @return 1 se o cabeçalho foi gravado ou não precisava ser gravado, -1 em caso de erro.
+ *
+ * @note Se o arquivo não tiver cabeçalho anexado, a função não faz nada e retorna 1.
+ */
+int flushFileHeader(FILE *file);
+
+/**
+ * @brief Grava e desanexa o cabeçalho em memória de um arquivo.
+ *
+ * @param file Ponteiro para o arquivo binário.
+ *
+ * @post As próximas chamadas a `readFileHeader` e `saveHeader` voltam a acessar o arquivo diretamente.
+ */
+void detachFileHeader(FILE *file);
+
+/**
+ * @brief Preenche o formato das unidades do arquivo de índices usado pelo alocador.
+ *
+ * Os nós livres são marcados com `nKeys` igual a 0 e encadeados por `left_child`; as páginas livres do modo B+ são
+ * marcadas com `isLeaf` igual a -1 e encadeadas por `next`. Os endereços são deslocamentos em bytes.
+ *
+ * @param header Ponteiro para o cabeçalho do arquivo de índices (a ordem define o formato).
+ * @param layout Ponteiro para o formato a ser preenchido.
+ */
+void getIndexLayout(const IndexFileHeader *header, PageAllocatorLayout *layout);
+
+/**
+ * @brief Preenche o formato das unidades do arquivo de dados usado pelo alocador.
+ *
+ * Os registros livres são `BookDataFreeNode` com `offset` igual a -1, e os endereços são números de registro.
+ *
+ * @param layout Ponteiro para o formato a ser preenchido.
+ */
+void getDataLayout(PageAllocatorLayout *layout);
+
+/**
+ * @brief Passa a alocar os nós (ou páginas, no modo B+) do arquivo de índices pelo alocador de unidades.
+ *
+ * Os nós livres são marcados com `nKeys` igual a 0 e encadeados por `left_child`; as páginas livres do modo B+ são
+ * marcadas com `isLeaf` igual a -1 e encadeadas por `next`. Os endereços são deslocamentos em bytes.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices, que deve permanecer válido enquanto o
+ *               arquivo estiver anexado.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo já estiver anexado), -1 em caso de erro.
+ */
+int attachIndexAllocator(FILE *indexFile, IndexFileHeader *header);
+
+/**
+ * @brief Passa a alocar os registros do arquivo de dados pelo alocador de unidades.
+ *
+ * Os registros livres são `BookDataFreeNode` com `offset` igual a -1, e os endereços são números de registro.
+ *
+ * @param dataFile Ponteiro para o arquivo de dados.
+ * @param header Ponteiro para o cabeçalho do arquivo de dados, que deve permanecer válido enquanto o
+ *               arquivo estiver anexado.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo já estiver anexado), -1 em caso de erro.
+ */
+int attachDataAllocator(FILE *dataFile, BookDataFileHeader *header);
+
+/**
+ * @brief Aloca um nó (ou página, no modo B+) do arquivo de índices.
+ *
+ * Se o arquivo ainda não estiver anexado ao alocador, ele é anexado com o cabeçalho informado.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ * @param hint Endereço de um nó próximo (por exemplo, o irmão do novo nó), ou -1 para o menor endereço livre.
+ *
+ * @return O endereço do nó alocado, ou -1 em caso de erro.
+ */
+int allocateIndexNode(FILE *indexFile, IndexFileHeader *header, int hint);
+
+/**
+ * @brief Carrega os livros de um arquivo texto para a biblioteca.
+ *
+ * Cada linha do arquivo texto contém os campos de um livro separados por ponto e vírgula. Os livros são
+ * adicionados um a um através de `addBook`, utilizando os cabeçalhos mantidos em memória pelo handle.
+ * Se a biblioteca estiver vazia, a carga é feita em lote por `loadTextFileBulk`.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param textFilename Nome do arquivo texto a ser carregado.
+ *
+ * @post Os livros do arquivo texto são adicionados à biblioteca e as alterações são gravadas com `libraryCommit`.
+ */
+void loadTextFile(Library *library, const char *textFilename);
+
+/**
+ * @brief Carrega um arquivo texto em lote, construindo o índice de baixo para cima.
+ *
+ * Todas as linhas do arquivo texto são lidas para a memória e ordenadas pelo código do livro. Os livros são então
+ * gravados sequencialmente no arquivo de dados (agrupados por código) e a árvore 2-3 é montada em uma única passada
+ * sequencial por `twoThreeTreeBulkBuild`, sem buscas de duplicidade nem divisões de nós por livro.
+ *
+ * @pre A biblioteca deve estar vazia (sem livros no arquivo de dados e sem raiz no índice).
+ *
+ * @post Os livros são gravados e indexados. Livros com código repetido são ignorados (vale a primeira ocorrência)
+ *       e reportados em um único resumo ao final da carga; linhas mal formadas são ignoradas e reportadas pelo
+ *       leitor do arquivo texto (`bookParserNext`).
+ * @post Em caso de erro, a biblioteca continua vazia e nada é gravado com `libraryCommit`.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param textFilename Nome do arquivo texto a ser carregado.
+ *
+ * @return O número de livros carregados, ou -1 em caso de erro.
+ */
+int loadTextFileBulk(Library *library, const char *textFilename);
+
 #endif /* FILE_MANAGER_H */
@@ -0,0 +1,160 @@
+/**
+ * @file file_report.h
+ * @see file_report.c
+ *
+ * @brief Contém os relatórios de diagnóstico dos arquivos da biblioteca: a impressão do índice por níveis e as listas
+ *        de nós e de registros livres.
+ *
+ * O índice é percorrido em largura, um nível de cada vez. Os nós de um nível são lidos em grupos de até
+ * `FILE_REPORT_BUFFER_BYTES` bytes: os endereços do grupo são ordenados e os nós próximos no arquivo são lidos em uma
+ * única leitura (lacunas de até `FILE_REPORT_MAX_GAP` bytes são lidas e descartadas), em vez de uma leitura por nó. A
+ * memória usada é a dos endereços de dois níveis consecutivos mais a de um grupo, independentemente do tamanho dos
+ * nós e do número de níveis.
+ *
+ * As listas de livres são percorridas pelo encadeamento gravado no arquivo, sem guardar os endereços visitados; um
+ * encadeamento com mais elementos que unidades no arquivo, ou que passe por uma unidade não marcada como livre, é
+ * reportado como corrompido. Antes de qualquer relatório, as alterações pendentes são gravadas (`libraryCommit`),
+ * para que os nós em cache e as listas de livres do alocador estejam no arquivo.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef FILE_REPORT_H
+#define FILE_REPORT_H
+
+#include "library.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Tamanho (em bytes) de cada grupo de nós lidos de um nível.
+ */
+#define FILE_REPORT_BUFFER_BYTES (1 << 18)
+
+/**
+ * @brief Maior lacuna (em bytes) entre dois nós de um grupo lidos na mesma leitura.
+ */
+#define FILE_REPORT_MAX_GAP 4096
+
+/**
+ * @brief Número máximo de níveis do índice.
+ */
+#define FILE_REPORT_MAX_LEVELS 64
+
+/**
+ * @brief Número máximo de nós impressos por nível e de endereços impressos por lista de livres.
+ */
+#define FILE_REPORT_MAX_PRINTED 64
+
+/**
+ * @brief Estrutura de Dados para as estatísticas de um nível do índice.
+ *
+ * - nodes: Número de nós do nível.
+ * - keys: Número de chaves dos nós do nível.
+ */
+typedef struct
+{
+    long nodes; // Nós do nível
+    long keys;  // Chaves do nível
+} IndexLevelStats;
+
+/**
+ * @brief Estrutura de Dados para o relatório do índice por níveis.
+ *
+ * - order: Ordem do índice (`TWO_THREE_TREE_ORDER` para a árvore 2-3).
+ * - maxKeys: Número máximo de chaves por nó (`order - 1`).
+ * - height: Número de níveis (0 para a árvore vazia).
+ * - nodes, keys: Totais de nós e de chaves de todos os níveis.
+ * - totalUnits: Número de nós (ou páginas) da área de nós do arquivo, em uso ou livres.
+ * - freeUnits: Número de nós (ou páginas) livres, segundo o alocador.
+ * - reads: Número de leituras feitas no arquivo durante o percurso.
+ * - levels: Estatísticas de cada nível, a partir da raiz.
+ */
+typedef struct
+{
+    int order;                                      // Ordem do índice
+    int maxKeys;                                    // Chaves por nó
+    int height;                                     // Número de níveis
+    long nodes;                                     // Total de nós
+    long keys;                                      // Total de chaves
+    long totalUnits;                                // Nós da área de nós
+    long freeUnits;                                 // Nós livres
+    long reads;                                     // Leituras feitas
+    IndexLevelStats levels[FILE_REPORT_MAX_LEVELS]; // Estatísticas por nível
+} IndexLevelReport;
+
+/**
+ * @brief Arquivo de uma lista de livres.
+ */
+typedef enum
+{
+    FREE_LIST_INDEX, // Nós (ou páginas) livres do arquivo de índices
+    FREE_LIST_DATA   // Registros livres do arquivo de dados
+} FreeListKind;
+
+/**
+ * @brief Estrutura de Dados para o relatório de uma lista de livres.
+ *
+ * - kind: Arquivo da lista.
+ * - totalUnits: Número de unidades (nós, páginas ou registros) da área de unidades do arquivo.
+ * - freeUnits: Número de unidades encontradas no encadeamento gravado no arquivo.
+ * - allocatorFree: Número de unidades livres segundo o alocador (-1 se o arquivo não estiver anexado).
+ * - first, last: Endereços da primeira e da última unidade do encadeamento (-1 se a lista estiver vazia).
+ * - corrupted: 1 se o encadeamento passar por uma unidade inválida ou não marcada como livre, ou tiver um ciclo.
+ */
+typedef struct
+{
+    FreeListKind kind;  // Arquivo da lista
+    long totalUnits;    // Unidades do arquivo
+    long freeUnits;     // Unidades do encadeamento
+    long allocatorFree; // Unidades livres no alocador
+    int first;          // Primeira unidade
+    int last;           // Última unidade
+    int corrupted;      // 1 se o encadeamento estiver corrompido
+} FreeListReport;
+
+/**
+ * @brief Percorre o índice em largura e calcula as estatísticas de cada nível.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param report Ponteiro para o relatório a ser preenchido.
+ * @param output Arquivo onde as chaves dos nós de cada nível são impressas (até `FILE_REPORT_MAX_PRINTED` nós por
+ *               nível), ou NULL para calcular apenas as estatísticas.
+ *
+ * @return A altura do índice, ou -1 em caso de erro de leitura, de memória ou de um índice inconsistente.
+ */
+int reportIndexLevels(Library *library, IndexLevelReport *report, FILE *output);
+
+/**
+ * @brief Exibe as estatísticas do relatório do índice por níveis.
+ *
+ * @param report Ponteiro para o relatório preenchido por `reportIndexLevels`.
+ */
+void printIndexLevelReport(const IndexLevelReport *report);
+
+/**
+ * @brief Percorre a lista de nós livres do índice ou a de registros livres do arquivo de dados.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param kind Arquivo da lista.
+ * @param report Ponteiro para o relatório a ser preenchido.
+ * @param output Arquivo onde os endereços da lista são impressos (até `FILE_REPORT_MAX_PRINTED`), ou NULL.
+ *
+ * @return O número de unidades da lista, ou -1 em caso de erro de leitura.
+ *
+ * @note Uma lista corrompida não é um erro: o percurso é interrompido e `report->corrupted` recebe 1.
+ */
+long reportFreeList(Library *library, FreeListKind kind, FreeListReport *report, FILE *output);
+
+/**
+ * @brief Exibe as estatísticas do relatório de uma lista de livres.
+ *
+ * @param report Ponteiro para o relatório preenchido por `reportFreeList`.
+ */
+void printFreeListReport(const FreeListReport *report);
+
+#endif /* FILE_REPORT_H */
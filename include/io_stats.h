@@ -0,0 +1,157 @@
+/**
+ * @file io_stats.h
+ * @see io_stats.c
+ *
+ * @brief Contém a instrumentação opcional das leituras e gravações de nós, cabeçalhos e registros.
+ *
+ * Compilada com `TWO_THREE_IO_STATS` definido (por exemplo, `make IO_STATS=1`), a instrumentação conta as chamadas,
+ * os bytes e os nanossegundos de cada acesso ao armazenamento feito por `loadNode23`, `saveNode`, pelos nós da
+ * árvore B+, por `readFileHeader`, `saveHeader` e pelas leituras e gravações de registros do arquivo de dados. Os
+ * contadores são separados por operação lógica (inserção, remoção, busca e alteração de livros; os acessos fora de
+ * uma operação, como o commit, ficam em "outros") e, para os nós, por nível da árvore (a raiz é o nível 0). Os
+ * níveis são atribuídos nas descidas da árvore 2-3 e na busca de folha da árvore B+; os demais acessos a nós B+
+ * ficam com o último nível definido na thread.
+ *
+ * Os acessos que não chegam ao arquivo (nós encontrados no cache, cabeçalhos anexados em memória) não são contados:
+ * os contadores medem a entrada e saída real. Uma gravação adiada pelo cache de nós é contada quando chega ao
+ * arquivo, normalmente no commit, sem nível atribuído.
+ *
+ * Sem `TWO_THREE_IO_STATS`, as macros de instrumentação se reduzem às chamadas de `storageRead` e `storageWrite`
+ * (ou a nada), sem nenhum custo; as funções de consulta continuam disponíveis e informam que a instrumentação não
+ * foi compilada.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef IO_STATS_H
+#define IO_STATS_H
+
+#include "storage.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Número de níveis da árvore com contadores próprios; níveis mais profundos são somados ao último.
+ */
+#define IO_STATS_MAX_LEVELS 32
+
+/**
+ * @brief Tipos de acesso instrumentados.
+ */
+typedef enum
+{
+    IO_STATS_NODE_READ,    // Leitura de um nó do índice
+    IO_STATS_NODE_WRITE,   // Gravação de um nó do índice
+    IO_STATS_HEADER_READ,  // Leitura de um cabeçalho
+    IO_STATS_HEADER_WRITE, // Gravação de um cabeçalho
+    IO_STATS_RECORD_READ,  // Leitura de registros do arquivo de dados
+    IO_STATS_RECORD_WRITE, // Gravação de registros do arquivo de dados
+    IO_STATS_SITE_COUNT
+} IoStatsSite;
+
+/**
+ * @brief Operações lógicas às quais os acessos são atribuídos.
+ */
+typedef enum
+{
+    IO_STATS_OP_OTHER,  // Acessos fora de uma operação (commit, carga, compactação, ...)
+    IO_STATS_OP_INSERT, // Inserção de livro ou de chave
+    IO_STATS_OP_REMOVE, // Remoção de livro ou de chave
+    IO_STATS_OP_SEARCH, // Busca de chave e leitura de livros
+    IO_STATS_OP_UPDATE, // Alteração do estoque de um livro
+    IO_STATS_OP_COUNT
+} IoStatsOperation;
+
+/**
+ * @brief Contadores de um tipo de acesso.
+ */
+typedef struct
+{
+    long long calls;       // Chamadas
+    long long bytes;       // Bytes transferidos
+    long long nanoseconds; // Tempo total das chamadas
+} IoStatsCounter;
+
+/**
+ * @brief Cópia dos contadores da instrumentação.
+ *
+ * - operations: Número de operações lógicas executadas, por operação.
+ * - sites: Contadores por operação e por tipo de acesso.
+ * - levels: Leituras (índice 0) e gravações (índice 1) de nós por nível da árvore.
+ */
+typedef struct
+{
+    long long operations[IO_STATS_OP_COUNT];
+    IoStatsCounter sites[IO_STATS_OP_COUNT][IO_STATS_SITE_COUNT];
+    IoStatsCounter levels[IO_STATS_MAX_LEVELS][2];
+} IoStatsSnapshot;
+
+/**
+ * @brief Informa se a instrumentação foi compilada.
+ *
+ * @return 1 se `TWO_THREE_IO_STATS` estava definido na compilação, 0 caso contrário.
+ */
+int ioStatsEnabled(void);
+
+/**
+ * @brief Zera todos os contadores da instrumentação.
+ */
+void ioStatsReset(void);
+
+/**
+ * @brief Copia os contadores da instrumentação.
+ *
+ * @param snapshot Ponteiro para a estrutura que recebe os contadores (zerada se a instrumentação não foi compilada).
+ */
+void ioStatsGet(IoStatsSnapshot *snapshot);
+
+/**
+ * @brief Imprime os contadores da instrumentação por operação, por tipo de acesso e por nível da árvore.
+ *
+ * @param output Arquivo onde o relatório é impresso (por exemplo, `stdout`).
+ */
+void ioStatsPrint(FILE *output);
+
+#ifdef TWO_THREE_IO_STATS
+// Funções usadas pelas macros abaixo; não devem ser chamadas diretamente
+int ioStatsRead(IoStatsSite site, FILE *file, long offset, void *buffer, size_t size);
+int ioStatsWrite(IoStatsSite site, FILE *file, long offset, const void *buffer, size_t size);
+int ioStatsBegin(IoStatsOperation operation);
+void ioStatsEnd(int previous);
+void ioStatsSetLevel(int level);
+
+/**
+ * @brief `storageRead` contado como um acesso do tipo `site`.
+ */
+#define IO_STATS_READ(site, file, offset, buffer, size) ioStatsRead((site), (file), (offset), (buffer), (size))
+
+/**
+ * @brief `storageWrite` contado como um acesso do tipo `site`.
+ */
+#define IO_STATS_WRITE(site, file, offset, buffer, size) ioStatsWrite((site), (file), (offset), (buffer), (size))
+
+/**
+ * @brief Inicia uma operação lógica; operações aninhadas são atribuídas à mais externa.
+ */
+#define IO_STATS_BEGIN(operation) int ioStatsPrevious = ioStatsBegin(operation)
+
+/**
+ * @brief Encerra a operação iniciada com `IO_STATS_BEGIN` no mesmo bloco.
+ */
+#define IO_STATS_END() ioStatsEnd(ioStatsPrevious)
+
+/**
+ * @brief Define o nível da árvore (a raiz é o nível 0) dos próximos acessos a nós da thread.
+ */
+#define IO_STATS_LEVEL(level) ioStatsSetLevel(level)
+#else
+#define IO_STATS_READ(site, file, offset, buffer, size) storageRead((file), (offset), (buffer), (size))
+#define IO_STATS_WRITE(site, file, offset, buffer, size) storageWrite((file), (offset), (buffer), (size))
+#define IO_STATS_BEGIN(operation) ((void)0)
+#define IO_STATS_END() ((void)0)
+// Sem a instrumentação, o nível não é avaliado
+#define IO_STATS_LEVEL(level) ((void)sizeof(level))
+#endif
+
+#endif /* IO_STATS_H */
@@ -0,0 +1,45 @@
+/**
+ * @file key_search.h
+ * @see key_search.c
+ *
+ * @brief Contém a busca de uma chave no vetor ordenado de chaves de um nó.
+ *
+ * A busca binária estreita o intervalo até `KEY_SEARCH_LINEAR_WIDTH` chaves, e o restante é resolvido comparando
+ * várias chaves por instrução: como o vetor está ordenado, o número de chaves menores que a procurada é exatamente a
+ * contagem das comparações verdadeiras, sem desvios que dependam do resultado. A implementação vetorial é escolhida
+ * na compilação: AVX2 (8 chaves por comparação, com `-mavx2` ou `-march=native`), SSE2 (4 chaves, padrão em x86-64)
+ * ou NEON (4 chaves, em AArch64), com uma versão escalar nas demais plataformas.
+ *
+ * As leituras não exigem alinhamento, de modo que o vetor pode estar em qualquer posição do nó (as chaves de um
+ * `BPlusNode` começam no deslocamento 12 da página).
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef KEY_SEARCH_H
+#define KEY_SEARCH_H
+
+/**
+ * @brief Número de chaves a partir do qual a busca binária dá lugar à contagem vetorial.
+ */
+#define KEY_SEARCH_LINEAR_WIDTH 32
+
+/**
+ * @brief Retorna o número de chaves de um vetor ordenado menores que `key`.
+ *
+ * @param keys Chaves em ordem crescente.
+ * @param n Número de chaves.
+ * @param key Chave procurada.
+ *
+ * @return O índice da primeira chave maior ou igual a `key` (`n` se não houver).
+ */
+int keySearchLowerBound(const int *keys, int n, int key);
+
+/**
+ * @brief Retorna o nome da implementação escolhida na compilação ("avx2", "sse2", "neon" ou "scalar").
+ *
+ * @return O nome da implementação.
+ */
+const char *keySearchImplementation(void);
+
+#endif /* KEY_SEARCH_H */
@@ -0,0 +1,451 @@
+/**
+ * @file library.h
+ * @see library.c
+ *
+ * @brief Define o "handle" da biblioteca, que mantém abertos os arquivos de dados e de índices.
+ *
+ * O handle carrega uma única vez os cabeçalhos dos dois arquivos e os mantém em memória como a versão
+ * válida durante toda a sessão. Os cabeçalhos só são gravados no disco em `libraryCommit`/`libraryClose`
+ * ou, opcionalmente, a cada `flushInterval` operações.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include "book_data_file.h"
+#include "two_three_tree.h"
+#include "author_index.h"
+#include "title_index.h"
+#include "book_stats.h"
+#include "column_store.h"
+#include "wal.h"
+#include "code_filter.h"
+#include "library_snapshot.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Intervalo padrão (em operações) entre gravações automáticas dos cabeçalhos.
+ *
+ * O valor 0 indica que os cabeçalhos só são gravados em `libraryCommit` e `libraryClose`.
+ */
+#define LIBRARY_DEFAULT_FLUSH_INTERVAL 0
+
+/**
+ * @brief Tamanho máximo (com o terminador) dos nomes de arquivo guardados no handle.
+ */
+#define LIBRARY_MAX_FILENAME 256
+
+/**
+ * @brief Sufixo dos novos arquivos de dados e de índices trocados por `librarySwapFiles`.
+ *
+ * Uma troca interrompida é concluída por `libraryOpenExisting` a partir do arquivo com este sufixo.
+ */
+#define LIBRARY_SWAP_SUFFIX ".tmp"
+
+/**
+ * @brief Estrutura de dados para a biblioteca aberta.
+ *
+ * - dataFile: Arquivo de dados dos livros.
+ * - indexFile: Arquivo de índices (árvore 2-3).
+ * - dataHeader: Cabeçalho do arquivo de dados, mantido em memória.
+ * - indexHeader: Cabeçalho do arquivo de índices, mantido em memória.
+ * - authorIndex: Índice secundário por autor (opcional, aberto com `libraryOpenAuthorIndex`).
+ * - titleIndex: Índice secundário ordenado por título (opcional, aberto com `libraryOpenTitleIndex`).
+ * - stats: Contadores por autor, editora e ano (opcional, abertos com `libraryOpenStats`).
+ * - columns: Colunas com os campos numéricos de cada posição do arquivo de dados (opcional, abertas com
+ *   `libraryOpenColumns`).
+ * - wal: Log de escrita antecipada dos arquivos de dados e de índices (opcional, aberto com `libraryOpenWal`).
+ * - transactionDataHeader, transactionIndexHeader: Cabeçalhos no início da transação corrente, restaurados por
+ *   `libraryAbortTransaction`.
+ * - codeFilter: Filtro de pertinência dos códigos do índice (opcional, ligado com `libraryEnableCodeFilter`).
+ * - flushInterval: Número de operações entre gravações automáticas (0 para gravar apenas no commit).
+ * - pendingOperations: Número de operações realizadas desde a última gravação.
+ * - dataFilename, indexFilename, walFilename: Nomes dos arquivos abertos (usados para substituí-los na compactação).
+ * - snapshotFilename: Nome do snapshot gravado no fechamento (vazio se não for usado, veja `libraryUseSnapshot`).
+ * - snapshot: Snapshot lido na abertura.
+ * - snapshotParts: Arquivos secundários do snapshot que ainda podem ser aproveitados na abertura.
+ * - staleParts: Arquivos secundários abertos que deixaram de acompanhar o arquivo de dados (veja `libraryMarkStale`).
+ */
+typedef struct
+{
+    FILE *dataFile;                 // Arquivo de dados dos livros
+    FILE *indexFile;                // Arquivo de índices
+    BookDataFileHeader dataHeader;  // Cabeçalho do arquivo de dados (versão válida)
+    IndexFileHeader indexHeader;    // Cabeçalho do arquivo de índices (versão válida)
+    AuthorIndex authorIndex;        // Índice por autor (authorIndex.file == NULL se não estiver aberto)
+    TitleIndex titleIndex;          // Índice por título (titleIndex.file == NULL se não estiver aberto)
+    BookStats stats;                // Contadores agregados (stats.file == NULL se não estiverem abertos)
+    ColumnStore columns;            // Colunas numéricas (columns.file == NULL se não estiverem abertas)
+    Wal wal;                        // Log de escrita antecipada (wal.file == NULL se não estiver aberto)
+    BookDataFileHeader transactionDataHeader; // Cabeçalho de dados no início da transação
+    IndexFileHeader transactionIndexHeader;   // Cabeçalho de índices no início da transação
+    CodeFilter codeFilter;          // Filtro de códigos (codeFilter.counters == NULL se não estiver ligado)
+    int flushInterval;              // Operações entre gravações automáticas (0 = apenas no commit)
+    int pendingOperations;          // Operações desde a última gravação
+    char dataFilename[LIBRARY_MAX_FILENAME];  // Nome do arquivo de dados
+    char indexFilename[LIBRARY_MAX_FILENAME]; // Nome do arquivo de índices
+    char walFilename[LIBRARY_MAX_FILENAME];   // Nome do arquivo de log (vazio se o log não estiver aberto)
+    char snapshotFilename[LIBRARY_MAX_FILENAME]; // Nome do snapshot (vazio se não for usado)
+    LibrarySnapshot snapshot;                    // Snapshot lido na abertura
+    int snapshotParts;                           // Arquivos secundários aproveitáveis
+    int staleParts;                              // Arquivos secundários desatualizados, fora do próximo snapshot
+} Library;
+
+/**
+ * @brief Abre (criando do zero) os arquivos de dados e de índices da biblioteca.
+ *
+ * Os arquivos são criados vazios, seus cabeçalhos são inicializados e anexados em memória, de modo que as
+ * operações seguintes não precisem reler nem regravar os cabeçalhos a cada chamada.
+ *
+ * @pre `library`, `dataFilename` e `indexFilename` não devem ser NULL.
+ *
+ * @post Os dois arquivos estão abertos em modo de leitura e escrita e seus cabeçalhos estão em memória.
+ *
+ * @param library Ponteiro para o handle a ser inicializado.
+ * @param dataFilename Nome do arquivo de dados.
+ * @param indexFilename Nome do arquivo de índices.
+ *
+ * @return 0 em caso de sucesso, -1 caso algum arquivo não possa ser aberto.
+ */
+int libraryOpen(Library *library, const char *dataFilename, const char *indexFilename);
+
+/**
+ * @brief Abre (criando do zero) os arquivos da biblioteca, com o índice na ordem informada.
+ *
+ * Igual a `libraryOpen`, mas permite escolher a ordem do índice: `TWO_THREE_TREE_ORDER` mantém a árvore 2-3 e
+ * valores maiores (até `BPLUS_MAX_ORDER`) criam o índice no modo B+, com nós do tamanho de uma página.
+ *
+ * @param library Ponteiro para o handle a ser inicializado.
+ * @param dataFilename Nome do arquivo de dados.
+ * @param indexFilename Nome do arquivo de índices.
+ * @param indexOrder Ordem (número máximo de filhos por nó) do índice.
+ *
+ * @return 0 em caso de sucesso, -1 caso algum arquivo não possa ser aberto.
+ */
+int libraryOpenWithOrder(Library *library, const char *dataFilename, const char *indexFilename, int indexOrder);
+
+/**
+ * @brief Reabre os arquivos de dados e de índices de uma sessão anterior.
+ *
+ * Os cabeçalhos dos dois arquivos são validados (identificador, versão, tamanho dos registros e dos nós e
+ * consistência com o tamanho do arquivo) antes de serem anexados; a ordem do índice é a gravada no arquivo. Os dois
+ * cabeçalhos devem ter a mesma marca de par (`pairStamp`): se não tiverem, a troca interrompida de
+ * `librarySwapFiles` é concluída com o arquivo de sufixo `LIBRARY_SWAP_SUFFIX` que completa o par. Nenhum
+ * livro nem nó é lido: as listas de livres são convertidas nos mapas de bits do alocador e os nós são lidos sob
+ * demanda. A exceção é um total em estoque negativo no cabeçalho de dados, recalculado a partir dos livros gravados.
+ *
+ * @pre Se a sessão anterior usou o log, `libraryRecover` já deve ter sido chamada.
+ *
+ * @param library Ponteiro para o handle a ser inicializado.
+ * @param dataFilename Nome do arquivo de dados.
+ * @param indexFilename Nome do arquivo de índices.
+ *
+ * @return 0 se os arquivos foram reabertos, 1 se nenhum dos dois existir (nada é aberto; use `libraryOpen`), -1 se
+ *         apenas um deles existir, algum cabeçalho for inválido, os arquivos não formarem um par ou em caso de erro.
+ */
+int libraryOpenExisting(Library *library, const char *dataFilename, const char *indexFilename);
+
+/**
+ * @brief Passa a usar o snapshot da biblioteca (veja `library_snapshot.h`).
+ *
+ * O snapshot gravado no último fechamento é lido e apagado. Se ele corresponder aos arquivos de dados e de índices
+ * abertos, as próximas chamadas de `libraryOpenAuthorIndex`, `libraryOpenTitleIndex`, `libraryOpenStats` e
+ * `libraryOpenColumns` reabrem os arquivos secundários registrados nele em vez de reconstruí-los. Em
+ * `libraryClose`, um novo snapshot é gravado com o estado final, sem os arquivos marcados com `libraryMarkStale`.
+ *
+ * @pre A biblioteca deve ter sido aberta, e os arquivos secundários ainda não.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo do snapshot.
+ *
+ * @return 1 se o snapshot corresponde aos arquivos abertos, 0 se não existir ou não corresponder, -1 se não puder
+ *         ser apagado.
+ */
+int libraryUseSnapshot(Library *library, const char *filename);
+
+/**
+ * @brief Abre o índice secundário por autor da biblioteca.
+ *
+ * Com o índice aberto, `addBookAux` e `removeBook` passam a mantê-lo atualizado e `searchByAuthor` o utiliza
+ * automaticamente no lugar da leitura sequencial do arquivo de dados. O arquivo registrado no snapshot é
+ * reaproveitado; caso contrário, o índice é criado e preenchido com os livros já gravados no arquivo de dados.
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen` ou `libraryOpenExisting`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo do índice de autores.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenAuthorIndex(Library *library, const char *filename);
+
+/**
+ * @brief Abre o índice secundário ordenado por título da biblioteca.
+ *
+ * Com o índice aberto, `addBookAux` e `removeBook` passam a mantê-lo atualizado e `searchByTitle` e
+ * `searchByTitlePrefix` o utilizam automaticamente no lugar da leitura sequencial do arquivo de dados. O arquivo
+ * registrado no snapshot é reaproveitado; caso contrário, o índice é criado e preenchido com os livros já gravados.
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen` ou `libraryOpenExisting`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo do índice de títulos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenTitleIndex(Library *library, const char *filename);
+
+/**
+ * @brief Abre o arquivo de estatísticas da biblioteca (contadores por autor, editora e ano).
+ *
+ * Com as estatísticas abertas, `addBookAux` e `removeBook` passam a manter os contadores atualizados e os totais
+ * por autor, por editora e por ano são consultados sem leitura do arquivo de dados. O arquivo registrado no snapshot
+ * é reaproveitado; caso contrário, os contadores são calculados com os livros já gravados.
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen` ou `libraryOpenExisting`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo de estatísticas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenStats(Library *library, const char *filename);
+
+/**
+ * @brief Abre o arquivo de colunas da biblioteca (código, ano, edição, estoque, preço e os identificadores do autor e
+ *        da editora de cada posição).
+ *
+ * O arquivo registrado no snapshot é reaproveitado, com os seus dicionários; caso contrário, as colunas e os
+ * dicionários de autores e editoras são preenchidos com os livros já gravados no arquivo de dados.
+ * Com as colunas abertas, as inserções, remoções e alterações de estoque passam a mantê-las atualizadas, e as
+ * agregações (como os totais por ano, autor ou editora sem as estatísticas abertas e as estatísticas de preço)
+ * percorrem as colunas em vez do arquivo de dados.
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo de colunas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenColumns(Library *library, const char *filename);
+
+/**
+ * @brief Marca um arquivo secundário aberto como desatualizado, depois de uma falha ao mantê-lo.
+ *
+ * O arquivo continua aberto até o fim da sessão, mas fica fora do snapshot gravado em `libraryClose`, de modo que a
+ * próxima abertura o reconstrói a partir do arquivo de dados. Um aviso é exibido na primeira marcação.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param part Arquivo secundário (`LIBRARY_SNAPSHOT_AUTHOR_INDEX`, `LIBRARY_SNAPSHOT_TITLE_INDEX`,
+ *             `LIBRARY_SNAPSHOT_STATS` ou `LIBRARY_SNAPSHOT_COLUMNS`).
+ *
+ * @note Uma nova abertura do arquivo na mesma sessão (que o reconstrói ou reaproveita) desfaz a marcação.
+ */
+void libraryMarkStale(Library *library, int part);
+
+/**
+ * @brief Cria o log de escrita antecipada dos arquivos de dados e de índices.
+ *
+ * Com o log aberto, cada inserção, remoção e alteração de estoque é executada como uma transação registrada no
+ * log antes de chegar aos arquivos, e `libraryCommit` passa a funcionar como checkpoint (veja `wal.h`).
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo de log.
+ * @param syncWindowMs Janela (em milissegundos) do commit em grupo; 0 sincroniza o log a cada operação.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenWal(Library *library, const char *filename, int syncWindowMs);
+
+/**
+ * @brief Inicia a transação de uma operação de escrita.
+ *
+ * Sem log aberto, a chamada não tem efeito.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ */
+void libraryBeginTransaction(Library *library);
+
+/**
+ * @brief Confirma a transação corrente.
+ *
+ * Os nós modificados são gravados (e registrados no log) e as imagens dos cabeçalhos em memória são acrescentadas
+ * ao log antes do registro de commit. Sem log aberto, a chamada não tem efeito.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryCommitTransaction(Library *library);
+
+/**
+ * @brief Descarta a transação corrente.
+ *
+ * As gravações retidas pelo log, os nós modificados no cache, as alocações e liberações de unidades e os cabeçalhos
+ * em memória voltam ao estado do início da transação. Sem log aberto (ou sem transação aberta), a chamada não tem
+ * efeito.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @note Os índices secundários, as estatísticas e as colunas não são restaurados: as operações descartam a transação
+ *       antes de alterá-los.
+ */
+void libraryAbortTransaction(Library *library);
+
+/**
+ * @brief Aplica aos arquivos da biblioteca o log deixado por uma sessão interrompida.
+ *
+ * Deve ser chamada antes de abrir a biblioteca cujos arquivos já existem.
+ *
+ * @param dataFilename Nome do arquivo de dados.
+ * @param indexFilename Nome do arquivo de índices.
+ * @param walFilename Nome do arquivo de log.
+ *
+ * @return O número de transações refeitas (0 se não houver log), ou -1 em caso de erro.
+ */
+int libraryRecover(const char *dataFilename, const char *indexFilename, const char *walFilename);
+
+/**
+ * @brief Substitui os arquivos de dados e de índices da biblioteca pelos arquivos informados.
+ *
+ * Os arquivos atuais são fechados, os novos são renomeados sobre eles (`rename`, atômico para cada arquivo) e
+ * reabertos, com os cabeçalhos e os alocadores anexados novamente. O mapeamento em memória, o acesso concorrente e o
+ * log, se estavam em uso, são restabelecidos sobre os novos arquivos.
+ *
+ * @pre As alterações pendentes já devem ter sido gravadas com `libraryCommit`. Os novos arquivos devem estar
+ *      completos, fechados e sincronizados com o dispositivo, e os seus cabeçalhos devem ter a mesma marca de par
+ *      (`pairStamp`), diferente da dos arquivos atuais.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param dataFilename Nome do novo arquivo de dados.
+ * @param indexFilename Nome do novo arquivo de índices.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ *
+ * @note As duas renomeações não são atômicas em conjunto. Uma interrupção entre elas deixa arquivos com marcas de par
+ *       diferentes, que `libraryOpenExisting` recusa ou, se os novos arquivos tiverem os nomes atuais com o sufixo
+ *       `LIBRARY_SWAP_SUFFIX`, completa com a renomeação que faltou.
+ */
+int librarySwapFiles(Library *library, const char *dataFilename, const char *indexFilename);
+
+/**
+ * @brief Passa a acessar os arquivos de dados e de índices por meio de mapeamentos em memória.
+ *
+ * Depois desta chamada, as leituras e gravações de livros, nós e cabeçalhos se tornam cópias de memória
+ * (veja `storage.h`). Os índices secundários continuam sendo acessados com `stdio`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 se o mapeamento não estiver disponível. Em caso de erro, os arquivos
+ *         continuam sendo acessados com `stdio`.
+ */
+int libraryUseMappedStorage(Library *library);
+
+/**
+ * @brief Liga o acesso concorrente à biblioteca: várias threads podem ler livros ao mesmo tempo.
+ *
+ * Os arquivos de dados e de índices passam a ser acessados com leituras e gravações posicionais (`pread`/`pwrite`),
+ * que não dependem da posição corrente do `FILE*`, e o índice recebe uma trava de leitura e escrita (veja
+ * `tree_lock.h`). As buscas (`twoThreeTreeSearch`, `readBookRecord` e os cursores) obtêm a trava para leitura; as
+ * inserções, remoções, alterações de estoque e gravações da biblioteca a obtêm para escrita.
+ *
+ * @pre Nenhuma outra thread pode estar usando a biblioteca.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (o acesso concorrente continua desligado).
+ *
+ * @note Os índices secundários, as estatísticas e as colunas não são protegidos pela trava e só podem ser consultados
+ *       sem gravações simultâneas.
+ */
+int libraryEnableConcurrency(Library *library);
+
+/**
+ * @brief Desliga o acesso concorrente à biblioteca.
+ *
+ * @pre Nenhuma outra thread pode estar usando a biblioteca.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ */
+void libraryDisableConcurrency(Library *library);
+
+/**
+ * @brief Liga o filtro de códigos, que permite às inserções dispensar a busca prévia por duplicados.
+ *
+ * O filtro (veja `code_filter.h`) é montado em memória com os códigos presentes no índice. A partir daí, uma inserção
+ * cujo código certamente não está no índice não percorre a árvore antes de gravar o livro; apenas os códigos que
+ * podem estar no índice (os duplicados e cerca de 1% dos novos) são procurados. As inserções, remoções e a carga em
+ * lote mantêm o filtro atualizado, e ele é reconstruído com o dobro da capacidade quando o número de códigos a
+ * excede. Chamar a função com o filtro já ligado o reconstrói.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param expectedKeys Número de códigos previstos (o filtro usa cerca de 5 bytes por código), ou 0 para usar o
+ *                     dobro do número de livros atual.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (o filtro fica desligado).
+ */
+int libraryEnableCodeFilter(Library *library, long expectedKeys);
+
+/**
+ * @brief Desliga o filtro de códigos e libera a sua memória.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ */
+void libraryDisableCodeFilter(Library *library);
+
+/**
+ * @brief Define o intervalo entre gravações automáticas dos cabeçalhos.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param interval Número de operações entre gravações, ou 0 para gravar apenas em `libraryCommit`/`libraryClose`.
+ */
+void librarySetFlushInterval(Library *library, int interval);
+
+/**
+ * @brief Registra o término de uma operação de escrita na biblioteca.
+ *
+ * Se o intervalo de gravação estiver configurado e tiver sido atingido, os cabeçalhos e os nós modificados
+ * são gravados no disco.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 se a gravação automática falhar.
+ */
+int libraryEndOperation(Library *library);
+
+/**
+ * @brief Grava no disco os cabeçalhos e os nós modificados da biblioteca.
+ *
+ * As listas de nós e de registros livres do alocador também são gravadas, assim como os cabeçalhos dos índices
+ * secundários abertos, as estatísticas e as colunas. Com o log aberto, os
+ * arquivos são sincronizados com o dispositivo e o log é esvaziado (checkpoint). Com o acesso concorrente ligado, a
+ * gravação é feita com a trava de escrita do índice.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 se alguma gravação falhar.
+ */
+int libraryCommit(Library *library);
+
+/**
+ * @brief Grava as alterações pendentes e fecha os arquivos da biblioteca.
+ *
+ * A geração dos arquivos de dados e de índices é incrementada, o que invalida qualquer snapshot anterior. Com o
+ * snapshot em uso, todos os arquivos são sincronizados com o dispositivo e um novo snapshot é gravado antes do
+ * fechamento.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 se alguma gravação ou fechamento falhar.
+ *
+ * @post Os ponteiros de arquivo do handle são definidos como NULL.
+ */
+int libraryClose(Library *library);
+
+#endif /* LIBRARY_H */
@@ -0,0 +1,97 @@
+/**
+ * @file library_snapshot.h
+ * @see library_snapshot.c
+ *
+ * @brief Contém o snapshot da biblioteca: o registro, gravado no fechamento, do estado de todos os arquivos.
+ *
+ * Os arquivos de dados e de índices são recuperados pelo log de escrita antecipada, mas os índices secundários, as
+ * estatísticas e as colunas são gravados apenas em `libraryCommit` e não estão no log. Depois de uma interrupção,
+ * eles podem não corresponder mais aos livros do arquivo de dados. O snapshot resolve essa dúvida sem ler os livros:
+ * ao fechar a biblioteca, todos os arquivos são gravados e sincronizados e o snapshot registra os cabeçalhos de cada
+ * um (com a geração dos arquivos de dados e de índices, incrementada a cada fechamento). Ao reabrir, um arquivo
+ * secundário só é aproveitado se o snapshot for válido, os cabeçalhos dos arquivos de dados e de índices forem
+ * iguais aos registrados e o cabeçalho do próprio arquivo também; caso contrário, ele é reconstruído a partir do
+ * arquivo de dados.
+ *
+ * O snapshot é consumido (apagado) ao ser lido, de modo que uma sessão interrompida nunca deixa um snapshot que
+ * descreva arquivos já alterados. A gravação usa um arquivo temporário renomeado sobre o anterior.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef LIBRARY_SNAPSHOT_H
+#define LIBRARY_SNAPSHOT_H
+
+#include "book_data_file.h"
+#include "two_three_tree.h"
+#include "author_index.h"
+#include "title_index.h"
+#include "book_stats.h"
+#include "column_store.h"
+
+/**
+ * @brief Identificador do formato do snapshot.
+ */
+#define LIBRARY_SNAPSHOT_MAGIC 0x31534E4Cu
+
+/**
+ * @brief Versão do formato do snapshot.
+ */
+#define LIBRARY_SNAPSHOT_VERSION 1
+
+/**
+ * @brief Arquivos secundários registrados no snapshot (`LibrarySnapshot.parts`), combinados com `|`.
+ */
+#define LIBRARY_SNAPSHOT_AUTHOR_INDEX 0x1 // Índice por autor
+#define LIBRARY_SNAPSHOT_TITLE_INDEX 0x2  // Índice por título
+#define LIBRARY_SNAPSHOT_STATS 0x4        // Estatísticas
+#define LIBRARY_SNAPSHOT_COLUMNS 0x8      // Colunas e seus dicionários
+
+/**
+ * @brief Estrutura de Dados para o snapshot da biblioteca.
+ *
+ * - magic, version: Identificador e versão do formato.
+ * - parts: Arquivos secundários abertos no fechamento.
+ * - dataHeader, indexHeader: Cabeçalhos dos arquivos de dados e de índices.
+ * - authorHeader, titleHeader, statsHeader, columnsHeader: Cabeçalhos dos arquivos secundários registrados.
+ * - authorsHeader, publishersHeader: Cabeçalhos dos dicionários das colunas.
+ * - checksum: Soma de verificação dos campos anteriores.
+ */
+typedef struct
+{
+    unsigned int magic;                      // Identificador do formato
+    int version;                             // Versão do formato
+    int parts;                               // Arquivos secundários registrados
+    BookDataFileHeader dataHeader;           // Cabeçalho do arquivo de dados
+    IndexFileHeader indexHeader;             // Cabeçalho do arquivo de índices
+    AuthorIndexHeader authorHeader;          // Cabeçalho do índice por autor
+    TitleIndexHeader titleHeader;            // Cabeçalho do índice por título
+    BookStatsHeader statsHeader;             // Cabeçalho das estatísticas
+    ColumnStoreHeader columnsHeader;         // Cabeçalho das colunas
+    StringDictionaryHeader authorsHeader;    // Cabeçalho do dicionário de autores
+    StringDictionaryHeader publishersHeader; // Cabeçalho do dicionário de editoras
+    unsigned int checksum;                   // Soma de verificação
+} LibrarySnapshot;
+
+/**
+ * @brief Grava o snapshot de forma atômica (arquivo temporário sincronizado e renomeado).
+ *
+ * @param filename Nome do arquivo do snapshot.
+ * @param snapshot Ponteiro para o snapshot; o identificador, a versão e a soma de verificação são preenchidos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (o snapshot anterior, se houver, é mantido).
+ */
+int librarySnapshotWrite(const char *filename, LibrarySnapshot *snapshot);
+
+/**
+ * @brief Lê e valida um snapshot.
+ *
+ * @param filename Nome do arquivo do snapshot.
+ * @param snapshot Ponteiro para a estrutura que recebe o snapshot.
+ *
+ * @return 1 se o snapshot foi lido e é válido, 0 se o arquivo não existir, -1 se estiver incompleto, corrompido ou
+ *         em outro formato.
+ */
+int librarySnapshotRead(const char *filename, LibrarySnapshot *snapshot);
+
+#endif /* LIBRARY_SNAPSHOT_H */
@@ -10,18 +10,20 @@
 #ifndef menu_h
 #define menu_h
 
+#include "library.h"
+
 /**
  * @brief Exibe o menu principal e manipula as escolhas do usuário.
  *
  * Esta função exibe o menu principal com as opções principais de operações, incluindo cadastro, remoção, impressão e listagem de livros, etc.
  * O menu principal permanece em execução até que o usuário escolha a opção de sair.
  *
- * @pre Nenhuma.
+ * @pre O handle da biblioteca deve ter sido aberto com `libraryOpen`.
  * @post O menu principal é exibido na tela e as opções são tratadas de acordo com a escolha do usuário.
  *
- * @param Nenhum.
+ * @param library Ponteiro para o handle da biblioteca aberta.
  * @return Nenhum. A função não retorna nada.
  */
-void handleChoice();
+void handleChoice(Library *library);
 
 #endif /* menu_h */
@@ -0,0 +1,147 @@
+/**
+ * @file node_cache.h
+ * @see node_cache.c
+ *
+ * @brief Contém funções para o cache em memória dos nós da árvore 2-3.
+ *
+ * O cache mantém os nós lidos do arquivo de índices indexados pelo seu deslocamento (offset) no arquivo,
+ * evitando que a raiz e os níveis superiores da árvore sejam relidos do disco a cada operação. A política
+ * de substituição é a do relógio (CLOCK) e as escritas são adiadas (write-back) até a remoção do nó do
+ * cache ou até uma chamada explícita a `nodeCacheFlush`.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef NODE_CACHE_H
+#define NODE_CACHE_H
+
+#include "two_three_tree.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Capacidade padrão do cache (em número de nós) quando `nodeCacheInit` não é chamada.
+ */
+#define NODE_CACHE_DEFAULT_CAPACITY 256
+
+/**
+ * @brief Estrutura com os contadores de uso do cache de nós.
+ *
+ * - hits: Número de leituras atendidas diretamente pelo cache.
+ * - misses: Número de leituras que precisaram acessar o arquivo de índices.
+ * - evictions: Número de nós removidos do cache para dar lugar a outros.
+ * - writebacks: Número de nós modificados (sujos) gravados no arquivo de índices.
+ */
+typedef struct
+{
+    unsigned long hits;       // Leituras atendidas pelo cache
+    unsigned long misses;     // Leituras que foram ao disco
+    unsigned long evictions;  // Nós removidos pela política do relógio
+    unsigned long writebacks; // Nós sujos gravados no arquivo
+} NodeCacheStats;
+
+/**
+ * @brief Inicializa (ou reconfigura) o cache de nós com a capacidade informada.
+ *
+ * Caso o cache já esteja inicializado, todos os nós sujos são gravados em seus arquivos antes da
+ * reconfiguração. Uma capacidade igual a 0 desativa o cache, fazendo com que todas as leituras e
+ * escritas de nós sejam feitas diretamente no arquivo de índices.
+ *
+ * @pre Nenhuma.
+ *
+ * @post O cache está vazio e pronto para uso com a capacidade informada.
+ *
+ * @param capacity Número máximo de nós mantidos em memória.
+ *
+ * @return 0 em caso de sucesso, -1 se não houver memória suficiente (neste caso o cache fica desativado).
+ */
+int nodeCacheInit(int capacity);
+
+/**
+ * @brief Grava todos os nós sujos e libera a memória utilizada pelo cache.
+ *
+ * @pre Nenhuma.
+ *
+ * @post O cache é desativado até uma nova chamada a `nodeCacheInit`.
+ */
+void nodeCacheDestroy(void);
+
+/**
+ * @brief Indica se o cache de nós está ativo.
+ *
+ * Se o cache ainda não foi inicializado, ele é criado com a capacidade `NODE_CACHE_DEFAULT_CAPACITY`.
+ *
+ * @return 1 se o cache está ativo, 0 caso contrário.
+ */
+int nodeCacheEnabled(void);
+
+/**
+ * @brief Procura um nó no cache.
+ *
+ * @param file Arquivo de índices ao qual o nó pertence.
+ * @param offset Deslocamento (offset) do nó no arquivo de índices.
+ * @param node Ponteiro onde o nó encontrado será copiado.
+ *
+ * @return 1 se o nó estava no cache (hit), 0 caso contrário (miss).
+ */
+int nodeCacheLookup(FILE *file, int offset, Node23 *node);
+
+/**
+ * @brief Verifica se um nó está no cache, sem copiá-lo e sem alterar as estatísticas.
+ *
+ * @param file Arquivo de índices ao qual o nó pertence.
+ * @param offset Deslocamento (offset) do nó no arquivo de índices.
+ *
+ * @return 1 se o nó está no cache, 0 caso contrário.
+ */
+int nodeCacheContains(FILE *file, int offset);
+
+/**
+ * @brief Armazena um nó no cache.
+ *
+ * Se o nó já estiver no cache, seu conteúdo é substituído. Caso o cache esteja cheio, um nó é escolhido
+ * pela política do relógio para ser removido, sendo gravado no arquivo caso esteja sujo.
+ *
+ * @param file Arquivo de índices ao qual o nó pertence.
+ * @param offset Deslocamento (offset) do nó no arquivo de índices.
+ * @param node Ponteiro para o nó a ser armazenado.
+ * @param dirty 1 se o nó foi modificado e ainda não está gravado no arquivo, 0 caso contrário.
+ *
+ * @return 0 se o nó foi armazenado, -1 se o cache estiver desativado ou se a gravação de um nó removido falhar.
+ */
+int nodeCacheStore(FILE *file, int offset, const Node23 *node, int dirty);
+
+/**
+ * @brief Grava no arquivo todos os nós sujos de um arquivo de índices.
+ *
+ * @param file Arquivo de índices cujos nós sujos serão gravados, ou NULL para gravar os nós de todos os arquivos.
+ *
+ * @return 0 em caso de sucesso, -1 se alguma gravação falhar.
+ *
+ * @note Os nós permanecem no cache, agora marcados como limpos.
+ */
+int nodeCacheFlush(FILE *file);
+
+/**
+ * @brief Descarta do cache todos os nós de um arquivo de índices, sem gravá-los.
+ *
+ * Deve ser chamada após `nodeCacheFlush` quando o arquivo for fechado ou recriado, para que um novo
+ * arquivo que reutilize o mesmo ponteiro `FILE` não receba nós antigos.
+ *
+ * @param file Arquivo de índices cujos nós serão descartados, ou NULL para esvaziar o cache.
+ */
+void nodeCacheInvalidate(FILE *file);
+
+/**
+ * @brief Copia os contadores de uso do cache.
+ *
+ * @param stats Ponteiro para a estrutura onde os contadores serão copiados.
+ */
+void nodeCacheGetStats(NodeCacheStats *stats);
+
+/**
+ * @brief Zera os contadores de uso do cache.
+ */
+void nodeCacheResetStats(void);
+
+#endif /* NODE_CACHE_H */
@@ -0,0 +1,169 @@
+/**
+ * @file page_allocator.h
+ * @see page_allocator.c
+ *
+ * @brief Contém o alocador de unidades de tamanho fixo (nós, páginas e registros) dos arquivos binários.
+ *
+ * Cada arquivo anexado é dividido em unidades de `unitSize` bytes a partir do deslocamento `base`. O alocador
+ * mantém em memória um mapa de bits das unidades livres, carregado uma única vez a partir da lista de unidades
+ * livres gravada no arquivo (`headEmptyPosition` do cabeçalho). Assim, a alocação não precisa ler a unidade livre
+ * para descobrir a próxima e a liberação não precisa gravar o encadeamento.
+ *
+ * - Alocação: é escolhida a unidade livre mais próxima da unidade informada como referência (por exemplo, o nó
+ *   irmão), ou a de menor endereço, o que mantém o arquivo compacto. Sem unidades livres, o arquivo é estendido
+ *   de `PAGE_ALLOCATOR_BATCH` unidades de uma só vez, e as que sobram ficam livres para as próximas alocações.
+ * - Persistência: a lista de unidades livres só é regravada em `pageAllocatorFlush` (no commit), em ordem
+ *   crescente de endereço. Entre dois commits, o `headEmptyPosition` em memória vale -1, de modo que um cabeçalho
+ *   gravado nesse intervalo (por exemplo, no log) nunca aponta para uma unidade que já voltou a ser usada. Na pior
+ *   das hipóteses, as unidades liberadas depois do último commit se perdem até a próxima compactação.
+ *
+ * Os endereços recebidos e retornados seguem a convenção do arquivo: deslocamentos em bytes no arquivo de índices
+ * e números de registro no arquivo de dados (veja `PageAllocatorLayout`).
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef PAGE_ALLOCATOR_H
+#define PAGE_ALLOCATOR_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Número de unidades acrescentadas ao arquivo em cada extensão.
+ */
+#define PAGE_ALLOCATOR_BATCH 64
+
+/**
+ * @brief Número máximo de arquivos anexados ao mesmo tempo.
+ */
+#define PAGE_ALLOCATOR_MAX_FILES 40
+
+/**
+ * @brief Estrutura de Dados para o formato das unidades de um arquivo.
+ *
+ * - base: Deslocamento (em bytes) da primeira unidade no arquivo.
+ * - unitSize: Tamanho (em bytes) de cada unidade.
+ * - byteAddresses: 1 se os endereços do arquivo são deslocamentos em bytes; 0 se são números de unidade.
+ * - marker: Valor gravado no primeiro `int` de uma unidade livre.
+ * - linkOffset: Posição, dentro da unidade livre, do `int` com o endereço da próxima unidade livre.
+ */
+typedef struct
+{
+    long base;         // Deslocamento da primeira unidade
+    size_t unitSize;   // Tamanho de cada unidade
+    int byteAddresses; // 1 para deslocamentos em bytes, 0 para números de unidade
+    int marker;        // Marca das unidades livres
+    size_t linkOffset; // Posição do encadeamento dentro da unidade livre
+} PageAllocatorLayout;
+
+/**
+ * @brief Passa a gerenciar as unidades livres de um arquivo.
+ *
+ * A lista de unidades livres gravada no arquivo é percorrida uma única vez e convertida no mapa de bits. Uma
+ * unidade que não estiver marcada como livre interrompe a lista (as unidades seguintes deixam de ser reutilizadas).
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param layout Formato das unidades do arquivo.
+ * @param firstEmptyPosition Campo do cabeçalho em memória com o endereço da primeira unidade nunca utilizada.
+ * @param headEmptyPosition Campo do cabeçalho em memória com o endereço da primeira unidade livre.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo já estiver anexado), -1 em caso de erro.
+ *
+ * @warning Os campos do cabeçalho devem continuar válidos até `pageAllocatorDetach`.
+ */
+int pageAllocatorAttach(FILE *file, const PageAllocatorLayout *layout, int *firstEmptyPosition, int *headEmptyPosition);
+
+/**
+ * @brief Indica se o arquivo está anexado ao alocador.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 1 se o arquivo está anexado, 0 caso contrário.
+ */
+int pageAllocatorIsAttached(FILE *file);
+
+/**
+ * @brief Aloca uma unidade do arquivo.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ * @param hint Endereço de referência; a unidade livre mais próxima dele é escolhida. Com -1, é escolhida a unidade
+ *             livre de menor endereço.
+ *
+ * @return O endereço da unidade alocada, ou -1 em caso de erro (ou se o arquivo não estiver anexado).
+ *
+ * @note O conteúdo da unidade alocada é indefinido e deve ser gravado pelo chamador.
+ */
+int pageAllocate(FILE *file, int hint);
+
+/**
+ * @brief Devolve uma unidade ao alocador.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ * @param address Endereço da unidade.
+ *
+ * @return 0 em caso de sucesso, -1 se o endereço for inválido ou a unidade já estiver livre.
+ *
+ * @note O chamador deve marcar a unidade como livre no arquivo, se ela puder ser lida antes do próximo commit
+ *       (como os registros do arquivo de dados, que são percorridos sequencialmente).
+ */
+int pageRelease(FILE *file, int address);
+
+/**
+ * @brief Retorna o número de unidades livres do arquivo.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ *
+ * @return O número de unidades livres, ou 0 se o arquivo não estiver anexado.
+ */
+int pageAllocatorFreeCount(FILE *file);
+
+/**
+ * @brief Passa a registrar as alocações e liberações do arquivo, para que possam ser desfeitas.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ */
+void pageAllocatorBeginTransaction(FILE *file);
+
+/**
+ * @brief Confirma as operações da transação e deixa de registrá-las.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ */
+void pageAllocatorEndTransaction(FILE *file);
+
+/**
+ * @brief Desfaz as alocações, liberações e extensões feitas desde `pageAllocatorBeginTransaction`.
+ *
+ * O mapa, o número de unidades livres e os campos do cabeçalho voltam ao estado do início da transação. As unidades
+ * acrescentadas por uma extensão desfeita continuam no arquivo, além do `firstEmptyPosition`, e são regravadas na
+ * próxima extensão.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ */
+void pageAllocatorRollback(FILE *file);
+
+/**
+ * @brief Grava no arquivo a lista de unidades livres, se ela tiver sido alterada.
+ *
+ * @pre As unidades livres não devem ser gravadas depois desta chamada por caches com escrita adiada
+ *      (o cache de nós deve ser gravado antes).
+ *
+ * @post O `headEmptyPosition` em memória aponta para a unidade livre de menor endereço (ou -1).
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo não estiver anexado), -1 em caso de erro.
+ */
+int pageAllocatorFlush(FILE *file);
+
+/**
+ * @brief Grava a lista de unidades livres e deixa de gerenciar o arquivo.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo não estiver anexado), -1 em caso de erro.
+ */
+int pageAllocatorDetach(FILE *file);
+
+#endif /* PAGE_ALLOCATOR_H */
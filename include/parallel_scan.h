@@ -0,0 +1,117 @@
+/**
+ * @file parallel_scan.h
+ * @see parallel_scan.c
+ *
+ * @brief Contém o mecanismo de varredura paralela do arquivo de dados.
+ *
+ * Uma varredura divide as posições do arquivo de dados em intervalos contíguos, um por thread, e cada thread lê o
+ * seu intervalo em lotes com `storagePread`, sem compartilhar a posição corrente do `FILE*`. Para cada livro válido
+ * (registros livres são ignorados), a função `visit` da consulta acumula o resultado no resultado parcial da thread;
+ * ao final, os resultados parciais são combinados com `merge`, na ordem dos intervalos. Assim, consultas que
+ * coletam posições (buscas) recebem as posições em ordem crescente, como em uma varredura sequencial.
+ *
+ * O número de threads é limitado pelo número de processadores disponíveis e por `PARALLEL_SCAN_MIN_ROWS` posições
+ * por thread, de modo que arquivos pequenos são percorridos sem criar threads. Em plataformas sem `pthread` e
+ * `pread`, a varredura é sempre feita na thread que a chamou.
+ *
+ * @warning Nenhuma gravação no arquivo de dados pode ocorrer durante a varredura.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef PARALLEL_SCAN_H
+#define PARALLEL_SCAN_H
+
+#include "book.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Número máximo de threads de uma varredura.
+ */
+#define PARALLEL_SCAN_MAX_THREADS 64
+
+/**
+ * @brief Número mínimo de posições por thread; intervalos menores não compensam a criação de uma thread.
+ */
+#define PARALLEL_SCAN_MIN_ROWS 4096
+
+/**
+ * @brief Número de livros lidos de cada vez por thread.
+ */
+#define PARALLEL_SCAN_BATCH 64
+
+/**
+ * @brief Função chamada para cada livro válido do intervalo de uma thread.
+ *
+ * @param book Ponteiro para o livro lido.
+ * @param position Posição do livro no arquivo de dados.
+ * @param context Contexto da consulta (somente leitura, compartilhado entre as threads).
+ * @param partial Resultado parcial da thread.
+ *
+ * @return 0 para continuar, -1 para interromper o intervalo com erro (por exemplo, falta de memória).
+ */
+typedef int (*ParallelScanVisit)(const Book *book, long position, const void *context, void *partial);
+
+/**
+ * @brief Função que combina o resultado parcial de uma thread ao resultado final.
+ *
+ * Chamada uma vez por thread, na ordem dos intervalos, mesmo que a varredura tenha falhado; deve liberar os
+ * recursos alocados pelo resultado parcial.
+ *
+ * @param result Resultado final.
+ * @param partial Resultado parcial da thread.
+ * @param context Contexto da consulta.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+typedef int (*ParallelScanMerge)(void *result, void *partial, const void *context);
+
+/**
+ * @brief Estrutura de Dados para uma consulta executada pela varredura paralela.
+ *
+ * - visit: Função chamada para cada livro válido.
+ * - merge: Função que combina cada resultado parcial ao resultado final.
+ * - partialSize: Tamanho (em bytes) do resultado parcial de cada thread, que começa zerado.
+ * - context: Contexto repassado às funções (pode ser NULL).
+ */
+typedef struct
+{
+    ParallelScanVisit visit; // Função chamada para cada livro
+    ParallelScanMerge merge; // Função que combina os resultados parciais
+    size_t partialSize;      // Tamanho do resultado parcial
+    const void *context;     // Contexto da consulta
+} ParallelScanQuery;
+
+/**
+ * @brief Define o número máximo de threads usado pelas varreduras.
+ *
+ * @param threads Número de threads (limitado a `PARALLEL_SCAN_MAX_THREADS`), ou 0 para usar o número de
+ *                processadores disponíveis.
+ */
+void parallelScanSetThreads(int threads);
+
+/**
+ * @brief Retorna o número máximo de threads usado pelas varreduras.
+ *
+ * @return O número definido com `parallelScanSetThreads` ou, se nenhum foi definido, o número de processadores
+ *         disponíveis (no máximo `PARALLEL_SCAN_MAX_THREADS`).
+ */
+int parallelScanThreads(void);
+
+/**
+ * @brief Percorre as posições do arquivo de dados em paralelo.
+ *
+ * @pre `result` deve estar inicializado para ser combinado pela função `merge` da consulta.
+ *
+ * @param dataFile Ponteiro para o arquivo de dados.
+ * @param rowCount Número de posições a serem percorridas (normalmente `firstEmptyPosition`).
+ * @param query Ponteiro para a consulta.
+ * @param result Resultado final, que recebe os resultados parciais de todas as threads.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura, de memória ou de uma das funções da consulta.
+ */
+int parallelScan(FILE *dataFile, long rowCount, const ParallelScanQuery *query, void *result);
+
+#endif /* PARALLEL_SCAN_H */
@@ -0,0 +1,212 @@
+/**
+ * @file sharded_library.h
+ * @see sharded_library.c
+ *
+ * @brief Contém a biblioteca particionada: os livros são distribuídos entre vários pares de arquivos de dados e de
+ *        índices independentes.
+ *
+ * Cada partição (shard) é uma biblioteca comum (`Library`), com o seu próprio arquivo de dados, o seu próprio índice e
+ * os seus próprios cabeçalhos, alocadores e trava. O código do livro determina a partição, por hash (distribuição
+ * uniforme de qualquer conjunto de códigos) ou por faixas de códigos (cada partição guarda um intervalo contíguo, o
+ * que preserva a ordem dos códigos entre as partições). As funções de inserção, remoção, leitura e alteração de
+ * estoque e de preço apenas encaminham a operação para a biblioteca da partição do código.
+ *
+ * Como as partições não compartilham cabeçalhos nem nós, operações em partições diferentes podem ser executadas ao
+ * mesmo tempo por threads diferentes sem disputar a mesma trava (`shardedLibraryInsertMany` insere um lote com uma
+ * thread por partição). As partições são abertas com o acesso concorrente ligado: o cache de nós é compartilhado e a
+ * thread de uma partição pode gravar de volta um nó de outra, o que exige as gravações posicionais, e a trava de cada
+ * índice permite também várias threads na mesma partição. Os arquivos de cada partição seguem o formato de uma
+ * biblioteca comum e podem ser montados por processos diferentes, cada um abrindo a sua partição com
+ * `shardedLibraryOpenShard`.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef SHARDED_LIBRARY_H
+#define SHARDED_LIBRARY_H
+
+#include "book_manager.h"
+#include "library.h"
+
+/**
+ * @brief Número máximo de partições de uma biblioteca particionada.
+ */
+#define SHARDED_LIBRARY_MAX_SHARDS 16
+
+/**
+ * @brief Critério de distribuição dos códigos entre as partições.
+ */
+typedef enum
+{
+    SHARD_BY_HASH,  // Partição escolhida pelo hash do código
+    SHARD_BY_RANGE  // Partição escolhida pela faixa de códigos
+} ShardingMode;
+
+/**
+ * @brief Estrutura de Dados para a biblioteca particionada.
+ *
+ * - shards: Bibliotecas das partições.
+ * - shardCount: Número de partições.
+ * - mode: Critério de distribuição dos códigos.
+ * - rangeStarts: Primeiro código de cada partição (apenas em `SHARD_BY_RANGE`; a partição 0 começa em `INT_MIN`).
+ */
+typedef struct
+{
+    Library shards[SHARDED_LIBRARY_MAX_SHARDS]; // Bibliotecas das partições
+    int shardCount;                             // Número de partições
+    ShardingMode mode;                          // Critério de distribuição
+    int rangeStarts[SHARDED_LIBRARY_MAX_SHARDS]; // Primeiro código de cada partição (SHARD_BY_RANGE)
+} ShardedLibrary;
+
+/**
+ * @brief Abre (criando do zero) uma partição avulsa, com os mesmos nomes de arquivo usados por `shardedLibraryOpen`.
+ *
+ * Permite que cada processo mantenha apenas a sua partição.
+ *
+ * @param library Ponteiro para o handle a ser inicializado.
+ * @param prefix Prefixo dos nomes dos arquivos (`<prefixo>_books_<n>.bin` e `<prefixo>_TwoThreeTree_<n>.bin`).
+ * @param shard Número da partição.
+ * @param indexOrder Ordem do índice (`TWO_THREE_TREE_ORDER` para a árvore 2-3, valores maiores para o modo B+).
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int shardedLibraryOpenShard(Library *library, const char *prefix, int shard, int indexOrder);
+
+/**
+ * @brief Abre (criando do zero) uma biblioteca particionada.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada a ser inicializada.
+ * @param prefix Prefixo dos nomes dos arquivos das partições.
+ * @param shardCount Número de partições (de 1 a `SHARDED_LIBRARY_MAX_SHARDS`).
+ * @param indexOrder Ordem do índice de todas as partições.
+ * @param mode Critério de distribuição dos códigos.
+ * @param rangeStarts Em `SHARD_BY_RANGE`, o primeiro código de cada partição, em ordem crescente (o valor da partição 0
+ *                    é ignorado), ou NULL para dividir os códigos de 0 a `INT_MAX` em faixas iguais. Ignorado em
+ *                    `SHARD_BY_HASH`.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (nenhuma partição fica aberta).
+ *
+ * @note As partições são abertas com o acesso concorrente ligado (`libraryEnableConcurrency`).
+ */
+int shardedLibraryOpen(ShardedLibrary *sharded, const char *prefix, int shardCount, int indexOrder, ShardingMode mode,
+                       const int *rangeStarts);
+
+/**
+ * @brief Retorna a partição de um código.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ *
+ * @return O número da partição (de 0 a `shardCount - 1`).
+ */
+int shardedLibraryShardOf(const ShardedLibrary *sharded, int code);
+
+/**
+ * @brief Retorna a biblioteca da partição de um código.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ *
+ * @return Ponteiro para a biblioteca da partição.
+ */
+Library *shardedLibraryShard(ShardedLibrary *sharded, int code);
+
+/**
+ * @brief Insere um livro na partição do seu código (veja `insertBookRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param book Ponteiro para o livro a ser inserido.
+ *
+ * @return `BOOK_OK`, `BOOK_DUPLICATE`, `BOOK_INVALID_STOCK` ou -1, como `insertBookRecord`.
+ */
+int shardedLibraryInsert(ShardedLibrary *sharded, const Book *book);
+
+/**
+ * @brief Insere um lote de livros, com uma thread por partição.
+ *
+ * Os livros são agrupados por partição e cada grupo é inserido, na ordem do lote, por uma thread própria. Em
+ * plataformas sem `pthread`, os grupos são inseridos em sequência pela thread chamadora.
+ *
+ * @pre Nenhuma outra thread pode estar gravando na biblioteca particionada.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param books Livros a serem inseridos.
+ * @param n Número de livros.
+ * @param results Vetor que recebe o resultado (`BOOK_OK`, `BOOK_DUPLICATE`, `BOOK_INVALID_STOCK` ou -1) de cada
+ *        livro, ou NULL.
+ *
+ * @return O número de livros inseridos, ou -1 em caso de erro de memória.
+ */
+int shardedLibraryInsertMany(ShardedLibrary *sharded, const Book *books, int n, int *results);
+
+/**
+ * @brief Remove um livro da partição do seu código (veja `deleteBookRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ *
+ * @return `BOOK_OK`, `BOOK_NOT_FOUND` ou -1, como `deleteBookRecord`.
+ */
+int shardedLibraryRemove(ShardedLibrary *sharded, int code);
+
+/**
+ * @brief Lê um livro da partição do seu código (veja `readBookRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ * @param book Ponteiro para a estrutura que recebe o livro lido.
+ *
+ * @return `BOOK_OK`, `BOOK_NOT_FOUND` ou -1, como `readBookRecord`.
+ */
+int shardedLibraryRead(ShardedLibrary *sharded, int code, Book *book);
+
+/**
+ * @brief Altera o estoque de um livro na partição do seu código (veja `adjustBookStockRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ * @param delta Variação da quantidade em estoque.
+ *
+ * @return `BOOK_OK`, `BOOK_NOT_FOUND`, `BOOK_INSUFFICIENT_STOCK` ou -1, como `adjustBookStockRecord`.
+ */
+int shardedLibraryAdjustStock(ShardedLibrary *sharded, int code, int delta);
+
+/**
+ * @brief Altera o preço e/ou o estoque de um livro na partição do seu código (veja `updateBookRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param update Ponteiro para a atualização.
+ *
+ * @return `BOOK_OK`, `BOOK_NOT_FOUND`, `BOOK_INVALID_PRICE`, `BOOK_INSUFFICIENT_STOCK` ou -1, como
+ *         `updateBookRecord`.
+ */
+int shardedLibraryUpdate(ShardedLibrary *sharded, const BookUpdate *update);
+
+/**
+ * @brief Retorna o número de livros de todas as partições.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ *
+ * @return A soma dos números de livros dos cabeçalhos das partições.
+ */
+long shardedLibraryBookCount(const ShardedLibrary *sharded);
+
+/**
+ * @brief Grava no disco as alterações pendentes de todas as partições (veja `libraryCommit`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ *
+ * @return 0 em caso de sucesso, -1 se a gravação de alguma partição falhar.
+ */
+int shardedLibraryCommit(ShardedLibrary *sharded);
+
+/**
+ * @brief Grava as alterações pendentes e fecha os arquivos de todas as partições.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada.
+ *
+ * @return 0 em caso de sucesso, -1 se o fechamento de alguma partição falhar.
+ */
+int shardedLibraryClose(ShardedLibrary *sharded);
+
+#endif /* SHARDED_LIBRARY_H */
@@ -0,0 +1,311 @@
+/**
+ * @file storage.h
+ * @see storage.c
+ *
+ * @brief Contém a interface de acesso aos arquivos binários da biblioteca (dados e índices).
+ *
+ * Todas as leituras e gravações de registros, nós e cabeçalhos passam por `storageRead` e `storageWrite`, que
+ * recebem o deslocamento absoluto no arquivo. Por padrão o acesso é feito com `fseek`/`fread`/`fwrite`; depois de
+ * `storageMap`, o arquivo é mapeado em memória (`mmap`) e cada acesso se torna uma cópia de memória. O mapeamento
+ * cresce em blocos de `STORAGE_MAP_CHUNK` bytes e o tamanho real do arquivo é restaurado em `storageUnmap`.
+ *
+ * Em plataformas sem `mmap`, `storageMap` retorna -1 e o acesso continua pelo caminho com `FILE*`.
+ *
+ * @warning Enquanto o arquivo estiver mapeado, ele não deve ser acessado diretamente com as funções de `stdio`.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Tamanho (em bytes) dos blocos em que os mapeamentos crescem.
+ */
+#define STORAGE_MAP_CHUNK (16L * 1024 * 1024)
+
+/**
+ * @brief Número máximo de arquivos mapeados ao mesmo tempo.
+ */
+#define STORAGE_MAX_MAPPINGS 40
+
+/**
+ * @brief Tamanho (em bytes) da janela de leitura antecipada das varreduras sequenciais (`StorageReadAhead`).
+ */
+#define STORAGE_PREFETCH_WINDOW (1L << 20)
+
+/**
+ * @brief Número de leituras aleatórias (registros ou nós) antecipadas à frente da leitura corrente.
+ */
+#define STORAGE_PREFETCH_DEPTH 16
+
+/**
+ * @brief Estado da leitura antecipada de uma varredura sequencial.
+ *
+ * - file: Arquivo percorrido.
+ * - next: Início do trecho ainda não antecipado.
+ * - end: Final do trecho percorrido pela varredura.
+ */
+typedef struct
+{
+    FILE *file; // Arquivo percorrido
+    long next;  // Início do trecho ainda não antecipado
+    long end;   // Final da varredura
+} StorageReadAhead;
+
+/**
+ * @brief Função chamada por `storageWrite` antes de cada gravação em um arquivo observado.
+ *
+ * Recebe os mesmos argumentos da gravação e o contexto registrado em `storageSetWriteHook`. Se retornar 0, a gravação
+ * é realizada; se retornar 1, a função assumiu a gravação (por exemplo, retendo-a em memória) e `storageWrite`
+ * retorna 0 sem gravar; qualquer outro valor faz `storageWrite` retornar -1 sem gravar.
+ */
+typedef int (*StorageWriteHook)(FILE *file, long offset, const void *buffer, size_t size, void *context);
+
+/**
+ * @brief Função chamada por `storageRead` e `storagePread` depois de cada leitura bem-sucedida de um arquivo observado.
+ *
+ * Recebe os mesmos argumentos da leitura e o contexto registrado em `storageSetReadHook`, e pode alterar os bytes lidos
+ * (por exemplo, para que as gravações retidas por uma `StorageWriteHook` sejam vistas pelas leituras).
+ */
+typedef void (*StorageReadHook)(FILE *file, long offset, void *buffer, size_t size, void *context);
+
+/**
+ * @brief Lê `size` bytes do arquivo a partir do deslocamento `offset`.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param buffer Destino dos dados lidos.
+ * @param size Número de bytes a serem lidos.
+ *
+ * @return 0 em caso de sucesso, -1 se a leitura falhar ou ultrapassar o final do arquivo.
+ */
+int storageRead(FILE *file, long offset, void *buffer, size_t size);
+
+/**
+ * @brief Lê `size` bytes do arquivo a partir do deslocamento `offset`, sem usar a posição corrente do `FILE*`.
+ *
+ * Ao contrário de `storageRead`, a leitura não altera o estado do `FILE*` (usa `pread` no descritor, ou copia do
+ * mapeamento), de modo que várias threads podem ler o mesmo arquivo ao mesmo tempo.
+ *
+ * @pre As gravações pendentes no buffer do `FILE*` devem ter sido repassadas com `storageFlush`, e nenhuma gravação
+ *      no arquivo pode ocorrer durante as leituras.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param buffer Destino dos dados lidos.
+ * @param size Número de bytes a serem lidos.
+ *
+ * @return 0 em caso de sucesso, -1 se a leitura falhar ou ultrapassar o final do arquivo.
+ *
+ * @note Em plataformas sem `pread`, equivale a `storageRead` e não pode ser usada por várias threads.
+ */
+int storagePread(FILE *file, long offset, void *buffer, size_t size);
+
+/**
+ * @brief Grava `size` bytes no arquivo a partir do deslocamento `offset`.
+ *
+ * Gravações além do final do arquivo o estendem, como com `fwrite`. Se houver uma função registrada com
+ * `storageSetWriteHook` para o arquivo, ela é chamada antes da gravação e pode assumi-la (veja `StorageWriteHook`).
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param buffer Dados a serem gravados.
+ * @param size Número de bytes a serem gravados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int storageWrite(FILE *file, long offset, const void *buffer, size_t size);
+
+/**
+ * @brief Retorna o tamanho atual (em bytes) do arquivo.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return Tamanho do arquivo, ou -1 em caso de erro.
+ *
+ * @note Para arquivos mapeados é retornado o tamanho lógico (até o último byte gravado), e não o tamanho do mapeamento.
+ */
+long storageSize(FILE *file);
+
+/**
+ * @brief Reduz o arquivo ao tamanho informado, descartando o conteúdo seguinte.
+ *
+ * @param file Ponteiro para o arquivo, que não pode estar mapeado.
+ * @param size Novo tamanho (em bytes) do arquivo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro ou se o arquivo estiver mapeado.
+ *
+ * @note Em plataformas sem `ftruncate`, o arquivo mantém o seu tamanho e a chamada retorna 0.
+ */
+int storageTruncate(FILE *file, long size);
+
+/**
+ * @brief Retorna um ponteiro para os dados do arquivo mapeado, sem cópia.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param size Número de bytes que serão acessados.
+ *
+ * @return Ponteiro para os dados, ou NULL se o arquivo não estiver mapeado, o intervalo ultrapassar o seu final ou
+ *         houver uma função registrada com `storageSetReadHook` para o arquivo.
+ *
+ * @warning O ponteiro deixa de ser válido na próxima gravação que estender o arquivo e em `storageUnmap`.
+ */
+const void *storagePointer(FILE *file, long offset, size_t size);
+
+/**
+ * @brief Garante que as gravações feitas no arquivo foram repassadas ao sistema operacional.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int storageFlush(FILE *file);
+
+/**
+ * @brief Garante que o conteúdo do arquivo foi gravado no dispositivo (`msync`/`fsync`).
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ *
+ * @note Em plataformas sem `fsync`, equivale a `storageFlush`.
+ */
+int storageSync(FILE *file);
+
+/**
+ * @brief Registra uma função a ser chamada antes de cada gravação no arquivo.
+ *
+ * @param file Ponteiro para o arquivo observado.
+ * @param hook Função a ser chamada, ou NULL para remover o registro.
+ * @param context Ponteiro repassado à função a cada chamada.
+ *
+ * @return 0 em caso de sucesso, -1 se o limite de arquivos observados for atingido.
+ */
+int storageSetWriteHook(FILE *file, StorageWriteHook hook, void *context);
+
+/**
+ * @brief Registra uma função a ser chamada depois de cada leitura do arquivo.
+ *
+ * @param file Ponteiro para o arquivo observado.
+ * @param hook Função a ser chamada, ou NULL para remover o registro.
+ * @param context Ponteiro repassado à função a cada chamada.
+ *
+ * @return 0 em caso de sucesso, -1 se o limite de arquivos observados for atingido.
+ */
+int storageSetReadHook(FILE *file, StorageReadHook hook, void *context);
+
+/**
+ * @brief Passa a acessar o arquivo por meio de um mapeamento em memória.
+ *
+ * @param file Ponteiro para o arquivo, aberto em modo de leitura e escrita.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo já estiver mapeado), -1 se o mapeamento não estiver disponível.
+ */
+int storageMap(FILE *file);
+
+/**
+ * @brief Desfaz o mapeamento do arquivo, restaurando o seu tamanho real.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo não estiver mapeado), -1 em caso de erro.
+ *
+ * @post O arquivo volta a ser acessado com as funções de `stdio`.
+ */
+int storageUnmap(FILE *file);
+
+/**
+ * @brief Informa se o arquivo está mapeado em memória.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 1 se o arquivo estiver mapeado, 0 caso contrário.
+ */
+int storageIsMapped(FILE *file);
+
+/**
+ * @brief Liga ou desliga o acesso posicional ao arquivo.
+ *
+ * No acesso posicional, as leituras e gravações de arquivos não mapeados usam `pread` e `pwrite` no descritor, sem
+ * o buffer nem a posição corrente do `FILE*`, de modo que várias threads podem ler o arquivo ao mesmo tempo (as
+ * gravações continuam exigindo acesso exclusivo, garantido por quem chama). Arquivos mapeados já são lidos sem
+ * usar o `FILE*`.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param enabled 1 para ligar, 0 para desligar.
+ *
+ * @return 0 em caso de sucesso, -1 se o limite de arquivos for atingido ou se a plataforma não tiver `pread`.
+ *
+ * @note Deve ser chamada antes de o arquivo passar a ser usado por várias threads.
+ */
+int storageSetPositional(FILE *file, int enabled);
+
+/**
+ * @brief Informa se o arquivo está com o acesso posicional ligado.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 1 se o acesso posicional estiver ligado, 0 caso contrário.
+ */
+int storageIsPositional(FILE *file);
+
+/**
+ * @brief Avisa que um trecho do arquivo será lido em breve, sem esperar pela leitura.
+ *
+ * O sistema operacional começa a trazer o trecho para o cache de páginas em segundo plano e a chamada retorna
+ * imediatamente; a leitura posterior (`storageRead`/`storagePread`) encontra os dados já em memória. Várias chamadas
+ * seguidas mantêm várias leituras em andamento ao mesmo tempo, o que aproveita a fila de comandos do dispositivo.
+ * Arquivos mapeados usam `madvise(MADV_WILLNEED)`; os demais, `posix_fadvise(POSIX_FADV_WILLNEED)` no descritor.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param size Número de bytes que serão lidos.
+ *
+ * @note Sem a leitura antecipada ligada (`storageSetPrefetch`) ou em plataformas sem esses avisos, a chamada não
+ *       tem efeito. Os avisos nunca alteram o conteúdo lido.
+ */
+void storagePrefetch(FILE *file, long offset, size_t size);
+
+/**
+ * @brief Liga ou desliga a leitura antecipada de todos os arquivos (ligada por padrão).
+ *
+ * @param enabled 1 para ligar, 0 para desligar.
+ */
+void storageSetPrefetch(int enabled);
+
+/**
+ * @brief Informa se a leitura antecipada está ligada.
+ *
+ * @return 1 se estiver ligada, 0 caso contrário.
+ */
+int storagePrefetchEnabled(void);
+
+/**
+ * @brief Inicia a leitura antecipada de uma varredura sequencial do trecho [`start`, `end`) do arquivo.
+ *
+ * A primeira janela de `STORAGE_PREFETCH_WINDOW` bytes é antecipada imediatamente.
+ *
+ * @param readAhead Ponteiro para o estado a ser inicializado.
+ * @param file Ponteiro para o arquivo.
+ * @param start Deslocamento (em bytes) da primeira leitura da varredura.
+ * @param end Deslocamento (em bytes) do final da varredura.
+ */
+void storageReadAheadStart(StorageReadAhead *readAhead, FILE *file, long start, long end);
+
+/**
+ * @brief Avança a leitura antecipada até a leitura que está para ser feita.
+ *
+ * Quando a varredura alcança a metade da última janela antecipada, a janela seguinte é antecipada, de modo que o
+ * dispositivo trabalha à frente da varredura.
+ *
+ * @param readAhead Ponteiro para o estado iniciado com `storageReadAheadStart`.
+ * @param offset Deslocamento (em bytes) da próxima leitura da varredura.
+ */
+void storageReadAheadAdvance(StorageReadAhead *readAhead, long offset);
+
+#endif /* STORAGE_H */
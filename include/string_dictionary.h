@@ -0,0 +1,132 @@
+/**
+ * @file string_dictionary.h
+ * @see string_dictionary.c
+ *
+ * @brief Contém o dicionário de strings usado na codificação por dicionário das colunas de texto.
+ *
+ * O dicionário associa cada valor distinto (já normalizado, como as chaves de `book_stats.h`) a um identificador
+ * inteiro, atribuído em ordem de inserção a partir de 0. Os identificadores nunca mudam enquanto o dicionário está
+ * aberto, de modo que as colunas podem guardar apenas o identificador de cada valor e os agrupamentos podem ser
+ * feitos sobre inteiros, sem comparações de strings.
+ *
+ * A busca de um valor usa uma tabela hash com endereçamento aberto sobre os identificadores. O arquivo do
+ * dicionário só recebe acréscimos: `StringDictionaryHeader` seguido dos valores, cada um com
+ * `STRING_DICTIONARY_VALUE_SIZE` bytes, na ordem dos identificadores.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef STRING_DICTIONARY_H
+#define STRING_DICTIONARY_H
+
+#include "book_stats.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Tamanho (com o terminador) de cada valor do dicionário.
+ */
+#define STRING_DICTIONARY_VALUE_SIZE BOOK_STATS_KEY_SIZE
+
+/**
+ * @brief Capacidade inicial (em valores) do dicionário. Deve ser potência de 2.
+ */
+#define STRING_DICTIONARY_INITIAL_CAPACITY 64
+
+/**
+ * @brief Estrutura de Dados para o cabeçalho do arquivo do dicionário.
+ *
+ * - count: Número de valores gravados.
+ */
+typedef struct
+{
+    int count; // Valores gravados
+} StringDictionaryHeader;
+
+/**
+ * @brief Dicionário de strings aberto.
+ */
+typedef struct
+{
+    FILE *file;                                   // Arquivo do dicionário (NULL se não estiver aberto)
+    StringDictionaryHeader header;                // Cabeçalho (versão em memória)
+    char (*values)[STRING_DICTIONARY_VALUE_SIZE]; // Valor de cada identificador
+    int capacity;                                 // Valores reservados em `values`
+    int *slots;                                   // Tabela hash de identificadores (-1 se livre)
+    int slotCapacity;                             // Entradas da tabela (potência de 2, o dobro de `capacity`)
+    int flushedCount;                             // Valores já gravados no arquivo
+} StringDictionary;
+
+/**
+ * @brief Cria um novo dicionário vazio.
+ *
+ * @pre `dictionary` e `filename` não devem ser NULL.
+ *
+ * @param dictionary Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo do dicionário.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int stringDictionaryCreate(StringDictionary *dictionary, const char *filename);
+
+/**
+ * @brief Abre um dicionário existente, carregando os seus valores para a memória.
+ *
+ * @pre `dictionary` e `filename` não devem ser NULL.
+ *
+ * @param dictionary Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo do dicionário.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser lido ou estiver inconsistente.
+ */
+int stringDictionaryOpen(StringDictionary *dictionary, const char *filename);
+
+/**
+ * @brief Procura o identificador de um valor.
+ *
+ * @param dictionary Ponteiro para o dicionário aberto.
+ * @param value Valor normalizado.
+ *
+ * @return O identificador do valor, ou -1 se ele não estiver no dicionário.
+ */
+int stringDictionaryFind(const StringDictionary *dictionary, const char *value);
+
+/**
+ * @brief Retorna o identificador de um valor, acrescentando-o ao dicionário se necessário.
+ *
+ * @param dictionary Ponteiro para o dicionário aberto.
+ * @param value Valor normalizado (com menos de `STRING_DICTIONARY_VALUE_SIZE` caracteres).
+ *
+ * @return O identificador do valor, ou -1 em caso de erro de memória.
+ */
+int stringDictionaryIntern(StringDictionary *dictionary, const char *value);
+
+/**
+ * @brief Retorna o valor de um identificador.
+ *
+ * @param dictionary Ponteiro para o dicionário aberto.
+ * @param id Identificador (entre 0 e `header.count - 1`).
+ *
+ * @return O valor normalizado.
+ */
+const char *stringDictionaryValue(const StringDictionary *dictionary, int id);
+
+/**
+ * @brief Grava no arquivo os valores acrescentados desde a última gravação.
+ *
+ * @param dictionary Ponteiro para o dicionário aberto.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int stringDictionaryFlush(StringDictionary *dictionary);
+
+/**
+ * @brief Grava os valores pendentes e fecha o dicionário.
+ *
+ * @param dictionary Ponteiro para o dicionário.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int stringDictionaryClose(StringDictionary *dictionary);
+
+#endif /* STRING_DICTIONARY_H */
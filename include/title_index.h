@@ -0,0 +1,171 @@
+/**
+ * @file title_index.h
+ * @see title_index.c
+ *
+ * @brief Contém o índice secundário persistente e ordenado de livros por título.
+ *
+ * O índice é uma árvore 2-3 gravada em arquivo cujas chaves são os títulos normalizados (`normalizeString`). Para
+ * permitir títulos repetidos, cada chave é o par (título, posição do livro). Como as chaves ficam ordenadas, o índice
+ * responde tanto a buscas exatas quanto a buscas por prefixo ("começa com"), devolvendo os livros em ordem de título.
+ *
+ * A remoção é preguiçosa: a chave é apenas marcada como removida no nó, sem redistribuições nem fusões. As chaves
+ * removidas são ignoradas pelas buscas e a posição ocupada por elas é reaproveitada quando a mesma chave é reinserida.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef TITLE_INDEX_H
+#define TITLE_INDEX_H
+
+#include <stdio.h>
+
+/**
+ * @brief Tamanho (com o terminador) de um título armazenado no índice. Igual ao campo `title` de `Book`.
+ */
+#define TITLE_INDEX_KEY_SIZE 151
+
+/**
+ * @brief Estrutura de Dados para o cabeçalho do arquivo do índice de títulos.
+ *
+ * - rootAddress: Posição (número do nó) da raiz da árvore, -1 se a árvore estiver vazia.
+ * - firstEmptyPosition: Posição do primeiro nó nunca utilizado.
+ * - keyCount: Número de chaves válidas (não removidas) no índice.
+ */
+typedef struct
+{
+    int rootAddress;        // Nó raiz da árvore
+    int firstEmptyPosition; // Primeiro nó nunca utilizado
+    int keyCount;           // Número de chaves válidas
+} TitleIndexHeader;
+
+/**
+ * @brief Estrutura de Dados para um nó da árvore do índice de títulos.
+ *
+ * - nKeys: Número de chaves do nó (1 ou 2).
+ * - keys: Títulos normalizados, em ordem crescente.
+ * - bookPositions: Posição do livro de cada chave no arquivo de dados.
+ * - deleted: 1 se a chave correspondente foi removida.
+ * - children: Filhos do nó (-1 nas folhas). O filho `i` contém as chaves menores que `keys[i]`.
+ */
+typedef struct
+{
+    int nKeys;
+    char keys[2][TITLE_INDEX_KEY_SIZE];
+    int bookPositions[2];
+    char deleted[2];
+    int children[3];
+} TitleIndexNode;
+
+/**
+ * @brief Índice de títulos aberto.
+ *
+ * O cabeçalho fica em memória enquanto o índice está aberto e só é gravado em `titleIndexFlush` ou `titleIndexClose`.
+ */
+typedef struct
+{
+    FILE *file;              // Arquivo do índice (NULL se o índice não estiver aberto)
+    TitleIndexHeader header; // Cabeçalho (versão válida)
+    int dirty;               // 1 se o cabeçalho precisa ser gravado
+} TitleIndex;
+
+/**
+ * @brief Cria um novo índice de títulos vazio.
+ *
+ * @pre `index` e `filename` não devem ser NULL.
+ *
+ * @post O arquivo é criado (ou truncado) e o índice fica aberto, com o cabeçalho em memória.
+ *
+ * @param index Ponteiro para a estrutura do índice a ser inicializada.
+ * @param filename Nome do arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int titleIndexCreate(TitleIndex *index, const char *filename);
+
+/**
+ * @brief Abre um índice de títulos existente.
+ *
+ * @pre `index` e `filename` não devem ser NULL.
+ *
+ * @post O índice fica aberto, com o cabeçalho lido do arquivo para a memória.
+ *
+ * @param index Ponteiro para a estrutura do índice a ser inicializada.
+ * @param filename Nome do arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser lido ou estiver inconsistente.
+ */
+int titleIndexOpen(TitleIndex *index, const char *filename);
+
+/**
+ * @brief Insere a associação entre um título e a posição de um livro.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param title Título do livro (não precisa estar normalizado).
+ * @param bookPosition Posição do livro no arquivo de dados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura ou gravação.
+ */
+int titleIndexInsert(TitleIndex *index, const char *title, int bookPosition);
+
+/**
+ * @brief Remove a associação entre um título e a posição de um livro.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param title Título usado na inserção.
+ * @param bookPosition Posição do livro no arquivo de dados.
+ *
+ * @return 0 se a chave foi removida, -1 se não foi encontrada ou em caso de erro.
+ *
+ * @note A chave é apenas marcada como removida; a estrutura da árvore não é alterada.
+ */
+int titleIndexRemove(TitleIndex *index, const char *title, int bookPosition);
+
+/**
+ * @brief Retorna, em ordem de título, as posições dos livros cujo título é igual ao informado ou começa por ele.
+ *
+ * Apenas as subárvores que podem conter títulos no intervalo buscado são visitadas.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param query Título (ou prefixo) a ser buscado. A comparação ignora maiúsculas e espaços extras.
+ * @param prefixMatch 0 para busca exata, diferente de 0 para busca por prefixo.
+ * @param limit Número máximo de posições retornadas (0 para não limitar).
+ * @param count Ponteiro onde será armazenado o número de posições retornadas.
+ *
+ * @return Vetor alocado dinamicamente com as posições (deve ser liberado com `free`), ou NULL se nenhum livro
+ *         for encontrado.
+ */
+int *titleIndexSearch(TitleIndex *index, const char *query, int prefixMatch, int limit, int *count);
+
+/**
+ * @brief Remove todas as chaves do índice, mantendo o arquivo aberto.
+ *
+ * Usada para reconstruir o índice quando as posições dos livros mudam (por exemplo, na compactação). As chaves
+ * marcadas como removidas também deixam de ocupar o arquivo.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ *
+ * @post O arquivo é truncado para o cabeçalho.
+ */
+int titleIndexClear(TitleIndex *index);
+
+/**
+ * @brief Grava no arquivo o cabeçalho do índice, caso tenha sido modificado.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int titleIndexFlush(TitleIndex *index);
+
+/**
+ * @brief Grava as alterações pendentes e fecha o índice de títulos.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int titleIndexClose(TitleIndex *index);
+
+#endif /* TITLE_INDEX_H */
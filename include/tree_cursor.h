@@ -0,0 +1,119 @@
+/**
+ * @file tree_cursor.h
+ * @see tree_cursor.c
+ *
+ * @brief Contém o cursor para percorrer em ordem um intervalo de chaves do arquivo de índices.
+ *
+ * O cursor é posicionado uma única vez na primeira chave do intervalo e, a partir daí, avança sem voltar à raiz:
+ * na árvore 2-3 ele guarda o caminho percorrido em uma pilha explícita e, no modo B+, segue o encadeamento das
+ * folhas. Os livros podem ser lidos em lotes com `treeRangeNextBooks`, que agrupa as leituras do arquivo de dados.
+ *
+ * Com o acesso concorrente ligado (`treeLockEnable`), o cursor detém a trava de leitura do índice de
+ * `treeRangeBegin` até `treeRangeEnd`; a thread que o usa não pode alterar o índice enquanto ele estiver aberto.
+ *
+ * Exemplo de uso:
+ * @code
+ * TreeCursor cursor;
+ * Book books[64];
+ * int n;
+ *
+ * treeRangeBegin(&cursor, indexFile, 100, 200);
+ * while ((n = treeRangeNextBooks(&cursor, dataFile, books, 64)) > 0)
+ * {
+ *     // ...
+ * }
+ * treeRangeEnd(&cursor);
+ * @endcode
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef TREE_CURSOR_H
+#define TREE_CURSOR_H
+
+#include "book.h"
+#include "two_three_tree.h"
+#include "bplus_tree.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Altura máxima da árvore 2-3 suportada pelo cursor.
+ */
+#define TREE_CURSOR_MAX_DEPTH 48
+
+/**
+ * @brief Nó da pilha do cursor na árvore 2-3.
+ *
+ * - node: Nó visitado.
+ * - next: Índice (0 ou 1) da próxima chave do nó a ser retornada; igual a `nKeys` quando o nó já foi esgotado.
+ */
+typedef struct
+{
+    Node23 node;
+    int next;
+} TreeCursorFrame;
+
+/**
+ * @brief Cursor sobre um intervalo de chaves [low, high] do arquivo de índices.
+ *
+ * Os campos devem ser tratados como privados e manipulados apenas pelas funções `treeRange*`.
+ */
+typedef struct
+{
+    FILE *indexFile;                              // Arquivo de índices percorrido
+    int high;                                     // Maior chave do intervalo
+    int finished;                                 // 1 quando não há mais chaves no intervalo
+    int depth;                                    // Número de nós na pilha (árvore 2-3)
+    TreeCursorFrame stack[TREE_CURSOR_MAX_DEPTH]; // Caminho da raiz até o nó atual (árvore 2-3)
+    BPlusNode *leaf;                              // Folha atual (modo B+), NULL na árvore 2-3
+    int leafIndex;                                // Próxima chave da folha atual (modo B+)
+    int locked;                                   // 1 se o cursor detém a trava de leitura do índice
+} TreeCursor;
+
+/**
+ * @brief Posiciona o cursor na primeira chave maior ou igual a `low`.
+ *
+ * @param cursor Ponteiro para o cursor a ser inicializado.
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param low Menor chave do intervalo.
+ * @param high Maior chave do intervalo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro. O cursor deve ser liberado com `treeRangeEnd` em ambos os casos.
+ */
+int treeRangeBegin(TreeCursor *cursor, FILE *indexFile, int low, int high);
+
+/**
+ * @brief Avança o cursor para a próxima chave do intervalo.
+ *
+ * @param cursor Ponteiro para o cursor.
+ * @param key Ponteiro onde a chave será armazenada.
+ * @param bookPosition Ponteiro onde a posição do livro associado será armazenada.
+ *
+ * @return 1 se uma chave foi retornada, 0 se o intervalo terminou, -1 em caso de erro.
+ */
+int treeRangeNext(TreeCursor *cursor, int *key, int *bookPosition);
+
+/**
+ * @brief Lê, em ordem de chave, os próximos livros do intervalo.
+ *
+ * As posições dos livros do lote são ordenadas e registros consecutivos no arquivo de dados são lidos com uma
+ * única leitura. Os livros são devolvidos na ordem das chaves.
+ *
+ * @param cursor Ponteiro para o cursor.
+ * @param dataFile Ponteiro para o arquivo de dados.
+ * @param books Vetor onde os livros serão armazenados.
+ * @param maxBooks Capacidade do vetor `books`.
+ *
+ * @return Número de livros lidos (0 quando o intervalo terminou), ou -1 em caso de erro.
+ */
+int treeRangeNextBooks(TreeCursor *cursor, FILE *dataFile, Book *books, int maxBooks);
+
+/**
+ * @brief Libera os recursos do cursor.
+ *
+ * @param cursor Ponteiro para o cursor.
+ */
+void treeRangeEnd(TreeCursor *cursor);
+
+#endif /* TREE_CURSOR_H */
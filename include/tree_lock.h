@@ -0,0 +1,88 @@
+/**
+ * @file tree_lock.h
+ * @see tree_lock.c
+ *
+ * @brief Contém o protocolo de leitores e escritores do arquivo de índices.
+ *
+ * Com o acesso concorrente ligado (`treeLockEnable`), cada arquivo de índices tem uma trava de leitura e escrita:
+ * as buscas e os cursores obtêm a trava para leitura e podem ser executados em paralelo, enquanto as inserções,
+ * remoções e construções do índice a obtêm para escrita, de forma exclusiva. Como no cache de nós e nos cabeçalhos
+ * anexados, a trava é identificada pelo `FILE*` do arquivo.
+ *
+ * A trava é reentrante na mesma thread: uma operação que já a detém (por exemplo, `removeKey`, que busca a chave
+ * antes de removê-la, ou uma inserção de livro que detém a trava de escrita durante toda a operação) pode obtê-la
+ * novamente. Uma thread que detém apenas a trava de leitura não pode obtê-la para escrita.
+ *
+ * Para arquivos sem o acesso concorrente ligado, as funções não fazem nada, de modo que o custo para o uso em uma
+ * única thread é apenas a consulta ao registro.
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef TREE_LOCK_H
+#define TREE_LOCK_H
+
+#include <stdio.h>
+
+/**
+ * @brief Número máximo de arquivos de índices com o acesso concorrente ligado ao mesmo tempo.
+ */
+#define TREE_LOCK_MAX_FILES 40
+
+/**
+ * @brief Liga o acesso concorrente ao arquivo de índices, criando a sua trava.
+ *
+ * @pre Nenhuma outra thread pode estar usando o arquivo.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ *
+ * @return 0 em caso de sucesso (ou se já estiver ligado), -1 se o limite de arquivos for atingido ou se a
+ *         plataforma não tiver `pthread`.
+ */
+int treeLockEnable(FILE *indexFile);
+
+/**
+ * @brief Desliga o acesso concorrente ao arquivo de índices, destruindo a sua trava.
+ *
+ * @pre Nenhuma outra thread pode estar usando o arquivo, e a trava não pode estar obtida.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ */
+void treeLockDisable(FILE *indexFile);
+
+/**
+ * @brief Informa se o acesso concorrente ao arquivo de índices está ligado.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ *
+ * @return 1 se estiver ligado, 0 caso contrário.
+ */
+int treeLockIsEnabled(FILE *indexFile);
+
+/**
+ * @brief Obtém a trava do arquivo de índices para leitura.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ *
+ * @return 0 em caso de sucesso (ou se o acesso concorrente não estiver ligado), -1 em caso de erro.
+ */
+int treeLockRead(FILE *indexFile);
+
+/**
+ * @brief Obtém a trava do arquivo de índices para escrita.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ *
+ * @return 0 em caso de sucesso (ou se o acesso concorrente não estiver ligado), -1 em caso de erro ou se a thread
+ *         detiver apenas a trava de leitura.
+ */
+int treeLockWrite(FILE *indexFile);
+
+/**
+ * @brief Libera a trava obtida com `treeLockRead` ou `treeLockWrite`.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ */
+void treeUnlock(FILE *indexFile);
+
+#endif /* TREE_LOCK_H */
@@ -10,6 +10,15 @@
 #ifndef TREE_MANAGER_H
 #define TREE_MANAGER_H
 
+#include "two_three_tree.h"
+
+#include <stdio.h>
+
+/**
+ * @brief Altura máxima da árvore 2-3 percorrida pela inserção e pela remoção (suficiente para mais de 2^31 chaves).
+ */
+#define TREE_PATH_MAX_HEIGHT 32
+
 /**
  * @brief Cria um nó 2-3 no arquivo de índices.
  *
@@ -32,16 +41,18 @@
  * @param middleChild Filho do meio, que aponta para a subárvore entre as chaves.
  * @param rightChild Filho da direita, que aponta para a subárvore à direita do nó.
  * @param nKeys Número de chaves no nó. Deve ser 2 para um nó 2-3 válido.
+ * @param hint Deslocamento de um nó relacionado (por exemplo, o irmão do novo nó), usado para alocar o novo nó
+ *             perto dele, ou -1 para o menor endereço livre.
  * @param header Ponteiro para o cabeçalho do arquivo de índices, contendo informações como a posição do
  *               primeiro nó livre.
  *
  * @return Inteiro representando o deslocamento (offset) do nó no arquivo de índices. Retorna -1 se houver
  *         algum erro durante o processo de criação ou gravação do nó.
  *
- * @note A função pode reutilizar um nó previamente apagado (se houver um nó livre), atualizando a posição
- *       do nó livre e o deslocamento do nó a ser reutilizado.
+ * @note A alocação é feita pelo alocador de unidades (`allocateIndexNode`), que reutiliza o nó livre mais
+ *       próximo de `hint` sem ler o arquivo e estende o arquivo em lotes quando não há nós livres.
  */
-int createNode23(FILE *indexFile, int leftKey, int rightKey, int leftBook, int rightBook, int leftChild, int middleChild, int rightChild, int nKeys, IndexFileHeader *header);
+int createNode23(FILE *indexFile, int leftKey, int rightKey, int leftBook, int rightBook, int leftChild, int middleChild, int rightChild, int nKeys, int hint, IndexFileHeader *header);
 
 /**
  * @brief Carrega um nó do arquivo de índices.
@@ -58,7 +69,8 @@ int createNode23(FILE *indexFile, int leftKey, int rightKey, int leftBook, int r
  *
  * @return Nó carregado do arquivo de índices.
  *
- * @note O nó é carregado a partir do deslocamento especificado no arquivo de índices.
+ * @note O nó é carregado a partir do deslocamento especificado no arquivo de índices. Se o nó estiver
+ *       no cache de nós, nenhum acesso ao arquivo é realizado.
  */
 Node23 loadNode23(FILE *indexFile, int offset);
 
@@ -101,21 +113,51 @@ int getRootAddress(FILE *file);
  * @param file Ponteiro para o arquivo de índices, onde os nós da árvore 2-3 estão armazenados.
  * @param key Chave a ser buscada na árvore 2-3.
  *
- * @return Inteiro representando o endereço do nó na árvore 2-3 (arquivo de índices),
- *         ou -1 se a árvore estiver vazia.
+ * @return Posição do livro associado à chave no arquivo de dados, ou -1 se a chave não for encontrada
+ *         ou se a árvore estiver vazia.
  *
  * @note A função obtém o endereço da raiz da árvore 2-3 através da função `getRootAddress`
  *       e inicia a busca pela função `searchNode`. Se a árvore estiver vazia (não houver raiz),
  *       a função retorna -1.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a busca é delegada a `bplusTreeSearch`.
+ *
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), a busca obtém a trava do índice para leitura e pode ser
+ *       executada por várias threads ao mesmo tempo.
  */
 int twoThreeTreeSearch(FILE *file, int key);
 
+/**
+ * @brief Busca um lote de chaves na árvore com uma única descida compartilhada.
+ *
+ * As chaves são ordenadas e distribuídas entre os filhos de cada nó visitado: cada nó é lido uma única vez para
+ * todas as chaves do lote que passam por ele, de modo que os caminhos com prefixo comum (a raiz e os níveis
+ * superiores, para lotes grandes) não são relidos, e o cabeçalho é consultado apenas uma vez.
+ *
+ * @pre O arquivo de índices deve estar aberto no modo de leitura e escrita.
+ *
+ * @param file Ponteiro para o arquivo de índices.
+ * @param keys Chaves a serem buscadas, em qualquer ordem (podem se repetir).
+ * @param n Número de chaves.
+ * @param positions Vetor que recebe, na ordem de `keys`, a posição do livro de cada chave no arquivo de dados
+ *                  (-1 se a chave não for encontrada).
+ *
+ * @return Número de chaves encontradas, ou -1 em caso de erro de memória ou de leitura.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a busca é delegada a `bplusTreeSearchMany`.
+ *
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), o lote inteiro é buscado com a trava do índice obtida
+ *       para leitura.
+ */
+int twoThreeTreeSearchMany(FILE *file, const int *keys, int n, int *positions);
+
 /**
  * @brief Insere uma chave na árvore 2-3.
  *
  * Esta função é responsável por inserir uma chave na árvore 2-3, criando um nó raiz caso a árvore esteja vazia
- * ou realizando a inserção recursiva nos nós existentes. Caso haja uma divisão de nó, a chave promovida será
- * colocada em um novo nó raiz. O cabeçalho do arquivo de índice será atualizado conforme necessário.
+ * ou descendo até a folha adequada e subindo pelo caminho percorrido, dividindo os nós cheios. Caso a raiz seja
+ * dividida, a chave promovida será colocada em um novo nó raiz. O cabeçalho do arquivo de índice será atualizado
+ * conforme necessário.
  *
  * @pre O arquivo de índice deve estar aberto no modo de leitura e escrita. O cabeçalho do arquivo de índice
  *     deve estar carregado e disponível para atualização. A chave a ser inserida deve ser fornecida.
@@ -128,11 +170,14 @@ int twoThreeTreeSearch(FILE *file, int key);
  * @param bookPosition Posição do livro associada à chave a ser inserida.
  * @param header Ponteiro para o cabeçalho do arquivo de índice, que contém informações da árvore, incluindo o endereço da raiz.
  *
- * @return O endereço do nó raiz após a inserção. Caso não haja divisão de nó, retorna `0` indicando sucesso.
+ * @return 0 em caso de sucesso, ou -1 se a chave já existir na árvore ou se não for possível alocar um nó.
+ *
+ * @note Os nós do caminho da raiz até a folha são lidos uma única vez, na descida; as divisões reutilizam essas
+ *       cópias em memória, sem buscas adicionais pelo pai de cada nó.
  *
- * @note Se a árvore estiver vazia, um novo nó raiz será criado com a chave inserida. Caso contrário, a inserção
- *       será realizada recursivamente, e se necessário, a árvore será reestruturada com a criação de um novo nó raiz
- *       para acomodar a chave promovida.
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a inserção é delegada a `bplusTreeInsert`.
+ *
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), a inserção obtém a trava do índice para escrita.
  */
 int insertKey(FILE *indexFile, int key, int bookPosition, IndexFileHeader *header);
 
@@ -157,8 +202,17 @@ int insertKey(FILE *indexFile, int key, int bookPosition, IndexFileHeader *heade
  *
  * @note Esta função lida com diferentes cenários para remoção:
  *       - Se a chave estiver em um nó folha, ela é removida diretamente.
- *       - Se o nó folha ficar desequilibrado (com menos de uma chave), a função `handleLeafUnderflow` é chamada.
- *       - Se a chave estiver em um nó interno, a chave é substituída pelo sucessor em ordem, e a remoção é recursiva.
+ *       - Se a chave estiver em um nó interno, ela é substituída pelo sucessor em ordem, encontrado na mesma
+ *         descida, e o sucessor é removido da sua folha.
+ *       - Se um nó ficar sem chaves, ele recebe uma chave do irmão (redistribuição) ou é fundido com ele, e a
+ *         fusão pode se propagar até a raiz.
+ *
+ * @note A remoção lê cada nó do caminho uma única vez e, por nível em underflow, apenas o irmão: o custo é
+ *       proporcional à altura da árvore.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a remoção é delegada a `bplusTreeRemove`.
+ *
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), a remoção obtém a trava do índice para escrita.
  */
 int removeKey(FILE *indexFile, int key, IndexFileHeader *header);
 
@@ -174,7 +228,40 @@ int removeKey(FILE *indexFile, int key, IndexFileHeader *header);
  *
  * @return O número total de nós na árvore 2-3.
  *         Retorna 0 se a árvore estiver vazia.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), são contadas as chaves das folhas (uma por livro).
  */
 int twoThreeTreeCountNodes(FILE *indexFile);
 
+/**
+ * @brief Constrói a árvore 2-3 de baixo para cima a partir de chaves ordenadas.
+ *
+ * Esta função monta uma árvore 2-3 compacta (com o maior número possível de nós com duas chaves) a partir de um
+ * vetor de chaves em ordem crescente e sem repetição. Os nós são gerados em pós-ordem, isto é, cada nó é gravado
+ * depois dos seus filhos, o que permite escrever todo o índice em uma única passada sequencial no final do arquivo,
+ * sem nenhuma leitura e sem divisões de nós.
+ *
+ * @pre O arquivo de índices deve estar aberto no modo de leitura e escrita e a árvore deve estar vazia
+ *      (`header->rootAddress == -1`). As chaves devem estar em ordem crescente e sem repetição.
+ *
+ * @post Os nós da árvore são gravados no final do arquivo de índices e `header->rootAddress` passa a apontar
+ *       para a nova raiz.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param keys Vetor com as chaves em ordem crescente.
+ * @param bookPositions Vetor com a posição do livro (dado) associada a cada chave.
+ * @param n Número de chaves.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ *
+ * @return O deslocamento (offset) da nova raiz, ou -1 se a árvore não estiver vazia ou ocorrer erro de gravação.
+ *
+ * @note A altura escolhida é a menor capaz de armazenar `n` chaves. Em cada nível interno, o nó recebe três filhos
+ *       sempre que as subárvores continuarem válidas, e as chaves são distribuídas igualmente entre os filhos.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a construção é delegada a `bplusTreeBulkBuild`.
+ *
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), a construção obtém a trava do índice para escrita.
+ */
+int twoThreeTreeBulkBuild(FILE *indexFile, const int *keys, const int *bookPositions, int n, IndexFileHeader *header);
+
 #endif /* TREE_MANAGER_H */
\ No newline at end of file
@@ -11,6 +11,23 @@
 #ifndef TWO_THREE_TREE_H
 #define TWO_THREE_TREE_H
 
+/**
+ * @brief Ordem (número máximo de filhos por nó) do layout clássico de árvore 2-3.
+ *
+ * Arquivos de índices com ordem maior utilizam o modo B+ (ver `bplus_tree.h`).
+ */
+#define TWO_THREE_TREE_ORDER 3
+
+/**
+ * @brief Identificador do formato do arquivo de índices.
+ */
+#define INDEX_FILE_MAGIC 0x31465849u
+
+/**
+ * @brief Versão do formato do arquivo de índices.
+ */
+#define INDEX_FILE_VERSION 2
+
 /**
  * @brief Estrutura de Dados para um Nó de uma Árvore 2-3.
  *
@@ -43,17 +60,29 @@ typedef struct Node
  * @brief Estrutura de Dados para o cabeçalho do arquivo de índices.
  *
  * O cabeçalho do arquivo de índices contém informações sobre o arquivo de índices, como:
+ * - magic, version: Identificador e versão do formato (`INDEX_FILE_MAGIC` e `INDEX_FILE_VERSION`).
+ * - nodeSize: Tamanho (em bytes) de cada nó: `sizeof(Node23)` na árvore 2-3 ou `BPLUS_PAGE_SIZE` no modo B+.
+ * - generation: Número de fechamentos completos da biblioteca, conferido com o do snapshot ao reabri-la.
+ * - pairStamp: Marca comum ao arquivo de índices e ao arquivo de dados criados juntos, conferida ao reabri-los.
  * - rootAddress: Endereço (deslocamento/offset) do registro raiz no arquivo de índices.
- * - firstEmptyPosition: Posição do primeiro espaço livre no arquivo de índices.
+ * - firstEmptyPosition: Endereço (deslocamento/offset) do primeiro nó ou página nunca utilizado, isto é, o fim
+ *   da área reservada pelo alocador (veja `page_allocator.h`).
  * - headEmptyPosition: Endereço (deslocamento/offset) do início da lista de nós/páginas livres.
+ * - order: Ordem da árvore. `TWO_THREE_TREE_ORDER` para a árvore 2-3; valores maiores selecionam o modo B+.
  *
  * O cabeçalho do arquivo de índices é armazenado no início do arquivo de índices.
  */
 typedef struct
 {
+    unsigned int magic;     // Identificador do formato
+    int version;            // Versão do formato
+    int nodeSize;           // Tamanho de cada nó ou página
+    int generation;         // Número de fechamentos completos
+    unsigned int pairStamp; // Marca comum ao arquivo de dados do mesmo par
     int rootAddress;        // Endereço (deslocamento/offset) do registro raiz no arquivo de índices.
     int firstEmptyPosition; // Posição do primeiro espaço livre no arquivo de índices
     int headEmptyPosition;  // Endereço (deslocamento/offset) do início da lista de nós/páginas livres.
+    int order;              // Ordem da árvore (TWO_THREE_TREE_ORDER para a árvore 2-3)
 } IndexFileHeader;
 
 /**
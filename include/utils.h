@@ -12,6 +12,10 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <ctype.h>
+#include <stddef.h>
+#include <string.h>
+
 /**
  * @file utils.c
  * @brief Implementação de funções utilitárias para manipulação de strings, arquivos e outros recursos gerais usados no projeto.
@@ -94,4 +98,23 @@ int compareCaseInsensitive(const char *str1, const char *str2);
  */
 void formatDecimalSeparator(char *str);
 
+/**
+ * @brief Gera a forma normalizada de uma string para uso como chave de índice.
+ *
+ * @details A forma normalizada não possui espaços no início nem no final, tem os espaços internos consecutivos
+ *          reduzidos a um único espaço e todas as letras convertidas para minúsculas. Duas strings consideradas
+ *          iguais pela busca (ignorando maiúsculas e espaços extras) têm sempre a mesma forma normalizada.
+ *
+ * @param src String de origem, terminada por caractere nulo.
+ * @param dest Buffer de destino, que receberá a string normalizada.
+ * @param destSize Tamanho, em bytes, do buffer de destino.
+ *
+ * @pre `src` e `dest` devem ser válidos e `destSize` deve ser maior que 0.
+ *
+ * @post `dest` contém a string normalizada, truncada em `destSize - 1` caracteres se necessário.
+ *
+ * @return Retorna o ponteiro `dest`.
+ */
+char *normalizeString(const char *src, char *dest, size_t destSize);
+
 #endif /* UTILS_H */
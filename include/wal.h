@@ -0,0 +1,258 @@
+/**
+ * @file wal.h
+ * @see wal.c
+ *
+ * @brief Contém o log de escrita antecipada (write-ahead log) dos arquivos de dados e de índices.
+ *
+ * Cada operação de escrita da biblioteca é executada como uma transação. Enquanto a transação está aberta, toda
+ * gravação feita com `storageWrite` nos arquivos observados é registrada no log com a nova imagem dos bytes gravados.
+ * A gravação em si fica retida em memória até que o `fsync` do log que cobre o seu commit termine; as leituras dos
+ * arquivos observados (`storageRead`/`storagePread`) enxergam as gravações retidas. Assim, nenhum byte de uma
+ * transação chega aos arquivos, nem ao cache de páginas do sistema operacional (de onde poderia ser gravado no
+ * dispositivo a qualquer momento), antes de o seu registro estar no dispositivo. Apenas o trecho de uma gravação que
+ * estende o arquivo é gravado imediatamente: ele fica além de tudo o que os cabeçalhos gravados alcançam. O commit
+ * acrescenta as imagens dos cabeçalhos (que ficam apenas em memória até o checkpoint) e um registro de commit.
+ *
+ * O commit em grupo é controlado pela janela de sincronização: o log só é sincronizado com o dispositivo (`fsync`)
+ * quando a janela tiver passado desde a última sincronização (ou quando as gravações retidas passarem de
+ * `WAL_MAX_PENDING_BYTES`), de modo que vários commits próximos compartilham um único `fsync`; logo depois dele, as
+ * gravações retidas de todos esses commits são aplicadas aos arquivos. Uma janela de 0 ms sincroniza a cada commit.
+ * Os commits da janela corrente podem ser perdidos em uma falha do sistema operacional, mas nunca ficam aplicados
+ * pela metade.
+ *
+ * No checkpoint (`libraryCommit`), as gravações retidas são aplicadas, os arquivos de dados e de índices são
+ * sincronizados e o log é esvaziado: a geração do log é incrementada e os próximos registros voltam a ser gravados
+ * logo após o cabeçalho. Depois de uma interrupção, `walRecover` refaz as transações confirmadas; como as gravações
+ * das demais nunca chegaram aos arquivos, nada precisa ser desfeito.
+ *
+ * Formato do arquivo: `WalFileHeader` seguido dos registros, cada um formado por um `WalRecordHeader` e pela nova
+ * imagem dos bytes gravados (`length` bytes, apenas em `WAL_RECORD_WRITE`).
+ *
+ * @author Gabriel Hochmann
+ */
+
+#ifndef WAL_H
+#define WAL_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Identificador do formato do arquivo de log.
+ */
+#define WAL_MAGIC 0x314C4157u
+
+/**
+ * @brief Número máximo de arquivos observados por um log.
+ */
+#define WAL_MAX_FILES 4
+
+/**
+ * @brief Janela padrão (em milissegundos) entre sincronizações do log.
+ */
+#define WAL_DEFAULT_SYNC_WINDOW_MS 10
+
+/**
+ * @brief Total (em bytes) das gravações retidas a partir do qual o commit sincroniza o log antes do fim da janela.
+ */
+#define WAL_MAX_PENDING_BYTES (1L << 20)
+
+/**
+ * @brief Tipo de um registro do log.
+ */
+typedef enum
+{
+    WAL_RECORD_WRITE = 1, // Gravação em um arquivo observado
+    WAL_RECORD_COMMIT = 2 // Fim de uma transação confirmada
+} WalRecordType;
+
+/**
+ * @brief Estrutura de Dados para o cabeçalho do arquivo de log.
+ *
+ * - magic: Deve ser `WAL_MAGIC`.
+ * - fileCount: Número de arquivos observados, na ordem em que foram informados a `walCreate`.
+ * - generation: Geração corrente do log, incrementada a cada checkpoint. Registros de gerações anteriores que
+ *   tenham sobrado no arquivo são ignorados.
+ */
+typedef struct
+{
+    unsigned int magic; // Identificador do formato
+    int fileCount;      // Arquivos observados
+    int generation;     // Geração corrente
+} WalFileHeader;
+
+/**
+ * @brief Estrutura de Dados para o cabeçalho de um registro do log.
+ *
+ * - type: Tipo do registro (`WalRecordType`).
+ * - generation: Geração do log em que o registro foi gravado.
+ * - transaction: Número da transação.
+ * - fileId: Índice do arquivo gravado (apenas em `WAL_RECORD_WRITE`).
+ * - length: Tamanho da nova imagem.
+ * - offset: Deslocamento da gravação no arquivo.
+ * - checksum: Soma de verificação (FNV-1a) do registro, calculada com este campo igual a 0.
+ */
+typedef struct
+{
+    int type;              // Tipo do registro
+    int generation;        // Geração do log
+    int transaction;       // Número da transação
+    int fileId;            // Arquivo gravado
+    int length;            // Tamanho da nova imagem
+    long long offset;      // Deslocamento da gravação
+    unsigned int checksum; // Soma de verificação do registro
+} WalRecordHeader;
+
+/**
+ * @brief Gravação retida em memória até a sincronização do log.
+ *
+ * - fileId: Índice do arquivo observado.
+ * - length: Tamanho da gravação.
+ * - offset: Deslocamento da gravação no arquivo.
+ * - data: Posição dos bytes gravados na área das gravações retidas.
+ */
+typedef struct
+{
+    int fileId;  // Arquivo gravado
+    int length;  // Tamanho da gravação
+    long offset; // Deslocamento da gravação
+    size_t data; // Posição dos bytes na área das gravações retidas
+} WalPendingWrite;
+
+/**
+ * @brief Log aberto.
+ */
+typedef struct
+{
+    FILE *file;                 // Arquivo de log (NULL se o log não estiver aberto)
+    FILE *files[WAL_MAX_FILES]; // Arquivos observados
+    int fileCount;              // Número de arquivos observados
+    int generation;             // Geração corrente do log
+    int transaction;            // Número da última transação iniciada
+    int active;                 // 1 enquanto uma transação está aberta
+    int syncWindowMs;           // Janela entre sincronizações do log
+    long long lastSyncMs;       // Instante da última sincronização
+    int unsyncedCommits;        // Commits ainda não sincronizados
+    char *record;               // Área de montagem dos registros
+    size_t recordCapacity;      // Tamanho da área de montagem
+    WalPendingWrite *pending;   // Gravações retidas, na ordem em que foram feitas
+    int pendingCount;           // Número de gravações retidas
+    int pendingCapacity;        // Capacidade do vetor de gravações retidas
+    char *pendingData;          // Bytes das gravações retidas
+    size_t pendingBytes;        // Bytes ocupados em `pendingData`
+    size_t pendingDataCapacity; // Tamanho de `pendingData`
+    long pendingFirst[WAL_MAX_FILES]; // Menor deslocamento retido de cada arquivo
+    long pendingEnd[WAL_MAX_FILES];   // Maior final de gravação retida de cada arquivo
+    int applying;               // 1 enquanto as gravações retidas são aplicadas aos arquivos
+    int transactionPending;     // Gravações retidas antes do início da transação corrente
+} Wal;
+
+/**
+ * @brief Cria (ou esvazia) o arquivo de log e passa a observar as gravações dos arquivos informados.
+ *
+ * @param wal Ponteiro para a estrutura do log a ser inicializada.
+ * @param filename Nome do arquivo de log.
+ * @param files Arquivos cujas gravações serão registradas.
+ * @param fileCount Número de arquivos (no máximo `WAL_MAX_FILES`).
+ * @param syncWindowMs Janela (em milissegundos) entre sincronizações do log; 0 sincroniza a cada commit.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walCreate(Wal *wal, const char *filename, FILE *files[], int fileCount, int syncWindowMs);
+
+/**
+ * @brief Inicia uma transação.
+ *
+ * @param wal Ponteiro para o log aberto.
+ */
+void walBegin(Wal *wal);
+
+/**
+ * @brief Registra na transação corrente uma imagem que ainda não foi gravada no arquivo.
+ *
+ * Usada para os cabeçalhos mantidos em memória, que só são gravados no checkpoint. A imagem não é retida: ela só
+ * chega ao arquivo quando a recuperação refaz o registro.
+ *
+ * @param wal Ponteiro para o log aberto.
+ * @param file Arquivo observado ao qual a imagem pertence.
+ * @param offset Deslocamento da imagem no arquivo.
+ * @param buffer Conteúdo da imagem.
+ * @param size Tamanho da imagem.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walLogImage(Wal *wal, FILE *file, long offset, const void *buffer, size_t size);
+
+/**
+ * @brief Confirma a transação corrente.
+ *
+ * O registro de commit é entregue ao sistema operacional imediatamente; o `fsync` do log (seguido da aplicação das
+ * gravações retidas) é feito se a janela de sincronização tiver passado desde o último ou se as gravações retidas
+ * passarem de `WAL_MAX_PENDING_BYTES`.
+ *
+ * @param wal Ponteiro para o log aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walCommit(Wal *wal);
+
+/**
+ * @brief Descarta a transação corrente.
+ *
+ * As gravações retidas da transação são descartadas (elas nunca chegaram aos arquivos) e os seus registros ficam sem
+ * registro de commit, de modo que a recuperação os ignora. Sem transação aberta, a chamada não tem efeito.
+ *
+ * @param wal Ponteiro para o log aberto.
+ */
+void walAbort(Wal *wal);
+
+/**
+ * @brief Sincroniza o log com o dispositivo, se houver commits pendentes, e aplica aos arquivos as gravações retidas.
+ *
+ * @pre Nenhuma transação aberta.
+ *
+ * @param wal Ponteiro para o log aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walSync(Wal *wal);
+
+/**
+ * @brief Esvazia o log depois que os arquivos observados foram sincronizados.
+ *
+ * @pre Nenhuma transação aberta. As gravações retidas já devem ter sido aplicadas (`walSync`) e os arquivos
+ *      observados, gravados e sincronizados.
+ *
+ * @param wal Ponteiro para o log aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walCheckpoint(Wal *wal);
+
+/**
+ * @brief Sincroniza o log, aplica as gravações retidas, deixa de observar os arquivos e fecha o log.
+ *
+ * @param wal Ponteiro para o log.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ *
+ * @post `wal->file` é definido como NULL.
+ */
+int walClose(Wal *wal);
+
+/**
+ * @brief Aplica aos arquivos o conteúdo de um log deixado por uma sessão interrompida.
+ *
+ * As gravações das transações confirmadas são refeitas na ordem do log; as das transações descartadas e da
+ * incompleta são ignoradas, já que nunca chegaram aos arquivos. Registros corrompidos ou truncados no final do log
+ * são descartados. Ao final, os arquivos são sincronizados e o log é esvaziado.
+ *
+ * @param filename Nome do arquivo de log.
+ * @param files Arquivos observados, na mesma ordem usada em `walCreate`, abertos para leitura e escrita.
+ * @param fileCount Número de arquivos.
+ *
+ * @return O número de transações refeitas (0 se o log não existir ou estiver vazio), ou -1 em caso de erro.
+ */
+int walRecover(const char *filename, FILE *files[], int fileCount);
+
+#endif /* WAL_H */
@@ -0,0 +1,472 @@
+/**
+ * @file author_index.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o índice secundário persistente de livros por autor.
+ *
+ * Os nomes dos autores são normalizados (`normalizeString`) antes do cálculo do hash (FNV-1a), de modo que a busca
+ * continue ignorando maiúsculas e espaços extras, como a busca sequencial fazia.
+ *
+ * @see author_index.h
+ */
+
+#include "author_index.h"
+#include "book.h"
+#include "file_manager.h"
+#include "storage.h"
+#include "utils.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Calcula o hash (FNV-1a) do nome normalizado de um autor.
+ */
+static unsigned int hashAuthor(const char *author)
+{
+    char normalized[sizeof(((Book *)0)->author)];
+    unsigned int hash = 2166136261u;
+
+    normalizeString(author, normalized, sizeof(normalized));
+
+    for (const char *p = normalized; *p; p++)
+    {
+        hash ^= (unsigned char)*p;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Calcula o deslocamento (em bytes) de uma entrada no arquivo do índice.
+ */
+static long entryPosition(const AuthorIndex *index, int entry)
+{
+    return sizeof(AuthorIndexHeader) + (long)index->header.bucketCount * sizeof(int) + (long)entry * sizeof(AuthorIndexEntry);
+}
+
+/**
+ * @brief Lê uma entrada do arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int readEntry(AuthorIndex *index, int entry, AuthorIndexEntry *out)
+{
+    if (fseek(index->file, entryPosition(index, entry), SEEK_SET) != 0 ||
+        fread(out, sizeof(AuthorIndexEntry), 1, index->file) != 1)
+    {
+        fprintf(stderr, "Erro ao ler a entrada %d do índice de autores.\n", entry);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Grava uma entrada no arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int writeEntry(AuthorIndex *index, int entry, const AuthorIndexEntry *in)
+{
+    if (fseek(index->file, entryPosition(index, entry), SEEK_SET) != 0 ||
+        fwrite(in, sizeof(AuthorIndexEntry), 1, index->file) != 1)
+    {
+        perror("Erro ao gravar entrada no índice de autores");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Compara duas posições de livros (usada para ordenar o resultado das buscas).
+ */
+static int comparePositions(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Cria um novo índice de autores vazio.
+ *
+ * @pre `index` e `filename` não devem ser NULL.
+ *
+ * @post O arquivo é criado (ou truncado) e o índice fica aberto, com o cabeçalho e os baldes em memória.
+ *
+ * @param index Ponteiro para a estrutura do índice a ser inicializada.
+ * @param filename Nome do arquivo do índice.
+ * @param bucketCount Número de baldes da tabela hash.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int authorIndexCreate(AuthorIndex *index, const char *filename, int bucketCount)
+{
+    index->file = NULL;
+    index->buckets = NULL;
+    index->dirty = 0;
+
+    if (bucketCount <= 0)
+    {
+        bucketCount = AUTHOR_INDEX_DEFAULT_BUCKETS;
+    }
+
+    index->buckets = malloc(sizeof(int) * bucketCount);
+
+    if (index->buckets == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o índice de autores.\n");
+        return -1;
+    }
+
+    index->file = openFile(filename, "w+b");
+
+    if (index->file == NULL)
+    {
+        free(index->buckets);
+        index->buckets = NULL;
+        return -1;
+    }
+
+    index->header.bucketCount = bucketCount;
+    index->header.firstEmptyPosition = 0;
+    index->header.headEmptyPosition = -1;
+
+    for (int i = 0; i < bucketCount; i++)
+    {
+        index->buckets[i] = -1;
+    }
+
+    // Grava o cabeçalho e os baldes vazios para que o arquivo já tenha o formato completo
+    index->dirty = 1;
+    return authorIndexFlush(index);
+}
+
+/**
+ * @brief Abre um índice de autores existente.
+ *
+ * @pre `index` e `filename` não devem ser NULL.
+ *
+ * @post O índice fica aberto, com o cabeçalho e os baldes lidos do arquivo para a memória.
+ *
+ * @param index Ponteiro para a estrutura do índice a ser inicializada.
+ * @param filename Nome do arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser lido ou estiver inconsistente.
+ */
+int authorIndexOpen(AuthorIndex *index, const char *filename)
+{
+    index->buckets = NULL;
+    index->dirty = 0;
+    index->file = openFile(filename, "r+b");
+
+    if (index->file == NULL)
+    {
+        return -1;
+    }
+
+    if (fseek(index->file, 0, SEEK_SET) != 0 || fread(&index->header, sizeof(AuthorIndexHeader), 1, index->file) != 1 ||
+        index->header.bucketCount <= 0 || index->header.firstEmptyPosition < 0 ||
+        index->header.headEmptyPosition < -1 || index->header.headEmptyPosition >= index->header.firstEmptyPosition ||
+        storageSize(index->file) < entryPosition(index, index->header.firstEmptyPosition))
+    {
+        fprintf(stderr, "Erro: o índice de autores '%s' está inconsistente.\n", filename);
+        closeFile(&index->file);
+        return -1;
+    }
+
+    index->buckets = malloc(sizeof(int) * index->header.bucketCount);
+
+    if (index->buckets == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o índice de autores.\n");
+        closeFile(&index->file);
+        return -1;
+    }
+
+    if (fseek(index->file, sizeof(AuthorIndexHeader), SEEK_SET) != 0 ||
+        fread(index->buckets, sizeof(int), index->header.bucketCount, index->file) != (size_t)index->header.bucketCount)
+    {
+        perror("Erro ao ler os baldes do índice de autores");
+        authorIndexClose(index);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Insere a associação entre um autor e a posição de um livro.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param author Nome do autor (não precisa estar normalizado).
+ * @param bookPosition Posição do livro no arquivo de dados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de gravação.
+ */
+int authorIndexInsert(AuthorIndex *index, const char *author, int bookPosition)
+{
+    AuthorIndexEntry entry;
+    int position;
+
+    entry.hash = hashAuthor(author);
+    entry.bookPosition = bookPosition;
+
+    // Reutiliza uma entrada livre, se houver
+    if (index->header.headEmptyPosition != -1)
+    {
+        AuthorIndexEntry freeEntry;
+        position = index->header.headEmptyPosition;
+
+        if (readEntry(index, position, &freeEntry) != 0)
+        {
+            return -1;
+        }
+
+        index->header.headEmptyPosition = freeEntry.next;
+    }
+    else
+    {
+        position = index->header.firstEmptyPosition++;
+    }
+
+    int bucket = entry.hash % (unsigned int)index->header.bucketCount;
+
+    entry.next = index->buckets[bucket];
+
+    if (writeEntry(index, position, &entry) != 0)
+    {
+        return -1;
+    }
+
+    index->buckets[bucket] = position;
+    index->dirty = 1;
+
+    return 0;
+}
+
+/**
+ * @brief Remove a associação entre um autor e a posição de um livro.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param author Nome do autor usado na inserção.
+ * @param bookPosition Posição do livro no arquivo de dados.
+ *
+ * @return 0 se a entrada foi removida, -1 se não foi encontrada ou em caso de erro.
+ *
+ * @note A entrada removida é colocada na lista de entradas livres para ser reutilizada.
+ */
+int authorIndexRemove(AuthorIndex *index, const char *author, int bookPosition)
+{
+    unsigned int hash = hashAuthor(author);
+    int bucket = hash % (unsigned int)index->header.bucketCount;
+    int previous = -1;
+    AuthorIndexEntry previousEntry;
+
+    for (int position = index->buckets[bucket]; position != -1;)
+    {
+        AuthorIndexEntry entry;
+
+        if (readEntry(index, position, &entry) != 0)
+        {
+            return -1;
+        }
+
+        if (entry.hash == hash && entry.bookPosition == bookPosition)
+        {
+            // Retira a entrada da lista do balde
+            if (previous == -1)
+            {
+                index->buckets[bucket] = entry.next;
+            }
+            else
+            {
+                previousEntry.next = entry.next;
+                if (writeEntry(index, previous, &previousEntry) != 0)
+                {
+                    return -1;
+                }
+            }
+
+            // Coloca a entrada na lista de entradas livres
+            entry.bookPosition = -1;
+            entry.next = index->header.headEmptyPosition;
+            if (writeEntry(index, position, &entry) != 0)
+            {
+                return -1;
+            }
+
+            index->header.headEmptyPosition = position;
+            index->dirty = 1;
+
+            return 0;
+        }
+
+        previous = position;
+        previousEntry = entry;
+        position = entry.next;
+    }
+
+    return -1; // Entrada não encontrada
+}
+
+/**
+ * @brief Retorna as posições dos livros cujo autor tem o mesmo hash do autor informado.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param author Nome do autor a ser buscado.
+ * @param count Ponteiro onde será armazenado o número de posições retornadas.
+ *
+ * @return Vetor alocado dinamicamente com as posições em ordem crescente (deve ser liberado com `free`),
+ *         ou NULL se nenhuma posição for encontrada.
+ *
+ * @warning As posições retornadas são candidatas: o autor deve ser confirmado no registro do livro.
+ */
+int *authorIndexLookup(AuthorIndex *index, const char *author, int *count)
+{
+    unsigned int hash = hashAuthor(author);
+    int bucket = hash % (unsigned int)index->header.bucketCount;
+    int *positions = NULL;
+    int allocated = 0;
+
+    *count = 0;
+
+    for (int position = index->buckets[bucket]; position != -1;)
+    {
+        AuthorIndexEntry entry;
+
+        if (readEntry(index, position, &entry) != 0)
+        {
+            break;
+        }
+
+        if (entry.hash == hash)
+        {
+            if (*count == allocated)
+            {
+                int newAllocated = allocated == 0 ? 16 : allocated * 2;
+                int *resized = realloc(positions, sizeof(int) * newAllocated);
+
+                if (resized == NULL)
+                {
+                    fprintf(stderr, "Erro: memória insuficiente para a busca por autor.\n");
+                    break;
+                }
+
+                positions = resized;
+                allocated = newAllocated;
+            }
+
+            positions[(*count)++] = entry.bookPosition;
+        }
+
+        position = entry.next;
+    }
+
+    if (*count == 0)
+    {
+        free(positions);
+        return NULL;
+    }
+
+    // Ordena as posições para que os livros sejam lidos na ordem do arquivo de dados
+    qsort(positions, *count, sizeof(int), comparePositions);
+
+    return positions;
+}
+
+/**
+ * @brief Remove todas as entradas do índice, mantendo o arquivo aberto.
+ *
+ * Usada para reconstruir o índice quando as posições dos livros mudam (por exemplo, na compactação).
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ *
+ * @post O arquivo é truncado para o cabeçalho e os baldes vazios.
+ */
+int authorIndexClear(AuthorIndex *index)
+{
+    index->header.firstEmptyPosition = 0;
+    index->header.headEmptyPosition = -1;
+
+    for (int i = 0; i < index->header.bucketCount; i++)
+    {
+        index->buckets[i] = -1;
+    }
+
+    index->dirty = 1;
+
+    if (authorIndexFlush(index) != 0)
+    {
+        return -1;
+    }
+
+    // Descarta as entradas antigas que ficaram depois dos baldes
+    if (storageTruncate(index->file, entryPosition(index, 0)) != 0)
+    {
+        perror("Erro ao truncar o índice de autores");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Grava no arquivo o cabeçalho e os baldes do índice, caso tenham sido modificados.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int authorIndexFlush(AuthorIndex *index)
+{
+    if (index->file == NULL || !index->dirty)
+    {
+        return 0;
+    }
+
+    if (fseek(index->file, 0, SEEK_SET) != 0 ||
+        fwrite(&index->header, sizeof(AuthorIndexHeader), 1, index->file) != 1 ||
+        fwrite(index->buckets, sizeof(int), index->header.bucketCount, index->file) != (size_t)index->header.bucketCount)
+    {
+        perror("Erro ao gravar o cabeçalho do índice de autores");
+        return -1;
+    }
+
+    fflush(index->file);
+    index->dirty = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Grava as alterações pendentes e fecha o índice de autores.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int authorIndexClose(AuthorIndex *index)
+{
+    if (index->file == NULL)
+    {
+        return 0;
+    }
+
+    int result = authorIndexFlush(index);
+
+    if (closeFile(&index->file) != 0)
+    {
+        result = -1;
+    }
+
+    free(index->buckets);
+    index->buckets = NULL;
+
+    return result;
+}
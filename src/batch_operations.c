@@ -0,0 +1,373 @@
+/**
+ * @file batch_operations.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o executor de operações em lote (inserções, remoções e alterações de estoque e de preço).
+ *
+ * @see batch_operations.h
+ */
+
+#include "batch_operations.h"
+#include "book_manager.h"
+#include "book_parser.h"
+#include "file_manager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Compara duas operações pelo código do livro e, em caso de empate, pela linha de origem.
+ */
+static int compareBatchOperations(const void *a, const void *b)
+{
+    const BatchOperation *x = a;
+    const BatchOperation *y = b;
+
+    if (x->book.code != y->book.code)
+    {
+        return x->book.code < y->book.code ? -1 : 1;
+    }
+
+    return x->line - y->line;
+}
+
+/**
+ * @brief Converte um campo numérico de uma linha de operação.
+ *
+ * O campo vai até o próximo `;` ou até o final da linha e é convertido por `bookParseInt`.
+ *
+ * @param text Início do campo.
+ * @param value Ponteiro onde o valor convertido será armazenado.
+ * @param end Ponteiro onde será armazenado o primeiro caractere após o campo (o `;` ou o terminador nulo).
+ *
+ * @return 0 se o campo contém um número inteiro que cabe em um `int`, -1 caso contrário.
+ */
+static int parseIntField(const char *text, int *value, const char **end)
+{
+    *end = strchr(text, ';');
+
+    if (*end == NULL)
+    {
+        *end = text + strlen(text);
+    }
+
+    return bookParseInt(text, *end, value);
+}
+
+/**
+ * @brief Converte o campo do preço de uma linha de operação, aceitando vírgula ou ponto como separador decimal.
+ *
+ * @param text Início do campo (até o final da linha).
+ * @param value Ponteiro onde o preço convertido será armazenado.
+ *
+ * @return 0 se o campo contém um número, -1 caso contrário.
+ */
+static int parsePriceField(const char *text, double *value)
+{
+    char number[64];
+    size_t length = strlen(text);
+    char *end;
+
+    while (length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\t'))
+    {
+        length--;
+    }
+
+    if (length == 0 || length >= sizeof(number))
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < length; i++)
+    {
+        number[i] = text[i] == ',' ? '.' : text[i];
+    }
+
+    number[length] = '\0';
+    *value = strtod(number, &end);
+
+    return end != number && *end == '\0' ? 0 : -1;
+}
+
+/**
+ * @brief Interpreta uma linha do arquivo de operações.
+ *
+ * As linhas de inserção são convertidas por `bookParseLine`, com as mesmas regras da importação do arquivo texto.
+ *
+ * @param line Linha sem a quebra de linha.
+ * @param operation Ponteiro para a operação a ser preenchida.
+ * @param error Ponteiro onde é armazenada a descrição do erro, se a linha for inválida.
+ *
+ * @return 0 em caso de sucesso, -1 se a linha estiver mal formatada.
+ */
+static int parseBatchLine(const char *line, BatchOperation *operation, const char **error)
+{
+    const char *end;
+
+    *error = "linha mal formatada";
+
+    if (line[0] == '\0' || line[1] != ';')
+    {
+        return -1;
+    }
+
+    memset(&operation->book, 0, sizeof(Book));
+    operation->delta = 0;
+    operation->price = 0.0;
+
+    switch (line[0])
+    {
+    case 'I':
+    case 'i':
+        operation->type = BATCH_INSERT;
+        return bookParseLine(line + 2, strlen(line + 2), &operation->book, error);
+
+    case 'R':
+    case 'r':
+        operation->type = BATCH_REMOVE;
+        return parseIntField(line + 2, &operation->book.code, &end);
+
+    case 'E':
+    case 'e':
+        operation->type = BATCH_STOCK;
+
+        if (parseIntField(line + 2, &operation->book.code, &end) != 0 || *end != ';')
+        {
+            return -1;
+        }
+
+        return parseIntField(end + 1, &operation->delta, &end);
+
+    case 'P':
+    case 'p':
+        operation->type = BATCH_PRICE;
+
+        if (parseIntField(line + 2, &operation->book.code, &end) != 0 || *end != ';')
+        {
+            return -1;
+        }
+
+        return parsePriceField(end + 1, &operation->price);
+
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief Exibe um erro do lote, se o limite de erros listados ainda não foi atingido.
+ */
+static void reportBatchError(int *reported, int line, const char *message, int code)
+{
+    if (*reported < BATCH_MAX_REPORTED_ERRORS)
+    {
+        if (*reported == 0)
+        {
+            fprintf(stderr, "Aviso: operações do lote não aplicadas:\n");
+        }
+        fprintf(stderr, "  linha %d: %s (código %d)\n", line, message, code);
+    }
+    (*reported)++;
+}
+
+/**
+ * @brief Aplica uma operação do lote e a contabiliza no relatório.
+ *
+ * @return 1 se a operação foi aplicada, 0 caso contrário.
+ */
+static int applyBatchOperation(Library *library, const BatchOperation *operation, BatchReport *report, int *reported)
+{
+    int result;
+
+    switch (operation->type)
+    {
+    case BATCH_INSERT:
+        result = insertBookRecord(library, &operation->book);
+        break;
+    case BATCH_REMOVE:
+        result = deleteBookRecord(library, operation->book.code);
+        break;
+    case BATCH_PRICE:
+    {
+        BookUpdate update = {operation->book.code, BOOK_UPDATE_PRICE, operation->price, 0};
+
+        result = updateBookRecord(library, &update);
+        break;
+    }
+    default:
+        result = adjustBookStockRecord(library, operation->book.code, operation->delta);
+        break;
+    }
+
+    switch (result)
+    {
+    case BOOK_OK:
+        if (operation->type == BATCH_INSERT)
+        {
+            report->inserted++;
+        }
+        else if (operation->type == BATCH_REMOVE)
+        {
+            report->removed++;
+        }
+        else
+        {
+            report->updated++;
+        }
+        return 1;
+
+    case BOOK_DUPLICATE:
+        report->duplicates++;
+        reportBatchError(reported, operation->line, "código já existente", operation->book.code);
+        break;
+    case BOOK_NOT_FOUND:
+        report->missing++;
+        reportBatchError(reported, operation->line, "código não encontrado", operation->book.code);
+        break;
+    case BOOK_INSUFFICIENT_STOCK:
+        report->insufficient++;
+        reportBatchError(reported, operation->line, "estoque insuficiente", operation->book.code);
+        break;
+    case BOOK_INVALID_STOCK:
+        report->invalid++;
+        reportBatchError(reported, operation->line, "estoque negativo", operation->book.code);
+        break;
+    case BOOK_INVALID_PRICE:
+        report->invalid++;
+        reportBatchError(reported, operation->line, "preço inválido", operation->book.code);
+        break;
+    default:
+        report->failed++;
+        reportBatchError(reported, operation->line, "erro de leitura ou gravação", operation->book.code);
+        break;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Executa as operações de um arquivo de operações em lote.
+ *
+ * As operações rejeitadas (código duplicado, código inexistente, estoque insuficiente ou linha inválida) não
+ * interrompem o lote: elas são contabilizadas no relatório e as primeiras `BATCH_MAX_REPORTED_ERRORS` são listadas.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @post As operações válidas são aplicadas e os cabeçalhos, os nós modificados, os índices secundários e as
+ *       estatísticas são gravados uma única vez, ao final do lote.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param filename Nome do arquivo de operações.
+ * @param report Ponteiro para o relatório a ser preenchido.
+ *
+ * @return O número de operações aplicadas, ou -1 se o arquivo não puder ser lido.
+ */
+int executeBatchFile(Library *library, const char *filename, BatchReport *report)
+{
+    memset(report, 0, sizeof(BatchReport));
+
+    FILE *textFile = openFile(filename, "r");
+
+    if (textFile == NULL)
+    {
+        return -1;
+    }
+
+    BatchOperation *operations = NULL;
+    int count = 0;
+    int allocated = 0;
+    int lineNumber = 0;
+    int reported = 0;
+    char line[1024];
+
+    // Lê todas as operações para a memória
+    while (fgets(line, sizeof(line), textFile))
+    {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (line[0] == '\0' || line[0] == '#')
+        {
+            continue; // Linha em branco ou comentário
+        }
+
+        if (count == allocated)
+        {
+            int newAllocated = allocated == 0 ? 1024 : allocated * 2;
+            BatchOperation *resized = realloc(operations, sizeof(BatchOperation) * newAllocated);
+
+            if (resized == NULL)
+            {
+                fprintf(stderr, "Erro: memória insuficiente para o lote de operações.\n");
+                free(operations);
+                closeFile(&textFile);
+                return -1;
+            }
+
+            operations = resized;
+            allocated = newAllocated;
+        }
+
+        const char *error;
+
+        if (parseBatchLine(line, &operations[count], &error) != 0)
+        {
+            report->invalid++;
+            reportBatchError(&reported, lineNumber, error, 0);
+            continue;
+        }
+
+        operations[count].line = lineNumber;
+        count++;
+    }
+
+    closeFile(&textFile);
+
+    // Agrupa as operações por código, preservando a ordem do arquivo entre operações do mesmo livro
+    qsort(operations, count, sizeof(BatchOperation), compareBatchOperations);
+
+    int applied = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        applied += applyBatchOperation(library, &operations[i], report, &reported);
+    }
+
+    free(operations);
+
+    if (reported > BATCH_MAX_REPORTED_ERRORS)
+    {
+        fprintf(stderr, "  ... e mais %d operações não aplicadas.\n", reported - BATCH_MAX_REPORTED_ERRORS);
+    }
+
+    // Uma única gravação dos cabeçalhos e dos nós para todo o lote
+    if (libraryCommit(library) != 0)
+    {
+        report->failed++;
+    }
+
+    return applied;
+}
+
+/**
+ * @brief Exibe o relatório de execução de um lote.
+ *
+ * @param report Ponteiro para o relatório.
+ */
+void printBatchReport(const BatchReport *report)
+{
+    printf("Lote concluído:\n");
+    printf("  Livros inseridos: %d\n", report->inserted);
+    printf("  Livros removidos: %d\n", report->removed);
+    printf("  Estoques ou preços alterados: %d\n", report->updated);
+    printf("  Códigos duplicados: %d\n", report->duplicates);
+    printf("  Códigos não encontrados: %d\n", report->missing);
+    printf("  Estoque insuficiente: %d\n", report->insufficient);
+    printf("  Linhas inválidas: %d\n", report->invalid);
+
+    if (report->failed > 0)
+    {
+        printf("  Falhas de leitura ou gravação: %d\n", report->failed);
+    }
+}
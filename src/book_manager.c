@@ -19,10 +19,28 @@
 #include "two_three_tree.h"
 
 #include "book_manager.h"
+#include "book_parser.h"
 #include "tree_manager.h"
+#include "file_manager.h"
 #include "utils.h"
-
+#include "tree_cursor.h"
+#include "storage.h"
+#include "page_allocator.h"
+#include "parallel_scan.h"
+#include "tree_lock.h"
+#include "io_stats.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Número de livros lidos por vez ao listar os livros em ordem de código.
+ */
+#define LIST_BOOKS_BATCH_SIZE 64
 
 /**
  * @brief Processa uma linha de texto e extrai os dados do livro.
@@ -48,327 +66,1509 @@
  * - Posição (inteiro) - Novo campo adicionado
  * - Preço (decimal) - Novo campo adicionado
  *
- * @note A função assume que todos os campos estão presentes na linha e no formato correto. Se algum campo estiver ausente ou mal formatado,
- * o comportamento pode ser imprevisível. Certifique-se de que o arquivo de texto está corretamente formatado.
+ * @note A conversão é feita por `bookParseLine`, sem copiar a linha. Se algum campo estiver ausente ou mal formatado, os
+ * campos seguintes não são preenchidos; use `bookParseLine` diretamente para saber se a linha é válida.
  */
-static void extractBookFromLine(const char *linha, Book *livro)
+void extractBookFromLine(const char *linha, Book *livro)
 {
     if (linha == NULL || livro == NULL)
         return;
 
-    char buffer[1024];
-    strncpy(buffer, linha, sizeof(buffer) - 1);
-    buffer[sizeof(buffer) - 1] = '\0'; // Garante terminação segura
+    // Linhas mal formadas são aceitas como antes: os campos são preenchidos até o primeiro campo inválido
+    bookParseLine(linha, strlen(linha), livro, NULL);
+}
+
+/**
+ * @brief Retorna o offset do livro no arquivo de dados com base no código fornecido.
+ *
+ * @param[in] indexFile Ponteiro para o arquivo de índices onde a árvore 2-3 está armazenada.
+ * @param[in] key O código do livro a ser verificado.
+ *
+ * @return Retorna o offset do livro no arquivo de dados se encontrado, `-1` caso contrário.
+ *
+ * @details Esta função utiliza a busca na árvore 2-3 (função `twoThreeTreeSearch`) para procurar
+ *          o código do livro no arquivo de índices. Caso o livro seja encontrado, retorna o offset
+ *          correspondente no arquivo de dados. Caso contrário, retorna `-1`.
+ */
+static long getBookOffset(FILE *indexFile, int key)
+{
+    // Realiza a busca na árvore 2-3 para o código do livro
+    long offset = twoThreeTreeSearch(indexFile, key);
+
+    // Verifica se a busca retornou um offset válido
+    if (offset != -1)
+    {
+        return offset; // Retorna o offset do livro encontrado
+    }
+    return -1; // Retorna -1 se o livro não for encontrado
+}
+
+/**
+ * @brief Insere o livro e a sua chave com a trava de escrita do índice já obtida.
+ *
+ * @return O mesmo valor de `insertBookRecord`.
+ */
+static int insertRecord(Library *library, const Book *book)
+{
+    FILE *dataFile = library->dataFile;
+    FILE *indexFile = library->indexFile;
+
+    // Um estoque negativo tornaria o total do cabeçalho inconsistente
+    if (book->stock_quantity < 0)
+    {
+        return BOOK_INVALID_STOCK;
+    }
+
+    // Verifica se o livro já existe no índice; com o filtro ligado, só os códigos que podem existir são procurados
+    if ((library->codeFilter.counters == NULL || codeFilterMayContain(&library->codeFilter, book->code)) &&
+        getBookOffset(indexFile, book->code) != -1)
+    {
+        return BOOK_DUPLICATE; // Livro já existe, não adiciona novamente
+    }
+
+    // As gravações a partir daqui formam uma transação no log, se estiver aberto
+    libraryBeginTransaction(library);
+
+    // Cabeçalho do arquivo de dados (mantido em memória pelo handle)
+    BookDataFileHeader *dataHeader = &library->dataHeader;
+
+    // Reutiliza o registro livre de menor posição ou estende o arquivo de dados (sem ler o registro livre)
+    long offset = pageAllocate(dataFile, -1);
 
-    char *token = strtok(buffer, ";");
+    if (offset == -1)
+    {
+        fprintf(stderr, "Erro ao alocar um registro no arquivo de dados.\n");
+        libraryAbortTransaction(library);
+        return -1;
+    }
 
-    if (token)
-        livro->code = atoi(token);
+    // Adiciona o livro na posição calculada
+    if (IO_STATS_WRITE(IO_STATS_RECORD_WRITE, dataFile, sizeof(BookDataFileHeader) + offset * sizeof(Book), book,
+                       sizeof(Book)) != 0)
+    {
+        perror("Erro ao adicionar o livro no arquivo de dados");
+        libraryAbortTransaction(library);
+        return -1;
+    }
 
-    token = strtok(NULL, ";");
-    if (token)
+    // Atualiza o índice com o código do livro e o novo offset
+    if (insertKey(indexFile, book->code, offset, &library->indexHeader) != 0)
     {
-        trimWhitespace(token);
-        snprintf(livro->title, sizeof(livro->title), "%s", token);
+        fprintf(stderr, "Erro ao inserir o código %d no índice.\n", book->code);
+        libraryAbortTransaction(library);
+        return -1;
     }
 
-    token = strtok(NULL, ";");
-    if (token)
+    // Atualiza os totais mantidos no cabeçalho apenas depois que o livro e a chave foram gravados
+    dataHeader->bookCount++;
+    dataHeader->stockTotal += book->stock_quantity;
+
+    saveHeader(dataFile, dataHeader, sizeof(BookDataFileHeader));
+
+    // Mantém o filtro de códigos atualizado, se estiver ligado, reconstruindo-o maior quando fica cheio
+    if (library->codeFilter.counters != NULL)
     {
-        trimWhitespace(token);
-        snprintf(livro->author, sizeof(livro->author), "%s", token);
+        codeFilterAdd(&library->codeFilter, book->code);
+
+        if (codeFilterIsFull(&library->codeFilter))
+        {
+            libraryEnableCodeFilter(library, 2 * library->codeFilter.keys);
+        }
     }
 
-    token = strtok(NULL, ";");
-    if (token)
+    // Mantém os arquivos secundários abertos atualizados; o que falhar é reconstruído na próxima abertura, pois o
+    // livro já está gravado no arquivo de dados e no índice
+    if (library->authorIndex.file != NULL && authorIndexInsert(&library->authorIndex, book->author, offset) != 0)
     {
-        trimWhitespace(token);
-        snprintf(livro->publisher, sizeof(livro->publisher), "%s", token);
+        libraryMarkStale(library, LIBRARY_SNAPSHOT_AUTHOR_INDEX);
     }
 
-    token = strtok(NULL, ";");
-    if (token)
-        livro->edition = atoi(token);
+    if (library->titleIndex.file != NULL && titleIndexInsert(&library->titleIndex, book->title, offset) != 0)
+    {
+        libraryMarkStale(library, LIBRARY_SNAPSHOT_TITLE_INDEX);
+    }
 
-    token = strtok(NULL, ";");
-    if (token)
-        livro->year = atoi(token);
+    if (library->stats.file != NULL && bookStatsAddBook(&library->stats, book) != 0)
+    {
+        libraryMarkStale(library, LIBRARY_SNAPSHOT_STATS);
+    }
 
-    token = strtok(NULL, ";");
-    if (token)
+    if (library->columns.file != NULL && columnStoreSet(&library->columns, offset, book) != 0)
     {
-        formatDecimalSeparator(token);
-        livro->price = atof(token);
+        libraryMarkStale(library, LIBRARY_SNAPSHOT_COLUMNS);
     }
 
-    token = strtok(NULL, ";");
-    if (token)
-        livro->stock_quantity = atoi(token);
+    return libraryCommitTransaction(library) == 0 ? BOOK_OK : -1;
 }
 
 /**
- * @brief Retorna o offset do livro no arquivo de dados com base no código fornecido.
+ * @brief Insere um livro no arquivo de dados e sua chave nos índices, sem exibir mensagens.
  *
- * @param[in] indexFile Ponteiro para o arquivo de índices onde a árvore 2-3 está armazenada.
- * @param[in] key O código do livro a ser verificado.
+ * @details O livro é gravado no registro livre de menor posição, obtido do alocador de registros sem leitura do
+ *          arquivo (que é estendido em lotes quando não há registros livres). Em seguida, o código do livro é inserido na árvore 2-3 junto com a
+ *          posição do registro, e os índices secundários e as estatísticas abertos são atualizados. Os cabeçalhos
+ *          utilizados são os mantidos em memória pelo handle da biblioteca, de modo que nenhuma leitura ou gravação
+ *          de cabeçalho é feita por livro.
  *
- * @return Retorna o offset do livro no arquivo de dados se encontrado, `-1` caso contrário.
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param book Ponteiro para o livro a ser inserido.
  *
- * @details Esta função utiliza a busca na árvore 2-3 (função `twoThreeTreeSearch`) para procurar
- *          o código do livro no arquivo de índices. Caso o livro seja encontrado, retorna o offset
- *          correspondente no arquivo de dados. Caso contrário, retorna `-1`.
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações da operação formam uma única transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante toda a operação.
+ * @note Com o filtro de códigos ligado (`libraryEnableCodeFilter`), a busca prévia por duplicados só é feita
+ *       para os códigos que podem estar no índice.
+ * @note Uma falha ao atualizar um arquivo secundário não desfaz a inserção: o arquivo é marcado com
+ *       `libraryMarkStale` e reconstruído na próxima abertura.
+ *
+ * @return `BOOK_OK` se o livro foi inserido, `BOOK_DUPLICATE` se o código já existir no índice,
+ *         `BOOK_INVALID_STOCK` se o estoque do livro for negativo, ou -1 em caso de erro de leitura ou gravação.
  */
-static long getBookOffset(FILE *indexFile, int key)
+int insertBookRecord(Library *library, const Book *book)
 {
-    // Realiza a busca na árvore 2-3 para o código do livro
-    long offset = twoThreeTreeSearch(indexFile, key);
-
-    // Verifica se a busca retornou um offset válido
-    if (offset != -1)
+    if (treeLockWrite(library->indexFile) != 0)
     {
-        return offset; // Retorna o offset do livro encontrado
+        return -1;
     }
-    return -1; // Retorna -1 se o livro não for encontrado
+
+    IO_STATS_BEGIN(IO_STATS_OP_INSERT);
+    int result = insertRecord(library, book);
+    IO_STATS_END();
+
+    treeUnlock(library->indexFile);
+    return result;
 }
 
-void addBookAux(FILE *dataFile, FILE *indexFile, const Book *book)
+/**
+ * @brief Adiciona um livro ao arquivo de dados e sua chave ao índice.
+ *
+ * @details Chama `insertBookRecord` e exibe o resultado da inserção.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param book Ponteiro para o livro a ser adicionado.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @post Se o código ainda não existir no índice, o livro é gravado e indexado.
+ */
+void addBookAux(Library *library, const Book *book)
 {
-    // Verifica se o livro já existe no índice
-    if (getBookOffset(indexFile, book->code) != -1)
+    int result = insertBookRecord(library, book);
+
+    if (result == BOOK_DUPLICATE)
     {
         printf("Erro: Livro com o código %d já existe no índice.\n", book->code);
-        return; // Livro já existe, não adiciona novamente
     }
+    else if (result == BOOK_INVALID_STOCK)
+    {
+        printf("Erro: O estoque do livro não pode ser negativo.\n");
+    }
+    else if (result == BOOK_OK)
+    {
+        printf("Livro adicionado com sucesso!\n");
+    }
+}
 
-    // Cabeçalho do arquivo de dados
-    BookDataFileHeader dataHeader;
+/**
+ * @brief Adiciona um livro à biblioteca.
+ *
+ * @details Chama `addBookAux` e registra a operação no handle da biblioteca, que grava os cabeçalhos no disco
+ *          quando o intervalo de gravação configurado é atingido.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param book Ponteiro para o livro a ser adicionado.
+ */
+void addBook(Library *library, const Book *book)
+{
+    addBookAux(library, book);
+    libraryEndOperation(library);
+}
+
+/**
+ * @brief Remove o livro e a sua chave com a trava de escrita do índice já obtida.
+ *
+ * @return O mesmo valor de `deleteBookRecord`.
+ */
+static int deleteRecord(Library *library, int code)
+{
+    FILE *dataFile = library->dataFile;
+    BookDataFileHeader *dataHeader = &library->dataHeader;
+    long offset = getBookOffset(library->indexFile, code);
+    Book book;
 
-    // Lê o cabeçalho do arquivo de dados usando a função readFileHeader
-    if (readFileHeader(dataFile, &dataHeader, sizeof(BookDataFileHeader)) != 1)
+    if (offset == -1)
     {
-        return; // Se falhar ao ler o cabeçalho, retorna
+        return BOOK_NOT_FOUND;
     }
 
-    // Cabeçalho do arquivo de índice
-    IndexFileHeader indexHeader;
+    libraryBeginTransaction(library);
+
+    // Lê o registro para obter o autor usado no índice secundário
+    if (IO_STATS_READ(IO_STATS_RECORD_READ, dataFile, sizeof(BookDataFileHeader) + offset * sizeof(Book), &book,
+                      sizeof(Book)) != 0)
+    {
+        perror("Erro ao ler o livro no arquivo de dados");
+        libraryAbortTransaction(library);
+        return -1;
+    }
 
-    // Lê o cabeçalho do arquivo de índice usando a função readFileHeader
-    if (readFileHeader(indexFile, &indexHeader, sizeof(IndexFileHeader)) != 1)
+    if (removeKey(library->indexFile, code, &library->indexHeader) != 0)
     {
-        return; // Se falhar ao ler o cabeçalho, retorna
+        fprintf(stderr, "Erro ao remover o código %d do índice.\n", code);
+        libraryAbortTransaction(library);
+        return -1;
     }
 
-    long offset; // A posição onde o livro será armazenado no arquivo de dados
+    // Marca o registro como removido (as leituras sequenciais o ignoram) e o devolve ao alocador. As etapas que podem
+    // falhar vêm antes das alterações dos índices secundários, que a transação descartada não restaura
+    BookDataFreeNode freeNode;
+    freeNode.offset = -1;     // Ocupa o lugar do código do livro
+    freeNode.nextOffset = -1; // O encadeamento é gravado pelo alocador no commit
 
-    // Verifica se há uma posição livre para reutilizar no arquivo de dados
-    if (dataHeader.headEmptyPosition != -1)
+    if (IO_STATS_WRITE(IO_STATS_RECORD_WRITE, dataFile, sizeof(BookDataFileHeader) + offset * sizeof(Book), &freeNode,
+                       sizeof(BookDataFreeNode)) != 0)
     {
-        // Reutiliza a posição livre
-        offset = dataHeader.headEmptyPosition;
+        perror("Erro ao marcar o livro como removido");
+        libraryAbortTransaction(library);
+        return -1;
+    }
 
-        // Lê a próxima posição livre da lista encadeada de espaços livres
-        BookDataFreeNode freeNode;
-        if (fseek(dataFile, sizeof(BookDataFileHeader) + offset * sizeof(Book), SEEK_SET) != 0)
-        {
-            perror("Erro ao posicionar o ponteiro no arquivo de dados");
-            return;
-        }
-        if (fread(&freeNode, sizeof(BookDataFreeNode), 1, dataFile) != 1)
-        {
-            perror("Erro ao ler o próximo nó livre");
-            return;
-        }
+    if (pageRelease(dataFile, offset) != 0)
+    {
+        libraryAbortTransaction(library);
+        return -1;
+    }
 
-        // Atualiza a posição livre no cabeçalho
-        dataHeader.headEmptyPosition = freeNode.nextOffset;
+    dataHeader->bookCount--;
+    dataHeader->stockTotal -= book.stock_quantity;
+    saveHeader(dataFile, dataHeader, sizeof(BookDataFileHeader));
 
-        // Atualiza o cabeçalho no arquivo de dados
-        if (fseek(dataFile, 0, SEEK_SET) != 0)
-        {
-            perror("Erro ao posicionar o ponteiro no arquivo de dados");
-            return;
-        }
+    // Uma entrada ausente também indica um índice secundário desatualizado
+    if (library->authorIndex.file != NULL && authorIndexRemove(&library->authorIndex, book.author, offset) != 0)
+    {
+        libraryMarkStale(library, LIBRARY_SNAPSHOT_AUTHOR_INDEX);
+    }
 
-        if (fwrite(&dataHeader, sizeof(BookDataFileHeader), 1, dataFile) != 1)
-        {
-            perror("Erro ao atualizar o cabeçalho do arquivo de dados");
-            return;
-        }
+    if (library->titleIndex.file != NULL && titleIndexRemove(&library->titleIndex, book.title, offset) != 0)
+    {
+        libraryMarkStale(library, LIBRARY_SNAPSHOT_TITLE_INDEX);
     }
-    else
+
+    if (library->stats.file != NULL)
     {
-        // Caso não haja registros livres, adicione no final do arquivo de dados
-        fseek(dataFile, 0, SEEK_END);
-        offset = ftell(dataFile) / sizeof(Book); // Calcula a posição com base no tamanho do livro
+        bookStatsRemoveBook(&library->stats, &book);
     }
 
-    // Adiciona o livro na posição calculada
-    fseek(dataFile, sizeof(BookDataFileHeader) + offset * sizeof(Book), SEEK_SET);
-    if (fwrite(book, sizeof(Book), 1, dataFile) != 1)
+    if (library->columns.file != NULL)
     {
-        perror("Erro ao adicionar o livro no arquivo de dados");
-        return;
+        columnStoreDelete(&library->columns, offset);
     }
 
-    // Atualiza o índice com o código do livro e o novo offset
-    insertKey(indexFile, book->code, offset, &indexHeader);
+    if (libraryCommitTransaction(library) != 0)
+    {
+        return -1; // O código continua no filtro: um falso positivo apenas exige uma busca a mais
+    }
 
-    // Atualiza o cabeçalho do arquivo de índice com a posição do topo
-    if (offset >= indexHeader.rootAddress)
+    // Retira o código do filtro apenas depois da remoção confirmada, para que o filtro nunca o negue por engano
+    if (library->codeFilter.counters != NULL)
     {
-        indexHeader.rootAddress = offset + 1;
+        codeFilterRemove(&library->codeFilter, code);
     }
 
-    // Atualiza o cabeçalho no arquivo de índice
-    fseek(indexFile, 0, SEEK_SET);
-    if (fwrite(&indexHeader, sizeof(IndexFileHeader), 1, indexFile) != 1)
+    return BOOK_OK;
+}
+
+/**
+ * @brief Remove um livro do arquivo de dados e dos índices, sem exibir mensagens.
+ *
+ * @details A chave do livro é removida da árvore 2-3 e dos índices de autores e de títulos (se estiverem abertos). O registro no
+ *          arquivo de dados é marcado como removido (código -1) e devolvido ao alocador de registros, para ser
+ *          reutilizado pelas próximas inserções.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param code Código do livro a ser removido.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações da operação formam uma única transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante toda a operação.
+ * @note Uma falha ao atualizar um índice secundário não desfaz a remoção: o índice é marcado com `libraryMarkStale`
+ *       e reconstruído na próxima abertura.
+ *
+ * @return `BOOK_OK` se o livro foi removido, `BOOK_NOT_FOUND` se o código não existir no índice, ou -1 em caso de erro.
+ */
+int deleteBookRecord(Library *library, int code)
+{
+    if (treeLockWrite(library->indexFile) != 0)
     {
-        perror("Erro ao atualizar o cabeçalho do arquivo de índice");
-        return;
+        return -1;
     }
 
-    printf("Livro adicionado com sucesso!\n");
+    IO_STATS_BEGIN(IO_STATS_OP_REMOVE);
+    int result = deleteRecord(library, code);
+    IO_STATS_END();
+
+    treeUnlock(library->indexFile);
+    return result;
 }
 
 /**
- * @brief Coleta dados de um livro do usuário e os adiciona ao arquivo.
+ * @brief Remove um livro da biblioteca.
  *
- * @details Esta função solicita ao usuário que insira os detalhes de um livro, incluindo código, título, autor, editora, edição, ano, preço e estoque.
- *          A função valida os dados inseridos pelo usuário, ajusta o formato do preço, e adiciona o livro ao arquivo especificado.
- *          Caso o usuário insira um preço com vírgula, a função ajusta o formato para usar ponto como separador decimal.
- *          Se o preço inserido for inválido ou qualquer outro dado for inserido de forma incorreta, a função solicita a reentrada dos dados.
+ * @details Chama `deleteBookRecord` e registra a operação no handle da biblioteca.
  *
- * @param fp Ponteiro para o arquivo onde o livro será adicionado. O arquivo deve estar aberto no modo de escrita.
- * @param cabecalho Ponteiro para o cabeçalho do arquivo. Deve ser um ponteiro válido para um objeto `Cabecalho` que será atualizado conforme necessário.
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param code Código do livro a ser removido.
  *
- * @pre O ponteiro `fp` deve ser um ponteiro válido para um arquivo aberto no modo de escrita.
- * @pre O ponteiro `cabecalho` deve ser um ponteiro válido para um objeto `Cabecalho` que esteja corretamente inicializado e acessível.
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
  *
- * @post Os dados do livro inseridos pelo usuário são lidos e processados. Se o preço foi inserido com uma vírgula, ele será convertido para o formato com ponto.
- *       O livro é adicionado ao arquivo através da função `adicionarLivro`. Uma mensagem de sucesso é exibida ao final do processo.
+ * @return 0 se o livro foi removido, -1 se não foi encontrado ou em caso de erro.
+ */
+int removeBook(Library *library, int code)
+{
+    int result = deleteBookRecord(library, code);
+
+    if (result == BOOK_NOT_FOUND)
+    {
+        printf("Livro com código %d não encontrado.\n", code);
+        return -1;
+    }
+
+    if (result != BOOK_OK)
+    {
+        return -1;
+    }
+
+    libraryEndOperation(library);
+
+    return 0;
+}
+
+/**
+ * @brief Verifica se um preço é válido (finito e positivo), como exigido no cadastro de livros.
+ */
+static int bookPriceIsValid(double price)
+{
+    return isfinite(price) && price > 0;
+}
+
+/**
+ * @brief Valida uma atualização: o novo preço deve ser válido e o estoque resultante não negativo e representável
+ *        em um `int`.
  *
- * @note A função usa `fgets` para ler strings e garantir que não ocorram estouros de buffer. Além disso, é feita a limpeza do buffer de entrada após cada leitura
- *       com `scanf` para evitar problemas com entradas residuais.
+ * @return `BOOK_OK`, `BOOK_INVALID_PRICE` ou `BOOK_INSUFFICIENT_STOCK`.
  */
-void registerBook(FILE *dataFile, FILE *indexFile)
+static int checkBookUpdate(const Book *book, const BookUpdate *update)
 {
-    Book livro;
-    char precoStr[20];
-    int entradaValida;
+    long long stock = book->stock_quantity;
+
+    if ((update->fields & BOOK_UPDATE_PRICE) && !bookPriceIsValid(update->price))
+    {
+        return BOOK_INVALID_PRICE;
+    }
+
+    if (update->fields & BOOK_UPDATE_STOCK)
+    {
+        stock += update->stockDelta;
+    }
+
+    return stock >= 0 && stock <= INT_MAX ? BOOK_OK : BOOK_INSUFFICIENT_STOCK;
+}
+
+/**
+ * @brief Aplica uma atualização ao livro já lido e regrava apenas os bytes dos campos alterados.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta, com a transação já iniciada.
+ * @param offset Posição do livro no arquivo de dados.
+ * @param book Livro lido da posição; recebe os campos alterados.
+ * @param update Atualização a ser aplicada.
+ *
+ * @return `BOOK_OK`, `BOOK_INVALID_PRICE` ou `BOOK_INSUFFICIENT_STOCK` (nada é gravado), ou -1 em caso de erro de
+ *         gravação.
+ */
+static int applyBookUpdate(Library *library, long offset, Book *book, const BookUpdate *update)
+{
+    int stockChanged = (update->fields & BOOK_UPDATE_STOCK) != 0;
+    int priceChanged = (update->fields & BOOK_UPDATE_PRICE) != 0;
+    int delta = stockChanged ? update->stockDelta : 0;
+    int status = checkBookUpdate(book, update);
+
+    if (status != BOOK_OK)
+    {
+        return status;
+    }
+
+    if (!stockChanged && !priceChanged)
+    {
+        return BOOK_OK;
+    }
+
+    // O preço e o estoque são vizinhos no registro: o trecho gravado vai do primeiro ao último campo alterado
+    size_t first = priceChanged ? offsetof(Book, price) : offsetof(Book, stock_quantity);
+    size_t last = stockChanged ? offsetof(Book, stock_quantity) + sizeof(book->stock_quantity)
+                               : offsetof(Book, price) + sizeof(book->price);
+
+    if (priceChanged)
+    {
+        book->price = update->price;
+    }
+
+    book->stock_quantity += delta;
+
+    if (IO_STATS_WRITE(IO_STATS_RECORD_WRITE, library->dataFile,
+                       sizeof(BookDataFileHeader) + offset * sizeof(Book) + (long)first, (const char *)book + first,
+                       last - first) != 0)
+    {
+        perror("Erro ao gravar o livro no arquivo de dados");
+        return -1;
+    }
+
+    if (delta != 0)
+    {
+        library->dataHeader.stockTotal += delta;
+        saveHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader));
+    }
+
+    return BOOK_OK;
+}
+
+/**
+ * @brief Leva uma atualização já gravada às estatísticas e ao arquivo de colunas abertos.
+ *
+ * @details É chamada depois de confirmada a transação, para que uma transação descartada não deixe as estruturas
+ *          secundárias à frente do arquivo de dados.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param offset Posição do livro no arquivo de dados.
+ * @param book Livro com os campos já alterados por `applyBookUpdate`.
+ * @param update Atualização aplicada.
+ */
+static void applyBookUpdateSecondaries(Library *library, long offset, const Book *book, const BookUpdate *update)
+{
+    int stockChanged = (update->fields & BOOK_UPDATE_STOCK) != 0;
+    int priceChanged = (update->fields & BOOK_UPDATE_PRICE) != 0;
+
+    if (library->stats.file != NULL && stockChanged && update->stockDelta != 0)
+    {
+        bookStatsAdjustStock(&library->stats, book, update->stockDelta);
+    }
+
+    if (library->columns.file != NULL)
+    {
+        if (stockChanged)
+        {
+            columnStoreSetStock(&library->columns, offset, book->stock_quantity);
+        }
+
+        if (priceChanged)
+        {
+            columnStoreSetPrice(&library->columns, offset, book->price);
+        }
+    }
+}
+
+/**
+ * @brief Atualiza o livro com a trava de escrita do índice já obtida.
+ *
+ * @return O mesmo valor de `updateBookRecord`.
+ */
+static int updateRecord(Library *library, const BookUpdate *update)
+{
+    long offset = getBookOffset(library->indexFile, update->code);
+    long position = sizeof(BookDataFileHeader) + offset * sizeof(Book);
+    Book book;
+
+    if (offset == -1)
+    {
+        return BOOK_NOT_FOUND;
+    }
+
+    if (IO_STATS_READ(IO_STATS_RECORD_READ, library->dataFile, position, &book, sizeof(Book)) != 0)
+    {
+        perror("Erro ao ler o livro no arquivo de dados");
+        return -1;
+    }
+
+    int status = checkBookUpdate(&book, update);
+
+    if (status != BOOK_OK)
+    {
+        return status;
+    }
+
+    libraryBeginTransaction(library);
+
+    int result = applyBookUpdate(library, offset, &book, update);
+
+    if (result == -1)
+    {
+        libraryAbortTransaction(library);
+        return -1;
+    }
+
+    if (libraryCommitTransaction(library) != 0)
+    {
+        return -1;
+    }
+
+    if (result == BOOK_OK)
+    {
+        applyBookUpdateSecondaries(library, offset, &book, update);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Altera o estoque do livro com a trava de escrita do índice já obtida.
+ *
+ * @return O mesmo valor de `adjustBookStockRecord`.
+ */
+static int adjustStockRecord(Library *library, int code, int delta)
+{
+    BookUpdate update = {code, BOOK_UPDATE_STOCK, 0.0, delta};
+
+    return updateRecord(library, &update);
+}
+
+/**
+ * @brief Altera a quantidade em estoque de um livro, sem exibir mensagens.
+ *
+ * @details O registro do livro é lido e apenas o campo do estoque é regravado, na mesma posição (veja
+ *          `updateBookRecord`). O total em estoque do cabeçalho do arquivo de dados e as estatísticas abertas são
+ *          ajustados pela mesma variação.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param code Código do livro.
+ * @param delta Variação da quantidade em estoque (negativa para saídas).
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações da operação formam uma única transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante toda a operação.
+ *
+ * @return `BOOK_OK` se o estoque foi alterado, `BOOK_NOT_FOUND` se o código não existir no índice,
+ *         `BOOK_INSUFFICIENT_STOCK` se o estoque ficaria negativo, ou -1 em caso de erro.
+ */
+int adjustBookStockRecord(Library *library, int code, int delta)
+{
+    if (treeLockWrite(library->indexFile) != 0)
+    {
+        return -1;
+    }
+
+    IO_STATS_BEGIN(IO_STATS_OP_UPDATE);
+    int result = adjustStockRecord(library, code, delta);
+    IO_STATS_END();
+
+    treeUnlock(library->indexFile);
+    return result;
+}
+
+/**
+ * @brief Altera o preço e/ou o estoque de um livro no próprio registro, sem exibir mensagens.
+ *
+ * @details O código é procurado uma única vez no índice e o registro é lido para validar a alteração e ajustar as
+ *          estatísticas. Apenas os bytes dos campos alterados são regravados, em uma única gravação (o preço e o
+ *          estoque são campos vizinhos do registro); o índice, os demais campos e a lista de registros livres não
+ *          são alterados. O total em estoque do cabeçalho, as estatísticas e o arquivo de colunas abertos são
+ *          ajustados junto (as estatísticas e as colunas, depois de confirmada a transação).
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param update Ponteiro para a atualização.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações da operação formam uma única transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante toda a operação.
+ *
+ * @return `BOOK_OK` se o livro foi alterado, `BOOK_NOT_FOUND` se o código não existir no índice,
+ *         `BOOK_INVALID_PRICE` se o novo preço não for finito e positivo, `BOOK_INSUFFICIENT_STOCK` se o estoque
+ *         ficaria negativo (nos dois casos, nenhum campo é alterado), ou -1 em caso de erro.
+ */
+int updateBookRecord(Library *library, const BookUpdate *update)
+{
+    if (treeLockWrite(library->indexFile) != 0)
+    {
+        return -1;
+    }
+
+    IO_STATS_BEGIN(IO_STATS_OP_UPDATE);
+    int result = updateRecord(library, update);
+    IO_STATS_END();
+
+    treeUnlock(library->indexFile);
+    return result;
+}
+
+/**
+ * @brief Lê um livro a partir do seu código, sem exibir mensagens.
+ *
+ * @details O código é procurado na árvore 2-3 e o registro correspondente é lido do arquivo de dados. Com o acesso
+ *          concorrente ligado (`libraryEnableConcurrency`), a trava de leitura do índice é mantida durante a busca e a
+ *          leitura do registro, de modo que várias threads podem ler livros ao mesmo tempo, enquanto as inserções,
+ *          remoções e alterações de estoque aguardam.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param code Código do livro.
+ * @param book Ponteiro para a estrutura que recebe o livro lido.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @return `BOOK_OK` se o livro foi lido, `BOOK_NOT_FOUND` se o código não existir no índice, ou -1 em caso de erro.
+ */
+int readBookRecord(Library *library, int code, Book *book)
+{
+    if (treeLockRead(library->indexFile) != 0)
+    {
+        return -1;
+    }
+
+    IO_STATS_BEGIN(IO_STATS_OP_SEARCH);
+    long offset = getBookOffset(library->indexFile, code);
+    int result = BOOK_OK;
+
+    if (offset == -1)
+    {
+        result = BOOK_NOT_FOUND;
+    }
+    else if (IO_STATS_READ(IO_STATS_RECORD_READ, library->dataFile, sizeof(BookDataFileHeader) + offset * sizeof(Book),
+                           book, sizeof(Book)) != 0)
+    {
+        perror("Erro ao ler o livro no arquivo de dados");
+        result = -1;
+    }
+    else if (book->code != code)
+    {
+        result = BOOK_NOT_FOUND; // Registro removido
+    }
+
+    IO_STATS_END();
+    treeUnlock(library->indexFile);
+    return result;
+}
+
+/**
+ * @brief Posição de um livro de uma leitura em lote e seu lugar no vetor de resultados.
+ */
+typedef struct
+{
+    int position; // Posição do livro no arquivo de dados
+    int slot;     // Índice do código no lote
+} BatchRead;
+
+/**
+ * @brief Compara duas entradas de uma leitura em lote pela posição no arquivo de dados.
+ */
+static int compareBatchReads(const void *a, const void *b)
+{
+    int x = ((const BatchRead *)a)->position;
+    int y = ((const BatchRead *)b)->position;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Lê um lote de livros a partir dos seus códigos, sem exibir mensagens.
+ *
+ * @details Os códigos são procurados de uma só vez com `twoThreeTreeSearchMany`, e os registros encontrados são lidos
+ *          em ordem crescente de posição no arquivo de dados, com registros consecutivos lidos em uma única leitura.
+ *          Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de leitura do índice é mantida
+ *          durante a busca e a leitura de todo o lote.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param codes Códigos dos livros, em qualquer ordem.
+ * @param n Número de códigos.
+ * @param books Vetor que recebe, na ordem de `codes`, o livro de cada código. O campo `code` dos livros não
+ *              encontrados é -1.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @return Número de livros encontrados, ou -1 em caso de erro de memória ou de leitura.
+ */
+int readBookRecords(Library *library, const int *codes, int n, Book *books)
+{
+    int *positions = malloc(sizeof(int) * (n > 0 ? n : 1));
+    BatchRead *entries = malloc(sizeof(BatchRead) * (n > 0 ? n : 1));
+    Book *buffer = malloc(sizeof(Book) * (n > 0 ? n : 1));
+    int count = 0;
+    int found = 0;
+
+    if (positions == NULL || entries == NULL || buffer == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a leitura em lote.\n");
+        free(positions);
+        free(entries);
+        free(buffer);
+        return -1;
+    }
+
+    if (treeLockRead(library->indexFile) != 0)
+    {
+        free(positions);
+        free(entries);
+        free(buffer);
+        return -1;
+    }
+
+    IO_STATS_BEGIN(IO_STATS_OP_SEARCH);
+
+    if (twoThreeTreeSearchMany(library->indexFile, codes, n, positions) == -1)
+    {
+        found = -1;
+    }
+
+    for (int i = 0; found != -1 && i < n; i++)
+    {
+        books[i].code = -1;
+
+        if (positions[i] != -1)
+        {
+            entries[count].position = positions[i];
+            entries[count].slot = i;
+            count++;
+        }
+    }
+
+    // Lê os registros na ordem do arquivo, juntando posições consecutivas em uma única leitura
+    qsort(entries, count, sizeof(BatchRead), compareBatchReads);
+
+    // Antecipa todos os trechos do lote, para que o dispositivo os leia em paralelo (com um único trecho, não há o que
+    // antecipar)
+    for (int start = 0; start < count;)
+    {
+        int end = start + 1;
+
+        while (end < count && entries[end].position <= entries[end - 1].position + 1)
+        {
+            end++;
+        }
+
+        if (start > 0 || end < count)
+        {
+            storagePrefetch(library->dataFile, sizeof(BookDataFileHeader) + (long)entries[start].position * sizeof(Book),
+                            sizeof(Book) * (entries[end - 1].position - entries[start].position + 1));
+        }
+
+        start = end;
+    }
+
+    for (int start = 0; found != -1 && start < count;)
+    {
+        int end = start + 1;
+
+        while (end < count && entries[end].position <= entries[end - 1].position + 1)
+        {
+            end++;
+        }
+
+        int first = entries[start].position;
+        int run = entries[end - 1].position - first + 1;
+
+        if (IO_STATS_READ(IO_STATS_RECORD_READ, library->dataFile,
+                          sizeof(BookDataFileHeader) + (long)first * sizeof(Book), buffer, sizeof(Book) * run) != 0)
+        {
+            perror("Erro ao ler os livros do lote");
+            found = -1;
+            break;
+        }
+
+        for (int i = start; i < end; i++)
+        {
+            Book *book = &buffer[entries[i].position - first];
+
+            // Um registro removido (código -1) não pertence a nenhum dos códigos buscados
+            if (book->code == codes[entries[i].slot])
+            {
+                books[entries[i].slot] = *book;
+                found++;
+            }
+        }
+
+        start = end;
+    }
+
+    IO_STATS_END();
+    treeUnlock(library->indexFile);
+
+    free(positions);
+    free(entries);
+    free(buffer);
+
+    return found;
+}
+
+/**
+ * @brief Compara duas entradas de uma atualização em lote pela posição no arquivo de dados e, na mesma posição, pela
+ *        ordem no lote.
+ */
+static int compareBatchUpdates(const void *a, const void *b)
+{
+    const BatchRead *x = a;
+    const BatchRead *y = b;
+
+    if (x->position != y->position)
+    {
+        return (x->position > y->position) - (x->position < y->position);
+    }
+
+    return (x->slot > y->slot) - (x->slot < y->slot);
+}
+
+/**
+ * @brief Atualização de um lote já gravada, guardada até a confirmação da transação para as estruturas secundárias.
+ */
+typedef struct
+{
+    int position; // Posição do livro no arquivo de dados
+    int slot;     // Índice da atualização no lote
+    Book book;    // Livro com os campos já alterados
+} AppliedUpdate;
+
+/**
+ * @brief Aplica um lote de atualizações de preço e/ou estoque, sem exibir mensagens.
+ *
+ * @details Os códigos são procurados de uma só vez com `twoThreeTreeSearchMany`, e as atualizações são aplicadas em
+ *          ordem crescente de posição no arquivo de dados: os registros consecutivos são lidos em uma única leitura
+ *          (de até `BOOK_UPDATE_MAX_RUN` registros) e cada atualização regrava apenas os campos alterados, como em
+ *          `updateBookRecord`. As atualizações de um mesmo código são aplicadas na ordem do lote.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param updates Atualizações, em qualquer ordem.
+ * @param n Número de atualizações.
+ * @param results Vetor que recebe, na ordem de `updates`, o resultado de cada atualização (`BOOK_OK`,
+ *                `BOOK_NOT_FOUND`, `BOOK_INVALID_PRICE`, `BOOK_INSUFFICIENT_STOCK` ou -1), ou NULL.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @note Com o log de escrita antecipada aberto, as gravações de todo o lote formam uma única transação: em caso de
+ *       erro, a transação é descartada, nenhuma atualização é aplicada e as que seriam aplicadas recebem -1 em
+ *       `results`. Sem o log, as atualizações gravadas antes do erro permanecem nos arquivos, com `BOOK_OK`.
+ * @note As estatísticas e o arquivo de colunas só são ajustados depois de confirmada a transação.
+ * @note Com o acesso concorrente ligado (`libraryEnableConcurrency`), a trava de escrita do índice é mantida
+ *       durante todo o lote.
+ *
+ * @return Número de atualizações aplicadas, ou -1 em caso de erro de memória, de leitura ou de gravação.
+ */
+int updateBookRecords(Library *library, const BookUpdate *updates, int n, int *results)
+{
+    int *codes = malloc(sizeof(int) * (n > 0 ? n : 1));
+    int *positions = malloc(sizeof(int) * (n > 0 ? n : 1));
+    BatchRead *entries = malloc(sizeof(BatchRead) * (n > 0 ? n : 1));
+    int logged = library->wal.file != NULL;
+    int secondaries = library->stats.file != NULL || library->columns.file != NULL;
+    // As atualizações gravadas só chegam às estatísticas e às colunas depois de confirmada a transação
+    AppliedUpdate *done = secondaries ? malloc(sizeof(AppliedUpdate) * (n > 0 ? n : 1)) : NULL;
+    Book buffer[BOOK_UPDATE_MAX_RUN];
+    int count = 0;
+    int doneCount = 0;
+    int applied = 0;
+
+    if (codes == NULL || positions == NULL || entries == NULL || (secondaries && done == NULL))
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a atualização em lote.\n");
+        free(codes);
+        free(positions);
+        free(entries);
+        free(done);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        codes[i] = updates[i].code;
+
+        if (results != NULL)
+        {
+            results[i] = BOOK_NOT_FOUND;
+        }
+    }
+
+    if (treeLockWrite(library->indexFile) != 0)
+    {
+        free(codes);
+        free(positions);
+        free(entries);
+        free(done);
+        return -1;
+    }
+
+    IO_STATS_BEGIN(IO_STATS_OP_UPDATE);
+
+    if (twoThreeTreeSearchMany(library->indexFile, codes, n, positions) == -1)
+    {
+        applied = -1;
+    }
+
+    for (int i = 0; applied != -1 && i < n; i++)
+    {
+        if (positions[i] != -1)
+        {
+            entries[count].position = positions[i];
+            entries[count].slot = i;
+            count++;
+        }
+    }
+
+    // Aplica as atualizações na ordem do arquivo; as de um mesmo código ficam na ordem do lote
+    qsort(entries, count, sizeof(BatchRead), compareBatchUpdates);
+
+    if (applied != -1 && count > 0)
+    {
+        libraryBeginTransaction(library);
+    }
+
+    for (int start = 0; applied != -1 && start < count;)
+    {
+        int first = entries[start].position;
+        int end = start + 1;
+
+        // Junta as posições consecutivas (ou repetidas) em uma única leitura de até `BOOK_UPDATE_MAX_RUN` registros
+        while (end < count && entries[end].position <= entries[end - 1].position + 1 &&
+               entries[end].position - first < BOOK_UPDATE_MAX_RUN)
+        {
+            end++;
+        }
+
+        int run = entries[end - 1].position - first + 1;
+
+        if (IO_STATS_READ(IO_STATS_RECORD_READ, library->dataFile,
+                          sizeof(BookDataFileHeader) + (long)first * sizeof(Book), buffer, sizeof(Book) * run) != 0)
+        {
+            perror("Erro ao ler os livros do lote");
+            applied = -1;
+            break;
+        }
+
+        for (int i = start; i < end; i++)
+        {
+            const BookUpdate *update = &updates[entries[i].slot];
+            Book *book = &buffer[entries[i].position - first];
+            int result = BOOK_NOT_FOUND; // Um registro removido (código -1) não pertence ao código buscado
+
+            if (book->code == update->code)
+            {
+                // O livro do buffer recebe as alterações, de modo que a próxima atualização do código parte delas
+                result = applyBookUpdate(library, entries[i].position, book, update);
+            }
+
+            if (results != NULL)
+            {
+                results[entries[i].slot] = result;
+            }
+
+            if (result == -1)
+            {
+                applied = -1;
+                break;
+            }
+
+            if (result == BOOK_OK)
+            {
+                if (done != NULL)
+                {
+                    done[doneCount].position = entries[i].position;
+                    done[doneCount].slot = entries[i].slot;
+                    done[doneCount].book = *book;
+                    doneCount++;
+                }
+
+                applied++;
+            }
+        }
+
+        start = end;
+    }
+
+    if (applied == -1)
+    {
+        // O lote inteiro é descartado: nenhuma atualização chega aos arquivos
+        libraryAbortTransaction(library);
+    }
+    else if (count > 0 && libraryCommitTransaction(library) != 0)
+    {
+        applied = -1; // A confirmação que falha já descarta a transação
+    }
+
+    if (applied == -1 && logged && results != NULL)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (results[entries[i].slot] == BOOK_OK)
+            {
+                results[entries[i].slot] = -1;
+            }
+        }
+    }
+
+    // Sem o log, as gravações feitas antes do erro já estão nos arquivos e não podem ser desfeitas
+    if (applied != -1 || !logged)
+    {
+        for (int i = 0; i < doneCount; i++)
+        {
+            applyBookUpdateSecondaries(library, done[i].position, &done[i].book, &updates[done[i].slot]);
+        }
+    }
+
+    IO_STATS_END();
+    treeUnlock(library->indexFile);
+
+    free(codes);
+    free(positions);
+    free(entries);
+    free(done);
+
+    return applied;
+}
+
+/**
+ * @brief Coleta dados de um livro do usuário e os adiciona ao arquivo.
+ *
+ * @details Esta função solicita ao usuário que insira os detalhes de um livro, incluindo código, título, autor, editora, edição, ano, preço e estoque.
+ *          A função valida os dados inseridos pelo usuário, ajusta o formato do preço, e adiciona o livro ao arquivo especificado.
+ *          Caso o usuário insira um preço com vírgula, a função ajusta o formato para usar ponto como separador decimal.
+ *          Se o preço inserido for inválido ou qualquer outro dado for inserido de forma incorreta, a função solicita a reentrada dos dados.
+ *
+ * @param library Ponteiro para o handle da biblioteca onde o livro será adicionado.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @post Os dados do livro inseridos pelo usuário são lidos e processados. Se o preço foi inserido com uma vírgula, ele será convertido para o formato com ponto.
+ *       O livro é adicionado ao arquivo através da função `adicionarLivro`. Uma mensagem de sucesso é exibida ao final do processo.
+ *
+ * @note A função usa `fgets` para ler strings e garantir que não ocorram estouros de buffer. Além disso, é feita a limpeza do buffer de entrada após cada leitura
+ *       com `scanf` para evitar problemas com entradas residuais.
+ */
+void registerBook(Library *library)
+{
+    Book livro;
+    char precoStr[20];
+    int entradaValida;
+
+    // Coletar dados do livro
+    printf("Digite os dados do livro:\n");
+
+    // Código
+    do
+    {
+        printf("Codigo: ");
+        entradaValida = scanf("%d", &livro.code);
+        while (getchar() != '\n')
+            ; // Limpar buffer de entrada
+    } while (entradaValida != 1);
+
+    // Título
+    printf("Titulo: ");
+    if (fgets(livro.title, sizeof(livro.title), stdin) == NULL)
+    {
+        printf("Erro ao ler o título.\n");
+        return;
+    }
+    livro.title[strcspn(livro.title, "\n")] = '\0'; // Remover newline
+
+    // Autor
+    printf("Autor: ");
+    if (fgets(livro.author, sizeof(livro.author), stdin) == NULL)
+    {
+        printf("Erro ao ler o autor.\n");
+        return;
+    }
+    livro.author[strcspn(livro.author, "\n")] = '\0'; // Remover newline
+
+    // Editora
+    printf("Editora: ");
+    if (fgets(livro.publisher, sizeof(livro.publisher), stdin) == NULL)
+    {
+        printf("Erro ao ler a editora.\n");
+        return;
+    }
+    livro.publisher[strcspn(livro.publisher, "\n")] = '\0'; // Remover newline
+
+    // Edição
+    do
+    {
+        printf("Edicao: ");
+        entradaValida = scanf("%d", &livro.edition);
+        while (getchar() != '\n')
+            ; // Limpar buffer de entrada
+    } while (entradaValida != 1);
+
+    // Ano
+    do
+    {
+        printf("Ano: ");
+        entradaValida = scanf("%d", &livro.year);
+        while (getchar() != '\n')
+            ; // Limpar buffer de entrada
+    } while (entradaValida != 1);
+
+    // Preço
+    do
+    {
+        printf("Preco: ");
+        if (fgets(precoStr, sizeof(precoStr), stdin) == NULL)
+        {
+            printf("Erro ao ler o preço.\n");
+            return;
+        }
+        formatDecimalSeparator(precoStr); // Ajusta o formato do preço
+        livro.price = strtof(precoStr, NULL);
+
+        // Verifica se a conversão foi bem-sucedida e se o valor é positivo
+        if (!bookPriceIsValid(livro.price))
+        {
+            printf("Valor de preco invalido. Tente novamente.\n");
+            entradaValida = 0;
+        }
+        else
+        {
+            entradaValida = 1;
+        }
+    } while (entradaValida != 1);
+
+    // Estoque
+    do
+    {
+        printf("Estoque: ");
+        entradaValida = scanf("%d", &livro.stock_quantity);
+        while (getchar() != '\n')
+            ; // Limpar buffer de entrada
+
+        if (entradaValida == 1 && livro.stock_quantity < 0)
+        {
+            printf("Valor de estoque invalido. Tente novamente.\n");
+            entradaValida = 0;
+        }
+    } while (entradaValida != 1);
+
+    // Adiciona o livro ao arquivo
+    addBook(library, &livro);
+
+    printf("Livro adicionado com sucesso.\n");
+}
+
+/**
+ * @brief Lê um livro do arquivo de dados a partir da sua posição (número do registro).
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int readBookAt(FILE *dataFile, long position, Book *book)
+{
+    return IO_STATS_READ(IO_STATS_RECORD_READ, dataFile, sizeof(BookDataFileHeader) + position * sizeof(Book), book,
+                         sizeof(Book));
+}
+
+/**
+ * @brief Antecipa a leitura do registro de uma posição (veja `storagePrefetch`).
+ */
+static void prefetchBookAt(FILE *dataFile, long position)
+{
+    storagePrefetch(dataFile, sizeof(BookDataFileHeader) + position * sizeof(Book), sizeof(Book));
+}
+
+/**
+ * @brief Contexto da busca de livros por um campo de texto (autor ou título) na varredura paralela.
+ */
+typedef struct
+{
+    size_t fieldOffset;            // Deslocamento do campo em `Book`
+    size_t fieldSize;              // Tamanho do campo
+    char key[BOOK_STATS_KEY_SIZE]; // Valor procurado, normalizado
+} TextMatchQuery;
+
+/**
+ * @brief Posições dos livros encontrados (resultado parcial de uma thread ou resultado final de uma busca).
+ */
+typedef struct
+{
+    long *positions; // Posições encontradas, em ordem crescente
+    int count;       // Número de posições
+    int capacity;    // Capacidade do vetor `positions`
+} MatchList;
+
+/**
+ * @brief Acrescenta posições ao final de uma lista de posições encontradas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int appendMatches(MatchList *list, const long *positions, int count)
+{
+    if (list->count + count > list->capacity)
+    {
+        int capacity = list->capacity > 0 ? list->capacity : 16;
+
+        while (capacity < list->count + count)
+        {
+            capacity *= 2;
+        }
+
+        long *resized = realloc(list->positions, sizeof(long) * capacity);
+
+        if (resized == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para os resultados da busca.\n");
+            return -1;
+        }
+
+        list->positions = resized;
+        list->capacity = capacity;
+    }
+
+    memcpy(list->positions + list->count, positions, sizeof(long) * count);
+    list->count += count;
+
+    return 0;
+}
+
+/**
+ * @brief Compara o campo de texto de um livro com o valor procurado (função `visit` da varredura paralela).
+ */
+static int visitTextMatch(const Book *book, long position, const void *context, void *partial)
+{
+    const TextMatchQuery *query = context;
+    char normalizado[BOOK_STATS_KEY_SIZE];
+
+    normalizeString((const char *)book + query->fieldOffset, normalizado, query->fieldSize);
+
+    if (strcmp(normalizado, query->key) != 0)
+    {
+        return 0;
+    }
+
+    return appendMatches(partial, &position, 1);
+}
+
+/**
+ * @brief Acrescenta as posições encontradas por uma thread ao resultado da busca (função `merge`).
+ */
+static int mergeTextMatches(void *result, void *partial, const void *context)
+{
+    MatchList *parcial = partial;
+    int status = appendMatches(result, parcial->positions, parcial->count);
+
+    (void)context;
+    free(parcial->positions);
+
+    return status;
+}
+
+/**
+ * @brief Percorre o arquivo de dados em paralelo, procurando os livros com um valor em um campo de texto.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param fieldOffset Deslocamento do campo em `Book` (`offsetof(Book, author)`, por exemplo).
+ * @param fieldSize Tamanho do campo.
+ * @param valor Valor procurado. A comparação ignora maiúsculas e espaços extras.
+ * @param matches Lista (vazia) que receberá as posições encontradas, em ordem crescente; deve ser liberada com
+ *                `free(matches->positions)`.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int scanTextMatches(Library *library, size_t fieldOffset, size_t fieldSize, const char *valor, MatchList *matches)
+{
+    TextMatchQuery busca = {fieldOffset, fieldSize, ""};
+    ParallelScanQuery consulta = {visitTextMatch, mergeTextMatches, sizeof(MatchList), &busca};
+
+    normalizeString(valor, busca.key, fieldSize);
+    memset(matches, 0, sizeof(MatchList));
+
+    return parallelScan(library->dataFile, library->dataHeader.firstEmptyPosition, &consulta, matches);
+}
+
+/**
+ * @brief Contexto da contagem de livros por um valor de campo na varredura paralela.
+ */
+typedef struct
+{
+    BookStatsField field;          // Campo comparado
+    char key[BOOK_STATS_KEY_SIZE]; // Valor procurado, normalizado
+} FieldCountQuery;
+
+/**
+ * @brief Número de livros e de exemplares encontrados por uma contagem.
+ */
+typedef struct
+{
+    int books; // Livros com o valor procurado
+    int stock; // Exemplares em estoque desses livros
+} FieldCount;
+
+/**
+ * @brief Conta um livro se o seu campo tiver o valor procurado (função `visit` da varredura paralela).
+ */
+static int visitFieldCount(const Book *book, long position, const void *context, void *partial)
+{
+    const FieldCountQuery *query = context;
+    FieldCount *total = partial;
+    char chave[BOOK_STATS_KEY_SIZE];
+
+    (void)position;
+    bookStatsKey(book, query->field, chave);
+
+    if (strcmp(chave, query->key) == 0)
+    {
+        total->books++;
+        total->stock += book->stock_quantity;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Soma a contagem de uma thread ao resultado (função `merge` da varredura paralela).
+ */
+static int mergeFieldCount(void *result, void *partial, const void *context)
+{
+    FieldCount *total = result;
+    const FieldCount *parcial = partial;
+
+    (void)context;
+    total->books += parcial->books;
+    total->stock += parcial->stock;
+
+    return 0;
+}
+
+/**
+ * @brief Agrupa um livro pelo valor do campo (função `visit` da varredura paralela).
+ *
+ * O resultado parcial é uma `BookStatsTable`, inicializada no primeiro livro da thread.
+ */
+static int visitFieldGroup(const Book *book, long position, const void *context, void *partial)
+{
+    BookStatsTable *tabela = partial;
+    char chave[BOOK_STATS_KEY_SIZE];
+
+    (void)position;
+
+    if (tabela->entries == NULL && bookStatsTableInit(tabela) != 0)
+    {
+        return -1;
+    }
+
+    bookStatsKey(book, *(const BookStatsField *)context, chave);
+    return bookStatsTableAdd(tabela, chave, 1, book->stock_quantity);
+}
+
+/**
+ * @brief Soma os contadores de uma thread à tabela do resultado e os libera (função `merge`).
+ */
+static int mergeFieldGroup(void *result, void *partial, const void *context)
+{
+    BookStatsTable *parcial = partial;
+    int status = 0;
 
-    // Coletar dados do livro
-    printf("Digite os dados do livro:\n");
+    (void)context;
 
-    // Código
-    do
+    for (int i = 0; i < parcial->capacity && status == 0; i++)
     {
-        printf("Codigo: ");
-        entradaValida = scanf("%d", &livro.code);
-        while (getchar() != '\n')
-            ; // Limpar buffer de entrada
-    } while (entradaValida != 1);
+        const BookStatsEntry *entrada = &parcial->entries[i];
 
-    // Título
-    printf("Titulo: ");
-    if (fgets(livro.title, sizeof(livro.title), stdin) == NULL)
-    {
-        printf("Erro ao ler o título.\n");
-        return;
+        if (entrada->key[0] != '\0')
+        {
+            status = bookStatsTableAdd(result, entrada->key, entrada->books, entrada->stock);
+        }
     }
-    livro.title[strcspn(livro.title, "\n")] = '\0'; // Remover newline
 
-    // Autor
-    printf("Autor: ");
-    if (fgets(livro.author, sizeof(livro.author), stdin) == NULL)
+    bookStatsTableFree(parcial);
+    return status;
+}
+
+/**
+ * @brief Estatísticas de preço parciais de uma thread, com a soma dos preços para o cálculo da média.
+ */
+typedef struct
+{
+    ColumnStorePriceStats stats; // Estatísticas parciais
+    double sum;                  // Soma dos preços
+} PriceScan;
+
+/**
+ * @brief Acumula o preço de um livro (função `visit` da varredura paralela).
+ */
+static int visitPrice(const Book *book, long position, const void *context, void *partial)
+{
+    PriceScan *parcial = partial;
+    ColumnStorePriceStats *stats = &parcial->stats;
+
+    (void)position;
+    (void)context;
+
+    if (stats->books == 0 || book->price < stats->minPrice)
     {
-        printf("Erro ao ler o autor.\n");
-        return;
+        stats->minPrice = book->price;
     }
-    livro.author[strcspn(livro.author, "\n")] = '\0'; // Remover newline
 
-    // Editora
-    printf("Editora: ");
-    if (fgets(livro.publisher, sizeof(livro.publisher), stdin) == NULL)
+    if (stats->books == 0 || book->price > stats->maxPrice)
     {
-        printf("Erro ao ler a editora.\n");
-        return;
+        stats->maxPrice = book->price;
     }
-    livro.publisher[strcspn(livro.publisher, "\n")] = '\0'; // Remover newline
 
-    // Edição
-    do
-    {
-        printf("Edicao: ");
-        entradaValida = scanf("%d", &livro.edition);
-        while (getchar() != '\n')
-            ; // Limpar buffer de entrada
-    } while (entradaValida != 1);
+    parcial->sum += book->price;
+    stats->stockValue += book->price * book->stock_quantity;
+    stats->books++;
 
-    // Ano
-    do
-    {
-        printf("Ano: ");
-        entradaValida = scanf("%d", &livro.year);
-        while (getchar() != '\n')
-            ; // Limpar buffer de entrada
-    } while (entradaValida != 1);
+    return 0;
+}
 
-    // Preço
-    do
+/**
+ * @brief Combina as estatísticas de preço de uma thread ao resultado (função `merge` da varredura paralela).
+ */
+static int mergePrice(void *result, void *partial, const void *context)
+{
+    PriceScan *total = result;
+    const PriceScan *parcial = partial;
+
+    (void)context;
+
+    if (parcial->stats.books == 0)
     {
-        printf("Preco: ");
-        if (fgets(precoStr, sizeof(precoStr), stdin) == NULL)
-        {
-            printf("Erro ao ler o preço.\n");
-            return;
-        }
-        formatDecimalSeparator(precoStr); // Ajusta o formato do preço
-        livro.price = strtof(precoStr, NULL);
+        return 0;
+    }
 
-        // Verifica se a conversão foi bem-sucedida e se o valor é positivo
-        if (livro.price <= 0)
-        {
-            printf("Valor de preco invalido. Tente novamente.\n");
-            entradaValida = 0;
-        }
-        else
-        {
-            entradaValida = 1;
-        }
-    } while (entradaValida != 1);
+    if (total->stats.books == 0 || parcial->stats.minPrice < total->stats.minPrice)
+    {
+        total->stats.minPrice = parcial->stats.minPrice;
+    }
 
-    // Estoque
-    do
+    if (total->stats.books == 0 || parcial->stats.maxPrice > total->stats.maxPrice)
     {
-        printf("Estoque: ");
-        entradaValida = scanf("%d", &livro.stock_quantity);
-        while (getchar() != '\n')
-            ; // Limpar buffer de entrada
-    } while (entradaValida != 1);
+        total->stats.maxPrice = parcial->stats.maxPrice;
+    }
 
-    // Adiciona o livro ao arquivo
-    addBook(dataFile, indexFile, &livro);
+    total->sum += parcial->sum;
+    total->stats.stockValue += parcial->stats.stockValue;
+    total->stats.books += parcial->stats.books;
 
-    printf("Livro adicionado com sucesso.\n");
+    return 0;
 }
 
 /**
- * @brief Busca e exibe livros de um autor específico em um arquivo.
+ * @brief Busca e exibe livros de um autor específico.
  *
- * @details Esta função percorre um arquivo de livros e imprime os títulos dos livros escritos por um autor específico. A busca é feita de forma insensível a maiúsculas e minúsculas. Se nenhum livro do autor for encontrado, uma mensagem é exibida.
+ * @details Quando o índice de autores da biblioteca está aberto, apenas os registros indicados pelo índice são lidos
+ *          e o autor de cada um é confirmado (descartando colisões do hash). Caso contrário, todos os registros do
+ *          arquivo de dados são percorridos em paralelo (`parallelScan`). Nos dois casos a comparação ignora
+ *          maiúsculas e espaços extras.
  *
- * @param fp Ponteiro para o arquivo onde os livros estão armazenados. O arquivo deve estar aberto no modo de leitura.
- * @param autor Nome do autor pelo qual os livros devem ser buscados. A comparação é feita de forma insensível a maiúsculas e minúsculas.
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param autor Nome do autor pelo qual os livros devem ser buscados.
  *
- * @pre O ponteiro `fp` deve ser um ponteiro válido para um arquivo aberto no modo de leitura.
  * @pre O ponteiro `autor` deve ser uma string válida que representa o nome do autor a ser buscado.
  *
  * @post Todos os livros do autor especificado são exibidos, ou uma mensagem é mostrada se nenhum livro for encontrado.
  */
-void searchByAuthor(FILE *dataFile, const char *autor)
+void searchByAuthor(Library *library, const char *autor)
 {
+    FILE *dataFile = library->dataFile;
+    char autorNormalizado[sizeof(((Book *)0)->author)];
+    char livroNormalizado[sizeof(((Book *)0)->author)];
     Book livro;
-    long posicao = sizeof(BookDataFileHeader); // A posição inicial do primeiro livro é após o cabeçalho
     int encontrado = 0;
 
     if (!dataFile || !autor)
@@ -377,16 +1577,60 @@ void searchByAuthor(FILE *dataFile, const char *autor)
         return;
     }
 
-    // Percorre todos os livros no arquivo
-    while (fseek(dataFile, posicao, SEEK_SET) == 0 && fread(&livro, sizeof(Book), 1, dataFile) == 1)
+    normalizeString(autor, autorNormalizado, sizeof(autorNormalizado));
+
+    if (library->authorIndex.file != NULL)
+    {
+        int count;
+        int *positions = authorIndexLookup(&library->authorIndex, autor, &count);
+
+        for (int i = 0; i < count; i++)
+        {
+            // Mantém as leituras dos próximos registros em andamento
+            for (int j = i == 0 ? 1 : i + STORAGE_PREFETCH_DEPTH; j <= i + STORAGE_PREFETCH_DEPTH && j < count; j++)
+            {
+                prefetchBookAt(dataFile, positions[j]);
+            }
+
+            if (readBookAt(dataFile, positions[i], &livro) != 0 || livro.code == -1)
+            {
+                continue;
+            }
+
+            // Confirma o autor, descartando colisões do hash
+            normalizeString(livro.author, livroNormalizado, sizeof(livroNormalizado));
+            if (strcmp(livroNormalizado, autorNormalizado) == 0)
+            {
+                printf("Titulo: %s\n", livro.title);
+                encontrado = 1;
+            }
+        }
+
+        free(positions);
+    }
+    else
     {
-        if (comparaCaseInsensitive(livro.author, autor) == 0)
+        MatchList encontrados;
+
+        // Sem índice: percorre todos os livros no arquivo, em paralelo, e exibe os encontrados em ordem
+        scanTextMatches(library, offsetof(Book, author), sizeof(livro.author), autor, &encontrados);
+
+        for (int i = 0; i < encontrados.count; i++)
         {
-            // Livro encontrado
-            printf("Titulo: %s\n", livro.title);
-            encontrado = 1;
+            for (int j = i == 0 ? 1 : i + STORAGE_PREFETCH_DEPTH; j <= i + STORAGE_PREFETCH_DEPTH && j < encontrados.count;
+                 j++)
+            {
+                prefetchBookAt(dataFile, encontrados.positions[j]);
+            }
+
+            if (readBookAt(dataFile, encontrados.positions[i], &livro) == 0)
+            {
+                printf("Titulo: %s\n", livro.title);
+                encontrado = 1;
+            }
         }
-        posicao += sizeof(Book); // Move para a próxima posição do livro
+
+        free(encontrados.positions);
     }
 
     if (!encontrado)
@@ -406,16 +1650,9 @@ void showBookInfo(FILE *dataFile, int offset)
     // Calcula a posição do livro no arquivo
     long position = sizeof(BookDataFileHeader) + offset * sizeof(Book);
 
-    // Navega até a posição do livro
-    if (fseek(dataFile, position, SEEK_SET) != 0)
-    {
-        printf("Erro: falha ao buscar a posição do livro no arquivo.\n");
-        return;
-    }
-
     // Lê os dados do livro
     Book livro;
-    if (fread(&livro, sizeof(Book), 1, dataFile) != 1)
+    if (IO_STATS_READ(IO_STATS_RECORD_READ, dataFile, position, &livro, sizeof(Book)) != 0)
     {
         printf("Erro: falha ao ler os dados do livro.\n");
         return;
@@ -434,48 +1671,65 @@ void showBookInfo(FILE *dataFile, int offset)
 }
 
 /**
- * @brief Busca e imprime informações de um livro com um título específico.
+ * @brief Busca e imprime informações dos livros com um título específico.
  *
- * @details Esta função procura por um livro com o título fornecido no arquivo de dados.
- * A busca é realizada de forma insensível a maiúsculas e minúsculas. Se um livro com o título
- * correspondente for encontrado, suas informações são exibidas. Caso contrário, uma mensagem
- * informando que nenhum livro foi encontrado é exibida.
+ * @details Quando o índice de títulos da biblioteca está aberto, apenas os registros indicados pelo índice são
+ * lidos. Caso contrário, todos os registros do arquivo de dados são percorridos em paralelo (`parallelScan`). Nos dois
+ * casos a comparação ignora maiúsculas e espaços extras, e as informações de cada livro encontrado são exibidas.
  *
- * @pre O arquivo deve estar aberto e posicionado corretamente. O ponteiro `fp` deve apontar para um arquivo
- *       binário que contém registros de livros, e o título deve ser uma string não-nula.
+ * @pre O handle deve ter sido aberto com `libraryOpen` e o título deve ser uma string não-nula.
  *
- * @post O conteúdo do arquivo não é modificado. Se um livro com o título especificado for encontrado,
- *       suas informações são exibidas na saída padrão. Caso contrário, uma mensagem indicando que o livro
- *       não foi encontrado é exibida.
+ * @post O conteúdo dos arquivos não é modificado. Se nenhum livro com o título especificado for encontrado,
+ *       uma mensagem indicando que o livro não foi encontrado é exibida.
  *
- * @param fp Ponteiro para o arquivo onde os livros estão armazenados.
+ * @param library Ponteiro para o handle da biblioteca aberta.
  * @param titulo O título do livro a ser pesquisado. Deve ser uma string não-nula.
  */
-void searchByTitle(FILE *filename, const char *titulo)
+void searchByTitle(Library *library, const char *titulo)
 {
-    Book livro;
-    long posicao = sizeof(BookDataFileHeader); // Posição inicial após o cabeçalho
+    FILE *dataFile = library->dataFile;
     int encontrado = 0;
 
     // Verifica se o ponteiro do arquivo é válido
-    if (!filename || !titulo)
+    if (!dataFile || !titulo)
     {
         fprintf(stderr, "Arquivo invalido ou titulo nulo.\n");
         return;
     }
 
-    // Percorre todos os livros no arquivo
-    while (fseek(filename, posicao, SEEK_SET) == 0 && fread(&livro, sizeof(Book), 1, filename) == 1)
+    if (library->titleIndex.file != NULL)
     {
-        // Compara o título do livro com o título fornecido
-        if (comparaCaseInsensitive(livro.title, titulo) == 0)
+        int count;
+        int *positions = titleIndexSearch(&library->titleIndex, titulo, 0, 0, &count);
+
+        for (int i = 0; i < count; i++)
+        {
+            for (int j = i == 0 ? 1 : i + STORAGE_PREFETCH_DEPTH; j <= i + STORAGE_PREFETCH_DEPTH && j < count; j++)
+            {
+                prefetchBookAt(dataFile, positions[j]);
+            }
+
+            showBookInfo(dataFile, positions[i]);
+        }
+
+        encontrado = count > 0;
+        free(positions);
+    }
+    else
+    {
+        MatchList encontrados;
+
+        // Sem índice: percorre todos os livros no arquivo, em paralelo, e exibe os encontrados em ordem
+        scanTextMatches(library, offsetof(Book, title), sizeof(((Book *)0)->title), titulo, &encontrados);
+
+        for (int i = 0; i < encontrados.count; i++)
         {
-            // Livro encontrado, imprime as informações
-            showBookInfo(filename, posicao);
-            encontrado = 1;
-            break; // Se você quiser parar após encontrar o primeiro livro com o título, use break
+            // showBookInfo espera a posição do registro, não o deslocamento em bytes
+            showBookInfo(dataFile, encontrados.positions[i]);
         }
-        posicao += sizeof(Book); // Move para a próxima posição do livro
+
+        encontrado = encontrados.count > 0;
+        free(encontrados.positions);
     }
 
     if (!encontrado)
@@ -484,13 +1738,55 @@ void searchByTitle(FILE *filename, const char *titulo)
     }
 }
 
+/**
+ * @brief Lista, em ordem de título, os livros cujo título começa pelo prefixo informado.
+ *
+ * @details Requer o índice de títulos aberto: a busca visita apenas os ramos da árvore que podem conter o prefixo,
+ *          o que permite usá-la para autocompletar sem percorrer o arquivo de dados.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param prefixo Início do título a ser buscado. A comparação ignora maiúsculas e espaços extras.
+ * @param limite Número máximo de livros exibidos (0 para não limitar).
+ *
+ * @return Número de livros exibidos, ou -1 se o índice de títulos não estiver aberto.
+ */
+int searchByTitlePrefix(Library *library, const char *prefixo, int limite)
+{
+    if (library->titleIndex.file == NULL || !prefixo)
+    {
+        fprintf(stderr, "Erro: índice de títulos não está aberto.\n");
+        return -1;
+    }
+
+    int count;
+    int *positions = titleIndexSearch(&library->titleIndex, prefixo, 1, limite, &count);
+    Book livro;
+
+    for (int i = 0; i < count; i++)
+    {
+        for (int j = i == 0 ? 1 : i + STORAGE_PREFETCH_DEPTH; j <= i + STORAGE_PREFETCH_DEPTH && j < count; j++)
+        {
+            prefetchBookAt(library->dataFile, positions[j]);
+        }
+
+        if (readBookAt(library->dataFile, positions[i], &livro) == 0)
+        {
+            printf("| %-6d | %-35.35s | %-30.30s |\n", livro.code, livro.title, livro.author);
+        }
+    }
+
+    free(positions);
+
+    return count;
+}
+
 /**
  * @brief Imprime os dados de um livro com base em seu código.
  *
  * @details Esta função utiliza o código do livro fornecido para procurar a posição (offset) do livro no arquivo de dados.
  *          Se o livro for encontrado, seus dados são impressos no console. Caso contrário, uma mensagem indicando que o livro não foi encontrado é exibida.
  *
- * @param arquivo Ponteiro para o arquivo onde os livros estão armazenados. O arquivo deve estar aberto no modo de leitura.
+ * @param library Ponteiro para o handle da biblioteca aberta.
  * @param codigo O código do livro a ser pesquisado. Deve ser um valor inteiro que identifique unicamente o livro.
  *
  * @pre O arquivo deve estar aberto e acessível. O ponteiro de arquivo deve ser válido e o arquivo deve estar posicionado no início dos dados dos livros.
@@ -498,21 +1794,22 @@ void searchByTitle(FILE *filename, const char *titulo)
  *
  * @post Se o livro com o código especificado for encontrado, seus dados serão impressos no console.
  * @post Se o livro não for encontrado, uma mensagem informando que o livro não foi encontrado será exibida.
- * @post O ponteiro do arquivo será reposicionado para o início dos dados dos livros após a execução da função.
  *
  * @return Nenhum valor é retornado. A função imprime diretamente os dados no console ou uma mensagem de erro.
  */
-void printBookData(FILE *arquivo, int codigo)
+void printBookData(Library *library, int codigo)
 {
+    FILE *arquivo = library->dataFile;
+
     // Verifica se o arquivo está aberto
-    if (!arquivo)
+    if (!arquivo || !library->indexFile)
     {
         printf("Erro: arquivo nao esta aberto.\n");
         return;
     }
 
-    // Obtém o offset do livro no arquivo de dados
-    int offset = getBookOffset(arquivo, codigo);
+    // Obtém o offset do livro no arquivo de dados (a busca é feita no arquivo de índices)
+    int offset = getBookOffset(library->indexFile, codigo);
 
     // Verifica se o livro foi encontrado (offset válido)
     if (offset == -1)
@@ -523,61 +1820,52 @@ void printBookData(FILE *arquivo, int codigo)
 
     // Imprime os dados do livro encontrado
     showBookInfo(arquivo, offset);
-
-    // Retorna ao início do arquivo
-    fseek(arquivo, sizeof(BookDataFileHeader), SEEK_SET);
 }
 
 /**
- * @brief Lista todos os livros armazenados no arquivo.
+ * @brief Lista, em ordem de código, os livros com código no intervalo informado.
  *
- * @details Esta função percorre todos os registros de livros no arquivo, a partir da posição logo após o cabeçalho, e imprime os detalhes de cada livro que não está marcado como removido.
- *          A função formata a saída em uma tabela para facilitar a visualização.
+ * @details O intervalo é percorrido com o cursor do índice (`treeRangeBegin`/`treeRangeNextBooks`), que lê os livros
+ *          em lotes. Nenhuma ordenação do arquivo de dados é necessária.
  *
- * @param arquivo Ponteiro para o arquivo onde os livros estão armazenados. O arquivo deve estar aberto no modo de leitura.
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param codigoInicial Menor código do intervalo.
+ * @param codigoFinal Maior código do intervalo.
  *
- * @pre O arquivo deve estar aberto e acessível. O ponteiro de arquivo deve ser válido e o arquivo deve estar posicionado no início dos dados dos livros.
- *
- * @post A lista de livros é impressa no console em formato tabular.
- * @post Livros com código marcado como -1 (removidos) não são exibidos.
- * @post O ponteiro do arquivo será reposicionado para o início dos dados dos livros após a execução da função.
+ * @return Número de livros exibidos, ou -1 em caso de erro.
  */
-void listarTodosLivros(FILE *arquivo)
+int listBooksByCodeRange(Library *library, int codigoInicial, int codigoFinal)
 {
-    // Verifica se o arquivo está aberto
-    if (!arquivo)
+    // Verifica se os arquivos estão abertos
+    if (!library->dataFile || !library->indexFile)
     {
         printf("Erro: arquivo não está aberto.\n");
-        return;
+        return -1;
     }
 
-    Book livro;
-
-    // Move o ponteiro do arquivo para o início da lista de livros
-    if (fseek(arquivo, sizeof(BookDataFileHeader), SEEK_SET) != 0)
-    {
-        printf("Erro: falha ao mover ponteiro para o início dos dados dos livros.\n");
-        return;
-    }
+    TreeCursor cursor;
+    Book livros[LIST_BOOKS_BATCH_SIZE];
+    int lidos;
+    int count = 0; // Contador de livros exibidos
 
     // Imprime o cabeçalho da tabela
     printf("--------------------------------------------------------------------------------------------\n");
     printf("| Codigo | Titulo                              | Autor                          | Estoque |\n");
     printf("--------------------------------------------------------------------------------------------\n");
 
-    // Percorre todos os registros de livros
-    int count = 0; // Contador de livros exibidos
-    while (fread(&livro, sizeof(Book), 1, arquivo) == 1)
+    // Percorre o intervalo em ordem de código, um lote de livros por vez
+    treeRangeBegin(&cursor, library->indexFile, codigoInicial, codigoFinal);
+    while ((lidos = treeRangeNextBooks(&cursor, library->dataFile, livros, LIST_BOOKS_BATCH_SIZE)) > 0)
     {
-        // Verifica se o livro está marcado como removido
-        if (livro.code != -1)
+        for (int i = 0; i < lidos; i++)
         {
             // Imprime os detalhes do livro em formato tabular
             printf("| %-6d | %-35.35s | %-30.30s | %-7d |\n",
-                   livro.code, livro.title, livro.author, livro.stock_quantity);
-            count++;
+                   livros[i].code, livros[i].title, livros[i].author, livros[i].stock_quantity);
         }
+        count += lidos;
     }
+    treeRangeEnd(&cursor);
 
     // Se nenhum livro válido for encontrado
     if (count == 0)
@@ -588,91 +1876,249 @@ void listarTodosLivros(FILE *arquivo)
     // Imprime o rodapé da tabela
     printf("--------------------------------------------------------------------------------------------\n");
 
-    // Retorna ao início do arquivo
-    if (fseek(arquivo, sizeof(BookDataFileHeader), SEEK_SET) != 0)
-    {
-        printf("Erro: falha ao reposicionar ponteiro ao início dos dados.\n");
-    }
+    return lidos == -1 ? -1 : count;
+}
+
+/**
+ * @brief Lista todos os livros da biblioteca, em ordem de código.
+ *
+ * @details Percorre o índice por completo com `listBooksByCodeRange`. Livros removidos não aparecem, pois não estão
+ *          mais no índice.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ *
+ * @post A lista de livros é impressa no console em formato tabular.
+ */
+void listarTodosLivros(Library *library)
+{
+    listBooksByCodeRange(library, INT_MIN, INT_MAX);
+}
+
+/**
+ * @brief Retorna o total de livros registrados na biblioteca.
+ *
+ * O total é mantido no cabeçalho do arquivo de dados (`bookCount`) e atualizado a cada inserção e remoção, de modo
+ * que a consulta não precisa percorrer a árvore de índices.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ *
+ * @return O número de livros registrados.
+ */
+int calcularTotalLivrosRegistrados(Library *library)
+{
+    return library->dataHeader.bookCount;
 }
 
 /**
- * @brief Calcula o total de livros registrados no arquivo de índices utilizando a árvore 2-3.
+ * @brief Retorna a quantidade total de exemplares em estoque na biblioteca.
+ *
+ * O total é mantido no cabeçalho do arquivo de dados (`stockTotal`) e atualizado a cada inserção, remoção e
+ * alteração de estoque, de modo que a consulta não precisa percorrer o arquivo de dados.
  *
- * Esta função é responsável por calcular o número total de livros registrados na árvore 2-3 armazenada no arquivo de índices.
- * A árvore 2-3 é usada para indexar os registros de dados, onde cada chave na árvore pode representar um livro registrado.
- * O total de livros registrados é determinado contando o número de nós na árvore 2-3, pois cada nó contém informações relacionadas a um livro.
+ * @param library Ponteiro para o handle da biblioteca aberta.
  *
- * A função utiliza a função auxiliar `twoThreeTreeCountNodes`, que percorre toda a árvore 2-3 e conta o número total de nós.
- * Como cada nó da árvore 2-3 representa um livro, o número de nós corresponde ao número de livros registrados no sistema.
+ * @return A soma das quantidades em estoque dos livros registrados.
+ */
+long long calcularTotalLivrosEmEstoque(Library *library)
+{
+    return library->dataHeader.stockTotal;
+}
+
+/**
+ * @brief Calcula o total de livros e de exemplares em estoque com um determinado autor, editora ou ano.
  *
- * @param indexFile Ponteiro para o arquivo de índices. O arquivo contém a árvore 2-3 que armazena as informações de índice.
- *                  A árvore 2-3 é percorrida para calcular o número total de livros registrados.
+ * @details Quando as estatísticas da biblioteca estão abertas (`libraryOpenStats`), o resultado é obtido diretamente
+ *          dos contadores. Sem elas, o total é calculado sobre as colunas (`libraryOpenColumns`), se estiverem
+ *          abertas: o ano é comparado diretamente e o autor e a editora, pelo identificador no dicionário do campo;
+ *          nos demais casos, o arquivo de dados é percorrido em paralelo (`parallelScan`), ignorando os registros
+ *          removidos.
+ *          A comparação ignora maiúsculas e espaços extras.
  *
- * @return O total de livros registrados. Retorna um valor inteiro correspondente ao número de livros registrados na árvore 2-3.
- *         Caso o arquivo não esteja aberto ou um erro seja detectado, a função retorna -1.
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param campo Campo agrupado (`BOOK_STATS_AUTHOR`, `BOOK_STATS_PUBLISHER` ou `BOOK_STATS_YEAR`).
+ * @param valor Valor procurado (nome do autor, da editora ou o ano em texto).
+ * @param estoque Ponteiro onde a soma do estoque será armazenada (pode ser NULL).
  *
- * @note A função espera que o arquivo de índices esteja corretamente aberto e que a árvore 2-3 tenha sido configurada
- *       de acordo com o modelo esperado. Caso contrário, a função irá retornar um valor de erro.
+ * @return O número de livros com o valor informado, ou -1 em caso de erro de leitura.
  */
-int calcularTotalLivrosRegistrados(FILE *indexFile)
+int calcularTotalLivrosPorCampo(Library *library, BookStatsField campo, const char *valor, int *estoque)
 {
-    // Verifica se o arquivo foi aberto corretamente
-    if (!indexFile)
+    int totalLivros = 0;
+    int totalEstoque = 0;
+
+    char *fim;
+    long ano = strtol(valor, &fim, 10);
+
+    if (library->stats.file != NULL)
     {
-        // Caso o arquivo não esteja aberto, imprime mensagem de erro e retorna -1
-        printf("Erro: arquivo de indices nao esta aberto.\n");
-        return -1;
+        bookStatsLookup(&library->stats, campo, valor, &totalLivros, &totalEstoque);
     }
+    else if (campo == BOOK_STATS_YEAR && library->columns.file != NULL && fim != valor)
+    {
+        // Apenas as colunas de ano e de estoque são percorridas
+        totalLivros = columnStoreCountByYear(&library->columns, (int)ano, &totalEstoque);
+    }
+    else if (campo != BOOK_STATS_YEAR && library->columns.file != NULL)
+    {
+        // O valor é procurado uma única vez no dicionário; as linhas comparam apenas identificadores
+        totalLivros = columnStoreCountByValue(&library->columns, campo, valor, &totalEstoque);
+    }
+    else
+    {
+        FieldCountQuery busca = {campo, ""};
+        ParallelScanQuery consulta = {visitFieldCount, mergeFieldCount, sizeof(FieldCount), &busca};
+        FieldCount total = {0, 0};
 
-    // Variável que armazena o total de livros
-    int totalLivros = 0;
+        bookStatsValueKey(valor, busca.key);
+
+        // Sem estatísticas nem colunas abertas, percorre os registros do arquivo de dados
+        if (parallelScan(library->dataFile, library->dataHeader.firstEmptyPosition, &consulta, &total) != 0)
+        {
+            return -1;
+        }
+
+        totalLivros = total.books;
+        totalEstoque = total.stock;
+    }
 
-    // A árvore 2-3 deve ser percorrida e cada chave representa um livro.
-    // A função twoThreeTreeCountNodes conta o número de nós na árvore,
-    // e cada nó da árvore representa um livro registrado.
-    totalLivros = twoThreeTreeCountNodes(indexFile);
+    if (estoque != NULL)
+    {
+        *estoque = totalEstoque;
+    }
 
-    // Retorna o total de livros registrados
     return totalLivros;
 }
 
 /**
- * @brief Soma a quantidade total de livros em estoque no arquivo de dados, ignorando registros deletados.
+ * @brief Exibe os contadores com livros de uma tabela de estatísticas.
+ *
+ * @return O número de contadores exibidos.
+ */
+static int printStatsTable(const BookStatsTable *tabela)
+{
+    int exibidos = 0;
+
+    for (int i = 0; i < tabela->capacity; i++)
+    {
+        const BookStatsEntry *entrada = &tabela->entries[i];
+
+        if (entrada->key[0] != '\0' && entrada->books > 0)
+        {
+            printf("%s: %d livro(s), %d exemplar(es) em estoque\n", entrada->key, entrada->books, entrada->stock);
+            exibidos++;
+        }
+    }
+
+    return exibidos;
+}
+
+/**
+ * @brief Exibe o total de livros e de exemplares em estoque de cada autor ou de cada editora.
  *
- * Esta função percorre o arquivo de dados, começando após o cabeçalho, e soma as quantidades de estoque
- * dos livros cujos códigos não são -1 (indicando que o livro não foi deletado). Para cada livro válido,
- * a quantidade de estoque é somada.
+ * @details Com as colunas abertas (`libraryOpenColumns`), os livros são agrupados pelo identificador do valor no
+ *          dicionário do campo, em uma única passagem pela coluna de identificadores. Caso contrário, são exibidos
+ *          os contadores das estatísticas (`libraryOpenStats`) ou, sem elas, os contadores obtidos percorrendo o
+ *          arquivo de dados em paralelo (`parallelScan`). Os valores são exibidos normalizados.
  *
- * @param dataFile Ponteiro para o arquivo de dados, que contém os registros dos livros.
- * @param headerSize Tamanho do cabeçalho no arquivo de dados (em bytes), que será pulado.
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param campo Campo agrupado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
  *
- * @return A soma das quantidades de livros em estoque. Se ocorrer algum erro, a função retorna -1.
+ * @return O número de valores exibidos, ou -1 em caso de erro de leitura ou de memória.
  */
-int calcularTotalLivrosEmEstoque(FILE *dataFile, size_t headerSize)
+int listarTotaisPorCampo(Library *library, BookStatsField campo)
 {
-    // Verifica se o arquivo foi aberto corretamente
-    if (!dataFile)
+    int exibidos = 0;
+
+    if (library->columns.file != NULL)
     {
-        printf("Erro: arquivo de dados nao esta aberto.\n");
-        return -1;
-    }
+        int valores = columnStoreDistinctValues(&library->columns, campo);
+        int *livros = malloc(sizeof(int) * (valores > 0 ? valores : 1));
+        int *estoques = malloc(sizeof(int) * (valores > 0 ? valores : 1));
 
-    int totalEstoque = 0;
-    Book book;
+        if (livros == NULL || estoques == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para agrupar os livros.\n");
+            free(livros);
+            free(estoques);
+            return -1;
+        }
+
+        columnStoreGroupCounts(&library->columns, campo, livros, estoques);
 
-    // Pula o cabeçalho do arquivo de dados
-    fseek(dataFile, headerSize, SEEK_SET);
+        for (int id = 0; id < valores; id++)
+        {
+            // Valores cujos livros foram todos removidos continuam no dicionário
+            if (livros[id] > 0)
+            {
+                printf("%s: %d livro(s), %d exemplar(es) em estoque\n", columnStoreValue(&library->columns, campo, id),
+                       livros[id], estoques[id]);
+                exibidos++;
+            }
+        }
 
-    // Lê o arquivo de dados, um livro por vez, e soma o estoque
-    while (fread(&book, sizeof(Book), 1, dataFile))
+        free(livros);
+        free(estoques);
+    }
+    else if (library->stats.file != NULL)
+    {
+        exibidos = printStatsTable(&library->stats.tables[campo]);
+    }
+    else
     {
-        // Se o código do livro não for -1 (livro não deletado), soma o estoque
-        if (book.code != -1)
+        ParallelScanQuery consulta = {visitFieldGroup, mergeFieldGroup, sizeof(BookStatsTable), &campo};
+        BookStatsTable tabela;
+
+        if (bookStatsTableInit(&tabela) != 0 ||
+            parallelScan(library->dataFile, library->dataHeader.firstEmptyPosition, &consulta, &tabela) != 0)
         {
-            totalEstoque += book.stock_quantity;
+            fprintf(stderr, "Erro ao agrupar os livros.\n");
+            bookStatsTableFree(&tabela);
+            return -1;
         }
+
+        exibidos = printStatsTable(&tabela);
+        bookStatsTableFree(&tabela);
+    }
+
+    return exibidos;
+}
+
+/**
+ * @brief Calcula as estatísticas de preço dos livros registrados.
+ *
+ * @details Com as colunas abertas (`libraryOpenColumns`), apenas as colunas de preço e de estoque são percorridas.
+ *          Caso contrário, o arquivo de dados é percorrido em paralelo (`parallelScan`), ignorando os registros
+ *          removidos.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param stats Ponteiro para as estatísticas a serem preenchidas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+int calcularEstatisticasPreco(Library *library, ColumnStorePriceStats *stats)
+{
+    ParallelScanQuery consulta = {visitPrice, mergePrice, sizeof(PriceScan), NULL};
+    PriceScan total;
+
+    if (library->columns.file != NULL)
+    {
+        columnStorePriceStats(&library->columns, stats);
+        return 0;
+    }
+
+    memset(&total, 0, sizeof(PriceScan));
+
+    // Sem colunas abertas, percorre os registros do arquivo de dados
+    if (parallelScan(library->dataFile, library->dataHeader.firstEmptyPosition, &consulta, &total) != 0)
+    {
+        return -1;
+    }
+
+    if (total.stats.books > 0)
+    {
+        total.stats.averagePrice = total.sum / total.stats.books;
     }
 
-    // Retorna o total de livros em estoque
-    return totalEstoque;
+    *stats = total.stats;
+    return 0;
 }
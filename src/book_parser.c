@@ -0,0 +1,402 @@
+/**
+ * @file book_parser.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o leitor do formato texto de importação de livros.
+ *
+ * Os campos são tratados como intervalos [início, fim) do bloco lido, sem terminador nulo. A busca pelas quebras de
+ * linha e pelos separadores usa `memchr`, que as bibliotecas C implementam com instruções vetoriais; os trechos do
+ * bloco que não são linhas completas são movidos para o início do buffer antes da próxima leitura.
+ *
+ * @see book_parser.h
+ */
+
+#include "book_parser.h"
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Número de campos obrigatórios de uma linha.
+ */
+#define BOOK_PARSER_FIELDS 8
+
+/**
+ * @brief Remove os espaços das extremidades de um campo.
+ */
+static void trimField(const char **start, const char **end)
+{
+    while (*start < *end && isspace((unsigned char)**start))
+    {
+        (*start)++;
+    }
+
+    while (*end > *start && isspace((unsigned char)(*end)[-1]))
+    {
+        (*end)--;
+    }
+}
+
+/**
+ * @brief Copia um campo de texto para o livro, com a normalização de `trimWhitespace`, truncando-o se necessário.
+ */
+static void copyTextField(char *dest, size_t size, const char *start, const char *end)
+{
+    size_t length = 0;
+
+    trimField(&start, &end);
+
+    for (const char *p = start; p < end && length < size - 1; p++)
+    {
+        if (!isspace((unsigned char)*p))
+        {
+            dest[length++] = *p;
+        }
+        else if (!isspace((unsigned char)p[-1]))
+        {
+            dest[length++] = ' '; // Espaços consecutivos viram um único espaço
+        }
+    }
+
+    dest[length] = '\0';
+}
+
+/**
+ * @brief Converte um campo inteiro (com sinal opcional e espaços nas extremidades).
+ *
+ * @param start Início do campo.
+ * @param end Fim do campo (exclusivo).
+ * @param value Ponteiro onde o valor convertido será armazenado.
+ *
+ * @return 0 em caso de sucesso, -1 se o campo estiver vazio, tiver caracteres inválidos ou não couber em um `int`.
+ */
+int bookParseInt(const char *start, const char *end, int *value)
+{
+    long long result = 0;
+    int negative = 0;
+
+    trimField(&start, &end);
+
+    if (start < end && (*start == '-' || *start == '+'))
+    {
+        negative = *start == '-';
+        start++;
+    }
+
+    if (start == end)
+    {
+        return -1;
+    }
+
+    for (; start < end; start++)
+    {
+        if (*start < '0' || *start > '9')
+        {
+            return -1;
+        }
+
+        result = result * 10 + (*start - '0');
+
+        if (result > (long long)INT_MAX + negative)
+        {
+            return -1;
+        }
+    }
+
+    *value = (int)(negative ? -result : result);
+    return 0;
+}
+
+/**
+ * @brief Converte o campo do preço, aceitando vírgula ou ponto como separador decimal.
+ *
+ * @return 0 em caso de sucesso, -1 se o campo estiver vazio ou não for um número.
+ */
+static int parsePriceField(const char *start, const char *end, double *value)
+{
+    char number[64];
+    size_t length = 0;
+    char *parsed;
+
+    trimField(&start, &end);
+
+    if (start == end || end - start >= (long)sizeof(number))
+    {
+        return -1;
+    }
+
+    // Apenas o preço é copiado, para que `strtod` encontre o terminador nulo
+    for (const char *p = start; p < end; p++)
+    {
+        number[length++] = *p == ',' ? '.' : *p;
+    }
+
+    number[length] = '\0';
+    *value = strtod(number, &parsed);
+
+    return parsed == number + length ? 0 : -1;
+}
+
+/**
+ * @brief Converte uma linha do formato texto em um livro.
+ *
+ * @param line Início da linha (não precisa terminar com caractere nulo).
+ * @param length Tamanho da linha, sem a quebra de linha.
+ * @param book Ponteiro para o livro a ser preenchido. Os campos são preenchidos em ordem até o primeiro erro.
+ * @param error Ponteiro onde é armazenada a descrição do erro (pode ser NULL).
+ *
+ * @return 0 se a linha for válida, -1 se estiver mal formada ou tiver estoque negativo.
+ */
+int bookParseLine(const char *line, size_t length, Book *book, const char **error)
+{
+    const char *fields[BOOK_PARSER_FIELDS + 1];
+    const char *end = line + length;
+    const char *message = NULL;
+    int count = 0;
+
+    // Localiza os separadores dos campos obrigatórios; o restante da linha é ignorado
+    fields[count++] = line;
+
+    while (count <= BOOK_PARSER_FIELDS)
+    {
+        const char *separator = memchr(fields[count - 1], ';', end - fields[count - 1]);
+
+        if (separator == NULL)
+        {
+            break;
+        }
+
+        fields[count++] = separator + 1;
+    }
+
+    int complete = count > BOOK_PARSER_FIELDS - 1;
+
+    // Fim de cada campo: o separador seguinte ou o final da linha
+#define FIELD_END(i) ((i) + 1 < count ? fields[(i) + 1] - 1 : end)
+
+    if (count > 0 && bookParseInt(fields[0], FIELD_END(0), &book->code) != 0)
+    {
+        message = "código inválido";
+    }
+    else if (!complete)
+    {
+        message = "campos faltando";
+    }
+    else
+    {
+        copyTextField(book->title, sizeof(book->title), fields[1], FIELD_END(1));
+        copyTextField(book->author, sizeof(book->author), fields[2], FIELD_END(2));
+        copyTextField(book->publisher, sizeof(book->publisher), fields[3], FIELD_END(3));
+
+        if (bookParseInt(fields[4], FIELD_END(4), &book->edition) != 0)
+        {
+            message = "edição inválida";
+        }
+        else if (bookParseInt(fields[5], FIELD_END(5), &book->year) != 0)
+        {
+            message = "ano inválido";
+        }
+        else if (parsePriceField(fields[6], FIELD_END(6), &book->price) != 0)
+        {
+            message = "preço inválido";
+        }
+        else if (bookParseInt(fields[7], FIELD_END(7), &book->stock_quantity) != 0)
+        {
+            message = "estoque inválido";
+        }
+        else if (book->stock_quantity < 0)
+        {
+            message = "estoque negativo";
+        }
+    }
+
+#undef FIELD_END
+
+    if (error != NULL)
+    {
+        *error = message;
+    }
+
+    return message == NULL ? 0 : -1;
+}
+
+/**
+ * @brief Lê o próximo bloco do arquivo para o buffer, preservando o trecho ainda não consumido.
+ *
+ * @return 1 se foram lidos bytes, 0 no final do arquivo, -1 em caso de erro de leitura ou de memória.
+ */
+static int fillBuffer(BookParser *parser)
+{
+    size_t pending = parser->end - parser->start;
+
+    // Move a linha incompleta para o início do buffer
+    if (parser->start > 0)
+    {
+        memmove(parser->buffer, parser->buffer + parser->start, pending);
+        parser->start = 0;
+        parser->end = pending;
+    }
+
+    // Uma linha maior que o buffer faz o buffer crescer
+    if (parser->end == parser->capacity)
+    {
+        char *resized = realloc(parser->buffer, parser->capacity * 2);
+
+        if (resized == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para ler o arquivo texto.\n");
+            return -1;
+        }
+
+        parser->buffer = resized;
+        parser->capacity *= 2;
+    }
+
+    size_t read = fread(parser->buffer + parser->end, 1, parser->capacity - parser->end, parser->file);
+
+    if (read == 0)
+    {
+        if (ferror(parser->file))
+        {
+            perror("Erro ao ler o arquivo texto");
+            return -1;
+        }
+
+        parser->eof = 1;
+        return 0;
+    }
+
+    parser->end += read;
+    return 1;
+}
+
+/**
+ * @brief Abre um arquivo texto de livros para leitura.
+ *
+ * @param parser Ponteiro para o leitor a ser inicializado.
+ * @param filename Nome do arquivo texto.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser aberto ou faltar memória.
+ */
+int bookParserOpen(BookParser *parser, const char *filename)
+{
+    memset(parser, 0, sizeof(BookParser));
+    parser->file = fopen(filename, "rb");
+
+    if (parser->file == NULL)
+    {
+        perror("Erro ao abrir o arquivo texto");
+        return -1;
+    }
+
+    parser->buffer = malloc(BOOK_PARSER_BLOCK_SIZE);
+    parser->capacity = BOOK_PARSER_BLOCK_SIZE;
+
+    if (parser->buffer == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para ler o arquivo texto.\n");
+        bookParserClose(parser);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Lê o próximo livro do arquivo, ignorando as linhas em branco e as mal formadas.
+ *
+ * @param parser Ponteiro para o leitor aberto.
+ * @param book Ponteiro para o livro a ser preenchido (todos os bytes são definidos).
+ *
+ * @return 1 se um livro foi lido, 0 no final do arquivo, -1 em caso de erro de leitura ou de memória.
+ *
+ * @note O número da linha do livro lido fica em `parser->line`.
+ */
+int bookParserNext(BookParser *parser, Book *book)
+{
+    for (;;)
+    {
+        char *start = parser->buffer + parser->start;
+        char *newline = memchr(start, '\n', parser->end - parser->start);
+        char *end;
+
+        if (newline != NULL)
+        {
+            end = newline;
+            parser->start = newline + 1 - parser->buffer;
+        }
+        else if (!parser->eof)
+        {
+            if (fillBuffer(parser) == -1)
+            {
+                return -1;
+            }
+
+            continue;
+        }
+        else if (parser->start < parser->end)
+        {
+            end = parser->buffer + parser->end; // Última linha, sem quebra de linha
+            parser->start = parser->end;
+        }
+        else
+        {
+            return 0;
+        }
+
+        parser->line++;
+
+        if (end > start && end[-1] == '\r')
+        {
+            end--;
+        }
+
+        const char *first = start;
+        const char *last = end;
+
+        trimField(&first, &last);
+
+        if (first == last)
+        {
+            continue; // Linha em branco
+        }
+
+        const char *error;
+
+        memset(book, 0, sizeof(Book));
+
+        if (bookParseLine(start, end - start, book, &error) == 0)
+        {
+            return 1;
+        }
+
+        if (parser->malformed++ < BOOK_PARSER_MAX_REPORTED)
+        {
+            fprintf(stderr, "Aviso: linha %ld ignorada (%s).\n", parser->line, error);
+        }
+    }
+}
+
+/**
+ * @brief Fecha o arquivo e libera o buffer do leitor.
+ *
+ * @param parser Ponteiro para o leitor.
+ */
+void bookParserClose(BookParser *parser)
+{
+    if (parser->malformed > BOOK_PARSER_MAX_REPORTED)
+    {
+        fprintf(stderr, "  ... e mais %ld linhas mal formadas.\n", parser->malformed - BOOK_PARSER_MAX_REPORTED);
+    }
+
+    if (parser->file != NULL)
+    {
+        fclose(parser->file);
+    }
+
+    free(parser->buffer);
+    parser->file = NULL;
+    parser->buffer = NULL;
+}
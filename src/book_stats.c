@@ -0,0 +1,544 @@
+/**
+ * @file book_stats.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa os contadores agregados de livros por autor, por editora e por ano de publicação.
+ *
+ * Cada tabela usa endereçamento aberto com sondagem linear e é dobrada quando fica com metade das entradas
+ * ocupadas. Contadores que chegam a zero permanecem na tabela (não há remoção), mas não são gravados no arquivo.
+ *
+ * @see book_stats.h
+ */
+
+#include "book_stats.h"
+#include "file_manager.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Calcula o hash (FNV-1a) de uma chave já normalizada.
+ */
+static unsigned int hashKey(const char *key)
+{
+    unsigned int hash = 2166136261u;
+
+    for (const char *p = key; *p; p++)
+    {
+        hash ^= (unsigned char)*p;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Procura a entrada de uma chave na tabela.
+ *
+ * @return Índice da entrada com a chave ou, se ela não existir, da entrada livre onde seria inserida.
+ */
+static int findSlot(const BookStatsTable *table, const char *key)
+{
+    int mask = table->capacity - 1;
+    int slot = hashKey(key) & mask;
+
+    while (table->entries[slot].key[0] != '\0' && strcmp(table->entries[slot].key, key) != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Aloca uma tabela vazia com a capacidade informada.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int initTable(BookStatsTable *table, int capacity)
+{
+    table->entries = calloc(capacity, sizeof(BookStatsEntry));
+    table->capacity = table->entries != NULL ? capacity : 0;
+    table->count = 0;
+
+    return table->entries != NULL ? 0 : -1;
+}
+
+/**
+ * @brief Dobra a capacidade da tabela, reposicionando as entradas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int growTable(BookStatsTable *table)
+{
+    BookStatsTable grown;
+
+    if (initTable(&grown, table->capacity * 2) != 0)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < table->capacity; i++)
+    {
+        if (table->entries[i].key[0] != '\0')
+        {
+            grown.entries[findSlot(&grown, table->entries[i].key)] = table->entries[i];
+            grown.count++;
+        }
+    }
+
+    free(table->entries);
+    *table = grown;
+
+    return 0;
+}
+
+/**
+ * @brief Retorna o contador de uma chave, criando-o se necessário.
+ *
+ * @return Ponteiro para o contador, ou NULL em caso de erro de memória.
+ */
+static BookStatsEntry *findOrInsert(BookStatsTable *table, const char *key)
+{
+    int slot = findSlot(table, key);
+
+    if (table->entries[slot].key[0] != '\0')
+    {
+        return &table->entries[slot];
+    }
+
+    // Mantém a tabela com no máximo metade das entradas ocupadas
+    if ((table->count + 1) * 2 > table->capacity)
+    {
+        if (growTable(table) != 0)
+        {
+            return NULL;
+        }
+        slot = findSlot(table, key);
+    }
+
+    strcpy(table->entries[slot].key, key);
+    table->entries[slot].books = 0;
+    table->entries[slot].stock = 0;
+    table->count++;
+
+    return &table->entries[slot];
+}
+
+/**
+ * @brief Normaliza um valor de campo (nome do autor, da editora ou o ano em texto) para ser usado como chave.
+ *
+ * @param value Valor a ser normalizado.
+ * @param key Destino da chave, com pelo menos `BOOK_STATS_KEY_SIZE` bytes.
+ *
+ * @note Valores vazios recebem a chave "-", já que a string vazia marca entradas livres das tabelas.
+ */
+void bookStatsValueKey(const char *value, char *key)
+{
+    normalizeString(value, key, BOOK_STATS_KEY_SIZE);
+
+    if (key[0] == '\0')
+    {
+        strcpy(key, "-");
+    }
+}
+
+/**
+ * @brief Monta a chave de um livro para o campo informado.
+ *
+ * @param book Ponteiro para o livro.
+ * @param field Campo agrupado.
+ * @param key Destino da chave, com pelo menos `BOOK_STATS_KEY_SIZE` bytes.
+ */
+void bookStatsKey(const Book *book, BookStatsField field, char *key)
+{
+    char year[16];
+
+    switch (field)
+    {
+    case BOOK_STATS_AUTHOR:
+        bookStatsValueKey(book->author, key);
+        break;
+    case BOOK_STATS_PUBLISHER:
+        bookStatsValueKey(book->publisher, key);
+        break;
+    default:
+        snprintf(year, sizeof(year), "%d", book->year);
+        bookStatsValueKey(year, key);
+        break;
+    }
+}
+
+/**
+ * @brief Inicializa uma tabela de contadores vazia, sem arquivo associado.
+ *
+ * @param table Ponteiro para a tabela.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int bookStatsTableInit(BookStatsTable *table)
+{
+    return initTable(table, BOOK_STATS_INITIAL_CAPACITY);
+}
+
+/**
+ * @brief Soma livros e exemplares ao contador de uma chave, criando-o se necessário.
+ *
+ * @param table Ponteiro para a tabela inicializada.
+ * @param key Chave já normalizada (com `bookStatsKey` ou `bookStatsValueKey`).
+ * @param books Número de livros a somar.
+ * @param stock Número de exemplares a somar.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int bookStatsTableAdd(BookStatsTable *table, const char *key, int books, int stock)
+{
+    BookStatsEntry *entry = findOrInsert(table, key);
+
+    if (entry == NULL)
+    {
+        return -1;
+    }
+
+    entry->books += books;
+    entry->stock += stock;
+
+    return 0;
+}
+
+/**
+ * @brief Libera as entradas de uma tabela de contadores.
+ *
+ * @param table Ponteiro para a tabela.
+ */
+void bookStatsTableFree(BookStatsTable *table)
+{
+    free(table->entries);
+    table->entries = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+/**
+ * @brief Inicializa as estatísticas sem arquivo, com as tabelas vazias.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int initStats(BookStats *stats)
+{
+    stats->file = NULL;
+    stats->dirty = 0;
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        stats->tables[field].entries = NULL;
+    }
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        if (initTable(&stats->tables[field], BOOK_STATS_INITIAL_CAPACITY) != 0)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para as estatísticas.\n");
+            bookStatsClose(stats);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Cria um novo arquivo de estatísticas vazio.
+ *
+ * @pre `stats` e `filename` não devem ser NULL.
+ *
+ * @post O arquivo é criado (ou truncado) e as tabelas de contadores estão vazias em memória.
+ *
+ * @param stats Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo de estatísticas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int bookStatsCreate(BookStats *stats, const char *filename)
+{
+    if (initStats(stats) != 0)
+    {
+        return -1;
+    }
+
+    stats->file = openFile(filename, "w+b");
+
+    if (stats->file == NULL)
+    {
+        bookStatsClose(stats);
+        return -1;
+    }
+
+    // Grava o cabeçalho vazio para que o arquivo já tenha o formato completo
+    stats->dirty = 1;
+    return bookStatsFlush(stats);
+}
+
+/**
+ * @brief Abre um arquivo de estatísticas existente, carregando os contadores para a memória.
+ *
+ * @pre `stats` e `filename` não devem ser NULL.
+ *
+ * @param stats Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo de estatísticas.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser lido ou estiver inconsistente.
+ */
+int bookStatsOpen(BookStats *stats, const char *filename)
+{
+    BookStatsHeader header;
+    BookStatsEntry entry;
+    int valid = 1;
+
+    if (initStats(stats) != 0)
+    {
+        return -1;
+    }
+
+    stats->file = openFile(filename, "r+b");
+
+    if (stats->file == NULL)
+    {
+        bookStatsClose(stats);
+        return -1;
+    }
+
+    if (fseek(stats->file, 0, SEEK_SET) != 0 || fread(&header, sizeof(BookStatsHeader), 1, stats->file) != 1)
+    {
+        valid = 0;
+    }
+
+    // Os contadores de cada campo estão gravados em sequência, na ordem de `BookStatsField`
+    for (int field = 0; valid && field < BOOK_STATS_FIELDS; field++)
+    {
+        for (int i = 0; valid && i < header.counts[field]; i++)
+        {
+            if (fread(&entry, sizeof(BookStatsEntry), 1, stats->file) != 1 || entry.books <= 0 ||
+                entry.key[0] == '\0' || memchr(entry.key, '\0', sizeof(entry.key)) == NULL)
+            {
+                valid = 0;
+            }
+            else if (bookStatsTableAdd(&stats->tables[field], entry.key, entry.books, entry.stock) != 0)
+            {
+                fprintf(stderr, "Erro: memória insuficiente para as estatísticas.\n");
+                bookStatsClose(stats);
+                return -1;
+            }
+        }
+    }
+
+    if (!valid)
+    {
+        fprintf(stderr, "Erro: o arquivo de estatísticas '%s' está inconsistente.\n", filename);
+        bookStatsClose(stats);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Contabiliza um livro inserido.
+ *
+ * @param stats Ponteiro para as estatísticas abertas.
+ * @param book Ponteiro para o livro inserido.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int bookStatsAddBook(BookStats *stats, const Book *book)
+{
+    char key[BOOK_STATS_KEY_SIZE];
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        bookStatsKey(book, field, key);
+
+        BookStatsEntry *entry = findOrInsert(&stats->tables[field], key);
+
+        if (entry == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para as estatísticas.\n");
+            return -1;
+        }
+
+        entry->books++;
+        entry->stock += book->stock_quantity;
+    }
+
+    stats->dirty = 1;
+    return 0;
+}
+
+/**
+ * @brief Desconta um livro removido.
+ *
+ * @param stats Ponteiro para as estatísticas abertas.
+ * @param book Ponteiro para o livro removido (como estava gravado no arquivo de dados).
+ */
+void bookStatsRemoveBook(BookStats *stats, const Book *book)
+{
+    char key[BOOK_STATS_KEY_SIZE];
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        BookStatsTable *table = &stats->tables[field];
+
+        bookStatsKey(book, field, key);
+
+        int slot = findSlot(table, key);
+
+        if (table->entries[slot].key[0] != '\0')
+        {
+            table->entries[slot].books--;
+            table->entries[slot].stock -= book->stock_quantity;
+        }
+    }
+
+    stats->dirty = 1;
+}
+
+/**
+ * @brief Registra a alteração do estoque de um livro.
+ *
+ * @param stats Ponteiro para as estatísticas abertas.
+ * @param book Ponteiro para o livro.
+ * @param delta Variação da quantidade em estoque (negativa para saídas).
+ */
+void bookStatsAdjustStock(BookStats *stats, const Book *book, int delta)
+{
+    char key[BOOK_STATS_KEY_SIZE];
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        BookStatsTable *table = &stats->tables[field];
+
+        bookStatsKey(book, field, key);
+
+        int slot = findSlot(table, key);
+
+        if (table->entries[slot].key[0] != '\0')
+        {
+            table->entries[slot].stock += delta;
+        }
+    }
+
+    stats->dirty = 1;
+}
+
+/**
+ * @brief Consulta o contador de um valor de campo.
+ *
+ * @param stats Ponteiro para as estatísticas abertas.
+ * @param field Campo agrupado.
+ * @param value Valor procurado (nome do autor, da editora ou o ano em texto). É normalizado antes da consulta.
+ * @param books Ponteiro onde o número de livros será armazenado.
+ * @param stock Ponteiro onde a soma do estoque será armazenada.
+ *
+ * @note Valores sem livros registrados produzem 0 em `books` e `stock`.
+ */
+void bookStatsLookup(const BookStats *stats, BookStatsField field, const char *value, int *books, int *stock)
+{
+    const BookStatsTable *table = &stats->tables[field];
+    char key[BOOK_STATS_KEY_SIZE];
+
+    bookStatsValueKey(value, key);
+
+    int slot = findSlot(table, key);
+
+    *books = table->entries[slot].key[0] != '\0' ? table->entries[slot].books : 0;
+    *stock = table->entries[slot].key[0] != '\0' ? table->entries[slot].stock : 0;
+}
+
+/**
+ * @brief Grava os contadores no arquivo, se tiverem sido alterados.
+ *
+ * O arquivo contém o cabeçalho seguido dos contadores não nulos de cada campo, na ordem de `BookStatsField`.
+ *
+ * @param stats Ponteiro para as estatísticas.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int bookStatsFlush(BookStats *stats)
+{
+    BookStatsHeader header;
+
+    if (stats->file == NULL || !stats->dirty)
+    {
+        return 0;
+    }
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        header.counts[field] = 0;
+
+        for (int i = 0; i < stats->tables[field].capacity; i++)
+        {
+            if (stats->tables[field].entries[i].books > 0)
+            {
+                header.counts[field]++;
+            }
+        }
+    }
+
+    if (fseek(stats->file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(BookStatsHeader), 1, stats->file) != 1)
+    {
+        perror("Erro ao gravar o cabeçalho das estatísticas");
+        return -1;
+    }
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        for (int i = 0; i < stats->tables[field].capacity; i++)
+        {
+            const BookStatsEntry *entry = &stats->tables[field].entries[i];
+
+            if (entry->books > 0 && fwrite(entry, sizeof(BookStatsEntry), 1, stats->file) != 1)
+            {
+                perror("Erro ao gravar os contadores das estatísticas");
+                return -1;
+            }
+        }
+    }
+
+    fflush(stats->file);
+    stats->dirty = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Grava os contadores, fecha o arquivo e libera as tabelas.
+ *
+ * @param stats Ponteiro para as estatísticas.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ *
+ * @post `stats->file` é definido como NULL.
+ */
+int bookStatsClose(BookStats *stats)
+{
+    int result = 0;
+
+    if (stats->file != NULL)
+    {
+        result = bookStatsFlush(stats);
+
+        if (closeFile(&stats->file) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        bookStatsTableFree(&stats->tables[field]);
+    }
+
+    return result;
+}
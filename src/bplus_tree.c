@@ -0,0 +1,690 @@
+/**
+ * @file bplus_tree.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o modo B+ do arquivo de índices.
+ *
+ * A inserção desce até a folha e, quando um nó ultrapassa `ordem - 1` chaves, ele é dividido ao meio. Na divisão de
+ * uma folha a primeira chave da nova folha é copiada para o pai; na divisão de um nó interno a chave do meio sobe.
+ *
+ * @see bplus_tree.h
+ */
+
+#include "bplus_tree.h"
+#include "file_manager.h"
+#include "storage.h"
+#include "io_stats.h"
+#include "key_search.h"
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Grava um nó da árvore B+ no arquivo de índices.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de gravação.
+ */
+static int saveBPlusNode(FILE *indexFile, int address, const BPlusNode *node)
+{
+    if (IO_STATS_WRITE(IO_STATS_NODE_WRITE, indexFile, address, node, sizeof(BPlusNode)) != 0)
+    {
+        perror("Erro ao gravar nó da árvore B+");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Aloca uma página do arquivo de índices, de preferência perto da página de referência.
+ *
+ * @return Endereço da página alocada, ou -1 em caso de erro.
+ */
+static int allocatePage(FILE *indexFile, IndexFileHeader *header, int hint)
+{
+    return allocateIndexNode(indexFile, header, hint);
+}
+
+/**
+ * @brief Reserva uma nova página no final do arquivo de índices (usada apenas pela construção em lote).
+ *
+ * @return Endereço da página reservada.
+ */
+static int appendPage(IndexFileHeader *header)
+{
+    int address = header->firstEmptyPosition;
+
+    header->firstEmptyPosition += BPLUS_PAGE_SIZE;
+
+    return address;
+}
+
+/**
+ * @brief Inicializa um nó vazio.
+ */
+static void clearBPlusNode(BPlusNode *node, int isLeaf)
+{
+    memset(node, 0, sizeof(BPlusNode));
+    node->isLeaf = isLeaf;
+    node->next = -1;
+}
+
+/**
+ * @brief Retorna o número de chaves do nó menores que `key` (veja `keySearchLowerBound`).
+ */
+static int lowerBound(const BPlusNode *node, int key)
+{
+    return keySearchLowerBound(node->keys, node->nKeys, key);
+}
+
+/**
+ * @brief Retorna o índice do filho de um nó interno que cobre `key`.
+ */
+static int childIndex(const BPlusNode *node, int key)
+{
+    int i = lowerBound(node, key);
+
+    // Chaves iguais ao separador ficam no filho da direita
+    if (i < node->nKeys && node->keys[i] == key)
+    {
+        i++;
+    }
+
+    return i;
+}
+
+/**
+ * @brief Carrega um nó da árvore B+ do arquivo de índices.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param address Endereço (deslocamento) do nó.
+ * @param node Ponteiro onde o nó lido será armazenado.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+int bplusTreeLoadNode(FILE *indexFile, int address, BPlusNode *node)
+{
+    if (IO_STATS_READ(IO_STATS_NODE_READ, indexFile, address, node, sizeof(BPlusNode)) != 0)
+    {
+        fprintf(stderr, "Erro ao ler o nó %d da árvore B+.\n", address);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Carrega um nó visitado na descida de uma busca.
+ *
+ * Em arquivos mapeados, os nós são copiados apenas até as chaves e os valores em uso (o restante da estrutura fica
+ * indefinido), o que evita copiar a página inteira em cada nível. As folhas que serão alteradas e gravadas por quem
+ * chama (`wholeLeaf`) são carregadas por completo, assim como os nós de arquivos não mapeados, em que uma única
+ * leitura é mais barata que várias.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+static int loadRoutingNode(FILE *indexFile, int address, BPlusNode *node, int wholeLeaf)
+{
+    if (!storageIsMapped(indexFile))
+    {
+        return bplusTreeLoadNode(indexFile, address, node);
+    }
+
+    if (IO_STATS_READ(IO_STATS_NODE_READ, indexFile, address, node, offsetof(BPlusNode, keys)) != 0)
+    {
+        fprintf(stderr, "Erro ao ler o nó %d da árvore B+.\n", address);
+        return -1;
+    }
+
+    int failed;
+
+    if ((wholeLeaf && node->isLeaf) || node->nKeys < 0 || node->nKeys >= BPLUS_MAX_ORDER)
+    {
+        failed = storageRead(indexFile, address + offsetof(BPlusNode, keys), node->keys,
+                             sizeof(BPlusNode) - offsetof(BPlusNode, keys));
+    }
+    else
+    {
+        failed = storageRead(indexFile, address + offsetof(BPlusNode, keys), node->keys, sizeof(int) * node->nKeys) ||
+                 storageRead(indexFile, address + offsetof(BPlusNode, values), node->values,
+                             sizeof(int) * (node->nKeys + 1));
+    }
+
+    if (failed)
+    {
+        fprintf(stderr, "Erro ao ler o nó %d da árvore B+.\n", address);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Localiza a folha de uma chave (veja `bplusTreeFindLeaf`), carregando a folha por completo se `wholeLeaf`.
+ */
+static int findLeaf(FILE *indexFile, const IndexFileHeader *header, int key, BPlusNode *leaf, int wholeLeaf)
+{
+    int address = header->rootAddress;
+    int level = 0;
+
+    while (address != -1)
+    {
+        IO_STATS_LEVEL(level++);
+
+        if (loadRoutingNode(indexFile, address, leaf, wholeLeaf) != 0)
+        {
+            return -1;
+        }
+
+        if (leaf->isLeaf)
+        {
+            return address;
+        }
+
+        address = leaf->values[childIndex(leaf, key)];
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Localiza a folha onde uma chave está (ou estaria) armazenada.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ * @param key Chave de referência.
+ * @param leaf Ponteiro onde a folha encontrada será armazenada.
+ *
+ * @return Endereço da folha, ou -1 se a árvore estiver vazia ou ocorrer erro de leitura.
+ *
+ * @note A partir da folha retornada, as chaves maiores podem ser percorridas em ordem seguindo o campo `next`.
+ */
+int bplusTreeFindLeaf(FILE *indexFile, const IndexFileHeader *header, int key, BPlusNode *leaf)
+{
+    return findLeaf(indexFile, header, key, leaf, 1);
+}
+
+/**
+ * @brief Busca uma chave na árvore B+.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ * @param key Chave a ser buscada.
+ *
+ * @return Posição do livro associado à chave, ou -1 se a chave não for encontrada.
+ */
+int bplusTreeSearch(FILE *indexFile, const IndexFileHeader *header, int key)
+{
+    BPlusNode leaf;
+
+    // A folha é apenas consultada: basta copiar as chaves e as posições em uso
+    if (findLeaf(indexFile, header, key, &leaf, 0) == -1)
+    {
+        return -1;
+    }
+
+    int i = lowerBound(&leaf, key);
+
+    if (i < leaf.nKeys && leaf.keys[i] == key)
+    {
+        return leaf.values[i];
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Busca um trecho ordenado das chaves de um lote na subárvore com raiz em `address`.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+static int searchManyRec(FILE *indexFile, int address, const int *keys, int n, int *positions)
+{
+    BPlusNode node;
+
+    if (loadRoutingNode(indexFile, address, &node, 0) != 0)
+    {
+        return -1;
+    }
+
+    if (node.isLeaf)
+    {
+        // As chaves do lote e as da folha estão ordenadas: uma única passada sobre as duas sequências
+        for (int i = 0, j = 0; i < n; i++)
+        {
+            while (j < node.nKeys && node.keys[j] < keys[i])
+            {
+                j++;
+            }
+
+            positions[i] = j < node.nKeys && node.keys[j] == keys[i] ? node.values[j] : -1;
+        }
+
+        return 0;
+    }
+
+    // Antecipa a leitura dos filhos que serão visitados, quando houver mais de um
+    if (childIndex(&node, keys[0]) != childIndex(&node, keys[n - 1]))
+    {
+        for (int start = 0; start < n;)
+        {
+            int child = childIndex(&node, keys[start]);
+
+            storagePrefetch(indexFile, node.values[child], sizeof(BPlusNode));
+
+            while (start < n && (child == node.nKeys || keys[start] < node.keys[child]))
+            {
+                start++;
+            }
+        }
+    }
+
+    for (int start = 0; start < n;)
+    {
+        int child = childIndex(&node, keys[start]);
+        int end = start + 1;
+
+        // O filho recebe todas as chaves menores que o seu separador direito (o último filho recebe as restantes)
+        while (end < n && (child == node.nKeys || keys[end] < node.keys[child]))
+        {
+            end++;
+        }
+
+        if (searchManyRec(indexFile, node.values[child], keys + start, end - start, positions + start) != 0)
+        {
+            return -1;
+        }
+
+        start = end;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Busca um lote de chaves, em ordem crescente, na árvore B+.
+ *
+ * As chaves são distribuídas entre os filhos de cada nó interno visitado, de modo que cada nó é lido uma única vez
+ * para todas as chaves do lote que passam por ele, e cada folha é percorrida junto com as chaves que lhe cabem.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ * @param keys Chaves a serem buscadas, em ordem crescente (podem se repetir).
+ * @param n Número de chaves.
+ * @param positions Vetor que recebe, na ordem de `keys`, a posição do livro de cada chave (-1 se não encontrada).
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+int bplusTreeSearchMany(FILE *indexFile, const IndexFileHeader *header, const int *keys, int n, int *positions)
+{
+    if (header->rootAddress == -1)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            positions[i] = -1;
+        }
+
+        return 0;
+    }
+
+    return n > 0 ? searchManyRec(indexFile, header->rootAddress, keys, n, positions) : 0;
+}
+
+/**
+ * @brief Insere recursivamente uma chave na subárvore com raiz em `address`.
+ *
+ * @param promotedKey Chave que deve ser inserida no pai quando o nó é dividido.
+ * @param newNode Endereço do novo nó criado à direita quando o nó é dividido.
+ *
+ * @return 0 se a subárvore absorveu a chave, 1 se o nó foi dividido, -1 se a chave já existe ou em caso de erro.
+ */
+static int insertRec(FILE *indexFile, int address, int key, int bookPosition, IndexFileHeader *header,
+                     int *promotedKey, int *newNode)
+{
+    BPlusNode node;
+    BPlusNode right;
+
+    if (bplusTreeLoadNode(indexFile, address, &node) != 0)
+    {
+        return -1;
+    }
+
+    if (node.isLeaf)
+    {
+        int i = lowerBound(&node, key);
+
+        if (i < node.nKeys && node.keys[i] == key)
+        {
+            return -1; // Chave duplicada
+        }
+
+        memmove(&node.keys[i + 1], &node.keys[i], sizeof(int) * (node.nKeys - i));
+        memmove(&node.values[i + 1], &node.values[i], sizeof(int) * (node.nKeys - i));
+        node.keys[i] = key;
+        node.values[i] = bookPosition;
+        node.nKeys++;
+
+        if (node.nKeys < header->order)
+        {
+            return saveBPlusNode(indexFile, address, &node);
+        }
+
+        // Divide a folha ao meio e copia a primeira chave da nova folha para o pai
+        int keep = node.nKeys / 2;
+
+        clearBPlusNode(&right, 1);
+        right.nKeys = node.nKeys - keep;
+        memcpy(right.keys, &node.keys[keep], sizeof(int) * right.nKeys);
+        memcpy(right.values, &node.values[keep], sizeof(int) * right.nKeys);
+        right.next = node.next;
+
+        *newNode = allocatePage(indexFile, header, address);
+        node.nKeys = keep;
+        node.next = *newNode;
+        *promotedKey = right.keys[0];
+    }
+    else
+    {
+        int i = childIndex(&node, key);
+        int childKey;
+        int childNode;
+        int result = insertRec(indexFile, node.values[i], key, bookPosition, header, &childKey, &childNode);
+
+        if (result != 1)
+        {
+            return result;
+        }
+
+        // O filho foi dividido: insere o separador e o novo filho à direita dele
+        memmove(&node.keys[i + 1], &node.keys[i], sizeof(int) * (node.nKeys - i));
+        memmove(&node.values[i + 2], &node.values[i + 1], sizeof(int) * (node.nKeys - i));
+        node.keys[i] = childKey;
+        node.values[i + 1] = childNode;
+        node.nKeys++;
+
+        if (node.nKeys < header->order)
+        {
+            return saveBPlusNode(indexFile, address, &node);
+        }
+
+        // Divide o nó interno: a chave do meio sobe para o pai
+        int mid = node.nKeys / 2;
+
+        clearBPlusNode(&right, 0);
+        right.nKeys = node.nKeys - mid - 1;
+        memcpy(right.keys, &node.keys[mid + 1], sizeof(int) * right.nKeys);
+        memcpy(right.values, &node.values[mid + 1], sizeof(int) * (right.nKeys + 1));
+
+        *newNode = allocatePage(indexFile, header, address);
+        *promotedKey = node.keys[mid];
+        node.nKeys = mid;
+    }
+
+    if (*newNode == -1 || saveBPlusNode(indexFile, address, &node) != 0 || saveBPlusNode(indexFile, *newNode, &right) != 0)
+    {
+        return -1;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Insere uma chave e a posição do livro associado na árvore B+.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param key Chave a ser inserida.
+ * @param bookPosition Posição do livro no arquivo de dados.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices (atualizado quando a raiz muda ou páginas são alocadas).
+ *
+ * @return 0 em caso de sucesso, -1 se a chave já existir ou ocorrer erro de gravação.
+ */
+int bplusTreeInsert(FILE *indexFile, int key, int bookPosition, IndexFileHeader *header)
+{
+    BPlusNode root;
+
+    if (header->rootAddress == -1)
+    {
+        // Árvore vazia: a raiz é uma folha com a única chave
+        clearBPlusNode(&root, 1);
+        root.nKeys = 1;
+        root.keys[0] = key;
+        root.values[0] = bookPosition;
+
+        header->rootAddress = allocatePage(indexFile, header, -1);
+        saveHeader(indexFile, header, sizeof(IndexFileHeader));
+
+        if (header->rootAddress == -1)
+        {
+            return -1;
+        }
+
+        return saveBPlusNode(indexFile, header->rootAddress, &root);
+    }
+
+    int promotedKey;
+    int newNode;
+    IndexFileHeader before = *header;
+    int result = insertRec(indexFile, header->rootAddress, key, bookPosition, header, &promotedKey, &newNode);
+
+    if (result == 1)
+    {
+        // A raiz foi dividida: cria uma nova raiz com os dois nós como filhos
+        clearBPlusNode(&root, 0);
+        root.nKeys = 1;
+        root.keys[0] = promotedKey;
+        root.values[0] = header->rootAddress;
+        root.values[1] = newNode;
+
+        int page = allocatePage(indexFile, header, header->rootAddress);
+
+        if (page == -1)
+        {
+            return -1;
+        }
+
+        header->rootAddress = page;
+        result = saveBPlusNode(indexFile, header->rootAddress, &root);
+    }
+
+    // A raiz ou o alocador (extensão do arquivo, lista de páginas livres) alteraram o cabeçalho
+    if (memcmp(&before, header, sizeof(IndexFileHeader)) != 0)
+    {
+        saveHeader(indexFile, header, sizeof(IndexFileHeader));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Remove uma chave da árvore B+.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param key Chave a ser removida.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ *
+ * @return 0 se a chave foi removida, -1 se não foi encontrada ou em caso de erro.
+ *
+ * @note A remoção é preguiçosa: a chave é retirada da folha, mas folhas com poucas chaves não são redistribuídas nem
+ *       fundidas. As chaves dos nós internos continuam válidas como separadores.
+ */
+int bplusTreeRemove(FILE *indexFile, int key, IndexFileHeader *header)
+{
+    BPlusNode leaf;
+    int address = bplusTreeFindLeaf(indexFile, header, key, &leaf);
+
+    if (address == -1)
+    {
+        return -1;
+    }
+
+    int i = lowerBound(&leaf, key);
+
+    if (i >= leaf.nKeys || leaf.keys[i] != key)
+    {
+        return -1; // Chave não encontrada
+    }
+
+    leaf.nKeys--;
+    memmove(&leaf.keys[i], &leaf.keys[i + 1], sizeof(int) * (leaf.nKeys - i));
+    memmove(&leaf.values[i], &leaf.values[i + 1], sizeof(int) * (leaf.nKeys - i));
+
+    if (saveBPlusNode(indexFile, address, &leaf) != 0)
+    {
+        return -1;
+    }
+
+    // Se a raiz é uma folha e ficou vazia, a árvore passa a ser vazia
+    if (address == header->rootAddress && leaf.nKeys == 0)
+    {
+        header->rootAddress = -1;
+        saveHeader(indexFile, header, sizeof(IndexFileHeader));
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Constrói a árvore B+ de baixo para cima a partir de chaves já ordenadas.
+ *
+ * As folhas são preenchidas por completo e gravadas sequencialmente, seguidas dos níveis internos.
+ *
+ * @pre A árvore deve estar vazia e `keys` deve estar em ordem estritamente crescente.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param keys Vetor de chaves ordenadas.
+ * @param bookPositions Vetor com a posição do livro associada a cada chave.
+ * @param n Número de chaves.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ *
+ * @return O endereço da nova raiz, ou -1 em caso de erro.
+ */
+int bplusTreeBulkBuild(FILE *indexFile, const int *keys, const int *bookPositions, int n, IndexFileHeader *header)
+{
+    if (header->rootAddress != -1 || n <= 0)
+    {
+        fprintf(stderr, "Erro: a construção em lote exige uma árvore B+ vazia.\n");
+        return -1;
+    }
+
+    int maxKeys = header->order - 1;
+    int count = (n + maxKeys - 1) / maxKeys; // Número de nós do nível atual
+    int *addresses = malloc(sizeof(int) * count);
+    int *minKeys = malloc(sizeof(int) * count);
+    BPlusNode *node = malloc(sizeof(BPlusNode));
+    int result = 0;
+
+    if (addresses == NULL || minKeys == NULL || node == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a construção em lote.\n");
+        free(addresses);
+        free(minKeys);
+        free(node);
+        return -1;
+    }
+
+    // Folhas: as chaves são divididas igualmente e cada folha aponta para a seguinte
+    for (int i = 0, first = 0; result == 0 && i < count; i++)
+    {
+        int size = n / count + (i < n % count);
+
+        clearBPlusNode(node, 1);
+        node->nKeys = size;
+        memcpy(node->keys, &keys[first], sizeof(int) * size);
+        memcpy(node->values, &bookPositions[first], sizeof(int) * size);
+
+        addresses[i] = appendPage(header);
+        minKeys[i] = keys[first];
+        node->next = (i + 1 < count) ? header->firstEmptyPosition : -1;
+
+        if (IO_STATS_WRITE(IO_STATS_NODE_WRITE, indexFile, addresses[i], node, sizeof(BPlusNode)) != 0)
+        {
+            perror("Erro ao gravar folha da árvore B+");
+            result = -1;
+        }
+
+        first += size;
+    }
+
+    // Níveis internos: os nós do nível anterior são agrupados igualmente, até restar apenas a raiz
+    while (result == 0 && count > 1)
+    {
+        int parents = (count + header->order - 1) / header->order;
+
+        for (int i = 0, first = 0; result == 0 && i < parents; i++)
+        {
+            int size = count / parents + (i < count % parents);
+
+            clearBPlusNode(node, 0);
+            node->nKeys = size - 1;
+            for (int j = 0; j < size; j++)
+            {
+                node->values[j] = addresses[first + j];
+                if (j > 0)
+                {
+                    node->keys[j - 1] = minKeys[first + j];
+                }
+            }
+
+            // O vetor é reaproveitado: o nó pai ocupa a posição i, que já foi consumida
+            int minKey = minKeys[first];
+            addresses[i] = appendPage(header);
+            minKeys[i] = minKey;
+
+            if (IO_STATS_WRITE(IO_STATS_NODE_WRITE, indexFile, addresses[i], node, sizeof(BPlusNode)) != 0)
+            {
+                perror("Erro ao gravar nó da árvore B+");
+                result = -1;
+            }
+
+            first += size;
+        }
+
+        count = parents;
+    }
+
+    if (result == 0)
+    {
+        header->rootAddress = addresses[0];
+        result = header->rootAddress;
+    }
+
+    saveHeader(indexFile, header, sizeof(IndexFileHeader));
+
+    free(addresses);
+    free(minKeys);
+    free(node);
+
+    return result;
+}
+
+/**
+ * @brief Conta as chaves armazenadas na árvore B+, percorrendo o encadeamento das folhas.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ *
+ * @return Número de chaves, ou -1 em caso de erro de leitura.
+ */
+int bplusTreeCountKeys(FILE *indexFile, const IndexFileHeader *header)
+{
+    BPlusNode leaf;
+    int count = 0;
+
+    // Desce pelo filho mais à esquerda até a primeira folha
+    int address = bplusTreeFindLeaf(indexFile, header, INT_MIN, &leaf);
+
+    while (address != -1)
+    {
+        count += leaf.nKeys;
+        address = leaf.next;
+
+        if (address != -1 && bplusTreeLoadNode(indexFile, address, &leaf) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file code_filter.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o filtro de pertinência (filtro de Bloom com contadores) dos códigos de livros.
+ *
+ * As posições dos contadores de um código são obtidas por hash duplo: um único hash de 64 bits do código fornece
+ * a posição inicial (32 bits inferiores) e o passo ímpar (32 bits superiores) entre as posições.
+ *
+ * @see code_filter.h
+ */
+
+#include "code_filter.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Valor máximo de um contador de 4 bits; contadores saturados não são mais alterados.
+ */
+#define CODE_FILTER_MAX_COUNT 15
+
+/**
+ * @brief Mistura os bits do código (finalizador do splitmix64).
+ */
+static uint64_t hashCode(int code)
+{
+    uint64_t x = (uint32_t)code + 0x9E3779B97F4A7C15ULL;
+
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Lê o contador de índice `index`.
+ */
+static int getCounter(const CodeFilter *filter, unsigned long index)
+{
+    return (filter->counters[index >> 1] >> ((index & 1) * 4)) & 0x0F;
+}
+
+/**
+ * @brief Soma `delta` (+1 ou -1) ao contador de índice `index`, exceto se ele estiver saturado.
+ */
+static void updateCounter(CodeFilter *filter, unsigned long index, int delta)
+{
+    int value = getCounter(filter, index);
+    int shift = (index & 1) * 4;
+
+    if (value == CODE_FILTER_MAX_COUNT || (delta < 0 && value == 0))
+    {
+        return;
+    }
+
+    value += delta;
+    filter->counters[index >> 1] = (unsigned char)((filter->counters[index >> 1] & ~(0x0F << shift)) | (value << shift));
+}
+
+/**
+ * @brief Soma `delta` a todos os contadores do código.
+ */
+static void updateCode(CodeFilter *filter, int code, int delta)
+{
+    uint64_t hash = hashCode(code);
+    unsigned long position = (unsigned long)(uint32_t)hash;
+    unsigned long step = (unsigned long)(hash >> 32) | 1;
+
+    for (int i = 0; i < CODE_FILTER_HASHES; i++)
+    {
+        updateCounter(filter, position & filter->mask, delta);
+        position += step;
+    }
+}
+
+/**
+ * @brief Cria um filtro vazio dimensionado para `capacity` códigos.
+ *
+ * @param filter Ponteiro para o filtro.
+ * @param capacity Número de códigos previstos (no mínimo `CODE_FILTER_MIN_CAPACITY`).
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int codeFilterCreate(CodeFilter *filter, long capacity)
+{
+    unsigned long counters = 2;
+
+    if (capacity < CODE_FILTER_MIN_CAPACITY)
+    {
+        capacity = CODE_FILTER_MIN_CAPACITY;
+    }
+
+    // Arredonda o número de contadores para a potência de 2 seguinte
+    while (counters < (unsigned long)capacity * CODE_FILTER_COUNTERS_PER_KEY)
+    {
+        counters <<= 1;
+    }
+
+    filter->counters = calloc(counters / 2, 1);
+    filter->mask = counters - 1;
+    filter->keys = 0;
+    filter->capacity = capacity;
+
+    if (filter->counters == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o filtro de códigos.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Libera a memória do filtro.
+ *
+ * @param filter Ponteiro para o filtro (pode não ter sido criado).
+ */
+void codeFilterDestroy(CodeFilter *filter)
+{
+    free(filter->counters);
+    filter->counters = NULL;
+    filter->keys = 0;
+}
+
+/**
+ * @brief Acrescenta um código ao filtro.
+ *
+ * @param filter Ponteiro para o filtro criado.
+ * @param code Código do livro.
+ */
+void codeFilterAdd(CodeFilter *filter, int code)
+{
+    updateCode(filter, code, 1);
+    filter->keys++;
+}
+
+/**
+ * @brief Retira do filtro um código acrescentado com `codeFilterAdd`.
+ *
+ * @param filter Ponteiro para o filtro criado.
+ * @param code Código do livro.
+ */
+void codeFilterRemove(CodeFilter *filter, int code)
+{
+    updateCode(filter, code, -1);
+
+    if (filter->keys > 0)
+    {
+        filter->keys--;
+    }
+}
+
+/**
+ * @brief Informa se um código pode estar no filtro.
+ *
+ * @param filter Ponteiro para o filtro criado.
+ * @param code Código do livro.
+ *
+ * @return 0 se o código certamente não está no filtro, 1 se pode estar.
+ */
+int codeFilterMayContain(const CodeFilter *filter, int code)
+{
+    uint64_t hash = hashCode(code);
+    unsigned long position = (unsigned long)(uint32_t)hash;
+    unsigned long step = (unsigned long)(hash >> 32) | 1;
+
+    for (int i = 0; i < CODE_FILTER_HASHES; i++)
+    {
+        if (getCounter(filter, position & filter->mask) == 0)
+        {
+            return 0;
+        }
+
+        position += step;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Informa se o filtro tem mais códigos do que a sua capacidade e deve ser reconstruído maior.
+ *
+ * @param filter Ponteiro para o filtro criado.
+ *
+ * @return 1 se o número de códigos excede a capacidade, 0 caso contrário.
+ */
+int codeFilterIsFull(const CodeFilter *filter)
+{
+    return filter->keys > filter->capacity;
+}
@@ -0,0 +1,799 @@
+/**
+ * @file column_store.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o arquivo de colunas com os campos numéricos e os campos codificados por dicionário dos livros.
+ *
+ * @see column_store.h
+ */
+
+#include "column_store.h"
+#include "file_manager.h"
+#include "storage.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Número de posições representadas por palavra do mapa de bits.
+ */
+#define COLUMN_STORE_WORD_BITS 64
+
+/**
+ * @brief Número de colunas de `int` no arquivo, gravadas antes da coluna de preços.
+ */
+#define COLUMN_STORE_INT_COLUMNS 6
+
+/**
+ * @brief Calcula o deslocamento (em bytes) de uma coluna no arquivo.
+ *
+ * @param capacity Capacidade das colunas.
+ * @param column Número da coluna (0 a 6 para as colunas de valores, 7 para o mapa de bits).
+ */
+static long columnPosition(int capacity, int column)
+{
+    long position = sizeof(ColumnStoreHeader);
+
+    // As seis primeiras colunas são de `int` e a sétima, de `double`
+    position += (long)capacity * sizeof(int) * (column < COLUMN_STORE_INT_COLUMNS ? column : COLUMN_STORE_INT_COLUMNS);
+
+    if (column > COLUMN_STORE_INT_COLUMNS)
+    {
+        position += (long)capacity * sizeof(double);
+    }
+
+    return position;
+}
+
+/**
+ * @brief Grava os valores neutros de uma posição removida e a marca no mapa de bits.
+ */
+static void clearRow(ColumnStore *store, int row)
+{
+    store->codes[row] = -1;
+    store->years[row] = COLUMN_STORE_NO_YEAR;
+    store->editions[row] = 0;
+    store->stocks[row] = 0;
+    store->authorIds[row] = -1;
+    store->publisherIds[row] = -1;
+    store->prices[row] = 0.0;
+    store->deleted[row / COLUMN_STORE_WORD_BITS] |= (uint64_t)1 << (row % COLUMN_STORE_WORD_BITS);
+}
+
+/**
+ * @brief Acrescenta uma posição ao intervalo a ser gravado em `columnStoreFlush`.
+ */
+static void markDirty(ColumnStore *store, int row)
+{
+    if (store->dirtyFirst == -1 || row < store->dirtyFirst)
+    {
+        store->dirtyFirst = row;
+    }
+
+    if (row > store->dirtyLast)
+    {
+        store->dirtyLast = row;
+    }
+}
+
+/**
+ * @brief Redimensiona um vetor de coluna, mantendo o vetor original em caso de erro.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int resizeColumn(void **column, size_t size)
+{
+    void *resized = realloc(*column, size);
+
+    if (resized == NULL)
+    {
+        return -1;
+    }
+
+    *column = resized;
+    return 0;
+}
+
+/**
+ * @brief Aumenta a capacidade das colunas para que a posição informada caiba nelas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int growColumns(ColumnStore *store, int row)
+{
+    int capacity = store->header.capacity;
+    int newCapacity = capacity;
+
+    while (row >= newCapacity)
+    {
+        newCapacity *= 2;
+    }
+
+    if (resizeColumn((void **)&store->codes, sizeof(int) * newCapacity) != 0 ||
+        resizeColumn((void **)&store->years, sizeof(int) * newCapacity) != 0 ||
+        resizeColumn((void **)&store->editions, sizeof(int) * newCapacity) != 0 ||
+        resizeColumn((void **)&store->stocks, sizeof(int) * newCapacity) != 0 ||
+        resizeColumn((void **)&store->authorIds, sizeof(int) * newCapacity) != 0 ||
+        resizeColumn((void **)&store->publisherIds, sizeof(int) * newCapacity) != 0 ||
+        resizeColumn((void **)&store->prices, sizeof(double) * newCapacity) != 0 ||
+        resizeColumn((void **)&store->deleted, sizeof(uint64_t) * (newCapacity / COLUMN_STORE_WORD_BITS)) != 0)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o arquivo de colunas.\n");
+        return -1;
+    }
+
+    memset(store->deleted + capacity / COLUMN_STORE_WORD_BITS, 0,
+           sizeof(uint64_t) * ((newCapacity - capacity) / COLUMN_STORE_WORD_BITS));
+
+    for (int i = capacity; i < newCapacity; i++)
+    {
+        clearRow(store, i);
+    }
+
+    // O deslocamento das colunas no arquivo depende da capacidade
+    store->header.capacity = newCapacity;
+    store->layoutDirty = 1;
+
+    return 0;
+}
+
+/**
+ * @brief Grava um trecho de uma coluna no arquivo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int writeColumnSlice(ColumnStore *store, int column, const void *values, size_t valueSize, int first, int count)
+{
+    long position = columnPosition(store->header.capacity, column) + (long)first * valueSize;
+
+    if (fseek(store->file, position, SEEK_SET) != 0 ||
+        fwrite((const char *)values + (size_t)first * valueSize, valueSize, count, store->file) != (size_t)count)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Retorna a coluna de identificadores de um campo codificado por dicionário.
+ */
+static const int *idColumn(const ColumnStore *store, BookStatsField field)
+{
+    return field == BOOK_STATS_AUTHOR ? store->authorIds : store->publisherIds;
+}
+
+/**
+ * @brief Retorna o dicionário de um campo codificado por dicionário.
+ */
+static const StringDictionary *fieldDictionary(const ColumnStore *store, BookStatsField field)
+{
+    return field == BOOK_STATS_AUTHOR ? &store->authors : &store->publishers;
+}
+
+/**
+ * @brief Cria o dicionário de um campo, gravado em `<nome do arquivo de colunas>.<sufixo>`.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int createDictionary(StringDictionary *dictionary, const char *filename, const char *suffix)
+{
+    char dictionaryFilename[FILENAME_MAX];
+
+    snprintf(dictionaryFilename, sizeof(dictionaryFilename), "%s.%s", filename, suffix);
+    return stringDictionaryCreate(dictionary, dictionaryFilename);
+}
+
+/**
+ * @brief Cria um novo arquivo de colunas vazio.
+ *
+ * @pre `store` e `filename` não devem ser NULL.
+ *
+ * @param store Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo de colunas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int columnStoreCreate(ColumnStore *store, const char *filename)
+{
+    int capacity = COLUMN_STORE_INITIAL_CAPACITY;
+
+    memset(store, 0, sizeof(ColumnStore));
+    store->codes = malloc(sizeof(int) * capacity);
+    store->years = malloc(sizeof(int) * capacity);
+    store->editions = malloc(sizeof(int) * capacity);
+    store->stocks = malloc(sizeof(int) * capacity);
+    store->authorIds = malloc(sizeof(int) * capacity);
+    store->publisherIds = malloc(sizeof(int) * capacity);
+    store->prices = malloc(sizeof(double) * capacity);
+    store->deleted = malloc(sizeof(uint64_t) * (capacity / COLUMN_STORE_WORD_BITS));
+
+    if (store->codes == NULL || store->years == NULL || store->editions == NULL || store->stocks == NULL ||
+        store->authorIds == NULL || store->publisherIds == NULL || store->prices == NULL || store->deleted == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o arquivo de colunas.\n");
+        columnStoreClose(store);
+        return -1;
+    }
+
+    store->file = openFile(filename, "w+b");
+
+    if (store->file == NULL || createDictionary(&store->authors, filename, "autores") != 0 ||
+        createDictionary(&store->publishers, filename, "editoras") != 0)
+    {
+        columnStoreClose(store);
+        return -1;
+    }
+
+    store->header.capacity = capacity;
+    columnStoreClear(store);
+
+    // Grava o cabeçalho e as colunas vazias para que o arquivo já tenha o formato completo
+    return columnStoreFlush(store);
+}
+
+/**
+ * @brief Abre o dicionário de um campo, gravado em `<nome do arquivo de colunas>.<sufixo>`.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int openDictionary(StringDictionary *dictionary, const char *filename, const char *suffix)
+{
+    char dictionaryFilename[FILENAME_MAX];
+
+    snprintf(dictionaryFilename, sizeof(dictionaryFilename), "%s.%s", filename, suffix);
+    return stringDictionaryOpen(dictionary, dictionaryFilename);
+}
+
+/**
+ * @brief Lê uma coluna inteira do arquivo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int readColumn(ColumnStore *store, int column, void *values, size_t valueSize, int count)
+{
+    if (fseek(store->file, columnPosition(store->header.capacity, column), SEEK_SET) != 0 ||
+        fread(values, valueSize, count, store->file) != (size_t)count)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Abre um arquivo de colunas existente, carregando as colunas e os dicionários para a memória.
+ *
+ * @pre `store` e `filename` não devem ser NULL.
+ *
+ * @param store Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo de colunas.
+ *
+ * @return 0 em caso de sucesso, -1 se algum arquivo não puder ser lido ou estiver inconsistente.
+ */
+int columnStoreOpen(ColumnStore *store, const char *filename)
+{
+    ColumnStoreHeader header;
+
+    memset(store, 0, sizeof(ColumnStore));
+    store->dirtyFirst = -1;
+    store->dirtyLast = -1;
+    store->file = openFile(filename, "r+b");
+
+    if (store->file == NULL)
+    {
+        return -1;
+    }
+
+    if (fseek(store->file, 0, SEEK_SET) != 0 || fread(&header, sizeof(ColumnStoreHeader), 1, store->file) != 1 ||
+        header.capacity <= 0 || header.capacity % COLUMN_STORE_WORD_BITS != 0 || header.rowCount < 0 ||
+        header.rowCount > header.capacity || storageSize(store->file) < columnPosition(header.capacity, 8))
+    {
+        fprintf(stderr, "Erro: o arquivo de colunas '%s' está inconsistente.\n", filename);
+        columnStoreClose(store);
+        return -1;
+    }
+
+    int capacity = header.capacity;
+
+    store->header = header;
+    store->codes = malloc(sizeof(int) * capacity);
+    store->years = malloc(sizeof(int) * capacity);
+    store->editions = malloc(sizeof(int) * capacity);
+    store->stocks = malloc(sizeof(int) * capacity);
+    store->authorIds = malloc(sizeof(int) * capacity);
+    store->publisherIds = malloc(sizeof(int) * capacity);
+    store->prices = malloc(sizeof(double) * capacity);
+    store->deleted = malloc(sizeof(uint64_t) * (capacity / COLUMN_STORE_WORD_BITS));
+
+    if (store->codes == NULL || store->years == NULL || store->editions == NULL || store->stocks == NULL ||
+        store->authorIds == NULL || store->publisherIds == NULL || store->prices == NULL || store->deleted == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o arquivo de colunas.\n");
+        columnStoreClose(store);
+        return -1;
+    }
+
+    if (readColumn(store, 0, store->codes, sizeof(int), capacity) != 0 ||
+        readColumn(store, 1, store->years, sizeof(int), capacity) != 0 ||
+        readColumn(store, 2, store->editions, sizeof(int), capacity) != 0 ||
+        readColumn(store, 3, store->stocks, sizeof(int), capacity) != 0 ||
+        readColumn(store, 4, store->authorIds, sizeof(int), capacity) != 0 ||
+        readColumn(store, 5, store->publisherIds, sizeof(int), capacity) != 0 ||
+        readColumn(store, 6, store->prices, sizeof(double), capacity) != 0 ||
+        readColumn(store, 7, store->deleted, sizeof(uint64_t), capacity / COLUMN_STORE_WORD_BITS) != 0)
+    {
+        perror("Erro ao ler o arquivo de colunas");
+        columnStoreClose(store);
+        return -1;
+    }
+
+    if (openDictionary(&store->authors, filename, "autores") != 0 ||
+        openDictionary(&store->publishers, filename, "editoras") != 0)
+    {
+        columnStoreClose(store);
+        return -1;
+    }
+
+    // Os identificadores das colunas precisam existir nos dicionários
+    for (int i = 0; i < header.rowCount; i++)
+    {
+        if (store->authorIds[i] >= store->authors.header.count ||
+            store->publisherIds[i] >= store->publishers.header.count)
+        {
+            fprintf(stderr, "Erro: o arquivo de colunas '%s' não corresponde aos seus dicionários.\n", filename);
+            columnStoreClose(store);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Grava os campos de um livro na posição informada.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param position Posição do livro no arquivo de dados.
+ * @param book Ponteiro para o livro.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+int columnStoreSet(ColumnStore *store, int position, const Book *book)
+{
+    char author[BOOK_STATS_KEY_SIZE];
+    char publisher[BOOK_STATS_KEY_SIZE];
+
+    if (position < 0 || (position >= store->header.capacity && growColumns(store, position) != 0))
+    {
+        return -1;
+    }
+
+    bookStatsKey(book, BOOK_STATS_AUTHOR, author);
+    bookStatsKey(book, BOOK_STATS_PUBLISHER, publisher);
+
+    int authorId = stringDictionaryIntern(&store->authors, author);
+    int publisherId = stringDictionaryIntern(&store->publishers, publisher);
+
+    if (authorId == -1 || publisherId == -1)
+    {
+        return -1;
+    }
+
+    store->codes[position] = book->code;
+    store->years[position] = book->year;
+    store->editions[position] = book->edition;
+    store->stocks[position] = book->stock_quantity;
+    store->authorIds[position] = authorId;
+    store->publisherIds[position] = publisherId;
+    store->prices[position] = book->price;
+    store->deleted[position / COLUMN_STORE_WORD_BITS] &= ~((uint64_t)1 << (position % COLUMN_STORE_WORD_BITS));
+
+    if (position >= store->header.rowCount)
+    {
+        store->header.rowCount = position + 1;
+    }
+
+    markDirty(store, position);
+    return 0;
+}
+
+/**
+ * @brief Marca a posição informada como removida.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param position Posição do livro removido no arquivo de dados.
+ */
+void columnStoreDelete(ColumnStore *store, int position)
+{
+    if (position < 0 || position >= store->header.rowCount)
+    {
+        return;
+    }
+
+    clearRow(store, position);
+    markDirty(store, position);
+}
+
+/**
+ * @brief Altera o estoque da posição informada.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param position Posição do livro no arquivo de dados.
+ * @param stock Novo estoque do livro.
+ */
+void columnStoreSetStock(ColumnStore *store, int position, int stock)
+{
+    if (position < 0 || position >= store->header.rowCount)
+    {
+        return;
+    }
+
+    store->stocks[position] = stock;
+    markDirty(store, position);
+}
+
+/**
+ * @brief Altera o preço da posição informada.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param position Posição do livro no arquivo de dados.
+ * @param price Novo preço do livro.
+ */
+void columnStoreSetPrice(ColumnStore *store, int position, double price)
+{
+    if (position < 0 || position >= store->header.rowCount)
+    {
+        return;
+    }
+
+    store->prices[position] = price;
+    markDirty(store, position);
+}
+
+/**
+ * @brief Remove todas as posições, mantendo o arquivo aberto.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ *
+ * @note Os dicionários são mantidos: os identificadores já atribuídos continuam válidos para as novas posições.
+ */
+void columnStoreClear(ColumnStore *store)
+{
+    memset(store->deleted, 0, sizeof(uint64_t) * (store->header.capacity / COLUMN_STORE_WORD_BITS));
+
+    for (int i = 0; i < store->header.capacity; i++)
+    {
+        clearRow(store, i);
+    }
+
+    store->header.rowCount = 0;
+    store->dirtyFirst = -1;
+    store->dirtyLast = -1;
+    store->layoutDirty = 1;
+}
+
+/**
+ * @brief Soma os exemplares em estoque de todos os livros.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ *
+ * @return O total de exemplares em estoque.
+ */
+long columnStoreStockTotal(const ColumnStore *store)
+{
+    const int *stocks = store->stocks;
+    int rows = store->header.rowCount;
+    long total = 0;
+
+    // As posições removidas têm estoque 0: a soma não precisa consultar o mapa de bits
+    for (int i = 0; i < rows; i++)
+    {
+        total += stocks[i];
+    }
+
+    return total;
+}
+
+/**
+ * @brief Conta os livros de um ano de publicação e soma os seus exemplares em estoque.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param year Ano de publicação.
+ * @param stock Ponteiro onde a soma do estoque será armazenada (pode ser NULL).
+ *
+ * @return O número de livros do ano informado.
+ */
+int columnStoreCountByYear(const ColumnStore *store, int year, int *stock)
+{
+    const int *years = store->years;
+    const int *stocks = store->stocks;
+    int rows = store->header.rowCount;
+    int count = 0;
+    int total = 0;
+
+    // Comparação sem desvios; as posições removidas têm um ano que nunca é consultado
+    for (int i = 0; i < rows; i++)
+    {
+        int match = years[i] == year;
+
+        count += match;
+        total += stocks[i] & -match;
+    }
+
+    if (stock != NULL)
+    {
+        *stock = total;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Conta os livros com um autor ou uma editora e soma os seus exemplares em estoque.
+ *
+ * O valor é normalizado e procurado uma única vez no dicionário; a contagem compara apenas identificadores.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param field Campo consultado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ * @param value Valor procurado (a comparação ignora maiúsculas e espaços extras).
+ * @param stock Ponteiro onde a soma do estoque será armazenada (pode ser NULL).
+ *
+ * @return O número de livros com o valor informado.
+ */
+int columnStoreCountByValue(const ColumnStore *store, BookStatsField field, const char *value, int *stock)
+{
+    char key[BOOK_STATS_KEY_SIZE];
+
+    bookStatsValueKey(value, key);
+
+    const int *ids = idColumn(store, field);
+    const int *stocks = store->stocks;
+    int id = stringDictionaryFind(fieldDictionary(store, field), key);
+    int rows = store->header.rowCount;
+    int count = 0;
+    int total = 0;
+
+    // Um valor fora do dicionário não tem livros; as posições removidas têm identificador -1
+    for (int i = 0; id != -1 && i < rows; i++)
+    {
+        int match = ids[i] == id;
+
+        count += match;
+        total += stocks[i] & -match;
+    }
+
+    if (stock != NULL)
+    {
+        *stock = total;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Retorna o número de valores distintos do dicionário de um campo.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param field Campo consultado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ *
+ * @return O número de identificadores atribuídos (inclusive os de valores sem livros no momento).
+ */
+int columnStoreDistinctValues(const ColumnStore *store, BookStatsField field)
+{
+    return fieldDictionary(store, field)->header.count;
+}
+
+/**
+ * @brief Retorna o valor normalizado de um identificador do dicionário de um campo.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param field Campo consultado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ * @param id Identificador (entre 0 e `columnStoreDistinctValues - 1`).
+ *
+ * @return O valor normalizado.
+ */
+const char *columnStoreValue(const ColumnStore *store, BookStatsField field, int id)
+{
+    return stringDictionaryValue(fieldDictionary(store, field), id);
+}
+
+/**
+ * @brief Agrupa os livros por autor ou por editora.
+ *
+ * Os vetores são indexados pelo identificador do valor no dicionário, de modo que o agrupamento percorre as
+ * colunas uma única vez, sem tabela hash nem comparações de strings.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param field Campo agrupado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ * @param books Vetor com `columnStoreDistinctValues` posições que receberá o número de livros de cada valor.
+ * @param stocks Vetor com `columnStoreDistinctValues` posições que receberá o estoque de cada valor.
+ */
+void columnStoreGroupCounts(const ColumnStore *store, BookStatsField field, int *books, int *stocks)
+{
+    const int *ids = idColumn(store, field);
+    int values = columnStoreDistinctValues(store, field);
+
+    memset(books, 0, sizeof(int) * values);
+    memset(stocks, 0, sizeof(int) * values);
+
+    for (int i = 0; i < store->header.rowCount; i++)
+    {
+        int id = ids[i];
+
+        if (id != -1)
+        {
+            books[id]++;
+            stocks[id] += store->stocks[i];
+        }
+    }
+}
+
+/**
+ * @brief Calcula as estatísticas de preço dos livros.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ * @param stats Ponteiro para as estatísticas a serem preenchidas.
+ */
+void columnStorePriceStats(const ColumnStore *store, ColumnStorePriceStats *stats)
+{
+    const double *prices = store->prices;
+    const int *stocks = store->stocks;
+    double sum = 0.0;
+
+    memset(stats, 0, sizeof(ColumnStorePriceStats));
+
+    for (int first = 0; first < store->header.rowCount; first += COLUMN_STORE_WORD_BITS)
+    {
+        uint64_t deleted = store->deleted[first / COLUMN_STORE_WORD_BITS];
+        int last = first + COLUMN_STORE_WORD_BITS;
+
+        if (last > store->header.rowCount)
+        {
+            last = store->header.rowCount;
+        }
+
+        if (deleted == ~(uint64_t)0)
+        {
+            continue; // Nenhum livro neste trecho
+        }
+
+        for (int i = first; i < last; i++)
+        {
+            // Trechos sem remoções (o caso comum) não precisam consultar o mapa de bits
+            if (deleted != 0 && (deleted >> (i - first) & 1))
+            {
+                continue;
+            }
+
+            double price = prices[i];
+
+            if (stats->books == 0 || price < stats->minPrice)
+            {
+                stats->minPrice = price;
+            }
+
+            if (stats->books == 0 || price > stats->maxPrice)
+            {
+                stats->maxPrice = price;
+            }
+
+            sum += price;
+            stats->stockValue += price * stocks[i];
+            stats->books++;
+        }
+    }
+
+    if (stats->books > 0)
+    {
+        stats->averagePrice = sum / stats->books;
+    }
+}
+
+/**
+ * @brief Grava no arquivo as posições alteradas desde a última gravação e os valores novos dos dicionários.
+ *
+ * @param store Ponteiro para o arquivo aberto.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int columnStoreFlush(ColumnStore *store)
+{
+    if (store->file == NULL)
+    {
+        return 0;
+    }
+
+    // Os dicionários são gravados antes das colunas, que podem referenciar os identificadores novos
+    if (stringDictionaryFlush(&store->authors) != 0 || stringDictionaryFlush(&store->publishers) != 0)
+    {
+        return -1;
+    }
+
+    if (!store->layoutDirty && store->dirtyFirst == -1)
+    {
+        return 0;
+    }
+
+    int first = store->dirtyFirst;
+    int count = store->dirtyLast - store->dirtyFirst + 1;
+
+    if (store->layoutDirty)
+    {
+        first = 0;
+        count = store->header.capacity;
+    }
+
+    // O mapa de bits é gravado em palavras inteiras
+    int firstWord = first / COLUMN_STORE_WORD_BITS;
+    int wordCount = (first + count - 1) / COLUMN_STORE_WORD_BITS - firstWord + 1;
+
+    if (fseek(store->file, 0, SEEK_SET) != 0 ||
+        fwrite(&store->header, sizeof(ColumnStoreHeader), 1, store->file) != 1 ||
+        writeColumnSlice(store, 0, store->codes, sizeof(int), first, count) != 0 ||
+        writeColumnSlice(store, 1, store->years, sizeof(int), first, count) != 0 ||
+        writeColumnSlice(store, 2, store->editions, sizeof(int), first, count) != 0 ||
+        writeColumnSlice(store, 3, store->stocks, sizeof(int), first, count) != 0 ||
+        writeColumnSlice(store, 4, store->authorIds, sizeof(int), first, count) != 0 ||
+        writeColumnSlice(store, 5, store->publisherIds, sizeof(int), first, count) != 0 ||
+        writeColumnSlice(store, 6, store->prices, sizeof(double), first, count) != 0 ||
+        writeColumnSlice(store, 7, store->deleted, sizeof(uint64_t), firstWord, wordCount) != 0)
+    {
+        perror("Erro ao gravar o arquivo de colunas");
+        return -1;
+    }
+
+    fflush(store->file);
+    store->dirtyFirst = -1;
+    store->dirtyLast = -1;
+    store->layoutDirty = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Grava as alterações pendentes e fecha o arquivo de colunas.
+ *
+ * @param store Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int columnStoreClose(ColumnStore *store)
+{
+    int result = 0;
+
+    if (store->file != NULL)
+    {
+        result = columnStoreFlush(store);
+
+        if (closeFile(&store->file) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    if (stringDictionaryClose(&store->authors) != 0)
+    {
+        result = -1;
+    }
+
+    if (stringDictionaryClose(&store->publishers) != 0)
+    {
+        result = -1;
+    }
+
+    free(store->codes);
+    free(store->years);
+    free(store->editions);
+    free(store->stocks);
+    free(store->authorIds);
+    free(store->publisherIds);
+    free(store->prices);
+    free(store->deleted);
+    store->codes = store->years = store->editions = store->stocks = NULL;
+    store->authorIds = store->publisherIds = NULL;
+    store->prices = NULL;
+    store->deleted = NULL;
+
+    return result;
+}
@@ -0,0 +1,564 @@
+/**
+ * @file compact_book_file.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o formato compacto do arquivo de livros e a conversão entre ele e o arquivo de dados.
+ *
+ * @see compact_book_file.h
+ */
+
+#include "compact_book_file.h"
+#include "book_data_file.h"
+#include "file_manager.h"
+#include "node_cache.h"
+#include "storage.h"
+#include "tree_manager.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Tamanho máximo dos textos de um livro no formato compacto.
+ */
+#define COMPACT_BOOK_MAX_TEXT (sizeof(((Book *)0)->title) + sizeof(((Book *)0)->author) + sizeof(((Book *)0)->publisher))
+
+/**
+ * @brief Calcula o deslocamento (em bytes) de um registro no arquivo compacto.
+ */
+static long recordPosition(int record)
+{
+    return sizeof(CompactBookFileHeader) + (long)record * sizeof(CompactBookRecord);
+}
+
+/**
+ * @brief Calcula o deslocamento (em bytes) da área de textos no arquivo compacto.
+ */
+static long heapPosition(const CompactBookFileHeader *header)
+{
+    return recordPosition(header->bookCount);
+}
+
+/**
+ * @brief Retorna o tamanho de um texto de tamanho fixo, sem o terminador.
+ */
+static unsigned char textLength(const char *text, size_t capacity)
+{
+    size_t length = 0;
+
+    while (length < capacity - 1 && text[length] != '\0')
+    {
+        length++;
+    }
+
+    return (unsigned char)length;
+}
+
+/**
+ * @brief Abre um arquivo compacto para leitura.
+ *
+ * @param compact Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo compacto.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser aberto ou não estiver no formato compacto.
+ */
+int compactBookFileOpen(CompactBookFile *compact, const char *filename)
+{
+    compact->file = openFile(filename, "rb");
+
+    if (compact->file == NULL)
+    {
+        return -1;
+    }
+
+    if (fread(&compact->header, sizeof(CompactBookFileHeader), 1, compact->file) != 1 ||
+        compact->header.magic != COMPACT_BOOK_FILE_MAGIC)
+    {
+        fprintf(stderr, "Erro: o arquivo '%s' não está no formato compacto.\n", filename);
+        closeFile(&compact->file);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Lê registros consecutivos do arquivo compacto, sem os textos.
+ *
+ * @param compact Ponteiro para o arquivo aberto.
+ * @param first Número do primeiro registro.
+ * @param records Vetor onde os registros serão armazenados.
+ * @param maxRecords Capacidade do vetor `records`.
+ *
+ * @return Número de registros lidos (0 depois do último), ou -1 em caso de erro.
+ */
+int compactBookFileReadRecords(CompactBookFile *compact, int first, CompactBookRecord *records, int maxRecords)
+{
+    int count = compact->header.bookCount - first;
+
+    if (first < 0 || count <= 0)
+    {
+        return 0;
+    }
+
+    if (count > maxRecords)
+    {
+        count = maxRecords;
+    }
+
+    if (fseek(compact->file, recordPosition(first), SEEK_SET) != 0 ||
+        fread(records, sizeof(CompactBookRecord), count, compact->file) != (size_t)count)
+    {
+        fprintf(stderr, "Erro ao ler os registros do arquivo compacto.\n");
+        return -1;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Lê livros consecutivos e completos do arquivo compacto.
+ *
+ * Os textos dos livros lidos são carregados com uma única leitura da área de textos.
+ *
+ * @param compact Ponteiro para o arquivo aberto.
+ * @param first Número do primeiro livro.
+ * @param books Vetor onde os livros serão armazenados.
+ * @param maxBooks Capacidade do vetor `books` (no máximo `COMPACT_BOOK_FILE_BATCH`).
+ *
+ * @return Número de livros lidos (0 depois do último), ou -1 em caso de erro.
+ */
+int compactBookFileReadBooks(CompactBookFile *compact, int first, Book *books, int maxBooks)
+{
+    CompactBookRecord records[COMPACT_BOOK_FILE_BATCH];
+
+    if (maxBooks > COMPACT_BOOK_FILE_BATCH)
+    {
+        maxBooks = COMPACT_BOOK_FILE_BATCH;
+    }
+
+    int count = compactBookFileReadRecords(compact, first, records, maxBooks);
+
+    if (count <= 0)
+    {
+        return count;
+    }
+
+    // Os textos de registros consecutivos são consecutivos na área de textos
+    const CompactBookRecord *last = &records[count - 1];
+    long start = records[0].textOffset;
+    long end = last->textOffset + last->titleLength + last->authorLength + last->publisherLength;
+
+    if (start < 0 || end < start || end > compact->header.heapSize)
+    {
+        fprintf(stderr, "Erro: textos inválidos no arquivo compacto.\n");
+        return -1;
+    }
+
+    char *texts = malloc(end - start + 1);
+
+    if (texts == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para ler o arquivo compacto.\n");
+        return -1;
+    }
+
+    if (end > start && (fseek(compact->file, heapPosition(&compact->header) + start, SEEK_SET) != 0 ||
+                        fread(texts, end - start, 1, compact->file) != 1))
+    {
+        fprintf(stderr, "Erro ao ler os textos do arquivo compacto.\n");
+        free(texts);
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        const CompactBookRecord *record = &records[i];
+        const char *text = texts + (record->textOffset - start);
+        Book *book = &books[i];
+
+        memset(book, 0, sizeof(Book));
+        book->code = record->code;
+        book->edition = record->edition;
+        book->year = record->year;
+        book->price = record->price;
+        book->stock_quantity = record->stock_quantity;
+
+        memcpy(book->title, text, record->titleLength);
+        text += record->titleLength;
+        memcpy(book->author, text, record->authorLength);
+        text += record->authorLength;
+        memcpy(book->publisher, text, record->publisherLength);
+    }
+
+    free(texts);
+    return count;
+}
+
+/**
+ * @brief Soma os exemplares em estoque lendo apenas os registros de tamanho fixo.
+ *
+ * @param compact Ponteiro para o arquivo aberto.
+ *
+ * @return O total de exemplares em estoque, ou -1 em caso de erro.
+ */
+long compactBookFileStockTotal(CompactBookFile *compact)
+{
+    CompactBookRecord records[COMPACT_BOOK_FILE_BATCH];
+    long total = 0;
+    int count;
+
+    for (int first = 0; (count = compactBookFileReadRecords(compact, first, records, COMPACT_BOOK_FILE_BATCH)) > 0;
+         first += count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            total += records[i].stock_quantity;
+        }
+    }
+
+    return count == -1 ? -1 : total;
+}
+
+/**
+ * @brief Fecha o arquivo compacto.
+ *
+ * @param compact Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int compactBookFileClose(CompactBookFile *compact)
+{
+    if (compact->file == NULL)
+    {
+        return 0;
+    }
+
+    return closeFile(&compact->file);
+}
+
+/**
+ * @brief Converte um arquivo de dados para o formato compacto.
+ *
+ * Os registros livres do arquivo de dados são descartados; os livros mantêm a ordem do arquivo de dados.
+ *
+ * @pre O arquivo de dados não deve estar aberto por uma biblioteca (o cabeçalho gravado deve estar atualizado).
+ *
+ * @param dataFilename Nome do arquivo de dados.
+ * @param compactFilename Nome do arquivo compacto a ser criado.
+ *
+ * @return O número de livros convertidos, ou -1 em caso de erro.
+ */
+int convertDataFileToCompact(const char *dataFilename, const char *compactFilename)
+{
+    FILE *dataFile = openFile(dataFilename, "rb");
+    FILE *compactFile = openFile(compactFilename, "w+b");
+    BookDataFileHeader dataHeader;
+    CompactBookFileHeader header = {COMPACT_BOOK_FILE_MAGIC, 0, 0, 0};
+    Book *books = malloc(sizeof(Book) * COMPACT_BOOK_FILE_BATCH);
+    CompactBookRecord *records = malloc(sizeof(CompactBookRecord) * COMPACT_BOOK_FILE_BATCH);
+    char *heap = NULL;
+    size_t heapAllocated = 0;
+    int result = 0;
+
+    if (dataFile == NULL || compactFile == NULL || books == NULL || records == NULL ||
+        readFileHeader(dataFile, &dataHeader, sizeof(BookDataFileHeader)) != 1)
+    {
+        result = -1;
+    }
+
+    StorageReadAhead readAhead;
+
+    if (result == 0)
+    {
+        storageReadAheadStart(&readAhead, dataFile, sizeof(BookDataFileHeader),
+                              sizeof(BookDataFileHeader) + (long)dataHeader.firstEmptyPosition * sizeof(Book));
+    }
+
+    // Os registros são gravados à medida que são lidos; os textos ficam na memória até o final
+    for (int first = 0; result == 0 && first < dataHeader.firstEmptyPosition; first += COMPACT_BOOK_FILE_BATCH)
+    {
+        int count = dataHeader.firstEmptyPosition - first;
+        int kept = 0;
+
+        if (count > COMPACT_BOOK_FILE_BATCH)
+        {
+            count = COMPACT_BOOK_FILE_BATCH;
+        }
+
+        storageReadAheadAdvance(&readAhead, sizeof(BookDataFileHeader) + (long)first * sizeof(Book));
+
+        if (storageRead(dataFile, sizeof(BookDataFileHeader) + (long)first * sizeof(Book), books, sizeof(Book) * count) != 0)
+        {
+            fprintf(stderr, "Erro ao ler os livros do arquivo de dados.\n");
+            result = -1;
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            const Book *book = &books[i];
+
+            if (book->code == -1)
+            {
+                continue; // Registro livre
+            }
+
+            if (heapAllocated - header.heapSize < COMPACT_BOOK_MAX_TEXT)
+            {
+                size_t newAllocated = heapAllocated == 0 ? 65536 : heapAllocated * 2;
+                char *resized = realloc(heap, newAllocated);
+
+                if (resized == NULL)
+                {
+                    fprintf(stderr, "Erro: memória insuficiente para a conversão.\n");
+                    result = -1;
+                    break;
+                }
+
+                heap = resized;
+                heapAllocated = newAllocated;
+            }
+
+            CompactBookRecord *record = &records[kept++];
+
+            record->code = book->code;
+            record->edition = book->edition;
+            record->year = book->year;
+            record->stock_quantity = book->stock_quantity;
+            record->price = book->price;
+            record->textOffset = header.heapSize;
+            record->titleLength = textLength(book->title, sizeof(book->title));
+            record->authorLength = textLength(book->author, sizeof(book->author));
+            record->publisherLength = textLength(book->publisher, sizeof(book->publisher));
+
+            memcpy(heap + header.heapSize, book->title, record->titleLength);
+            header.heapSize += record->titleLength;
+            memcpy(heap + header.heapSize, book->author, record->authorLength);
+            header.heapSize += record->authorLength;
+            memcpy(heap + header.heapSize, book->publisher, record->publisherLength);
+            header.heapSize += record->publisherLength;
+
+            header.stockTotal += book->stock_quantity;
+        }
+
+        if (result == 0 && kept > 0 &&
+            (fseek(compactFile, recordPosition(header.bookCount), SEEK_SET) != 0 ||
+             fwrite(records, sizeof(CompactBookRecord), kept, compactFile) != (size_t)kept))
+        {
+            perror("Erro ao gravar os registros do arquivo compacto");
+            result = -1;
+        }
+
+        header.bookCount += kept;
+    }
+
+    // A área de textos começa logo após o último registro
+    if (result == 0 &&
+        (fseek(compactFile, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, compactFile) != 1 ||
+         fseek(compactFile, heapPosition(&header), SEEK_SET) != 0 ||
+         (header.heapSize > 0 && fwrite(heap, header.heapSize, 1, compactFile) != 1)))
+    {
+        perror("Erro ao gravar o arquivo compacto");
+        result = -1;
+    }
+
+    free(books);
+    free(records);
+    free(heap);
+
+    if ((dataFile != NULL && closeFile(&dataFile) != 0) || (compactFile != NULL && closeFile(&compactFile) != 0))
+    {
+        result = -1;
+    }
+
+    return result == 0 ? header.bookCount : -1;
+}
+
+/**
+ * @brief Código de um livro importado e sua posição no novo arquivo de dados.
+ */
+typedef struct
+{
+    int code;     // Código do livro
+    int position; // Posição do livro no arquivo de dados
+} CompactImportKey;
+
+/**
+ * @brief Compara duas chaves importadas pelo código.
+ */
+static int compareImportKeys(const void *a, const void *b)
+{
+    const CompactImportKey *x = a;
+    const CompactImportKey *y = b;
+
+    return (x->code > y->code) - (x->code < y->code);
+}
+
+/**
+ * @brief Monta o índice dos livros importados, de baixo para cima, em um arquivo de índices vazio.
+ *
+ * @param indexFile Novo arquivo de índices.
+ * @param entries Códigos e posições dos livros importados; o vetor é ordenado pelo código.
+ * @param count Número de livros.
+ * @param pairStamp Marca de par, a mesma do novo arquivo de dados.
+ *
+ * @return 0 em caso de sucesso, -1 se houver códigos repetidos ou em caso de erro.
+ */
+static int writeImportedIndex(FILE *indexFile, CompactImportKey *entries, int count, unsigned int pairStamp)
+{
+    IndexFileHeader header;
+    int *keys = malloc(sizeof(int) * (count > 0 ? count : 1));
+    int *positions = malloc(sizeof(int) * (count > 0 ? count : 1));
+    int result = 0;
+
+    if (keys == NULL || positions == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para montar o índice.\n");
+        free(keys);
+        free(positions);
+        return -1;
+    }
+
+    qsort(entries, count, sizeof(CompactImportKey), compareImportKeys);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (i > 0 && entries[i].code == entries[i - 1].code)
+        {
+            fprintf(stderr, "Erro: o código %d aparece mais de uma vez no arquivo compacto.\n", entries[i].code);
+            result = -1;
+            break;
+        }
+
+        keys[i] = entries[i].code;
+        positions[i] = entries[i].position;
+    }
+
+    createIndexFileHeader(indexFile);
+
+    if (result == 0 && readFileHeader(indexFile, &header, sizeof(IndexFileHeader)) != 1)
+    {
+        result = -1;
+    }
+
+    if (result == 0)
+    {
+        header.pairStamp = pairStamp;
+
+        if (count > 0 && twoThreeTreeBulkBuild(indexFile, keys, positions, count, &header) == -1)
+        {
+            result = -1;
+        }
+
+        // Os nós do cache são gravados antes do cabeçalho
+        if (nodeCacheFlush(indexFile) != 0)
+        {
+            result = -1;
+        }
+
+        saveHeader(indexFile, &header, sizeof(IndexFileHeader));
+    }
+
+    free(keys);
+    free(positions);
+
+    return result;
+}
+
+/**
+ * @brief Converte um arquivo compacto de volta para o formato do arquivo de dados e monta o seu índice.
+ *
+ * O livro `i` do arquivo compacto é gravado na posição `i` do arquivo de dados, que fica sem registros livres. O
+ * índice é montado de baixo para cima com `twoThreeTreeBulkBuild` (na ordem `TWO_THREE_TREE_ORDER`), e os dois
+ * arquivos recebem a mesma marca de par.
+ *
+ * @param compactFilename Nome do arquivo compacto.
+ * @param dataFilename Nome do arquivo de dados a ser criado.
+ * @param indexFilename Nome do arquivo de índices a ser criado.
+ *
+ * @return O número de livros convertidos, ou -1 em caso de erro (ou de código repetido no arquivo compacto).
+ *
+ * @post Em caso de erro, os arquivos de dados e de índices são removidos.
+ */
+int convertCompactToDataFile(const char *compactFilename, const char *dataFilename, const char *indexFilename)
+{
+    CompactBookFile compact;
+
+    if (compactBookFileOpen(&compact, compactFilename) != 0)
+    {
+        return -1;
+    }
+
+    FILE *dataFile = openFile(dataFilename, "w+b");
+    FILE *indexFile = openFile(indexFilename, "w+b");
+    Book *books = malloc(sizeof(Book) * COMPACT_BOOK_FILE_BATCH);
+    int total = compact.header.bookCount;
+    CompactImportKey *entries = malloc(sizeof(CompactImportKey) * (total > 0 ? total : 1));
+    BookDataFileHeader dataHeader;
+    int converted = 0;
+    int count = 0;
+    int result = 0;
+
+    initBookDataFileHeader(&dataHeader);
+    dataHeader.pairStamp = createFilePairStamp(0);
+    dataHeader.firstEmptyPosition = total;
+    dataHeader.bookCount = total;
+    dataHeader.stockTotal = compact.header.stockTotal;
+
+    if (books == NULL || entries == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a conversão.\n");
+        result = -1;
+    }
+
+    if (dataFile == NULL || indexFile == NULL || result == -1 ||
+        storageWrite(dataFile, 0, &dataHeader, sizeof(BookDataFileHeader)) != 0)
+    {
+        result = -1;
+    }
+
+    while (result == 0 && (count = compactBookFileReadBooks(&compact, converted, books, COMPACT_BOOK_FILE_BATCH)) > 0)
+    {
+        if (storageWrite(dataFile, sizeof(BookDataFileHeader) + (long)converted * sizeof(Book), books, sizeof(Book) * count) != 0)
+        {
+            perror("Erro ao gravar os livros no arquivo de dados");
+            result = -1;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            entries[converted + i].code = books[i].code;
+            entries[converted + i].position = converted + i;
+        }
+
+        converted += count;
+    }
+
+    if (count == -1)
+    {
+        result = -1;
+    }
+
+    if (result == 0 && writeImportedIndex(indexFile, entries, converted, dataHeader.pairStamp) != 0)
+    {
+        result = -1;
+    }
+
+    free(books);
+    free(entries);
+
+    if ((dataFile != NULL && closeFile(&dataFile) != 0) || (indexFile != NULL && closeFile(&indexFile) != 0) ||
+        compactBookFileClose(&compact) != 0)
+    {
+        result = -1;
+    }
+
+    // Um par incompleto não deve ser reaberto como biblioteca
+    if (result == -1)
+    {
+        remove(dataFilename);
+        remove(indexFilename);
+    }
+
+    return result == 0 ? converted : -1;
+}
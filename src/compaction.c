@@ -0,0 +1,342 @@
+/**
+ * @file compaction.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa a compactação dos arquivos de dados e de índices da biblioteca.
+ *
+ * @see compaction.h
+ */
+
+#include "compaction.h"
+#include "file_manager.h"
+#include "node_cache.h"
+#include "storage.h"
+#include "tree_cursor.h"
+#include "tree_manager.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Grava no novo arquivo de dados os livros do índice, em ordem de código e sem registros livres.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param dataFile Novo arquivo de dados, vazio.
+ * @param books Área de leitura com `COMPACTION_BATCH_SIZE` livros.
+ * @param keys Ponteiro onde será armazenado o vetor (alocado dinamicamente) com os códigos gravados.
+ * @param count Ponteiro onde será armazenado o número de livros gravados.
+ * @param pairStamp Marca de par dos novos arquivos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int writeCompactedData(Library *library, FILE *dataFile, Book *books, int **keys, int *count,
+                              unsigned int pairStamp)
+{
+    BookDataFileHeader header;
+    TreeCursor cursor;
+    int allocated = library->dataHeader.bookCount > 0 ? library->dataHeader.bookCount : COMPACTION_BATCH_SIZE;
+    int fetched;
+    int result = 0;
+
+    initBookDataFileHeader(&header);
+    header.pairStamp = pairStamp;
+
+    *count = 0;
+    *keys = malloc(sizeof(int) * allocated);
+
+    if (*keys == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a compactação.\n");
+        return -1;
+    }
+
+    // Percorre o índice em ordem de código; cada lote é gravado logo após o anterior
+    treeRangeBegin(&cursor, library->indexFile, INT_MIN, INT_MAX);
+    while (result == 0 && (fetched = treeRangeNextBooks(&cursor, library->dataFile, books, COMPACTION_BATCH_SIZE)) > 0)
+    {
+        if (*count + fetched > allocated)
+        {
+            int newAllocated = allocated * 2 > *count + fetched ? allocated * 2 : *count + fetched;
+            int *resized = realloc(*keys, sizeof(int) * newAllocated);
+
+            if (resized == NULL)
+            {
+                fprintf(stderr, "Erro: memória insuficiente para a compactação.\n");
+                result = -1;
+                break;
+            }
+
+            *keys = resized;
+            allocated = newAllocated;
+        }
+
+        if (storageWrite(dataFile, sizeof(BookDataFileHeader) + (long)*count * sizeof(Book), books, sizeof(Book) * fetched) != 0)
+        {
+            perror("Erro ao gravar os livros no novo arquivo de dados");
+            result = -1;
+            break;
+        }
+
+        for (int i = 0; i < fetched; i++)
+        {
+            (*keys)[*count + i] = books[i].code;
+            header.stockTotal += books[i].stock_quantity;
+        }
+        *count += fetched;
+    }
+    treeRangeEnd(&cursor);
+
+    if (result != 0 || fetched == -1)
+    {
+        return -1;
+    }
+
+    header.firstEmptyPosition = *count;
+    header.bookCount = *count;
+
+    if (storageWrite(dataFile, 0, &header, sizeof(BookDataFileHeader)) != 0)
+    {
+        perror("Erro ao gravar o cabeçalho do novo arquivo de dados");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Monta o novo índice, de baixo para cima, com as posições do novo arquivo de dados.
+ *
+ * @param indexFile Novo arquivo de índices, vazio.
+ * @param order Ordem do índice atual, mantida no novo índice.
+ * @param keys Códigos dos livros, em ordem crescente; o livro `i` está na posição `i`.
+ * @param count Número de livros.
+ * @param pairStamp Marca de par dos novos arquivos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int writeCompactedIndex(FILE *indexFile, int order, const int *keys, int count, unsigned int pairStamp)
+{
+    IndexFileHeader header;
+    int result = 0;
+
+    createIndexFileHeaderWithOrder(indexFile, order);
+
+    if (readFileHeader(indexFile, &header, sizeof(IndexFileHeader)) != 1)
+    {
+        return -1;
+    }
+
+    header.pairStamp = pairStamp;
+
+    if (count > 0)
+    {
+        int *positions = malloc(sizeof(int) * count);
+
+        if (positions == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para a compactação.\n");
+            return -1;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            positions[i] = i;
+        }
+
+        if (twoThreeTreeBulkBuild(indexFile, keys, positions, count, &header) == -1)
+        {
+            result = -1;
+        }
+
+        free(positions);
+    }
+
+    // Os nós do cache são gravados antes da sincronização do arquivo
+    if (nodeCacheFlush(indexFile) != 0)
+    {
+        result = -1;
+    }
+
+    saveHeader(indexFile, &header, sizeof(IndexFileHeader));
+
+    return result;
+}
+
+/**
+ * @brief Reconstrói os índices secundários e as colunas abertos a partir do arquivo de dados compactado.
+ *
+ * @param library Ponteiro para o handle da biblioteca, já com o novo arquivo de dados.
+ * @param books Área de leitura com `COMPACTION_BATCH_SIZE` livros.
+ * @param count Número de livros do arquivo de dados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int rebuildSecondaryIndexes(Library *library, Book *books, int count)
+{
+    AuthorIndex *authorIndex = &library->authorIndex;
+    TitleIndex *titleIndex = &library->titleIndex;
+    ColumnStore *columns = &library->columns;
+
+    if ((authorIndex->file != NULL && authorIndexClear(authorIndex) != 0) ||
+        (titleIndex->file != NULL && titleIndexClear(titleIndex) != 0))
+    {
+        return -1;
+    }
+
+    if (columns->file != NULL)
+    {
+        columnStoreClear(columns);
+    }
+
+    if (authorIndex->file == NULL && titleIndex->file == NULL && columns->file == NULL)
+    {
+        return 0;
+    }
+
+    StorageReadAhead readAhead;
+
+    storageReadAheadStart(&readAhead, library->dataFile, sizeof(BookDataFileHeader),
+                          sizeof(BookDataFileHeader) + (long)count * sizeof(Book));
+
+    // Os livros estão nas posições 0..count-1 e são lidos sequencialmente, um lote por vez
+    for (int first = 0; first < count; first += COMPACTION_BATCH_SIZE)
+    {
+        int fetched = count - first < COMPACTION_BATCH_SIZE ? count - first : COMPACTION_BATCH_SIZE;
+
+        storageReadAheadAdvance(&readAhead, sizeof(BookDataFileHeader) + (long)first * sizeof(Book));
+
+        if (storageRead(library->dataFile, sizeof(BookDataFileHeader) + (long)first * sizeof(Book), books, sizeof(Book) * fetched) != 0)
+        {
+            fprintf(stderr, "Erro ao ler os livros do arquivo de dados compactado.\n");
+            return -1;
+        }
+
+        for (int i = 0; i < fetched; i++)
+        {
+            if ((authorIndex->file != NULL && authorIndexInsert(authorIndex, books[i].author, first + i) != 0) ||
+                (titleIndex->file != NULL && titleIndexInsert(titleIndex, books[i].title, first + i) != 0) ||
+                (columns->file != NULL && columnStoreSet(columns, first + i, &books[i]) != 0))
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Compacta os arquivos de dados e de índices da biblioteca.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen` e nenhuma transação pode estar aberta.
+ *
+ * @post O arquivo de dados contém apenas os livros do índice, em ordem de código e sem registros livres; o índice,
+ *       os índices secundários e as colunas abertos e as listas de unidades livres refletem as novas posições.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param report Ponteiro para o relatório a ser preenchido.
+ *
+ * @return O número de livros gravados, ou -1 em caso de erro.
+ */
+int compactLibrary(Library *library, CompactionReport *report)
+{
+    memset(report, 0, sizeof(CompactionReport));
+
+    // Parte de um estado completo no disco: nós, listas de unidades livres e cabeçalhos gravados
+    if (libraryCommit(library) != 0)
+    {
+        return -1;
+    }
+
+    report->dataBytesBefore = storageSize(library->dataFile);
+    report->indexBytesBefore = storageSize(library->indexFile);
+
+    char dataTemp[LIBRARY_MAX_FILENAME + sizeof(LIBRARY_SWAP_SUFFIX)];
+    char indexTemp[LIBRARY_MAX_FILENAME + sizeof(LIBRARY_SWAP_SUFFIX)];
+
+    snprintf(dataTemp, sizeof(dataTemp), "%s%s", library->dataFilename, LIBRARY_SWAP_SUFFIX);
+    snprintf(indexTemp, sizeof(indexTemp), "%s%s", library->indexFilename, LIBRARY_SWAP_SUFFIX);
+
+    // A nova marca distingue os novos arquivos dos atuais se a troca for interrompida
+    unsigned int pairStamp = createFilePairStamp(library->dataHeader.pairStamp);
+
+    Book *books = malloc(sizeof(Book) * COMPACTION_BATCH_SIZE);
+    FILE *dataFile = openFile(dataTemp, "w+b");
+    FILE *indexFile = openFile(indexTemp, "w+b");
+    int *keys = NULL;
+    int count = 0;
+    int result = 0;
+
+    if (books == NULL || dataFile == NULL || indexFile == NULL)
+    {
+        result = -1;
+    }
+
+    if (result == 0 && (writeCompactedData(library, dataFile, books, &keys, &count, pairStamp) != 0 ||
+                        writeCompactedIndex(indexFile, library->indexHeader.order, keys, count, pairStamp) != 0))
+    {
+        result = -1;
+    }
+
+    // Os novos arquivos precisam estar no dispositivo antes de substituírem os originais
+    if (result == 0 && (storageSync(dataFile) != 0 || storageSync(indexFile) != 0))
+    {
+        perror("Erro ao sincronizar os arquivos compactados");
+        result = -1;
+    }
+
+    if ((dataFile != NULL && closeFile(&dataFile) != 0) || (indexFile != NULL && closeFile(&indexFile) != 0))
+    {
+        result = -1;
+    }
+
+    free(keys);
+
+    if (result != 0)
+    {
+        // Os arquivos originais não foram alterados
+        remove(dataTemp);
+        remove(indexTemp);
+        free(books);
+        return -1;
+    }
+
+    if (librarySwapFiles(library, dataTemp, indexTemp) != 0)
+    {
+        free(books);
+        return -1;
+    }
+
+    if (rebuildSecondaryIndexes(library, books, count) != 0)
+    {
+        result = -1;
+    }
+
+    free(books);
+
+    if (libraryCommit(library) != 0)
+    {
+        result = -1;
+    }
+
+    report->bookCount = count;
+    report->dataBytesAfter = storageSize(library->dataFile);
+    report->indexBytesAfter = storageSize(library->indexFile);
+
+    return result == 0 ? count : -1;
+}
+
+/**
+ * @brief Exibe o relatório de uma compactação.
+ *
+ * @param report Ponteiro para o relatório.
+ */
+void printCompactionReport(const CompactionReport *report)
+{
+    printf("Compactação concluída:\n");
+    printf("  Livros gravados: %d\n", report->bookCount);
+    printf("  Arquivo de dados: %ld -> %ld bytes\n", report->dataBytesBefore, report->dataBytesAfter);
+    printf("  Arquivo de índices: %ld -> %ld bytes\n", report->indexBytesBefore, report->indexBytesAfter);
+}
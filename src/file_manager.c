@@ -20,9 +20,21 @@
 #include "book.h"
 #include "file_manager.h"
 #include "book_manager.h"
+#include "book_parser.h"
 #include "utils.h"
+#include "node_cache.h"
+#include "tree_manager.h"
+#include "bplus_tree.h"
+#include "storage.h"
+#include "io_stats.h"
+#include "page_allocator.h"
+#include "tree_lock.h"
 
 #include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 /**
  * @brief Verifica se o arquivo está aberto corretamente.
@@ -51,6 +63,45 @@ static int verifyFile(FILE *arquivo, const char *nomeArquivo)
     return 1;
 }
 
+/**
+ * @brief Número máximo de cabeçalhos mantidos em memória simultaneamente.
+ */
+#define MAX_ATTACHED_HEADERS 40
+
+/**
+ * @brief Cabeçalho de arquivo mantido em memória.
+ *
+ * Enquanto um cabeçalho estiver anexado ao seu arquivo, a cópia em memória é a versão válida: `readFileHeader`
+ * e `saveHeader` operam apenas sobre ela, e a gravação no arquivo só ocorre em `flushFileHeader`.
+ */
+typedef struct
+{
+    FILE *file;        // Arquivo ao qual o cabeçalho pertence (NULL se a posição estiver livre)
+    void *header;      // Cópia do cabeçalho em memória
+    size_t headerSize; // Tamanho do cabeçalho em bytes
+    int dirty;         // 1 se a cópia em memória ainda não foi gravada no arquivo
+} AttachedHeader;
+
+static AttachedHeader attachedHeaders[MAX_ATTACHED_HEADERS];
+
+/**
+ * @brief Procura o cabeçalho anexado a um arquivo.
+ *
+ * @return Ponteiro para o cabeçalho anexado, ou NULL se o arquivo não tiver cabeçalho em memória.
+ */
+static AttachedHeader *findAttachedHeader(FILE *file)
+{
+    for (int i = 0; i < MAX_ATTACHED_HEADERS; i++)
+    {
+        if (file != NULL && attachedHeaders[i].file == file)
+        {
+            return &attachedHeaders[i];
+        }
+    }
+
+    return NULL;
+}
+
 /**
  * @brief Abre um arquivo no modo especificado.
  *
@@ -73,7 +124,7 @@ FILE *openFile(const char *filename, const char *mode)
 {
     FILE *file = fopen(filename, mode);
 
-    if (!validarArquivo(filename, "Arquivo"))
+    if (!verifyFile(file, filename))
     {
         return NULL;
     }
@@ -96,11 +147,32 @@ FILE *openFile(const char *filename, const char *mode)
  * @return 0 se o arquivo foi fechado com sucesso, -1 caso contrário.
  *
  * @note Se ocorrer um erro ao fechar o arquivo, uma mensagem de erro será exibida com detalhes do erro.
+ *       O cabeçalho anexado ao arquivo, os nós mantidos no cache de nós e a lista de unidades livres do
+ *       alocador são gravados antes do fechamento, e o mapeamento em memória do arquivo, se houver, é desfeito.
+ *       O modo de leituras posicionais e a trava de acesso concorrente do arquivo também são desligados.
  */
 int closeFile(FILE **file)
 {
     if (file && *file)
     {
+        // Grava os nós sujos do cache, a lista de unidades livres e o cabeçalho em memória antes de fechar o arquivo
+        nodeCacheFlush(*file);
+        if (pageAllocatorIsAttached(*file))
+        {
+            AttachedHeader *attached = findAttachedHeader(*file);
+
+            pageAllocatorDetach(*file);
+            if (attached != NULL)
+            {
+                attached->dirty = 1; // A cabeça da lista de unidades livres foi atualizada
+            }
+        }
+        detachFileHeader(*file);
+        nodeCacheInvalidate(*file);
+        storageUnmap(*file);
+        storageSetPositional(*file, 0);
+        treeLockDisable(*file);
+
         if (fclose(*file) == 0)
         {
             *file = NULL;
@@ -123,23 +195,61 @@ int closeFile(FILE **file)
  *
  * @return Nenhum.
  *
- * @note O cabeçalho do arquivo de índices é composto por três informações:
+ * @note Além do identificador, da versão, do tamanho dos nós, da geração e da marca do par, o cabeçalho do
+ *       arquivo de índices contém:
  *       - A raiz da árvore (`rootAddress`), inicialmente definida como -1 (indicando que a árvore está vazia).
- *       - A primeira posição livre (`firstEmptyPosition`), inicialmente definida como 0.
+ *       - A primeira posição livre (`firstEmptyPosition`), o endereço do primeiro nó, logo após o cabeçalho.
  *       - A cabeça de registros livres (`headEmptyPosition`), inicialmente definida como -1 (sem registros livres).
+ *       - A ordem da árvore (`order`), definida como `TWO_THREE_TREE_ORDER`.
  *
  * @warning A função assume que o arquivo foi aberto corretamente e está pronto para gravação. Não realiza verificação de erros na abertura do arquivo.
  */
 void createIndexFileHeader(FILE *file)
+{
+    createIndexFileHeaderWithOrder(file, TWO_THREE_TREE_ORDER);
+}
+
+/**
+ * @brief Cria o cabeçalho do arquivo de índices para uma árvore da ordem informada.
+ *
+ * Com ordem igual a `TWO_THREE_TREE_ORDER` o cabeçalho é o mesmo criado por `createIndexFileHeader`. Com ordem maior,
+ * o arquivo passa a usar o modo B+: a primeira página fica reservada para o cabeçalho e `firstEmptyPosition` aponta
+ * para a página seguinte.
+ *
+ * @param file Ponteiro para o arquivo de índices a ser modificado. O arquivo deve estar aberto em modo de escrita.
+ * @param order Número máximo de filhos por nó, entre `TWO_THREE_TREE_ORDER` e `BPLUS_MAX_ORDER`
+ *              (valores fora do intervalo são ajustados ao limite mais próximo).
+ */
+void createIndexFileHeaderWithOrder(FILE *file, int order)
 {
     IndexFileHeader header;
 
-    header.rootAddress = -1;       // Raiz da árvore (inicialmente vazia)
-    header.firstEmptyPosition = 0; // Primeira posição livre
+    if (order < TWO_THREE_TREE_ORDER)
+    {
+        order = TWO_THREE_TREE_ORDER;
+    }
+    else if (order > BPLUS_MAX_ORDER)
+    {
+        order = BPLUS_MAX_ORDER;
+    }
+
+    header.magic = INDEX_FILE_MAGIC;
+    header.version = INDEX_FILE_VERSION;
+    header.nodeSize = order > TWO_THREE_TREE_ORDER ? BPLUS_PAGE_SIZE : (int)sizeof(Node23);
+    header.generation = 0;
+    header.pairStamp = 0;
+    header.rootAddress = -1;                             // Raiz da árvore (inicialmente vazia)
+    header.firstEmptyPosition = sizeof(IndexFileHeader); // Primeiro nó, logo após o cabeçalho
     header.headEmptyPosition = -1; // Cabeça de registros livres (inicialmente sem registros livres)
+    header.order = order;
 
-    fseek(file, 0, SEEK_SET);
-    fwrite(&header, sizeof(header), 1, file);
+    // No modo B+ a primeira página é reservada para o cabeçalho
+    if (order > TWO_THREE_TREE_ORDER)
+    {
+        header.firstEmptyPosition = BPLUS_PAGE_SIZE;
+    }
+
+    IO_STATS_WRITE(IO_STATS_HEADER_WRITE, file, 0, &header, sizeof(header));
 }
 
 /**
@@ -153,9 +263,11 @@ void createIndexFileHeader(FILE *file)
  *
  * @return Nenhum.
  *
- * @note O cabeçalho do arquivo de dados é composto por duas informações:
+ * @note Além do identificador, da versão, do tamanho dos registros, da geração e da marca do par, o cabeçalho
+ *       do arquivo de dados contém:
  *       - A primeira posição livre (`firstEmptyPosition`), inicialmente definida como 0.
  *       - A cabeça de registros livres (`headEmptyPosition`), inicialmente definida como -1 (sem registros livres).
+ *       - O número de livros registrados (`bookCount`) e o total em estoque (`stockTotal`), inicialmente 0.
  *
  * @warning A função assume que o arquivo foi aberto corretamente e está pronto para gravação. Não realiza verificação de erros na abertura do arquivo.
  */
@@ -163,11 +275,149 @@ void createBookDataFileHeader(FILE *file)
 {
     BookDataFileHeader header;
 
-    header.firstEmptyPosition = 0; // Primeira posição livre
-    header.headEmptyPosition = -1; // Cabeça de registros livres (inicialmente sem registros livres)
+    initBookDataFileHeader(&header);
+
+    IO_STATS_WRITE(IO_STATS_HEADER_WRITE, file, 0, &header, sizeof(header));
+}
+
+/**
+ * @brief Inicializa o cabeçalho de um arquivo de dados vazio, sem gravá-lo.
+ *
+ * @param header Ponteiro para o cabeçalho a ser preenchido.
+ */
+void initBookDataFileHeader(BookDataFileHeader *header)
+{
+    header->magic = BOOK_DATA_FILE_MAGIC;
+    header->version = BOOK_DATA_FILE_VERSION;
+    header->recordSize = sizeof(Book);
+    header->generation = 0;
+    header->pairStamp = 0;
+    header->firstEmptyPosition = 0; // Primeira posição livre
+    header->headEmptyPosition = -1; // Cabeça de registros livres (inicialmente sem registros livres)
+    header->bookCount = 0;          // Nenhum livro registrado
+    header->stockTotal = 0;         // Nenhum exemplar em estoque
+}
+
+/**
+ * @brief Gera a marca de um novo par de arquivos de dados e de índices (`pairStamp`).
+ *
+ * @param previous Marca do par substituído (ou 0), que nunca é repetida.
+ *
+ * @return A nova marca.
+ */
+unsigned int createFilePairStamp(unsigned int previous)
+{
+    unsigned int stamp = (unsigned int)time(NULL) ^ ((unsigned int)clock() << 16);
+
+    return stamp != previous ? stamp : stamp + 1;
+}
+
+/**
+ * @brief Verifica se o cabeçalho lido de um arquivo de dados existente é válido para este programa.
+ *
+ * São conferidos o identificador e a versão do formato, o tamanho dos registros e a coerência dos campos com o
+ * tamanho do arquivo.
+ *
+ * @param file Ponteiro para o arquivo de dados aberto.
+ * @param header Ponteiro para o cabeçalho lido do arquivo.
+ *
+ * @return 0 se o cabeçalho for válido, -1 caso contrário (o motivo é exibido no stderr).
+ *
+ * @note O total em estoque não é conferido: ele é derivado dos livros, e `libraryOpenExisting` o recalcula se for
+ *       negativo.
+ */
+int checkBookDataFileHeader(FILE *file, const BookDataFileHeader *header)
+{
+    const char *problem = NULL;
+
+    if (header->magic != BOOK_DATA_FILE_MAGIC)
+    {
+        problem = "não é um arquivo de dados";
+    }
+    else if (header->version != BOOK_DATA_FILE_VERSION)
+    {
+        problem = "versão do formato não suportada";
+    }
+    else if (header->recordSize != (int)sizeof(Book))
+    {
+        problem = "tamanho de registro diferente do usado pelo programa";
+    }
+    else if (header->firstEmptyPosition < 0 || header->headEmptyPosition < -1 ||
+             header->headEmptyPosition >= header->firstEmptyPosition || header->bookCount < 0 ||
+             header->bookCount > header->firstEmptyPosition)
+    {
+        problem = "cabeçalho inconsistente";
+    }
+    else if (storageSize(file) < (long)sizeof(BookDataFileHeader) + (long)header->firstEmptyPosition * sizeof(Book))
+    {
+        problem = "arquivo menor que o indicado no cabeçalho";
+    }
+
+    if (problem != NULL)
+    {
+        fprintf(stderr, "Erro: arquivo de dados inválido (%s).\n", problem);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Verifica se o cabeçalho lido de um arquivo de índices existente é válido para este programa.
+ *
+ * São conferidos o identificador e a versão do formato, a ordem, o tamanho dos nós e a coerência dos endereços
+ * com o tamanho do arquivo.
+ *
+ * @param file Ponteiro para o arquivo de índices aberto.
+ * @param header Ponteiro para o cabeçalho lido do arquivo.
+ *
+ * @return 0 se o cabeçalho for válido, -1 caso contrário (o motivo é exibido no stderr).
+ */
+int checkIndexFileHeader(FILE *file, const IndexFileHeader *header)
+{
+    PageAllocatorLayout layout;
+    const char *problem = NULL;
 
-    fseek(file, 0, SEEK_SET);
-    fwrite(&header, sizeof(header), 1, file);
+    getIndexLayout(header, &layout);
+
+    if (header->magic != INDEX_FILE_MAGIC)
+    {
+        problem = "não é um arquivo de índices";
+    }
+    else if (header->version != INDEX_FILE_VERSION)
+    {
+        problem = "versão do formato não suportada";
+    }
+    else if (header->order < TWO_THREE_TREE_ORDER || header->order > BPLUS_MAX_ORDER)
+    {
+        problem = "ordem inválida";
+    }
+    else if (header->nodeSize != (int)layout.unitSize)
+    {
+        problem = "tamanho de nó diferente do usado pelo programa";
+    }
+    else if (header->firstEmptyPosition < layout.base ||
+             (header->firstEmptyPosition - layout.base) % layout.unitSize != 0 ||
+             (header->rootAddress != -1 &&
+              (header->rootAddress < layout.base || header->rootAddress >= header->firstEmptyPosition ||
+               (header->rootAddress - layout.base) % layout.unitSize != 0)) ||
+             (header->headEmptyPosition != -1 &&
+              (header->headEmptyPosition < layout.base || header->headEmptyPosition >= header->firstEmptyPosition)))
+    {
+        problem = "cabeçalho inconsistente";
+    }
+    else if (storageSize(file) < header->firstEmptyPosition)
+    {
+        problem = "arquivo menor que o indicado no cabeçalho";
+    }
+
+    if (problem != NULL)
+    {
+        fprintf(stderr, "Erro: arquivo de índices inválido (%s).\n", problem);
+        return -1;
+    }
+
+    return 0;
 }
 
 /**
@@ -183,15 +433,26 @@ void createBookDataFileHeader(FILE *file)
  * @return 1 se o cabeçalho foi lido com sucesso, -1 em caso de erro.
  *
  * @note A função assume que o arquivo foi aberto corretamente em modo de leitura binária antes de ser chamada.
- *       A leitura será feita a partir do início do arquivo.
+ *       A leitura será feita a partir do início do arquivo. Se o cabeçalho estiver anexado ao arquivo
+ *       (`attachFileHeader`), a cópia em memória é retornada sem acesso ao arquivo.
  *
  * @warning Se ocorrer um erro ao ler o cabeçalho, uma mensagem de erro será exibida.
  */
 int readFileHeader(FILE *file, void *header, size_t headerSize)
 {
-    fseek(file, 0, SEEK_SET);
+    AttachedHeader *attached = findAttachedHeader(file);
 
-    if (fread(header, headerSize, 1, file) != 1)
+    // Cabeçalho em memória: nenhuma leitura do arquivo é necessária
+    if (attached != NULL && attached->headerSize == headerSize)
+    {
+        if (header != attached->header)
+        {
+            memcpy(header, attached->header, headerSize);
+        }
+        return 1;
+    }
+
+    if (IO_STATS_READ(IO_STATS_HEADER_READ, file, 0, header, headerSize) != 0)
     {
         fprintf(stderr, "Erro ao ler o cabeçalho do arquivo.\n");
         return -1; // Erro ao ler o cabeçalho
@@ -214,58 +475,608 @@ int readFileHeader(FILE *file, void *header, size_t headerSize)
  * @return Nenhum.
  *
  * @note A função assume que o arquivo foi aberto corretamente em modo de escrita binária antes de ser chamada.
- *       O cabeçalho será escrito a partir do início do arquivo.
+ *       O cabeçalho será escrito a partir do início do arquivo. Se o cabeçalho estiver anexado ao arquivo
+ *       (`attachFileHeader`), apenas a cópia em memória é atualizada e a gravação ocorre em `flushFileHeader`.
  *
  * @warning Não há verificação de erros durante a escrita do cabeçalho. É importante garantir que o arquivo esteja
  *          corretamente aberto e pronto para gravação antes de chamar a função.
  */
 void saveHeader(FILE *file, void *header, size_t headerSize)
 {
-    // Coloca o ponteiro do arquivo no início
-    fseek(file, 0, SEEK_SET);
+    AttachedHeader *attached = findAttachedHeader(file);
 
-    // Escreve o cabeçalho no arquivo
-    fwrite(header, headerSize, 1, file);
+    // Cabeçalho em memória: a gravação é adiada até flushFileHeader
+    if (attached != NULL && attached->headerSize == headerSize)
+    {
+        if (header != attached->header)
+        {
+            memcpy(attached->header, header, headerSize);
+        }
+        attached->dirty = 1;
+        return;
+    }
+
+    // Escreve o cabeçalho no início do arquivo
+    IO_STATS_WRITE(IO_STATS_HEADER_WRITE, file, 0, header, headerSize);
 }
 
-void loadTextFile(const char *textFilename, const char *indexFilename, const char *dataFilename)
+/**
+ * @brief Anexa um cabeçalho em memória a um arquivo binário.
+ *
+ * O cabeçalho é lido do arquivo para a estrutura fornecida, que passa a ser a versão válida do cabeçalho: as
+ * chamadas seguintes a `readFileHeader` e `saveHeader` para este arquivo operam apenas na memória, e o
+ * cabeçalho só é gravado no arquivo por `flushFileHeader` ou `detachFileHeader`.
+ *
+ * @pre O arquivo deve estar aberto em modo de leitura e escrita binária e já conter o cabeçalho.
+ * @pre `header` deve permanecer válido enquanto estiver anexado ao arquivo.
+ *
+ * @post O cabeçalho é carregado em `header` e anexado ao arquivo.
+ *
+ * @param file Ponteiro para o arquivo binário.
+ * @param header Ponteiro para a estrutura que manterá o cabeçalho em memória.
+ * @param headerSize Tamanho, em bytes, da estrutura do cabeçalho.
+ *
+ * @return 1 se o cabeçalho foi anexado com sucesso, -1 em caso de erro na leitura ou se não houver posição livre.
+ */
+int attachFileHeader(FILE *file, void *header, size_t headerSize)
 {
-    FILE *textFile = openFile(textFilename, "r");
-    FILE *indexFile = openFile(indexFilename, "wb");
-    FILE *dataFile = openFile(dataFilename, "wb");
+    detachFileHeader(file);
+
+    if (readFileHeader(file, header, headerSize) != 1)
+    {
+        return -1;
+    }
 
-    if (!verifyFile(textFile, "Arquivo texto") || !verifyFile(indexFile, "Arquivo de Indices") || !verifyFile(dataFile, "Arquivo de Dados"))
+    for (int i = 0; i < MAX_ATTACHED_HEADERS; i++)
+    {
+        if (attachedHeaders[i].file == NULL)
+        {
+            attachedHeaders[i].file = file;
+            attachedHeaders[i].header = header;
+            attachedHeaders[i].headerSize = headerSize;
+            attachedHeaders[i].dirty = 0;
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "Erro: limite de cabeçalhos em memória atingido.\n");
+    return -1;
+}
+
+/**
+ * @brief Grava no arquivo o cabeçalho em memória, caso tenha sido modificado.
+ *
+ * @param file Ponteiro para o arquivo binário.
+ *
+ * @return 1 se o cabeçalho foi gravado ou não precisava ser gravado, -1 em caso de erro.
+ *
+ * @note Se o arquivo não tiver cabeçalho anexado, a função não faz nada e retorna 1.
+ */
+int flushFileHeader(FILE *file)
+{
+    AttachedHeader *attached = findAttachedHeader(file);
+
+    if (attached == NULL || !attached->dirty)
+    {
+        return 1;
+    }
+
+    if (IO_STATS_WRITE(IO_STATS_HEADER_WRITE, file, 0, attached->header, attached->headerSize) != 0)
+    {
+        perror("Erro ao gravar o cabeçalho do arquivo");
+        return -1;
+    }
+
+    attached->dirty = 0;
+    return 1;
+}
+
+/**
+ * @brief Grava e desanexa o cabeçalho em memória de um arquivo.
+ *
+ * @param file Ponteiro para o arquivo binário.
+ *
+ * @post As próximas chamadas a `readFileHeader` e `saveHeader` voltam a acessar o arquivo diretamente.
+ */
+void detachFileHeader(FILE *file)
+{
+    AttachedHeader *attached = findAttachedHeader(file);
+
+    if (attached == NULL)
     {
-        closeFile(&textFile);
-        closeFile(&indexFile);
-        closeFile(&dataFile);
         return;
     }
 
+    flushFileHeader(file);
+
+    attached->file = NULL;
+    attached->header = NULL;
+    attached->headerSize = 0;
+    attached->dirty = 0;
+}
+
+/**
+ * @brief Preenche o formato das unidades do arquivo de índices usado pelo alocador.
+ *
+ * Os nós livres são marcados com `nKeys` igual a 0 e encadeados por `left_child`; as páginas livres do modo B+ são
+ * marcadas com `isLeaf` igual a -1 e encadeadas por `next`. Os endereços são deslocamentos em bytes.
+ *
+ * @param header Ponteiro para o cabeçalho do arquivo de índices (a ordem define o formato).
+ * @param layout Ponteiro para o formato a ser preenchido.
+ */
+void getIndexLayout(const IndexFileHeader *header, PageAllocatorLayout *layout)
+{
+    if (header->order > TWO_THREE_TREE_ORDER)
+    {
+        layout->base = BPLUS_PAGE_SIZE;
+        layout->unitSize = BPLUS_PAGE_SIZE;
+        layout->marker = -1;
+        layout->linkOffset = offsetof(BPlusNode, next);
+    }
+    else
+    {
+        layout->base = sizeof(IndexFileHeader);
+        layout->unitSize = sizeof(Node23);
+        layout->marker = 0;
+        layout->linkOffset = offsetof(Node23, left_child);
+    }
+    layout->byteAddresses = 1;
+}
+
+/**
+ * @brief Preenche o formato das unidades do arquivo de dados usado pelo alocador.
+ *
+ * Os registros livres são `BookDataFreeNode` com `offset` igual a -1, e os endereços são números de registro.
+ *
+ * @param layout Ponteiro para o formato a ser preenchido.
+ */
+void getDataLayout(PageAllocatorLayout *layout)
+{
+    layout->base = sizeof(BookDataFileHeader);
+    layout->unitSize = sizeof(Book);
+    layout->byteAddresses = 0;
+    layout->marker = -1;
+    layout->linkOffset = offsetof(BookDataFreeNode, nextOffset);
+}
+
+/**
+ * @brief Passa a alocar os nós (ou páginas, no modo B+) do arquivo de índices pelo alocador de unidades.
+ *
+ * Os nós livres são marcados com `nKeys` igual a 0 e encadeados por `left_child`; as páginas livres do modo B+ são
+ * marcadas com `isLeaf` igual a -1 e encadeadas por `next`. Os endereços são deslocamentos em bytes.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices, que deve permanecer válido enquanto o
+ *               arquivo estiver anexado.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo já estiver anexado), -1 em caso de erro.
+ */
+int attachIndexAllocator(FILE *indexFile, IndexFileHeader *header)
+{
+    PageAllocatorLayout layout;
+
+    getIndexLayout(header, &layout);
+
+    // Arquivos criados antes do alocador não registram o fim da área de nós no cabeçalho
+    if (header->order <= TWO_THREE_TREE_ORDER && header->firstEmptyPosition < layout.base)
+    {
+        long size = storageSize(indexFile);
+        long nodes = size > layout.base ? (size - layout.base) / (long)sizeof(Node23) : 0;
+
+        header->firstEmptyPosition = layout.base + nodes * sizeof(Node23);
+    }
+
+    return pageAllocatorAttach(indexFile, &layout, &header->firstEmptyPosition, &header->headEmptyPosition);
+}
+
+/**
+ * @brief Passa a alocar os registros do arquivo de dados pelo alocador de unidades.
+ *
+ * Os registros livres são `BookDataFreeNode` com `offset` igual a -1, e os endereços são números de registro.
+ *
+ * @param dataFile Ponteiro para o arquivo de dados.
+ * @param header Ponteiro para o cabeçalho do arquivo de dados, que deve permanecer válido enquanto o
+ *               arquivo estiver anexado.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo já estiver anexado), -1 em caso de erro.
+ */
+int attachDataAllocator(FILE *dataFile, BookDataFileHeader *header)
+{
+    PageAllocatorLayout layout;
+
+    getDataLayout(&layout);
+
+    return pageAllocatorAttach(dataFile, &layout, &header->firstEmptyPosition, &header->headEmptyPosition);
+}
+
+/**
+ * @brief Aloca um nó (ou página, no modo B+) do arquivo de índices.
+ *
+ * Se o arquivo ainda não estiver anexado ao alocador, ele é anexado com o cabeçalho informado.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ * @param hint Endereço de um nó próximo (por exemplo, o irmão do novo nó), ou -1 para o menor endereço livre.
+ *
+ * @return O endereço do nó alocado, ou -1 em caso de erro.
+ */
+int allocateIndexNode(FILE *indexFile, IndexFileHeader *header, int hint)
+{
+    if (!pageAllocatorIsAttached(indexFile) && attachIndexAllocator(indexFile, header) != 0)
+    {
+        return -1;
+    }
+
+    return pageAllocate(indexFile, hint);
+}
+
+/**
+ * @brief Livro lido do arquivo texto durante a carga em lote, junto com a linha de origem.
+ */
+typedef struct
+{
+    Book book; // Dados do livro
+    int line;  // Linha do arquivo texto (usada no relatório de duplicados e como desempate na ordenação)
+} BulkBookEntry;
+
+/**
+ * @brief Número máximo de códigos duplicados listados individualmente no relatório da carga em lote.
+ */
+#define BULK_MAX_REPORTED_DUPLICATES 20
+
+/**
+ * @brief Compara dois livros da carga em lote pelo código e, em caso de empate, pela linha de origem.
+ */
+static int compareBulkEntries(const void *a, const void *b)
+{
+    const BulkBookEntry *x = a;
+    const BulkBookEntry *y = b;
+
+    if (x->book.code != y->book.code)
+    {
+        return x->book.code < y->book.code ? -1 : 1;
+    }
+
+    return x->line - y->line;
+}
+
+/**
+ * @brief Desfaz uma carga em lote interrompida, devolvendo a biblioteca ao estado vazio do início da carga.
+ *
+ * Os livros e os nós já gravados ficam além do `firstEmptyPosition` restaurado e são sobrescritos pelas próximas
+ * gravações.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param dataHeader Cabeçalho de dados do início da carga.
+ * @param indexHeader Cabeçalho de índices do início da carga.
+ * @param books Livros da carga.
+ * @param statsAdded Número de livros (do início de `books`) já somados às estatísticas.
+ */
+static void discardBulkLoad(Library *library, const BookDataFileHeader *dataHeader,
+                            const IndexFileHeader *indexHeader, const Book *books, int statsAdded)
+{
+    nodeCacheInvalidate(library->indexFile);
+
+    library->dataHeader = *dataHeader;
+    library->indexHeader = *indexHeader;
+    saveHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader));
+    saveHeader(library->indexFile, &library->indexHeader, sizeof(IndexFileHeader));
+
+    // A biblioteca estava vazia: os arquivos secundários também voltam a ficar vazios
+    if (library->codeFilter.counters != NULL)
+    {
+        libraryEnableCodeFilter(library, library->codeFilter.keys);
+    }
+
+    if (library->authorIndex.file != NULL)
+    {
+        authorIndexClear(&library->authorIndex);
+    }
+
+    if (library->titleIndex.file != NULL)
+    {
+        titleIndexClear(&library->titleIndex);
+    }
+
+    for (int i = 0; library->stats.file != NULL && i < statsAdded; i++)
+    {
+        bookStatsRemoveBook(&library->stats, &books[i]);
+    }
+
+    if (library->columns.file != NULL)
+    {
+        columnStoreClear(&library->columns);
+    }
+}
+
+/**
+ * @brief Carrega um arquivo texto em lote, construindo o índice de baixo para cima.
+ *
+ * Todas as linhas do arquivo texto são lidas para a memória e ordenadas pelo código do livro. Os livros são então
+ * gravados sequencialmente no arquivo de dados (agrupados por código) e a árvore 2-3 é montada em uma única passada
+ * sequencial por `twoThreeTreeBulkBuild`, sem buscas de duplicidade nem divisões de nós por livro.
+ *
+ * @pre A biblioteca deve estar vazia (sem livros no arquivo de dados e sem raiz no índice).
+ *
+ * @post Os livros são gravados e indexados. Livros com código repetido são ignorados (vale a primeira ocorrência)
+ *       e reportados em um único resumo ao final da carga; linhas mal formadas são ignoradas e reportadas pelo
+ *       leitor do arquivo texto (`bookParserNext`).
+ * @post Em caso de erro, a biblioteca continua vazia e nada é gravado com `libraryCommit`.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param textFilename Nome do arquivo texto a ser carregado.
+ *
+ * @return O número de livros carregados, ou -1 em caso de erro.
+ */
+int loadTextFileBulk(Library *library, const char *textFilename)
+{
+    if (library->indexHeader.rootAddress != -1 || library->dataHeader.firstEmptyPosition != 0 ||
+        library->dataHeader.headEmptyPosition != -1)
+    {
+        fprintf(stderr, "Erro: a carga em lote exige uma biblioteca vazia.\n");
+        return -1;
+    }
+
+    BookParser parser;
+
+    if (bookParserOpen(&parser, textFilename) != 0)
+    {
+        return -1;
+    }
+
+    // Estado vazio restaurado se a carga for interrompida
+    BookDataFileHeader emptyDataHeader = library->dataHeader;
+    IndexFileHeader emptyIndexHeader = library->indexHeader;
+    BulkBookEntry *entries = NULL;
+    int count = 0;
+    int allocated = 0;
     Book book;
-    char line[1024];
+    int status;
 
-    while (fgets(line, sizeof(line), textFile))
+    // Lê todos os livros do arquivo texto para a memória
+    while ((status = bookParserNext(&parser, &book)) == 1)
     {
-        // Remove a nova linha do final da string, se existir
-        line[strcspn(line, "\n")] = '\0';
+        if (count == allocated)
+        {
+            int newAllocated = allocated == 0 ? 1024 : allocated * 2;
+            BulkBookEntry *resized = realloc(entries, sizeof(BulkBookEntry) * newAllocated);
+
+            if (resized == NULL)
+            {
+                fprintf(stderr, "Erro: memória insuficiente para a carga em lote.\n");
+                free(entries);
+                bookParserClose(&parser);
+                return -1;
+            }
+
+            entries = resized;
+            allocated = newAllocated;
+        }
+
+        entries[count].book = book;
+        entries[count].line = (int)parser.line;
+        count++;
+    }
 
-        if (strlen(line) > sizeof(line) - 1)
+    long malformed = parser.malformed;
+
+    bookParserClose(&parser);
+
+    if (status == -1)
+    {
+        free(entries);
+        return -1;
+    }
+
+    if (count == 0)
+    {
+        free(entries);
+        printf("Arquivo carregado com sucesso! Nenhum livro encontrado, %ld linhas mal formadas ignoradas.\n",
+               malformed);
+        return 0;
+    }
+
+    // Ordena pelo código; duplicados ficam adjacentes, com a primeira ocorrência antes
+    qsort(entries, count, sizeof(BulkBookEntry), compareBulkEntries);
+
+    Book *books = malloc(sizeof(Book) * count);
+    int *keys = malloc(sizeof(int) * count);
+    int *positions = malloc(sizeof(int) * count);
+
+    if (books == NULL || keys == NULL || positions == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a carga em lote.\n");
+        free(entries);
+        free(books);
+        free(keys);
+        free(positions);
+        return -1;
+    }
+
+    int unique = 0;
+    int duplicates = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (unique > 0 && keys[unique - 1] == entries[i].book.code)
         {
-            fprintf(stderr, "Erro: Linha muito longa no arquivo de texto.\n");
-            break;
+            if (duplicates < BULK_MAX_REPORTED_DUPLICATES)
+            {
+                if (duplicates == 0)
+                {
+                    fprintf(stderr, "Aviso: livros com código duplicado ignorados:\n");
+                }
+                fprintf(stderr, "  código %d (linha %d)\n", entries[i].book.code, entries[i].line);
+            }
+            duplicates++;
+            continue;
         }
 
-        // Processa a linha e extrai dados do livro
-        extractBookFromLine(line, &book);
+        books[unique] = entries[i].book;
+        keys[unique] = entries[i].book.code;
+        positions[unique] = unique;
+        unique++;
+    }
 
+    free(entries);
+
+    if (duplicates > BULK_MAX_REPORTED_DUPLICATES)
+    {
+        fprintf(stderr, "  ... e mais %d duplicados.\n", duplicates - BULK_MAX_REPORTED_DUPLICATES);
+    }
+
+    // Grava os livros sequencialmente, já ordenados por código
+    int result = unique;
+    int statsAdded = 0;
+
+    if (unique > 0 && IO_STATS_WRITE(IO_STATS_RECORD_WRITE, library->dataFile, sizeof(BookDataFileHeader), books,
+                                       sizeof(Book) * unique) != 0)
+    {
+        perror("Erro ao gravar os livros no arquivo de dados");
+        result = -1;
+    }
+    // Monta o índice de baixo para cima em uma única passada sequencial
+    else if (twoThreeTreeBulkBuild(library->indexFile, keys, positions, unique, &library->indexHeader) == -1)
+    {
+        result = -1;
+    }
+    else
+    {
+        // Os totais do cabeçalho só passam a valer depois que os livros e o índice foram gravados
+        library->dataHeader.firstEmptyPosition = unique;
+        library->dataHeader.bookCount = unique;
+        library->dataHeader.stockTotal = 0;
+
+        for (int i = 0; i < unique; i++)
+        {
+            library->dataHeader.stockTotal += books[i].stock_quantity;
+        }
+
+        saveHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader));
+
+        // Alimenta o filtro de códigos, se estiver ligado
+        for (int i = 0; library->codeFilter.counters != NULL && i < unique; i++)
+        {
+            codeFilterAdd(&library->codeFilter, keys[i]);
+        }
+
+        if (library->codeFilter.counters != NULL && codeFilterIsFull(&library->codeFilter))
+        {
+            libraryEnableCodeFilter(library, 2 * library->codeFilter.keys);
+        }
+
+        // Alimenta o índice de autores, se estiver aberto
+        for (int i = 0; result != -1 && library->authorIndex.file != NULL && i < unique; i++)
+        {
+            if (authorIndexInsert(&library->authorIndex, books[i].author, positions[i]) != 0)
+            {
+                result = -1;
+            }
+        }
+
+        // Alimenta o índice de títulos, se estiver aberto
+        for (int i = 0; result != -1 && library->titleIndex.file != NULL && i < unique; i++)
+        {
+            if (titleIndexInsert(&library->titleIndex, books[i].title, positions[i]) != 0)
+            {
+                result = -1;
+            }
+        }
+
+        // Alimenta os contadores por autor, editora e ano, se estiverem abertos
+        for (int i = 0; result != -1 && library->stats.file != NULL && i < unique; i++)
+        {
+            if (bookStatsAddBook(&library->stats, &books[i]) != 0)
+            {
+                result = -1;
+            }
+            else
+            {
+                statsAdded++;
+            }
+        }
+
+        // Alimenta as colunas numéricas, se estiverem abertas
+        for (int i = 0; result != -1 && library->columns.file != NULL && i < unique; i++)
+        {
+            if (columnStoreSet(&library->columns, positions[i], &books[i]) != 0)
+            {
+                result = -1;
+            }
+        }
+    }
+
+    // Uma carga interrompida não é confirmada: os cabeçalhos gravados continuam sendo os da biblioteca vazia
+    if (result == -1)
+    {
+        fprintf(stderr, "Erro: carga em lote interrompida; nenhum livro foi carregado.\n");
+        discardBulkLoad(library, &emptyDataHeader, &emptyIndexHeader, books, statsAdded);
+    }
+    else if (libraryCommit(library) != 0)
+    {
+        result = -1;
+    }
+
+    free(books);
+    free(keys);
+    free(positions);
+
+    if (result != -1)
+    {
+        printf("Arquivo carregado com sucesso! %d livros carregados, %d duplicados ignorados, %ld linhas mal formadas "
+               "ignoradas.\n",
+               unique, duplicates, malformed);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Carrega os livros de um arquivo texto para a biblioteca.
+ *
+ * Cada linha do arquivo texto contém os campos de um livro separados por ponto e vírgula. Os livros são
+ * adicionados um a um através de `addBook`, utilizando os cabeçalhos mantidos em memória pelo handle.
+ * Se a biblioteca estiver vazia, a carga é feita em lote por `loadTextFileBulk`.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param textFilename Nome do arquivo texto a ser carregado.
+ *
+ * @post Os livros do arquivo texto são adicionados à biblioteca e as alterações são gravadas com `libraryCommit`.
+ */
+void loadTextFile(Library *library, const char *textFilename)
+{
+    // Biblioteca vazia: usa a carga em lote, que ordena os livros e monta o índice de uma só vez
+    if (library->indexHeader.rootAddress == -1 && library->dataHeader.firstEmptyPosition == 0 &&
+        library->dataHeader.headEmptyPosition == -1)
+    {
+        loadTextFileBulk(library, textFilename);
+        return;
+    }
+
+    BookParser parser;
+
+    if (bookParserOpen(&parser, textFilename) != 0)
+    {
+        return;
+    }
+
+    Book book;
+    int status;
+
+    // Lê os livros um a um, sem copiar as linhas do arquivo
+    while ((status = bookParserNext(&parser, &book)) == 1)
+    {
         // Adiciona o livro ao arquivo binário
-        addBook(dataFile, indexFile, &book);
+        addBook(library, &book);
     }
 
-    closeFile(&textFile);
-    closeFile(&indexFile);
-    closeFile(&dataFile);
+    long malformed = parser.malformed;
+
+    bookParserClose(&parser);
+    libraryCommit(library);
 
-    printf("Arquivo carregado com sucesso!\n");
+    if (status == 0)
+    {
+        printf("Arquivo carregado com sucesso! %ld linhas mal formadas ignoradas.\n", malformed);
+    }
 }
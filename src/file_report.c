@@ -0,0 +1,566 @@
+/**
+ * @file file_report.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa os relatórios de diagnóstico dos arquivos da biblioteca.
+ *
+ * O percurso em largura mantém os endereços do nível corrente na ordem da esquerda para a direita. Cada grupo desses
+ * endereços é copiado para um vetor de posições, ordenado pelo endereço e lido em trechos contíguos; os nós lidos
+ * são colocados de volta na ordem do nível, de modo que a impressão e os endereços dos filhos (o próximo nível)
+ * preservam a ordem das chaves.
+ *
+ * @see file_report.h
+ */
+
+#include "file_report.h"
+#include "file_manager.h"
+#include "bplus_tree.h"
+#include "page_allocator.h"
+#include "storage.h"
+#include "tree_lock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Endereço de um nó de um grupo e a sua posição na ordem do nível.
+ */
+typedef struct
+{
+    int address; // Endereço do nó no arquivo de índices
+    int index;   // Posição do nó no grupo
+} ReportSlot;
+
+/**
+ * @brief Compara duas posições de um grupo pelo endereço.
+ */
+static int compareReportSlots(const void *a, const void *b)
+{
+    int x = ((const ReportSlot *)a)->address;
+    int y = ((const ReportSlot *)b)->address;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Verifica se um endereço é o início de uma unidade da área de unidades do arquivo.
+ *
+ * @param layout Formato das unidades do arquivo.
+ * @param end Fim da área de unidades (`firstEmptyPosition` do cabeçalho).
+ * @param address Endereço a ser verificado.
+ */
+static int isValidUnit(const PageAllocatorLayout *layout, long end, int address)
+{
+    if (!layout->byteAddresses)
+    {
+        return address >= 0 && address < end;
+    }
+
+    return address >= layout->base && address < end && (address - layout->base) % (long)layout->unitSize == 0;
+}
+
+/**
+ * @brief Lê os nós de um grupo do nível, juntando em uma única leitura os nós próximos no arquivo.
+ *
+ * @param file Arquivo de índices.
+ * @param addresses Endereços dos nós, na ordem do nível.
+ * @param count Número de nós (no máximo `FILE_REPORT_BUFFER_BYTES / unitSize`).
+ * @param unitSize Tamanho de cada nó.
+ * @param nodes Área que recebe os nós, na ordem de `addresses`.
+ * @param slots Área auxiliar com `count` posições.
+ * @param buffer Área de leitura com `FILE_REPORT_BUFFER_BYTES` bytes.
+ * @param reads Contador de leituras, incrementado a cada leitura.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+static int loadLevelGroup(FILE *file, const int *addresses, int count, size_t unitSize, char *nodes,
+                          ReportSlot *slots, char *buffer, long *reads)
+{
+    for (int i = 0; i < count; i++)
+    {
+        slots[i].address = addresses[i];
+        slots[i].index = i;
+    }
+
+    qsort(slots, count, sizeof(ReportSlot), compareReportSlots);
+
+    for (int start = 0; start < count;)
+    {
+        long first = slots[start].address;
+        int end = start + 1;
+
+        // O trecho cresce enquanto couber na área de leitura e as lacunas forem pequenas
+        while (end < count && slots[end].address - first + (long)unitSize <= FILE_REPORT_BUFFER_BYTES &&
+               slots[end].address - slots[end - 1].address - (long)unitSize <= FILE_REPORT_MAX_GAP)
+        {
+            end++;
+        }
+
+        size_t size = slots[end - 1].address - first + unitSize;
+
+        (*reads)++;
+        if (storageRead(file, first, buffer, size) != 0)
+        {
+            fprintf(stderr, "Erro ao ler os nós %ld a %d do índice.\n", first, slots[end - 1].address);
+            return -1;
+        }
+
+        for (int i = start; i < end; i++)
+        {
+            memcpy(nodes + (size_t)slots[i].index * unitSize, buffer + (slots[i].address - first), unitSize);
+        }
+
+        start = end;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Imprime as chaves de um nó: todas, se forem até três, ou a primeira e a última.
+ */
+static void printNodeKeys(FILE *output, const int *keys, int nKeys)
+{
+    fprintf(output, " [");
+
+    if (nKeys <= 3)
+    {
+        for (int i = 0; i < nKeys; i++)
+        {
+            fprintf(output, i == 0 ? "%d" : "|%d", keys[i]);
+        }
+    }
+    else
+    {
+        fprintf(output, "%d|...|%d", keys[0], keys[nKeys - 1]);
+    }
+
+    fprintf(output, "]");
+}
+
+/**
+ * @brief Garante espaço para mais `extra` endereços no vetor do próximo nível.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int reserveAddresses(int **addresses, long *capacity, long count, long extra)
+{
+    if (count + extra <= *capacity)
+    {
+        return 0;
+    }
+
+    long resized = *capacity * 2 > count + extra ? *capacity * 2 : count + extra;
+    int *grown = realloc(*addresses, sizeof(int) * resized);
+
+    if (grown == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para percorrer o índice.\n");
+        return -1;
+    }
+
+    *addresses = grown;
+    *capacity = resized;
+    return 0;
+}
+
+/**
+ * @brief Percorre o índice em largura e calcula as estatísticas de cada nível.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param report Ponteiro para o relatório a ser preenchido.
+ * @param output Arquivo onde as chaves dos nós de cada nível são impressas (até `FILE_REPORT_MAX_PRINTED` nós por
+ *               nível), ou NULL para calcular apenas as estatísticas.
+ *
+ * @return A altura do índice, ou -1 em caso de erro de leitura, de memória ou de um índice inconsistente.
+ */
+int reportIndexLevels(Library *library, IndexLevelReport *report, FILE *output)
+{
+    FILE *indexFile = library->indexFile;
+    const IndexFileHeader *header = &library->indexHeader;
+    PageAllocatorLayout layout;
+
+    memset(report, 0, sizeof(IndexLevelReport));
+
+    if (treeLockWrite(indexFile) != 0)
+    {
+        return -1;
+    }
+
+    // Os nós em cache e a lista de livres do alocador passam a estar no arquivo
+    if (libraryCommit(library) != 0)
+    {
+        treeUnlock(indexFile);
+        return -1;
+    }
+
+    getIndexLayout(header, &layout);
+
+    int bplus = header->order > TWO_THREE_TREE_ORDER;
+    int group = FILE_REPORT_BUFFER_BYTES / layout.unitSize;
+
+    report->order = header->order;
+    report->maxKeys = header->order - 1;
+    report->totalUnits = header->firstEmptyPosition > layout.base
+                             ? (header->firstEmptyPosition - layout.base) / (long)layout.unitSize
+                             : 0;
+    report->freeUnits = pageAllocatorIsAttached(indexFile) ? pageAllocatorFreeCount(indexFile) : 0;
+
+    long levelCapacity = 1;
+    long nextCapacity = 1;
+    int *level = malloc(sizeof(int) * levelCapacity);
+    int *next = malloc(sizeof(int) * nextCapacity);
+    char *nodes = malloc(FILE_REPORT_BUFFER_BYTES);
+    char *buffer = malloc(FILE_REPORT_BUFFER_BYTES);
+    ReportSlot *slots = malloc(sizeof(ReportSlot) * group);
+    long count = 0;
+    int result = 0;
+
+    if (level == NULL || next == NULL || nodes == NULL || buffer == NULL || slots == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para percorrer o índice.\n");
+        result = -1;
+    }
+    else if (header->rootAddress != -1)
+    {
+        level[count++] = header->rootAddress;
+    }
+
+    while (result == 0 && count > 0)
+    {
+        if (report->height == FILE_REPORT_MAX_LEVELS)
+        {
+            fprintf(stderr, "Erro: o índice tem mais de %d níveis.\n", FILE_REPORT_MAX_LEVELS);
+            result = -1;
+            break;
+        }
+
+        IndexLevelStats *stats = &report->levels[report->height];
+        long nextCount = 0;
+
+        if (output != NULL)
+        {
+            fprintf(output, "Nível %d:", report->height);
+        }
+
+        for (long start = 0; result == 0 && start < count; start += group)
+        {
+            int n = count - start < group ? (int)(count - start) : group;
+
+            for (int i = 0; i < n; i++)
+            {
+                if (!isValidUnit(&layout, header->firstEmptyPosition, level[start + i]))
+                {
+                    fprintf(stderr, "Erro: endereço de nó inválido no índice (%d).\n", level[start + i]);
+                    result = -1;
+                    break;
+                }
+            }
+
+            if (result != 0 ||
+                loadLevelGroup(indexFile, level + start, n, layout.unitSize, nodes, slots, buffer, &report->reads) != 0)
+            {
+                result = -1;
+                break;
+            }
+
+            for (int i = 0; i < n; i++)
+            {
+                const char *raw = nodes + (size_t)i * layout.unitSize;
+                int nKeys;
+                int pair[2];
+                const int *keys;
+
+                if (bplus)
+                {
+                    const BPlusNode *node = (const BPlusNode *)raw;
+
+                    nKeys = node->nKeys;
+                    keys = node->keys;
+
+                    // Folhas podem ficar vazias com a remoção preguiçosa; páginas livres têm `isLeaf` igual a -1
+                    if ((node->isLeaf != 0 && node->isLeaf != 1) || nKeys < 0 || nKeys > report->maxKeys)
+                    {
+                        fprintf(stderr, "Erro: nó inconsistente no nível %d do índice.\n", report->height);
+                        result = -1;
+                        break;
+                    }
+
+                    if (reserveAddresses(&next, &nextCapacity, nextCount, nKeys + 1) != 0)
+                    {
+                        result = -1;
+                        break;
+                    }
+
+                    for (int c = 0; !node->isLeaf && c <= nKeys; c++)
+                    {
+                        next[nextCount++] = node->values[c];
+                    }
+                }
+                else
+                {
+                    const Node23 *node = (const Node23 *)raw;
+
+                    nKeys = node->nKeys;
+                    pair[0] = node->left_key;
+                    pair[1] = node->right_key;
+                    keys = pair;
+
+                    if (nKeys < 1 || nKeys > 2)
+                    {
+                        fprintf(stderr, "Erro: nó inconsistente no nível %d do índice.\n", report->height);
+                        result = -1;
+                        break;
+                    }
+
+                    if (reserveAddresses(&next, &nextCapacity, nextCount, 3) != 0)
+                    {
+                        result = -1;
+                        break;
+                    }
+
+                    if (node->left_child != -1)
+                    {
+                        next[nextCount++] = node->left_child;
+                        next[nextCount++] = node->middle_child;
+
+                        if (nKeys == 2)
+                        {
+                            next[nextCount++] = node->right_child;
+                        }
+                    }
+                }
+
+                if (output != NULL && stats->nodes < FILE_REPORT_MAX_PRINTED)
+                {
+                    printNodeKeys(output, keys, nKeys);
+                }
+
+                stats->nodes++;
+                stats->keys += nKeys;
+            }
+        }
+
+        if (output != NULL)
+        {
+            if (stats->nodes > FILE_REPORT_MAX_PRINTED)
+            {
+                fprintf(output, " ... (+%ld nós)", stats->nodes - FILE_REPORT_MAX_PRINTED);
+            }
+
+            fprintf(output, "\n");
+        }
+
+        report->nodes += stats->nodes;
+        report->keys += stats->keys;
+        report->height++;
+
+        // Mais nós que a área de nós só é possível com um ciclo entre os nós
+        if (result == 0 && report->nodes > report->totalUnits)
+        {
+            fprintf(stderr, "Erro: o índice tem mais nós que o arquivo (ciclo entre os nós).\n");
+            result = -1;
+        }
+
+        int *swap = level;
+        long swapCapacity = levelCapacity;
+
+        level = next;
+        levelCapacity = nextCapacity;
+        next = swap;
+        nextCapacity = swapCapacity;
+        count = nextCount;
+    }
+
+    free(level);
+    free(next);
+    free(nodes);
+    free(buffer);
+    free(slots);
+    treeUnlock(indexFile);
+
+    return result == 0 ? report->height : -1;
+}
+
+/**
+ * @brief Exibe as estatísticas do relatório do índice por níveis.
+ *
+ * @param report Ponteiro para o relatório preenchido por `reportIndexLevels`.
+ */
+void printIndexLevelReport(const IndexLevelReport *report)
+{
+    printf("Índice %s (ordem %d): altura %d, %ld nós, %ld chaves\n",
+           report->order > TWO_THREE_TREE_ORDER ? "B+" : "2-3", report->order, report->height, report->nodes,
+           report->keys);
+
+    for (int i = 0; i < report->height; i++)
+    {
+        const IndexLevelStats *level = &report->levels[i];
+
+        printf("  Nível %2d: %10ld nós, %11ld chaves, ocupação %5.1f%%\n", i, level->nodes, level->keys,
+               level->nodes > 0 ? 100.0 * level->keys / ((double)level->nodes * report->maxKeys) : 0.0);
+    }
+
+    if (report->nodes > 0)
+    {
+        printf("  Ocupação média: %.1f%%\n", 100.0 * report->keys / ((double)report->nodes * report->maxKeys));
+    }
+
+    printf("  Área de nós: %ld nós, %ld livres (%.1f%%)\n", report->totalUnits, report->freeUnits,
+           report->totalUnits > 0 ? 100.0 * report->freeUnits / report->totalUnits : 0.0);
+    printf("  Leituras do arquivo: %ld\n", report->reads);
+}
+
+/**
+ * @brief Percorre a lista de nós livres do índice ou a de registros livres do arquivo de dados.
+ *
+ * @pre O handle deve ter sido aberto com `libraryOpen`.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param kind Arquivo da lista.
+ * @param report Ponteiro para o relatório a ser preenchido.
+ * @param output Arquivo onde os endereços da lista são impressos (até `FILE_REPORT_MAX_PRINTED`), ou NULL.
+ *
+ * @return O número de unidades da lista, ou -1 em caso de erro de leitura.
+ *
+ * @note Uma lista corrompida não é um erro: o percurso é interrompido e `report->corrupted` recebe 1.
+ */
+long reportFreeList(Library *library, FreeListKind kind, FreeListReport *report, FILE *output)
+{
+    FILE *file = kind == FREE_LIST_INDEX ? library->indexFile : library->dataFile;
+    PageAllocatorLayout layout;
+    StorageReadAhead ahead;
+    int result = 0;
+
+    memset(report, 0, sizeof(FreeListReport));
+    report->kind = kind;
+    report->first = -1;
+    report->last = -1;
+
+    if (treeLockWrite(library->indexFile) != 0)
+    {
+        return -1;
+    }
+
+    // A lista de livres do alocador só é gravada no arquivo no commit
+    if (libraryCommit(library) != 0)
+    {
+        treeUnlock(library->indexFile);
+        return -1;
+    }
+
+    long end;
+    int address;
+
+    if (kind == FREE_LIST_INDEX)
+    {
+        getIndexLayout(&library->indexHeader, &layout);
+        end = library->indexHeader.firstEmptyPosition;
+        address = library->indexHeader.headEmptyPosition;
+        report->totalUnits = end > layout.base ? (end - layout.base) / (long)layout.unitSize : 0;
+    }
+    else
+    {
+        getDataLayout(&layout);
+        end = library->dataHeader.firstEmptyPosition;
+        address = library->dataHeader.headEmptyPosition;
+        report->totalUnits = end;
+    }
+
+    report->allocatorFree = pageAllocatorIsAttached(file) ? pageAllocatorFreeCount(file) : -1;
+
+    // A lista é gravada em ordem crescente de endereço: as leituras seguem o arquivo
+    storageReadAheadStart(&ahead, file, layout.base, layout.base + report->totalUnits * (long)layout.unitSize);
+
+    if (output != NULL)
+    {
+        fprintf(output, "Livres:");
+    }
+
+    while (address != -1)
+    {
+        if (!isValidUnit(&layout, end, address) || report->freeUnits >= report->totalUnits)
+        {
+            report->corrupted = 1;
+            break;
+        }
+
+        long offset = layout.byteAddresses ? address : layout.base + (long)address * layout.unitSize;
+        int marker;
+        int link;
+
+        storageReadAheadAdvance(&ahead, offset);
+
+        if (storageRead(file, offset, &marker, sizeof(int)) != 0 ||
+            storageRead(file, offset + layout.linkOffset, &link, sizeof(int)) != 0)
+        {
+            perror("Erro ao ler a lista de livres");
+            result = -1;
+            break;
+        }
+
+        if (marker != layout.marker)
+        {
+            report->corrupted = 1;
+            break;
+        }
+
+        if (output != NULL && report->freeUnits < FILE_REPORT_MAX_PRINTED)
+        {
+            fprintf(output, " %d", address);
+        }
+
+        if (report->first == -1)
+        {
+            report->first = address;
+        }
+
+        report->last = address;
+        report->freeUnits++;
+        address = link;
+    }
+
+    if (output != NULL)
+    {
+        if (report->freeUnits > FILE_REPORT_MAX_PRINTED)
+        {
+            fprintf(output, " ... (+%ld)", report->freeUnits - FILE_REPORT_MAX_PRINTED);
+        }
+
+        fprintf(output, report->freeUnits == 0 ? " nenhum\n" : "\n");
+    }
+
+    treeUnlock(library->indexFile);
+
+    return result == 0 ? report->freeUnits : -1;
+}
+
+/**
+ * @brief Exibe as estatísticas do relatório de uma lista de livres.
+ *
+ * @param report Ponteiro para o relatório preenchido por `reportFreeList`.
+ */
+void printFreeListReport(const FreeListReport *report)
+{
+    const char *units = report->kind == FREE_LIST_INDEX ? "nós" : "registros";
+
+    printf("Lista de livres do arquivo de %s: %ld de %ld %s livres (%.1f%%)\n",
+           report->kind == FREE_LIST_INDEX ? "índices" : "dados", report->freeUnits, report->totalUnits, units,
+           report->totalUnits > 0 ? 100.0 * report->freeUnits / report->totalUnits : 0.0);
+
+    if (report->freeUnits > 0)
+    {
+        printf("  Primeiro: %d | Último: %d\n", report->first, report->last);
+    }
+
+    if (report->corrupted)
+    {
+        printf("  Aviso: o encadeamento está corrompido; o percurso foi interrompido.\n");
+    }
+    else if (report->allocatorFree != -1 && report->allocatorFree != report->freeUnits)
+    {
+        printf("  Aviso: o alocador registra %ld %s livres.\n", report->allocatorFree, units);
+    }
+}
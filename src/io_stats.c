@@ -0,0 +1,326 @@
+/**
+ * @file io_stats.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa a instrumentação opcional das leituras e gravações de nós, cabeçalhos e registros.
+ *
+ * Os contadores são globais e atualizados com operações atômicas relaxadas, de modo que as threads do acesso
+ * concorrente podem contá-los sem trava. A operação lógica e o nível corrente são locais a cada thread.
+ *
+ * @see io_stats.h
+ */
+
+#include "io_stats.h"
+
+#include <string.h>
+
+#ifdef TWO_THREE_IO_STATS
+#include <stdatomic.h>
+#include <time.h>
+
+/**
+ * @brief Contadores atômicos de um tipo de acesso.
+ */
+typedef struct
+{
+    atomic_llong calls;
+    atomic_llong bytes;
+    atomic_llong nanoseconds;
+} AtomicCounter;
+
+static atomic_llong operations[IO_STATS_OP_COUNT];
+static AtomicCounter sites[IO_STATS_OP_COUNT][IO_STATS_SITE_COUNT];
+static AtomicCounter levels[IO_STATS_MAX_LEVELS][2];
+
+static _Thread_local int currentOperation = IO_STATS_OP_OTHER; // Operação lógica em andamento na thread
+static _Thread_local int currentLevel = -1;                     // Nível dos próximos acessos a nós (-1: nenhum)
+
+/**
+ * @brief Retorna o instante atual do relógio monotônico, em nanossegundos.
+ */
+static long long now(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (long long)time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+/**
+ * @brief Soma uma chamada a um contador.
+ */
+static void addToCounter(AtomicCounter *counter, size_t bytes, long long nanoseconds)
+{
+    atomic_fetch_add_explicit(&counter->calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counter->bytes, (long long)bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counter->nanoseconds, nanoseconds, memory_order_relaxed);
+}
+
+/**
+ * @brief Registra um acesso na operação corrente e, se for um acesso a nó, no nível corrente.
+ */
+static void record(IoStatsSite site, size_t bytes, long long start)
+{
+    long long elapsed = now() - start;
+
+    addToCounter(&sites[currentOperation][site], bytes, elapsed);
+
+    if ((site == IO_STATS_NODE_READ || site == IO_STATS_NODE_WRITE) && currentLevel >= 0)
+    {
+        int level = currentLevel < IO_STATS_MAX_LEVELS ? currentLevel : IO_STATS_MAX_LEVELS - 1;
+
+        addToCounter(&levels[level][site == IO_STATS_NODE_WRITE], bytes, elapsed);
+    }
+}
+
+/**
+ * @brief Copia um contador atômico.
+ */
+static IoStatsCounter loadCounter(AtomicCounter *counter)
+{
+    IoStatsCounter copy;
+
+    copy.calls = atomic_load_explicit(&counter->calls, memory_order_relaxed);
+    copy.bytes = atomic_load_explicit(&counter->bytes, memory_order_relaxed);
+    copy.nanoseconds = atomic_load_explicit(&counter->nanoseconds, memory_order_relaxed);
+
+    return copy;
+}
+
+/**
+ * @brief Zera um contador atômico.
+ */
+static void clearCounter(AtomicCounter *counter)
+{
+    atomic_store_explicit(&counter->calls, 0, memory_order_relaxed);
+    atomic_store_explicit(&counter->bytes, 0, memory_order_relaxed);
+    atomic_store_explicit(&counter->nanoseconds, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief Executa `storageRead` e registra o acesso como do tipo `site`.
+ *
+ * @return O mesmo valor de `storageRead`.
+ */
+int ioStatsRead(IoStatsSite site, FILE *file, long offset, void *buffer, size_t size)
+{
+    long long start = now();
+    int result = storageRead(file, offset, buffer, size);
+
+    record(site, size, start);
+    return result;
+}
+
+/**
+ * @brief Executa `storageWrite` e registra o acesso como do tipo `site`.
+ *
+ * @return O mesmo valor de `storageWrite`.
+ */
+int ioStatsWrite(IoStatsSite site, FILE *file, long offset, const void *buffer, size_t size)
+{
+    long long start = now();
+    int result = storageWrite(file, offset, buffer, size);
+
+    record(site, size, start);
+    return result;
+}
+
+/**
+ * @brief Inicia uma operação lógica na thread, se nenhuma estiver em andamento.
+ *
+ * @return A operação que estava em andamento, a ser restaurada por `ioStatsEnd`.
+ */
+int ioStatsBegin(IoStatsOperation operation)
+{
+    int previous = currentOperation;
+
+    if (previous == IO_STATS_OP_OTHER)
+    {
+        currentOperation = operation;
+        currentLevel = -1;
+        atomic_fetch_add_explicit(&operations[operation], 1, memory_order_relaxed);
+    }
+
+    return previous;
+}
+
+/**
+ * @brief Encerra a operação lógica iniciada por `ioStatsBegin`.
+ *
+ * @param previous Valor retornado por `ioStatsBegin`.
+ */
+void ioStatsEnd(int previous)
+{
+    currentOperation = previous;
+
+    if (previous == IO_STATS_OP_OTHER)
+    {
+        currentLevel = -1;
+    }
+}
+
+/**
+ * @brief Define o nível da árvore dos próximos acessos a nós da thread.
+ *
+ * @param level Nível (a raiz é o nível 0).
+ */
+void ioStatsSetLevel(int level)
+{
+    currentLevel = level;
+}
+#endif
+
+/**
+ * @brief Informa se a instrumentação foi compilada.
+ *
+ * @return 1 se `TWO_THREE_IO_STATS` estava definido na compilação, 0 caso contrário.
+ */
+int ioStatsEnabled(void)
+{
+#ifdef TWO_THREE_IO_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Zera todos os contadores da instrumentação.
+ */
+void ioStatsReset(void)
+{
+#ifdef TWO_THREE_IO_STATS
+    for (int op = 0; op < IO_STATS_OP_COUNT; op++)
+    {
+        atomic_store_explicit(&operations[op], 0, memory_order_relaxed);
+
+        for (int site = 0; site < IO_STATS_SITE_COUNT; site++)
+        {
+            clearCounter(&sites[op][site]);
+        }
+    }
+
+    for (int level = 0; level < IO_STATS_MAX_LEVELS; level++)
+    {
+        clearCounter(&levels[level][0]);
+        clearCounter(&levels[level][1]);
+    }
+#endif
+}
+
+/**
+ * @brief Copia os contadores da instrumentação.
+ *
+ * @param snapshot Ponteiro para a estrutura que recebe os contadores (zerada se a instrumentação não foi compilada).
+ */
+void ioStatsGet(IoStatsSnapshot *snapshot)
+{
+    memset(snapshot, 0, sizeof(IoStatsSnapshot));
+
+#ifdef TWO_THREE_IO_STATS
+    for (int op = 0; op < IO_STATS_OP_COUNT; op++)
+    {
+        snapshot->operations[op] = atomic_load_explicit(&operations[op], memory_order_relaxed);
+
+        for (int site = 0; site < IO_STATS_SITE_COUNT; site++)
+        {
+            snapshot->sites[op][site] = loadCounter(&sites[op][site]);
+        }
+    }
+
+    for (int level = 0; level < IO_STATS_MAX_LEVELS; level++)
+    {
+        snapshot->levels[level][0] = loadCounter(&levels[level][0]);
+        snapshot->levels[level][1] = loadCounter(&levels[level][1]);
+    }
+#endif
+}
+
+/**
+ * @brief Imprime uma linha do relatório com um contador e, se houver operações, as médias por operação.
+ */
+static void printCounter(FILE *output, const char *name, const IoStatsCounter *counter, long long operations)
+{
+    fprintf(output, "  %-22s %10lld chamadas %14lld bytes %12.3f ms", name, counter->calls, counter->bytes,
+            counter->nanoseconds / 1e6);
+
+    if (operations > 0)
+    {
+        fprintf(output, " | por operacao: %.2f chamadas, %.1f bytes, %.0f ns", (double)counter->calls / operations,
+                (double)counter->bytes / operations, (double)counter->nanoseconds / operations);
+    }
+
+    fprintf(output, "\n");
+}
+
+/**
+ * @brief Imprime os contadores da instrumentação por operação, por tipo de acesso e por nível da árvore.
+ *
+ * @param output Arquivo onde o relatório é impresso (por exemplo, `stdout`).
+ */
+void ioStatsPrint(FILE *output)
+{
+    static const char *operationNames[IO_STATS_OP_COUNT] = {"Outros", "Insercao", "Remocao", "Busca", "Alteracao"};
+    static const char *siteNames[IO_STATS_SITE_COUNT] = {"Leitura de nos",         "Gravacao de nos",
+                                                         "Leitura de cabecalhos",  "Gravacao de cabecalhos",
+                                                         "Leitura de registros",   "Gravacao de registros"};
+    IoStatsSnapshot snapshot;
+
+    if (!ioStatsEnabled())
+    {
+        fprintf(output, "Instrumentacao de E/S nao compilada (compile com TWO_THREE_IO_STATS definido).\n");
+        return;
+    }
+
+    ioStatsGet(&snapshot);
+
+    for (int op = 0; op < IO_STATS_OP_COUNT; op++)
+    {
+        int used = snapshot.operations[op] > 0;
+
+        for (int site = 0; !used && site < IO_STATS_SITE_COUNT; site++)
+        {
+            used = snapshot.sites[op][site].calls > 0;
+        }
+
+        if (!used)
+        {
+            continue;
+        }
+
+        // Os acessos fora de uma operação não têm médias por operação
+        long long count = op == IO_STATS_OP_OTHER ? 0 : snapshot.operations[op];
+
+        if (op == IO_STATS_OP_OTHER)
+        {
+            fprintf(output, "%s:\n", operationNames[op]);
+        }
+        else
+        {
+            fprintf(output, "%s: %lld operacoes\n", operationNames[op], count);
+        }
+
+        for (int site = 0; site < IO_STATS_SITE_COUNT; site++)
+        {
+            if (snapshot.sites[op][site].calls > 0)
+            {
+                printCounter(output, siteNames[site], &snapshot.sites[op][site], count);
+            }
+        }
+    }
+
+    fprintf(output, "Acessos a nos por nivel da arvore:\n");
+
+    for (int level = 0; level < IO_STATS_MAX_LEVELS; level++)
+    {
+        const IoStatsCounter *reads = &snapshot.levels[level][0];
+        const IoStatsCounter *writes = &snapshot.levels[level][1];
+
+        if (reads->calls > 0 || writes->calls > 0)
+        {
+            fprintf(output, "  Nivel %-2d %s %10lld leituras (%.3f ms) %10lld gravacoes (%.3f ms)\n", level,
+                    level == IO_STATS_MAX_LEVELS - 1 ? "ou mais" : "       ", reads->calls, reads->nanoseconds / 1e6,
+                    writes->calls, writes->nanoseconds / 1e6);
+        }
+    }
+}
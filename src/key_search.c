@@ -0,0 +1,129 @@
+/**
+ * @file key_search.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa a busca de uma chave no vetor ordenado de chaves de um nó.
+ *
+ * Cada comparação vetorial produz, em cada faixa, -1 para as chaves menores que a procurada e 0 para as demais; as
+ * máscaras são subtraídas de um acumulador vetorial, somado ao final (sem depender da instrução `popcnt`), e as chaves
+ * que não completam um vetor são comparadas uma a uma.
+ *
+ * @see key_search.h
+ */
+
+#include "key_search.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define KEY_SEARCH_IMPLEMENTATION "avx2"
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define KEY_SEARCH_IMPLEMENTATION "sse2"
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KEY_SEARCH_IMPLEMENTATION "neon"
+#else
+#define KEY_SEARCH_IMPLEMENTATION "scalar"
+#endif
+
+/**
+ * @brief Conta as chaves menores que `key` em um trecho ordenado curto, comparando várias chaves por instrução.
+ */
+static int countLess(const int *keys, int n, int key)
+{
+    int count = 0;
+    int i = 0;
+
+#if defined(__AVX2__)
+    __m256i needle = _mm256_set1_epi32(key);
+    __m256i total = _mm256_setzero_si256();
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(keys + i));
+
+        total = _mm256_sub_epi32(total, _mm256_cmpgt_epi32(needle, block));
+    }
+
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    count = _mm_cvtsi128_si32(half);
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128i needle = _mm_set1_epi32(key);
+    __m128i total = _mm_setzero_si128();
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(keys + i));
+
+        total = _mm_sub_epi32(total, _mm_cmpgt_epi32(needle, block));
+    }
+
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(1, 0, 3, 2)));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(2, 3, 0, 1)));
+    count = _mm_cvtsi128_si32(total);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    int32x4_t needle = vdupq_n_s32(key);
+    int32x4_t total = vdupq_n_s32(0);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        uint32x4_t less = vcltq_s32(vld1q_s32(keys + i), needle);
+
+        total = vsubq_s32(total, vreinterpretq_s32_u32(less));
+    }
+
+    count = vaddvq_s32(total);
+#endif
+
+    for (; i < n; i++)
+    {
+        count += keys[i] < key;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Retorna o número de chaves de um vetor ordenado menores que `key`.
+ *
+ * @param keys Chaves em ordem crescente.
+ * @param n Número de chaves.
+ * @param key Chave procurada.
+ *
+ * @return O índice da primeira chave maior ou igual a `key` (`n` se não houver).
+ */
+int keySearchLowerBound(const int *keys, int n, int key)
+{
+    int low = 0;
+
+    // Busca binária até restar um trecho curto o bastante para a contagem
+    while (n > KEY_SEARCH_LINEAR_WIDTH)
+    {
+        int half = n / 2;
+
+        if (keys[low + half] < key)
+        {
+            low += half + 1;
+            n -= half + 1;
+        }
+        else
+        {
+            n = half;
+        }
+    }
+
+    return low + countLess(keys + low, n, key);
+}
+
+/**
+ * @brief Retorna o nome da implementação escolhida na compilação ("avx2", "sse2", "neon" ou "scalar").
+ *
+ * @return O nome da implementação.
+ */
+const char *keySearchImplementation(void)
+{
+    return KEY_SEARCH_IMPLEMENTATION;
+}
@@ -0,0 +1,1310 @@
+/**
+ * @file library.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o handle da biblioteca, responsável pelos arquivos abertos e pelos cabeçalhos em memória.
+ *
+ * @see library.h
+ * @see file_manager.h
+ */
+
+#include "library.h"
+#include "file_manager.h"
+#include "node_cache.h"
+#include "storage.h"
+#include "page_allocator.h"
+#include "tree_lock.h"
+#include "tree_cursor.h"
+
+/**
+ * @brief Número de livros lidos de cada vez ao preencher os arquivos secundários.
+ */
+#define COLUMN_STORE_LOAD_BATCH 64
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Anexa os cabeçalhos e os alocadores dos arquivos de dados e de índices já abertos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (os arquivos são fechados).
+ */
+static int attachLibraryFiles(Library *library)
+{
+    if (attachFileHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader)) != 1 ||
+        attachFileHeader(library->indexFile, &library->indexHeader, sizeof(IndexFileHeader)) != 1 ||
+        attachDataAllocator(library->dataFile, &library->dataHeader) != 0 ||
+        attachIndexAllocator(library->indexFile, &library->indexHeader) != 0)
+    {
+        closeFile(&library->dataFile);
+        closeFile(&library->indexFile);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Inicializa os campos do handle que não dependem dos arquivos de dados e de índices.
+ */
+static void initLibraryHandle(Library *library, const char *dataFilename, const char *indexFilename)
+{
+    library->dataFile = NULL;
+    library->indexFile = NULL;
+    library->flushInterval = LIBRARY_DEFAULT_FLUSH_INTERVAL;
+    library->pendingOperations = 0;
+    library->authorIndex.file = NULL;
+    library->authorIndex.buckets = NULL;
+    library->titleIndex.file = NULL;
+    library->stats.file = NULL;
+    memset(&library->columns, 0, sizeof(ColumnStore));
+    library->wal.file = NULL;
+    library->walFilename[0] = '\0';
+    memset(&library->codeFilter, 0, sizeof(CodeFilter));
+    snprintf(library->dataFilename, sizeof(library->dataFilename), "%s", dataFilename);
+    snprintf(library->indexFilename, sizeof(library->indexFilename), "%s", indexFilename);
+    library->snapshotFilename[0] = '\0';
+    library->snapshotParts = 0;
+    library->staleParts = 0;
+
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        library->stats.tables[field].entries = NULL;
+    }
+}
+
+/**
+ * @brief Indica se um arquivo existe (pode ser aberto para leitura).
+ */
+static int fileExists(const char *filename)
+{
+    FILE *probe = fopen(filename, "rb");
+
+    if (probe == NULL)
+    {
+        return 0;
+    }
+
+    fclose(probe);
+    return 1;
+}
+
+/**
+ * @brief Abre (criando do zero) os arquivos de dados e de índices da biblioteca.
+ *
+ * Os arquivos são criados vazios, seus cabeçalhos são inicializados e anexados em memória, de modo que as
+ * operações seguintes não precisem reler nem regravar os cabeçalhos a cada chamada.
+ *
+ * @pre `library`, `dataFilename` e `indexFilename` não devem ser NULL.
+ *
+ * @post Os dois arquivos estão abertos em modo de leitura e escrita e seus cabeçalhos estão em memória.
+ *
+ * @param library Ponteiro para o handle a ser inicializado.
+ * @param dataFilename Nome do arquivo de dados.
+ * @param indexFilename Nome do arquivo de índices.
+ *
+ * @return 0 em caso de sucesso, -1 caso algum arquivo não possa ser aberto.
+ */
+int libraryOpen(Library *library, const char *dataFilename, const char *indexFilename)
+{
+    return libraryOpenWithOrder(library, dataFilename, indexFilename, TWO_THREE_TREE_ORDER);
+}
+
+/**
+ * @brief Abre (criando do zero) os arquivos da biblioteca, com o índice na ordem informada.
+ *
+ * Igual a `libraryOpen`, mas permite escolher a ordem do índice: `TWO_THREE_TREE_ORDER` mantém a árvore 2-3 e
+ * valores maiores (até `BPLUS_MAX_ORDER`) criam o índice no modo B+, com nós do tamanho de uma página.
+ *
+ * @param library Ponteiro para o handle a ser inicializado.
+ * @param dataFilename Nome do arquivo de dados.
+ * @param indexFilename Nome do arquivo de índices.
+ * @param indexOrder Ordem (número máximo de filhos por nó) do índice.
+ *
+ * @return 0 em caso de sucesso, -1 caso algum arquivo não possa ser aberto.
+ */
+int libraryOpenWithOrder(Library *library, const char *dataFilename, const char *indexFilename, int indexOrder)
+{
+    initLibraryHandle(library, dataFilename, indexFilename);
+
+    // Abre os arquivos em modo de leitura e escrita binária
+    library->dataFile = openFile(dataFilename, "w+b");
+    library->indexFile = openFile(indexFilename, "w+b");
+
+    if (library->dataFile == NULL || library->indexFile == NULL)
+    {
+        closeFile(&library->dataFile);
+        closeFile(&library->indexFile);
+        return -1;
+    }
+
+    // Inicializa os cabeçalhos e os mantém em memória a partir de agora
+    createBookDataFileHeader(library->dataFile);
+    createIndexFileHeaderWithOrder(library->indexFile, indexOrder);
+
+    if (attachLibraryFiles(library) != 0)
+    {
+        return -1;
+    }
+
+    // Os dois arquivos recebem a mesma marca, conferida por `libraryOpenExisting`
+    library->dataHeader.pairStamp = createFilePairStamp(0);
+    library->indexHeader.pairStamp = library->dataHeader.pairStamp;
+    saveHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader));
+    saveHeader(library->indexFile, &library->indexHeader, sizeof(IndexFileHeader));
+
+    return 0;
+}
+
+/**
+ * @brief Percorre os livros gravados no arquivo de dados, ignorando os registros livres.
+ *
+ * Os registros são lidos em grupos de `COLUMN_STORE_LOAD_BATCH`, com leitura antecipada do arquivo.
+ *
+ * @param add Função chamada com cada livro e a sua posição no arquivo de dados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura ou se `add` falhar.
+ */
+static int loadStoredBooks(Library *library, int (*add)(Library *library, const Book *book, int position))
+{
+    Book books[COLUMN_STORE_LOAD_BATCH];
+    int rows = library->dataHeader.firstEmptyPosition;
+    StorageReadAhead readAhead;
+
+    storageReadAheadStart(&readAhead, library->dataFile, sizeof(BookDataFileHeader),
+                          sizeof(BookDataFileHeader) + (long)rows * sizeof(Book));
+
+    for (int first = 0; first < rows; first += COLUMN_STORE_LOAD_BATCH)
+    {
+        int count = rows - first < COLUMN_STORE_LOAD_BATCH ? rows - first : COLUMN_STORE_LOAD_BATCH;
+
+        storageReadAheadAdvance(&readAhead, sizeof(BookDataFileHeader) + (long)first * sizeof(Book));
+
+        if (storageRead(library->dataFile, sizeof(BookDataFileHeader) + (long)first * sizeof(Book), books, sizeof(Book) * count) != 0)
+        {
+            fprintf(stderr, "Erro ao ler os livros do arquivo de dados.\n");
+            return -1;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            if (books[i].code != -1 && add(library, &books[i], first + i) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Soma o estoque de um livro ao total do cabeçalho de dados (usada com `loadStoredBooks`).
+ */
+static int addStoredStock(Library *library, const Book *book, int position)
+{
+    (void)position;
+    library->dataHeader.stockTotal += book->stock_quantity;
+    return 0;
+}
+
+/**
+ * @brief Substitui um arquivo da biblioteca pelo arquivo de mesmo nome com o sufixo `LIBRARY_SWAP_SUFFIX`, se o
+ *        cabeçalho deste tiver a marca de par informada.
+ *
+ * @param file Ponteiro para o arquivo aberto, reaberto sobre o novo arquivo.
+ * @param filename Nome do arquivo.
+ * @param header Cabeçalho do arquivo, substituído pelo do novo arquivo.
+ * @param headerSize Tamanho do cabeçalho.
+ * @param pairStamp Marca de par esperada.
+ * @param stampOffset Posição do campo `pairStamp` no cabeçalho.
+ *
+ * @return 1 se o arquivo foi substituído, 0 se não houver um novo arquivo com a marca, -1 em caso de erro.
+ */
+static int takeSwapFile(FILE **file, const char *filename, void *header, size_t headerSize, unsigned int pairStamp,
+                        size_t stampOffset)
+{
+    char swapFilename[LIBRARY_MAX_FILENAME + sizeof(LIBRARY_SWAP_SUFFIX)];
+    unsigned int swapStamp;
+
+    snprintf(swapFilename, sizeof(swapFilename), "%s%s", filename, LIBRARY_SWAP_SUFFIX);
+
+    FILE *swapFile = fopen(swapFilename, "rb");
+
+    if (swapFile == NULL)
+    {
+        return 0;
+    }
+
+    // Apenas a marca do novo arquivo é lida; o cabeçalho completo é validado depois da troca
+    int found = fseek(swapFile, (long)stampOffset, SEEK_SET) == 0 &&
+                fread(&swapStamp, sizeof(swapStamp), 1, swapFile) == 1 && swapStamp == pairStamp;
+
+    fclose(swapFile);
+
+    if (!found)
+    {
+        return 0;
+    }
+
+    closeFile(file);
+
+    if (rename(swapFilename, filename) != 0)
+    {
+        perror("Erro ao concluir a troca de arquivos interrompida");
+        return -1;
+    }
+
+    *file = openFile(filename, "r+b");
+
+    if (*file == NULL || readFileHeader(*file, header, headerSize) != 1)
+    {
+        return -1;
+    }
+
+    fprintf(stderr, "Aviso: troca de arquivos interrompida concluída com '%s'.\n", swapFilename);
+    return 1;
+}
+
+/**
+ * @brief Reabre os arquivos de dados e de índices de uma sessão anterior.
+ *
+ * Os cabeçalhos dos dois arquivos são validados (identificador, versão, tamanho dos registros e dos nós e
+ * consistência com o tamanho do arquivo) antes de serem anexados; a ordem do índice é a gravada no arquivo. Os dois
+ * cabeçalhos devem ter a mesma marca de par (`pairStamp`): se não tiverem, a troca interrompida de
+ * `librarySwapFiles` é concluída com o arquivo de sufixo `LIBRARY_SWAP_SUFFIX` que completa o par. Nenhum
+ * livro nem nó é lido: as listas de livres são convertidas nos mapas de bits do alocador e os nós são lidos sob
+ * demanda. A exceção é um total em estoque negativo no cabeçalho de dados, recalculado a partir dos livros gravados.
+ *
+ * @pre Se a sessão anterior usou o log, `libraryRecover` já deve ter sido chamada.
+ *
+ * @param library Ponteiro para o handle a ser inicializado.
+ * @param dataFilename Nome do arquivo de dados.
+ * @param indexFilename Nome do arquivo de índices.
+ *
+ * @return 0 se os arquivos foram reabertos, 1 se nenhum dos dois existir (nada é aberto; use `libraryOpen`), -1 se
+ *         apenas um deles existir, algum cabeçalho for inválido, os arquivos não formarem um par ou em caso de erro.
+ */
+int libraryOpenExisting(Library *library, const char *dataFilename, const char *indexFilename)
+{
+    int dataExists = fileExists(dataFilename);
+    int indexExists = fileExists(indexFilename);
+
+    initLibraryHandle(library, dataFilename, indexFilename);
+
+    if (!dataExists && !indexExists)
+    {
+        return 1; // Primeira sessão: os arquivos ainda não foram criados
+    }
+
+    // Um arquivo sem o outro não pode ser recriado sem perder os livros ou o índice
+    if (!dataExists || !indexExists)
+    {
+        fprintf(stderr, "Erro: o arquivo '%s' não existe.\n", dataExists ? indexFilename : dataFilename);
+        return -1;
+    }
+
+    library->dataFile = openFile(dataFilename, "r+b");
+    library->indexFile = openFile(indexFilename, "r+b");
+
+    if (library->dataFile == NULL || library->indexFile == NULL ||
+        readFileHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader)) != 1 ||
+        readFileHeader(library->indexFile, &library->indexHeader, sizeof(IndexFileHeader)) != 1)
+    {
+        closeFile(&library->dataFile);
+        closeFile(&library->indexFile);
+        return -1;
+    }
+
+    // Marcas diferentes indicam uma troca interrompida: falta renomear o novo índice ou o novo arquivo de dados
+    if (library->dataHeader.pairStamp != library->indexHeader.pairStamp)
+    {
+        int taken = takeSwapFile(&library->indexFile, indexFilename, &library->indexHeader, sizeof(IndexFileHeader),
+                                 library->dataHeader.pairStamp, offsetof(IndexFileHeader, pairStamp));
+
+        if (taken == 0)
+        {
+            taken = takeSwapFile(&library->dataFile, dataFilename, &library->dataHeader, sizeof(BookDataFileHeader),
+                                 library->indexHeader.pairStamp, offsetof(BookDataFileHeader, pairStamp));
+        }
+
+        if (taken != 1)
+        {
+            if (taken == 0)
+            {
+                fprintf(stderr, "Erro: os arquivos '%s' e '%s' não formam um par.\n", dataFilename, indexFilename);
+            }
+            closeFile(&library->dataFile);
+            closeFile(&library->indexFile);
+            return -1;
+        }
+    }
+
+    // Os cabeçalhos são validados antes de o alocador percorrer as listas de livres gravadas
+    if (checkBookDataFileHeader(library->dataFile, &library->dataHeader) != 0 ||
+        checkIndexFileHeader(library->indexFile, &library->indexHeader) != 0)
+    {
+        closeFile(&library->dataFile);
+        closeFile(&library->indexFile);
+        return -1;
+    }
+
+    if (attachLibraryFiles(library) != 0)
+    {
+        return -1;
+    }
+
+    // O total em estoque é derivado dos livros: um valor impossível é recalculado em vez de recusar os arquivos
+    if (library->dataHeader.stockTotal < 0)
+    {
+        long long stored = library->dataHeader.stockTotal;
+
+        fprintf(stderr, "Aviso: total em estoque inválido no arquivo '%s'; ele será recalculado.\n", dataFilename);
+        library->dataHeader.stockTotal = 0;
+
+        if (loadStoredBooks(library, addStoredStock) != 0)
+        {
+            library->dataHeader.stockTotal = stored; // Os arquivos são fechados sem alterar o cabeçalho
+            closeFile(&library->dataFile);
+            closeFile(&library->indexFile);
+            return -1;
+        }
+
+        saveHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader));
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Passa a usar o snapshot da biblioteca (veja `library_snapshot.h`).
+ *
+ * O snapshot gravado no último fechamento é lido e apagado. Se ele corresponder aos arquivos de dados e de índices
+ * abertos, as próximas chamadas de `libraryOpenAuthorIndex`, `libraryOpenTitleIndex`, `libraryOpenStats` e
+ * `libraryOpenColumns` reabrem os arquivos secundários registrados nele em vez de reconstruí-los. Em
+ * `libraryClose`, um novo snapshot é gravado com o estado final, sem os arquivos marcados com `libraryMarkStale`.
+ *
+ * @pre A biblioteca deve ter sido aberta, e os arquivos secundários ainda não.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo do snapshot.
+ *
+ * @return 1 se o snapshot corresponde aos arquivos abertos, 0 se não existir ou não corresponder, -1 se não puder
+ *         ser apagado.
+ */
+int libraryUseSnapshot(Library *library, const char *filename)
+{
+    int status = librarySnapshotRead(filename, &library->snapshot);
+
+    snprintf(library->snapshotFilename, sizeof(library->snapshotFilename), "%s", filename);
+    library->snapshotParts = 0;
+
+    if (status == 0)
+    {
+        return 0; // Nenhum snapshot: os arquivos secundários serão reconstruídos
+    }
+
+    if (status == -1)
+    {
+        fprintf(stderr, "Aviso: snapshot '%s' inválido; os arquivos secundários serão reconstruídos.\n", filename);
+    }
+    else if (memcmp(&library->snapshot.dataHeader, &library->dataHeader, sizeof(BookDataFileHeader)) != 0 ||
+             memcmp(&library->snapshot.indexHeader, &library->indexHeader, sizeof(IndexFileHeader)) != 0)
+    {
+        fprintf(stderr, "Aviso: o snapshot '%s' não corresponde aos arquivos da biblioteca; os arquivos "
+                        "secundários serão reconstruídos.\n", filename);
+        status = 0;
+    }
+    else
+    {
+        library->snapshotParts = library->snapshot.parts;
+    }
+
+    // Uma sessão interrompida não pode deixar um snapshot que descreva arquivos alterados depois dele
+    if (remove(filename) != 0)
+    {
+        perror("Erro ao apagar o snapshot");
+        library->snapshotParts = 0;
+        return -1;
+    }
+
+    return status == 1 ? 1 : 0;
+}
+
+/**
+ * @brief Indica se o arquivo secundário informado pode ser reaberto, e o retira do snapshot.
+ *
+ * Cada arquivo só é aproveitado uma vez: uma nova abertura na mesma sessão o recria.
+ */
+static int takeSnapshotPart(Library *library, int part)
+{
+    int available = (library->snapshotParts & part) != 0;
+
+    library->snapshotParts &= ~part;
+    return available;
+}
+
+/**
+ * @brief Calcula o cabeçalho que `bookStatsFlush` grava para as estatísticas em memória.
+ */
+static void statsHeaderOf(const BookStats *stats, BookStatsHeader *header)
+{
+    for (int field = 0; field < BOOK_STATS_FIELDS; field++)
+    {
+        header->counts[field] = 0;
+
+        for (int i = 0; i < stats->tables[field].capacity; i++)
+        {
+            if (stats->tables[field].entries[i].books > 0)
+            {
+                header->counts[field]++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Acrescenta um livro gravado ao índice por autor.
+ */
+static int addAuthorEntry(Library *library, const Book *book, int position)
+{
+    return authorIndexInsert(&library->authorIndex, book->author, position);
+}
+
+/**
+ * @brief Acrescenta um livro gravado ao índice por título.
+ */
+static int addTitleEntry(Library *library, const Book *book, int position)
+{
+    return titleIndexInsert(&library->titleIndex, book->title, position);
+}
+
+/**
+ * @brief Contabiliza um livro gravado nas estatísticas.
+ */
+static int addStatsEntry(Library *library, const Book *book, int position)
+{
+    (void)position;
+    return bookStatsAddBook(&library->stats, book);
+}
+
+/**
+ * @brief Acrescenta um livro gravado às colunas.
+ */
+static int addColumnsEntry(Library *library, const Book *book, int position)
+{
+    return columnStoreSet(&library->columns, position, book);
+}
+
+/**
+ * @brief Abre o índice secundário por autor da biblioteca.
+ *
+ * Com o índice aberto, `addBookAux` e `removeBook` passam a mantê-lo atualizado e `searchByAuthor` o utiliza
+ * automaticamente no lugar da leitura sequencial do arquivo de dados. O arquivo registrado no snapshot é
+ * reaproveitado; caso contrário, o índice é criado e preenchido com os livros já gravados no arquivo de dados.
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen` ou `libraryOpenExisting`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo do índice de autores.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenAuthorIndex(Library *library, const char *filename)
+{
+    authorIndexClose(&library->authorIndex);
+    library->staleParts &= ~LIBRARY_SNAPSHOT_AUTHOR_INDEX;
+
+    if (takeSnapshotPart(library, LIBRARY_SNAPSHOT_AUTHOR_INDEX))
+    {
+        if (authorIndexOpen(&library->authorIndex, filename) == 0 &&
+            memcmp(&library->authorIndex.header, &library->snapshot.authorHeader, sizeof(AuthorIndexHeader)) == 0)
+        {
+            return 0;
+        }
+
+        authorIndexClose(&library->authorIndex);
+        fprintf(stderr, "Aviso: o índice de autores '%s' será reconstruído.\n", filename);
+    }
+
+    if (authorIndexCreate(&library->authorIndex, filename, AUTHOR_INDEX_DEFAULT_BUCKETS) != 0)
+    {
+        return -1;
+    }
+
+    if (loadStoredBooks(library, addAuthorEntry) != 0 || authorIndexFlush(&library->authorIndex) != 0)
+    {
+        authorIndexClose(&library->authorIndex);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Abre o índice secundário ordenado por título da biblioteca.
+ *
+ * Com o índice aberto, `addBookAux` e `removeBook` passam a mantê-lo atualizado e `searchByTitle` e
+ * `searchByTitlePrefix` o utilizam automaticamente no lugar da leitura sequencial do arquivo de dados. O arquivo
+ * registrado no snapshot é reaproveitado; caso contrário, o índice é criado e preenchido com os livros já gravados.
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen` ou `libraryOpenExisting`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo do índice de títulos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenTitleIndex(Library *library, const char *filename)
+{
+    titleIndexClose(&library->titleIndex);
+    library->staleParts &= ~LIBRARY_SNAPSHOT_TITLE_INDEX;
+
+    if (takeSnapshotPart(library, LIBRARY_SNAPSHOT_TITLE_INDEX))
+    {
+        if (titleIndexOpen(&library->titleIndex, filename) == 0 &&
+            memcmp(&library->titleIndex.header, &library->snapshot.titleHeader, sizeof(TitleIndexHeader)) == 0)
+        {
+            return 0;
+        }
+
+        titleIndexClose(&library->titleIndex);
+        fprintf(stderr, "Aviso: o índice de títulos '%s' será reconstruído.\n", filename);
+    }
+
+    if (titleIndexCreate(&library->titleIndex, filename) != 0)
+    {
+        return -1;
+    }
+
+    if (loadStoredBooks(library, addTitleEntry) != 0 || titleIndexFlush(&library->titleIndex) != 0)
+    {
+        titleIndexClose(&library->titleIndex);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Abre o arquivo de estatísticas da biblioteca (contadores por autor, editora e ano).
+ *
+ * Com as estatísticas abertas, `addBookAux` e `removeBook` passam a manter os contadores atualizados e os totais
+ * por autor, por editora e por ano são consultados sem leitura do arquivo de dados. O arquivo registrado no snapshot
+ * é reaproveitado; caso contrário, os contadores são calculados com os livros já gravados.
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen` ou `libraryOpenExisting`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo de estatísticas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenStats(Library *library, const char *filename)
+{
+    bookStatsClose(&library->stats);
+    library->staleParts &= ~LIBRARY_SNAPSHOT_STATS;
+
+    if (takeSnapshotPart(library, LIBRARY_SNAPSHOT_STATS))
+    {
+        BookStatsHeader header;
+
+        if (bookStatsOpen(&library->stats, filename) == 0)
+        {
+            statsHeaderOf(&library->stats, &header);
+
+            if (memcmp(&header, &library->snapshot.statsHeader, sizeof(BookStatsHeader)) == 0)
+            {
+                return 0;
+            }
+        }
+
+        bookStatsClose(&library->stats);
+        fprintf(stderr, "Aviso: as estatísticas '%s' serão reconstruídas.\n", filename);
+    }
+
+    if (bookStatsCreate(&library->stats, filename) != 0)
+    {
+        return -1;
+    }
+
+    if (loadStoredBooks(library, addStatsEntry) != 0 || bookStatsFlush(&library->stats) != 0)
+    {
+        bookStatsClose(&library->stats);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Abre o arquivo de colunas da biblioteca (código, ano, edição, estoque, preço e os identificadores do autor e
+ *        da editora de cada posição).
+ *
+ * O arquivo registrado no snapshot é reaproveitado, com os seus dicionários; caso contrário, as colunas e os
+ * dicionários de autores e editoras são preenchidos com os livros já gravados no arquivo de dados.
+ * Com as colunas abertas, as inserções, remoções e alterações de estoque passam a mantê-las atualizadas, e as
+ * agregações (como os totais por ano, autor ou editora sem as estatísticas abertas e as estatísticas de preço)
+ * percorrem as colunas em vez do arquivo de dados.
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo de colunas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenColumns(Library *library, const char *filename)
+{
+    ColumnStore *columns = &library->columns;
+
+    columnStoreClose(columns);
+    library->staleParts &= ~LIBRARY_SNAPSHOT_COLUMNS;
+
+    if (takeSnapshotPart(library, LIBRARY_SNAPSHOT_COLUMNS))
+    {
+        if (columnStoreOpen(columns, filename) == 0 &&
+            memcmp(&columns->header, &library->snapshot.columnsHeader, sizeof(ColumnStoreHeader)) == 0 &&
+            memcmp(&columns->authors.header, &library->snapshot.authorsHeader, sizeof(StringDictionaryHeader)) == 0 &&
+            memcmp(&columns->publishers.header, &library->snapshot.publishersHeader, sizeof(StringDictionaryHeader)) == 0)
+        {
+            return 0;
+        }
+
+        columnStoreClose(columns);
+        fprintf(stderr, "Aviso: as colunas '%s' serão reconstruídas.\n", filename);
+    }
+
+    if (columnStoreCreate(columns, filename) != 0)
+    {
+        return -1;
+    }
+
+    if (loadStoredBooks(library, addColumnsEntry) != 0)
+    {
+        columnStoreClose(columns);
+        return -1;
+    }
+
+    return columnStoreFlush(columns);
+}
+
+/**
+ * @brief Marca um arquivo secundário aberto como desatualizado, depois de uma falha ao mantê-lo.
+ *
+ * O arquivo continua aberto até o fim da sessão, mas fica fora do snapshot gravado em `libraryClose`, de modo que a
+ * próxima abertura o reconstrói a partir do arquivo de dados. Um aviso é exibido na primeira marcação.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param part Arquivo secundário (`LIBRARY_SNAPSHOT_AUTHOR_INDEX`, `LIBRARY_SNAPSHOT_TITLE_INDEX`,
+ *             `LIBRARY_SNAPSHOT_STATS` ou `LIBRARY_SNAPSHOT_COLUMNS`).
+ *
+ * @note Uma nova abertura do arquivo na mesma sessão (que o reconstrói ou reaproveita) desfaz a marcação.
+ */
+void libraryMarkStale(Library *library, int part)
+{
+    if (library->staleParts & part)
+    {
+        return;
+    }
+
+    library->staleParts |= part;
+
+    const char *name = part == LIBRARY_SNAPSHOT_AUTHOR_INDEX ? "o índice de autores"
+                       : part == LIBRARY_SNAPSHOT_TITLE_INDEX ? "o índice de títulos"
+                       : part == LIBRARY_SNAPSHOT_STATS       ? "as estatísticas"
+                                                              : "as colunas";
+
+    fprintf(stderr, "Aviso: falha ao atualizar %s; o arquivo será reconstruído na próxima abertura.\n", name);
+}
+
+/**
+ * @brief Cria o log de escrita antecipada dos arquivos de dados e de índices.
+ *
+ * Com o log aberto, cada inserção, remoção e alteração de estoque é executada como uma transação registrada no
+ * log antes de chegar aos arquivos, e `libraryCommit` passa a funcionar como checkpoint (veja `wal.h`).
+ *
+ * @pre A biblioteca deve ter sido aberta com `libraryOpen`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param filename Nome do arquivo de log.
+ * @param syncWindowMs Janela (em milissegundos) do commit em grupo; 0 sincroniza o log a cada operação.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryOpenWal(Library *library, const char *filename, int syncWindowMs)
+{
+    FILE *files[] = {library->dataFile, library->indexFile};
+
+    walClose(&library->wal);
+
+    // O log começa vazio: o estado atual dos arquivos é o ponto de partida da recuperação
+    if (libraryCommit(library) != 0 || storageSync(library->dataFile) != 0 || storageSync(library->indexFile) != 0)
+    {
+        return -1;
+    }
+
+    if (walCreate(&library->wal, filename, files, 2, syncWindowMs) != 0)
+    {
+        return -1;
+    }
+
+    snprintf(library->walFilename, sizeof(library->walFilename), "%s", filename);
+    return 0;
+}
+
+/**
+ * @brief Inicia a transação de uma operação de escrita.
+ *
+ * Sem log aberto, a chamada não tem efeito.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ */
+void libraryBeginTransaction(Library *library)
+{
+    if (library->wal.file != NULL && !library->wal.active)
+    {
+        library->transactionDataHeader = library->dataHeader;
+        library->transactionIndexHeader = library->indexHeader;
+        pageAllocatorBeginTransaction(library->dataFile);
+        pageAllocatorBeginTransaction(library->indexFile);
+        walBegin(&library->wal);
+    }
+}
+
+/**
+ * @brief Confirma a transação corrente.
+ *
+ * Os nós modificados são gravados (e registrados no log) e as imagens dos cabeçalhos em memória são acrescentadas
+ * ao log antes do registro de commit. Sem log aberto, a chamada não tem efeito.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int libraryCommitTransaction(Library *library)
+{
+    Wal *wal = &library->wal;
+
+    if (wal->file == NULL || !wal->active)
+    {
+        return 0;
+    }
+
+    int result = 0;
+
+    // Sem o registro de commit, a transação é descartada; com ele (falha apenas no fsync), ela já está confirmada
+    if (nodeCacheFlush(library->indexFile) != 0 ||
+        walLogImage(wal, library->dataFile, 0, &library->dataHeader, sizeof(BookDataFileHeader)) != 0 ||
+        walLogImage(wal, library->indexFile, 0, &library->indexHeader, sizeof(IndexFileHeader)) != 0 ||
+        walCommit(wal) != 0)
+    {
+        libraryAbortTransaction(library);
+        result = -1;
+    }
+
+    pageAllocatorEndTransaction(library->dataFile);
+    pageAllocatorEndTransaction(library->indexFile);
+
+    return result;
+}
+
+/**
+ * @brief Descarta a transação corrente.
+ *
+ * As gravações retidas pelo log, os nós modificados no cache, as alocações e liberações de unidades e os cabeçalhos
+ * em memória voltam ao estado do início da transação. Sem log aberto (ou sem transação aberta), a chamada não tem
+ * efeito.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @note Os índices secundários, as estatísticas e as colunas não são restaurados: as operações descartam a transação
+ *       antes de alterá-los.
+ */
+void libraryAbortTransaction(Library *library)
+{
+    if (library->wal.file == NULL || !library->wal.active)
+    {
+        return;
+    }
+
+    walAbort(&library->wal);
+
+    // Com o log aberto, o cache não guarda nós modificados de transações anteriores (o commit os grava)
+    nodeCacheInvalidate(library->indexFile);
+
+    pageAllocatorRollback(library->dataFile);
+    pageAllocatorRollback(library->indexFile);
+
+    library->dataHeader = library->transactionDataHeader;
+    library->indexHeader = library->transactionIndexHeader;
+    saveHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader));
+    saveHeader(library->indexFile, &library->indexHeader, sizeof(IndexFileHeader));
+}
+
+/**
+ * @brief Aplica aos arquivos da biblioteca o log deixado por uma sessão interrompida.
+ *
+ * Deve ser chamada antes de abrir a biblioteca cujos arquivos já existem.
+ *
+ * @param dataFilename Nome do arquivo de dados.
+ * @param indexFilename Nome do arquivo de índices.
+ * @param walFilename Nome do arquivo de log.
+ *
+ * @return O número de transações refeitas (0 se não houver log), ou -1 em caso de erro.
+ */
+int libraryRecover(const char *dataFilename, const char *indexFilename, const char *walFilename)
+{
+    FILE *probe = fopen(walFilename, "rb");
+
+    if (probe == NULL)
+    {
+        return 0; // Nenhum log a recuperar
+    }
+    fclose(probe);
+
+    FILE *files[2];
+
+    files[0] = openFile(dataFilename, "r+b");
+    files[1] = openFile(indexFilename, "r+b");
+
+    if (files[0] == NULL || files[1] == NULL)
+    {
+        closeFile(&files[0]);
+        closeFile(&files[1]);
+        return -1;
+    }
+
+    int result = walRecover(walFilename, files, 2);
+
+    if (closeFile(&files[0]) != 0 || closeFile(&files[1]) != 0)
+    {
+        result = -1;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Substitui os arquivos de dados e de índices da biblioteca pelos arquivos informados.
+ *
+ * Os arquivos atuais são fechados, os novos são renomeados sobre eles (`rename`, atômico para cada arquivo) e
+ * reabertos, com os cabeçalhos e os alocadores anexados novamente. O mapeamento em memória, o acesso concorrente e o
+ * log, se estavam em uso, são restabelecidos sobre os novos arquivos.
+ *
+ * @pre As alterações pendentes já devem ter sido gravadas com `libraryCommit`. Os novos arquivos devem estar
+ *      completos, fechados e sincronizados com o dispositivo, e os seus cabeçalhos devem ter a mesma marca de par
+ *      (`pairStamp`), diferente da dos arquivos atuais.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param dataFilename Nome do novo arquivo de dados.
+ * @param indexFilename Nome do novo arquivo de índices.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ *
+ * @note As duas renomeações não são atômicas em conjunto. Uma interrupção entre elas deixa arquivos com marcas de par
+ *       diferentes, que `libraryOpenExisting` recusa ou, se os novos arquivos tiverem os nomes atuais com o sufixo
+ *       `LIBRARY_SWAP_SUFFIX`, completa com a renomeação que faltou.
+ */
+int librarySwapFiles(Library *library, const char *dataFilename, const char *indexFilename)
+{
+    int mapped = storageIsMapped(library->dataFile);
+    int concurrent = treeLockIsEnabled(library->indexFile);
+    int logged = library->wal.file != NULL;
+    int syncWindowMs = library->wal.syncWindowMs;
+    int result = 0;
+
+    // O log observa os arquivos atuais e é recriado sobre os novos
+    if (walClose(&library->wal) != 0 || closeFile(&library->dataFile) != 0 || closeFile(&library->indexFile) != 0)
+    {
+        result = -1;
+    }
+
+    // O índice só é trocado depois do arquivo de dados para o qual foi construído
+    if (rename(dataFilename, library->dataFilename) != 0)
+    {
+        perror("Erro ao substituir o arquivo de dados");
+        result = -1;
+    }
+    else if (rename(indexFilename, library->indexFilename) != 0)
+    {
+        perror("Erro ao substituir o arquivo de índices");
+        result = -1;
+    }
+
+    library->dataFile = openFile(library->dataFilename, "r+b");
+    library->indexFile = openFile(library->indexFilename, "r+b");
+
+    if (library->dataFile == NULL || library->indexFile == NULL)
+    {
+        closeFile(&library->dataFile);
+        closeFile(&library->indexFile);
+        return -1;
+    }
+
+    if (attachLibraryFiles(library) != 0)
+    {
+        return -1;
+    }
+
+    if (mapped)
+    {
+        libraryUseMappedStorage(library);
+    }
+
+    if (concurrent && libraryEnableConcurrency(library) != 0)
+    {
+        result = -1;
+    }
+
+    if (logged && libraryOpenWal(library, library->walFilename, syncWindowMs) != 0)
+    {
+        result = -1;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Passa a acessar os arquivos de dados e de índices por meio de mapeamentos em memória.
+ *
+ * Depois desta chamada, as leituras e gravações de livros, nós e cabeçalhos se tornam cópias de memória
+ * (veja `storage.h`). Os índices secundários continuam sendo acessados com `stdio`.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 se o mapeamento não estiver disponível. Em caso de erro, os arquivos
+ *         continuam sendo acessados com `stdio`.
+ */
+int libraryUseMappedStorage(Library *library)
+{
+    if (storageMap(library->dataFile) != 0 || storageMap(library->indexFile) != 0)
+    {
+        storageUnmap(library->dataFile);
+        storageUnmap(library->indexFile);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Liga o acesso concorrente à biblioteca: várias threads podem ler livros ao mesmo tempo.
+ *
+ * Os arquivos de dados e de índices passam a ser acessados com leituras e gravações posicionais (`pread`/`pwrite`),
+ * que não dependem da posição corrente do `FILE*`, e o índice recebe uma trava de leitura e escrita (veja
+ * `tree_lock.h`). As buscas (`twoThreeTreeSearch`, `readBookRecord` e os cursores) obtêm a trava para leitura; as
+ * inserções, remoções, alterações de estoque e gravações da biblioteca a obtêm para escrita.
+ *
+ * @pre Nenhuma outra thread pode estar usando a biblioteca.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (o acesso concorrente continua desligado).
+ *
+ * @note Os índices secundários, as estatísticas e as colunas não são protegidos pela trava e só podem ser consultados
+ *       sem gravações simultâneas.
+ */
+int libraryEnableConcurrency(Library *library)
+{
+    if (storageSetPositional(library->dataFile, 1) != 0 || storageSetPositional(library->indexFile, 1) != 0 ||
+        treeLockEnable(library->indexFile) != 0)
+    {
+        libraryDisableConcurrency(library);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Desliga o acesso concorrente à biblioteca.
+ *
+ * @pre Nenhuma outra thread pode estar usando a biblioteca.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ */
+void libraryDisableConcurrency(Library *library)
+{
+    treeLockDisable(library->indexFile);
+    storageSetPositional(library->dataFile, 0);
+    storageSetPositional(library->indexFile, 0);
+}
+
+/**
+ * @brief Liga o filtro de códigos, que permite às inserções dispensar a busca prévia por duplicados.
+ *
+ * O filtro (veja `code_filter.h`) é montado em memória com os códigos presentes no índice. A partir daí, uma inserção
+ * cujo código certamente não está no índice não percorre a árvore antes de gravar o livro; apenas os códigos que
+ * podem estar no índice (os duplicados e cerca de 1% dos novos) são procurados. As inserções, remoções e a carga em
+ * lote mantêm o filtro atualizado, e ele é reconstruído com o dobro da capacidade quando o número de códigos a
+ * excede. Chamar a função com o filtro já ligado o reconstrói.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param expectedKeys Número de códigos previstos (o filtro usa cerca de 5 bytes por código), ou 0 para usar o
+ *                     dobro do número de livros atual.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (o filtro fica desligado).
+ */
+int libraryEnableCodeFilter(Library *library, long expectedKeys)
+{
+    TreeCursor cursor;
+    int key, position;
+    int status = -1;
+
+    libraryDisableCodeFilter(library);
+
+    if (expectedKeys <= 0)
+    {
+        expectedKeys = 2L * library->dataHeader.bookCount;
+    }
+
+    if (codeFilterCreate(&library->codeFilter, expectedKeys) != 0)
+    {
+        return -1;
+    }
+
+    // Percorre todas as chaves do índice em ordem
+    if (treeRangeBegin(&cursor, library->indexFile, INT_MIN, INT_MAX) == 0)
+    {
+        while ((status = treeRangeNext(&cursor, &key, &position)) == 1)
+        {
+            codeFilterAdd(&library->codeFilter, key);
+        }
+    }
+
+    treeRangeEnd(&cursor);
+
+    if (status == -1)
+    {
+        fprintf(stderr, "Erro ao montar o filtro de códigos.\n");
+        libraryDisableCodeFilter(library);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Desliga o filtro de códigos e libera a sua memória.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ */
+void libraryDisableCodeFilter(Library *library)
+{
+    codeFilterDestroy(&library->codeFilter);
+}
+
+/**
+ * @brief Define o intervalo entre gravações automáticas dos cabeçalhos.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ * @param interval Número de operações entre gravações, ou 0 para gravar apenas em `libraryCommit`/`libraryClose`.
+ */
+void librarySetFlushInterval(Library *library, int interval)
+{
+    library->flushInterval = interval < 0 ? 0 : interval;
+}
+
+/**
+ * @brief Registra o término de uma operação de escrita na biblioteca.
+ *
+ * Se o intervalo de gravação estiver configurado e tiver sido atingido, os cabeçalhos e os nós modificados
+ * são gravados no disco.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 se a gravação automática falhar.
+ */
+int libraryEndOperation(Library *library)
+{
+    int result = 0;
+
+    if (treeLockWrite(library->indexFile) != 0)
+    {
+        return -1;
+    }
+
+    library->pendingOperations++;
+
+    if (library->flushInterval > 0 && library->pendingOperations >= library->flushInterval)
+    {
+        result = libraryCommit(library);
+    }
+
+    treeUnlock(library->indexFile);
+    return result;
+}
+
+/**
+ * @brief Grava no disco os cabeçalhos e os nós modificados da biblioteca.
+ *
+ * As listas de nós e de registros livres do alocador também são gravadas, assim como os cabeçalhos dos índices
+ * secundários abertos, as estatísticas e as colunas. Com o log aberto, os
+ * arquivos são sincronizados com o dispositivo e o log é esvaziado (checkpoint). Com o acesso concorrente ligado, a
+ * gravação é feita com a trava de escrita do índice.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 se alguma gravação falhar.
+ */
+int libraryCommit(Library *library)
+{
+    int result = 0;
+
+    // Com o acesso concorrente ligado, nenhuma leitura pode ocorrer enquanto os nós e os cabeçalhos são gravados
+    if (treeLockWrite(library->indexFile) != 0)
+    {
+        return -1;
+    }
+
+    // As gravações retidas pelo log chegam aos arquivos antes das listas livres, que não podem ser sobrescritas depois
+    if (library->wal.file != NULL && walSync(&library->wal) != 0)
+    {
+        result = -1;
+    }
+
+    // Os nós do cache são gravados antes da lista de nós livres, que não pode ser sobrescrita depois
+    if (nodeCacheFlush(library->indexFile) != 0)
+    {
+        result = -1;
+    }
+
+    if (pageAllocatorFlush(library->dataFile) != 0 || pageAllocatorFlush(library->indexFile) != 0)
+    {
+        result = -1;
+    }
+
+    // A cabeça das listas de unidades livres foi atualizada pelo alocador
+    saveHeader(library->dataFile, &library->dataHeader, sizeof(BookDataFileHeader));
+    saveHeader(library->indexFile, &library->indexHeader, sizeof(IndexFileHeader));
+
+    if (flushFileHeader(library->dataFile) != 1 || flushFileHeader(library->indexFile) != 1)
+    {
+        result = -1;
+    }
+
+    if (authorIndexFlush(&library->authorIndex) != 0 || titleIndexFlush(&library->titleIndex) != 0 ||
+        bookStatsFlush(&library->stats) != 0 || columnStoreFlush(&library->columns) != 0)
+    {
+        result = -1;
+    }
+
+    storageFlush(library->dataFile);
+    library->pendingOperations = 0;
+
+    // Checkpoint: os registros do log só podem ser descartados depois que os arquivos chegaram ao dispositivo
+    if (library->wal.file != NULL && result == 0)
+    {
+        if (storageSync(library->dataFile) != 0 || storageSync(library->indexFile) != 0 ||
+            walCheckpoint(&library->wal) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    treeUnlock(library->indexFile);
+    return result;
+}
+
+/**
+ * @brief Grava as alterações pendentes e fecha os arquivos da biblioteca.
+ *
+ * @param library Ponteiro para o handle da biblioteca.
+ *
+ * @return 0 em caso de sucesso, -1 se alguma gravação ou fechamento falhar.
+ *
+ * @post Os ponteiros de arquivo do handle são definidos como NULL.
+ */
+int libraryClose(Library *library)
+{
+    LibrarySnapshot *snapshot = &library->snapshot;
+    int snapshotted = library->snapshotFilename[0] != '\0';
+
+    // A nova geração distingue os arquivos deste fechamento dos registrados em qualquer snapshot anterior, mesmo que
+    // esta sessão não use o snapshot
+    library->dataHeader.generation++;
+    library->indexHeader.generation++;
+
+    int result = libraryCommit(library);
+
+    // O snapshot só é gravado depois que todos os arquivos que ele descreve chegaram ao dispositivo
+    if (snapshotted && result == 0 &&
+        (storageSync(library->dataFile) != 0 || storageSync(library->indexFile) != 0 ||
+         (library->authorIndex.file != NULL && storageSync(library->authorIndex.file) != 0) ||
+         (library->titleIndex.file != NULL && storageSync(library->titleIndex.file) != 0) ||
+         (library->stats.file != NULL && storageSync(library->stats.file) != 0) ||
+         (library->columns.file != NULL &&
+          (storageSync(library->columns.file) != 0 || storageSync(library->columns.authors.file) != 0 ||
+           storageSync(library->columns.publishers.file) != 0))))
+    {
+        result = -1;
+    }
+
+    if (snapshotted && result == 0)
+    {
+        memset(snapshot, 0, sizeof(LibrarySnapshot));
+        snapshot->dataHeader = library->dataHeader;
+        snapshot->indexHeader = library->indexHeader;
+
+        if (library->authorIndex.file != NULL && !(library->staleParts & LIBRARY_SNAPSHOT_AUTHOR_INDEX))
+        {
+            snapshot->parts |= LIBRARY_SNAPSHOT_AUTHOR_INDEX;
+            snapshot->authorHeader = library->authorIndex.header;
+        }
+
+        if (library->titleIndex.file != NULL && !(library->staleParts & LIBRARY_SNAPSHOT_TITLE_INDEX))
+        {
+            snapshot->parts |= LIBRARY_SNAPSHOT_TITLE_INDEX;
+            snapshot->titleHeader = library->titleIndex.header;
+        }
+
+        if (library->stats.file != NULL && !(library->staleParts & LIBRARY_SNAPSHOT_STATS))
+        {
+            snapshot->parts |= LIBRARY_SNAPSHOT_STATS;
+            statsHeaderOf(&library->stats, &snapshot->statsHeader);
+        }
+
+        if (library->columns.file != NULL && !(library->staleParts & LIBRARY_SNAPSHOT_COLUMNS))
+        {
+            snapshot->parts |= LIBRARY_SNAPSHOT_COLUMNS;
+            snapshot->columnsHeader = library->columns.header;
+            snapshot->authorsHeader = library->columns.authors.header;
+            snapshot->publishersHeader = library->columns.publishers.header;
+        }
+
+        if (librarySnapshotWrite(library->snapshotFilename, snapshot) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    // Com o checkpoint feito, o log pode ser fechado antes dos arquivos que ele observa
+    if (walClose(&library->wal) != 0)
+    {
+        result = -1;
+    }
+
+    // closeFile desanexa os cabeçalhos e descarta os nós do cache antes de fechar
+    if (closeFile(&library->dataFile) != 0)
+    {
+        result = -1;
+    }
+
+    if (closeFile(&library->indexFile) != 0)
+    {
+        result = -1;
+    }
+
+    if (authorIndexClose(&library->authorIndex) != 0 || titleIndexClose(&library->titleIndex) != 0 ||
+        bookStatsClose(&library->stats) != 0 || columnStoreClose(&library->columns) != 0)
+    {
+        result = -1;
+    }
+
+    libraryDisableCodeFilter(library);
+
+    return result;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file library_snapshot.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa a gravação e a leitura do snapshot da biblioteca.
+ *
+ * @see library_snapshot.h
+ */
+
+#include "library_snapshot.h"
+#include "file_manager.h"
+#include "storage.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Calcula a soma de verificação (FNV-1a) dos campos do snapshot anteriores a `checksum`.
+ */
+static unsigned int checksumSnapshot(const LibrarySnapshot *snapshot)
+{
+    const unsigned char *bytes = (const unsigned char *)snapshot;
+    unsigned int hash = 2166136261u;
+
+    for (size_t i = 0; i < offsetof(LibrarySnapshot, checksum); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Grava o snapshot de forma atômica (arquivo temporário sincronizado e renomeado).
+ *
+ * @param filename Nome do arquivo do snapshot.
+ * @param snapshot Ponteiro para o snapshot; o identificador, a versão e a soma de verificação são preenchidos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (o snapshot anterior, se houver, é mantido).
+ */
+int librarySnapshotWrite(const char *filename, LibrarySnapshot *snapshot)
+{
+    char temporary[FILENAME_MAX];
+
+    snprintf(temporary, sizeof(temporary), "%s.tmp", filename);
+
+    snapshot->magic = LIBRARY_SNAPSHOT_MAGIC;
+    snapshot->version = LIBRARY_SNAPSHOT_VERSION;
+    snapshot->checksum = checksumSnapshot(snapshot);
+
+    FILE *file = openFile(temporary, "wb");
+
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    // O snapshot só substitui o anterior depois de chegar ao dispositivo
+    if (fwrite(snapshot, sizeof(LibrarySnapshot), 1, file) != 1 || storageSync(file) != 0)
+    {
+        perror("Erro ao gravar o snapshot");
+        closeFile(&file);
+        remove(temporary);
+        return -1;
+    }
+
+    if (closeFile(&file) != 0 || rename(temporary, filename) != 0)
+    {
+        perror("Erro ao substituir o snapshot");
+        remove(temporary);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Lê e valida um snapshot.
+ *
+ * @param filename Nome do arquivo do snapshot.
+ * @param snapshot Ponteiro para a estrutura que recebe o snapshot.
+ *
+ * @return 1 se o snapshot foi lido e é válido, 0 se o arquivo não existir, -1 se estiver incompleto, corrompido ou
+ *         em outro formato.
+ */
+int librarySnapshotRead(const char *filename, LibrarySnapshot *snapshot)
+{
+    FILE *file = fopen(filename, "rb");
+
+    if (file == NULL)
+    {
+        return 0; // Nenhum snapshot gravado
+    }
+
+    size_t read = fread(snapshot, sizeof(LibrarySnapshot), 1, file);
+
+    fclose(file);
+
+    if (read != 1 || snapshot->magic != LIBRARY_SNAPSHOT_MAGIC || snapshot->version != LIBRARY_SNAPSHOT_VERSION ||
+        snapshot->checksum != checksumSnapshot(snapshot))
+    {
+        return -1;
+    }
+
+    return 1;
+}
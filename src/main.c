@@ -5,28 +5,88 @@
  * @brief Contém a função principal do programa, que gerencia a inicialização e execução do sistema.
  * 
  * A função `main` é responsável por abrir os arquivos binários de dados e índices, invocar o menu de opções para o usuário e, por fim, fechar os arquivos antes de encerrar o programa.
+ *
+ * Os arquivos de uma sessão anterior são reabertos, depois de aplicado o log de uma sessão interrompida; os arquivos
+ * secundários registrados no snapshot do último fechamento são reaproveitados, e os demais são reconstruídos a
+ * partir do arquivo de dados.
+ *
+ * Com os argumentos `--to-compact <dados> <compacto>` ou `--from-compact <compacto> <dados> <índices>`, o programa
+ * apenas converte um arquivo de dados para o formato compacto (ou de volta, montando também o índice) e termina, sem
+ * abrir o menu.
  * 
  * @see menu.h
- * @see file_manager.h
+ * @see library.h
+ * @see compact_book_file.h
  */
 
 #include "menu.h"
-#include "file_manager.h"
+#include "library.h"
+#include "compact_book_file.h"
 
-int main()
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
 {
-    // Abre o arquivo de dados em modo de leitura e escrita binária
-    FILE *dataFile = openFile("books.bin", "w+b");
+    Library library;
+
+    // Ferramenta de conversão entre o arquivo de dados e o formato compacto
+    if ((argc == 4 && strcmp(argv[1], "--to-compact") == 0) || (argc == 5 && strcmp(argv[1], "--from-compact") == 0))
+    {
+        int converted = argc == 4 ? convertDataFileToCompact(argv[2], argv[3])
+                                  : convertCompactToDataFile(argv[2], argv[3], argv[4]);
+
+        if (converted == -1)
+        {
+            return 1;
+        }
+
+        printf("%d livros convertidos.\n", converted);
+        return 0;
+    }
+
+    // Refaz as transações de uma sessão interrompida antes de reabrir os arquivos
+    if (libraryRecover("books.bin", "TwoThreeTree.bin", "Library.wal") == -1)
+    {
+        return 1;
+    }
+
+    // Reabre os arquivos de dados e de índices (ou os cria na primeira sessão), mantendo seus cabeçalhos em memória
+    int opened = libraryOpenExisting(&library, "books.bin", "TwoThreeTree.bin");
+
+    if (opened == -1 || (opened == 1 && libraryOpen(&library, "books.bin", "TwoThreeTree.bin") != 0))
+    {
+        return 1;
+    }
+
+    // O snapshot do último fechamento indica quais arquivos secundários podem ser reaproveitados
+    libraryUseSnapshot(&library, "Library.snapshot");
+
+    // Abre os índices secundários por autor e por título, usados pelas buscas, e os contadores e as colunas do submenu de quantidades
+    if (libraryOpenAuthorIndex(&library, "AuthorIndex.bin") != 0 ||
+        libraryOpenTitleIndex(&library, "TitleIndex.bin") != 0 ||
+        libraryOpenStats(&library, "Stats.bin") != 0 ||
+        libraryOpenColumns(&library, "Columns.bin") != 0)
+    {
+        libraryClose(&library);
+        return 1;
+    }
+
+    // Usa arquivos mapeados em memória quando disponíveis; caso contrário, mantém o acesso com stdio
+    libraryUseMappedStorage(&library);
 
-    // Abre o arquivo de índices em modo de leitura e escrita binária
-    FILE *indexFile = openFile("TwoThreeTree.bin", "w+b");
+    // Registra as operações de escrita no log, com commit em grupo
+    if (libraryOpenWal(&library, "Library.wal", WAL_DEFAULT_SYNC_WINDOW_MS) != 0)
+    {
+        libraryClose(&library);
+        return 1;
+    }
 
     // Exibe o menu de opções para o usuário
-    handleChoice();
+    handleChoice(&library);
 
-    // Fecha os arquivos de dados e índices
-    closeFile(&dataFile);
-    closeFile(&indexFile);
+    // Grava os cabeçalhos e fecha os arquivos de dados e índices
+    libraryClose(&library);
 
     return 0;
 }
@@ -14,6 +14,11 @@
  */
 
 #include "menu.h"
+#include "book_manager.h"
+#include "batch_operations.h"
+#include "compaction.h"
+#include "file_report.h"
+#include "io_stats.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -111,9 +116,189 @@ static int getMenuChoice()
         return -1; // Indica erro
     }
 
+    // Descarta o restante da linha para que leituras de texto posteriores comecem na próxima linha
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF)
+        ;
+
     return choice;
 }
 
+/**
+ * @brief Lê uma linha de texto digitada pelo usuário.
+ *
+ * @param prompt Mensagem exibida antes da leitura.
+ * @param buffer Destino do texto lido, sem a quebra de linha.
+ * @param size Tamanho de `buffer`.
+ *
+ * @return 0 em caso de sucesso, -1 se a leitura falhar.
+ */
+static int readMenuLine(const char *prompt, char *buffer, int size)
+{
+    printf("%s", prompt);
+
+    if (fgets(buffer, size, stdin) == NULL)
+    {
+        return -1;
+    }
+
+    buffer[strcspn(buffer, "\n")] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Lê um valor do usuário e exibe o total de livros e de exemplares em estoque com esse valor.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param campo Campo agrupado.
+ * @param prompt Mensagem exibida antes da leitura do valor.
+ */
+static void printTotalByField(Library *library, BookStatsField campo, const char *prompt)
+{
+    char valor[BOOK_STATS_KEY_SIZE];
+    int estoque;
+
+    if (readMenuLine(prompt, valor, sizeof(valor)) != 0)
+    {
+        printf("Erro ao ler o valor.\n");
+        return;
+    }
+
+    int total = calcularTotalLivrosPorCampo(library, campo, valor, &estoque);
+
+    if (total != -1)
+    {
+        printf("Total de livros: %d (exemplares em estoque: %d)\n", total, estoque);
+    }
+}
+
+/**
+ * @brief Exibe o total de livros e de exemplares em estoque de cada autor ou de cada editora.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param campo Campo agrupado (`BOOK_STATS_AUTHOR` ou `BOOK_STATS_PUBLISHER`).
+ */
+static void printGroupedTotals(Library *library, BookStatsField campo)
+{
+    if (listarTotaisPorCampo(library, campo) == 0)
+    {
+        printf("Nenhum livro registrado.\n");
+    }
+}
+
+/**
+ * @brief Exibe o menor, o maior e o preço médio dos livros, além do valor total do estoque.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ */
+static void printPriceStats(Library *library)
+{
+    ColumnStorePriceStats stats;
+
+    if (calcularEstatisticasPreco(library, &stats) != 0)
+    {
+        return;
+    }
+
+    if (stats.books == 0)
+    {
+        printf("Nenhum livro registrado.\n");
+        return;
+    }
+
+    printf("Livros: %d\n", stats.books);
+    printf("Menor preco: %.2f | Maior preco: %.2f | Preco medio: %.2f\n", stats.minPrice, stats.maxPrice,
+           stats.averagePrice);
+    printf("Valor total do estoque: %.2f\n", stats.stockValue);
+}
+
+/**
+ * @brief Lê o nome de um arquivo de operações e executa o lote.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ */
+static void handleBatchOperations(Library *library)
+{
+    char filename[256];
+    BatchReport report;
+
+    if (readMenuLine("Arquivo de operacoes: ", filename, sizeof(filename)) != 0)
+    {
+        printf("Erro ao ler o nome do arquivo.\n");
+        return;
+    }
+
+    if (executeBatchFile(library, filename, &report) != -1)
+    {
+        printBatchReport(&report);
+    }
+}
+
+/**
+ * @brief Compacta os arquivos de dados e de índices e exibe o relatório.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ */
+static void handleCompaction(Library *library)
+{
+    CompactionReport report;
+
+    if (compactLibrary(library, &report) != -1)
+    {
+        printCompactionReport(&report);
+    }
+}
+
+/**
+ * @brief Exibe os contadores da instrumentação de E/S e, se o usuário pedir, os zera.
+ *
+ * @note Sem `TWO_THREE_IO_STATS` definido na compilação, apenas informa que a instrumentação não está disponível.
+ */
+static void handleIoStats()
+{
+    char answer[8];
+
+    ioStatsPrint(stdout);
+
+    if (ioStatsEnabled() && readMenuLine("Zerar os contadores? (s/n): ", answer, sizeof(answer)) == 0 &&
+        (answer[0] == 's' || answer[0] == 'S'))
+    {
+        ioStatsReset();
+        printf("Contadores zerados.\n");
+    }
+}
+
+/**
+ * @brief Imprime o índice por níveis e exibe as estatísticas de cada nível.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ */
+static void handleLevelReport(Library *library)
+{
+    IndexLevelReport report;
+
+    if (reportIndexLevels(library, &report, stdout) != -1)
+    {
+        printIndexLevelReport(&report);
+    }
+}
+
+/**
+ * @brief Imprime uma lista de livres e exibe as suas estatísticas.
+ *
+ * @param library Ponteiro para o handle da biblioteca aberta.
+ * @param kind Arquivo da lista.
+ */
+static void handleFreeListReport(Library *library, FreeListKind kind)
+{
+    FreeListReport report;
+
+    if (reportFreeList(library, kind, &report, stdout) != -1)
+    {
+        printFreeListReport(&report);
+    }
+}
+
 /**
  * @brief Manipula o submenu de livres relacionado à manipulação da lista de registros livres.
  *
@@ -121,18 +306,18 @@ static int getMenuChoice()
  * e imprimir registros do arquivo de dados. O submenu continua em execução até que o usuário escolha a opção de sair.
  * Quando o usuário seleciona uma opção válida, a ação correspondente é executada.
  *
- * @pre Nenhuma.
+ * @pre O handle da biblioteca deve ter sido aberto com `libraryOpen`.
  * @post O submenu é exibido na tela, e as opções selecionadas pelo usuário são tratadas. O submenu é encerrado
  *       quando o usuário escolhe a opção de sair (opção 0).
  *
- * @param Nenhum.
+ * @param library Ponteiro para o handle da biblioteca aberta.
  *
  * @return Nenhum. A função não retorna nada.
  *
- * @note As opções de impressão dos arquivos de índices e dados ainda não estão implementadas e precisam
- *       ser chamadas com funções específicas para essa tarefa.
+ * @note Cada opção percorre o encadeamento gravado no arquivo e informa o número de unidades livres, a primeira e a
+ *       última, e se o encadeamento confere com o alocador.
  */
-static void handleSubMenuFreeList()
+static void handleSubMenuFreeList(Library *library)
 {
     const char *options[] = {
         "Sair.",
@@ -152,10 +337,10 @@ static void handleSubMenuFreeList()
             printf("Saindo do Sub-Menu de Livres...\n");
             break;
         case 1:
-            // chamar função de impressão de livres do arquivo de índices
+            handleFreeListReport(library, FREE_LIST_INDEX);
             break;
         case 2:
-            // chamar função de impressão de livres do arquivo de dados
+            handleFreeListReport(library, FREE_LIST_DATA);
             break;
         default:
             printf("Opcao invalida! Tente novamente.\n");
@@ -166,24 +351,25 @@ static void handleSubMenuFreeList()
 /**
  * @brief Manipula o submenu de quantidades relacionado à manipulação de quantidades de livros.
  *
- * Este submenu oferece ao usuário seis opções: sair, total de livros diferentes,
- * total de livros em estoque, total de livros por autor, total de livros por editora
- * e total de livros por ano de lançamento. O submenu permanece em execução até que o
+ * Este submenu oferece ao usuário sete opções: sair, total de livros diferentes,
+ * total de livros em estoque, total de livros por autor, total de livros por editora,
+ * total de livros por ano de lançamento e estatísticas de preço. O submenu permanece em execução até que o
  * usuário escolha a opção de sair. Quando o usuário escolhe uma opção, a função correspondente
  * será chamada para realizar o cálculo ou operação desejada.
  *
- * @pre Nenhuma.
+ * @pre O handle da biblioteca deve ter sido aberto com `libraryOpen`.
  * @post O submenu é exibido na tela e as opções selecionadas pelo usuário são tratadas adequadamente.
  *       O submenu é encerrado quando o usuário escolhe a opção de sair (opção 0).
  *
- * @param Nenhum.
+ * @param library Ponteiro para o handle da biblioteca aberta.
  *
  * @return Nenhum. A função não retorna nada.
  *
- * @note As opções de cálculo dos totais de livros, por autor, editora, etc., ainda precisam ser implementadas.
- *       Cada uma delas deve ser associada a uma função específica para realizar os cálculos desejados.
+ * @note Os totais são mantidos incrementalmente no cabeçalho do arquivo de dados e nas estatísticas da biblioteca,
+ *       e as estatísticas de preço são calculadas sobre as colunas numéricas, de modo que nenhuma opção percorre o
+ *       arquivo de dados quando as estatísticas e as colunas estão abertas.
  */
-static void handleSubMenuQuantities()
+static void handleSubMenuQuantities(Library *library)
 {
     const char *options[] = {
         "Sair.",
@@ -191,7 +377,10 @@ static void handleSubMenuQuantities()
         "Total de livros em estoque.",
         "Total de livros por autor.",
         "Total de livros por editora.",
-        "Total de livros por ano de lançamento."};
+        "Total de livros por ano de lançamento.",
+        "Estatisticas de preco.",
+        "Totais de todos os autores.",
+        "Totais de todas as editoras."};
 
     int numOptions = sizeof(options) / sizeof(options[0]);
     int choice;
@@ -206,19 +395,28 @@ static void handleSubMenuQuantities()
             printf("Saindo...\n");
             break;
         case 1:
-            // chamar função de calcular total de livros diferentes
+            printf("Total de livros diferentes: %d\n", calcularTotalLivrosRegistrados(library));
             break;
         case 2:
-            // chamar função de calcular total de livros em estoque
+            printf("Total de livros em estoque: %lld\n", calcularTotalLivrosEmEstoque(library));
             break;
         case 3:
-            // chamar função de calcular total de livros por autor
+            printTotalByField(library, BOOK_STATS_AUTHOR, "Autor: ");
             break;
         case 4:
-            // chamar função de calcular total de livros por editora
+            printTotalByField(library, BOOK_STATS_PUBLISHER, "Editora: ");
             break;
         case 5:
-            // chamar função de calcular total de livros por ano de lançamento
+            printTotalByField(library, BOOK_STATS_YEAR, "Ano de lançamento: ");
+            break;
+        case 6:
+            printPriceStats(library);
+            break;
+        case 7:
+            printGroupedTotals(library, BOOK_STATS_AUTHOR);
+            break;
+        case 8:
+            printGroupedTotals(library, BOOK_STATS_PUBLISHER);
             break;
         default:
             printf("Opcao invalida! Tente novamente.\n");
@@ -234,18 +432,18 @@ static void handleSubMenuQuantities()
  * operações em lote. O menu principal permanece em execução até que o usuário escolha a opção de sair.
  * O menu oferece opções para acessar submenus relacionados à manipulação de livros e de listas.
  *
- * @pre Nenhuma.
+ * @pre O handle da biblioteca deve ter sido aberto com `libraryOpen`.
  * @post O menu principal é exibido na tela e as opções são tratadas de acordo com a escolha do usuário.
  *       O submenu é chamado conforme a seleção do usuário, ou a operação correspondente é executada.
  *
- * @param Nenhum.
+ * @param library Ponteiro para o handle da biblioteca aberta.
  *
  * @return Nenhum. A função não retorna nada.
  *
  * @note As funções correspondentes para cada operação (como cadastro, remoção de livro,
  *       e manipulação de dados) ainda precisam ser implementadas.
  */
-void handleChoice()
+void handleChoice(Library *library)
 {
     const char *options[] = {
         "Sair.",
@@ -256,7 +454,9 @@ void handleChoice()
         "Imprimir arvore por niveis.",
         "Imprimir lista de livres.",
         "Calcular total de livros.",
-        "Realizar operacoes em lote."};
+        "Realizar operacoes em lote.",
+        "Compactar arquivos.",
+        "Estatisticas de E/S."};
 
     int numOptions = sizeof(options) / sizeof(options[0]);
     int choice;
@@ -290,16 +490,22 @@ void handleChoice()
             // chamar função de listagem de todos os livros
             break;
         case 5:
-            // chamar função de impressão de arvore por niveis
+            handleLevelReport(library);
             break;
         case 6:
-            handleSubMenuFreeList();
+            handleSubMenuFreeList(library);
             break;
         case 7:
-            handleSubMenuQuantities();
+            handleSubMenuQuantities(library);
             break;
         case 8:
-            // chamar função de operações em lote (carregar arquivo txt)
+            handleBatchOperations(library);
+            break;
+        case 9:
+            handleCompaction(library);
+            break;
+        case 10:
+            handleIoStats();
             break;
         default:
             printf("Opcao invalida! Tente novamente.\n");
@@ -0,0 +1,470 @@
+/**
+ * @file node_cache.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o cache em memória dos nós da árvore 2-3.
+ *
+ * Os nós são armazenados em um vetor de entradas de tamanho fixo. A localização de um nó é feita por uma
+ * tabela hash (encadeada) indexada pelo par arquivo/deslocamento, e a substituição utiliza o algoritmo do
+ * relógio (CLOCK): cada acesso liga o bit de referência da entrada e o ponteiro do relógio percorre o vetor
+ * desligando os bits até encontrar uma entrada não referenciada, que é então reutilizada.
+ *
+ * As consultas, inserções, gravações e descartes são protegidos por um mutex, pois com o acesso concorrente ao
+ * índice (`tree_lock.h`) várias threads leitoras consultam e preenchem o cache ao mesmo tempo.
+ *
+ * @see node_cache.h
+ */
+
+#include "node_cache.h"
+#include "storage.h"
+#include "io_stats.h"
+
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+
+static pthread_mutex_t cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define NODE_CACHE_LOCK() pthread_mutex_lock(&cacheMutex)
+#define NODE_CACHE_UNLOCK() pthread_mutex_unlock(&cacheMutex)
+#else
+#define NODE_CACHE_LOCK() ((void)0)
+#define NODE_CACHE_UNLOCK() ((void)0)
+#endif
+
+/**
+ * @brief Entrada do cache de nós.
+ */
+typedef struct
+{
+    FILE *file;     // Arquivo de índices ao qual o nó pertence (NULL se a entrada estiver livre)
+    int offset;     // Deslocamento do nó no arquivo
+    int dirty;      // 1 se o nó precisa ser gravado no arquivo
+    int referenced; // Bit de referência do algoritmo do relógio
+    int next;       // Próxima entrada no mesmo balde da tabela hash (-1 se for a última)
+    Node23 node;    // Conteúdo do nó
+} NodeCacheEntry;
+
+static NodeCacheEntry *entries = NULL; // Vetor de entradas
+static int *buckets = NULL;            // Cabeças das listas da tabela hash
+static int cacheCapacity = 0;          // Número de entradas
+static int bucketCount = 0;            // Número de baldes (potência de 2)
+static int clockHand = 0;              // Posição atual do ponteiro do relógio
+static int initialized = 0;            // 1 após a primeira inicialização (mesmo que desativado)
+static NodeCacheStats cacheStats;
+
+/**
+ * @brief Calcula o balde da tabela hash para um par arquivo/deslocamento.
+ */
+static int hashNode(FILE *file, int offset)
+{
+    unsigned long h = (unsigned long)(size_t)file ^ ((unsigned long)offset * 2654435761UL);
+    h ^= h >> 16;
+
+    return (int)(h & (unsigned long)(bucketCount - 1));
+}
+
+/**
+ * @brief Grava um nó diretamente no arquivo de índices.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int writeNode(FILE *file, int offset, const Node23 *node)
+{
+    if (IO_STATS_WRITE(IO_STATS_NODE_WRITE, file, offset, node, sizeof(Node23)) != 0)
+    {
+        perror("Erro ao gravar nó do cache no arquivo de índices");
+        return -1;
+    }
+
+    cacheStats.writebacks++;
+    return 0;
+}
+
+/**
+ * @brief Procura a entrada de um nó na tabela hash.
+ *
+ * @return Índice da entrada, ou -1 se o nó não estiver no cache.
+ */
+static int findEntry(FILE *file, int offset)
+{
+    for (int i = buckets[hashNode(file, offset)]; i != -1; i = entries[i].next)
+    {
+        if (entries[i].file == file && entries[i].offset == offset)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Remove uma entrada da lista do seu balde e a marca como livre.
+ */
+static void unlinkEntry(int index)
+{
+    int *link = &buckets[hashNode(entries[index].file, entries[index].offset)];
+
+    while (*link != -1 && *link != index)
+    {
+        link = &entries[*link].next;
+    }
+
+    if (*link == index)
+    {
+        *link = entries[index].next;
+    }
+
+    entries[index].file = NULL;
+    entries[index].dirty = 0;
+    entries[index].referenced = 0;
+    entries[index].next = -1;
+}
+
+/**
+ * @brief Escolhe uma entrada para receber um novo nó usando o algoritmo do relógio.
+ *
+ * Entradas livres são usadas imediatamente. Caso contrário, o ponteiro do relógio avança desligando os bits
+ * de referência até encontrar uma entrada não referenciada, que é gravada (se suja) e liberada.
+ *
+ * @return Índice da entrada livre, ou -1 se a gravação do nó removido falhar.
+ */
+static int evictEntry(void)
+{
+    while (1)
+    {
+        NodeCacheEntry *entry = &entries[clockHand];
+        int index = clockHand;
+
+        clockHand = (clockHand + 1) % cacheCapacity;
+
+        if (entry->file == NULL)
+        {
+            return index;
+        }
+
+        if (entry->referenced)
+        {
+            entry->referenced = 0; // Segunda chance
+            continue;
+        }
+
+        if (entry->dirty && writeNode(entry->file, entry->offset, &entry->node) != 0)
+        {
+            return -1;
+        }
+
+        unlinkEntry(index);
+        cacheStats.evictions++;
+
+        return index;
+    }
+}
+
+/**
+ * @brief Inicializa (ou reconfigura) o cache de nós com a capacidade informada.
+ *
+ * Caso o cache já esteja inicializado, todos os nós sujos são gravados em seus arquivos antes da
+ * reconfiguração. Uma capacidade igual a 0 desativa o cache, fazendo com que todas as leituras e
+ * escritas de nós sejam feitas diretamente no arquivo de índices.
+ *
+ * @pre Nenhuma.
+ *
+ * @post O cache está vazio e pronto para uso com a capacidade informada.
+ *
+ * @param capacity Número máximo de nós mantidos em memória.
+ *
+ * @return 0 em caso de sucesso, -1 se não houver memória suficiente (neste caso o cache fica desativado).
+ */
+int nodeCacheInit(int capacity)
+{
+    nodeCacheDestroy();
+    initialized = 1;
+
+    if (capacity <= 0)
+    {
+        return 0; // Cache desativado
+    }
+
+    bucketCount = 1;
+    while (bucketCount < capacity * 2)
+    {
+        bucketCount <<= 1;
+    }
+
+    entries = malloc(sizeof(NodeCacheEntry) * capacity);
+    buckets = malloc(sizeof(int) * bucketCount);
+
+    if (entries == NULL || buckets == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o cache de nós.\n");
+        free(entries);
+        free(buckets);
+        entries = NULL;
+        buckets = NULL;
+        bucketCount = 0;
+        return -1;
+    }
+
+    cacheCapacity = capacity;
+    clockHand = 0;
+
+    for (int i = 0; i < bucketCount; i++)
+    {
+        buckets[i] = -1;
+    }
+
+    for (int i = 0; i < cacheCapacity; i++)
+    {
+        entries[i].file = NULL;
+        entries[i].dirty = 0;
+        entries[i].referenced = 0;
+        entries[i].next = -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Grava todos os nós sujos e libera a memória utilizada pelo cache.
+ *
+ * @pre Nenhuma.
+ *
+ * @post O cache é desativado até uma nova chamada a `nodeCacheInit`.
+ */
+void nodeCacheDestroy(void)
+{
+    if (entries != NULL)
+    {
+        nodeCacheFlush(NULL);
+    }
+
+    free(entries);
+    free(buckets);
+
+    entries = NULL;
+    buckets = NULL;
+    cacheCapacity = 0;
+    bucketCount = 0;
+    clockHand = 0;
+}
+
+/**
+ * @brief Indica se o cache de nós está ativo.
+ *
+ * Se o cache ainda não foi inicializado, ele é criado com a capacidade `NODE_CACHE_DEFAULT_CAPACITY`.
+ *
+ * @return 1 se o cache está ativo, 0 caso contrário.
+ */
+int nodeCacheEnabled(void)
+{
+    if (!initialized)
+    {
+        nodeCacheInit(NODE_CACHE_DEFAULT_CAPACITY);
+    }
+
+    return cacheCapacity > 0;
+}
+
+/**
+ * @brief Procura um nó no cache.
+ *
+ * @param file Arquivo de índices ao qual o nó pertence.
+ * @param offset Deslocamento (offset) do nó no arquivo de índices.
+ * @param node Ponteiro onde o nó encontrado será copiado.
+ *
+ * @return 1 se o nó estava no cache (hit), 0 caso contrário (miss).
+ */
+int nodeCacheLookup(FILE *file, int offset, Node23 *node)
+{
+    NODE_CACHE_LOCK();
+
+    if (!nodeCacheEnabled())
+    {
+        NODE_CACHE_UNLOCK();
+        return 0;
+    }
+
+    int index = findEntry(file, offset);
+
+    if (index == -1)
+    {
+        cacheStats.misses++;
+        NODE_CACHE_UNLOCK();
+        return 0;
+    }
+
+    entries[index].referenced = 1;
+    *node = entries[index].node;
+    cacheStats.hits++;
+    NODE_CACHE_UNLOCK();
+
+    return 1;
+}
+
+/**
+ * @brief Verifica se um nó está no cache, sem copiá-lo e sem alterar as estatísticas.
+ *
+ * @param file Arquivo de índices ao qual o nó pertence.
+ * @param offset Deslocamento (offset) do nó no arquivo de índices.
+ *
+ * @return 1 se o nó está no cache, 0 caso contrário.
+ */
+int nodeCacheContains(FILE *file, int offset)
+{
+    NODE_CACHE_LOCK();
+
+    int found = nodeCacheEnabled() && findEntry(file, offset) != -1;
+
+    NODE_CACHE_UNLOCK();
+
+    return found;
+}
+
+/**
+ * @brief Armazena um nó no cache.
+ *
+ * Se o nó já estiver no cache, seu conteúdo é substituído. Caso o cache esteja cheio, um nó é escolhido
+ * pela política do relógio para ser removido, sendo gravado no arquivo caso esteja sujo.
+ *
+ * @param file Arquivo de índices ao qual o nó pertence.
+ * @param offset Deslocamento (offset) do nó no arquivo de índices.
+ * @param node Ponteiro para o nó a ser armazenado.
+ * @param dirty 1 se o nó foi modificado e ainda não está gravado no arquivo, 0 caso contrário.
+ *
+ * @return 0 se o nó foi armazenado, -1 se o cache estiver desativado ou se a gravação de um nó removido falhar.
+ */
+int nodeCacheStore(FILE *file, int offset, const Node23 *node, int dirty)
+{
+    NODE_CACHE_LOCK();
+
+    if (!nodeCacheEnabled())
+    {
+        NODE_CACHE_UNLOCK();
+        return -1;
+    }
+
+    int index = findEntry(file, offset);
+
+    if (index == -1)
+    {
+        index = evictEntry();
+
+        if (index == -1)
+        {
+            NODE_CACHE_UNLOCK();
+            return -1;
+        }
+
+        int bucket = hashNode(file, offset);
+
+        entries[index].file = file;
+        entries[index].offset = offset;
+        entries[index].dirty = 0;
+        entries[index].next = buckets[bucket];
+        buckets[bucket] = index;
+    }
+
+    entries[index].node = *node;
+    entries[index].dirty |= dirty;
+    entries[index].referenced = 1;
+    NODE_CACHE_UNLOCK();
+
+    return 0;
+}
+
+/**
+ * @brief Grava no arquivo todos os nós sujos de um arquivo de índices.
+ *
+ * @param file Arquivo de índices cujos nós sujos serão gravados, ou NULL para gravar os nós de todos os arquivos.
+ *
+ * @return 0 em caso de sucesso, -1 se alguma gravação falhar.
+ *
+ * @note Os nós permanecem no cache, agora marcados como limpos.
+ */
+int nodeCacheFlush(FILE *file)
+{
+    int result = 0;
+
+    NODE_CACHE_LOCK();
+
+    for (int i = 0; i < cacheCapacity; i++)
+    {
+        NodeCacheEntry *entry = &entries[i];
+
+        if (entry->file == NULL || !entry->dirty || (file != NULL && entry->file != file))
+        {
+            continue;
+        }
+
+        if (writeNode(entry->file, entry->offset, &entry->node) != 0)
+        {
+            result = -1;
+            continue;
+        }
+
+        entry->dirty = 0;
+    }
+
+    NODE_CACHE_UNLOCK();
+
+    if (file != NULL)
+    {
+        storageFlush(file);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Descarta do cache todos os nós de um arquivo de índices, sem gravá-los.
+ *
+ * Deve ser chamada após `nodeCacheFlush` quando o arquivo for fechado ou recriado, para que um novo
+ * arquivo que reutilize o mesmo ponteiro `FILE` não receba nós antigos.
+ *
+ * @param file Arquivo de índices cujos nós serão descartados, ou NULL para esvaziar o cache.
+ */
+void nodeCacheInvalidate(FILE *file)
+{
+    NODE_CACHE_LOCK();
+
+    for (int i = 0; i < cacheCapacity; i++)
+    {
+        if (entries[i].file != NULL && (file == NULL || entries[i].file == file))
+        {
+            unlinkEntry(i);
+        }
+    }
+
+    NODE_CACHE_UNLOCK();
+}
+
+/**
+ * @brief Copia os contadores de uso do cache.
+ *
+ * @param stats Ponteiro para a estrutura onde os contadores serão copiados.
+ */
+void nodeCacheGetStats(NodeCacheStats *stats)
+{
+    if (stats != NULL)
+    {
+        NODE_CACHE_LOCK();
+        *stats = cacheStats;
+        NODE_CACHE_UNLOCK();
+    }
+}
+
+/**
+ * @brief Zera os contadores de uso do cache.
+ */
+void nodeCacheResetStats(void)
+{
+    NODE_CACHE_LOCK();
+    cacheStats.hits = 0;
+    cacheStats.misses = 0;
+    cacheStats.evictions = 0;
+    cacheStats.writebacks = 0;
+    NODE_CACHE_UNLOCK();
+}
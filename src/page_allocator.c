@@ -0,0 +1,751 @@
+/**
+ * @file page_allocator.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o alocador de unidades de tamanho fixo dos arquivos binários.
+ *
+ * O mapa de bits usa um bit por unidade (1 = livre), em palavras de 64 bits, e cresce junto com o arquivo.
+ *
+ * @see page_allocator.h
+ */
+
+#include "page_allocator.h"
+#include "storage.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Número de bits por palavra do mapa.
+ */
+#define BITS_PER_WORD 64
+
+/**
+ * @brief Tipo de uma operação registrada no diário da transação.
+ */
+typedef enum
+{
+    JOURNAL_ALLOCATE, // Unidade alocada
+    JOURNAL_RELEASE,  // Unidade liberada
+    JOURNAL_EXTEND    // Lote de `PAGE_ALLOCATOR_BATCH` unidades acrescentado a partir da unidade
+} JournalOperation;
+
+/**
+ * @brief Operação registrada no diário da transação.
+ */
+typedef struct
+{
+    JournalOperation operation; // Tipo da operação
+    int unit;                   // Unidade alterada (primeira do lote, na extensão)
+} JournalEntry;
+
+/**
+ * @brief Estado do alocador de um arquivo anexado.
+ */
+typedef struct
+{
+    FILE *file;                 // Arquivo anexado (NULL se a entrada estiver livre)
+    PageAllocatorLayout layout; // Formato das unidades
+    int *firstEmptyPosition;    // Campo do cabeçalho com a primeira unidade nunca utilizada
+    int *headEmptyPosition;     // Campo do cabeçalho com a cabeça da lista de unidades livres
+    unsigned long long *words;  // Mapa de bits das unidades livres
+    int wordCount;              // Número de palavras alocadas no mapa
+    int freeCount;              // Número de unidades livres
+    int dirty;                  // 1 se a lista gravada no arquivo não corresponde mais ao mapa
+    JournalEntry *journal;      // Operações da transação corrente, na ordem em que foram feitas
+    int journalCount;           // Número de operações no diário
+    int journalCapacity;        // Capacidade do diário
+    int journaling;             // 1 enquanto uma transação estiver aberta
+    int savedDirty;             // Valor de `dirty` no início da transação
+    int savedFirstEmpty;        // Valor de `*firstEmptyPosition` no início da transação
+    int savedHeadEmpty;         // Valor de `*headEmptyPosition` no início da transação
+} AllocatorEntry;
+
+static AllocatorEntry allocators[PAGE_ALLOCATOR_MAX_FILES];
+
+/**
+ * @brief Retorna a entrada do alocador de um arquivo, ou NULL se ele não estiver anexado.
+ */
+static AllocatorEntry *findAllocator(FILE *file)
+{
+    for (int i = 0; file != NULL && i < PAGE_ALLOCATOR_MAX_FILES; i++)
+    {
+        if (allocators[i].file == file)
+        {
+            return &allocators[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Converte o endereço de uma unidade (na convenção do arquivo) no seu número.
+ *
+ * @return O número da unidade, ou -1 se o endereço não corresponder ao início de uma unidade.
+ */
+static int addressToUnit(const AllocatorEntry *entry, int address)
+{
+    if (!entry->layout.byteAddresses)
+    {
+        return address;
+    }
+
+    if (address < entry->layout.base || (address - entry->layout.base) % entry->layout.unitSize != 0)
+    {
+        return -1;
+    }
+
+    return (int)((address - entry->layout.base) / entry->layout.unitSize);
+}
+
+/**
+ * @brief Converte o número de uma unidade no seu endereço (na convenção do arquivo).
+ */
+static int unitToAddress(const AllocatorEntry *entry, int unit)
+{
+    return entry->layout.byteAddresses ? (int)(entry->layout.base + (long)unit * entry->layout.unitSize) : unit;
+}
+
+/**
+ * @brief Retorna o deslocamento (em bytes) de uma unidade no arquivo.
+ */
+static long unitOffset(const AllocatorEntry *entry, int unit)
+{
+    return entry->layout.base + (long)unit * entry->layout.unitSize;
+}
+
+/**
+ * @brief Retorna o número de unidades já reservadas no arquivo.
+ */
+static int unitCount(const AllocatorEntry *entry)
+{
+    return addressToUnit(entry, *entry->firstEmptyPosition);
+}
+
+/**
+ * @brief Garante que o mapa de bits comporte `units` unidades.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int reserveWords(AllocatorEntry *entry, int units)
+{
+    int needed = units / BITS_PER_WORD + 1;
+
+    if (needed <= entry->wordCount)
+    {
+        return 0;
+    }
+
+    int newCount = entry->wordCount == 0 ? 16 : entry->wordCount;
+
+    while (newCount < needed)
+    {
+        newCount *= 2;
+    }
+
+    unsigned long long *resized = realloc(entry->words, sizeof(unsigned long long) * newCount);
+
+    if (resized == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o mapa de unidades livres.\n");
+        return -1;
+    }
+
+    memset(resized + entry->wordCount, 0, sizeof(unsigned long long) * (newCount - entry->wordCount));
+    entry->words = resized;
+    entry->wordCount = newCount;
+
+    return 0;
+}
+
+/**
+ * @brief Indica se uma unidade está livre no mapa.
+ */
+static int isFree(const AllocatorEntry *entry, int unit)
+{
+    int word = unit / BITS_PER_WORD;
+
+    return word < entry->wordCount && (entry->words[word] >> (unit % BITS_PER_WORD)) & 1ULL;
+}
+
+/**
+ * @brief Marca uma unidade como livre (`value` = 1) ou ocupada (`value` = 0) no mapa.
+ *
+ * @pre O mapa deve comportar a unidade (`reserveWords`).
+ */
+static void setFree(AllocatorEntry *entry, int unit, int value)
+{
+    unsigned long long bit = 1ULL << (unit % BITS_PER_WORD);
+
+    if (value)
+    {
+        entry->words[unit / BITS_PER_WORD] |= bit;
+    }
+    else
+    {
+        entry->words[unit / BITS_PER_WORD] &= ~bit;
+    }
+}
+
+/**
+ * @brief Retorna a posição do bit 1 de menor ordem da palavra (que não pode ser 0).
+ */
+static int lowestBit(unsigned long long word)
+{
+    int bit = 0;
+
+    while (!(word & 1ULL))
+    {
+        word >>= 1;
+        bit++;
+    }
+
+    return bit;
+}
+
+/**
+ * @brief Retorna a posição do bit 1 de maior ordem da palavra (que não pode ser 0).
+ */
+static int highestBit(unsigned long long word)
+{
+    int bit = BITS_PER_WORD - 1;
+
+    while (!((word >> bit) & 1ULL))
+    {
+        bit--;
+    }
+
+    return bit;
+}
+
+/**
+ * @brief Procura a unidade livre mais próxima de `unit`, examinando as palavras do mapa a partir da dela.
+ *
+ * @return O número da unidade livre encontrada, ou -1 se não houver unidades livres.
+ */
+static int findNearestFree(const AllocatorEntry *entry, int unit)
+{
+    int word = unit / BITS_PER_WORD;
+    int bit = unit % BITS_PER_WORD;
+
+    if (word >= entry->wordCount)
+    {
+        word = entry->wordCount - 1;
+        bit = BITS_PER_WORD - 1;
+    }
+
+    for (int distance = 0; word - distance >= 0 || word + distance < entry->wordCount; distance++)
+    {
+        int left = -1;
+        int right = -1;
+
+        if (distance == 0)
+        {
+            unsigned long long current = entry->words[word];
+            unsigned long long above = current & (~0ULL << bit);
+            unsigned long long below = current & ((1ULL << bit) - 1);
+
+            right = above ? word * BITS_PER_WORD + lowestBit(above) : -1;
+            left = below ? word * BITS_PER_WORD + highestBit(below) : -1;
+        }
+        else
+        {
+            if (word + distance < entry->wordCount && entry->words[word + distance])
+            {
+                right = (word + distance) * BITS_PER_WORD + lowestBit(entry->words[word + distance]);
+            }
+            if (word - distance >= 0 && entry->words[word - distance])
+            {
+                left = (word - distance) * BITS_PER_WORD + highestBit(entry->words[word - distance]);
+            }
+        }
+
+        if (left != -1 && (right == -1 || unit - left <= right - unit))
+        {
+            return left;
+        }
+        if (right != -1)
+        {
+            return right;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Preenche o início de uma unidade livre: a marca e o endereço da próxima unidade livre.
+ */
+static void fillFreePrefix(const AllocatorEntry *entry, char *prefix, int next)
+{
+    memset(prefix, 0, entry->layout.linkOffset + sizeof(int));
+    memcpy(prefix, &entry->layout.marker, sizeof(int));
+    memcpy(prefix + entry->layout.linkOffset, &next, sizeof(int));
+}
+
+/**
+ * @brief Registra que o mapa passou a diferir da lista gravada no arquivo.
+ *
+ * O `headEmptyPosition` em memória é anulado para que nenhum cabeçalho gravado antes do próximo commit aponte para
+ * a lista desatualizada.
+ */
+static void markDirty(AllocatorEntry *entry)
+{
+    entry->dirty = 1;
+    *entry->headEmptyPosition = -1;
+}
+
+/**
+ * @brief Garante espaço no diário para mais uma operação, se houver uma transação aberta.
+ *
+ * Chamada antes de alterar o mapa, para que uma operação feita nunca fique fora do diário.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int reserveJournal(AllocatorEntry *entry)
+{
+    if (!entry->journaling || entry->journalCount < entry->journalCapacity)
+    {
+        return 0;
+    }
+
+    int capacity = entry->journalCapacity == 0 ? 16 : 2 * entry->journalCapacity;
+    JournalEntry *resized = realloc(entry->journal, sizeof(JournalEntry) * capacity);
+
+    if (resized == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o diário do alocador.\n");
+        return -1;
+    }
+
+    entry->journal = resized;
+    entry->journalCapacity = capacity;
+
+    return 0;
+}
+
+/**
+ * @brief Registra uma operação no diário, se houver uma transação aberta.
+ *
+ * @pre O espaço deve ter sido reservado com `reserveJournal`.
+ */
+static void recordJournal(AllocatorEntry *entry, JournalOperation operation, int unit)
+{
+    if (entry->journaling)
+    {
+        entry->journal[entry->journalCount].operation = operation;
+        entry->journal[entry->journalCount].unit = unit;
+        entry->journalCount++;
+    }
+}
+
+/**
+ * @brief Estende o arquivo em `PAGE_ALLOCATOR_BATCH` unidades livres com uma única gravação.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int extendFile(AllocatorEntry *entry)
+{
+    int first = unitCount(entry);
+    size_t unitSize = entry->layout.unitSize;
+    char *units = malloc(unitSize * PAGE_ALLOCATOR_BATCH);
+
+    if (units == NULL || reserveWords(entry, first + PAGE_ALLOCATOR_BATCH) != 0 || reserveJournal(entry) != 0)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para estender o arquivo.\n");
+        free(units);
+        return -1;
+    }
+
+    // As unidades novas já saem marcadas como livres, para que leituras sequenciais as ignorem
+    memset(units, 0, unitSize * PAGE_ALLOCATOR_BATCH);
+    for (int i = 0; i < PAGE_ALLOCATOR_BATCH; i++)
+    {
+        fillFreePrefix(entry, units + i * unitSize, -1);
+    }
+
+    if (storageWrite(entry->file, unitOffset(entry, first), units, unitSize * PAGE_ALLOCATOR_BATCH) != 0)
+    {
+        perror("Erro ao estender o arquivo");
+        free(units);
+        return -1;
+    }
+
+    free(units);
+
+    for (int i = 0; i < PAGE_ALLOCATOR_BATCH; i++)
+    {
+        setFree(entry, first + i, 1);
+    }
+
+    entry->freeCount += PAGE_ALLOCATOR_BATCH;
+    *entry->firstEmptyPosition = unitToAddress(entry, first + PAGE_ALLOCATOR_BATCH);
+    recordJournal(entry, JOURNAL_EXTEND, first);
+
+    return 0;
+}
+
+/**
+ * @brief Passa a gerenciar as unidades livres de um arquivo.
+ *
+ * A lista de unidades livres gravada no arquivo é percorrida uma única vez e convertida no mapa de bits. Uma
+ * unidade que não estiver marcada como livre interrompe a lista (as unidades seguintes deixam de ser reutilizadas).
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param layout Formato das unidades do arquivo.
+ * @param firstEmptyPosition Campo do cabeçalho em memória com o endereço da primeira unidade nunca utilizada.
+ * @param headEmptyPosition Campo do cabeçalho em memória com o endereço da primeira unidade livre.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo já estiver anexado), -1 em caso de erro.
+ *
+ * @warning Os campos do cabeçalho devem continuar válidos até `pageAllocatorDetach`.
+ */
+int pageAllocatorAttach(FILE *file, const PageAllocatorLayout *layout, int *firstEmptyPosition, int *headEmptyPosition)
+{
+    if (findAllocator(file) != NULL)
+    {
+        return 0;
+    }
+
+    AllocatorEntry *entry = NULL;
+
+    for (int i = 0; entry == NULL && i < PAGE_ALLOCATOR_MAX_FILES; i++)
+    {
+        if (allocators[i].file == NULL)
+        {
+            entry = &allocators[i];
+        }
+    }
+
+    if (entry == NULL)
+    {
+        fprintf(stderr, "Erro: limite de arquivos do alocador atingido.\n");
+        return -1;
+    }
+
+    memset(entry, 0, sizeof(AllocatorEntry));
+    entry->layout = *layout;
+    entry->firstEmptyPosition = firstEmptyPosition;
+    entry->headEmptyPosition = headEmptyPosition;
+
+    int units = unitCount(entry);
+
+    if (units < 0 || reserveWords(entry, units) != 0)
+    {
+        free(entry->words);
+        return -1;
+    }
+
+    entry->file = file;
+
+    // Converte a lista encadeada gravada no arquivo no mapa de bits
+    char *prefix = malloc(layout->linkOffset + sizeof(int));
+    int address = *headEmptyPosition;
+
+    while (prefix != NULL && address != -1)
+    {
+        int unit = addressToUnit(entry, address);
+        int marker;
+
+        if (unit < 0 || unit >= units || isFree(entry, unit) ||
+            storageRead(file, unitOffset(entry, unit), prefix, layout->linkOffset + sizeof(int)) != 0 ||
+            (memcpy(&marker, prefix, sizeof(int)), marker != layout->marker))
+        {
+            fprintf(stderr, "Aviso: lista de unidades livres interrompida no endereço %d.\n", address);
+            entry->dirty = 1;
+            break;
+        }
+
+        setFree(entry, unit, 1);
+        entry->freeCount++;
+        memcpy(&address, prefix + layout->linkOffset, sizeof(int));
+    }
+
+    free(prefix);
+
+    // A lista interrompida é regravada no próximo commit apenas com as unidades válidas
+    if (entry->dirty)
+    {
+        markDirty(entry);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Indica se o arquivo está anexado ao alocador.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 1 se o arquivo está anexado, 0 caso contrário.
+ */
+int pageAllocatorIsAttached(FILE *file)
+{
+    return findAllocator(file) != NULL;
+}
+
+/**
+ * @brief Aloca uma unidade do arquivo.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ * @param hint Endereço de referência; a unidade livre mais próxima dele é escolhida. Com -1, é escolhida a unidade
+ *             livre de menor endereço.
+ *
+ * @return O endereço da unidade alocada, ou -1 em caso de erro (ou se o arquivo não estiver anexado).
+ *
+ * @note O conteúdo da unidade alocada é indefinido e deve ser gravado pelo chamador.
+ */
+int pageAllocate(FILE *file, int hint)
+{
+    AllocatorEntry *entry = findAllocator(file);
+
+    if (entry == NULL)
+    {
+        return -1;
+    }
+
+    if (entry->freeCount == 0 && extendFile(entry) != 0)
+    {
+        return -1;
+    }
+
+    int unit = hint == -1 ? -1 : addressToUnit(entry, hint);
+    int found = findNearestFree(entry, unit < 0 ? 0 : unit);
+
+    if (found == -1 || reserveJournal(entry) != 0)
+    {
+        return -1; // found == -1 não deve ocorrer: freeCount > 0
+    }
+
+    setFree(entry, found, 0);
+    entry->freeCount--;
+    markDirty(entry);
+    recordJournal(entry, JOURNAL_ALLOCATE, found);
+
+    return unitToAddress(entry, found);
+}
+
+/**
+ * @brief Devolve uma unidade ao alocador.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ * @param address Endereço da unidade.
+ *
+ * @return 0 em caso de sucesso, -1 se o endereço for inválido ou a unidade já estiver livre.
+ *
+ * @note O chamador deve marcar a unidade como livre no arquivo, se ela puder ser lida antes do próximo commit
+ *       (como os registros do arquivo de dados, que são percorridos sequencialmente).
+ */
+int pageRelease(FILE *file, int address)
+{
+    AllocatorEntry *entry = findAllocator(file);
+    int unit = entry != NULL ? addressToUnit(entry, address) : -1;
+
+    if (unit < 0 || unit >= unitCount(entry) || isFree(entry, unit))
+    {
+        fprintf(stderr, "Erro: liberação inválida da unidade no endereço %d.\n", address);
+        return -1;
+    }
+
+    // Unidades gravadas sem o alocador (construção em lote) ainda podem estar fora do mapa
+    if (reserveWords(entry, unit + 1) != 0 || reserveJournal(entry) != 0)
+    {
+        return -1;
+    }
+
+    setFree(entry, unit, 1);
+    entry->freeCount++;
+    markDirty(entry);
+    recordJournal(entry, JOURNAL_RELEASE, unit);
+
+    return 0;
+}
+
+/**
+ * @brief Retorna o número de unidades livres do arquivo.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ *
+ * @return O número de unidades livres, ou 0 se o arquivo não estiver anexado.
+ */
+int pageAllocatorFreeCount(FILE *file)
+{
+    AllocatorEntry *entry = findAllocator(file);
+
+    return entry != NULL ? entry->freeCount : 0;
+}
+
+/**
+ * @brief Passa a registrar as alocações e liberações do arquivo, para que possam ser desfeitas.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ */
+void pageAllocatorBeginTransaction(FILE *file)
+{
+    AllocatorEntry *entry = findAllocator(file);
+
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    entry->journaling = 1;
+    entry->journalCount = 0;
+    entry->savedDirty = entry->dirty;
+    entry->savedFirstEmpty = *entry->firstEmptyPosition;
+    entry->savedHeadEmpty = *entry->headEmptyPosition;
+}
+
+/**
+ * @brief Confirma as operações da transação e deixa de registrá-las.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ */
+void pageAllocatorEndTransaction(FILE *file)
+{
+    AllocatorEntry *entry = findAllocator(file);
+
+    if (entry != NULL)
+    {
+        entry->journaling = 0;
+        entry->journalCount = 0;
+    }
+}
+
+/**
+ * @brief Desfaz as alocações, liberações e extensões feitas desde `pageAllocatorBeginTransaction`.
+ *
+ * O mapa, o número de unidades livres e os campos do cabeçalho voltam ao estado do início da transação. As unidades
+ * acrescentadas por uma extensão desfeita continuam no arquivo, além do `firstEmptyPosition`, e são regravadas na
+ * próxima extensão.
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ */
+void pageAllocatorRollback(FILE *file)
+{
+    AllocatorEntry *entry = findAllocator(file);
+
+    if (entry == NULL || !entry->journaling)
+    {
+        return;
+    }
+
+    for (int i = entry->journalCount - 1; i >= 0; i--)
+    {
+        int unit = entry->journal[i].unit;
+
+        switch (entry->journal[i].operation)
+        {
+        case JOURNAL_ALLOCATE:
+            setFree(entry, unit, 1);
+            entry->freeCount++;
+            break;
+        case JOURNAL_RELEASE:
+            setFree(entry, unit, 0);
+            entry->freeCount--;
+            break;
+        case JOURNAL_EXTEND:
+            for (int j = 0; j < PAGE_ALLOCATOR_BATCH; j++)
+            {
+                setFree(entry, unit + j, 0);
+            }
+            entry->freeCount -= PAGE_ALLOCATOR_BATCH;
+            break;
+        }
+    }
+
+    entry->dirty = entry->savedDirty;
+    *entry->firstEmptyPosition = entry->savedFirstEmpty;
+    *entry->headEmptyPosition = entry->savedHeadEmpty;
+    entry->journaling = 0;
+    entry->journalCount = 0;
+}
+
+/**
+ * @brief Grava no arquivo a lista de unidades livres, se ela tiver sido alterada.
+ *
+ * @pre As unidades livres não devem ser gravadas depois desta chamada por caches com escrita adiada
+ *      (o cache de nós deve ser gravado antes).
+ *
+ * @post O `headEmptyPosition` em memória aponta para a unidade livre de menor endereço (ou -1).
+ *
+ * @param file Ponteiro para o arquivo anexado.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo não estiver anexado), -1 em caso de erro.
+ */
+int pageAllocatorFlush(FILE *file)
+{
+    AllocatorEntry *entry = findAllocator(file);
+
+    if (entry == NULL || !entry->dirty)
+    {
+        return 0;
+    }
+
+    char *prefix = malloc(entry->layout.linkOffset + sizeof(int));
+
+    if (prefix == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para gravar a lista de unidades livres.\n");
+        return -1;
+    }
+
+    // Encadeia as unidades livres em ordem decrescente, de modo que a cabeça seja a de menor endereço
+    int next = -1;
+    int result = 0;
+
+    for (int unit = unitCount(entry) - 1; unit >= 0; unit--)
+    {
+        if (!isFree(entry, unit))
+        {
+            continue;
+        }
+
+        fillFreePrefix(entry, prefix, next);
+
+        if (storageWrite(file, unitOffset(entry, unit), prefix, entry->layout.linkOffset + sizeof(int)) != 0)
+        {
+            perror("Erro ao gravar a lista de unidades livres");
+            result = -1;
+            break;
+        }
+
+        next = unitToAddress(entry, unit);
+    }
+
+    free(prefix);
+
+    if (result == 0)
+    {
+        *entry->headEmptyPosition = next;
+        entry->dirty = 0;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Grava a lista de unidades livres e deixa de gerenciar o arquivo.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo não estiver anexado), -1 em caso de erro.
+ */
+int pageAllocatorDetach(FILE *file)
+{
+    AllocatorEntry *entry = findAllocator(file);
+
+    if (entry == NULL)
+    {
+        return 0;
+    }
+
+    int result = pageAllocatorFlush(file);
+
+    free(entry->words);
+    free(entry->journal);
+    memset(entry, 0, sizeof(AllocatorEntry));
+
+    return result;
+}
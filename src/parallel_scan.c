@@ -0,0 +1,231 @@
+/**
+ * @file parallel_scan.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o mecanismo de varredura paralela do arquivo de dados.
+ *
+ * @see parallel_scan.h
+ */
+
+#include "parallel_scan.h"
+#include "book_data_file.h"
+#include "storage.h"
+
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PARALLEL_SCAN_HAVE_THREADS 1
+#include <pthread.h>
+#include <unistd.h>
+#else
+#define PARALLEL_SCAN_HAVE_THREADS 0
+#endif
+
+/**
+ * @brief Intervalo de posições percorrido por uma thread.
+ */
+typedef struct
+{
+    FILE *dataFile;                 // Arquivo de dados
+    long first;                     // Primeira posição do intervalo
+    long last;                      // Posição seguinte à última do intervalo
+    const ParallelScanQuery *query; // Consulta executada
+    void *partial;                  // Resultado parcial da thread
+    int result;                     // 0 em caso de sucesso, -1 em caso de erro
+} ScanRange;
+
+static int configuredThreads = 0;
+
+/**
+ * @brief Percorre um intervalo de posições, chamando `visit` para cada livro válido.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int scanRange(ScanRange *range)
+{
+    Book books[PARALLEL_SCAN_BATCH];
+    StorageReadAhead readAhead;
+
+    // Mantém o dispositivo lendo à frente do intervalo, enquanto os lotes já lidos são visitados
+    storageReadAheadStart(&readAhead, range->dataFile, sizeof(BookDataFileHeader) + range->first * (long)sizeof(Book),
+                          sizeof(BookDataFileHeader) + range->last * (long)sizeof(Book));
+
+    for (long first = range->first; first < range->last; first += PARALLEL_SCAN_BATCH)
+    {
+        int count = range->last - first < PARALLEL_SCAN_BATCH ? (int)(range->last - first) : PARALLEL_SCAN_BATCH;
+        long offset = sizeof(BookDataFileHeader) + first * (long)sizeof(Book);
+
+        storageReadAheadAdvance(&readAhead, offset);
+
+        if (storagePread(range->dataFile, offset, books, sizeof(Book) * count) != 0)
+        {
+            return -1;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            if (books[i].code == -1)
+            {
+                continue; // Registro removido
+            }
+
+            if (range->query->visit(&books[i], first + i, range->query->context, range->partial) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+#if PARALLEL_SCAN_HAVE_THREADS
+/**
+ * @brief Função executada por cada thread da varredura.
+ */
+static void *scanRangeThread(void *argument)
+{
+    ScanRange *range = argument;
+
+    range->result = scanRange(range);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Define o número máximo de threads usado pelas varreduras.
+ *
+ * @param threads Número de threads (limitado a `PARALLEL_SCAN_MAX_THREADS`), ou 0 para usar o número de
+ *                processadores disponíveis.
+ */
+void parallelScanSetThreads(int threads)
+{
+    configuredThreads = threads < 0 ? 0 : threads > PARALLEL_SCAN_MAX_THREADS ? PARALLEL_SCAN_MAX_THREADS : threads;
+}
+
+/**
+ * @brief Retorna o número máximo de threads usado pelas varreduras.
+ *
+ * @return O número definido com `parallelScanSetThreads` ou, se nenhum foi definido, o número de processadores
+ *         disponíveis (no máximo `PARALLEL_SCAN_MAX_THREADS`).
+ */
+int parallelScanThreads(void)
+{
+    if (configuredThreads > 0)
+    {
+        return configuredThreads;
+    }
+
+#if PARALLEL_SCAN_HAVE_THREADS
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (processors > PARALLEL_SCAN_MAX_THREADS)
+    {
+        return PARALLEL_SCAN_MAX_THREADS;
+    }
+
+    return processors > 0 ? (int)processors : 1;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Percorre as posições do arquivo de dados em paralelo.
+ *
+ * @pre `result` deve estar inicializado para ser combinado pela função `merge` da consulta.
+ *
+ * @param dataFile Ponteiro para o arquivo de dados.
+ * @param rowCount Número de posições a serem percorridas (normalmente `firstEmptyPosition`).
+ * @param query Ponteiro para a consulta.
+ * @param result Resultado final, que recebe os resultados parciais de todas as threads.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura, de memória ou de uma das funções da consulta.
+ */
+int parallelScan(FILE *dataFile, long rowCount, const ParallelScanQuery *query, void *result)
+{
+    ScanRange ranges[PARALLEL_SCAN_MAX_THREADS];
+    long threads = parallelScanThreads();
+    int status = 0;
+
+#if !PARALLEL_SCAN_HAVE_THREADS
+    threads = 1;
+#endif
+
+    // Cada thread recebe pelo menos PARALLEL_SCAN_MIN_ROWS posições
+    if (threads > rowCount / PARALLEL_SCAN_MIN_ROWS)
+    {
+        threads = rowCount / PARALLEL_SCAN_MIN_ROWS > 0 ? rowCount / PARALLEL_SCAN_MIN_ROWS : 1;
+    }
+
+    // As leituras com pread não enxergam as gravações que ainda estão no buffer do FILE*
+    if (storageFlush(dataFile) != 0)
+    {
+        perror("Erro ao preparar a varredura do arquivo de dados");
+        return -1;
+    }
+
+    char *partials = calloc(threads, query->partialSize > 0 ? query->partialSize : 1);
+
+    if (partials == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a varredura do arquivo de dados.\n");
+        return -1;
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        ranges[i].dataFile = dataFile;
+        ranges[i].first = rowCount * i / threads;
+        ranges[i].last = rowCount * (i + 1) / threads;
+        ranges[i].query = query;
+        ranges[i].partial = partials + (size_t)i * query->partialSize;
+        ranges[i].result = 0;
+    }
+
+#if PARALLEL_SCAN_HAVE_THREADS
+    pthread_t handles[PARALLEL_SCAN_MAX_THREADS];
+    int started[PARALLEL_SCAN_MAX_THREADS];
+
+    // O primeiro intervalo é percorrido pela própria thread chamadora
+    for (int i = 1; i < threads; i++)
+    {
+        started[i] = pthread_create(&handles[i], NULL, scanRangeThread, &ranges[i]) == 0;
+    }
+
+    ranges[0].result = scanRange(&ranges[0]);
+
+    for (int i = 1; i < threads; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(handles[i], NULL);
+        }
+        else
+        {
+            // Sem recursos para uma nova thread, o intervalo é percorrido aqui mesmo
+            ranges[i].result = scanRange(&ranges[i]);
+        }
+    }
+#else
+    ranges[0].result = scanRange(&ranges[0]);
+#endif
+
+    // Todos os resultados parciais são combinados, mesmo após um erro, para que os seus recursos sejam liberados
+    for (int i = 0; i < threads; i++)
+    {
+        if (query->merge(result, ranges[i].partial, query->context) != 0 || ranges[i].result != 0)
+        {
+            status = -1;
+        }
+    }
+
+    free(partials);
+
+    if (status != 0)
+    {
+        fprintf(stderr, "Erro ao percorrer o arquivo de dados.\n");
+    }
+
+    return status;
+}
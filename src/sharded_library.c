@@ -0,0 +1,490 @@
+/**
+ * @file sharded_library.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa a biblioteca particionada e o encaminhamento das operações para as partições.
+ *
+ * @see sharded_library.h
+ */
+
+#include "sharded_library.h"
+#include "book_manager.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SHARDED_LIBRARY_HAVE_THREADS 1
+#include <pthread.h>
+#else
+#define SHARDED_LIBRARY_HAVE_THREADS 0
+#endif
+
+/**
+ * @brief Livros de um lote inseridos em uma partição.
+ */
+typedef struct
+{
+    Library *library;   // Biblioteca da partição
+    const Book *books;  // Livros do lote
+    const int *indexes; // Índices, no lote, dos livros da partição
+    int count;          // Número de livros da partição
+    int *results;       // Resultados do lote (pode ser NULL)
+    int inserted;       // Livros inseridos
+} ShardBatch;
+
+/**
+ * @brief Mistura os bits do código (finalizador do splitmix64), para que códigos próximos caiam em partições
+ *        diferentes.
+ */
+static uint64_t hashCode(int code)
+{
+    uint64_t x = (uint32_t)code + 0x9E3779B97F4A7C15ULL;
+
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Insere os livros de uma partição, na ordem do lote.
+ */
+static void insertShardBatch(ShardBatch *batch)
+{
+    batch->inserted = 0;
+
+    for (int i = 0; i < batch->count; i++)
+    {
+        int index = batch->indexes[i];
+        int result = insertBookRecord(batch->library, &batch->books[index]);
+
+        if (result == BOOK_OK)
+        {
+            batch->inserted++;
+            libraryEndOperation(batch->library);
+        }
+
+        if (batch->results != NULL)
+        {
+            batch->results[index] = result;
+        }
+    }
+}
+
+#if SHARDED_LIBRARY_HAVE_THREADS
+/**
+ * @brief Função executada pela thread de cada partição.
+ */
+static void *insertShardBatchThread(void *argument)
+{
+    insertShardBatch(argument);
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Abre (criando do zero) uma partição avulsa, com os mesmos nomes de arquivo usados por `shardedLibraryOpen`.
+ *
+ * Permite que cada processo mantenha apenas a sua partição.
+ *
+ * @param library Ponteiro para o handle a ser inicializado.
+ * @param prefix Prefixo dos nomes dos arquivos (`<prefixo>_books_<n>.bin` e `<prefixo>_TwoThreeTree_<n>.bin`).
+ * @param shard Número da partição.
+ * @param indexOrder Ordem do índice (`TWO_THREE_TREE_ORDER` para a árvore 2-3, valores maiores para o modo B+).
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int shardedLibraryOpenShard(Library *library, const char *prefix, int shard, int indexOrder)
+{
+    char dataFilename[LIBRARY_MAX_FILENAME];
+    char indexFilename[LIBRARY_MAX_FILENAME];
+
+    if (snprintf(dataFilename, sizeof(dataFilename), "%s_books_%d.bin", prefix, shard) >= (int)sizeof(dataFilename) ||
+        snprintf(indexFilename, sizeof(indexFilename), "%s_TwoThreeTree_%d.bin", prefix, shard) >=
+            (int)sizeof(indexFilename))
+    {
+        fprintf(stderr, "Erro: prefixo muito longo para os arquivos da partição.\n");
+        return -1;
+    }
+
+    return libraryOpenWithOrder(library, dataFilename, indexFilename, indexOrder);
+}
+
+/**
+ * @brief Abre (criando do zero) uma biblioteca particionada.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada a ser inicializada.
+ * @param prefix Prefixo dos nomes dos arquivos das partições.
+ * @param shardCount Número de partições (de 1 a `SHARDED_LIBRARY_MAX_SHARDS`).
+ * @param indexOrder Ordem do índice de todas as partições.
+ * @param mode Critério de distribuição dos códigos.
+ * @param rangeStarts Em `SHARD_BY_RANGE`, o primeiro código de cada partição, em ordem crescente (o valor da partição 0
+ *                    é ignorado), ou NULL para dividir os códigos de 0 a `INT_MAX` em faixas iguais. Ignorado em
+ *                    `SHARD_BY_HASH`.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro (nenhuma partição fica aberta).
+ *
+ * @note As partições são abertas com o acesso concorrente ligado (`libraryEnableConcurrency`).
+ */
+int shardedLibraryOpen(ShardedLibrary *sharded, const char *prefix, int shardCount, int indexOrder, ShardingMode mode,
+                       const int *rangeStarts)
+{
+    memset(sharded, 0, sizeof(ShardedLibrary));
+
+    if (shardCount < 1 || shardCount > SHARDED_LIBRARY_MAX_SHARDS)
+    {
+        fprintf(stderr, "Erro: o número de partições deve estar entre 1 e %d.\n", SHARDED_LIBRARY_MAX_SHARDS);
+        return -1;
+    }
+
+    sharded->mode = mode;
+    sharded->rangeStarts[0] = INT_MIN;
+
+    for (int i = 1; mode == SHARD_BY_RANGE && i < shardCount; i++)
+    {
+        sharded->rangeStarts[i] = rangeStarts != NULL ? rangeStarts[i] : (int)((long long)INT_MAX * i / shardCount);
+
+        if (sharded->rangeStarts[i] <= sharded->rangeStarts[i - 1])
+        {
+            fprintf(stderr, "Erro: as faixas das partições devem estar em ordem crescente.\n");
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < shardCount; i++)
+    {
+        if (shardedLibraryOpenShard(&sharded->shards[i], prefix, i, indexOrder) != 0)
+        {
+            shardedLibraryClose(sharded);
+            return -1;
+        }
+
+        sharded->shardCount = i + 1;
+
+        // O cache de nós é compartilhado: a thread de uma partição pode gravar de volta os nós de outra
+        if (libraryEnableConcurrency(&sharded->shards[i]) != 0)
+        {
+            shardedLibraryClose(sharded);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Retorna a partição de um código.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ *
+ * @return O número da partição (de 0 a `shardCount - 1`).
+ */
+int shardedLibraryShardOf(const ShardedLibrary *sharded, int code)
+{
+    if (sharded->mode == SHARD_BY_HASH)
+    {
+        return (int)(hashCode(code) % (uint64_t)sharded->shardCount);
+    }
+
+    // Última partição cujo primeiro código não é maior que o código procurado
+    int low = 0;
+    int high = sharded->shardCount - 1;
+
+    while (low < high)
+    {
+        int middle = low + (high - low + 1) / 2;
+
+        if (sharded->rangeStarts[middle] <= code)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief Retorna a biblioteca da partição de um código.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ *
+ * @return Ponteiro para a biblioteca da partição.
+ */
+Library *shardedLibraryShard(ShardedLibrary *sharded, int code)
+{
+    return &sharded->shards[shardedLibraryShardOf(sharded, code)];
+}
+
+/**
+ * @brief Insere um livro na partição do seu código (veja `insertBookRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param book Ponteiro para o livro a ser inserido.
+ *
+ * @return `BOOK_OK`, `BOOK_DUPLICATE`, `BOOK_INVALID_STOCK` ou -1, como `insertBookRecord`.
+ */
+int shardedLibraryInsert(ShardedLibrary *sharded, const Book *book)
+{
+    Library *library = shardedLibraryShard(sharded, book->code);
+    int result = insertBookRecord(library, book);
+
+    if (result == BOOK_OK)
+    {
+        libraryEndOperation(library);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Insere um lote de livros, com uma thread por partição.
+ *
+ * Os livros são agrupados por partição e cada grupo é inserido, na ordem do lote, por uma thread própria. Em
+ * plataformas sem `pthread`, os grupos são inseridos em sequência pela thread chamadora.
+ *
+ * @pre Nenhuma outra thread pode estar gravando na biblioteca particionada.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param books Livros a serem inseridos.
+ * @param n Número de livros.
+ * @param results Vetor que recebe o resultado (`BOOK_OK`, `BOOK_DUPLICATE`, `BOOK_INVALID_STOCK` ou -1) de cada
+ *        livro, ou NULL.
+ *
+ * @return O número de livros inseridos, ou -1 em caso de erro de memória.
+ */
+int shardedLibraryInsertMany(ShardedLibrary *sharded, const Book *books, int n, int *results)
+{
+    ShardBatch batches[SHARDED_LIBRARY_MAX_SHARDS];
+    int starts[SHARDED_LIBRARY_MAX_SHARDS + 1] = {0};
+    int *indexes = malloc(sizeof(int) * (n > 0 ? n : 1));
+    int *shardOf = malloc(sizeof(int) * (n > 0 ? n : 1));
+
+    if (indexes == NULL || shardOf == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a inserção em lote.\n");
+        free(indexes);
+        free(shardOf);
+        return -1;
+    }
+
+    // Agrupa os índices dos livros por partição, mantendo a ordem do lote em cada grupo
+    for (int i = 0; i < n; i++)
+    {
+        shardOf[i] = shardedLibraryShardOf(sharded, books[i].code);
+        starts[shardOf[i] + 1]++;
+    }
+
+    for (int s = 0; s < sharded->shardCount; s++)
+    {
+        starts[s + 1] += starts[s];
+        batches[s].library = &sharded->shards[s];
+        batches[s].books = books;
+        batches[s].indexes = indexes + starts[s];
+        batches[s].count = 0;
+        batches[s].results = results;
+        batches[s].inserted = 0;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        ShardBatch *batch = &batches[shardOf[i]];
+
+        indexes[starts[shardOf[i]] + batch->count++] = i;
+    }
+
+#if SHARDED_LIBRARY_HAVE_THREADS
+    pthread_t handles[SHARDED_LIBRARY_MAX_SHARDS];
+    int started[SHARDED_LIBRARY_MAX_SHARDS];
+
+    // A primeira partição é inserida pela própria thread chamadora
+    for (int s = 1; s < sharded->shardCount; s++)
+    {
+        started[s] = batches[s].count > 0 &&
+                     pthread_create(&handles[s], NULL, insertShardBatchThread, &batches[s]) == 0;
+    }
+
+    insertShardBatch(&batches[0]);
+
+    for (int s = 1; s < sharded->shardCount; s++)
+    {
+        if (started[s])
+        {
+            pthread_join(handles[s], NULL);
+        }
+        else
+        {
+            // Grupo vazio ou sem recursos para uma nova thread: o grupo é inserido aqui mesmo
+            insertShardBatch(&batches[s]);
+        }
+    }
+#else
+    for (int s = 0; s < sharded->shardCount; s++)
+    {
+        insertShardBatch(&batches[s]);
+    }
+#endif
+
+    int inserted = 0;
+
+    for (int s = 0; s < sharded->shardCount; s++)
+    {
+        inserted += batches[s].inserted;
+    }
+
+    free(indexes);
+    free(shardOf);
+
+    return inserted;
+}
+
+/**
+ * @brief Remove um livro da partição do seu código (veja `deleteBookRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ *
+ * @return `BOOK_OK`, `BOOK_NOT_FOUND` ou -1, como `deleteBookRecord`.
+ */
+int shardedLibraryRemove(ShardedLibrary *sharded, int code)
+{
+    Library *library = shardedLibraryShard(sharded, code);
+    int result = deleteBookRecord(library, code);
+
+    if (result == BOOK_OK)
+    {
+        libraryEndOperation(library);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Lê um livro da partição do seu código (veja `readBookRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ * @param book Ponteiro para a estrutura que recebe o livro lido.
+ *
+ * @return `BOOK_OK`, `BOOK_NOT_FOUND` ou -1, como `readBookRecord`.
+ */
+int shardedLibraryRead(ShardedLibrary *sharded, int code, Book *book)
+{
+    return readBookRecord(shardedLibraryShard(sharded, code), code, book);
+}
+
+/**
+ * @brief Altera o estoque de um livro na partição do seu código (veja `adjustBookStockRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param code Código do livro.
+ * @param delta Variação da quantidade em estoque.
+ *
+ * @return `BOOK_OK`, `BOOK_NOT_FOUND`, `BOOK_INSUFFICIENT_STOCK` ou -1, como `adjustBookStockRecord`.
+ */
+int shardedLibraryAdjustStock(ShardedLibrary *sharded, int code, int delta)
+{
+    Library *library = shardedLibraryShard(sharded, code);
+    int result = adjustBookStockRecord(library, code, delta);
+
+    if (result == BOOK_OK)
+    {
+        libraryEndOperation(library);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Altera o preço e/ou o estoque de um livro na partição do seu código (veja `updateBookRecord`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ * @param update Ponteiro para a atualização.
+ *
+ * @return `BOOK_OK`, `BOOK_NOT_FOUND`, `BOOK_INVALID_PRICE`, `BOOK_INSUFFICIENT_STOCK` ou -1, como
+ *         `updateBookRecord`.
+ */
+int shardedLibraryUpdate(ShardedLibrary *sharded, const BookUpdate *update)
+{
+    Library *library = shardedLibraryShard(sharded, update->code);
+    int result = updateBookRecord(library, update);
+
+    if (result == BOOK_OK)
+    {
+        libraryEndOperation(library);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Retorna o número de livros de todas as partições.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ *
+ * @return A soma dos números de livros dos cabeçalhos das partições.
+ */
+long shardedLibraryBookCount(const ShardedLibrary *sharded)
+{
+    long count = 0;
+
+    for (int s = 0; s < sharded->shardCount; s++)
+    {
+        count += sharded->shards[s].dataHeader.bookCount;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Grava no disco as alterações pendentes de todas as partições (veja `libraryCommit`).
+ *
+ * @param sharded Ponteiro para a biblioteca particionada aberta.
+ *
+ * @return 0 em caso de sucesso, -1 se a gravação de alguma partição falhar.
+ */
+int shardedLibraryCommit(ShardedLibrary *sharded)
+{
+    int result = 0;
+
+    for (int s = 0; s < sharded->shardCount; s++)
+    {
+        if (libraryCommit(&sharded->shards[s]) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Grava as alterações pendentes e fecha os arquivos de todas as partições.
+ *
+ * @param sharded Ponteiro para a biblioteca particionada.
+ *
+ * @return 0 em caso de sucesso, -1 se o fechamento de alguma partição falhar.
+ */
+int shardedLibraryClose(ShardedLibrary *sharded)
+{
+    int result = 0;
+
+    for (int s = 0; s < sharded->shardCount; s++)
+    {
+        if (libraryClose(&sharded->shards[s]) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    sharded->shardCount = 0;
+    return result;
+}
@@ -0,0 +1,906 @@
+/**
+ * @file storage.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa a interface de acesso aos arquivos binários, com `stdio` ou com mapeamento em memória.
+ *
+ * Cada arquivo mapeado tem uma entrada no registro de mapeamentos, indexado pelo `FILE*`. Como no cache de nós e
+ * nos cabeçalhos anexados, os demais módulos continuam identificando o arquivo apenas pelo `FILE*`.
+ *
+ * @see storage.h
+ */
+
+#include "storage.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define STORAGE_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define STORAGE_HAVE_MMAP 0
+#endif
+
+/**
+ * @brief Arquivo mapeado em memória.
+ */
+typedef struct
+{
+    FILE *file;       // Arquivo mapeado (NULL se a entrada estiver livre)
+    char *base;       // Início do mapeamento
+    long mappedSize;  // Tamanho do mapeamento (múltiplo de STORAGE_MAP_CHUNK)
+    long logicalSize; // Tamanho real do conteúdo do arquivo
+} MappedFile;
+
+/**
+ * @brief Função registrada para ser chamada antes das gravações em um arquivo.
+ */
+typedef struct
+{
+    FILE *file;            // Arquivo observado (NULL se a entrada estiver livre)
+    StorageWriteHook hook; // Função chamada antes de cada gravação
+    void *context;         // Contexto repassado à função
+} WriteHookEntry;
+
+/**
+ * @brief Função registrada para ser chamada depois das leituras de um arquivo.
+ */
+typedef struct
+{
+    FILE *file;           // Arquivo observado (NULL se a entrada estiver livre)
+    StorageReadHook hook; // Função chamada depois de cada leitura
+    void *context;        // Contexto repassado à função
+} ReadHookEntry;
+
+static MappedFile mappings[STORAGE_MAX_MAPPINGS];
+static WriteHookEntry writeHooks[STORAGE_MAX_MAPPINGS];
+static ReadHookEntry readHooks[STORAGE_MAX_MAPPINGS];
+static int readHookCount = 0;                        // Entradas ocupadas de `readHooks`
+static FILE *positionalFiles[STORAGE_MAX_MAPPINGS]; // Arquivos com acesso posicional (`storageSetPositional`)
+static int prefetchEnabled = 1;                     // 1 se os avisos de leitura antecipada estão ligados
+
+/**
+ * @brief Procura o mapeamento de um arquivo.
+ *
+ * @return Ponteiro para o mapeamento, ou NULL se o arquivo não estiver mapeado.
+ */
+static MappedFile *findMapping(FILE *file)
+{
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    for (int i = 0; i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (mappings[i].file == file)
+        {
+            return &mappings[i];
+        }
+    }
+
+    return NULL;
+}
+
+#if STORAGE_HAVE_MMAP
+/**
+ * @brief Aumenta o arquivo e o mapeamento até comportarem `required` bytes.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int growMapping(MappedFile *mapping, long required)
+{
+    long newSize = ((required + STORAGE_MAP_CHUNK - 1) / STORAGE_MAP_CHUNK) * STORAGE_MAP_CHUNK;
+    int fd = fileno(mapping->file);
+
+    if (newSize <= mapping->mappedSize)
+    {
+        return 0;
+    }
+
+    if (ftruncate(fd, newSize) != 0)
+    {
+        perror("Erro ao aumentar o arquivo mapeado");
+        return -1;
+    }
+
+    if (mapping->base != NULL)
+    {
+        munmap(mapping->base, mapping->mappedSize);
+    }
+
+    void *base = mmap(NULL, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (base == MAP_FAILED)
+    {
+        perror("Erro ao mapear o arquivo");
+        mapping->base = NULL;
+        mapping->mappedSize = 0;
+        return -1;
+    }
+
+    mapping->base = base;
+    mapping->mappedSize = newSize;
+
+    return 0;
+}
+#endif
+
+/**
+ * @brief Informa se o arquivo está no registro de acesso posicional.
+ */
+static int findPositional(FILE *file)
+{
+    for (int i = 0; file != NULL && i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (positionalFiles[i] == file)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+#if STORAGE_HAVE_MMAP
+/**
+ * @brief Lê `size` bytes do descritor do arquivo com `pread`, repetindo as leituras curtas.
+ *
+ * @return 0 em caso de sucesso, -1 se a leitura falhar ou ultrapassar o final do arquivo.
+ */
+static int positionalRead(FILE *file, long offset, void *buffer, size_t size)
+{
+    // Leituras curtas só ocorrem no final do arquivo ou quando interrompidas por um sinal
+    for (size_t done = 0; done < size;)
+    {
+        ssize_t count = pread(fileno(file), (char *)buffer + done, size - done, offset + (off_t)done);
+
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (count <= 0)
+        {
+            return -1;
+        }
+
+        done += (size_t)count;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Grava `size` bytes no descritor do arquivo com `pwrite`, repetindo as gravações curtas.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int positionalWrite(FILE *file, long offset, const void *buffer, size_t size)
+{
+    for (size_t done = 0; done < size;)
+    {
+        ssize_t count = pwrite(fileno(file), (const char *)buffer + done, size - done, offset + (off_t)done);
+
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (count <= 0)
+        {
+            return -1;
+        }
+
+        done += (size_t)count;
+    }
+
+    return 0;
+}
+#endif
+
+/**
+ * @brief Chama as funções registradas com `storageSetReadHook` para uma leitura bem-sucedida.
+ *
+ * Sem funções registradas (o caso comum), a leitura não percorre o registro.
+ */
+static void applyReadHooks(FILE *file, long offset, void *buffer, size_t size)
+{
+    for (int i = 0; readHookCount > 0 && i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (readHooks[i].file == file)
+        {
+            readHooks[i].hook(file, offset, buffer, size, readHooks[i].context);
+        }
+    }
+}
+
+/**
+ * @brief Lê `size` bytes do arquivo a partir do deslocamento `offset`.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param buffer Destino dos dados lidos.
+ * @param size Número de bytes a serem lidos.
+ *
+ * @return 0 em caso de sucesso, -1 se a leitura falhar ou ultrapassar o final do arquivo.
+ */
+int storageRead(FILE *file, long offset, void *buffer, size_t size)
+{
+    MappedFile *mapping = findMapping(file);
+
+    if (mapping != NULL)
+    {
+        if (offset < 0 || offset + (long)size > mapping->logicalSize)
+        {
+            return -1;
+        }
+
+        memcpy(buffer, mapping->base + offset, size);
+    }
+#if STORAGE_HAVE_MMAP
+    else if (findPositional(file))
+    {
+        if (positionalRead(file, offset, buffer, size) != 0)
+        {
+            return -1;
+        }
+    }
+#endif
+    else if (fseek(file, offset, SEEK_SET) != 0 || fread(buffer, size, 1, file) != 1)
+    {
+        return -1;
+    }
+
+    applyReadHooks(file, offset, buffer, size);
+    return 0;
+}
+
+/**
+ * @brief Lê `size` bytes do arquivo a partir do deslocamento `offset`, sem usar a posição corrente do `FILE*`.
+ *
+ * Ao contrário de `storageRead`, a leitura não altera o estado do `FILE*` (usa `pread` no descritor, ou copia do
+ * mapeamento), de modo que várias threads podem ler o mesmo arquivo ao mesmo tempo.
+ *
+ * @pre As gravações pendentes no buffer do `FILE*` devem ter sido repassadas com `storageFlush`, e nenhuma gravação
+ *      no arquivo pode ocorrer durante as leituras.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param buffer Destino dos dados lidos.
+ * @param size Número de bytes a serem lidos.
+ *
+ * @return 0 em caso de sucesso, -1 se a leitura falhar ou ultrapassar o final do arquivo.
+ *
+ * @note Em plataformas sem `pread`, equivale a `storageRead` e não pode ser usada por várias threads.
+ */
+int storagePread(FILE *file, long offset, void *buffer, size_t size)
+{
+#if STORAGE_HAVE_MMAP
+    const MappedFile *mapping = findMapping(file);
+
+    if (mapping != NULL)
+    {
+        if (offset < 0 || offset + (long)size > mapping->logicalSize)
+        {
+            return -1;
+        }
+
+        memcpy(buffer, mapping->base + offset, size);
+    }
+    else if (positionalRead(file, offset, buffer, size) != 0)
+    {
+        return -1;
+    }
+
+    applyReadHooks(file, offset, buffer, size);
+    return 0;
+#else
+    return storageRead(file, offset, buffer, size);
+#endif
+}
+
+/**
+ * @brief Grava `size` bytes no arquivo a partir do deslocamento `offset`.
+ *
+ * Gravações além do final do arquivo o estendem, como com `fwrite`. Se houver uma função registrada com
+ * `storageSetWriteHook` para o arquivo, ela é chamada antes da gravação.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param buffer Dados a serem gravados.
+ * @param size Número de bytes a serem gravados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int storageWrite(FILE *file, long offset, const void *buffer, size_t size)
+{
+    MappedFile *mapping = findMapping(file);
+
+    for (int i = 0; file != NULL && i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (writeHooks[i].file == file)
+        {
+            int handled = writeHooks[i].hook(file, offset, buffer, size, writeHooks[i].context);
+
+            if (handled != 0)
+            {
+                return handled == 1 ? 0 : -1; // 1: a gravação foi assumida pela função registrada
+            }
+        }
+    }
+
+    if (mapping != NULL)
+    {
+#if STORAGE_HAVE_MMAP
+        long end = offset + (long)size;
+
+        if (offset < 0 || (end > mapping->mappedSize && growMapping(mapping, end) != 0))
+        {
+            return -1;
+        }
+
+        memcpy(mapping->base + offset, buffer, size);
+
+        if (end > mapping->logicalSize)
+        {
+            mapping->logicalSize = end;
+        }
+
+        return 0;
+#endif
+    }
+
+#if STORAGE_HAVE_MMAP
+    if (findPositional(file))
+    {
+        return positionalWrite(file, offset, buffer, size);
+    }
+#endif
+
+    if (fseek(file, offset, SEEK_SET) != 0 || fwrite(buffer, size, 1, file) != 1)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Retorna o tamanho atual (em bytes) do arquivo.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return Tamanho do arquivo, ou -1 em caso de erro.
+ *
+ * @note Para arquivos mapeados é retornado o tamanho lógico (até o último byte gravado), e não o tamanho do mapeamento.
+ */
+long storageSize(FILE *file)
+{
+    MappedFile *mapping = findMapping(file);
+
+    if (mapping != NULL)
+    {
+        return mapping->logicalSize;
+    }
+
+#if STORAGE_HAVE_MMAP
+    struct stat info;
+
+    if (findPositional(file))
+    {
+        return fstat(fileno(file), &info) == 0 ? (long)info.st_size : -1;
+    }
+#endif
+
+    if (fseek(file, 0, SEEK_END) != 0)
+    {
+        return -1;
+    }
+
+    return ftell(file);
+}
+
+/**
+ * @brief Reduz o arquivo ao tamanho informado, descartando o conteúdo seguinte.
+ *
+ * @param file Ponteiro para o arquivo, que não pode estar mapeado.
+ * @param size Novo tamanho (em bytes) do arquivo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro ou se o arquivo estiver mapeado.
+ *
+ * @note Em plataformas sem `ftruncate`, o arquivo mantém o seu tamanho e a chamada retorna 0.
+ */
+int storageTruncate(FILE *file, long size)
+{
+    if (findMapping(file) != NULL || fflush(file) != 0)
+    {
+        return -1;
+    }
+
+#if STORAGE_HAVE_MMAP
+    return ftruncate(fileno(file), size) == 0 ? 0 : -1;
+#else
+    (void)size;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Retorna um ponteiro para os dados do arquivo mapeado, sem cópia.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param size Número de bytes que serão acessados.
+ *
+ * @return Ponteiro para os dados, ou NULL se o arquivo não estiver mapeado ou o intervalo ultrapassar o seu final.
+ *
+ * @warning O ponteiro deixa de ser válido na próxima gravação que estender o arquivo e em `storageUnmap`.
+ */
+const void *storagePointer(FILE *file, long offset, size_t size)
+{
+    MappedFile *mapping = findMapping(file);
+
+    if (mapping == NULL || offset < 0 || offset + (long)size > mapping->logicalSize)
+    {
+        return NULL;
+    }
+
+    // O mapeamento não contém o que uma função de leitura acrescentaria às cópias
+    for (int i = 0; readHookCount > 0 && i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (readHooks[i].file == file)
+        {
+            return NULL;
+        }
+    }
+
+    return mapping->base + offset;
+}
+
+/**
+ * @brief Garante que as gravações feitas no arquivo foram repassadas ao sistema operacional.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int storageFlush(FILE *file)
+{
+    MappedFile *mapping = findMapping(file);
+
+    if (mapping != NULL)
+    {
+        // As páginas de um mapeamento compartilhado já pertencem ao cache do sistema operacional
+        return 0;
+    }
+
+    return fflush(file) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Garante que o conteúdo do arquivo foi gravado no dispositivo (`msync`/`fsync`).
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ *
+ * @note Em plataformas sem `fsync`, equivale a `storageFlush`.
+ */
+int storageSync(FILE *file)
+{
+    MappedFile *mapping = findMapping(file);
+
+#if STORAGE_HAVE_MMAP
+    if (mapping != NULL)
+    {
+        return msync(mapping->base, mapping->mappedSize, MS_SYNC) == 0 ? 0 : -1;
+    }
+
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+#else
+    return mapping != NULL ? 0 : storageFlush(file);
+#endif
+}
+
+/**
+ * @brief Registra uma função a ser chamada antes de cada gravação no arquivo.
+ *
+ * @param file Ponteiro para o arquivo observado.
+ * @param hook Função a ser chamada, ou NULL para remover o registro.
+ * @param context Ponteiro repassado à função a cada chamada.
+ *
+ * @return 0 em caso de sucesso, -1 se o limite de arquivos observados for atingido.
+ */
+int storageSetWriteHook(FILE *file, StorageWriteHook hook, void *context)
+{
+    WriteHookEntry *entry = NULL;
+
+    for (int i = 0; i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (writeHooks[i].file == file)
+        {
+            entry = &writeHooks[i];
+        }
+        else if (entry == NULL && hook != NULL && writeHooks[i].file == NULL)
+        {
+            entry = &writeHooks[i];
+        }
+    }
+
+    if (entry == NULL)
+    {
+        if (hook == NULL)
+        {
+            return 0;
+        }
+
+        fprintf(stderr, "Erro: limite de arquivos observados atingido.\n");
+        return -1;
+    }
+
+    entry->file = hook != NULL ? file : NULL;
+    entry->hook = hook;
+    entry->context = context;
+
+    return 0;
+}
+
+/**
+ * @brief Registra uma função a ser chamada depois de cada leitura do arquivo.
+ *
+ * @param file Ponteiro para o arquivo observado.
+ * @param hook Função a ser chamada, ou NULL para remover o registro.
+ * @param context Ponteiro repassado à função a cada chamada.
+ *
+ * @return 0 em caso de sucesso, -1 se o limite de arquivos observados for atingido.
+ */
+int storageSetReadHook(FILE *file, StorageReadHook hook, void *context)
+{
+    ReadHookEntry *entry = NULL;
+
+    for (int i = 0; i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (readHooks[i].file == file)
+        {
+            entry = &readHooks[i];
+        }
+        else if (entry == NULL && hook != NULL && readHooks[i].file == NULL)
+        {
+            entry = &readHooks[i];
+        }
+    }
+
+    if (entry == NULL)
+    {
+        if (hook == NULL)
+        {
+            return 0;
+        }
+
+        fprintf(stderr, "Erro: limite de arquivos observados atingido.\n");
+        return -1;
+    }
+
+    readHookCount += (hook != NULL) - (entry->file != NULL);
+    entry->file = hook != NULL ? file : NULL;
+    entry->hook = hook;
+    entry->context = context;
+
+    return 0;
+}
+
+/**
+ * @brief Passa a acessar o arquivo por meio de um mapeamento em memória.
+ *
+ * @param file Ponteiro para o arquivo, aberto em modo de leitura e escrita.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo já estiver mapeado), -1 se o mapeamento não estiver disponível.
+ */
+int storageMap(FILE *file)
+{
+#if STORAGE_HAVE_MMAP
+    if (findMapping(file) != NULL)
+    {
+        return 0;
+    }
+
+    MappedFile *mapping = NULL;
+
+    for (int i = 0; mapping == NULL && i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (mappings[i].file == NULL)
+        {
+            mapping = &mappings[i];
+        }
+    }
+
+    if (mapping == NULL)
+    {
+        fprintf(stderr, "Erro: limite de arquivos mapeados atingido.\n");
+        return -1;
+    }
+
+    // Descarrega o buffer do stdio para que o mapeamento veja o conteúdo completo do arquivo
+    struct stat info;
+
+    if (fflush(file) != 0 || fstat(fileno(file), &info) != 0)
+    {
+        perror("Erro ao preparar o mapeamento do arquivo");
+        return -1;
+    }
+
+    mapping->file = file;
+    mapping->base = NULL;
+    mapping->mappedSize = 0;
+    mapping->logicalSize = info.st_size;
+
+    if (growMapping(mapping, info.st_size > 0 ? info.st_size : 1) != 0)
+    {
+        ftruncate(fileno(file), mapping->logicalSize);
+        mapping->file = NULL;
+        return -1;
+    }
+
+    return 0;
+#else
+    (void)file;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Desfaz o mapeamento do arquivo, restaurando o seu tamanho real.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 0 em caso de sucesso (ou se o arquivo não estiver mapeado), -1 em caso de erro.
+ *
+ * @post O arquivo volta a ser acessado com as funções de `stdio`.
+ */
+int storageUnmap(FILE *file)
+{
+    MappedFile *mapping = findMapping(file);
+    int result = 0;
+
+    if (mapping == NULL)
+    {
+        return 0;
+    }
+
+#if STORAGE_HAVE_MMAP
+    if (munmap(mapping->base, mapping->mappedSize) != 0)
+    {
+        perror("Erro ao desfazer o mapeamento do arquivo");
+        result = -1;
+    }
+
+    // Remove o espaço reservado pelos blocos do mapeamento além do conteúdo real
+    if (ftruncate(fileno(file), mapping->logicalSize) != 0)
+    {
+        perror("Erro ao restaurar o tamanho do arquivo");
+        result = -1;
+    }
+#endif
+
+    mapping->file = NULL;
+    mapping->base = NULL;
+
+    // Descarta qualquer estado do stdio anterior ao mapeamento
+    fseek(file, 0, SEEK_SET);
+
+    return result;
+}
+
+/**
+ * @brief Informa se o arquivo está mapeado em memória.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 1 se o arquivo estiver mapeado, 0 caso contrário.
+ */
+int storageIsMapped(FILE *file)
+{
+    return findMapping(file) != NULL;
+}
+
+/**
+ * @brief Liga ou desliga o acesso posicional ao arquivo.
+ *
+ * No acesso posicional, as leituras e gravações de arquivos não mapeados usam `pread` e `pwrite` no descritor, sem
+ * o buffer nem a posição corrente do `FILE*`, de modo que várias threads podem ler o arquivo ao mesmo tempo (as
+ * gravações continuam exigindo acesso exclusivo, garantido por quem chama). Arquivos mapeados já são lidos sem
+ * usar o `FILE*`.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param enabled 1 para ligar, 0 para desligar.
+ *
+ * @return 0 em caso de sucesso, -1 se o limite de arquivos for atingido ou se a plataforma não tiver `pread`.
+ *
+ * @note Deve ser chamada antes de o arquivo passar a ser usado por várias threads.
+ */
+int storageSetPositional(FILE *file, int enabled)
+{
+#if STORAGE_HAVE_MMAP
+    int slot = -1;
+
+    for (int i = 0; i < STORAGE_MAX_MAPPINGS; i++)
+    {
+        if (positionalFiles[i] == file)
+        {
+            if (!enabled)
+            {
+                positionalFiles[i] = NULL;
+            }
+            return 0;
+        }
+
+        if (positionalFiles[i] == NULL && slot == -1)
+        {
+            slot = i;
+        }
+    }
+
+    if (!enabled)
+    {
+        return 0;
+    }
+
+    if (slot == -1)
+    {
+        fprintf(stderr, "Erro: limite de arquivos com acesso posicional atingido.\n");
+        return -1;
+    }
+
+    // As gravações ainda no buffer do stdio precisam chegar ao descritor antes das leituras com pread (e um buffer
+    // de leitura é descartado, para não ser reaproveitado depois que o acesso posicional for desligado)
+    if (fflush(file) != 0)
+    {
+        perror("Erro ao preparar o acesso posicional ao arquivo");
+        return -1;
+    }
+
+    positionalFiles[slot] = file;
+    return 0;
+#else
+    (void)file;
+    return enabled ? -1 : 0;
+#endif
+}
+
+/**
+ * @brief Informa se o arquivo está com o acesso posicional ligado.
+ *
+ * @param file Ponteiro para o arquivo.
+ *
+ * @return 1 se o acesso posicional estiver ligado, 0 caso contrário.
+ */
+int storageIsPositional(FILE *file)
+{
+    return findPositional(file);
+}
+
+/**
+ * @brief Avisa que um trecho do arquivo será lido em breve, sem esperar pela leitura.
+ *
+ * O sistema operacional começa a trazer o trecho para o cache de páginas em segundo plano e a chamada retorna
+ * imediatamente; a leitura posterior (`storageRead`/`storagePread`) encontra os dados já em memória. Várias chamadas
+ * seguidas mantêm várias leituras em andamento ao mesmo tempo, o que aproveita a fila de comandos do dispositivo.
+ * Arquivos mapeados usam `madvise(MADV_WILLNEED)`; os demais, `posix_fadvise(POSIX_FADV_WILLNEED)` no descritor.
+ *
+ * @param file Ponteiro para o arquivo.
+ * @param offset Deslocamento (em bytes) a partir do início do arquivo.
+ * @param size Número de bytes que serão lidos.
+ *
+ * @note Sem a leitura antecipada ligada (`storageSetPrefetch`) ou em plataformas sem esses avisos, a chamada não
+ *       tem efeito. Os avisos nunca alteram o conteúdo lido.
+ */
+void storagePrefetch(FILE *file, long offset, size_t size)
+{
+    if (!prefetchEnabled || file == NULL || offset < 0 || size == 0)
+    {
+        return;
+    }
+
+#if STORAGE_HAVE_MMAP
+    MappedFile *mapping = findMapping(file);
+
+    if (mapping != NULL)
+    {
+        // O aviso vale para páginas inteiras, a partir do início da página do deslocamento
+        long page = sysconf(_SC_PAGESIZE);
+        long start = page > 0 ? offset / page * page : offset;
+        long end = offset + (long)size < mapping->logicalSize ? offset + (long)size : mapping->logicalSize;
+
+        if (start < end)
+        {
+            madvise(mapping->base + start, end - start, MADV_WILLNEED);
+        }
+
+        return;
+    }
+
+#if defined(POSIX_FADV_WILLNEED)
+    posix_fadvise(fileno(file), offset, (off_t)size, POSIX_FADV_WILLNEED);
+#elif defined(F_RDADVISE)
+    struct radvisory advice;
+
+    advice.ra_offset = offset;
+    advice.ra_count = size > INT_MAX ? INT_MAX : (int)size;
+    fcntl(fileno(file), F_RDADVISE, &advice);
+#endif
+#endif
+}
+
+/**
+ * @brief Liga ou desliga a leitura antecipada de todos os arquivos (ligada por padrão).
+ *
+ * @param enabled 1 para ligar, 0 para desligar.
+ */
+void storageSetPrefetch(int enabled)
+{
+    prefetchEnabled = enabled != 0;
+}
+
+/**
+ * @brief Informa se a leitura antecipada está ligada.
+ *
+ * @return 1 se estiver ligada, 0 caso contrário.
+ */
+int storagePrefetchEnabled(void)
+{
+    return prefetchEnabled;
+}
+
+/**
+ * @brief Inicia a leitura antecipada de uma varredura sequencial do trecho [`start`, `end`) do arquivo.
+ *
+ * A primeira janela de `STORAGE_PREFETCH_WINDOW` bytes é antecipada imediatamente.
+ *
+ * @param readAhead Ponteiro para o estado a ser inicializado.
+ * @param file Ponteiro para o arquivo.
+ * @param start Deslocamento (em bytes) da primeira leitura da varredura.
+ * @param end Deslocamento (em bytes) do final da varredura.
+ */
+void storageReadAheadStart(StorageReadAhead *readAhead, FILE *file, long start, long end)
+{
+    readAhead->file = file;
+    readAhead->next = start;
+    readAhead->end = end;
+
+    storageReadAheadAdvance(readAhead, start);
+}
+
+/**
+ * @brief Avança a leitura antecipada até a leitura que está para ser feita.
+ *
+ * Quando a varredura alcança a metade da última janela antecipada, a janela seguinte é antecipada, de modo que o
+ * dispositivo trabalha à frente da varredura.
+ *
+ * @param readAhead Ponteiro para o estado iniciado com `storageReadAheadStart`.
+ * @param offset Deslocamento (em bytes) da próxima leitura da varredura.
+ */
+void storageReadAheadAdvance(StorageReadAhead *readAhead, long offset)
+{
+    if (readAhead->next >= readAhead->end || offset + STORAGE_PREFETCH_WINDOW / 2 < readAhead->next)
+    {
+        return;
+    }
+
+    // A janela começa na leitura corrente se a varredura tiver saltado para além do trecho antecipado
+    long start = offset > readAhead->next ? offset : readAhead->next;
+    long size = readAhead->end - start < STORAGE_PREFETCH_WINDOW ? readAhead->end - start : STORAGE_PREFETCH_WINDOW;
+
+    storagePrefetch(readAhead->file, start, (size_t)size);
+    readAhead->next = start + size;
+}
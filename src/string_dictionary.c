@@ -0,0 +1,331 @@
+/**
+ * @file string_dictionary.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o dicionário de strings usado na codificação por dicionário das colunas de texto.
+ *
+ * @see string_dictionary.h
+ */
+
+#include "string_dictionary.h"
+#include "file_manager.h"
+#include "storage.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Calcula o hash FNV-1a de um valor.
+ */
+static unsigned int hashValue(const char *value)
+{
+    unsigned int hash = 2166136261u;
+
+    for (const char *p = value; *p; p++)
+    {
+        hash ^= (unsigned char)*p;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Procura a entrada da tabela hash de um valor.
+ *
+ * @return Índice da entrada com o identificador do valor ou, se ele não existir, da entrada livre onde seria inserido.
+ */
+static int findSlot(const StringDictionary *dictionary, const char *value)
+{
+    int mask = dictionary->slotCapacity - 1;
+    int slot = hashValue(value) & mask;
+
+    while (dictionary->slots[slot] != -1 && strcmp(dictionary->values[dictionary->slots[slot]], value) != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Dobra a capacidade do dicionário e reconstrói a tabela hash.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória (o dicionário permanece inalterado).
+ */
+static int growDictionary(StringDictionary *dictionary)
+{
+    int capacity = dictionary->capacity * 2;
+    int slotCapacity = capacity * 2;
+    int *slots = malloc(sizeof(int) * slotCapacity);
+    void *values = realloc(dictionary->values, (size_t)capacity * STRING_DICTIONARY_VALUE_SIZE);
+
+    if (values != NULL)
+    {
+        dictionary->values = values;
+    }
+
+    if (slots == NULL || values == NULL)
+    {
+        free(slots);
+        fprintf(stderr, "Erro: memória insuficiente para o dicionário.\n");
+        return -1;
+    }
+
+    free(dictionary->slots);
+    dictionary->slots = slots;
+    dictionary->slotCapacity = slotCapacity;
+    dictionary->capacity = capacity;
+
+    // Os identificadores não mudam; apenas as suas entradas na tabela são recalculadas
+    memset(slots, -1, sizeof(int) * slotCapacity);
+
+    for (int id = 0; id < dictionary->header.count; id++)
+    {
+        slots[findSlot(dictionary, dictionary->values[id])] = id;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Cria um novo dicionário vazio.
+ *
+ * @pre `dictionary` e `filename` não devem ser NULL.
+ *
+ * @param dictionary Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo do dicionário.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int stringDictionaryCreate(StringDictionary *dictionary, const char *filename)
+{
+    memset(dictionary, 0, sizeof(StringDictionary));
+    dictionary->capacity = STRING_DICTIONARY_INITIAL_CAPACITY;
+    dictionary->slotCapacity = STRING_DICTIONARY_INITIAL_CAPACITY * 2;
+    dictionary->values = malloc((size_t)dictionary->capacity * STRING_DICTIONARY_VALUE_SIZE);
+    dictionary->slots = malloc(sizeof(int) * dictionary->slotCapacity);
+
+    if (dictionary->values == NULL || dictionary->slots == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o dicionário.\n");
+        stringDictionaryClose(dictionary);
+        return -1;
+    }
+
+    memset(dictionary->slots, -1, sizeof(int) * dictionary->slotCapacity);
+    dictionary->file = openFile(filename, "w+b");
+
+    if (dictionary->file == NULL)
+    {
+        stringDictionaryClose(dictionary);
+        return -1;
+    }
+
+    // Grava o cabeçalho para que o arquivo já tenha o formato completo
+    if (fwrite(&dictionary->header, sizeof(StringDictionaryHeader), 1, dictionary->file) != 1)
+    {
+        perror("Erro ao gravar o dicionário");
+        stringDictionaryClose(dictionary);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Abre um dicionário existente, carregando os seus valores para a memória.
+ *
+ * @pre `dictionary` e `filename` não devem ser NULL.
+ *
+ * @param dictionary Ponteiro para a estrutura a ser inicializada.
+ * @param filename Nome do arquivo do dicionário.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser lido ou estiver inconsistente.
+ */
+int stringDictionaryOpen(StringDictionary *dictionary, const char *filename)
+{
+    memset(dictionary, 0, sizeof(StringDictionary));
+    dictionary->file = openFile(filename, "r+b");
+
+    if (dictionary->file == NULL)
+    {
+        return -1;
+    }
+
+    StringDictionaryHeader header;
+    long size = storageSize(dictionary->file);
+
+    if (fseek(dictionary->file, 0, SEEK_SET) != 0 ||
+        fread(&header, sizeof(StringDictionaryHeader), 1, dictionary->file) != 1 || header.count < 0 ||
+        size < (long)sizeof(StringDictionaryHeader) + (long)header.count * STRING_DICTIONARY_VALUE_SIZE)
+    {
+        fprintf(stderr, "Erro: o dicionário '%s' está inconsistente.\n", filename);
+        stringDictionaryClose(dictionary);
+        return -1;
+    }
+
+    int capacity = STRING_DICTIONARY_INITIAL_CAPACITY;
+
+    while (capacity < header.count)
+    {
+        capacity *= 2;
+    }
+
+    dictionary->capacity = capacity;
+    dictionary->slotCapacity = capacity * 2;
+    dictionary->values = malloc((size_t)capacity * STRING_DICTIONARY_VALUE_SIZE);
+    dictionary->slots = malloc(sizeof(int) * dictionary->slotCapacity);
+
+    if (dictionary->values == NULL || dictionary->slots == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o dicionário.\n");
+        stringDictionaryClose(dictionary);
+        return -1;
+    }
+
+    if (fread(dictionary->values, STRING_DICTIONARY_VALUE_SIZE, header.count, dictionary->file) != (size_t)header.count)
+    {
+        perror("Erro ao ler o dicionário");
+        stringDictionaryClose(dictionary);
+        return -1;
+    }
+
+    dictionary->header = header;
+    dictionary->flushedCount = header.count;
+    memset(dictionary->slots, -1, sizeof(int) * dictionary->slotCapacity);
+
+    for (int id = 0; id < header.count; id++)
+    {
+        dictionary->values[id][STRING_DICTIONARY_VALUE_SIZE - 1] = '\0';
+        dictionary->slots[findSlot(dictionary, dictionary->values[id])] = id;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Procura o identificador de um valor.
+ *
+ * @param dictionary Ponteiro para o dicionário aberto.
+ * @param value Valor normalizado.
+ *
+ * @return O identificador do valor, ou -1 se ele não estiver no dicionário.
+ */
+int stringDictionaryFind(const StringDictionary *dictionary, const char *value)
+{
+    return dictionary->slots[findSlot(dictionary, value)];
+}
+
+/**
+ * @brief Retorna o identificador de um valor, acrescentando-o ao dicionário se necessário.
+ *
+ * @param dictionary Ponteiro para o dicionário aberto.
+ * @param value Valor normalizado (com menos de `STRING_DICTIONARY_VALUE_SIZE` caracteres).
+ *
+ * @return O identificador do valor, ou -1 em caso de erro de memória.
+ */
+int stringDictionaryIntern(StringDictionary *dictionary, const char *value)
+{
+    int slot = findSlot(dictionary, value);
+
+    if (dictionary->slots[slot] != -1)
+    {
+        return dictionary->slots[slot];
+    }
+
+    if (dictionary->header.count == dictionary->capacity)
+    {
+        if (growDictionary(dictionary) != 0)
+        {
+            return -1;
+        }
+
+        slot = findSlot(dictionary, value);
+    }
+
+    int id = dictionary->header.count++;
+
+    // Preenche o valor inteiro para que o arquivo não receba bytes não inicializados
+    memset(dictionary->values[id], 0, STRING_DICTIONARY_VALUE_SIZE);
+    strncpy(dictionary->values[id], value, STRING_DICTIONARY_VALUE_SIZE - 1);
+    dictionary->slots[slot] = id;
+
+    return id;
+}
+
+/**
+ * @brief Retorna o valor de um identificador.
+ *
+ * @param dictionary Ponteiro para o dicionário aberto.
+ * @param id Identificador (entre 0 e `header.count - 1`).
+ *
+ * @return O valor normalizado.
+ */
+const char *stringDictionaryValue(const StringDictionary *dictionary, int id)
+{
+    return dictionary->values[id];
+}
+
+/**
+ * @brief Grava no arquivo os valores acrescentados desde a última gravação.
+ *
+ * @param dictionary Ponteiro para o dicionário aberto.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int stringDictionaryFlush(StringDictionary *dictionary)
+{
+    if (dictionary->file == NULL || dictionary->flushedCount == dictionary->header.count)
+    {
+        return 0;
+    }
+
+    int first = dictionary->flushedCount;
+    int count = dictionary->header.count - first;
+    long position = sizeof(StringDictionaryHeader) + (long)first * STRING_DICTIONARY_VALUE_SIZE;
+
+    // Os valores são gravados antes do cabeçalho, que só passa a contá-los depois
+    if (fseek(dictionary->file, position, SEEK_SET) != 0 ||
+        fwrite(dictionary->values[first], STRING_DICTIONARY_VALUE_SIZE, count, dictionary->file) != (size_t)count ||
+        fseek(dictionary->file, 0, SEEK_SET) != 0 ||
+        fwrite(&dictionary->header, sizeof(StringDictionaryHeader), 1, dictionary->file) != 1)
+    {
+        perror("Erro ao gravar o dicionário");
+        return -1;
+    }
+
+    fflush(dictionary->file);
+    dictionary->flushedCount = dictionary->header.count;
+
+    return 0;
+}
+
+/**
+ * @brief Grava os valores pendentes e fecha o dicionário.
+ *
+ * @param dictionary Ponteiro para o dicionário.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ */
+int stringDictionaryClose(StringDictionary *dictionary)
+{
+    int result = 0;
+
+    if (dictionary->file != NULL)
+    {
+        result = stringDictionaryFlush(dictionary);
+
+        if (closeFile(&dictionary->file) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    free(dictionary->values);
+    free(dictionary->slots);
+    dictionary->values = NULL;
+    dictionary->slots = NULL;
+
+    return result;
+}
@@ -0,0 +1,649 @@
+/**
+ * @file title_index.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o índice secundário persistente e ordenado de livros por título.
+ *
+ * A inserção segue o algoritmo clássico da árvore 2-3: a chave é colocada na folha correspondente e, quando um nó
+ * fica com três chaves, ele é dividido e a chave do meio sobe para o pai, podendo criar uma nova raiz.
+ *
+ * @see title_index.h
+ */
+
+#include "title_index.h"
+#include "file_manager.h"
+#include "storage.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Chave promovida para o nó pai após a divisão de um nó.
+ */
+typedef struct
+{
+    char key[TITLE_INDEX_KEY_SIZE]; // Título da chave promovida
+    int bookPosition;               // Posição do livro da chave promovida
+    char deleted;                   // 1 se a chave promovida está marcada como removida
+    int right;                      // Novo nó criado à direita da chave promovida
+} TitlePromotion;
+
+/**
+ * @brief Vetor dinâmico usado para acumular o resultado das buscas.
+ */
+typedef struct
+{
+    int *positions; // Posições encontradas
+    int count;      // Número de posições encontradas
+    int allocated;  // Capacidade do vetor
+    int limit;      // Número máximo de posições (0 = sem limite)
+} TitleCollector;
+
+/**
+ * @brief Calcula o deslocamento (em bytes) de um nó no arquivo do índice.
+ */
+static long nodePosition(int node)
+{
+    return sizeof(TitleIndexHeader) + (long)node * sizeof(TitleIndexNode);
+}
+
+/**
+ * @brief Lê um nó do arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int readNode(TitleIndex *index, int node, TitleIndexNode *out)
+{
+    if (fseek(index->file, nodePosition(node), SEEK_SET) != 0 ||
+        fread(out, sizeof(TitleIndexNode), 1, index->file) != 1)
+    {
+        fprintf(stderr, "Erro ao ler o nó %d do índice de títulos.\n", node);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Grava um nó no arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int writeNode(TitleIndex *index, int node, const TitleIndexNode *in)
+{
+    if (fseek(index->file, nodePosition(node), SEEK_SET) != 0 ||
+        fwrite(in, sizeof(TitleIndexNode), 1, index->file) != 1)
+    {
+        perror("Erro ao gravar nó no índice de títulos");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Inicializa um nó vazio (sem chaves e sem filhos).
+ */
+static void clearNode(TitleIndexNode *node)
+{
+    memset(node, 0, sizeof(TitleIndexNode));
+    node->bookPositions[0] = node->bookPositions[1] = -1;
+    node->children[0] = node->children[1] = node->children[2] = -1;
+}
+
+/**
+ * @brief Compara duas chaves (título, posição do livro).
+ *
+ * @return Valor negativo, zero ou positivo, como `strcmp`.
+ */
+static int compareKeys(const char *titleA, int positionA, const char *titleB, int positionB)
+{
+    int result = strcmp(titleA, titleB);
+
+    if (result != 0)
+    {
+        return result;
+    }
+
+    return (positionA > positionB) - (positionA < positionB);
+}
+
+/**
+ * @brief Insere uma chave no nó na posição `slot`, dividindo o nó se ele ficar com três chaves.
+ *
+ * @param right Filho à direita da nova chave (-1 nas folhas).
+ *
+ * @return 0 se o nó comportou a chave, 1 se o nó foi dividido (`promotion` é preenchida), -1 em caso de erro.
+ */
+static int placeKey(TitleIndex *index, int nodeAddress, TitleIndexNode *node, int slot,
+                    const char *key, int bookPosition, char deleted, int right, TitlePromotion *promotion)
+{
+    char keys[3][TITLE_INDEX_KEY_SIZE];
+    int positions[3];
+    char flags[3];
+    int children[4];
+    int n = node->nKeys;
+
+    // Monta as chaves e os filhos em vetores temporários, já com a nova chave na posição correta
+    for (int i = 0, j = 0; i <= n; i++)
+    {
+        if (i == slot)
+        {
+            memcpy(keys[i], key, TITLE_INDEX_KEY_SIZE);
+            positions[i] = bookPosition;
+            flags[i] = deleted;
+            continue;
+        }
+
+        memcpy(keys[i], node->keys[j], TITLE_INDEX_KEY_SIZE);
+        positions[i] = node->bookPositions[j];
+        flags[i] = node->deleted[j];
+        j++;
+    }
+
+    for (int i = 0, j = 0; i <= n + 1; i++)
+    {
+        children[i] = (i == slot + 1) ? right : node->children[j++];
+    }
+
+    if (n + 1 <= 2)
+    {
+        // O nó comporta a nova chave
+        node->nKeys = n + 1;
+        for (int i = 0; i < node->nKeys; i++)
+        {
+            memcpy(node->keys[i], keys[i], TITLE_INDEX_KEY_SIZE);
+            node->bookPositions[i] = positions[i];
+            node->deleted[i] = flags[i];
+        }
+        for (int i = 0; i <= node->nKeys; i++)
+        {
+            node->children[i] = children[i];
+        }
+
+        return writeNode(index, nodeAddress, node);
+    }
+
+    // Divide o nó: a primeira chave fica, a do meio sobe e a última vai para o novo nó
+    TitleIndexNode rightNode;
+    clearNode(&rightNode);
+    rightNode.nKeys = 1;
+    memcpy(rightNode.keys[0], keys[2], TITLE_INDEX_KEY_SIZE);
+    rightNode.bookPositions[0] = positions[2];
+    rightNode.deleted[0] = flags[2];
+    rightNode.children[0] = children[2];
+    rightNode.children[1] = children[3];
+
+    clearNode(node);
+    node->nKeys = 1;
+    memcpy(node->keys[0], keys[0], TITLE_INDEX_KEY_SIZE);
+    node->bookPositions[0] = positions[0];
+    node->deleted[0] = flags[0];
+    node->children[0] = children[0];
+    node->children[1] = children[1];
+
+    promotion->right = index->header.firstEmptyPosition++;
+    memcpy(promotion->key, keys[1], TITLE_INDEX_KEY_SIZE);
+    promotion->bookPosition = positions[1];
+    promotion->deleted = flags[1];
+    index->dirty = 1;
+
+    if (writeNode(index, nodeAddress, node) != 0 || writeNode(index, promotion->right, &rightNode) != 0)
+    {
+        return -1;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Insere recursivamente uma chave na subárvore com raiz em `nodeAddress`.
+ *
+ * @return 0 se a subárvore absorveu a chave, 1 se a raiz da subárvore foi dividida, -1 em caso de erro.
+ */
+static int insertRec(TitleIndex *index, int nodeAddress, const char *key, int bookPosition, TitlePromotion *promotion)
+{
+    TitleIndexNode node;
+
+    if (readNode(index, nodeAddress, &node) != 0)
+    {
+        return -1;
+    }
+
+    int slot = 0;
+
+    while (slot < node.nKeys)
+    {
+        int cmp = compareKeys(key, bookPosition, node.keys[slot], node.bookPositions[slot]);
+
+        if (cmp == 0)
+        {
+            // A chave já existe: apenas a reativa se estiver marcada como removida
+            if (node.deleted[slot])
+            {
+                node.deleted[slot] = 0;
+                index->header.keyCount++;
+                index->dirty = 1;
+                return writeNode(index, nodeAddress, &node);
+            }
+            return 0;
+        }
+
+        if (cmp < 0)
+        {
+            break;
+        }
+        slot++;
+    }
+
+    if (node.children[0] == -1)
+    {
+        // Folha: a chave é colocada diretamente no nó
+        index->header.keyCount++;
+        index->dirty = 1;
+        return placeKey(index, nodeAddress, &node, slot, key, bookPosition, 0, -1, promotion);
+    }
+
+    TitlePromotion childPromotion;
+    int result = insertRec(index, node.children[slot], key, bookPosition, &childPromotion);
+
+    if (result != 1)
+    {
+        return result;
+    }
+
+    // O filho foi dividido: a chave promovida é colocada neste nó
+    return placeKey(index, nodeAddress, &node, slot, childPromotion.key, childPromotion.bookPosition,
+                    childPromotion.deleted, childPromotion.right, promotion);
+}
+
+/**
+ * @brief Compara uma chave com o intervalo buscado.
+ *
+ * @return -1 se a chave é menor que todas as do intervalo, 0 se pertence ao intervalo, 1 se é maior.
+ */
+static int compareToRange(const char *key, const char *query, size_t length, int prefixMatch)
+{
+    int cmp = prefixMatch ? strncmp(key, query, length) : strcmp(key, query);
+
+    return (cmp > 0) - (cmp < 0);
+}
+
+/**
+ * @brief Acrescenta uma posição ao resultado da busca.
+ *
+ * @return 0 se a busca deve continuar, 1 se o limite foi atingido, -1 em caso de falta de memória.
+ */
+static int collectPosition(TitleCollector *collector, int bookPosition)
+{
+    if (collector->count == collector->allocated)
+    {
+        int newAllocated = collector->allocated == 0 ? 16 : collector->allocated * 2;
+        int *resized = realloc(collector->positions, sizeof(int) * newAllocated);
+
+        if (resized == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para a busca por título.\n");
+            return -1;
+        }
+
+        collector->positions = resized;
+        collector->allocated = newAllocated;
+    }
+
+    collector->positions[collector->count++] = bookPosition;
+
+    return (collector->limit > 0 && collector->count >= collector->limit) ? 1 : 0;
+}
+
+/**
+ * @brief Percorre em ordem a subárvore, visitando apenas os ramos que podem conter chaves do intervalo.
+ *
+ * @return 0 se a busca deve continuar, 1 se terminou (intervalo ultrapassado ou limite atingido), -1 em caso de erro.
+ */
+static int collectRange(TitleIndex *index, int nodeAddress, const char *query, size_t length, int prefixMatch,
+                        TitleCollector *collector)
+{
+    if (nodeAddress == -1)
+    {
+        return 0;
+    }
+
+    TitleIndexNode node;
+
+    if (readNode(index, nodeAddress, &node) != 0)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < node.nKeys; i++)
+    {
+        int cmp = compareToRange(node.keys[i], query, length, prefixMatch);
+
+        // Chaves menores que keys[i] só podem estar no intervalo se keys[i] não estiver antes dele
+        if (cmp >= 0)
+        {
+            int result = collectRange(index, node.children[i], query, length, prefixMatch, collector);
+            if (result != 0)
+            {
+                return result;
+            }
+        }
+
+        if (cmp > 0)
+        {
+            return 1; // Intervalo ultrapassado: as chaves seguintes são todas maiores
+        }
+
+        if (cmp == 0 && !node.deleted[i])
+        {
+            int result = collectPosition(collector, node.bookPositions[i]);
+            if (result != 0)
+            {
+                return result;
+            }
+        }
+    }
+
+    return collectRange(index, node.children[node.nKeys], query, length, prefixMatch, collector);
+}
+
+/**
+ * @brief Cria um novo índice de títulos vazio.
+ *
+ * @pre `index` e `filename` não devem ser NULL.
+ *
+ * @post O arquivo é criado (ou truncado) e o índice fica aberto, com o cabeçalho em memória.
+ *
+ * @param index Ponteiro para a estrutura do índice a ser inicializada.
+ * @param filename Nome do arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int titleIndexCreate(TitleIndex *index, const char *filename)
+{
+    index->file = openFile(filename, "w+b");
+
+    if (index->file == NULL)
+    {
+        return -1;
+    }
+
+    index->header.rootAddress = -1;
+    index->header.firstEmptyPosition = 0;
+    index->header.keyCount = 0;
+
+    index->dirty = 1;
+    return titleIndexFlush(index);
+}
+
+/**
+ * @brief Abre um índice de títulos existente.
+ *
+ * @pre `index` e `filename` não devem ser NULL.
+ *
+ * @post O índice fica aberto, com o cabeçalho lido do arquivo para a memória.
+ *
+ * @param index Ponteiro para a estrutura do índice a ser inicializada.
+ * @param filename Nome do arquivo do índice.
+ *
+ * @return 0 em caso de sucesso, -1 se o arquivo não puder ser lido ou estiver inconsistente.
+ */
+int titleIndexOpen(TitleIndex *index, const char *filename)
+{
+    index->dirty = 0;
+    index->file = openFile(filename, "r+b");
+
+    if (index->file == NULL)
+    {
+        return -1;
+    }
+
+    if (fseek(index->file, 0, SEEK_SET) != 0 || fread(&index->header, sizeof(TitleIndexHeader), 1, index->file) != 1 ||
+        index->header.firstEmptyPosition < 0 || index->header.keyCount < 0 || index->header.rootAddress < -1 ||
+        index->header.rootAddress >= index->header.firstEmptyPosition ||
+        storageSize(index->file) < nodePosition(index->header.firstEmptyPosition))
+    {
+        fprintf(stderr, "Erro: o índice de títulos '%s' está inconsistente.\n", filename);
+        closeFile(&index->file);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Insere a associação entre um título e a posição de um livro.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param title Título do livro (não precisa estar normalizado).
+ * @param bookPosition Posição do livro no arquivo de dados.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura ou gravação.
+ */
+int titleIndexInsert(TitleIndex *index, const char *title, int bookPosition)
+{
+    char key[TITLE_INDEX_KEY_SIZE] = {0};
+    TitlePromotion promotion;
+
+    normalizeString(title, key, sizeof(key));
+
+    if (index->header.rootAddress == -1)
+    {
+        // Árvore vazia: a raiz é uma folha com a única chave
+        TitleIndexNode root;
+        clearNode(&root);
+        root.nKeys = 1;
+        memcpy(root.keys[0], key, TITLE_INDEX_KEY_SIZE);
+        root.bookPositions[0] = bookPosition;
+
+        index->header.rootAddress = index->header.firstEmptyPosition++;
+        index->header.keyCount++;
+        index->dirty = 1;
+
+        return writeNode(index, index->header.rootAddress, &root);
+    }
+
+    int result = insertRec(index, index->header.rootAddress, key, bookPosition, &promotion);
+
+    if (result != 1)
+    {
+        return result;
+    }
+
+    // A raiz foi dividida: cria uma nova raiz com a chave promovida
+    TitleIndexNode root;
+    clearNode(&root);
+    root.nKeys = 1;
+    memcpy(root.keys[0], promotion.key, TITLE_INDEX_KEY_SIZE);
+    root.bookPositions[0] = promotion.bookPosition;
+    root.deleted[0] = promotion.deleted;
+    root.children[0] = index->header.rootAddress;
+    root.children[1] = promotion.right;
+
+    index->header.rootAddress = index->header.firstEmptyPosition++;
+    index->dirty = 1;
+
+    return writeNode(index, index->header.rootAddress, &root);
+}
+
+/**
+ * @brief Remove a associação entre um título e a posição de um livro.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param title Título usado na inserção.
+ * @param bookPosition Posição do livro no arquivo de dados.
+ *
+ * @return 0 se a chave foi removida, -1 se não foi encontrada ou em caso de erro.
+ *
+ * @note A chave é apenas marcada como removida; a estrutura da árvore não é alterada.
+ */
+int titleIndexRemove(TitleIndex *index, const char *title, int bookPosition)
+{
+    char key[TITLE_INDEX_KEY_SIZE] = {0};
+    int nodeAddress = index->header.rootAddress;
+
+    normalizeString(title, key, sizeof(key));
+
+    while (nodeAddress != -1)
+    {
+        TitleIndexNode node;
+
+        if (readNode(index, nodeAddress, &node) != 0)
+        {
+            return -1;
+        }
+
+        int slot = 0;
+
+        while (slot < node.nKeys)
+        {
+            int cmp = compareKeys(key, bookPosition, node.keys[slot], node.bookPositions[slot]);
+
+            if (cmp == 0)
+            {
+                if (node.deleted[slot])
+                {
+                    return -1; // Chave já removida
+                }
+
+                node.deleted[slot] = 1;
+                index->header.keyCount--;
+                index->dirty = 1;
+
+                return writeNode(index, nodeAddress, &node);
+            }
+
+            if (cmp < 0)
+            {
+                break;
+            }
+            slot++;
+        }
+
+        nodeAddress = node.children[slot];
+    }
+
+    return -1; // Chave não encontrada
+}
+
+/**
+ * @brief Retorna, em ordem de título, as posições dos livros cujo título é igual ao informado ou começa por ele.
+ *
+ * Apenas as subárvores que podem conter títulos no intervalo buscado são visitadas.
+ *
+ * @param index Ponteiro para o índice aberto.
+ * @param query Título (ou prefixo) a ser buscado. A comparação ignora maiúsculas e espaços extras.
+ * @param prefixMatch 0 para busca exata, diferente de 0 para busca por prefixo.
+ * @param limit Número máximo de posições retornadas (0 para não limitar).
+ * @param count Ponteiro onde será armazenado o número de posições retornadas.
+ *
+ * @return Vetor alocado dinamicamente com as posições (deve ser liberado com `free`), ou NULL se nenhum livro
+ *         for encontrado.
+ */
+int *titleIndexSearch(TitleIndex *index, const char *query, int prefixMatch, int limit, int *count)
+{
+    char normalized[TITLE_INDEX_KEY_SIZE];
+    TitleCollector collector = {NULL, 0, 0, limit};
+
+    normalizeString(query, normalized, sizeof(normalized));
+
+    collectRange(index, index->header.rootAddress, normalized, strlen(normalized), prefixMatch, &collector);
+
+    *count = collector.count;
+
+    if (collector.count == 0)
+    {
+        free(collector.positions);
+        return NULL;
+    }
+
+    return collector.positions;
+}
+
+/**
+ * @brief Remove todas as chaves do índice, mantendo o arquivo aberto.
+ *
+ * Usada para reconstruir o índice quando as posições dos livros mudam (por exemplo, na compactação). As chaves
+ * marcadas como removidas também deixam de ocupar o arquivo.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ *
+ * @post O arquivo é truncado para o cabeçalho.
+ */
+int titleIndexClear(TitleIndex *index)
+{
+    index->header.rootAddress = -1;
+    index->header.firstEmptyPosition = 0;
+    index->header.keyCount = 0;
+
+    index->dirty = 1;
+
+    if (titleIndexFlush(index) != 0)
+    {
+        return -1;
+    }
+
+    // Descarta os nós antigos
+    if (storageTruncate(index->file, nodePosition(0)) != 0)
+    {
+        perror("Erro ao truncar o índice de títulos");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Grava no arquivo o cabeçalho do índice, caso tenha sido modificado.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int titleIndexFlush(TitleIndex *index)
+{
+    if (index->file == NULL || !index->dirty)
+    {
+        return 0;
+    }
+
+    if (fseek(index->file, 0, SEEK_SET) != 0 ||
+        fwrite(&index->header, sizeof(TitleIndexHeader), 1, index->file) != 1)
+    {
+        perror("Erro ao gravar o cabeçalho do índice de títulos");
+        return -1;
+    }
+
+    fflush(index->file);
+    index->dirty = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Grava as alterações pendentes e fecha o índice de títulos.
+ *
+ * @param index Ponteiro para o índice aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int titleIndexClose(TitleIndex *index)
+{
+    if (index->file == NULL)
+    {
+        return 0;
+    }
+
+    int result = titleIndexFlush(index);
+
+    if (closeFile(&index->file) != 0)
+    {
+        result = -1;
+    }
+
+    return result;
+}
@@ -0,0 +1,393 @@
+/**
+ * @file tree_cursor.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o cursor para percorrer em ordem um intervalo de chaves do arquivo de índices.
+ *
+ * Na árvore 2-3 o percurso em ordem é feito com uma pilha explícita: cada nó da pilha lembra qual é a próxima chave
+ * a ser retornada e, depois de retornar uma chave, o cursor desce apenas pelo caminho mais à esquerda da subárvore
+ * seguinte. Assim, cada nó é lido uma única vez durante todo o percurso.
+ *
+ * @see tree_cursor.h
+ */
+
+#include "tree_cursor.h"
+#include "tree_manager.h"
+#include "file_manager.h"
+#include "book_data_file.h"
+#include "storage.h"
+#include "io_stats.h"
+#include "tree_lock.h"
+#include "key_search.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Posição de um livro no arquivo de dados e seu lugar no lote retornado.
+ */
+typedef struct
+{
+    int position; // Posição do livro no arquivo de dados
+    int slot;     // Índice do livro no vetor do lote
+} BatchEntry;
+
+/**
+ * @brief Retorna a i-ésima chave de um nó 2-3.
+ */
+static int keyAt(const Node23 *node, int i)
+{
+    return i == 0 ? node->left_key : node->right_key;
+}
+
+/**
+ * @brief Retorna a posição do livro da i-ésima chave de um nó 2-3.
+ */
+static int bookAt(const Node23 *node, int i)
+{
+    return i == 0 ? node->leftBook : node->rightBook;
+}
+
+/**
+ * @brief Retorna o i-ésimo filho de um nó 2-3 (-1 nas folhas).
+ */
+static int childAt(const Node23 *node, int i)
+{
+    if (node->left_child == -1)
+    {
+        return -1;
+    }
+
+    return i == 0 ? node->left_child : (i == 1 ? node->middle_child : node->right_child);
+}
+
+/**
+ * @brief Empilha um nó no cursor.
+ *
+ * @return 0 em caso de sucesso, -1 se a altura máxima for ultrapassada.
+ */
+static int pushFrame(TreeCursor *cursor, const Node23 *node, int next)
+{
+    if (cursor->depth == TREE_CURSOR_MAX_DEPTH)
+    {
+        fprintf(stderr, "Erro: altura da árvore 2-3 excede o limite do cursor.\n");
+        return -1;
+    }
+
+    cursor->stack[cursor->depth].node = *node;
+    cursor->stack[cursor->depth].next = next;
+    cursor->depth++;
+
+    return 0;
+}
+
+/**
+ * @brief Empilha o caminho mais à esquerda da subárvore com raiz em `address`.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int pushLeftmostPath(TreeCursor *cursor, int address)
+{
+    while (address != -1)
+    {
+        Node23 node = loadNode23(cursor->indexFile, address);
+
+        if (pushFrame(cursor, &node, 0) != 0)
+        {
+            return -1;
+        }
+
+        address = childAt(&node, 0);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Compara duas entradas do lote pela posição no arquivo de dados.
+ */
+static int compareBatchEntries(const void *a, const void *b)
+{
+    int x = ((const BatchEntry *)a)->position;
+    int y = ((const BatchEntry *)b)->position;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Posiciona o cursor na primeira chave maior ou igual a `low`.
+ *
+ * @param cursor Ponteiro para o cursor a ser inicializado.
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param low Menor chave do intervalo.
+ * @param high Maior chave do intervalo.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro. O cursor deve ser liberado com `treeRangeEnd` em ambos os casos.
+ */
+int treeRangeBegin(TreeCursor *cursor, FILE *indexFile, int low, int high)
+{
+    IndexFileHeader header;
+
+    cursor->indexFile = indexFile;
+    cursor->high = high;
+    cursor->finished = 0;
+    cursor->depth = 0;
+    cursor->leaf = NULL;
+    cursor->leafIndex = 0;
+    cursor->locked = 0;
+
+    // Com o acesso concorrente ligado, a trava de leitura é mantida até treeRangeEnd
+    if (treeLockRead(indexFile) != 0)
+    {
+        cursor->finished = 1;
+        return -1;
+    }
+
+    cursor->locked = 1;
+    readFileHeader(indexFile, &header, sizeof(IndexFileHeader));
+
+    if (header.rootAddress == -1 || low > high)
+    {
+        cursor->finished = 1;
+        return 0;
+    }
+
+    if (header.order > TWO_THREE_TREE_ORDER)
+    {
+        // Modo B+: basta localizar a folha de `low` e seguir o encadeamento
+        cursor->leaf = malloc(sizeof(BPlusNode));
+
+        if (cursor->leaf == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para o cursor.\n");
+            cursor->finished = 1;
+            return -1;
+        }
+
+        if (bplusTreeFindLeaf(indexFile, &header, low, cursor->leaf) == -1)
+        {
+            cursor->finished = 1;
+            return -1;
+        }
+
+        cursor->leafIndex = keySearchLowerBound(cursor->leaf->keys, cursor->leaf->nKeys, low);
+
+        return 0;
+    }
+
+    // Árvore 2-3: desce até `low`, empilhando cada nó com a próxima chave maior ou igual a `low`
+    int address = header.rootAddress;
+
+    while (address != -1)
+    {
+        Node23 node = loadNode23(indexFile, address);
+        int i = 0;
+
+        while (i < node.nKeys && keyAt(&node, i) < low)
+        {
+            i++;
+        }
+
+        if (pushFrame(cursor, &node, i) != 0)
+        {
+            cursor->finished = 1;
+            return -1;
+        }
+
+        if (i < node.nKeys && keyAt(&node, i) == low)
+        {
+            break; // As chaves menores da subárvore à esquerda não pertencem ao intervalo
+        }
+
+        address = childAt(&node, i);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Avança o cursor para a próxima chave do intervalo.
+ *
+ * @param cursor Ponteiro para o cursor.
+ * @param key Ponteiro onde a chave será armazenada.
+ * @param bookPosition Ponteiro onde a posição do livro associado será armazenada.
+ *
+ * @return 1 se uma chave foi retornada, 0 se o intervalo terminou, -1 em caso de erro.
+ */
+int treeRangeNext(TreeCursor *cursor, int *key, int *bookPosition)
+{
+    if (cursor->finished)
+    {
+        return 0;
+    }
+
+    if (cursor->leaf != NULL)
+    {
+        // Modo B+: passa para a próxima folha quando a atual se esgota
+        while (cursor->leafIndex >= cursor->leaf->nKeys)
+        {
+            if (cursor->leaf->next == -1)
+            {
+                cursor->finished = 1;
+                return 0;
+            }
+
+            if (bplusTreeLoadNode(cursor->indexFile, cursor->leaf->next, cursor->leaf) != 0)
+            {
+                cursor->finished = 1;
+                return -1;
+            }
+            cursor->leafIndex = 0;
+        }
+
+        *key = cursor->leaf->keys[cursor->leafIndex];
+        *bookPosition = cursor->leaf->values[cursor->leafIndex];
+        cursor->leafIndex++;
+    }
+    else
+    {
+        // Árvore 2-3: descarta os nós esgotados do topo da pilha
+        while (cursor->depth > 0 && cursor->stack[cursor->depth - 1].next >= cursor->stack[cursor->depth - 1].node.nKeys)
+        {
+            cursor->depth--;
+        }
+
+        if (cursor->depth == 0)
+        {
+            cursor->finished = 1;
+            return 0;
+        }
+
+        TreeCursorFrame *top = &cursor->stack[cursor->depth - 1];
+        int i = top->next++;
+
+        *key = keyAt(&top->node, i);
+        *bookPosition = bookAt(&top->node, i);
+
+        // A próxima chave em ordem é a menor da subárvore à direita da chave retornada
+        if (*key <= cursor->high && pushLeftmostPath(cursor, childAt(&top->node, i + 1)) != 0)
+        {
+            cursor->finished = 1;
+            return -1;
+        }
+    }
+
+    if (*key > cursor->high)
+    {
+        cursor->finished = 1;
+        return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Lê, em ordem de chave, os próximos livros do intervalo.
+ *
+ * As posições dos livros do lote são ordenadas e registros consecutivos no arquivo de dados são lidos com uma
+ * única leitura. Os livros são devolvidos na ordem das chaves.
+ *
+ * @param cursor Ponteiro para o cursor.
+ * @param dataFile Ponteiro para o arquivo de dados.
+ * @param books Vetor onde os livros serão armazenados.
+ * @param maxBooks Capacidade do vetor `books`.
+ *
+ * @return Número de livros lidos (0 quando o intervalo terminou), ou -1 em caso de erro.
+ */
+int treeRangeNextBooks(TreeCursor *cursor, FILE *dataFile, Book *books, int maxBooks)
+{
+    BatchEntry *entries = malloc(sizeof(BatchEntry) * maxBooks);
+    Book *buffer = malloc(sizeof(Book) * maxBooks);
+    int count = 0;
+    int key;
+    int result = 0;
+
+    if (entries == NULL || buffer == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a leitura em lote.\n");
+        free(entries);
+        free(buffer);
+        return -1;
+    }
+
+    // Coleta as posições do lote, na ordem das chaves
+    while (count < maxBooks && (result = treeRangeNext(cursor, &key, &entries[count].position)) == 1)
+    {
+        entries[count].slot = count;
+        count++;
+    }
+
+    // Lê os registros na ordem do arquivo, juntando posições consecutivas em uma única leitura
+    qsort(entries, count, sizeof(BatchEntry), compareBatchEntries);
+
+    // Antecipa todos os trechos do lote, para que o dispositivo os leia em paralelo (com um único trecho, não há o que
+    // antecipar)
+    for (int start = 0; start < count;)
+    {
+        int end = start + 1;
+
+        while (end < count && entries[end].position == entries[end - 1].position + 1)
+        {
+            end++;
+        }
+
+        if (start > 0 || end < count)
+        {
+            storagePrefetch(dataFile, sizeof(BookDataFileHeader) + (long)entries[start].position * sizeof(Book),
+                            sizeof(Book) * (end - start));
+        }
+
+        start = end;
+    }
+
+    for (int start = 0; result != -1 && start < count;)
+    {
+        int end = start + 1;
+
+        while (end < count && entries[end].position == entries[end - 1].position + 1)
+        {
+            end++;
+        }
+
+        int run = end - start;
+
+        if (IO_STATS_READ(IO_STATS_RECORD_READ, dataFile,
+                          sizeof(BookDataFileHeader) + (long)entries[start].position * sizeof(Book), buffer,
+                          sizeof(Book) * run) != 0)
+        {
+            perror("Erro ao ler os livros do intervalo");
+            result = -1;
+            break;
+        }
+
+        for (int i = 0; i < run; i++)
+        {
+            books[entries[start + i].slot] = buffer[i];
+        }
+
+        start = end;
+    }
+
+    free(entries);
+    free(buffer);
+
+    return result == -1 ? -1 : count;
+}
+
+/**
+ * @brief Libera os recursos do cursor.
+ *
+ * @param cursor Ponteiro para o cursor.
+ */
+void treeRangeEnd(TreeCursor *cursor)
+{
+    free(cursor->leaf);
+    cursor->leaf = NULL;
+    cursor->finished = 1;
+    cursor->depth = 0;
+
+    if (cursor->locked)
+    {
+        treeUnlock(cursor->indexFile);
+        cursor->locked = 0;
+    }
+}
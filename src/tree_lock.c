@@ -0,0 +1,246 @@
+/**
+ * @file tree_lock.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o protocolo de leitores e escritores do arquivo de índices.
+ *
+ * Cada entrada do registro guarda um `pthread_rwlock_t`. A reentrância é controlada por contadores locais a cada
+ * thread (um por entrada do registro): apenas a primeira obtenção de uma thread chega à trava, e apenas a última
+ * liberação a solta. Por isso a trava pode dar preferência aos escritores (o que, com obtenções de leitura
+ * aninhadas, poderia travar a thread), evitando que uma sequência de buscas adie as gravações indefinidamente.
+ *
+ * @see tree_lock.h
+ */
+
+#include "tree_lock.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TREE_LOCK_HAVE_THREADS 1
+#include <pthread.h>
+#else
+#define TREE_LOCK_HAVE_THREADS 0
+#endif
+
+#if TREE_LOCK_HAVE_THREADS
+/**
+ * @brief Trava de um arquivo de índices.
+ */
+typedef struct
+{
+    FILE *file;            // Arquivo de índices (NULL se a entrada estiver livre)
+    pthread_rwlock_t lock; // Trava de leitura e escrita
+} TreeLockEntry;
+
+static TreeLockEntry locks[TREE_LOCK_MAX_FILES];
+
+static _Thread_local int heldDepth[TREE_LOCK_MAX_FILES]; // Obtenções da trava pela thread atual
+static _Thread_local int heldWrite[TREE_LOCK_MAX_FILES]; // 1 se a thread atual detém a trava para escrita
+
+/**
+ * @brief Procura a entrada da trava de um arquivo.
+ *
+ * @return Índice da entrada, ou -1 se o acesso concorrente ao arquivo não estiver ligado.
+ */
+static int findLock(FILE *file)
+{
+    for (int i = 0; file != NULL && i < TREE_LOCK_MAX_FILES; i++)
+    {
+        if (locks[i].file == file)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Obtém a trava da entrada informada para leitura ou escrita, respeitando a reentrância.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int acquireLock(int index, int write)
+{
+    if (heldDepth[index] > 0)
+    {
+        if (write && !heldWrite[index])
+        {
+            fprintf(stderr, "Erro: a trava de leitura do índice não pode ser promovida para escrita.\n");
+            return -1;
+        }
+
+        heldDepth[index]++;
+        return 0;
+    }
+
+    int result = write ? pthread_rwlock_wrlock(&locks[index].lock) : pthread_rwlock_rdlock(&locks[index].lock);
+
+    if (result != 0)
+    {
+        fprintf(stderr, "Erro ao obter a trava do índice.\n");
+        return -1;
+    }
+
+    heldDepth[index] = 1;
+    heldWrite[index] = write;
+
+    return 0;
+}
+#endif
+
+/**
+ * @brief Liga o acesso concorrente ao arquivo de índices, criando a sua trava.
+ *
+ * @pre Nenhuma outra thread pode estar usando o arquivo.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ *
+ * @return 0 em caso de sucesso (ou se já estiver ligado), -1 se o limite de arquivos for atingido ou se a
+ *         plataforma não tiver `pthread`.
+ */
+int treeLockEnable(FILE *indexFile)
+{
+#if TREE_LOCK_HAVE_THREADS
+    if (findLock(indexFile) != -1)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < TREE_LOCK_MAX_FILES; i++)
+    {
+        if (locks[i].file == NULL)
+        {
+            pthread_rwlockattr_t attributes;
+            int result;
+
+            pthread_rwlockattr_init(&attributes);
+#ifdef __GLIBC__
+            // Sem preferência aos escritores, um fluxo contínuo de buscas impediria as inserções de prosseguir
+            pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+            result = pthread_rwlock_init(&locks[i].lock, &attributes);
+            pthread_rwlockattr_destroy(&attributes);
+
+            if (result != 0)
+            {
+                fprintf(stderr, "Erro ao criar a trava do índice.\n");
+                return -1;
+            }
+
+            locks[i].file = indexFile;
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "Erro: limite de índices com acesso concorrente atingido.\n");
+    return -1;
+#else
+    (void)indexFile;
+    fprintf(stderr, "Erro: acesso concorrente não disponível nesta plataforma.\n");
+    return -1;
+#endif
+}
+
+/**
+ * @brief Desliga o acesso concorrente ao arquivo de índices, destruindo a sua trava.
+ *
+ * @pre Nenhuma outra thread pode estar usando o arquivo, e a trava não pode estar obtida.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ */
+void treeLockDisable(FILE *indexFile)
+{
+#if TREE_LOCK_HAVE_THREADS
+    int index = findLock(indexFile);
+
+    if (index != -1)
+    {
+        pthread_rwlock_destroy(&locks[index].lock);
+        locks[index].file = NULL;
+    }
+#else
+    (void)indexFile;
+#endif
+}
+
+/**
+ * @brief Informa se o acesso concorrente ao arquivo de índices está ligado.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ *
+ * @return 1 se estiver ligado, 0 caso contrário.
+ */
+int treeLockIsEnabled(FILE *indexFile)
+{
+#if TREE_LOCK_HAVE_THREADS
+    return findLock(indexFile) != -1;
+#else
+    (void)indexFile;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Obtém a trava do arquivo de índices para leitura.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ *
+ * @return 0 em caso de sucesso (ou se o acesso concorrente não estiver ligado), -1 em caso de erro.
+ */
+int treeLockRead(FILE *indexFile)
+{
+#if TREE_LOCK_HAVE_THREADS
+    int index = findLock(indexFile);
+
+    return index == -1 ? 0 : acquireLock(index, 0);
+#else
+    (void)indexFile;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Obtém a trava do arquivo de índices para escrita.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ *
+ * @return 0 em caso de sucesso (ou se o acesso concorrente não estiver ligado), -1 em caso de erro ou se a thread
+ *         detiver apenas a trava de leitura.
+ */
+int treeLockWrite(FILE *indexFile)
+{
+#if TREE_LOCK_HAVE_THREADS
+    int index = findLock(indexFile);
+
+    return index == -1 ? 0 : acquireLock(index, 1);
+#else
+    (void)indexFile;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Libera a trava obtida com `treeLockRead` ou `treeLockWrite`.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ */
+void treeUnlock(FILE *indexFile)
+{
+#if TREE_LOCK_HAVE_THREADS
+    int index = findLock(indexFile);
+
+    if (index == -1 || heldDepth[index] == 0)
+    {
+        return;
+    }
+
+    // Apenas a última liberação da thread solta a trava
+    if (--heldDepth[index] == 0)
+    {
+        heldWrite[index] = 0;
+        pthread_rwlock_unlock(&locks[index].lock);
+    }
+#else
+    (void)indexFile;
+#endif
+}
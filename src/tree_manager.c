@@ -14,15 +14,25 @@
 #include "tree_manager.h"
 #include "two_three_tree.h"
 #include "file_manager.h"
+#include "node_cache.h"
+#include "bplus_tree.h"
+#include "storage.h"
+#include "page_allocator.h"
+#include "tree_lock.h"
+#include "io_stats.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 
 /**
  * @brief Salva um nó no arquivo de índices.
  *
  * Esta função é responsável por salvar um nó da árvore 2-3 no arquivo de índices. O nó é armazenado
- * na posição especificada pelo deslocamento fornecido. A operação é realizada utilizando a função
- * `fseek` para posicionar o ponteiro do arquivo e `fwrite` para gravar o conteúdo do nó.
+ * na posição especificada pelo deslocamento fornecido. A gravação é feita pela interface de armazenamento
+ * (`storageWrite`), que usa `stdio` ou o mapeamento em memória do arquivo.
+ *
+ * Quando o cache de nós está ativo, o nó é apenas marcado como sujo no cache e gravado no arquivo
+ * posteriormente (write-back).
  *
  * @pre O arquivo de índices deve estar aberto no modo de leitura e escrita. O nó a ser salvo deve
  *     ser válido e conter informações corretas.
@@ -37,8 +47,13 @@
  */
 static void saveNode(FILE *indexFile, int offset, Node23 *node)
 {
-    fseek(indexFile, offset, SEEK_SET);
-    fwrite(node, sizeof(Node23), 1, indexFile);
+    // Com o cache ativo, a gravação é adiada até a remoção do nó do cache ou até nodeCacheFlush
+    if (nodeCacheStore(indexFile, offset, node, 1) == 0)
+    {
+        return;
+    }
+
+    IO_STATS_WRITE(IO_STATS_NODE_WRITE, indexFile, offset, node, sizeof(Node23));
 }
 
 /**
@@ -63,16 +78,18 @@ static void saveNode(FILE *indexFile, int offset, Node23 *node)
  * @param middleChild Filho do meio, que aponta para a subárvore entre as chaves.
  * @param rightChild Filho da direita, que aponta para a subárvore à direita do nó.
  * @param nKeys Número de chaves no nó. Deve ser 2 para um nó 2-3 válido.
+ * @param hint Deslocamento de um nó relacionado (por exemplo, o irmão do novo nó), usado para alocar o novo nó
+ *             perto dele, ou -1 para o menor endereço livre.
  * @param header Ponteiro para o cabeçalho do arquivo de índices, contendo informações como a posição do
  *               primeiro nó livre.
  *
  * @return Inteiro representando o deslocamento (offset) do nó no arquivo de índices. Retorna -1 se houver
  *         algum erro durante o processo de criação ou gravação do nó.
  *
- * @note A função pode reutilizar um nó previamente apagado (se houver um nó livre), atualizando a posição
- *       do nó livre e o deslocamento do nó a ser reutilizado.
+ * @note A alocação é feita pelo alocador de unidades (`allocateIndexNode`), que reutiliza o nó livre mais
+ *       próximo de `hint` sem ler o arquivo e estende o arquivo em lotes quando não há nós livres.
  */
-int createNode23(FILE *indexFile, int leftKey, int rightKey, int leftBook, int rightBook, int leftChild, int middleChild, int rightChild, int nKeys, IndexFileHeader *header)
+int createNode23(FILE *indexFile, int leftKey, int rightKey, int leftBook, int rightBook, int leftChild, int middleChild, int rightChild, int nKeys, int hint, IndexFileHeader *header)
 {
     Node23 node;
     node.nKeys = nKeys;
@@ -84,45 +101,19 @@ int createNode23(FILE *indexFile, int leftKey, int rightKey, int leftBook, int r
     node.middle_child = middleChild;
     node.right_child = rightChild;
 
-    int nodeOffset;
-
-    // Reutiliza um nó livre, se houver
-    if (header->headEmptyPosition != -1)
-    {
-        // Carrega o nó livre
-        Node23 freeNode = loadNode23(indexFile, header->headEmptyPosition);
-
-        // Atualiza a cabeça da lista de nós livres
-        header->headEmptyPosition = freeNode.left_child;
+    // Reutiliza o nó livre mais próximo do nó de referência ou estende o arquivo de índices
+    int nodeOffset = allocateIndexNode(indexFile, header, hint);
 
-        // Atualiza o deslocamento do nó a ser reutilizado
-        nodeOffset = header->headEmptyPosition;
-    }
-    else
+    if (nodeOffset == -1)
     {
-        if (fseek(indexFile, 0, SEEK_END) != 0)
-        {
-            perror("Erro ao posicionar o cursor no final do arquivo de índices");
-            return -1;
-        }
-
-        nodeOffset = ftell(indexFile);
-
-        if (nodeOffset == -1)
-        {
-            perror("Erro ao obter o deslocamento do cursor no arquivo de índices");
-            return -1;
-        }
+        fprintf(stderr, "Erro ao alocar um nó no arquivo de índices.\n");
+        return -1;
     }
 
     saveNode(indexFile, nodeOffset, &node);
 
-    fseek(indexFile, 0, SEEK_SET);
-    if (fwrite(header, sizeof(IndexFileHeader), 1, indexFile) != 1)
-    {
-        perror("Erro ao escrever o cabeçalho no arquivo de índices");
-        return -1;
-    }
+    // Com o cabeçalho anexado em memória, a gravação no arquivo é adiada até o commit
+    saveHeader(indexFile, header, sizeof(IndexFileHeader));
 
     return nodeOffset;
 }
@@ -142,14 +133,23 @@ int createNode23(FILE *indexFile, int leftKey, int rightKey, int leftBook, int r
  *
  * @return Nó carregado do arquivo de índices.
  *
- * @note O nó é carregado a partir do deslocamento especificado no arquivo de índices.
+ * @note O nó é carregado a partir do deslocamento especificado no arquivo de índices. Se o nó estiver
+ *       no cache de nós, nenhum acesso ao arquivo é realizado.
  */
 Node23 loadNode23(FILE *indexFile, int offset)
 {
     Node23 node;
 
-    fseek(indexFile, offset, SEEK_SET);
-    fread(&node, sizeof(node), 1, indexFile);
+    // Consulta o cache antes de acessar o arquivo
+    if (nodeCacheLookup(indexFile, offset, &node))
+    {
+        return node;
+    }
+
+    if (IO_STATS_READ(IO_STATS_NODE_READ, indexFile, offset, &node, sizeof(node)) == 0)
+    {
+        nodeCacheStore(indexFile, offset, &node, 0);
+    }
 
     return node;
 }
@@ -184,11 +184,29 @@ int getRootAddress(FILE *file)
     return header.rootAddress;
 }
 
+/**
+ * @brief Retorna o i-ésimo filho de um nó 2-3.
+ */
+static int childAt(const Node23 *node, int i)
+{
+    return i == 0 ? node->left_child : (i == 1 ? node->middle_child : node->right_child);
+}
+
+/**
+ * @brief Retorna o índice do filho de um nó 2-3 que cobre `key`.
+ *
+ * O índice é a soma das comparações, sem desvios: se `key` é menor que a chave esquerda, também é menor que a direita.
+ */
+static int childIndexFor(const Node23 *node, int key)
+{
+    return (key >= node->left_key) + ((node->nKeys == 2) & (key >= node->right_key));
+}
+
 /**
  * @brief Realiza a busca de um nó na árvore 2-3.
  *
  * Esta função é responsável por realizar a busca de um nó na árvore 2-3 a partir de uma chave fornecida.
- * A busca é realizada de forma recursiva, descendo pela árvore a partir da raiz até o nó desejado,
+ * A busca é realizada de forma iterativa, descendo pela árvore a partir da raiz até o nó desejado,
  * comparando a chave de busca com as chaves presentes nos nós. A função retorna o endereço do nó
  * correspondente à chave buscada.
  *
@@ -201,39 +219,60 @@ int getRootAddress(FILE *file)
  * @param root Endereço (deslocamento) da raiz da árvore 2-3, utilizado como ponto de partida para a busca.
  * @param key Chave a ser buscada no nó da árvore 2-3.
  *
- * @return Inteiro representando o endereço do nó na árvore 2-3, que é o endereço (deslocamento) no arquivo de índices.
- *         Se a chave não for encontrada, a função retornará o endereço do nó onde a busca foi realizada.
+ * @return Posição do livro associado à chave no arquivo de dados, ou -1 se a chave não for encontrada.
  *
- * @note A busca é realizada recursivamente, descendo pela árvore 2-3. A função verifica primeiro a chave
+ * @note A busca é iterativa, descendo pela árvore 2-3. A função verifica primeiro a chave
  *       à esquerda do nó e, caso necessário, desce para os filhos do nó conforme a chave a ser buscada.
- *       Se a árvore tiver dois filhos, a chave à direita do nó também será verificada.
+ *       Se o nó tiver duas chaves, a chave à direita do nó também será verificada.
  */
 static int searchNode(FILE *file, int root, int key)
 {
-    Node23 node = loadNode23(file, root);
+    int offset = root;
+    int level = 0;
 
-    if (node.left_key == key)
+    // Chegar abaixo de uma folha (-1) significa que a chave não está na árvore
+    while (offset != -1)
     {
-        return root;
-    }
+        IO_STATS_LEVEL(level++);
+        Node23 node = loadNode23(file, offset);
 
-    if (node.nKeys == 2 && node.right_key == key)
-    {
-        return root;
-    }
+        if (node.left_key == key)
+        {
+            return node.leftBook;
+        }
 
-    if (key < node.left_key)
-    {
-        return searchNode(file, node.left_child, key);
+        if (node.nKeys == 2 && node.right_key == key)
+        {
+            return node.rightBook;
+        }
+
+        offset = childAt(&node, childIndexFor(&node, key));
     }
-    else if (node.nKeys == 1 || key < node.right_key)
+
+    return -1;
+}
+
+/**
+ * @brief Busca uma chave na árvore, sem obter a trava do índice.
+ *
+ * @return O mesmo valor de `twoThreeTreeSearch`.
+ */
+static int searchTree(FILE *file, int key)
+{
+    IndexFileHeader header;
+    readFileHeader(file, &header, sizeof(IndexFileHeader));
+
+    if (header.rootAddress == -1)
     {
-        return searchNode(file, node.middle_child, key);
+        return -1; // Árvore vazia
     }
-    else // key > node.right_key
+
+    if (header.order > TWO_THREE_TREE_ORDER)
     {
-        return searchNode(file, node.right_child, key);
+        return bplusTreeSearch(file, &header, key);
     }
+
+    return searchNode(file, header.rootAddress, key);
 }
 
 /**
@@ -251,60 +290,297 @@ static int searchNode(FILE *file, int root, int key)
  * @param file Ponteiro para o arquivo de índices, onde os nós da árvore 2-3 estão armazenados.
  * @param key Chave a ser buscada na árvore 2-3.
  *
- * @return Inteiro representando o endereço do nó na árvore 2-3 (arquivo de índices),
- *         ou -1 se a árvore estiver vazia.
+ * @return Posição do livro associado à chave no arquivo de dados, ou -1 se a chave não for encontrada
+ *         ou se a árvore estiver vazia.
  *
  * @note A função obtém o endereço da raiz da árvore 2-3 através da função `getRootAddress`
  *       e inicia a busca pela função `searchNode`. Se a árvore estiver vazia (não houver raiz),
  *       a função retorna -1.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a busca é delegada a `bplusTreeSearch`.
+ *
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), a busca obtém a trava do índice para leitura e pode ser
+ *       executada por várias threads ao mesmo tempo.
  */
 int twoThreeTreeSearch(FILE *file, int key)
 {
-    int root = getRootAddress(file);
+    if (treeLockRead(file) != 0)
+    {
+        return -1;
+    }
+
+    IO_STATS_BEGIN(IO_STATS_OP_SEARCH);
+    int result = searchTree(file, key);
+    IO_STATS_END();
+
+    treeUnlock(file);
+    return result;
+}
+
+/**
+ * @brief Chave de uma busca em lote e seu lugar no vetor de resultados.
+ */
+typedef struct
+{
+    int key;  // Chave buscada
+    int slot; // Índice da chave no lote
+} SearchEntry;
+
+/**
+ * @brief Compara duas entradas de uma busca em lote pela chave.
+ */
+static int compareSearchEntries(const void *a, const void *b)
+{
+    int x = ((const SearchEntry *)a)->key;
+    int y = ((const SearchEntry *)b)->key;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Antecipa a leitura de um nó 2-3 que ainda não está no cache.
+ */
+static void prefetchNode23(FILE *file, int offset)
+{
+    if (offset != -1 && !nodeCacheContains(file, offset))
+    {
+        storagePrefetch(file, offset, sizeof(Node23));
+    }
+}
+
+/**
+ * @brief Busca um trecho ordenado das chaves de um lote na subárvore 2-3 com raiz em `root`.
+ *
+ * O nó é lido uma única vez: as chaves iguais às do nó recebem a posição do livro, e as demais são divididas, sem
+ * perder a ordem, entre os filhos que as cobrem. As leituras dos filhos que recebem chaves são antecipadas antes da
+ * descida, para que fiquem em andamento ao mesmo tempo.
+ */
+static void searchNodeMany(FILE *file, int root, const int *keys, int n, int *positions)
+{
+    if (n == 0)
+    {
+        return;
+    }
 
     if (root == -1)
     {
-        return -1; // Árvore vazia
+        // Abaixo de uma folha: nenhuma das chaves está na árvore
+        for (int i = 0; i < n; i++)
+        {
+            positions[i] = -1;
+        }
+
+        return;
+    }
+
+    Node23 node = loadNode23(file, root);
+    int i = 0;
+
+    // Divide as chaves entre os filhos: [0, leftEnd), [middleStart, middleEnd) e [rightStart, n)
+    while (i < n && keys[i] < node.left_key)
+    {
+        i++;
+    }
+    int leftEnd = i;
+
+    while (i < n && keys[i] == node.left_key)
+    {
+        positions[i++] = node.leftBook;
+    }
+
+    int middleStart = i;
+    while (i < n && (node.nKeys == 1 || keys[i] < node.right_key))
+    {
+        i++;
+    }
+    int middleEnd = i;
+
+    if (node.nKeys == 2)
+    {
+        while (i < n && keys[i] == node.right_key)
+        {
+            positions[i++] = node.rightBook;
+        }
+    }
+    int rightStart = i;
+
+    // Só há o que antecipar quando mais de um filho será visitado
+    if ((leftEnd > 0) + (middleEnd > middleStart) + (node.nKeys == 2 && rightStart < n) > 1)
+    {
+        if (leftEnd > 0)
+        {
+            prefetchNode23(file, node.left_child);
+        }
+
+        if (middleEnd > middleStart)
+        {
+            prefetchNode23(file, node.middle_child);
+        }
+
+        if (node.nKeys == 2 && rightStart < n)
+        {
+            prefetchNode23(file, node.right_child);
+        }
+    }
+
+    searchNodeMany(file, node.left_child, keys, leftEnd, positions);
+    searchNodeMany(file, node.middle_child, keys + middleStart, middleEnd - middleStart, positions + middleStart);
+
+    if (node.nKeys == 2)
+    {
+        searchNodeMany(file, node.right_child, keys + rightStart, n - rightStart, positions + rightStart);
+    }
+}
+
+/**
+ * @brief Busca um lote de chaves já ordenadas na árvore, sem obter a trava do índice.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de leitura.
+ */
+static int searchTreeMany(FILE *file, const int *keys, int n, int *positions)
+{
+    IndexFileHeader header;
+    readFileHeader(file, &header, sizeof(IndexFileHeader));
+
+    if (header.order > TWO_THREE_TREE_ORDER)
+    {
+        return bplusTreeSearchMany(file, &header, keys, n, positions);
     }
 
-    return searchNode(file, root, key);
+    searchNodeMany(file, header.rootAddress, keys, n, positions);
+    return 0;
 }
 
 /**
- * @brief Adiciona uma chave em um nó que tem 1 chave.
+ * @brief Busca um lote de chaves na árvore com uma única descida compartilhada.
  *
- * Esta função é responsável por adicionar uma chave em um nó da árvore 2-3 que já contém uma chave,
- * atualizando o nó para armazenar duas chaves. A chave é inserida de forma que as chaves no nó fiquem ordenadas.
- * A chave inserida é comparada com a chave existente no nó para determinar a posição correta.
+ * As chaves são ordenadas e distribuídas entre os filhos de cada nó visitado: cada nó é lido uma única vez para
+ * todas as chaves do lote que passam por ele, de modo que os caminhos com prefixo comum (a raiz e os níveis
+ * superiores, para lotes grandes) não são relidos, e o cabeçalho é consultado apenas uma vez.
  *
- * @pre O nó deve ter espaço para 1 chave, ou seja, a variável `nKeys` deve ser 1.
+ * @pre O arquivo de índices deve estar aberto no modo de leitura e escrita.
  *
- * @post A chave é adicionada ao nó, atualizando as chaves do nó e a posição do livro.
+ * @param file Ponteiro para o arquivo de índices.
+ * @param keys Chaves a serem buscadas, em qualquer ordem (podem se repetir).
+ * @param n Número de chaves.
+ * @param positions Vetor que recebe, na ordem de `keys`, a posição do livro de cada chave no arquivo de dados
+ *                  (-1 se a chave não for encontrada).
  *
- * @param node Ponteiro para o nó onde a chave será inserida.
- * @param key Chave a ser adicionada ao nó.
- * @param bookPosition Posição do livro (dado) a ser inserido junto com a chave.
+ * @return Número de chaves encontradas, ou -1 em caso de erro de memória ou de leitura.
  *
- * @return Nenhum.
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a busca é delegada a `bplusTreeSearchMany`.
  *
- * @note A função compara a chave a ser inserida com a chave existente no nó e coloca a chave na posição
- *       correta, deslocando a chave existente para a posição da chave à direita, se necessário.
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), o lote inteiro é buscado com a trava do índice obtida
+ *       para leitura.
  */
-static void addKeyToNodeWithOneKey(Node23 *node, int key, int bookPosition)
+int twoThreeTreeSearchMany(FILE *file, const int *keys, int n, int *positions)
 {
-    if (node->left_key < key)
+    SearchEntry *entries = malloc(sizeof(SearchEntry) * (n > 0 ? n : 1));
+    int *sorted = malloc(sizeof(int) * 2 * (n > 0 ? n : 1)); // Chaves ordenadas seguidas das suas posições
+    int found = 0;
+
+    if (entries == NULL || sorted == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a busca em lote.\n");
+        free(entries);
+        free(sorted);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        entries[i].key = keys[i];
+        entries[i].slot = i;
+    }
+
+    qsort(entries, n, sizeof(SearchEntry), compareSearchEntries);
+
+    for (int i = 0; i < n; i++)
+    {
+        sorted[i] = entries[i].key;
+    }
+
+    if (treeLockRead(file) != 0)
     {
-        node->right_key = key;
-        node->rightBook = bookPosition;
+        found = -1;
     }
     else
     {
-        node->right_key = node->left_key;
-        node->rightBook = node->leftBook;
-        node->left_key = key;
-        node->leftBook = bookPosition;
+        IO_STATS_BEGIN(IO_STATS_OP_SEARCH);
+        found = searchTreeMany(file, sorted, n, sorted + n);
+        IO_STATS_END();
+        treeUnlock(file);
+    }
+
+    // Devolve as posições na ordem original das chaves
+    for (int i = 0; found != -1 && i < n; i++)
+    {
+        positions[entries[i].slot] = sorted[n + i];
+        found += sorted[n + i] != -1;
     }
-    node->nKeys = 2;
+
+    free(entries);
+    free(sorted);
+
+    return found;
+}
+
+/**
+ * @brief Nó visitado durante a descida da raiz até uma folha.
+ *
+ * - offset: Deslocamento (offset) do nó no arquivo de índices.
+ * - node: Cópia do nó em memória, alterada pelas operações e gravada com `saveNode`.
+ * - child: Índice (0, 1 ou 2) do filho pelo qual a descida continuou (não utilizado na folha).
+ */
+typedef struct
+{
+    int offset;
+    Node23 node;
+    int child;
+} TreePathEntry;
+
+/**
+ * @brief Caminho da raiz até uma folha, capturado durante a descida.
+ *
+ * As divisões, fusões e redistribuições percorrem o caminho de volta, de baixo para cima, usando os nós já
+ * carregados: o pai de cada nó é a entrada anterior do caminho, sem novas buscas a partir da raiz.
+ */
+typedef struct
+{
+    TreePathEntry entries[TREE_PATH_MAX_HEIGHT];
+    int depth; // Número de entradas do caminho
+} TreePath;
+
+/**
+ * @brief Copia as chaves, as posições dos livros e os filhos de um nó para vetores.
+ */
+static void unpackNode(const Node23 *node, int keys[3], int books[3], int children[4])
+{
+    keys[0] = node->left_key;
+    keys[1] = node->right_key;
+    books[0] = node->leftBook;
+    books[1] = node->rightBook;
+    children[0] = node->left_child;
+    children[1] = node->middle_child;
+    children[2] = node->right_child;
+}
+
+/**
+ * @brief Monta um nó a partir de vetores de chaves, posições dos livros e filhos.
+ *
+ * As posições sem chave ou sem filho recebem -1. Um nó sem chaves (durante a fusão) guarda o seu único filho em
+ * `left_child`.
+ */
+static void packNode(Node23 *node, int nKeys, const int keys[], const int books[], const int children[])
+{
+    node->nKeys = nKeys;
+    node->left_key = nKeys > 0 ? keys[0] : -1;
+    node->leftBook = nKeys > 0 ? books[0] : -1;
+    node->right_key = nKeys > 1 ? keys[1] : -1;
+    node->rightBook = nKeys > 1 ? books[1] : -1;
+    node->left_child = children[0];
+    node->middle_child = nKeys > 0 ? children[1] : -1;
+    node->right_child = nKeys > 1 ? children[2] : -1;
 }
 
 /**
@@ -331,191 +607,195 @@ static int isLeafNode(Node23 *node)
 }
 
 /**
- * @brief Realiza a divisão de um nó na árvore 2-3.
- *
- * Esta função é responsável por dividir um nó na árvore 2-3 quando ele não pode acomodar
- * mais de 2 chaves, promovendo a chave do meio para o nó pai e criando novos nós filhos.
+ * @brief Desce da raiz até a folha que contém (ou conteria) uma chave, registrando o caminho.
  *
- * @pre O nó pai e o nó a ser dividido devem estar corretamente carregados a partir do arquivo de índices.
- *      A chave a ser inserida já foi determinada.
- *
- * @post O nó é dividido e a chave do meio é promovida para o nó pai. O nó pai é atualizado com a nova chave.
- *       Um novo nó filho é criado para acomodar a chave inserida.
+ * Cada nó é lido uma única vez e guardado no caminho. Se a chave for encontrada em um nó interno, a descida
+ * continua até a folha com o sucessor em ordem (o nó mais à esquerda da subárvore à direita da chave), de modo que
+ * o caminho sirva tanto para a inserção quanto para a remoção.
  *
  * @param indexFile Ponteiro para o arquivo de índices.
- * @param parentNodeOffset Deslocamento (offset) do nó pai no arquivo de índices.
- * @param parentNode Ponteiro para o nó pai.
- * @param key Chave a ser inserida no nó.
- * @param promotedKey Ponteiro para armazenar a chave promovida para o nó pai.
- * @param subarvoreOffset Deslocamento (offset) da subárvore a ser associada ao novo nó.
- * @param header Cabeçalho do arquivo de índices, utilizado para gerenciar informações do arquivo.
- * @param leftBookOffset Deslocamento (offset) do livro associado à chave à esquerda do nó.
- * @param rightBookOffset Deslocamento (offset) do livro associado à chave à direita do nó.
- *
- * @return O deslocamento (offset) do nó direito criado ou atualizado após a divisão.
- *
- * @note O nó a ser dividido pode ter 1 ou 2 chaves, dependendo da condição de inserção.
- *       O comportamento da divisão varia dependendo da comparação da chave a ser inserida
- *       com as chaves do nó pai. Em cada caso, um novo nó é criado e o nó pai é atualizado.
+ * @param root Deslocamento (offset) da raiz (diferente de -1).
+ * @param key Chave procurada.
+ * @param path Caminho a ser preenchido; a última entrada é sempre uma folha.
+ * @param foundSlot Recebe o índice (0 ou 1) da chave no nó em que foi encontrada, ou -1.
+ *
+ * @return Nível (índice no caminho) do nó que contém a chave, -1 se a chave não estiver na árvore, ou -2 se a
+ *         altura da árvore exceder `TREE_PATH_MAX_HEIGHT`.
  */
-static int splitNode(FILE *indexFile, int parentNodeOffset, Node23 *parentNode, int key, int *promotedKey, int subarvoreOffset, IndexFileHeader *header, int leftBookOffset, int rightBookOffset)
+static int descendToLeaf(FILE *indexFile, int root, int key, TreePath *path, int *foundSlot)
 {
-    int rightNodeOffset;
+    int foundLevel = -1;
+    int offset = root;
 
-    // Se a chave a ser inserida é maior que a chave à direita
-    if (key > parentNode->right_key)
-    {
-        // Promove a antiga maior chave
-        *promotedKey = parentNode->right_key;
-
-        // Cria um novo nó à direita
-        rightNodeOffset = createNode23(indexFile, key, -1, rightBookOffset, -1, subarvoreOffset, -1, -1, 1, header);
+    *foundSlot = -1;
+    path->depth = 0;
 
-        // Atualiza o nó pai
-        parentNode->nKeys = 1;                     // O nó pai terá 1 chave
-        parentNode->right_key = -1;                // A chave da direita será nula
-        parentNode->rightBook = -1;                // A posição do livro associada à chave da direita será nula
-        parentNode->right_child = rightNodeOffset; // O filho à direita será nulo
-        parentNode->middle_child = -1;             // O filho do meio será nulo
+    while (offset != -1)
+    {
+        if (path->depth == TREE_PATH_MAX_HEIGHT)
+        {
+            fprintf(stderr, "Erro: altura da árvore 2-3 maior que o suportado.\n");
+            return -2;
+        }
 
-        return rightNodeOffset;
-    }
+        TreePathEntry *entry = &path->entries[path->depth++];
 
-    if (key >= parentNode->left_key) // Se a chave a ser inserida é maior que a chave à esquerda e menor que a chave à direita
-    {
-        // Promove a chave do meio
-        *promotedKey = key;
+        IO_STATS_LEVEL(path->depth);
+        entry->offset = offset;
+        entry->node = loadNode23(indexFile, offset);
 
-        // Cria um novo nó à direita
-        rightNodeOffset = createNode23(indexFile, parentNode->right_key, -1, parentNode->rightBook, -1, -1, -1, -1, 1, header);
+        if (isLeafNode(&entry->node))
+        {
+            entry->child = -1;
+            break;
+        }
 
-        // Atualiza o nó pai (muda a chave à direita para a chave inserida)
-        parentNode->nKeys = 1;                      // O nó pai terá 1 chave
-        parentNode->right_key = -1;                 // A chave da direita será nula
-        parentNode->rightBook = -1;                 // A posição do livro associada à chave da direita será nula
-        parentNode->right_child = -1;               // O filho à direita será nulo
-        parentNode->middle_child = rightNodeOffset; // O filho do meio será o novo nó criado
+        if (foundLevel != -1)
+        {
+            entry->child = 0; // Em busca do sucessor: sempre o filho mais à esquerda
+        }
+        else if (entry->node.left_key == key || (entry->node.nKeys == 2 && entry->node.right_key == key))
+        {
+            // A chave está neste nó interno: o sucessor é o menor valor da subárvore à direita da chave
+            foundLevel = path->depth - 1;
+            *foundSlot = entry->node.left_key == key ? 0 : 1;
+            entry->child = *foundSlot + 1;
+        }
+        else
+        {
+            entry->child = childIndexFor(&entry->node, key);
+        }
 
-        return rightNodeOffset;
+        offset = childAt(&entry->node, entry->child);
     }
 
-    // Se a chave a ser inserida é menor que a chave à esquerda
-    if (key < parentNode->left_key)
+    if (foundLevel == -1)
     {
-        // Promove a chave da esquerda
-        *promotedKey = parentNode->left_key;
+        Node23 *leaf = &path->entries[path->depth - 1].node;
 
-        // Cria um novo nó à direita
-        rightNodeOffset = createNode23(indexFile, parentNode->right_key, -1, parentNode->rightBook, -1, -1, -1, -1, 1, header);
-
-        // Atualiza o nó pai
-        parentNode->nKeys = 1;                      // O nó pai terá 1 chave
-        parentNode->left_key = key;                 // A chave da esquerda será a chave inserida
-        parentNode->right_key = -1;                 // A chave da direita será nula
-        parentNode->rightBook = -1;                 // A posição do livro associada à chave da direita será nula
-        parentNode->right_child = -1;               // O filho à direita será nulo
-        parentNode->middle_child = rightNodeOffset; // O filho do meio será nulo
-
-        return rightNodeOffset;
+        if (leaf->left_key == key || (leaf->nKeys == 2 && leaf->right_key == key))
+        {
+            foundLevel = path->depth - 1;
+            *foundSlot = leaf->left_key == key ? 0 : 1;
+        }
     }
+
+    return foundLevel;
 }
 
 /**
- * @brief Função auxiliar recursiva para inserção de uma chave em uma árvore 2-3.
- *
- * Esta função insere uma chave na árvore 2-3, propagando a inserção recursivamente até
- * alcançar um nó folha. Caso um nó ultrapasse sua capacidade máxima de chaves, ele será
- * dividido e a chave promovida para o nó pai. O processo pode envolver divisões
- * recursivas até a raiz.
+ * @brief Insere uma chave na árvore, sem obter a trava do índice.
  *
- * @pre O arquivo de índice deve estar aberto no modo de leitura e escrita. O nó pai e o nó
- *     atual devem estar corretamente carregados a partir do arquivo de índice. O cabeçalho
- *    do arquivo de índice deve estar carregado e disponível para atualização.
+ * A inserção desce uma única vez até a folha, registrando o caminho, e sobe por ele: um nó com uma chave absorve a
+ * chave (e a subárvore à sua direita) e a operação termina; um nó com duas chaves é dividido, ficando com a menor
+ * chave, enquanto a maior vai para um novo nó à direita e a do meio é promovida ao pai, que já está em memória.
+ * Se a raiz for dividida, uma nova raiz é criada.
  *
- * @post A chave é inserida na árvore 2-3, com divisões de nós conforme necessário.
- *
- * @param indexFile Ponteiro para o arquivo de índice onde a árvore é armazenada.
- * @param parentNodeOffset Deslocamento do nó pai no arquivo de índice.
- * @param parentNode Ponteiro para o nó pai na árvore 2-3.
- * @param key A chave a ser inserida na árvore.
- * @param promotedKey Ponteiro para a chave promovida do nó dividido, se houver.
- * @param subarvoreOffset Deslocamento da subárvore usada para a inserção.
- * @param header Ponteiro para o cabeçalho do arquivo de índice.
- * @param leftBookOffset Deslocamento do livro à esquerda no arquivo de índice.
- * @param rightBookOffset Deslocamento do livro à direita no arquivo de índice.
- * @return O deslocamento do nó pai após a inserção. Caso haja uma divisão, retorna o deslocamento do nó pai
- *         atualizado; caso contrário, retorna -1 indicando que não houve divisão.
- *
- * @note A função realiza a inserção de forma recursiva e cuida das divisões de nós conforme necessário.
- *       Ela também lida com a descida para os filhos apropriados com base na chave a ser inserida.
+ * @return O mesmo valor de `insertKey`.
  */
-static int insertKeyAux(FILE *indexFile, int parentNodeOffset, Node23 *parentNode, int key, int *promotedKey, int subarvoreOffset, IndexFileHeader *header, int leftBookOffset, int rightBookOffset)
+static int insertKeyInTree(FILE *indexFile, int key, int bookPosition, IndexFileHeader *header)
 {
-    // Caso o nó seja folha, o processo de inserção é direto ou envolve uma divisão.
-    if (isLeafNode(parentNode))
+    if (header->order > TWO_THREE_TREE_ORDER)
     {
-        // Caso o nó tenha apenas uma chave, adiciona a nova chave e salva o nó.
-        if (parentNode->nKeys == 1)
-        {
-            addKeyToNodeWithOneKey(parentNode, key, leftBookOffset);
-            saveNode(indexFile, parentNodeOffset, parentNode);
-            return parentNodeOffset;
-        }
-        // Caso o nó tenha duas chaves, é necessário dividir o nó.
-        else
-        {
-            return splitNode(indexFile, parentNodeOffset, parentNode, key, promotedKey, subarvoreOffset, header, leftBookOffset, rightBookOffset);
-        }
+        return bplusTreeInsert(indexFile, key, bookPosition, header);
     }
-    else // Caso o nó não seja folha, desce na árvore.
+
+    // Se a árvore está vazia, cria a raiz com a chave inserida
+    if (header->rootAddress == -1)
     {
-        Node23 auxTree;
-        int auxKey;
+        int newRoot = createNode23(indexFile, key, -1, bookPosition, -1, -1, -1, -1, 1, -1, header);
 
-        // Determina para qual filho descer, dependendo da chave a ser inserida.
-        if (key < parentNode->left_key) // Desce para o filho da esquerda.
+        if (newRoot == -1)
         {
-            auxTree = loadNode23(indexFile, parentNode->left_child);
-            auxKey = insertKeyAux(indexFile, parentNode->left_child, &auxTree, key, promotedKey, subarvoreOffset, header, leftBookOffset, rightBookOffset);
+            return -1;
         }
-        else if (parentNode->nKeys == 1 || key < parentNode->right_key) // Desce para o filho do meio.
+
+        header->rootAddress = newRoot;
+        saveHeader(indexFile, header, sizeof(IndexFileHeader));
+
+        return 0;
+    }
+
+    TreePath path;
+    int foundSlot;
+
+    if (descendToLeaf(indexFile, header->rootAddress, key, &path, &foundSlot) != -1)
+    {
+        return -1; // Chave já existente (ou árvore alta demais)
+    }
+
+    // Chave, livro e subárvore à direita que sobem pelo caminho
+    int carryKey = key;
+    int carryBook = bookPosition;
+    int carryChild = -1;
+
+    for (int level = path.depth - 1; level >= 0; level--)
+    {
+        TreePathEntry *entry = &path.entries[level];
+        int keys[3], books[3], children[4];
+        int slot = childIndexFor(&entry->node, carryKey);
+
+        IO_STATS_LEVEL(level);
+        unpackNode(&entry->node, keys, books, children);
+
+        // Abre espaço para a chave na posição `slot` e para a subárvore logo à sua direita
+        for (int i = entry->node.nKeys; i > slot; i--)
         {
-            auxTree = loadNode23(indexFile, parentNode->middle_child);
-            auxKey = insertKeyAux(indexFile, parentNode->middle_child, &auxTree, key, promotedKey, subarvoreOffset, header, leftBookOffset, rightBookOffset);
+            keys[i] = keys[i - 1];
+            books[i] = books[i - 1];
+            children[i + 1] = children[i];
         }
-        else // Desce para o filho da direita.
+
+        keys[slot] = carryKey;
+        books[slot] = carryBook;
+        children[slot + 1] = carryChild;
+
+        if (entry->node.nKeys == 1)
         {
-            auxTree = loadNode23(indexFile, parentNode->right_child);
-            auxKey = insertKeyAux(indexFile, parentNode->right_child, &auxTree, key, promotedKey, subarvoreOffset, header, leftBookOffset, rightBookOffset);
+            packNode(&entry->node, 2, keys, books, children);
+            saveNode(indexFile, entry->offset, &entry->node);
+            return 0;
         }
 
-        // Se não houve divisão, retorna -1.
-        if (auxKey == -1)
+        // Nó cheio: fica com a menor chave, a maior vai para um novo nó e a do meio sobe
+        int rightNode = createNode23(indexFile, keys[2], -1, books[2], -1, children[2], children[3], -1, 1,
+                                     entry->offset, header);
+
+        if (rightNode == -1)
         {
             return -1;
         }
 
-        // Se o nó tem espaço para a chave promovida, adiciona a chave e salva o nó.
-        if (parentNode->nKeys == 1)
-        {
-            addKeyToNodeWithOneKey(parentNode, auxKey, leftBookOffset);
-            saveNode(indexFile, parentNodeOffset, parentNode);
-            return parentNodeOffset;
-        }
-        // Caso o nó esteja cheio, é necessário realizar uma divisão.
-        else
-        {
-            return splitNode(indexFile, parentNodeOffset, parentNode, auxKey, promotedKey, subarvoreOffset, header, leftBookOffset, rightBookOffset);
-        }
+        packNode(&entry->node, 1, keys, books, children);
+        saveNode(indexFile, entry->offset, &entry->node);
+
+        carryKey = keys[1];
+        carryBook = books[1];
+        carryChild = rightNode;
+    }
+
+    // A raiz foi dividida: a chave promovida forma a nova raiz
+    int newRoot = createNode23(indexFile, carryKey, -1, carryBook, -1, header->rootAddress, carryChild, -1, 1,
+                               header->rootAddress, header);
+
+    if (newRoot == -1)
+    {
+        return -1;
     }
+
+    header->rootAddress = newRoot;
+    saveHeader(indexFile, header, sizeof(IndexFileHeader));
+
+    return 0;
 }
 
 /**
  * @brief Insere uma chave na árvore 2-3.
  *
  * Esta função é responsável por inserir uma chave na árvore 2-3, criando um nó raiz caso a árvore esteja vazia
- * ou realizando a inserção recursiva nos nós existentes. Caso haja uma divisão de nó, a chave promovida será
- * colocada em um novo nó raiz. O cabeçalho do arquivo de índice será atualizado conforme necessário.
+ * ou descendo até a folha adequada e subindo pelo caminho percorrido, dividindo os nós cheios. Caso a raiz seja
+ * dividida, a chave promovida será colocada em um novo nó raiz. O cabeçalho do arquivo de índice será atualizado
+ * conforme necessário.
  *
  * @pre O arquivo de índice deve estar aberto no modo de leitura e escrita. O cabeçalho do arquivo de índice
  *     deve estar carregado e disponível para atualização. A chave a ser inserida deve ser fornecida.
@@ -528,520 +808,278 @@ static int insertKeyAux(FILE *indexFile, int parentNodeOffset, Node23 *parentNod
  * @param bookPosition Posição do livro associada à chave a ser inserida.
  * @param header Ponteiro para o cabeçalho do arquivo de índice, que contém informações da árvore, incluindo o endereço da raiz.
  *
- * @return O endereço do nó raiz após a inserção. Caso não haja divisão de nó, retorna `0` indicando sucesso.
+ * @return 0 em caso de sucesso, ou -1 se a chave já existir na árvore ou se não for possível alocar um nó.
+ *
+ * @note Os nós do caminho da raiz até a folha são lidos uma única vez, na descida; as divisões reutilizam essas
+ *       cópias em memória, sem buscas adicionais pelo pai de cada nó.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a inserção é delegada a `bplusTreeInsert`.
  *
- * @note Se a árvore estiver vazia, um novo nó raiz será criado com a chave inserida. Caso contrário, a inserção
- *       será realizada recursivamente, e se necessário, a árvore será reestruturada com a criação de um novo nó raiz
- *       para acomodar a chave promovida.
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), a inserção obtém a trava do índice para escrita.
  */
 int insertKey(FILE *indexFile, int key, int bookPosition, IndexFileHeader *header)
 {
-    // Recupera o endereço da raiz da árvore
-    int root = getRootAddress(indexFile);
-
-    // Se a árvore está vazia
-    if (root == -1)
+    if (treeLockWrite(indexFile) != 0)
     {
-        // Cria um novo nó raiz com a chave inserida
-        int newRoot = createNode23(indexFile, key, -1, bookPosition, -1, -1, -1, -1, 1, header);
+        return -1;
+    }
 
-        // Atualiza o endereço da raiz no cabeçalho
-        header->rootAddress = newRoot;
-        saveHeader(indexFile, header, sizeof(IndexFileHeader));
+    IO_STATS_BEGIN(IO_STATS_OP_INSERT);
+    int result = insertKeyInTree(indexFile, key, bookPosition, header);
+    IO_STATS_END();
 
-        return newRoot;
-    }
-    else
-    {
-        // Carrega o nó raiz existente
-        Node23 rootNode = loadNode23(indexFile, root);
-
-        int promotedKey;
-        // Insere a chave recursivamente na árvore
-        int newRoot = insertKeyAux(indexFile, root, &rootNode, key, &promotedKey, -1, header, bookPosition, -1);
-
-        if (newRoot != -1)
-        {
-            // Caso tenha ocorrido uma divisão, cria um novo nó raiz
-            newRoot = createNode23(indexFile, promotedKey, -1, -1, -1, root, newRoot, -1, 1, header);
-
-            // Atualiza o cabeçalho com o novo endereço da raiz
-            header->rootAddress = newRoot;
-            saveHeader(indexFile, header, sizeof(IndexFileHeader));
-        }
-        else
-        {
-            // Se não houve divisão, apenas salva o nó raiz atualizado
-            saveNode(indexFile, root, &rootNode);
-        }
-    }
-
-    return 0; // Retorna 0 para indicar sucesso
+    treeUnlock(indexFile);
+    return result;
 }
 
 /**
- * @brief Remove uma chave de um nó folha na árvore 2-3.
- *
- * Esta função é responsável por remover uma chave de um nó folha da árvore 2-3. Se a chave a ser removida
- * for a chave à esquerda, ela é substituída pela chave à direita. Se a chave removida for a chave à direita,
- * ela é simplesmente apagada. Após a remoção, o número de chaves do nó é atualizado.
- *
- * @pre O nó passado deve ser um nó folha da árvore 2-3. A chave a ser removida deve existir no nó.
- *
- * @post A chave é removida do nó folha, e o número de chaves é atualizado.
- *
- * @param node Ponteiro para o nó folha de onde a chave será removida.
- * @param key A chave a ser removida do nó.
+ * @brief Marca um nó como livre e o devolve ao alocador.
  *
- * @note Esta função assume que o nó passado é um nó folha. Se a chave removida for a chave à esquerda,
- *       a chave à direita é movida para a posição da chave à esquerda. Se a chave removida for a chave à direita,
- *       ela é removida diretamente, e o número de chaves do nó é decrementado.
+ * @param indexFile Ponteiro para o arquivo de índice onde os nós da árvore 2-3 são armazenados.
+ * @param nodeOffset Deslocamento (offset) do nó.
+ * @param node Ponteiro para o nó liberado.
+ * @param header Cabeçalho do arquivo de índice.
  */
-static void removeKeyFromLeaf(Node23 *node, int key)
+static void releaseNode(FILE *indexFile, int nodeOffset, Node23 *node, IndexFileHeader *header)
 {
-    // Verifica qual chave remover
-    if (node->left_key == key)
-    {
-        // Move a chave da direita para a esquerda
-        node->left_key = node->right_key;
-        node->leftBook = node->rightBook;
+    // Marca o nó como livre (o encadeamento é gravado pelo alocador no commit)
+    node->nKeys = 0;
+    saveNode(indexFile, nodeOffset, node);
 
-        // Limpa a chave da direita e a posição do livro associada
-        node->right_key = -1;
-        node->rightBook = -1;
-    }
-    else if (node->right_key == key)
+    if (pageAllocatorIsAttached(indexFile) || attachIndexAllocator(indexFile, header) == 0)
     {
-        // Remove a chave da direita
-        node->right_key = -1;
-        node->rightBook = -1;
+        pageRelease(indexFile, nodeOffset);
     }
-    else
-    {
-        // Chave não encontrada
-        return;
-    }
-
-    // Atualiza o número de chaves
-    node->nKeys--;
 }
 
 /**
- * @brief Encontra o endereço do pai de um nó na árvore 2-3.
+ * @brief Libera a raiz que ficou sem chaves e promove a subárvore restante.
  *
- * Esta função realiza a busca do pai de um nó na árvore 2-3. Dado o endereço do nó e sua chave,
- * ela determina se o nó em questão é filho esquerdo, do meio ou direito de um nó pai. Se o nó
- * não for encontrado ou não tiver um pai válido, a função retorna -1.
+ * Depois de uma fusão na raiz, ela fica sem chaves e com no máximo um filho, que passa a ser a nova raiz (ou a
+ * árvore fica vazia, se a raiz era uma folha). O nó é marcado como livre e devolvido ao alocador.
  *
- * @param indexFile Ponteiro para o arquivo de índice onde a árvore está armazenada.
- * @param parentAddress Endereço do nó pai a ser verificado.
- * @param parentNode Ponteiro para o nó pai que contém as referências aos filhos.
- * @param nodeAddress Endereço do nó filho cujo pai está sendo buscado.
- * @param key A chave a ser verificada para determinar a relação com o nó pai.
+ * @param indexFile Ponteiro para o arquivo de índice onde os nós da árvore 2-3 são armazenados.
+ * @param nodeOffset Deslocamento (offset) da raiz vazia.
+ * @param node Ponteiro para a raiz vazia.
+ * @param header Cabeçalho do arquivo de índice.
  *
- * @pre O nó pai (`parentNode`) deve estar carregado e o endereço do nó filho (`nodeAddress`)
- *      deve ser válido. O arquivo de índice deve estar acessível e conter a árvore 2-3.
+ * @pre O arquivo de índice deve estar aberto e válido, e o cabeçalho deve estar carregado corretamente.
  *
- * @post Se o nó for encontrado e for filho esquerdo, do meio ou direito, o endereço do pai
- *       será retornado. Se o nó não tiver pai ou não for encontrado, retorna -1.
+ * @post `header->rootAddress` aponta para o único filho da raiz antiga (ou é -1) e o nó pode ser reutilizado
+ *       pela próxima alocação.
+ */
+static void handleEmptyNode(FILE *indexFile, int nodeOffset, Node23 *node, IndexFileHeader *header)
+{
+    header->rootAddress = node->left_child;
+
+    releaseNode(indexFile, nodeOffset, node, header);
+    saveHeader(indexFile, header, sizeof(IndexFileHeader));
+}
+
+/**
+ * @brief Trata, subindo pelo caminho, o underflow de um nó que ficou sem chaves.
  *
- * @return O endereço do pai do nó se encontrado, ou -1 caso contrário.
+ * O nó vazio guarda o seu único filho em `left_child` (-1 nas folhas). Se o irmão adjacente (o da esquerda, quando
+ * existe, ou o da direita) tiver duas chaves, uma delas passa pelo pai e a árvore está equilibrada
+ * (redistribuição). Caso contrário, o nó vazio, a chave separadora do pai e o irmão são fundidos no irmão; o pai
+ * perde uma chave e, se ficar vazio, o tratamento continua no nível de cima. Os pais já estão no caminho, de modo
+ * que apenas o irmão de cada nível é lido do arquivo.
  *
- * @note A função assume que o nó pai é um nó não folha. Se o nó filho for folha, a função
- *       retorna imediatamente -1, pois folhas não têm pais.
+ * @param indexFile Ponteiro para o arquivo de índice.
+ * @param path Caminho da raiz até o nó vazio (a última entrada).
+ * @param header Cabeçalho do arquivo de índice.
  */
-static int findParentAux(FILE *indexFile, int parentAddress, Node23 *parentNode, int nodeAddress, int key)
+static void fixUnderflow(FILE *indexFile, TreePath *path, IndexFileHeader *header)
 {
-    if (isLeafNode(parentNode))
-    {
-        return -1; // Nó folha, não tem pai
-    }
+    int level = path->depth - 1;
 
-    // Verificando se o nodeAddres é filho da esquerda, meio ou direita
-    if (parentNode->left_child == nodeAddress)
+    while (level > 0 && path->entries[level].node.nKeys == 0)
     {
-        if (key < parentNode->left_key)
+        TreePathEntry *entry = &path->entries[level];
+        TreePathEntry *parentEntry = &path->entries[level - 1];
+        Node23 *parent = &parentEntry->node;
+        int position = parentEntry->child;                     // Índice do nó vazio entre os filhos do pai
+        int siblingIndex = position > 0 ? position - 1 : 1;    // Irmão à esquerda, se existir
+        int separator = position > 0 ? position - 1 : 0;       // Chave do pai entre o nó vazio e o irmão
+        int siblingOffset = childAt(parent, siblingIndex);
+
+        IO_STATS_LEVEL(level);
+        Node23 sibling = loadNode23(indexFile, siblingOffset);
+        int orphan = entry->node.left_child;                   // Único filho do nó vazio
+
+        int parentKeys[3], parentBooks[3], parentChildren[4];
+        int siblingKeys[3], siblingBooks[3], siblingChildren[4];
+        int keys[3], books[3], children[4];
+
+        unpackNode(parent, parentKeys, parentBooks, parentChildren);
+        unpackNode(&sibling, siblingKeys, siblingBooks, siblingChildren);
+
+        if (sibling.nKeys == 2)
         {
-            return parentAddress; // Não tem pai
+            // Redistribuição: a chave separadora desce para o nó vazio e a chave mais próxima do irmão sobe
+            keys[0] = parentKeys[separator];
+            books[0] = parentBooks[separator];
+
+            if (siblingIndex < position)
+            {
+                children[0] = siblingChildren[2];
+                children[1] = orphan;
+                parentKeys[separator] = siblingKeys[1];
+                parentBooks[separator] = siblingBooks[1];
+                packNode(&sibling, 1, siblingKeys, siblingBooks, siblingChildren);
+            }
+            else
+            {
+                children[0] = orphan;
+                children[1] = siblingChildren[0];
+                parentKeys[separator] = siblingKeys[0];
+                parentBooks[separator] = siblingBooks[0];
+                packNode(&sibling, 1, siblingKeys + 1, siblingBooks + 1, siblingChildren + 1);
+            }
+
+            packNode(&entry->node, 1, keys, books, children);
+            packNode(parent, parent->nKeys, parentKeys, parentBooks, parentChildren);
+
+            saveNode(indexFile, entry->offset, &entry->node);
+            saveNode(indexFile, siblingOffset, &sibling);
+            IO_STATS_LEVEL(level - 1);
+            saveNode(indexFile, parentEntry->offset, parent);
+            return;
         }
-        else
-        {
-            return -1;
-        }
-    }
-    else if (parentNode->middle_child == nodeAddress)
-    {
-        if (key >= parentNode->left_key && key < parentNode->right_key)
+
+        // Fusão: o irmão recebe a chave separadora e o filho do nó vazio, ficando com duas chaves
+        if (siblingIndex < position)
         {
-            return parentAddress;
+            keys[0] = siblingKeys[0];
+            books[0] = siblingBooks[0];
+            keys[1] = parentKeys[separator];
+            books[1] = parentBooks[separator];
+            children[0] = siblingChildren[0];
+            children[1] = siblingChildren[1];
+            children[2] = orphan;
         }
         else
         {
-            return -1; // Não tem pai
+            keys[0] = parentKeys[separator];
+            books[0] = parentBooks[separator];
+            keys[1] = siblingKeys[0];
+            books[1] = siblingBooks[0];
+            children[0] = orphan;
+            children[1] = siblingChildren[0];
+            children[2] = siblingChildren[1];
         }
-    }
-    else if (parentNode->right_child == nodeAddress)
-    {
-        if (key >= parentNode->right_key)
+
+        packNode(&sibling, 2, keys, books, children);
+        saveNode(indexFile, siblingOffset, &sibling);
+        releaseNode(indexFile, entry->offset, &entry->node, header);
+
+        // O pai perde a chave separadora e o ponteiro para o nó vazio
+        for (int i = separator; i < parent->nKeys - 1; i++)
         {
-            return parentAddress;
+            parentKeys[i] = parentKeys[i + 1];
+            parentBooks[i] = parentBooks[i + 1];
         }
-        else
+
+        for (int i = position; i < parent->nKeys; i++)
         {
-            return -1; // Não tem pai
+            parentChildren[i] = parentChildren[i + 1];
         }
-    }
-
-    return -1; // Não tem pai
-}
 
-/**
- * @brief Encontra o endereço do pai de um nó na árvore 2-3.
- *
- * Esta função busca o pai de um nó em uma árvore 2-3, dado o endereço do nó e o cabeçalho do arquivo de índice.
- * A busca começa pela raiz da árvore, e se o nó for encontrado, o endereço do pai é retornado. Se o nó não tiver pai
- * (se for a raiz ou a árvore estiver vazia), a função retorna -1.
- *
- * @param indexFile Ponteiro para o arquivo de índice onde a árvore está armazenada.
- * @param nodeAddress Endereço do nó filho para o qual o pai está sendo buscado.
- * @param header Cabeçalho do arquivo de índice que contém informações da árvore.
- *
- * @return O endereço do pai do nó, ou -1 caso contrário.
- *
- * @pre O arquivo de índice deve estar carregado e acessível, e a árvore 2-3 deve estar bem estruturada.
- *
- * @post Se o nó filho for encontrado, o endereço do pai será retornado. Se o nó for a raiz ou se a árvore estiver vazia,
- *       retorna -1. Se o nó não for encontrado, a função também retorna -1.
- *
- * @note Caso a árvore esteja vazia ou o nó fornecido seja a raiz, a função retorna imediatamente -1.
- */
-static int findParent(FILE *indexFile, int nodeAddress, IndexFileHeader *header)
-{
-    int root = getRootAddress(indexFile);
+        packNode(parent, parent->nKeys - 1, parentKeys, parentBooks, parentChildren);
 
-    if (root == -1 || root == nodeAddress)
-    {
-        return -1; // Árvore vazia ou nó raiz
-    }
-
-    // Carrega a raiz da árvore
-    Node23 rootNode = loadNode23(indexFile, root);
-
-    return findParentAux(indexFile, root, &rootNode, nodeAddress, -1);
-}
-
-/**
- * @brief Encontra o irmão de um nó em uma árvore 2-3.
- *
- * Esta função busca o irmão de um nó, dado o endereço do nó filho e o endereço do nó pai. A busca é realizada com base
- * na relação de filhos na árvore 2-3. Dependendo da posição do nó filho (esquerdo, meio ou direito), o irmão será retornado.
- * Se o nó não tiver irmãos ou se houver um erro com a estrutura do nó pai, a função retorna -1.
- *
- * @param indexFile Ponteiro para o arquivo de índice onde a árvore está armazenada.
- * @param parentAddress Endereço do nó pai do nó filho para o qual estamos buscando o irmão.
- * @param nodeAddress Endereço do nó filho para o qual o irmão está sendo buscado.
- * @param header Cabeçalho do arquivo de índice que contém informações da árvore.
- *
- * @return O endereço do irmão do nó, ou -1 em caso de erro ou se o nó não tiver irmão.
- *
- * @pre O arquivo de índice deve estar carregado e acessível, e a árvore 2-3 deve estar bem estruturada.
- *      O nó pai deve conter filhos válidos.
- *
- * @post Se o nó filho tiver um irmão, o endereço do irmão será retornado. Se o nó pai estiver corrompido ou se o nó filho
- *       não tiver um irmão, retorna -1.
- *
- * @note Caso o nó pai tenha apenas um filho, o nó não terá irmão. Caso o nó procurado seja o filho esquerdo ou direito,
- *       o irmão será o filho do meio. Caso o nó seja o filho do meio, o irmão pode ser o filho à esquerda ou à direita,
- *       dependendo do número de chaves do nó pai.
- */
-static int findSibling(FILE *indexFile, int parentAddress, int nodeAddress, IndexFileHeader *header)
-{
-    // Carregar o nó pai
-    Node23 parentNode = loadNode23(indexFile, parentAddress);
-
-    if (parentNode.left_child == -1 || parentNode.middle_child == -1 || parentNode.right_child == -1)
-    {
-        fprintf(stderr, "Erro: O nó pai está corrompido, faltando filhos.\n");
-        return -1; // Se faltar algum filho, retorna erro
-    }
-
-    // Verificar se o nó procurado é o filho esquerdo
-    if (parentNode.left_child == nodeAddress)
-    {
-        return parentNode.middle_child; // O irmão é o filho do meio
-    }
-    // Verificar se o nó procurado é o filho do meio
-    else if (parentNode.middle_child == nodeAddress)
-    {
-        // O irmão pode ser o filho à esquerda ou à direita
-        if (parentNode.nKeys == 1) // Caso o nó pai tenha apenas uma chave
-        {
-            return parentNode.left_child; // O irmão à esquerda
-        }
-        else
+        if (parent->nKeys > 0)
         {
-            return parentNode.right_child; // O irmão à direita
+            IO_STATS_LEVEL(level - 1);
+            saveNode(indexFile, parentEntry->offset, parent);
+            return;
         }
+
+        level--; // O pai ficou vazio, com o irmão como único filho
     }
-    // Verificar se o nó procurado é o filho direito
-    else if (parentNode.right_child == nodeAddress)
+
+    if (level == 0 && path->entries[0].node.nKeys == 0)
     {
-        return parentNode.middle_child; // O irmão é o filho do meio
+        handleEmptyNode(indexFile, path->entries[0].offset, &path->entries[0].node, header);
     }
-
-    return -1; // Nó sem irmãos
 }
 
 /**
- * @brief Trata o underflow (falta de chaves) em um nó folha de uma árvore 2-3.
- *
- * Esta função é chamada quando um nó folha em uma árvore 2-3 não possui chaves e ocorre um underflow. O tratamento envolve
- * procurar o nó pai e verificar a possibilidade de redistribuição de chaves com um irmão ou fusão de nós. Caso o nó pai
- * também tenha underflow após a fusão, a função propaga o underflow para o nó pai.
- *
- * @param indexFile Ponteiro para o arquivo de índice onde a árvore está armazenada.
- * @param nodeAddress Endereço do nó folha que sofreu underflow.
- * @param node Ponteiro para o nó que sofreu underflow.
- * @param header Cabeçalho do arquivo de índice, que contém informações sobre a árvore.
- * @param key A chave que causou o underflow (caso necessário para redistribuição ou fusão).
+ * @brief Remove uma chave da árvore, sem obter a trava do índice.
  *
- * @return Esta função não retorna nenhum valor. Ela faz alterações diretamente na estrutura da árvore.
+ * A remoção desce uma única vez da raiz até uma folha, registrando o caminho. Uma chave de nó interno é
+ * substituída pelo seu sucessor em ordem, que está na folha alcançada pela mesma descida, e a chave é então
+ * removida da folha. O underflow é tratado com `fixUnderflow`, subindo pelo caminho.
  *
- * @pre O arquivo de índice deve estar carregado e acessível, a árvore 2-3 deve estar bem estruturada, e o nó folha
- *      deve ter um underflow (sem chaves).
- *
- * @post Após o tratamento, o underflow é resolvido, seja por redistribuição de chaves ou fusão de nós. Se necessário,
- *       o underflow é propagado para o nó pai. As alterações são salvas no arquivo de índice.
- *
- * @note Caso o nó pai fique vazio após a fusão de nós, a função `handleLeafUnderflow` é chamada recursivamente para
- *       tratar o underflow no nó pai.
+ * @return O mesmo valor de `removeKey`.
  */
-static void handleLeafUnderflow(FILE *indexFile, int nodeAddress, Node23 *node, IndexFileHeader *header, int key)
+static int removeKeyFromTree(FILE *indexFile, int key, IndexFileHeader *header)
 {
-    if (node->nKeys > 0)
+    if (header->order > TWO_THREE_TREE_ORDER)
     {
-        return; // Não há underflow
+        return bplusTreeRemove(indexFile, key, header);
     }
 
-    int parentAddress = findParent(indexFile, nodeAddress, header);
-
-    if (parentAddress == -1)
+    if (header->rootAddress == -1)
     {
-        // Se não tem pai e o nó está vazio, ajusta a raiz
-        header->rootAddress = -1; // Árvore vazia
-        saveHeader(indexFile, header, sizeof(IndexFileHeader));
-        return;
+        return -1; // Árvore vazia
     }
 
-    Node23 parentNode = loadNode23(indexFile, parentAddress);
-
-    // Localizar o irmão mais próximo para redistribuição ou fusão
-    int siblingAddress = findSibling(indexFile, parentAddress, nodeAddress, header);
+    TreePath path;
+    int foundSlot;
+    int foundLevel = descendToLeaf(indexFile, header->rootAddress, key, &path, &foundSlot);
 
-    if (siblingAddress == -1)
+    if (foundLevel < 0)
     {
-        fprintf(stderr, "Erro: Nó sem irmãos em uma árvore 2-3.\n");
-        return;
+        return -1; // Chave não encontrada (ou árvore alta demais)
     }
 
-    Node23 siblingNode = loadNode23(indexFile, siblingAddress);
+    TreePathEntry *leafEntry = &path.entries[path.depth - 1];
+    Node23 *leaf = &leafEntry->node;
+    int leafSlot = foundSlot;
 
-    // Verifica redistribuição ou fusão
-    if (siblingNode.nKeys == 2)
+    if (foundLevel != path.depth - 1)
     {
-        // Redistribuir chaves
-        redistributeKeys(indexFile, &parentNode, &siblingNode, node, key);
-    }
-    else
-    {
-        // Mesclar com o irmão
-        mergeNodes(indexFile, &parentNode, &siblingNode, node, key);
+        // Chave de nó interno: troca pelo sucessor, a menor chave da folha alcançada
+        Node23 *holder = &path.entries[foundLevel].node;
 
-        // Se o pai agora está vazio, propaga o underflow
-        if (parentNode.nKeys == 0)
+        if (foundSlot == 0)
         {
-            handleLeafUnderflow(indexFile, parentAddress, &parentNode, header, key);
-        }
-    }
-
-    // Salvar alterações
-    saveNode(indexFile, parentAddress, &parentNode);
-    saveNode(indexFile, siblingAddress, &siblingNode);
-    saveNode(indexFile, nodeAddress, node);
-}
-
-/**
- * @brief Encontra a chave mínima em uma subárvore de uma árvore 2-3.
- *
- * Esta função percorre a subárvore à esquerda de um nó até chegar ao nó mais à esquerda da árvore.
- * O nó mais à esquerda de uma árvore 2-3 contém a chave mínima dentro de sua subárvore.
- *
- * @param indexFile Ponteiro para o arquivo de índice onde a árvore está armazenada.
- * @param node Ponteiro para o nó a partir do qual a busca pela chave mínima será realizada.
- *
- * @return A chave mínima encontrada na subárvore do nó fornecido.
- *
- * @pre O arquivo de índice deve estar carregado e acessível, e o nó fornecido deve ser parte de uma árvore 2-3 válida.
- *
- * @post A função retorna a chave mais à esquerda da subárvore do nó fornecido.
- *
- * @note Esta função assume que a árvore está estruturada corretamente e que a subárvore do nó tem pelo menos um nó.
- */
-static int findMinInSubtree(FILE *indexFile, Node23 *node)
-{
-    // Percorrer a subárvore à esquerda até chegar ao nó mais à esquerda
-    while (node->left_child != -1)
-    {
-        *node = loadNode23(indexFile, node->left_child);
-    }
-
-    // Retorna a chave mais à esquerda do nó
-    return node->left_key;
-}
-
-/**
- * @brief Encontra o sucessor em ordem de uma chave em um nó de uma árvore 2-3.
- *
- * Esta função busca o sucessor em ordem de uma chave específica dentro de um nó da árvore 2-3.
- * O sucessor em ordem de uma chave é o próximo valor em uma travessia em ordem da árvore.
- * A função lida com diferentes casos para encontrar o sucessor dependendo do número de chaves no nó e da posição da chave procurada.
- *
- * @param indexFile Ponteiro para o arquivo de índice onde a árvore está armazenada.
- * @param node Ponteiro para o nó onde a chave procurada está localizada.
- * @param key A chave cujo sucessor em ordem será buscado.
- *
- * @return O sucessor em ordem da chave fornecida, ou -1 se não houver sucessor.
- *
- * @pre O arquivo de índice deve estar carregado e acessível, e o nó fornecido deve ser parte de uma árvore 2-3 válida.
- *
- * @post A função retorna o sucessor em ordem da chave fornecida ou -1 se a chave não for encontrada ou não houver sucessor.
- *
- * @note Esta função assume que o nó e a chave fornecida são válidos dentro da árvore 2-3.
- */
-static int findInOrderSuccessor(FILE *indexFile, Node23 *node, int key)
-{
-    // Se o nó tem apenas uma chave e a chave procurada é a esquerda, o sucessor será a chave à direita
-    if (node->nKeys == 1)
-    {
-        if (node->left_key == key)
-        {
-            return node->right_key;
+            holder->left_key = leaf->left_key;
+            holder->leftBook = leaf->leftBook;
         }
         else
         {
-            return -1; // A chave não está presente
+            holder->right_key = leaf->left_key;
+            holder->rightBook = leaf->leftBook;
         }
-    }
 
-    // Se o nó tem duas chaves e a chave procurada é a esquerda
-    if (node->left_key == key)
-    {
-        // Se o nó tem um filho à direita, o sucessor será o menor valor na subárvore direita
-        if (node->right_child != -1)
-        {
-            Node23 rightChild = loadNode23(indexFile, node->right_child);
-            return findMinInSubtree(indexFile, &rightChild); // Encontrar o valor mínimo na subárvore à direita
-        }
-        return -1; // Não há sucessor
+        IO_STATS_LEVEL(foundLevel);
+        saveNode(indexFile, path.entries[foundLevel].offset, holder);
+        leafSlot = 0;
     }
 
-    // Se a chave procurada é a direita
-    else if (node->right_key == key)
-    {
-        return findParent(indexFile, node->right_child, key);
-    }
+    int keys[3], books[3], children[4];
 
-    return -1; // Chave não encontrada
-}
+    unpackNode(leaf, keys, books, children);
 
-/**
- * @brief Substitui uma chave em um nó de uma árvore 2-3.
- *
- * Esta função substitui uma chave específica em um nó da árvore 2-3 com uma nova chave fornecida.
- * A substituição pode ocorrer tanto na chave à esquerda quanto na chave à direita, se a chave procurada for encontrada.
- *
- * @param node Ponteiro para o nó onde a chave será substituída.
- * @param key A chave que será substituída.
- * @param newKey A nova chave que substituirá a chave fornecida.
- *
- * @return 1 se a substituição for bem-sucedida, ou 0 se a chave não for encontrada.
- *
- * @pre O nó deve ser parte de uma árvore 2-3 válida.
- *
- * @post Se a chave fornecida for encontrada, ela será substituída pela nova chave.
- *       Se a chave não for encontrada, o nó permanecerá inalterado.
- *
- * @note Esta função pressupõe que o nó contém apenas duas chaves (esquerda e direita).
- *       A árvore 2-3 permite que um nó tenha duas chaves e, consequentemente, um máximo de dois valores.
- */
-static int replaceKey(Node23 *node, int key, int newKey)
-{
-    // Verificar se o nó contém a chave que será substituída
-    if (node->left_key == key)
+    if (leafSlot == 0)
     {
-        node->left_key = newKey;
-        return 1; // Substituição bem-sucedida
-    }
-    else if (node->right_key == key)
-    {
-        node->right_key = newKey;
-        return 1; // Substituição bem-sucedida
+        keys[0] = keys[1];
+        books[0] = books[1];
     }
 
-    // Caso a chave não seja encontrada
-    return 0; // Falha na substituição, chave não encontrada
-}
+    packNode(leaf, leaf->nKeys - 1, keys, books, children);
 
-/**
- * @brief Lida com um nó vazio e atualiza a posição de alocação de novos nós na árvore 2-3.
- *
- * Esta função é responsável por tratar um nó vazio em uma árvore 2-3. Caso o nó tenha sido removido ou
- * tenha se tornado vazio, ele será reutilizado ou desalocado. Se a posição de um nó livre já estiver
- * disponível, o nó será marcado como vazio e realocado. Caso contrário, um novo nó será alocado na próxima
- * posição disponível.
- *
- * @param indexFile Ponteiro para o arquivo de índice onde os nós da árvore 2-3 são armazenados.
- * @param node Ponteiro para o nó que será tratado.
- * @param header Cabeçalho do arquivo de índice, contendo informações sobre a alocação de nós livres.
- *
- * @pre O arquivo de índice deve estar aberto e válido, e o cabeçalho deve estar carregado corretamente.
- *
- * @post Se o nó estiver vazio, ele será realocado ou removido, dependendo da disponibilidade de espaços livres.
- *       Se a posição de um nó livre não for encontrada, um novo nó será alocado na próxima posição disponível.
- *       As atualizações no cabeçalho do arquivo serão salvas.
- *
- * @note Esta função considera que a posição de nós livres é gerenciada por duas variáveis no cabeçalho:
- *       `headEmptyPosition` para a posição do nó livre, e `firstEmptyPosition` para a próxima posição disponível
- *       para alocar novos nós.
- */
-static void handleEmptyNode(FILE *indexFile, Node23 *node, IndexFileHeader *header)
-{
-    // Se o nó não estiver vazio, devemos realocar a posição do nó livre
-    if (header->headEmptyPosition != -1)
+    if (leaf->nKeys > 0)
     {
-        // Atualiza o nó livre com a posição do nó vazio
-        Node23 freeNode;
-        freeNode.left_child = header->headEmptyPosition;
-        freeNode.nKeys = 0;
-
-        // Salva o nó na posição disponível (header->headEmptyPosition)
-        saveNode(indexFile, header->headEmptyPosition, &freeNode);
-
-        // Atualiza a posição do próximo nó livre
-        header->headEmptyPosition = freeNode.left_child;
-
-        // Salva as atualizações no cabeçalho
-        saveHeader(indexFile, header, sizeof(IndexFileHeader));
+        IO_STATS_LEVEL(path.depth - 1);
+        saveNode(indexFile, leafEntry->offset, leaf);
+        return 0;
     }
-    else
-    {
-        node->nKeys = 0;
 
-        saveNode(indexFile, header->firstEmptyPosition, node);
+    fixUnderflow(indexFile, &path, header);
 
-        header->firstEmptyPosition++; // Supondo que a posição seguinte seja a próxima para alocar um novo nó livre
-        saveHeader(indexFile, header, sizeof(IndexFileHeader));
-    }
+    return 0; // Sucesso
 }
 
 /**
@@ -1065,52 +1103,31 @@ static void handleEmptyNode(FILE *indexFile, Node23 *node, IndexFileHeader *head
  *
  * @note Esta função lida com diferentes cenários para remoção:
  *       - Se a chave estiver em um nó folha, ela é removida diretamente.
- *       - Se o nó folha ficar desequilibrado (com menos de uma chave), a função `handleLeafUnderflow` é chamada.
- *       - Se a chave estiver em um nó interno, a chave é substituída pelo sucessor em ordem, e a remoção é recursiva.
+ *       - Se a chave estiver em um nó interno, ela é substituída pelo sucessor em ordem, encontrado na mesma
+ *         descida, e o sucessor é removido da sua folha.
+ *       - Se um nó ficar sem chaves, ele recebe uma chave do irmão (redistribuição) ou é fundido com ele, e a
+ *         fusão pode se propagar até a raiz.
+ *
+ * @note A remoção lê cada nó do caminho uma única vez e, por nível em underflow, apenas o irmão: o custo é
+ *       proporcional à altura da árvore.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a remoção é delegada a `bplusTreeRemove`.
+ *
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), a remoção obtém a trava do índice para escrita.
  */
 int removeKey(FILE *indexFile, int key, IndexFileHeader *header)
 {
-    if (twoThreeTreeSearch(indexFile, key) == -1 || header->rootAddress == -1)
-    {
-        return -1; // Chave não encontrada ou árvore vazia
-    }
-
-    // Carrega a raiz
-    Node23 rootNode = loadNode23(indexFile, header->rootAddress);
-
-    // Se a raiz é uma folha
-    if (isLeafNode(&rootNode))
+    if (treeLockWrite(indexFile) != 0)
     {
-        if (rootNode.nKeys == 2)
-        {
-            removeKeyFromLeaf(&rootNode, key);
-            saveNode(indexFile, header->rootAddress, &rootNode);
-        }
-        else
-        {
-            handleLeafUnderflow(indexFile, header->rootAddress, &rootNode, header, key);
-        }
-    }
-    else
-    {
-        // Se a raiz não for uma folha, encontra o sucessor em ordem
-        int successorKey = findInOrderSuccessor(indexFile, &rootNode, key);
-
-        // Substitui a chave pela chave sucessora
-        replaceKey(&rootNode, key, successorKey);
-        saveNode(indexFile, header->rootAddress, &rootNode);
-
-        // Remove recursivamente a chave sucessora
-        removeKey(indexFile, successorKey, header);
+        return -1;
     }
 
-    // Se a raiz ficou sem chaves, trata o nó vazio
-    if (rootNode.nKeys == 0)
-    {
-        handleEmptyNode(indexFile, &rootNode, header);
-    }
+    IO_STATS_BEGIN(IO_STATS_OP_REMOVE);
+    int result = removeKeyFromTree(indexFile, key, header);
+    IO_STATS_END();
 
-    return 0; // Sucesso
+    treeUnlock(indexFile);
+    return result;
 }
 
 /**
@@ -1132,6 +1149,18 @@ static int twoThreeTreeCountNodesRec(Node23 node, FILE *indexFile)
     int count = 1; // Conta o nó atual
 
     // Se o nó tem filhos (nKeys == 1 ou nKeys == 2), conta os filhos recursivamente
+    // Antecipa a leitura dos filhos, que serão todos visitados
+    if (node.nKeys >= 1)
+    {
+        prefetchNode23(indexFile, node.left_child);
+        prefetchNode23(indexFile, node.middle_child);
+
+        if (node.nKeys == 2)
+        {
+            prefetchNode23(indexFile, node.right_child);
+        }
+    }
+
     if (node.nKeys == 1)
     {
         // Conta os dois filhos
@@ -1162,11 +1191,16 @@ static int twoThreeTreeCountNodesRec(Node23 node, FILE *indexFile)
  *
  * @return O número total de nós na árvore 2-3.
  *         Retorna 0 se a árvore estiver vazia.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), são contadas as chaves das folhas (uma por livro).
  */
 int twoThreeTreeCountNodes(FILE *indexFile)
 {
+    IndexFileHeader header;
+    readFileHeader(indexFile, &header, sizeof(IndexFileHeader));
+
     // Obtém o endereço da raiz da árvore 2-3
-    int rootAddress = getRootAddress(indexFile);
+    int rootAddress = header.rootAddress;
 
     // Verifica se a raiz é válida
     if (rootAddress == -1)
@@ -1175,6 +1209,12 @@ int twoThreeTreeCountNodes(FILE *indexFile)
         return 0;
     }
 
+    // No modo B+ cada chave das folhas representa um livro
+    if (header.order > TWO_THREE_TREE_ORDER)
+    {
+        return bplusTreeCountKeys(indexFile, &header);
+    }
+
     // Carrega o nó raiz da árvore usando a função loadNode23
     Node23 root = loadNode23(indexFile, rootAddress);
 
@@ -1183,3 +1223,242 @@ int twoThreeTreeCountNodes(FILE *indexFile)
 
     return count;
 }
+
+/**
+ * @brief Número de nós acumulados em memória antes de cada gravação da construção em lote.
+ */
+#define BULK_BUILD_BUFFER_NODES 512
+
+/**
+ * @brief Estado da gravação sequencial dos nós durante a construção em lote.
+ */
+typedef struct
+{
+    FILE *indexFile;                        // Arquivo de índices
+    Node23 buffer[BULK_BUILD_BUFFER_NODES]; // Nós ainda não gravados
+    int count;                              // Número de nós no buffer
+    int nextOffset;                         // Deslocamento que o próximo nó receberá
+    int error;                              // 1 se alguma gravação falhou
+} BulkNodeWriter;
+
+/**
+ * @brief Grava no arquivo os nós acumulados no buffer da construção em lote.
+ */
+static void flushBulkWriter(BulkNodeWriter *writer)
+{
+    long start = writer->nextOffset - (long)writer->count * sizeof(Node23);
+
+    if (writer->count > 0 && IO_STATS_WRITE(IO_STATS_NODE_WRITE, writer->indexFile, start, writer->buffer, sizeof(Node23) * writer->count) != 0)
+    {
+        perror("Erro ao gravar os nós da construção em lote");
+        writer->error = 1;
+    }
+
+    writer->count = 0;
+}
+
+/**
+ * @brief Acrescenta um nó ao buffer da construção em lote.
+ *
+ * @return O deslocamento (offset) que o nó terá no arquivo de índices.
+ */
+static int appendBulkNode(BulkNodeWriter *writer, const Node23 *node)
+{
+    int offset = writer->nextOffset;
+
+    writer->buffer[writer->count++] = *node;
+    writer->nextOffset += sizeof(Node23);
+
+    if (writer->count == BULK_BUILD_BUFFER_NODES)
+    {
+        flushBulkWriter(writer);
+    }
+
+    return offset;
+}
+
+/**
+ * @brief Constrói recursivamente uma subárvore de altura `height` com as chaves `keys[0..n-1]`.
+ *
+ * @param writer Estado da gravação sequencial.
+ * @param keys Chaves da subárvore, em ordem crescente.
+ * @param bookPositions Posições dos livros associadas às chaves.
+ * @param n Número de chaves, entre 2^height - 1 e 3^height - 1.
+ * @param height Altura da subárvore (1 para uma folha).
+ * @param minKeys Vetor com o número mínimo de chaves de uma subárvore de cada altura.
+ *
+ * @return O deslocamento (offset) da raiz da subárvore.
+ */
+static int buildSubtree(BulkNodeWriter *writer, const int *keys, const int *bookPositions, int n, int height, const long *minKeys)
+{
+    Node23 node;
+
+    node.nKeys = 1;
+    node.right_key = -1;
+    node.rightBook = -1;
+    node.left_child = -1;
+    node.middle_child = -1;
+    node.right_child = -1;
+
+    if (height == 1)
+    {
+        // Folha com uma ou duas chaves
+        node.nKeys = n;
+        node.left_key = keys[0];
+        node.leftBook = bookPositions[0];
+
+        if (n == 2)
+        {
+            node.right_key = keys[1];
+            node.rightBook = bookPositions[1];
+        }
+
+        return appendBulkNode(writer, &node);
+    }
+
+    // Três filhos sempre que cada um puder receber o mínimo de chaves da altura inferior
+    int children = (n - 2 >= 3 * minKeys[height - 1]) ? 3 : 2;
+    int remaining = n - (children - 1);
+    int position = 0;
+    int childOffsets[3];
+
+    for (int i = 0; i < children; i++)
+    {
+        // Distribui as chaves restantes igualmente entre os filhos
+        int childKeys = remaining / children + (i < remaining % children ? 1 : 0);
+
+        childOffsets[i] = buildSubtree(writer, keys + position, bookPositions + position, childKeys, height - 1, minKeys);
+        position += childKeys;
+
+        if (i == 0)
+        {
+            node.left_key = keys[position];
+            node.leftBook = bookPositions[position];
+            position++;
+        }
+        else if (i == 1 && children == 3)
+        {
+            node.right_key = keys[position];
+            node.rightBook = bookPositions[position];
+            position++;
+        }
+    }
+
+    node.nKeys = children - 1;
+    node.left_child = childOffsets[0];
+    node.middle_child = childOffsets[1];
+    node.right_child = children == 3 ? childOffsets[2] : -1;
+
+    return appendBulkNode(writer, &node);
+}
+
+/**
+ * @brief Constrói a árvore de baixo para cima, sem obter a trava do índice.
+ *
+ * @return O mesmo valor de `twoThreeTreeBulkBuild`.
+ */
+static int bulkBuildTree(FILE *indexFile, const int *keys, const int *bookPositions, int n, IndexFileHeader *header)
+{
+    if (header->order > TWO_THREE_TREE_ORDER)
+    {
+        return bplusTreeBulkBuild(indexFile, keys, bookPositions, n, header);
+    }
+
+    if (header->rootAddress != -1)
+    {
+        fprintf(stderr, "Erro: a construção em lote exige uma árvore 2-3 vazia.\n");
+        return -1;
+    }
+
+    if (n <= 0)
+    {
+        return -1;
+    }
+
+    // Menor altura capaz de armazenar n chaves (uma árvore de altura h guarda até 3^h - 1 chaves)
+    long minKeys[32];
+    long maxKeys = 2;
+    int height = 1;
+
+    minKeys[0] = 0;
+    minKeys[1] = 1;
+    while (maxKeys < n)
+    {
+        height++;
+        maxKeys = maxKeys * 3 + 2;
+        minKeys[height] = minKeys[height - 1] * 2 + 1;
+    }
+
+    BulkNodeWriter *writer = malloc(sizeof(BulkNodeWriter));
+
+    if (writer == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para a construção em lote.\n");
+        return -1;
+    }
+
+    writer->indexFile = indexFile;
+    writer->count = 0;
+    writer->nextOffset = header->firstEmptyPosition; // Fim da área reservada pelo alocador
+    writer->error = 0;
+
+    int root = buildSubtree(writer, keys, bookPositions, n, height, minKeys);
+    flushBulkWriter(writer);
+
+    int error = writer->error;
+    int end = writer->nextOffset;
+    free(writer);
+
+    if (error)
+    {
+        return -1;
+    }
+
+    header->rootAddress = root;
+    header->firstEmptyPosition = end;
+    saveHeader(indexFile, header, sizeof(IndexFileHeader));
+
+    return root;
+}
+
+/**
+ * @brief Constrói a árvore 2-3 de baixo para cima a partir de chaves ordenadas.
+ *
+ * Esta função monta uma árvore 2-3 compacta (com o maior número possível de nós com duas chaves) a partir de um
+ * vetor de chaves em ordem crescente e sem repetição. Os nós são gerados em pós-ordem, isto é, cada nó é gravado
+ * depois dos seus filhos, o que permite escrever todo o índice em uma única passada sequencial no final do arquivo,
+ * sem nenhuma leitura e sem divisões de nós.
+ *
+ * @pre O arquivo de índices deve estar aberto no modo de leitura e escrita e a árvore deve estar vazia
+ *      (`header->rootAddress == -1`). As chaves devem estar em ordem crescente e sem repetição.
+ *
+ * @post Os nós da árvore são gravados no final do arquivo de índices e `header->rootAddress` passa a apontar
+ *       para a nova raiz.
+ *
+ * @param indexFile Ponteiro para o arquivo de índices.
+ * @param keys Vetor com as chaves em ordem crescente.
+ * @param bookPositions Vetor com a posição do livro (dado) associada a cada chave.
+ * @param n Número de chaves.
+ * @param header Ponteiro para o cabeçalho do arquivo de índices.
+ *
+ * @return O deslocamento (offset) da nova raiz, ou -1 se a árvore não estiver vazia ou ocorrer erro de gravação.
+ *
+ * @note A altura escolhida é a menor capaz de armazenar `n` chaves. Em cada nível interno, o nó recebe três filhos
+ *       sempre que as subárvores continuarem válidas, e as chaves são distribuídas igualmente entre os filhos.
+ *
+ * @note No modo B+ (ordem maior que `TWO_THREE_TREE_ORDER`), a construção é delegada a `bplusTreeBulkBuild`.
+ *
+ * @note Com o acesso concorrente ligado (`treeLockEnable`), a construção obtém a trava do índice para escrita.
+ */
+int twoThreeTreeBulkBuild(FILE *indexFile, const int *keys, const int *bookPositions, int n, IndexFileHeader *header)
+{
+    if (treeLockWrite(indexFile) != 0)
+    {
+        return -1;
+    }
+
+    int result = bulkBuildTree(indexFile, keys, bookPositions, n, header);
+
+    treeUnlock(indexFile);
+    return result;
+}
@@ -147,3 +147,46 @@ void formatDecimalSeparator(char *str)
         }
     }
 }
+
+/**
+ * @brief Gera a forma normalizada de uma string para uso como chave de índice.
+ *
+ * @details A forma normalizada não possui espaços no início nem no final, tem os espaços internos consecutivos
+ *          reduzidos a um único espaço e todas as letras convertidas para minúsculas. Duas strings consideradas
+ *          iguais pela busca (ignorando maiúsculas e espaços extras) têm sempre a mesma forma normalizada.
+ *
+ * @param src String de origem, terminada por caractere nulo.
+ * @param dest Buffer de destino, que receberá a string normalizada.
+ * @param destSize Tamanho, em bytes, do buffer de destino.
+ *
+ * @pre `src` e `dest` devem ser válidos e `destSize` deve ser maior que 0.
+ *
+ * @post `dest` contém a string normalizada, truncada em `destSize - 1` caracteres se necessário.
+ *
+ * @return Retorna o ponteiro `dest`.
+ */
+char *normalizeString(const char *src, char *dest, size_t destSize)
+{
+    size_t length = 0;
+    int pendingSpace = 0;
+
+    for (; *src && length + 1 < destSize; src++)
+    {
+        if (isspace((unsigned char)*src))
+        {
+            pendingSpace = length > 0; // Espaços no início são descartados
+            continue;
+        }
+
+        if (pendingSpace && length + 2 < destSize)
+        {
+            dest[length++] = ' ';
+        }
+        pendingSpace = 0;
+
+        dest[length++] = (char)tolower((unsigned char)*src);
+    }
+
+    dest[length] = '\0';
+    return dest;
+}
@@ -0,0 +1,824 @@
+/**
+ * @file wal.c
+ * @author Gabriel Hochmann
+ *
+ * @brief Implementa o log de escrita antecipada (write-ahead log) dos arquivos de dados e de índices.
+ *
+ * As gravações são interceptadas com `storageSetWriteHook`: cada uma é registrada no log e retida em memória (a
+ * função assume a gravação), e `storageSetReadHook` sobrepõe as gravações retidas aos bytes lidos dos arquivos. As
+ * gravações retidas só são aplicadas aos arquivos em `walSync`, depois do `fsync` do log, de modo que nenhuma página
+ * dos arquivos observados pode chegar ao dispositivo antes do registro que a descreve.
+ *
+ * Como as transações são executadas uma de cada vez, os registros de uma transação ficam juntos no log e terminam no
+ * seu registro de commit; os de uma transação descartada (`walAbort`) ou incompleta não têm registro de commit.
+ *
+ * @see wal.h
+ */
+
+#include "wal.h"
+#include "storage.h"
+#include "file_manager.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Retorna o instante atual em milissegundos (relógio monotônico, quando disponível).
+ */
+static long long currentTimeMs(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+#else
+    return (long long)time(NULL) * 1000;
+#endif
+}
+
+/**
+ * @brief Valor inicial da soma de verificação (FNV-1a).
+ */
+#define WAL_CHECKSUM_SEED 2166136261u
+
+/**
+ * @brief Acrescenta `size` bytes à soma de verificação (FNV-1a) `hash`.
+ */
+static unsigned int checksumUpdate(unsigned int hash, const void *bytes, size_t size)
+{
+    const unsigned char *data = bytes;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Retorna o índice de um arquivo observado, ou -1 se o arquivo não for observado pelo log.
+ */
+static int findFileId(const Wal *wal, FILE *file)
+{
+    for (int i = 0; i < wal->fileCount; i++)
+    {
+        if (wal->files[i] == file)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Garante que a área de montagem comporte `size` bytes.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int reserveRecord(Wal *wal, size_t size)
+{
+    if (size <= wal->recordCapacity)
+    {
+        return 0;
+    }
+
+    char *resized = realloc(wal->record, size);
+
+    if (resized == NULL)
+    {
+        fprintf(stderr, "Erro: memória insuficiente para o log.\n");
+        return -1;
+    }
+
+    wal->record = resized;
+    wal->recordCapacity = size;
+
+    return 0;
+}
+
+/**
+ * @brief Acrescenta ao log o registro já montado na área de montagem e o entrega ao sistema operacional.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int appendRecord(Wal *wal, size_t size)
+{
+    WalRecordHeader *header = (WalRecordHeader *)wal->record;
+
+    header->checksum = 0;
+    header->checksum = checksumUpdate(WAL_CHECKSUM_SEED, wal->record, size);
+
+    if (fwrite(wal->record, size, 1, wal->file) != 1 || fflush(wal->file) != 0)
+    {
+        perror("Erro ao gravar no log");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Monta e acrescenta um registro de gravação (apenas com a nova imagem).
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int appendWrite(Wal *wal, int fileId, long offset, const void *after, int length)
+{
+    size_t size = sizeof(WalRecordHeader) + length;
+
+    if (reserveRecord(wal, size) != 0)
+    {
+        return -1;
+    }
+
+    WalRecordHeader *header = (WalRecordHeader *)wal->record;
+
+    memset(header, 0, sizeof(WalRecordHeader));
+    header->type = WAL_RECORD_WRITE;
+    header->generation = wal->generation;
+    header->transaction = wal->transaction;
+    header->fileId = fileId;
+    header->length = length;
+    header->offset = offset;
+    memcpy(wal->record + sizeof(WalRecordHeader), after, length);
+
+    return appendRecord(wal, size);
+}
+
+/**
+ * @brief Esvazia a lista de gravações retidas.
+ */
+static void clearPending(Wal *wal)
+{
+    wal->pendingCount = 0;
+    wal->pendingBytes = 0;
+
+    for (int i = 0; i < WAL_MAX_FILES; i++)
+    {
+        wal->pendingFirst[i] = LONG_MAX;
+        wal->pendingEnd[i] = -1;
+    }
+}
+
+/**
+ * @brief Retém uma gravação em memória até a próxima sincronização do log.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro de memória.
+ */
+static int retainWrite(Wal *wal, int fileId, long offset, const void *buffer, size_t size)
+{
+    if (wal->pendingCount == wal->pendingCapacity)
+    {
+        int capacity = wal->pendingCapacity > 0 ? 2 * wal->pendingCapacity : 64;
+        WalPendingWrite *resized = realloc(wal->pending, sizeof(WalPendingWrite) * capacity);
+
+        if (resized == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para o log.\n");
+            return -1;
+        }
+
+        wal->pending = resized;
+        wal->pendingCapacity = capacity;
+    }
+
+    if (wal->pendingBytes + size > wal->pendingDataCapacity)
+    {
+        size_t capacity = wal->pendingDataCapacity > 0 ? wal->pendingDataCapacity : 4096;
+
+        while (capacity < wal->pendingBytes + size)
+        {
+            capacity *= 2;
+        }
+
+        char *resized = realloc(wal->pendingData, capacity);
+
+        if (resized == NULL)
+        {
+            fprintf(stderr, "Erro: memória insuficiente para o log.\n");
+            return -1;
+        }
+
+        wal->pendingData = resized;
+        wal->pendingDataCapacity = capacity;
+    }
+
+    WalPendingWrite *write = &wal->pending[wal->pendingCount++];
+
+    write->fileId = fileId;
+    write->length = (int)size;
+    write->offset = offset;
+    write->data = wal->pendingBytes;
+    memcpy(wal->pendingData + wal->pendingBytes, buffer, size);
+    wal->pendingBytes += size;
+
+    if (offset < wal->pendingFirst[fileId])
+    {
+        wal->pendingFirst[fileId] = offset;
+    }
+
+    if (offset + (long)size > wal->pendingEnd[fileId])
+    {
+        wal->pendingEnd[fileId] = offset + (long)size;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Aplica aos arquivos, na ordem em que foram feitas, as gravações retidas, e esvazia a lista.
+ *
+ * @return 0 em caso de sucesso, -1 se alguma gravação falhar (o log sincronizado ainda permite refazê-la).
+ */
+static int applyPending(Wal *wal)
+{
+    int result = 0;
+
+    wal->applying = 1;
+
+    for (int i = 0; i < wal->pendingCount; i++)
+    {
+        const WalPendingWrite *write = &wal->pending[i];
+
+        if (storageWrite(wal->files[write->fileId], write->offset, wal->pendingData + write->data, write->length) != 0)
+        {
+            perror("Erro ao aplicar as gravações do log");
+            result = -1;
+        }
+    }
+
+    wal->applying = 0;
+    clearPending(wal);
+
+    return result;
+}
+
+/**
+ * @brief Registra no log uma gravação feita com `storageWrite` em um arquivo observado e a retém em memória.
+ *
+ * O trecho da gravação além do final do arquivo é gravado imediatamente: nenhum cabeçalho gravado o alcança, e as
+ * leituras do trecho retido continuam dentro do arquivo. Fora de uma transação (carga em lote e checkpoint) e durante
+ * a aplicação das gravações retidas, as gravações não são registradas.
+ *
+ * @return 1 se a gravação foi assumida, 0 se ela deve ser feita normalmente, -1 em caso de erro.
+ */
+static int walWriteHook(FILE *file, long offset, const void *buffer, size_t size, void *context)
+{
+    Wal *wal = context;
+
+    if (!wal->active || wal->applying)
+    {
+        return 0;
+    }
+
+    int fileId = findFileId(wal, file);
+
+    if (fileId == -1)
+    {
+        return 0;
+    }
+
+    if (appendWrite(wal, fileId, offset, buffer, (int)size) != 0)
+    {
+        return -1;
+    }
+
+    long fileSize = storageSize(file);
+    long existing = fileSize > offset ? fileSize - offset : 0;
+    size_t retained = existing < (long)size ? (size_t)existing : size;
+
+    if (retained == 0)
+    {
+        return 0; // A gravação apenas estende o arquivo
+    }
+
+    if (retainWrite(wal, fileId, offset, buffer, retained) != 0)
+    {
+        return -1;
+    }
+
+    if (retained < size)
+    {
+        wal->applying = 1;
+        int result = storageWrite(file, offset + (long)retained, (const char *)buffer + retained, size - retained);
+        wal->applying = 0;
+
+        if (result != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Sobrepõe aos bytes lidos de um arquivo observado as gravações retidas que os alcançam.
+ */
+static void walReadHook(FILE *file, long offset, void *buffer, size_t size, void *context)
+{
+    Wal *wal = context;
+    int fileId = findFileId(wal, file);
+    long end = offset + (long)size;
+
+    // A faixa retida de cada arquivo descarta de uma vez as leituras que não alcançam nenhuma gravação retida
+    if (fileId == -1 || end <= wal->pendingFirst[fileId] || offset >= wal->pendingEnd[fileId])
+    {
+        return;
+    }
+
+    // As gravações são sobrepostas na ordem em que foram feitas: a mais recente prevalece
+    for (int i = 0; i < wal->pendingCount; i++)
+    {
+        const WalPendingWrite *write = &wal->pending[i];
+        long first = write->offset > offset ? write->offset : offset;
+        long last = write->offset + write->length < end ? write->offset + write->length : end;
+
+        if (write->fileId == fileId && first < last)
+        {
+            memcpy((char *)buffer + (first - offset), wal->pendingData + write->data + (first - write->offset),
+                   last - first);
+        }
+    }
+}
+
+/**
+ * @brief Grava o cabeçalho do log e posiciona o arquivo logo após ele.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+static int writeLogHeader(FILE *file, int fileCount, int generation)
+{
+    WalFileHeader header;
+
+    header.magic = WAL_MAGIC;
+    header.fileCount = fileCount;
+    header.generation = generation;
+
+    if (fseek(file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(WalFileHeader), 1, file) != 1 || storageSync(file) != 0)
+    {
+        perror("Erro ao gravar o cabeçalho do log");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Cria (ou esvazia) o arquivo de log e passa a observar as gravações dos arquivos informados.
+ *
+ * @param wal Ponteiro para a estrutura do log a ser inicializada.
+ * @param filename Nome do arquivo de log.
+ * @param files Arquivos cujas gravações serão registradas.
+ * @param fileCount Número de arquivos (no máximo `WAL_MAX_FILES`).
+ * @param syncWindowMs Janela (em milissegundos) entre sincronizações do log; 0 sincroniza a cada commit.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walCreate(Wal *wal, const char *filename, FILE *files[], int fileCount, int syncWindowMs)
+{
+    memset(wal, 0, sizeof(Wal));
+
+    if (fileCount > WAL_MAX_FILES)
+    {
+        fprintf(stderr, "Erro: o log observa no máximo %d arquivos.\n", WAL_MAX_FILES);
+        return -1;
+    }
+
+    wal->file = openFile(filename, "w+b");
+
+    if (wal->file == NULL)
+    {
+        return -1;
+    }
+
+    wal->fileCount = fileCount;
+    wal->generation = 1;
+    wal->syncWindowMs = syncWindowMs < 0 ? 0 : syncWindowMs;
+    wal->lastSyncMs = currentTimeMs();
+    clearPending(wal);
+
+    if (writeLogHeader(wal->file, fileCount, wal->generation) != 0)
+    {
+        walClose(wal);
+        return -1;
+    }
+
+    for (int i = 0; i < fileCount; i++)
+    {
+        wal->files[i] = files[i];
+
+        if (storageSetWriteHook(files[i], walWriteHook, wal) != 0 || storageSetReadHook(files[i], walReadHook, wal) != 0)
+        {
+            walClose(wal);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Inicia uma transação.
+ *
+ * @param wal Ponteiro para o log aberto.
+ */
+void walBegin(Wal *wal)
+{
+    if (!wal->active)
+    {
+        wal->transaction++;
+        wal->active = 1;
+        wal->transactionPending = wal->pendingCount;
+    }
+}
+
+/**
+ * @brief Registra na transação corrente uma imagem que ainda não foi gravada no arquivo.
+ *
+ * Usada para os cabeçalhos mantidos em memória, que só são gravados no checkpoint. A imagem não é retida: ela só
+ * chega ao arquivo quando a recuperação refaz o registro.
+ *
+ * @param wal Ponteiro para o log aberto.
+ * @param file Arquivo observado ao qual a imagem pertence.
+ * @param offset Deslocamento da imagem no arquivo.
+ * @param buffer Conteúdo da imagem.
+ * @param size Tamanho da imagem.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walLogImage(Wal *wal, FILE *file, long offset, const void *buffer, size_t size)
+{
+    int fileId = findFileId(wal, file);
+
+    if (!wal->active || fileId == -1)
+    {
+        return 0;
+    }
+
+    return appendWrite(wal, fileId, offset, buffer, (int)size);
+}
+
+/**
+ * @brief Confirma a transação corrente.
+ *
+ * O registro de commit é entregue ao sistema operacional imediatamente; o `fsync` do log (seguido da aplicação das
+ * gravações retidas) é feito se a janela de sincronização tiver passado desde o último ou se as gravações retidas
+ * passarem de `WAL_MAX_PENDING_BYTES`.
+ *
+ * @param wal Ponteiro para o log aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walCommit(Wal *wal)
+{
+    if (!wal->active)
+    {
+        return 0;
+    }
+
+    if (reserveRecord(wal, sizeof(WalRecordHeader)) != 0)
+    {
+        return -1;
+    }
+
+    WalRecordHeader *header = (WalRecordHeader *)wal->record;
+
+    memset(header, 0, sizeof(WalRecordHeader));
+    header->type = WAL_RECORD_COMMIT;
+    header->generation = wal->generation;
+    header->transaction = wal->transaction;
+
+    // Sem o registro de commit, a transação continua aberta e pode ser descartada com `walAbort`
+    if (appendRecord(wal, sizeof(WalRecordHeader)) != 0)
+    {
+        return -1;
+    }
+
+    wal->active = 0;
+    wal->unsyncedCommits++;
+
+    // Commit em grupo: um único fsync para todos os commits da janela
+    if (currentTimeMs() - wal->lastSyncMs >= wal->syncWindowMs || wal->pendingBytes >= (size_t)WAL_MAX_PENDING_BYTES)
+    {
+        return walSync(wal);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Descarta a transação corrente.
+ *
+ * As gravações retidas da transação são descartadas (elas nunca chegaram aos arquivos) e os seus registros ficam sem
+ * registro de commit, de modo que a recuperação os ignora. Sem transação aberta, a chamada não tem efeito.
+ *
+ * @param wal Ponteiro para o log aberto.
+ */
+void walAbort(Wal *wal)
+{
+    if (!wal->active)
+    {
+        return;
+    }
+
+    int kept = wal->transactionPending;
+
+    if (kept < wal->pendingCount)
+    {
+        wal->pendingBytes = wal->pending[kept].data;
+        wal->pendingCount = kept;
+
+        // Recalcula as faixas retidas apenas com as gravações das transações confirmadas
+        for (int i = 0; i < WAL_MAX_FILES; i++)
+        {
+            wal->pendingFirst[i] = LONG_MAX;
+            wal->pendingEnd[i] = -1;
+        }
+
+        for (int i = 0; i < kept; i++)
+        {
+            const WalPendingWrite *write = &wal->pending[i];
+
+            if (write->offset < wal->pendingFirst[write->fileId])
+            {
+                wal->pendingFirst[write->fileId] = write->offset;
+            }
+
+            if (write->offset + write->length > wal->pendingEnd[write->fileId])
+            {
+                wal->pendingEnd[write->fileId] = write->offset + write->length;
+            }
+        }
+    }
+
+    wal->active = 0;
+}
+
+/**
+ * @brief Sincroniza o log com o dispositivo, se houver commits pendentes, e aplica aos arquivos as gravações retidas.
+ *
+ * @pre Nenhuma transação aberta.
+ *
+ * @param wal Ponteiro para o log aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walSync(Wal *wal)
+{
+    if (wal->file == NULL || (wal->unsyncedCommits == 0 && wal->pendingCount == 0))
+    {
+        return 0;
+    }
+
+    // As gravações retidas continuam fora dos arquivos se o log não chegar ao dispositivo
+    if (storageSync(wal->file) != 0)
+    {
+        perror("Erro ao sincronizar o log");
+        return -1;
+    }
+
+    wal->unsyncedCommits = 0;
+    wal->lastSyncMs = currentTimeMs();
+
+    return applyPending(wal);
+}
+
+/**
+ * @brief Esvazia o log depois que os arquivos observados foram sincronizados.
+ *
+ * @pre Nenhuma transação aberta. As gravações retidas já devem ter sido aplicadas (`walSync`) e os arquivos
+ *      observados, gravados e sincronizados.
+ *
+ * @param wal Ponteiro para o log aberto.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int walCheckpoint(Wal *wal)
+{
+    if (wal->file == NULL)
+    {
+        return 0;
+    }
+
+    // Uma nova geração invalida os registros anteriores sem precisar truncar o arquivo
+    if (writeLogHeader(wal->file, wal->fileCount, wal->generation + 1) != 0)
+    {
+        return -1;
+    }
+
+    wal->generation++;
+    wal->unsyncedCommits = 0;
+    wal->lastSyncMs = currentTimeMs();
+
+    return 0;
+}
+
+/**
+ * @brief Sincroniza o log, aplica as gravações retidas, deixa de observar os arquivos e fecha o log.
+ *
+ * @param wal Ponteiro para o log.
+ *
+ * @return 0 em caso de sucesso (ou se não estiver aberto), -1 em caso de erro.
+ *
+ * @post `wal->file` é definido como NULL.
+ */
+int walClose(Wal *wal)
+{
+    if (wal->file == NULL)
+    {
+        return 0;
+    }
+
+    int result = walSync(wal);
+
+    for (int i = 0; i < wal->fileCount; i++)
+    {
+        storageSetWriteHook(wal->files[i], NULL, NULL);
+        storageSetReadHook(wal->files[i], NULL, NULL);
+    }
+
+    if (closeFile(&wal->file) != 0)
+    {
+        result = -1;
+    }
+
+    free(wal->record);
+    free(wal->pending);
+    free(wal->pendingData);
+    wal->record = NULL;
+    wal->recordCapacity = 0;
+    wal->pending = NULL;
+    wal->pendingData = NULL;
+    wal->pendingCapacity = 0;
+    wal->pendingDataCapacity = 0;
+    clearPending(wal);
+    wal->fileCount = 0;
+
+    return result;
+}
+
+/**
+ * @brief Aplica aos arquivos o conteúdo de um log deixado por uma sessão interrompida.
+ *
+ * As gravações das transações confirmadas são refeitas na ordem do log; as das transações descartadas e da
+ * incompleta são ignoradas, já que nunca chegaram aos arquivos. Registros corrompidos ou truncados no final do log
+ * são descartados. Ao final, os arquivos são sincronizados e o log é esvaziado.
+ *
+ * @param filename Nome do arquivo de log.
+ * @param files Arquivos observados, na mesma ordem usada em `walCreate`, abertos para leitura e escrita.
+ * @param fileCount Número de arquivos.
+ *
+ * @return O número de transações refeitas (0 se o log não existir ou estiver vazio), ou -1 em caso de erro.
+ */
+int walRecover(const char *filename, FILE *files[], int fileCount)
+{
+    FILE *file = fopen(filename, "r+b");
+    WalFileHeader header;
+
+    if (file == NULL)
+    {
+        return 0; // Nenhum log a recuperar
+    }
+
+    long size = storageSize(file);
+
+    if (size < (long)sizeof(WalFileHeader) || storageRead(file, 0, &header, sizeof(WalFileHeader)) != 0 ||
+        header.magic != WAL_MAGIC || header.fileCount != fileCount)
+    {
+        fprintf(stderr, "Aviso: log '%s' inválido ignorado.\n", filename);
+        closeFile(&file);
+        return 0;
+    }
+
+    char *log = malloc(size);
+    long *records = malloc(sizeof(long) * (size / sizeof(WalRecordHeader) + 1));
+    int recordCount = 0;
+    int committedCount = 0;
+
+    if (log == NULL || records == NULL || storageRead(file, 0, log, size) != 0)
+    {
+        fprintf(stderr, "Erro: não foi possível ler o log '%s'.\n", filename);
+        free(log);
+        free(records);
+        closeFile(&file);
+        return -1;
+    }
+
+    // Localiza os registros válidos da geração corrente. Os registros não ficam alinhados no buffer (as imagens têm
+    // tamanho arbitrário), por isso cada cabeçalho é copiado para uma variável local
+    for (long position = sizeof(WalFileHeader); position + (long)sizeof(WalRecordHeader) <= size;)
+    {
+        WalRecordHeader record;
+        long recordSize = sizeof(WalRecordHeader);
+
+        memcpy(&record, log + position, sizeof(WalRecordHeader));
+
+        if (record.type == WAL_RECORD_WRITE)
+        {
+            if (record.fileId < 0 || record.fileId >= fileCount || record.length < 0)
+            {
+                break;
+            }
+            recordSize += record.length;
+        }
+        else if (record.type != WAL_RECORD_COMMIT)
+        {
+            break;
+        }
+
+        if (record.generation != header.generation || position + recordSize > size)
+        {
+            break;
+        }
+
+        // A soma é calculada com o campo da soma igual a 0, na cópia local
+        unsigned int checksum = record.checksum;
+        record.checksum = 0;
+
+        unsigned int computed = checksumUpdate(WAL_CHECKSUM_SEED, &record, sizeof(WalRecordHeader));
+        computed = checksumUpdate(computed, log + position + sizeof(WalRecordHeader), recordSize - sizeof(WalRecordHeader));
+
+        if (computed != checksum)
+        {
+            break; // Registro incompleto no final do log
+        }
+
+        if (record.type == WAL_RECORD_COMMIT)
+        {
+            committedCount++;
+        }
+
+        records[recordCount++] = position;
+        position += recordSize;
+    }
+
+    // As transações são gravadas uma após a outra: uma gravação é confirmada apenas se o próximo registro de commit
+    // do log for o da sua transação. As de uma transação descartada (`walAbort`) ou incompleta são ignoradas
+    int committing = -1;
+
+    for (int i = recordCount - 1; i >= 0; i--)
+    {
+        WalRecordHeader record;
+
+        memcpy(&record, log + records[i], sizeof(WalRecordHeader));
+
+        if (record.type == WAL_RECORD_COMMIT)
+        {
+            committing = record.transaction;
+        }
+        else if (record.transaction != committing)
+        {
+            records[i] = -1;
+        }
+    }
+
+    // Refaz as gravações das transações confirmadas, na ordem do log
+    for (int i = 0; i < recordCount; i++)
+    {
+        WalRecordHeader record;
+
+        if (records[i] == -1)
+        {
+            continue;
+        }
+
+        memcpy(&record, log + records[i], sizeof(WalRecordHeader));
+
+        const char *after = log + records[i] + sizeof(WalRecordHeader);
+
+        if (record.type == WAL_RECORD_WRITE)
+        {
+            storageWrite(files[record.fileId], (long)record.offset, after, record.length);
+        }
+    }
+
+    free(log);
+    free(records);
+
+    int result = committedCount;
+
+    for (int i = 0; i < fileCount; i++)
+    {
+        if (storageSync(files[i]) != 0)
+        {
+            result = -1;
+        }
+    }
+
+    // Com os arquivos sincronizados, o conteúdo do log não é mais necessário
+    if (result != -1 && writeLogHeader(file, fileCount, header.generation + 1) != 0)
+    {
+        result = -1;
+    }
+
+    closeFile(&file);
+
+    return result;
+}